@@ -0,0 +1,120 @@
+// Microbenchmark comparing the generation of procedural textures by VKTextureSynth (SIMD rows, on one thread and
+// on the threads of a VKJobSystem) against the loop the samples used to generate their checkerboard texture
+// (a modulo and a division per texel, one byte at a time).
+//
+// Usage: TextureSynthBench [max size] [repetitions]
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "VKTextureSynth.hpp"
+#include "VKJobSystem.hpp"
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// The checkerboard loop of GenerateTextureData in 01F-VkHelloTextures and 02F-VkComputeShader
+static void GenerateCheckerboardLoop(uint32_t width, uint32_t height, uint8_t* pData)
+{
+    const size_t texelSize = 4;
+    const size_t rowPitch = width * texelSize;
+    const size_t cellPitch = rowPitch >> 3;
+    const size_t cellHeight = width >> 3;
+    const size_t textureSize = rowPitch * height;
+
+    for (size_t n = 0; n < textureSize; n += texelSize)
+    {
+        size_t x = n % rowPitch;
+        size_t y = n / rowPitch;
+        size_t i = x / cellPitch;
+        size_t j = y / cellHeight;
+
+        if (i % 2 == j % 2)
+        {
+            pData[n] = 0x00;
+            pData[n + 1] = 0x00;
+            pData[n + 2] = 0x00;
+            pData[n + 3] = 0xff;
+        }
+        else
+        {
+            pData[n] = 0xff;
+            pData[n + 1] = 0xff;
+            pData[n + 2] = 0xff;
+            pData[n + 3] = 0xff;
+        }
+    }
+}
+
+// Best time, in milliseconds, of a few repetitions of a function
+template<typename F>
+static double BestTime(uint32_t repetitions, F function)
+{
+    double best = -1.0;
+    for (uint32_t r = 0; r < repetitions; r++)
+    {
+        Clock::time_point start = Clock::now();
+        function();
+        double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (best < 0.0 || time < best)
+            best = time;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t maxSize = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 8192;
+    uint32_t repetitions = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 3;
+
+    VKJobSystem jobSystem;
+    jobSystem.Init();
+
+    printf("Instruction set: %s, %u threads\n\n", VKTextureSynth::GetInstructionSet(), jobSystem.GetThreadCount());
+    printf("%-14s %6s %12s %12s %12s %9s\n", "pattern", "size", "loop (ms)", "1 thread", "threads", "speedup");
+
+    for (uint32_t size = 1024; size <= maxSize; size *= 2)
+    {
+        std::vector<uint8_t> reference(static_cast<size_t>(size) * size * 4);
+        std::vector<uint8_t> data(reference.size());
+
+        // Touch the pages once, so that the first measurement doesn't include the page faults
+        memset(reference.data(), 0, reference.size());
+        memset(data.data(), 0, data.size());
+
+        double loopTime = BestTime(repetitions, [&]() { GenerateCheckerboardLoop(size, size, reference.data()); });
+
+        for (uint32_t p = 0; p < VKTextureSynth::PATTERN_COUNT; p++)
+        {
+            VKTextureSynth::Desc desc;
+            desc.Type = static_cast<VKTextureSynth::Pattern>(p);
+            desc.Width = size;
+            desc.Height = size;
+
+            double singleTime = BestTime(repetitions, [&]() { VKTextureSynth::Generate(desc, data.data()); });
+            double threadsTime = BestTime(repetitions, [&]() { VKTextureSynth::Generate(desc, data.data(), &jobSystem); });
+
+            if (desc.Type == VKTextureSynth::PATTERN_CHECKERBOARD)
+            {
+                // Same texels as the loop
+                if (data != reference)
+                {
+                    printf("Checkerboard %ux%u doesn't match the loop\n", size, size);
+                    return 1;
+                }
+                printf("%-14s %6u %12.2f %12.2f %12.2f %8.1fx\n", VKTextureSynth::GetPatternName(desc.Type), size,
+                       loopTime, singleTime, threadsTime, loopTime / threadsTime);
+            }
+            else
+            {
+                printf("%-14s %6u %12s %12.2f %12.2f\n", VKTextureSynth::GetPatternName(desc.Type), size,
+                       "-", singleTime, threadsTime);
+            }
+        }
+    }
+
+    jobSystem.Destroy();
+    return 0;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "VKFramePacer.hpp"
+
+/** @brief Example settings that can be changed e.g. by command line arguments */
+struct Settings {
+    /** @brief Activates validation layers (and message output) when set to true */
+    bool validation = false;
+    /** @brief Set to true if fullscreen mode has been requested via command line */
+    bool fullscreen = false;
+    /** @brief Set to true if v-sync will be forced for the swapchain */
+    bool vsync = false;
+    /** @brief Set to true if headless mode (offscreen rendering without a window) has been requested via command line */
+    bool headless = false;
+    /** @brief Number of frames to render before exiting in headless mode (number of frames to measure in benchmark mode) */
+    uint32_t frameCount = 1000;
+    /** @brief Set to true if benchmark mode (fixed number of frames with fixed timestep, metrics reported at exit) has been requested via command line */
+    bool benchmark = false;
+    /** @brief Number of frames to render before starting to measure them in benchmark mode */
+    uint32_t warmupFrames = 100;
+    /** @brief File the benchmark metrics are written to (in JSON format), if not empty */
+    std::string benchmarkOutput;
+    /** @brief Max number of frames the CPU can queue before waiting for the GPU (from 1 to MAX_FRAMES_IN_FLIGHT) */
+    uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    /** @brief Present mode requested via command line (VK_PRESENT_MODE_MAX_ENUM_KHR if it must be selected from vsync) */
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAX_ENUM_KHR;
+    /** @brief Set to true if frame pacing with VK_KHR_present_wait has been requested via command line */
+    bool presentWait = false;
+    };
+
+struct WindowParameters {
+#if defined(_WIN32)
+    HWND hWindow;
+    HINSTANCE hInstance;
+#elif defined(VK_USE_PLATFORM_XLIB_KHR)
+    bool quit = false;
+    Display *DisplayPtr;
+    Window Handle;
+    Atom xlib_wm_delete_window = 0;
+#endif
+};
+
+class VKSample;
+
+class VKApplication
+{
+public:
+    static void Setup(VKSample* pSample, bool enableValidation, void* hInstance = nullptr, int nCmdShow = 0);
+    static int RenderLoop();
+    static bool RenderFrame();
+    static std::vector<const char*>* GetArgs() { return &m_args; }
+    static VKSample* GetVKSample() { return m_pVKSample; }
+    static Settings settings;
+    static WindowParameters winParams;
+    static bool resizing;
+
+private:
+    static VKSample* m_pVKSample;
+    static std::vector<const char*> m_args;
+};
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include "VKTimestampQueries.hpp"
+
+// Number of frames whose GPU timestamps can be in flight at the same time.
+// It must be greater than the max number of frames queued by any sample (MAX_FRAMES_IN_FLIGHT).
+#define BENCHMARK_QUERY_SLOTS 8
+
+// Time step (in seconds) the simulation of the samples advances by at every frame in benchmark mode
+#define BENCHMARK_TIME_STEP (1.0 / 60.0)
+
+// Metrics recorded for each frame (in milliseconds). GPU time is negative if it couldn't be measured.
+struct BenchmarkFrame {
+    double                        CpuTime;        // Time spent in OnUpdate and OnRender
+    double                        GpuTime;        // Time spent by the GPU executing the commands of the frame
+    double                        AcquireTime;    // Time spent waiting for a swapchain image
+    double                        PresentTime;    // Time spent queuing the image for presentation
+    double                        Latency;        // Time from the sampling of the input to the presentation (see VKFramePacer)
+
+    BenchmarkFrame() :
+        CpuTime(0.0),
+        GpuTime(-1.0),
+        AcquireTime(0.0),
+        PresentTime(0.0),
+        Latency(-1.0) {
+    }
+};
+
+// Statistics of a metric (in milliseconds) computed over all the measured frames.
+struct BenchmarkStats {
+    double                        Min;
+    double                        Avg;
+    double                        P50;
+    double                        P95;
+    double                        P99;
+    double                        Max;
+    uint32_t                      SampleCount;
+
+    BenchmarkStats() :
+        Min(0.0),
+        Avg(0.0),
+        P50(0.0),
+        P95(0.0),
+        P99(0.0),
+        Max(0.0),
+        SampleCount(0) {
+    }
+};
+
+//
+// Collect per-frame metrics for a fixed number of frames, so that the performance of a sample can be
+// measured reproducibly and compared between runs.
+//
+// The GPU time of a frame is measured with a pair of timestamps written by two tiny command buffers
+// submitted right before and after the command buffers of the frame. The results of a frame are read back
+// BENCHMARK_QUERY_SLOTS frames later, when its command buffers have certainly completed.
+// The peak of device memory usage is tracked with VK_EXT_memory_budget, if supported.
+//
+class VKBenchmark
+{
+public:
+    enum Metric {
+        METRIC_ACQUIRE,
+        METRIC_PRESENT
+    };
+
+    VKBenchmark();
+    ~VKBenchmark();
+
+    // The first warmupFrames frames are rendered but not measured.
+    void Init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t warmupFrames);
+    void Destroy();
+
+    void BeginFrame();
+    void EndFrame();
+
+    // Add a time (in milliseconds) to one of the metrics of the current frame.
+    void AddTime(Metric metric, double milliseconds);
+
+    // Set the latency (in milliseconds) of the frame begun framesAgo frames before the current one,
+    // since the latency of a frame is usually known only some frames later.
+    void SetLatency(uint32_t framesAgo, double milliseconds);
+
+    // Get the command buffers writing the timestamps of the current frame, to be submitted before and after
+    // the command buffers of the frame to the queue passed to Init. Only the first submission of a frame is measured,
+    // so false is returned if timestamps are not supported or the GPU time of the current frame is already measured.
+    bool GetTimestampCommandBuffers(VkCommandBuffer* beginCmdBuffer, VkCommandBuffer* endCmdBuffer);
+
+    // Read back the GPU times of all the frames. Call it when the device is idle.
+    void CollectResults();
+
+    BenchmarkStats GetStats(double BenchmarkFrame::*metric) const;
+    void PrintReport(const char* sampleName) const;
+    bool WriteResults(const char* fileName, const char* sampleName) const;
+
+    // Number of frames begun so far, including the warm-up ones.
+    uint32_t GetFrameCount() const { return m_frameCount; }
+    bool IsEnabled() const { return m_enabled; }
+
+private:
+    void ReadBack(uint32_t slot);
+    void UpdateMemoryUsage();
+
+    VkPhysicalDevice              m_physicalDevice;
+    VkDevice                      m_device;
+    std::string                   m_deviceName;
+    VkCommandPool                 m_commandPool;
+    VKTimestampQueries            m_timestamps;         // A pair of queries for each query slot
+    std::vector<VkCommandBuffer>  m_beginCmdBuffers;    // One for each query slot
+    std::vector<VkCommandBuffer>  m_endCmdBuffers;      // One for each query slot
+    std::vector<int64_t>          m_pendingFrames;      // Per query slot: measured frame whose timestamps weren't read back yet (-1 if none)
+    bool                          m_frameTimed;         // True if the GPU time of the current frame is being measured
+
+    PFN_vkGetPhysicalDeviceMemoryProperties2KHR vkGetPhysicalDeviceMemoryProperties2KHR;
+    VkDeviceSize                  m_peakMemoryUsage;    // Peak of device-local memory usage (bytes)
+
+    std::vector<BenchmarkFrame>   m_frames;             // Metrics of the measured frames
+    uint32_t                      m_warmupFrames;
+    uint32_t                      m_frameCount;
+    std::chrono::steady_clock::time_point m_frameStart;
+    std::chrono::steady_clock::time_point m_benchmarkStart;
+    double                        m_totalTime;          // Wall-clock time spent rendering the measured frames (ms)
+    bool                          m_enabled;
+};
+
+// Measure the time spent in a scope and add it to a metric of the current frame.
+class VKBenchmarkScope
+{
+public:
+    VKBenchmarkScope(VKBenchmark& benchmark, VKBenchmark::Metric metric) :
+        m_benchmark(benchmark),
+        m_metric(metric)
+    {
+        if (m_benchmark.IsEnabled())
+            m_start = std::chrono::steady_clock::now();
+    }
+
+    ~VKBenchmarkScope()
+    {
+        if (m_benchmark.IsEnabled())
+            m_benchmark.AddTime(m_metric, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count());
+    }
+
+private:
+    VKBenchmark& m_benchmark;
+    VKBenchmark::Metric m_metric;
+    std::chrono::steady_clock::time_point m_start;
+};
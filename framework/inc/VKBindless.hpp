@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vector>
+
+// Default number of descriptors in each array of the bindless descriptor set
+#define BINDLESS_MAX_SAMPLED_IMAGES 4096
+#define BINDLESS_MAX_STORAGE_BUFFERS 4096
+
+// Binding points of the descriptor arrays in the bindless descriptor set:
+//
+// layout (set = 0, binding = 0) uniform sampler2D textures[];
+// layout (set = 0, binding = 1) readonly buffer Buffers { ... } buffers[];
+//
+#define BINDLESS_BINDING_SAMPLED_IMAGES 0
+#define BINDLESS_BINDING_STORAGE_BUFFERS 1
+
+// Index returned by Add* when the descriptor array is full
+#define BINDLESS_INVALID_INDEX UINT32_MAX
+
+//
+// A single, large descriptor set holding an array of combined image samplers and an array of storage buffers
+// (VK_EXT_descriptor_indexing), so that shaders can address any resource registered in the set by an index,
+// usually passed through push constants.
+// The set is bound once per command buffer: drawing with a different texture or buffer only requires a different
+// index, with no descriptor set allocation, update or binding in the render loop.
+//
+// Descriptors are written with the update-after-bind semantics, so resources can be registered while the set is
+// bound to command buffers that are recorded or pending, as long as those command buffers don't access the
+// descriptors being written. For the same reason, an index returned to the set by Remove* can only be reused once
+// the GPU has finished executing the commands that accessed it: the caller must wait for the frames in flight
+// (or do the removal when the resource itself is destroyed, which has the same requirement).
+//
+class VKBindless
+{
+public:
+    VKBindless();
+    ~VKBindless();
+
+    // Check whether the physical device supports bindless descriptors. If it does, the device extensions to enable are
+    // added to deviceExtensions, and features is filled with the descriptor indexing features to chain to the pNext of
+    // VkDeviceCreateInfo (so it must outlive the creation of the logical device).
+    // The instance must have been created with VK_KHR_get_physical_device_properties2 enabled.
+    static bool QuerySupport(VkInstance instance, VkPhysicalDevice physicalDevice,
+                             std::vector<const char*>& deviceExtensions,
+                             VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features);
+
+    // Create the descriptor set. The size of the arrays is clamped to the limits of the device.
+    void Init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device,
+              uint32_t maxSampledImages = BINDLESS_MAX_SAMPLED_IMAGES,
+              uint32_t maxStorageBuffers = BINDLESS_MAX_STORAGE_BUFFERS);
+    void Destroy();
+
+    // Write a descriptor in the first free element of an array, and return its index
+    // (BINDLESS_INVALID_INDEX if the array is full, in which case nothing is written).
+    uint32_t AddSampledImage(const VkDescriptorImageInfo& imageInfo);
+    uint32_t AddStorageBuffer(const VkDescriptorBufferInfo& bufferInfo);
+
+    // Overwrite the descriptor at a given index (for e.g. after recreating a resource).
+    void UpdateSampledImage(uint32_t index, const VkDescriptorImageInfo& imageInfo);
+    void UpdateStorageBuffer(uint32_t index, const VkDescriptorBufferInfo& bufferInfo);
+
+    // Return an index to the set, so that it can be reused by the next call to Add* (see above).
+    void RemoveSampledImage(uint32_t index);
+    void RemoveStorageBuffer(uint32_t index);
+
+    // Bind the descriptor set. layout must have been created with GetSetLayout at the index firstSet.
+    void Bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t firstSet = 0) const;
+
+    VkDescriptorSetLayout GetSetLayout() const { return m_setLayout; }
+    VkDescriptorSet GetSet() const { return m_set; }
+    uint32_t GetMaxSampledImages() const { return m_sampledImages.Size; }
+    uint32_t GetMaxStorageBuffers() const { return m_storageBuffers.Size; }
+
+private:
+    // Indices of a descriptor array: elements below Next have been used at least once, and the ones
+    // that were removed since are kept in FreeIndices.
+    struct IndexTable {
+        uint32_t                  Size;
+        uint32_t                  Next;
+        std::vector<uint32_t>     FreeIndices;
+    };
+
+    uint32_t AllocateIndex(IndexTable& table);
+    void FreeIndex(IndexTable& table, uint32_t index);
+    void WriteDescriptor(uint32_t binding, VkDescriptorType type, uint32_t index,
+                         const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo);
+
+    VkDevice                      m_device;
+    VkDescriptorPool              m_pool;
+    VkDescriptorSetLayout         m_setLayout;
+    VkDescriptorSet               m_set;
+
+    IndexTable                    m_sampledImages;
+    IndexTable                    m_storageBuffers;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include "VKTimestampQueries.hpp"
+
+// Number of times the workload of a variant is executed in a row for each measurement
+#define COMPUTE_TUNER_ITERATIONS 16
+
+// Number of measurements of each variant (the fastest one is kept), after a warm-up execution
+#define COMPUTE_TUNER_RUNS 3
+
+//
+// Select the fastest variant of a GPU workload (for e.g. the same compute shader specialized with different
+// workgroup sizes) by timing each variant with timestamp queries.
+//
+// Each measurement executes the commands recorded by the application several times in a single command buffer,
+// with a barrier between the executions (as if they were consecutive passes), and waits for its completion.
+// It's meant to be used at setup: the queue is stalled by every measurement.
+//
+class VKComputeTuner
+{
+public:
+    VKComputeTuner();
+    ~VKComputeTuner();
+
+    void Init(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamilyIndex);
+    void Destroy();
+
+    // Return the average GPU time (in milliseconds) of an execution of the commands recorded by record,
+    // or a negative value if timestamps are not supported by the queue.
+    double Measure(const std::function<void(VkCommandBuffer)>& record, uint32_t iterations = COMPUTE_TUNER_ITERATIONS);
+
+    // Measure variantCount variants of a workload, recorded by record(commandBuffer, variantIndex), and return the 
+    // index of the fastest one (0 if timestamps are not supported). The times of the variants are returned in times (if not null).
+    uint32_t SelectFastest(uint32_t variantCount, const std::function<void(VkCommandBuffer, uint32_t)>& record, 
+                           std::vector<double>* times = nullptr);
+
+    bool IsSupported() const { return m_timestamps.IsSupported(); }
+
+private:
+    double Run(const std::function<void(VkCommandBuffer)>& record, uint32_t iterations);
+
+    VkDevice                      m_device;
+    VkQueue                       m_queue;
+    VkCommandPool                 m_commandPool;
+    VkCommandBuffer               m_commandBuffer;
+    VkFence                       m_fence;
+    VKTimestampQueries            m_timestamps;         // A single pair, written at the beginning and at the end of a measurement
+};
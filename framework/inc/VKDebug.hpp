@@ -1,5 +1,19 @@
 #pragma once
 
+// Check the result of a Vulkan call: print the error and assert if it's not VK_SUCCESS
+#define VK_CHECK_RESULT(f)																			                          \
+{																										                      \
+    VkResult res = (f);																					                      \
+    if (res != VK_SUCCESS)																				                      \
+    {																									                      \
+        std::cout << "Fatal : VkResult is \"" << errorString(res) << "\" in " << __FILE__ << " at line " << __LINE__ << "\n"; \
+        assert(res == VK_SUCCESS);																		                      \
+    }																									                      \
+}
+
+// Return a string with the name of a VkResult error code
+std::string errorString(VkResult errorCode);
+
 extern PFN_vkCreateDebugUtilsMessengerEXT pfnCreateDebugUtilsMessengerEXT;
 extern PFN_vkDestroyDebugUtilsMessengerEXT pfnDestroyDebugUtilsMessengerEXT;
 extern VkDebugUtilsMessengerEXT debugUtilsMessenger;
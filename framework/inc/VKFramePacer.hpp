@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+
+// Default and max number of frames that can be queued (frames in flight), set at runtime with --frames-in-flight N
+#define DEFAULT_FRAMES_IN_FLIGHT 2
+#define MAX_FRAMES_IN_FLIGHT 4
+
+// Max time to wait for the presentation of a frame (for e.g. the window could be minimized and never present)
+#define FRAME_PACER_WAIT_TIMEOUT 1000000000ull
+
+//
+// Frame pacing and latency measurement.
+//
+// Each frame is identified by a number (its present ID), starting from 1, and its latency is measured from the time
+// its input is sampled (BeginFrame, before the sample updates the simulation) to the time it's presented.
+//
+// If VK_KHR_present_id and VK_KHR_present_wait are enabled, every present is tagged with the number of the frame,
+// and BeginFrame waits for the presentation of the frame framesInFlight frames back before the input of the new frame
+// is sampled. This caps the number of frames queued for presentation (not only the ones queued to the GPU), so that
+// the latency can be traded for throughput with the number of frames in flight. The presentation time is the time
+// the wait returns, which is accurate as long as the wait actually blocks (that is, unless the sample is CPU-bound).
+//
+// Without these extensions the latency is measured up to the return of vkQueuePresentKHR, so it doesn't include
+// the time spent by the frame in the presentation queue.
+//
+class VKFramePacer
+{
+public:
+    VKFramePacer();
+    ~VKFramePacer();
+
+    // Check whether the physical device supports waiting for presents. If it does, the device extensions to enable are
+    // added to deviceExtensions, and the features to chain to the pNext of VkDeviceCreateInfo are filled (presentIdFeatures
+    // points to presentWaitFeatures, so both must outlive the creation of the logical device).
+    // The instance must have been created with VK_KHR_get_physical_device_properties2 enabled.
+    static bool QuerySupport(VkInstance instance, VkPhysicalDevice physicalDevice,
+                             std::vector<const char*>& deviceExtensions,
+                             VkPhysicalDevicePresentIdFeaturesKHR& presentIdFeatures,
+                             VkPhysicalDevicePresentWaitFeaturesKHR& presentWaitFeatures);
+
+    // Convert the name of a present mode (fifo, fifo_relaxed, mailbox or immediate) to its value, and vice versa.
+    static bool ParsePresentMode(const char* name, VkPresentModeKHR* presentMode);
+    static const char* GetPresentModeName(VkPresentModeKHR presentMode);
+
+    // presentWait must be true only if the extensions and features returned by QuerySupport were enabled.
+    void Init(VkDevice device, uint32_t framesInFlight, bool presentWait);
+
+    // Set the swapchain the frames are presented to (after creating or recreating it).
+    // Frames presented to the previous swapchain are not waited for (nor measured).
+    void SetSwapchain(VkSwapchainKHR swapchain);
+
+    // Start a new frame (before sampling its input). Return true if the latency of a previous frame was measured,
+    // along with the number of frames since that frame (0 for the current one).
+    bool BeginFrame(uint32_t* framesAgo, double* latency);
+
+    // Chain a VkPresentIdKHR with the number of the current frame to the present info, if waiting for presents.
+    // presentId must outlive the call to vkQueuePresentKHR.
+    void ChainPresentId(VkPresentInfoKHR& presentInfo, VkPresentIdKHR& presentId);
+
+    // Call after presenting the current frame. Return true if its latency was measured (without present wait).
+    bool EndFrame(double* latency);
+
+    // Print the statistics of the latencies measured so far.
+    void PrintReport() const;
+
+    bool IsPresentWaitEnabled() const { return m_presentWait; }
+
+private:
+    double ElapsedMs(uint64_t frame) const;
+    void AddLatency(double latency);
+
+    VkDevice                      m_device;
+    VkSwapchainKHR                m_swapchain;
+    uint32_t                      m_framesInFlight;
+    bool                          m_presentWait;
+    PFN_vkWaitForPresentKHR       vkWaitForPresentKHR;
+
+    uint64_t                      m_frameNumber;         // Number (present ID) of the current frame
+    uint64_t                      m_lastPresented;       // Number of the last frame queued for presentation
+    uint64_t                      m_firstOfSwapchain;    // Number of the first frame presented to the current swapchain
+
+    // Time at which the input of the last frames was sampled (indexed by frame number modulo its size)
+    std::vector<std::chrono::steady_clock::time_point> m_inputTimes;
+
+    std::vector<double>           m_latencies;           // Latency of the last frames measured (ms)
+    uint64_t                      m_latencyCount;        // Number of frames measured so far
+};
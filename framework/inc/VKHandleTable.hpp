@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <assert.h>
+
+// Handle of an element of a VKHandleTable (its index in the table)
+typedef uint32_t TableHandle;
+#define INVALID_TABLE_HANDLE UINT32_MAX
+
+//
+// Table of named elements (pipelines, descriptor sets, mesh objects, ...) stored in a dense array
+// and accessed through small integer handles.
+//
+// Names are only used to register the elements, usually at setup: the handle returned by Register (or Find) is
+// stored by the application, and any access in the render loop is a bounds-checked (in debug builds) array
+// access, with no string construction, hashing or comparison.
+// Elements are never removed, so a handle stays valid for the whole lifetime of the table.
+//
+template<typename T>
+class VKHandleTable
+{
+public:
+    // Add an element, or return the handle of the element with the same name if already registered.
+    TableHandle Register(const std::string& name, const T& value = T())
+    {
+        TableHandle handle = Find(name);
+        if (handle != INVALID_TABLE_HANDLE)
+            return handle;
+
+        m_elements.push_back(value);
+        m_names.push_back(name);
+        return static_cast<TableHandle>(m_elements.size() - 1);
+    }
+
+    // Return the handle of the element with a given name, or INVALID_TABLE_HANDLE if there's no such element.
+    // Linear in the number of elements: resolve names once and keep the handles.
+    TableHandle Find(const std::string& name) const
+    {
+        for (size_t i = 0; i < m_names.size(); i++)
+        {
+            if (m_names[i] == name)
+                return static_cast<TableHandle>(i);
+        }
+        return INVALID_TABLE_HANDLE;
+    }
+
+    T& operator[](TableHandle handle)
+    {
+        assert(handle < m_elements.size());
+        return m_elements[handle];
+    }
+
+    const T& operator[](TableHandle handle) const
+    {
+        assert(handle < m_elements.size());
+        return m_elements[handle];
+    }
+
+    const std::string& GetName(TableHandle handle) const
+    {
+        assert(handle < m_names.size());
+        return m_names[handle];
+    }
+
+    size_t Size() const { return m_elements.size(); }
+    bool Empty() const { return m_elements.empty(); }
+
+    void Clear()
+    {
+        m_elements.clear();
+        m_names.clear();
+    }
+
+    // Iterate over the elements (in registration order), for e.g. to destroy them
+    typename std::vector<T>::iterator begin() { return m_elements.begin(); }
+    typename std::vector<T>::iterator end() { return m_elements.end(); }
+    typename std::vector<T>::const_iterator begin() const { return m_elements.begin(); }
+    typename std::vector<T>::const_iterator end() const { return m_elements.end(); }
+
+private:
+    std::vector<T>                m_elements;
+    std::vector<std::string>      m_names;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Max number of worker threads of the job system
+#define JOB_SYSTEM_MAX_THREADS 8
+
+//
+// Fixed pool of worker threads executing batches of jobs (fork-join).
+//
+// Run hands a batch of jobs to the workers and returns when all of them completed.
+// Each job receives its index in the batch and the index of the worker running it, so that
+// jobs can access per-thread resources (e.g. command pools) without further synchronization.
+//
+class VKJobSystem
+{
+public:
+    VKJobSystem();
+    ~VKJobSystem();
+
+    // Create the worker threads (0 to use one thread per hardware thread, up to JOB_SYSTEM_MAX_THREADS).
+    void Init(uint32_t threadCount = 0);
+    void Destroy();
+
+    // Run jobCount jobs on the worker threads and wait for their completion.
+    void Run(uint32_t jobCount, const std::function<void(uint32_t jobIndex, uint32_t threadIndex)>& job);
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+
+private:
+    void WorkerMain(uint32_t threadIndex);
+
+    std::vector<std::thread>      m_threads;
+    std::mutex                    m_mutex;
+    std::condition_variable       m_wakeCondition;      // Signaled when a batch of jobs is available (or on exit)
+    std::condition_variable       m_doneCondition;      // Signaled when all the jobs of the batch completed
+
+    // Current batch of jobs (protected by m_mutex)
+    const std::function<void(uint32_t, uint32_t)>* m_job;
+    uint32_t                      m_jobCount;
+    uint32_t                      m_nextJob;            // Index of the next job to hand to a worker
+    uint32_t                      m_pendingJobs;        // Number of jobs not completed yet
+    bool                          m_quit;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+// Preferred size of the device memory blocks sub-allocated by VKMemoryAllocator
+#define MEMORY_BLOCK_SIZE (64ull * 1024 * 1024)
+
+struct MemoryBlock;
+
+// A range of device memory sub-allocated from a memory block.
+struct MemoryAllocation {
+    VkDeviceMemory                Memory;           // Device memory object of the block the range was carved from
+    VkDeviceSize                  Offset;           // Offset of the range in the memory block
+    VkDeviceSize                  Size;             // Size of the range
+    void*                         MappedMemory;     // Host address of the range (nullptr if not host-visible)
+    uint32_t                      MemoryTypeIndex;
+    MemoryBlock*                  Block;
+
+    MemoryAllocation() :
+        Memory(VK_NULL_HANDLE),
+        Offset(0),
+        Size(0),
+        MappedMemory(nullptr),
+        MemoryTypeIndex(UINT32_MAX),
+        Block(nullptr) {
+    }
+};
+
+// Usage and fragmentation statistics of the memory blocks.
+struct MemoryStats {
+    uint32_t                      BlockCount;            // Number of live device memory objects
+    uint32_t                      DedicatedBlockCount;   // Number of live device memory objects holding a single resource
+    uint32_t                      AllocationCount;       // Number of live sub-allocations
+    uint32_t                      FreeRangeCount;        // Number of free ranges in the memory blocks
+    VkDeviceSize                  BlockBytes;            // Memory allocated from the driver
+    VkDeviceSize                  UsedBytes;             // Memory used by the sub-allocations
+    VkDeviceSize                  LargestFreeRange;      // Size of the largest free range
+    float                         Fragmentation;         // 0 if all free memory is contiguous, approaching 1 as it gets scattered
+
+    MemoryStats() :
+        BlockCount(0),
+        DedicatedBlockCount(0),
+        AllocationCount(0),
+        FreeRangeCount(0),
+        BlockBytes(0),
+        UsedBytes(0),
+        LargestFreeRange(0),
+        Fragmentation(0.0f) {
+    }
+};
+
+// A block of device memory (a single vkAllocateMemory) from which resources are sub-allocated.
+struct MemoryBlock {
+    struct Suballocation {
+        VkDeviceSize              Size;
+        bool                      Linear;   // Buffer or linear image (as opposed to an optimal-tiling image)
+    };
+
+    VkDeviceMemory                          Memory;
+    VkDeviceSize                            Size;
+    uint32_t                                MemoryTypeIndex;
+    uint8_t*                                MappedMemory;
+    bool                                    Dedicated;
+    std::map<VkDeviceSize, VkDeviceSize>    FreeRanges;       // Offset -> size, sorted by offset so that adjacent ranges can be merged
+    std::map<VkDeviceSize, Suballocation>   Allocations;      // Offset -> sub-allocation
+};
+
+//
+// Allocate large blocks of device memory for each memory type, and sub-allocate buffers and images
+// from them with a best-fit free list. This way the number of vkAllocateMemory calls (which are
+// expensive, and limited by maxMemoryAllocationCount) doesn't depend on the number of resources.
+//
+class VKMemoryAllocator
+{
+public:
+    VKMemoryAllocator();
+    ~VKMemoryAllocator();
+
+    void Init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = MEMORY_BLOCK_SIZE);
+    void Destroy();
+
+    // Sub-allocate a range of memory satisfying the requirements of a resource.
+    // Set linear to false for images with optimal tiling.
+    MemoryAllocation Allocate(const VkMemoryRequirements& memReqs, VkMemoryPropertyFlags memFlags, bool linear);
+    void Free(MemoryAllocation& allocation);
+
+    // Sub-allocate memory for a buffer (or an image) and bind it to the resource.
+    void AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags memFlags, MemoryAllocation& allocation);
+    void AllocateImageMemory(VkImage image, VkMemoryPropertyFlags memFlags, MemoryAllocation& allocation, bool linearTiling = false);
+
+    // Get statistics for a given memory type (or for all of them if memoryTypeIndex is UINT32_MAX).
+    MemoryStats GetStats(uint32_t memoryTypeIndex = UINT32_MAX) const;
+    void PrintStats() const;
+
+    VkDevice GetDevice() const { return m_device; }
+
+private:
+    MemoryBlock* CreateBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated);
+    void DestroyBlock(MemoryBlock* block);
+    bool AllocateFromBlock(MemoryBlock* block, VkDeviceSize size, VkDeviceSize alignment, bool linear, VkDeviceSize& offset);
+    uint32_t FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags memFlags) const;
+
+    VkDevice                            m_device;
+    VkPhysicalDeviceMemoryProperties    m_memoryProperties;
+    VkPhysicalDeviceLimits              m_limits;
+    VkDeviceSize                        m_blockSize[VK_MAX_MEMORY_TYPES];
+
+    // Memory blocks of each memory type
+    std::vector<MemoryBlock*>           m_blocks[VK_MAX_MEMORY_TYPES];
+
+    // Number of device memory objects currently allocated (limited by maxMemoryAllocationCount)
+    uint32_t                            m_deviceAllocationCount;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include "VKTimestampQueries.hpp"
+
+// Max number of scopes that can be profiled in a frame
+#define PROFILER_MAX_SCOPES 16
+
+// Number of frames the statistics of each scope are computed over
+#define PROFILER_HISTORY_SIZE 256
+
+// Timing statistics of a profiled scope (in milliseconds), computed over the last PROFILER_HISTORY_SIZE frames.
+struct ProfilerStats {
+    float                         Min;
+    float                         Avg;
+    float                         P99;
+    float                         Last;
+    uint32_t                      SampleCount;
+
+    ProfilerStats() :
+        Min(0.0f),
+        Avg(0.0f),
+        P99(0.0f),
+        Last(0.0f),
+        SampleCount(0) {
+    }
+};
+
+//
+// Measure the GPU time spent executing ranges of commands (scopes) with timestamp queries.
+//
+// Each scope uses a pair of queries (begin and end) for each frame in flight, and writes
+// the pair of the current frame slot. The results of a scope are read back
+// the next time the scope is recorded in the same frame slot: at that point the command buffer that
+// wrote them has completed (its fence was waited on), so reading them never stalls the CPU.
+//
+class VKProfiler
+{
+public:
+    VKProfiler();
+    ~VKProfiler();
+
+    void Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount);
+    void Destroy();
+
+    // Set the frame slot (usually the frame index) whose query pool will be used by the next scopes.
+    void BeginFrame(uint32_t frameIndex);
+
+    // Write a timestamp at the beginning and at the end of a scope.
+    // Scopes must begin outside render pass instances (the queries are reset in BeginScope).
+    void BeginScope(VkCommandBuffer cmd, const char* name, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+    void EndScope(VkCommandBuffer cmd, const char* name, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    ProfilerStats GetStats(const char* name) const;
+    void PrintReport() const;
+
+    bool IsEnabled() const { return m_enabled; }
+
+private:
+    struct Scope {
+        std::string               Name;
+        std::vector<bool>         Pending;      // Per frame slot: queries written and not read back yet
+        std::vector<float>        History;      // Ring buffer of the last GPU times (ms)
+        uint32_t                  HistoryIndex;
+        uint32_t                  SampleCount;
+    };
+
+    int FindScope(const char* name) const;
+    void ReadBack(uint32_t scopeIndex);
+
+    // Index of the pair of queries of a scope in the current frame slot
+    uint32_t GetPair(uint32_t scopeIndex) const { return m_frameIndex * PROFILER_MAX_SCOPES + scopeIndex; }
+
+    VKTimestampQueries            m_timestamps;         // PROFILER_MAX_SCOPES pairs for each frame in flight
+    std::vector<Scope>            m_scopes;
+    uint32_t                      m_frameCount;
+    uint32_t                      m_frameIndex;
+    bool                          m_enabled;
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "VKSampleHelper.hpp"
+#include "StepTimer.hpp"
+#include "VKBenchmark.hpp"
+#include "VKFramePacer.hpp"
+#include "VKStagingRing.hpp"
+#include "VKProfiler.hpp"
+#include "VKJobSystem.hpp"
+
+// File (in the assets path) the pipeline cache is saved to between runs
+#define PIPELINE_CACHE_FILE "pipeline_cache.bin"
+
+class VKSample
+{
+public:
+    VKSample(uint32_t width, uint32_t height, std::string name);
+    virtual ~VKSample();
+
+    virtual void OnInit() = 0;
+    virtual void OnUpdate() = 0;
+    virtual void OnRender() = 0;
+    virtual void OnDestroy() = 0;
+    virtual void OnResize() {}
+
+    virtual void WindowResize(uint32_t width, uint32_t height);
+
+    // Samples override the event handlers to handle specific messages.
+    virtual void OnKeyDown(uint8_t /*key*/) {}
+    virtual void OnKeyUp(uint8_t /*key*/) {}
+
+    // Accessors.
+    uint32_t GetWidth() const { return m_width; }
+    void SetWidth(uint32_t width) { m_width = width; }
+    uint32_t GetHeight() const { return m_height; }
+    void SetHeight(uint32_t height) { m_height = height; }
+    const char* GetTitle() const { return m_title.c_str(); }
+    const std::string GetStringTitle() const { return m_title; }
+    const std::string GetAssetsPath() const { return m_assetsPath; };
+    const std::string GetWindowTitle();
+    void SetAssetsPath(std::string assetPath) { m_assetsPath = assetPath; }
+    uint64_t GetFrameCounter() const{ return m_frameCounter; }
+    bool IsInitialized() const { return m_initialized; }
+
+    // Benchmark mode: collect per-frame metrics (with a fixed timestep) and report them at the end
+    void BeginBenchmark();
+    void EndBenchmark();
+    VKBenchmark* GetBenchmark() { return &m_benchmark; }
+
+    // Frame pacing: the number of frames in flight is set before OnInit, and BeginFramePacing is called
+    // at the beginning of every frame, before the sample samples its input and updates the simulation.
+    void SetFramesInFlight(uint32_t framesInFlight) { m_framesInFlight = framesInFlight; }
+    void BeginFramePacing();
+    VKFramePacer* GetFramePacer() { return &m_framePacer; }
+
+protected:
+    virtual void CreateInstance();
+    virtual void CreateSurface();
+    virtual void CreateSynchronizationObjects();
+    virtual void CreateDevice(VkQueueFlags requestedQueueTypes);
+    virtual void CreateSwapchain(uint32_t* width, uint32_t* height, bool vsync);
+    virtual void CreateDepthStencilImage(uint32_t width, uint32_t height);
+    virtual void CreateRenderPass();
+    virtual void CreateFrameBuffers();
+    virtual void AllocateCommandBuffers();
+
+    // Headless mode: render to offscreen images in place of the swapchain ones
+    virtual void CreateHeadlessImages(uint32_t width, uint32_t height);
+    VkResult AcquireNextImage(uint64_t timeout, VkSemaphore semaphore, VkFence fence, uint32_t* imageIndex);
+    VkResult QueuePresent(VkQueue queue, const VkPresentInfoKHR* presentInfo);
+
+    // Submit command buffers to a queue, measuring the GPU time of the frame in benchmark mode
+    VkResult QueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence);
+
+    // Pipeline cache persisted on disk, so that pipelines don't need to be compiled from scratch at every launch
+    virtual void CreatePipelineCache();
+    virtual void DestroyPipelineCache();
+    void ReportPipelineCreationTime();
+
+    // Multithreaded command buffer recording: each worker thread of the job system records secondary 
+    // command buffers from its own command pool (one for each frame in flight), so that no synchronization 
+    // is needed between threads. The pools of a frame are reset at once when the frame can be recorded again.
+    virtual void CreateThreadCommandPools();
+    virtual void DestroyThreadCommandPools();
+    void ResetThreadCommandPools();
+    VkCommandBuffer GetSecondaryCommandBuffer(uint32_t threadIndex);
+
+    // Samples override these hooks to request the instance extensions, device extensions and 
+    // device features they need. They are called by CreateInstance and CreateDevice.
+    virtual void EnableInstanceExtensions(std::vector<const char*>& instanceExtensions);
+    virtual void EnableDeviceExtensions(std::vector<const char*>& deviceExtensions);
+    virtual void EnableFeatures(VkPhysicalDeviceFeatures& features);
+
+    // Viewport dimensions.
+    uint32_t m_width;
+    uint32_t m_height;
+    float m_aspectRatio;
+
+    // Sentinel variable to check sample initialization completion.
+    bool m_initialized;
+
+    // Vulkan and sample parameters.
+    VulkanCommonParameters  m_vulkanParams;
+    SampleParameters m_sampleParams;
+
+    // Stores physical device properties (for e.g. checking device limits)
+    VkPhysicalDeviceProperties m_deviceProperties;
+    // Stores all available memory (type) properties for the physical device
+    VkPhysicalDeviceMemoryProperties m_deviceMemoryProperties;
+    // Stores the features available on the selected physical device (for e.g. checking if a feature is available)
+    VkPhysicalDeviceFeatures m_deviceFeatures;
+
+    // Sub-allocates device memory for buffers and images
+    VKMemoryAllocator m_memAllocator;
+
+    // Uploads data to buffers and images in device-local memory
+    VKStagingRing m_stagingRing;
+
+    // Measures the GPU time spent executing scopes of commands
+    VKProfiler m_profiler;
+
+    // Set by the samples that use the stencil buffer, before CreateDepthStencilImage is called:
+    // only depth-stencil formats are selected, and the stencil is cleared at the start of the render pass.
+    bool m_stencilBuffer = false;
+
+    // Frame count
+    StepTimer m_timer;
+    uint64_t m_frameCounter;
+    char m_lastFPS[32];
+
+    // Metrics collected in benchmark mode
+    VKBenchmark m_benchmark;
+
+    // Frame pacing (with VK_KHR_present_wait, if requested) and measurement of the input-to-present latency
+    VKFramePacer m_framePacer;
+
+    // Max number of frames the CPU can queue before waiting for the GPU (--frames-in-flight N)
+    uint32_t m_framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+
+    // Index of the current frame
+    uint32_t m_frameIndex = 0;
+
+    // Index of the next offscreen image to render to in headless mode
+    uint32_t m_headlessImageIndex = 0;
+
+    // Pipeline cache used to create all the pipeline objects of the sample
+    VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
+    // True if the pipeline cache was initialized with data saved by a previous run
+    bool m_warmPipelineCache = false;
+    // Time at which the creation of the pipeline objects started
+    std::chrono::steady_clock::time_point m_pipelineCreationStart;
+
+    // Worker threads used to record command buffers in parallel
+    VKJobSystem m_jobSystem;
+    // Command pools of each worker thread (one for each frame in flight)
+    std::vector<std::vector<ThreadCommandPool>> m_threadCommandPools;
+
+private:
+    // Root assets path.
+    std::string m_assetsPath;
+
+    // Window title.
+    std::string m_title;
+};
\ No newline at end of file
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "VKDebug.hpp"
+#include "VKMemoryAllocator.hpp"
+#include "VKHandleTable.hpp"
+
 struct QueueParameters {
     VkQueue                       Handle;
     uint32_t                      FamilyIndex;
@@ -12,7 +16,7 @@ struct QueueParameters {
 
 struct ImageParameters {
     VkImage                       Handle;
-    VkDeviceMemory                Memory;
+    MemoryAllocation              Allocation;
     VkImageView                   View;
     void*                         MappedMemory;
     uint32_t                      Size;
@@ -21,7 +25,7 @@ struct ImageParameters {
 
     ImageParameters() :
         Handle(VK_NULL_HANDLE),
-        Memory(VK_NULL_HANDLE),
+        Allocation(),
         View(VK_NULL_HANDLE),
         MappedMemory(nullptr),
         Descriptor(),
@@ -31,14 +35,14 @@ struct ImageParameters {
 
 struct BufferParameters {
     VkBuffer                      Handle;
-    VkDeviceMemory                Memory;
+    MemoryAllocation              Allocation;
     void*                         MappedMemory;
     size_t                        Size;
     VkDescriptorBufferInfo        Descriptor;
 
     BufferParameters() :
         Handle(VK_NULL_HANDLE),
-        Memory(VK_NULL_HANDLE),
+        Allocation(),
         MappedMemory(nullptr),
         Descriptor(),
         Size(0) {
@@ -96,10 +100,10 @@ struct FrameResources {
     std::vector<VkCommandBuffer>                        CommandBuffers;
     std::vector<BufferParameters>                       HostVisibleBuffers;
     std::vector<BufferParameters>                       HostVisibleDynamicBuffers;
-    std::map<std::string, std::vector<VkDescriptorSet>> DescriptorSets;
+    VKHandleTable<std::vector<VkDescriptorSet>>         DescriptorSets;
     std::vector<VkSemaphore>                            ImageAvailableSemaphores;
     std::vector<VkSemaphore>                            RenderingCompleteSemaphores;
-    std::map<std::string, std::vector<VkSemaphore>>     Semaphores;
+    VKHandleTable<std::vector<VkSemaphore>>             Semaphores;
     std::vector<VkFence>                                Fences;
 
     FrameResources() :
@@ -113,10 +117,23 @@ struct FrameResources {
     }
 };
 
+// Command pool used by a single thread to record the secondary command buffers of a frame.
+struct ThreadCommandPool {
+    VkCommandPool                        Handle;
+    std::vector<VkCommandBuffer>         SecondaryCommandBuffers;  // Allocated on demand, and reused every time the pool is reset
+    uint32_t                             UsedCount;                // Number of secondary command buffers recorded since the last reset
+
+    ThreadCommandPool() :
+        Handle(VK_NULL_HANDLE),
+        SecondaryCommandBuffers(),
+        UsedCount(0) {
+    }
+};
+
 struct SampleParameters {
     VkRenderPass                         RenderPass;
     std::vector<VkFramebuffer>           Framebuffers;
-    std::map<std::string, VkPipeline>    Pipelines;
+    VKHandleTable<VkPipeline>            Pipelines;
     VkDescriptorPool                     DescriptorPool;
     VkDescriptorSetLayout                DescriptorSetLayout;
     VkPipelineLayout                     PipelineLayout;
@@ -136,16 +153,6 @@ struct SampleParameters {
     }
 };
 
-#define VK_CHECK_RESULT(f)																			                          \
-{																										                      \
-    VkResult res = (f);																					                      \
-    if (res != VK_SUCCESS)																				                      \
-    {																									                      \
-        std::cout << "Fatal : VkResult is \"" << errorString(res) << "\" in " << __FILE__ << " at line " << __LINE__ << "\n"; \
-        assert(res == VK_SUCCESS);																		                      \
-    }																									                      \
-}
-
 void GetDeviceQueue(
     const VkDevice& device, 
     unsigned int queueFamilyIndex, 
@@ -169,28 +176,25 @@ void TransitionImageLayout(VkCommandBuffer cmd,
 
 void SetBufferMemoryBarrier(VkCommandBuffer cmd, 
                             VkBuffer buffer, VkDeviceSize size, VkDeviceSize offset, 
-                            VkAccessFlagBits srcAccessMask, VkPipelineStageFlags srcStages, 
-                            VkAccessFlagBits dstAccessMask, VkPipelineStageFlags dstStages);
+                            VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStages, 
+                            VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStages,
+                            uint32_t srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                            uint32_t dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED);
 
-void CreateBuffer(VkDevice device, 
+void CreateBuffer(VKMemoryAllocator& allocator, 
                     VkBufferCreateInfo bufferInfo, 
                     BufferParameters& bufParams, 
-                    VkMemoryPropertyFlags memFlags,
-                    VkPhysicalDeviceMemoryProperties devMemProps);
+                    VkMemoryPropertyFlags memFlags);
 
-void CreateBuffer(VkDevice device, 
+void CreateBuffer(VKMemoryAllocator& allocator, 
                     VkBufferCreateInfo bufferInfo, 
                     VkBuffer& buffer,
-                    VkDeviceMemory& memory,
-                    void *mappedMemory,
-                    VkMemoryPropertyFlags memFlags,
-                    VkPhysicalDeviceMemoryProperties devMemProps);
+                    MemoryAllocation& allocation,
+                    VkMemoryPropertyFlags memFlags);
 
 VkShaderModule LoadSPIRVShaderModule(VkDevice device, std::string filename);
 
 void FlushInitCommandBuffer(VkDevice device, VkQueue queue, VkCommandBuffer cmd, VkFence fence);
 
 void* AlignedAlloc(size_t size, size_t alignment);
-void AlignedFree(void* ptr);
-
-std::string errorString(VkResult errorCode);
\ No newline at end of file
+void AlignedFree(void* ptr);
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+// Default size of the staging ring buffer
+#define STAGING_RING_SIZE (32ull * 1024 * 1024)
+
+// Default number of upload batches that can be in flight at the same time
+#define STAGING_RING_BATCHES 4
+
+//
+// Upload data from the host to buffers and images in device-local memory through a single, persistently
+// mapped staging buffer used as a ring: uploads are sub-allocated at the head of the ring, and the space is
+// reclaimed at the tail as soon as the GPU has finished copying from it.
+//
+// The copies recorded between two calls to Submit are executed as a single batch (one command buffer, one
+// vkQueueSubmit), each batch with its own fence, so that the CPU can keep writing new uploads while the
+// previous batches are still being copied. Uploads larger than half of the ring are split in several copies.
+//
+// If the transfer queue passed to Init belongs to a different family than the graphics one (a dedicated
+// transfer queue, which usually maps to the DMA engines of the GPU), the ownership of the uploaded resources is
+// released by the transfer queue and acquired by the graphics queue at the end of each batch.
+// Either way, the uploaded data is available to any subsequent command submitted to the graphics queue, and
+// images are transitioned to the layout requested by the application.
+//
+class VKStagingRing
+{
+public:
+    VKStagingRing();
+    ~VKStagingRing();
+
+    void Init(VkPhysicalDevice physicalDevice, VkDevice device,
+              VkQueue transferQueue, uint32_t transferFamilyIndex,
+              VkQueue graphicsQueue, uint32_t graphicsFamilyIndex,
+              VkDeviceSize size = STAGING_RING_SIZE, uint32_t batchCount = STAGING_RING_BATCHES);
+    void Destroy();
+
+    // Copy data to a range of a buffer. The buffer must be created with VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+    // and the range must not be in use by the GPU.
+    void UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+    // Reserve space in the ring for a copy to a range of a buffer and return its host address, so that the data can
+    // be written directly to the staging memory. It must be written before calling any other method of the ring.
+    // size can't exceed GetMaxUploadSize.
+    void* MapBufferUpload(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+
+    // Copy tightly packed texels to a mip level and array layer of a 2D image (of a non-compressed format), created
+    // with VK_IMAGE_USAGE_TRANSFER_DST_BIT. Meant for the initial upload of an image: the previous content of the
+    // subresource is discarded, and the image is left in finalLayout.
+    void UploadImage(VkImage image, uint32_t width, uint32_t height, uint32_t texelSize, const void* data,
+                     VkImageLayout finalLayout, uint32_t mipLevel = 0, uint32_t arrayLayer = 0);
+
+    // Same as UploadImage, for a block-compressed format: the data is made of tightly packed blocks of 
+    // blockWidth x blockHeight texels, blockSize bytes each (the blocks on the right and bottom edges can be partial).
+    void UploadCompressedImage(VkImage image, uint32_t width, uint32_t height, 
+                               uint32_t blockWidth, uint32_t blockHeight, uint32_t blockSize, const void* data,
+                               VkImageLayout finalLayout, uint32_t mipLevel = 0, uint32_t arrayLayer = 0);
+
+    // Submit the copies recorded so far as a single batch, without waiting for it to complete.
+    void Submit();
+
+    // Submit the copies recorded so far and wait for all the batches to complete.
+    void Flush();
+
+    VkDeviceSize GetMaxUploadSize() const { return m_size / 2; }
+    bool UsesDedicatedQueue() const { return m_transferFamilyIndex != m_graphicsFamilyIndex; }
+
+private:
+    // A batch of copies, submitted at once and tracked by a fence.
+    struct Batch {
+        VkCommandBuffer                      TransferCmdBuffer;
+        VkCommandBuffer                      GraphicsCmdBuffer;    // Acquires the ownership of the resources (dedicated transfer queue only)
+        VkSemaphore                          Semaphore;            // Signaled by the transfer queue, waited by the graphics queue (dedicated transfer queue only)
+        VkFence                              Fence;
+        VkDeviceSize                         End;                  // Head of the ring when the batch was submitted
+        bool                                 Pending;
+
+        // Copies are recorded when the batch is submitted, so that all the copies to the same resource
+        // can be issued with a single command.
+        std::vector<std::pair<VkBuffer, VkBufferCopy>>        BufferCopies;
+        std::vector<std::pair<VkImage, VkBufferImageCopy>>    ImageCopies;
+        std::vector<VkImageMemoryBarrier>    ImageTransitions;     // Transition of the images uploaded by the batch to TRANSFER_DST_OPTIMAL
+        std::vector<VkBufferMemoryBarrier>   BufferBarriers;       // Ownership transfer of the uploaded buffer ranges (dedicated transfer queue only)
+        std::vector<VkImageMemoryBarrier>    ImageBarriers;        // Transition of the uploaded images to their final layout
+
+        bool Empty() const { return BufferCopies.empty() && ImageCopies.empty(); }
+    };
+
+    VkDeviceSize Allocate(VkDeviceSize size, VkDeviceSize alignment);
+    void WaitOldestBatch();
+
+    VkDevice                      m_device;
+    VkQueue                       m_transferQueue;
+    VkQueue                       m_graphicsQueue;
+    uint32_t                      m_transferFamilyIndex;
+    uint32_t                      m_graphicsFamilyIndex;
+    VkCommandPool                 m_transferCommandPool;
+    VkCommandPool                 m_graphicsCommandPool;
+
+    VkBuffer                      m_buffer;
+    VkDeviceMemory                m_memory;
+    uint8_t*                      m_mappedMemory;
+    VkDeviceSize                  m_size;
+    VkDeviceSize                  m_copyOffsetAlignment;   // optimalBufferCopyOffsetAlignment
+
+    // Head and tail of the ring, as offsets that only grow (the offset in the buffer is their value modulo m_size).
+    VkDeviceSize                  m_head;
+    VkDeviceSize                  m_tail;
+
+    std::vector<Batch>            m_batches;
+    uint32_t                      m_currentBatch;          // Batch recording the next copies
+    uint32_t                      m_pendingBatches;        // Batches submitted and not waited yet, preceding m_currentBatch
+};
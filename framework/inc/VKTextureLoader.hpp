@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+//
+// Load a 2D texture, with its mip chain, from a KTX2 file (the container of the Khronos Group for GPU textures,
+// which stores the texels of each mip level in the layout expected by Vulkan, for any VkFormat).
+//
+// Block-compressed formats (BC1-BC7, ETC2/EAC, ASTC) are kept as-is, so that they can be uploaded to the GPU and
+// sampled directly: they take 4 to 8 times less memory, and bandwidth, than R8G8B8A8 textures. If the device can't
+// sample the format of a texture, Decode converts it to R8G8B8A8 on the CPU (for the BC1-BC5, BC7 and ETC2 formats:
+// ASTC textures can only be used on devices that support them).
+//
+// Only 2D textures without supercompression are supported (no array layers, cube faces, Basis Universal or Zstandard).
+//
+class VKTextureLoader
+{
+public:
+    // A mip level of the texture: the texels (or blocks, for a compressed format) are tightly packed in rows.
+    struct Level {
+        uint32_t                  Width;
+        uint32_t                  Height;
+        std::vector<uint8_t>      Data;
+    };
+
+    VKTextureLoader();
+
+    // Load a texture and all its mip levels, or return false (after printing why) if the file can't be loaded.
+    bool LoadKTX2(const std::string& fileName);
+
+    // Check if the device can use images of the format of the texture for the requested features (for e.g. sampling).
+    // The device feature of the family of a compressed format (for e.g. textureCompressionBC) must be enabled.
+    bool IsFormatSupported(VkPhysicalDevice physicalDevice, const VkPhysicalDeviceFeatures& enabledFeatures,
+                           VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) const;
+
+    // Decode a compressed texture to R8G8B8A8 (UNORM or SRGB, as the original format) on the CPU.
+    // Return false if there's no decoder for the format of the texture.
+    bool Decode();
+
+    VkFormat GetFormat() const { return m_format; }
+    const char* GetFormatName() const;
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+    uint32_t GetBlockWidth() const { return m_blockWidth; }
+    uint32_t GetBlockHeight() const { return m_blockHeight; }
+    uint32_t GetBlockSize() const { return m_blockSize; }
+    bool IsCompressed() const { return m_blockWidth > 1 || m_blockHeight > 1; }
+
+    uint32_t GetLevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+    const Level& GetLevel(uint32_t level) const { return m_levels[level]; }
+
+    // Size in bytes of all the mip levels, and size they would take as R8G8B8A8 texels
+    size_t GetSize() const;
+    size_t GetUncompressedSize() const;
+
+    // Enable the features of the families of compressed formats supported by the device
+    static void EnableCompressionFeatures(const VkPhysicalDeviceFeatures& supportedFeatures, VkPhysicalDeviceFeatures& enabledFeatures);
+
+private:
+    VkFormat                      m_format;
+    uint32_t                      m_width;
+    uint32_t                      m_height;
+    uint32_t                      m_blockWidth;      // Size of a block of texels (1x1 for non-compressed formats)
+    uint32_t                      m_blockHeight;
+    uint32_t                      m_blockSize;       // Bytes per block
+    std::vector<Level>            m_levels;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class VKJobSystem;
+
+//
+// Generate procedural RGBA8 textures (checkerboards, gradients, value and Perlin noise, test patterns) on the CPU.
+//
+// The texels are not computed one at a time: every row is built with SIMD instructions (AVX2 if the CPU supports it,
+// SSE2 on x86-64, NEON on ARM64, plain C++ otherwise), and identical rows (for e.g. the rows of a row of cells of a
+// checkerboard) are only built once and then copied. With a VKJobSystem, the rows are split in bands generated
+// in parallel by the worker threads.
+//
+class VKTextureSynth
+{
+public:
+    enum Pattern {
+        PATTERN_CHECKERBOARD,   // Cells of Color0 and Color1 (the first one is Color0)
+        PATTERN_GRADIENT,       // Diagonal gradient from Color0 (top left) to Color1 (bottom right)
+        PATTERN_VALUE_NOISE,    // Fractal value noise (random values at the vertices of a lattice, smoothly interpolated)
+        PATTERN_PERLIN_NOISE,   // Fractal Perlin noise (random gradients at the vertices of a lattice)
+        PATTERN_TEST,           // Color bars, a gray ramp and a grid, to check orientation, filtering and color conversions
+        PATTERN_COUNT
+    };
+
+    struct Desc {
+        Pattern     Type = PATTERN_CHECKERBOARD;
+        uint32_t    Width = 256;
+        uint32_t    Height = 256;
+        uint32_t    Color0 = 0xff000000;    // Colors as RGBA8 texels (R in the lowest byte), the noise goes from Color0 to Color1
+        uint32_t    Color1 = 0xffffffff;
+        uint32_t    CellWidth = 0;          // Size of the cells of a checkerboard, or of the lattice of the first octave of noise,
+        uint32_t    CellHeight = 0;         // in texels (0 for 1/8 of the width of the texture, as the checkerboards of the samples)
+        uint32_t    Octaves = 5;            // Number of octaves of noise, each with half the cell size and amplitude of the previous one
+        uint32_t    Seed = 0;               // Seed of the random values of the noise
+    };
+
+    // Write the texels of the texture described by desc to data (Width * Height * 4 bytes, tightly packed rows).
+    // If jobSystem isn't null the rows are generated in parallel by its worker threads.
+    static void Generate(const Desc& desc, uint8_t* data, VKJobSystem* jobSystem = nullptr);
+
+    // Name of the instruction set used to build the rows (for e.g. "AVX2")
+    static const char* GetInstructionSet();
+
+    // Pattern from its name (checkerboard, gradient, value, perlin, test), or PATTERN_COUNT if the name is unknown
+    static Pattern GetPattern(const char* name);
+    static const char* GetPatternName(Pattern pattern);
+
+private:
+    static void GenerateRows(const Desc& desc, uint8_t* data, uint32_t firstRow, uint32_t rowCount);
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+//
+// A pool of pairs of timestamp queries, measuring the GPU time spent between the two timestamps of each pair.
+//
+// It holds what VKProfiler, VKBenchmark and VKComputeTuner have in common: checking that the queue family supports
+// timestamps, creating the query pool, and converting the difference of two timestamps to milliseconds
+// (timestampPeriod is the number of nanoseconds per tick, and the valid bits tell us where the counter wraps around).
+// Each user decides which pair is written by which command buffer, and when it's safe to read it back.
+//
+class VKTimestampQueries
+{
+public:
+    VKTimestampQueries();
+    ~VKTimestampQueries();
+
+    // Create pairCount pairs of timestamp queries, to be written by command buffers submitted to a queue of the given family.
+    // Return false (and create nothing) if the queue family doesn't support timestamps.
+    bool Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t pairCount);
+    void Destroy();
+
+    // Reset a pair and write its first timestamp. Must be recorded outside render pass instances.
+    void Begin(VkCommandBuffer cmd, uint32_t pair, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+    // Write the second timestamp of a pair.
+    void End(VkCommandBuffer cmd, uint32_t pair, VkPipelineStageFlagBits stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+    // Read back the time (in milliseconds) between the two timestamps of a pair. If wait is false the CPU never stalls,
+    // and false is returned if the timestamps are not available yet. With wait, the call blocks until they are.
+    bool GetElapsed(uint32_t pair, bool wait, double* milliseconds) const;
+
+    bool IsSupported() const { return m_queryPool != VK_NULL_HANDLE; }
+
+private:
+    VkDevice                      m_device;
+    VkQueryPool                   m_queryPool;
+    float                         m_timestampPeriod;    // Nanoseconds per timestamp tick
+    uint64_t                      m_timestampMask;      // Valid bits of the timestamps
+};
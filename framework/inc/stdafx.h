@@ -0,0 +1,25 @@
+#pragma once
+
+// Precompiled-header style include used when the framework library is built on its own.
+// Samples compile these sources through their own stdafx.h, which is a superset of this one.
+
+#ifdef _WIN32
+#include <windows.h>
+#include <shellapi.h>
+#elif defined(VK_USE_PLATFORM_XLIB_KHR)
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+#endif
+
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <map>
+#include <array>
+#include <chrono>
+#include <string.h>
+#include <assert.h>
+
+#include "vulkan.h"
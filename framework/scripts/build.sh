@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Build the static library with the framework code shared by all the samples.
+# Run from the framework directory.
+
+FILE=/usr/include/vulkan/vulkan.h
+if [ -f "$FILE" ]; then
+    VULKAN_INCLUDE=/usr/include/vulkan/
+else 
+    VULKAN_INCLUDE=../external/include/vulkan/
+fi
+
+includes="-Iinc -I../external/include/ -I$VULKAN_INCLUDE"
+
+defines="-DDEBUG -DVK_USE_PLATFORM_XLIB_KHR"
+
+source ../scripts/compile.sh
+
+echo Building framework...
+
+compile_sources obj "$includes $defines" src/*.cpp || exit 1
+archive_library lib/libvkframework.a $OBJECTS || exit 1
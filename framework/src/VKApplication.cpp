@@ -41,8 +41,8 @@ LRESULT CALLBACK WindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lPara
         case WM_PAINT:
             if (pSample && pSample->IsInitialized() && !IsIconic(VKApplication::winParams.hWindow))
             {
-                pSample->OnUpdate();
-                pSample->OnRender();
+                if (!VKApplication::RenderFrame())
+                    PostQuitMessage(0);
 
                 if (pSample->GetFrameCounter() % 100 == 0)
                     SetWindowText(VKApplication::winParams.hWindow, pSample->GetWindowTitle().c_str());
@@ -200,6 +200,56 @@ void VKApplication::Setup(VKSample* pSample, bool enableValidation, void* hInsta
     }
     m_pVKSample->SetAssetsPath(assetsPath);
 
+    // Parse command line arguments
+    for (size_t i = 1; i < m_args.size(); i++)
+    {
+        if (strcmp(m_args[i], "--headless") == 0)
+            settings.headless = true;
+        else if ((strcmp(m_args[i], "--frames") == 0) && (i + 1 < m_args.size()))
+            settings.frameCount = static_cast<uint32_t>(strtoul(m_args[++i], nullptr, 10));
+        else if (strcmp(m_args[i], "--benchmark") == 0)
+            settings.benchmark = true;
+        else if ((strcmp(m_args[i], "--warmup") == 0) && (i + 1 < m_args.size()))
+            settings.warmupFrames = static_cast<uint32_t>(strtoul(m_args[++i], nullptr, 10));
+        else if ((strcmp(m_args[i], "--out") == 0) && (i + 1 < m_args.size()))
+        {
+            // Writing the results to a file implies benchmark mode
+            settings.benchmarkOutput = m_args[++i];
+            settings.benchmark = true;
+        }
+        else if (strcmp(m_args[i], "--vsync") == 0)
+            settings.vsync = true;
+        else if ((strcmp(m_args[i], "--frames-in-flight") == 0) && (i + 1 < m_args.size()))
+        {
+            // Fewer frames in flight reduce the latency, more frames in flight increase the throughput
+            uint32_t framesInFlight = static_cast<uint32_t>(strtoul(m_args[++i], nullptr, 10));
+            settings.framesInFlight = std::min(std::max(framesInFlight, 1u), static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+        }
+        else if ((strcmp(m_args[i], "--present-mode") == 0) && (i + 1 < m_args.size()))
+        {
+            if (!VKFramePacer::ParsePresentMode(m_args[++i], &settings.presentMode))
+                printf("Unknown present mode %s (expected fifo, fifo_relaxed, mailbox or immediate): the default one is used.\n", m_args[i]);
+        }
+        else if (strcmp(m_args[i], "--present-wait") == 0)
+            settings.presentWait = true;
+    }
+
+    // The frame resources of the sample are created for the requested number of frames in flight
+    m_pVKSample->SetFramesInFlight(settings.framesInFlight);
+
+    // In headless mode no window is created: the sample renders to offscreen images 
+    // (in place of the swapchain ones) so it can run without a display (e.g. on CI machines).
+    if (settings.headless)
+    {
+#if defined(_WIN32)
+        // Always set up a console since there is no window to show the results.
+        setupConsole("Vulkan Sample");
+#endif
+        // Initialize the sample. OnInit is defined in each child-implementation of VKSample.
+        pSample->OnInit();
+        return;
+    }
+
 #if defined(_WIN32)
     if (settings.validation)
         setupConsole("Vulkan Sample");
@@ -331,8 +381,61 @@ void VKApplication::Setup(VKSample* pSample, bool enableValidation, void* hInsta
 #endif
 }
 
+// Update and render a frame, measuring it in benchmark mode.
+// Return false (without rendering anything) once all the frames of the benchmark have been rendered.
+bool VKApplication::RenderFrame()
+{
+    VKBenchmark* pBenchmark = m_pVKSample->GetBenchmark();
+
+    if (settings.benchmark)
+    {
+        if (pBenchmark->GetFrameCount() >= settings.warmupFrames + settings.frameCount)
+            return false;
+
+        pBenchmark->BeginFrame();
+    }
+
+    // Wait for the presentation of a previous frame (if frame pacing is enabled) before sampling the input of this one
+    m_pVKSample->BeginFramePacing();
+
+    m_pVKSample->OnUpdate();
+    m_pVKSample->OnRender();
+
+    if (settings.benchmark)
+        pBenchmark->EndFrame();
+
+    return true;
+}
+
 int VKApplication::RenderLoop()
 {
+    // In benchmark mode the sample renders a fixed number of frames (after some warm-up frames),
+    // with a fixed timestep, and reports the metrics collected for each of them at exit.
+    if (settings.benchmark && m_pVKSample->IsInitialized())
+        m_pVKSample->BeginBenchmark();
+
+    // In headless mode render a fixed number of frames, without processing any window event.
+    if (settings.headless)
+    {
+        uint32_t frame = 0;
+        for (; (settings.benchmark || frame < settings.frameCount) && m_pVKSample->IsInitialized(); frame++)
+        {
+            if (!RenderFrame())
+                break;
+        }
+
+        printf("%s (%u frames rendered in headless mode)\n", m_pVKSample->GetWindowTitle().c_str(), frame);
+        fflush(stdout);
+
+        if (settings.benchmark)
+            m_pVKSample->EndBenchmark();
+        else
+            m_pVKSample->GetFramePacer()->PrintReport();
+
+        m_pVKSample->OnDestroy();
+        return 0;
+    }
+
     // Main sample loop
 #if defined(_WIN32)
     MSG msg;
@@ -350,6 +453,11 @@ int VKApplication::RenderLoop()
         }
     }
 
+    if (settings.benchmark)
+        m_pVKSample->EndBenchmark();
+    else
+        m_pVKSample->GetFramePacer()->PrintReport();
+
     m_pVKSample->OnDestroy();
 
     // Return this part of the WM_QUIT message to Windows.
@@ -367,8 +475,8 @@ int VKApplication::RenderLoop()
 
         if (!winParams.quit && m_pVKSample->IsInitialized())
         {
-            m_pVKSample->OnUpdate();
-            m_pVKSample->OnRender();
+            if (!RenderFrame())
+                winParams.quit = true;
         }
 
         if (m_pVKSample->GetFrameCounter() % 1000 == 0)
@@ -384,6 +492,11 @@ int VKApplication::RenderLoop()
         }
     }
 
+    if (settings.benchmark)
+        m_pVKSample->EndBenchmark();
+    else
+        m_pVKSample->GetFramePacer()->PrintReport();
+
     m_pVKSample->OnDestroy();
     return 0;
 #endif
@@ -0,0 +1,400 @@
+#include "stdafx.h"
+#include "VKDebug.hpp"
+#include "VKBenchmark.hpp"
+#include <cmath>
+
+VKBenchmark::VKBenchmark() :
+    m_physicalDevice(VK_NULL_HANDLE),
+    m_device(VK_NULL_HANDLE),
+    m_commandPool(VK_NULL_HANDLE),
+    m_frameTimed(false),
+    vkGetPhysicalDeviceMemoryProperties2KHR(nullptr),
+    m_peakMemoryUsage(0),
+    m_warmupFrames(0),
+    m_frameCount(0),
+    m_totalTime(0.0),
+    m_enabled(false)
+{
+}
+
+VKBenchmark::~VKBenchmark()
+{
+    Destroy();
+}
+
+void VKBenchmark::Init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t warmupFrames)
+{
+    m_physicalDevice = physicalDevice;
+    m_device = device;
+    m_warmupFrames = warmupFrames;
+    m_frameCount = 0;
+    m_frames.clear();
+    m_enabled = true;
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    m_deviceName = deviceProperties.deviceName;
+
+    //
+    // GPU time
+    //
+
+    // A pair of timestamp queries for each slot
+    if (!m_timestamps.Init(physicalDevice, device, queueFamilyIndex, BENCHMARK_QUERY_SLOTS))
+    {
+        printf("VKBenchmark: timestamps are not supported by queue family %u, GPU times won't be measured.\n", queueFamilyIndex);
+    }
+    else
+    {
+        VkCommandPoolCreateInfo cmdPoolInfo = {};
+        cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmdPoolInfo.queueFamilyIndex = queueFamilyIndex;
+        VK_CHECK_RESULT(vkCreateCommandPool(m_device, &cmdPoolInfo, nullptr, &m_commandPool));
+
+        m_beginCmdBuffers.resize(BENCHMARK_QUERY_SLOTS);
+        m_endCmdBuffers.resize(BENCHMARK_QUERY_SLOTS);
+        m_pendingFrames.assign(BENCHMARK_QUERY_SLOTS, -1);
+
+        VkCommandBufferAllocateInfo cmdBufAllocateInfo = {};
+        cmdBufAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmdBufAllocateInfo.commandPool = m_commandPool;
+        cmdBufAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmdBufAllocateInfo.commandBufferCount = BENCHMARK_QUERY_SLOTS;
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &cmdBufAllocateInfo, m_beginCmdBuffers.data()));
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &cmdBufAllocateInfo, m_endCmdBuffers.data()));
+
+        // The command buffers always write the same queries, so they are recorded once and submitted many times.
+        // A slot is reused only after the timestamps written by its previous submission were read back.
+        VkCommandBufferBeginInfo cmdBufInfo = {};
+        cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+        for (uint32_t i = 0; i < BENCHMARK_QUERY_SLOTS; i++)
+        {
+            VK_CHECK_RESULT(vkBeginCommandBuffer(m_beginCmdBuffers[i], &cmdBufInfo));
+            m_timestamps.Begin(m_beginCmdBuffers[i], i);
+            VK_CHECK_RESULT(vkEndCommandBuffer(m_beginCmdBuffers[i]));
+
+            VK_CHECK_RESULT(vkBeginCommandBuffer(m_endCmdBuffers[i], &cmdBufInfo));
+            m_timestamps.End(m_endCmdBuffers[i], i);
+            VK_CHECK_RESULT(vkEndCommandBuffer(m_endCmdBuffers[i]));
+        }
+    }
+
+    //
+    // Device memory usage
+    //
+
+    // VK_EXT_memory_budget reports how much memory of each heap is currently used by the process.
+    // It's queried through vkGetPhysicalDeviceMemoryProperties2KHR, which is only available if the sample
+    // enabled VK_KHR_get_physical_device_properties2 (samples enable it in benchmark mode whenever it's supported).
+    bool budgetSupported = false;
+
+    uint32_t extCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> deviceExtensions(extCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, deviceExtensions.data());
+    for (const VkExtensionProperties& extension : deviceExtensions)
+    {
+        if (strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0)
+            budgetSupported = true;
+    }
+
+    bool properties2Supported = false;
+
+    vkEnumerateInstanceExtensionProperties(nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> instanceExtensions(extCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extCount, instanceExtensions.data());
+    for (const VkExtensionProperties& extension : instanceExtensions)
+    {
+        if (strcmp(extension.extensionName, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0)
+            properties2Supported = true;
+    }
+
+    if (budgetSupported && properties2Supported)
+        vkGetPhysicalDeviceMemoryProperties2KHR = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2KHR>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+
+    if (vkGetPhysicalDeviceMemoryProperties2KHR)
+        UpdateMemoryUsage();
+    else
+        printf("VKBenchmark: VK_EXT_memory_budget is not supported, device memory usage won't be measured.\n");
+}
+
+void VKBenchmark::Destroy()
+{
+    if (m_device == VK_NULL_HANDLE)
+        return;
+
+    if (m_commandPool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+
+    m_timestamps.Destroy();
+
+    m_commandPool = VK_NULL_HANDLE;
+    m_beginCmdBuffers.clear();
+    m_endCmdBuffers.clear();
+    m_pendingFrames.clear();
+    m_enabled = false;
+    m_device = VK_NULL_HANDLE;
+}
+
+void VKBenchmark::BeginFrame()
+{
+    if (!m_enabled)
+        return;
+
+    // Read back the timestamps of the frame that last used the query slot of this frame
+    if (m_timestamps.IsSupported())
+        ReadBack(m_frameCount % BENCHMARK_QUERY_SLOTS);
+
+    // Measured frames start here
+    if (m_frameCount == m_warmupFrames)
+    {
+        m_benchmarkStart = std::chrono::steady_clock::now();
+        m_totalTime = 0.0;
+    }
+
+    if (m_frameCount >= m_warmupFrames)
+        m_frames.push_back(BenchmarkFrame());
+
+    m_frameTimed = false;
+    m_frameStart = std::chrono::steady_clock::now();
+}
+
+void VKBenchmark::EndFrame()
+{
+    if (!m_enabled)
+        return;
+
+    std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+
+    if (m_frameCount >= m_warmupFrames)
+    {
+        m_frames.back().CpuTime = std::chrono::duration<double, std::milli>(frameEnd - m_frameStart).count();
+        m_totalTime = std::chrono::duration<double, std::milli>(frameEnd - m_benchmarkStart).count();
+
+        if (vkGetPhysicalDeviceMemoryProperties2KHR)
+            UpdateMemoryUsage();
+    }
+
+    m_frameCount++;
+}
+
+void VKBenchmark::AddTime(Metric metric, double milliseconds)
+{
+    if (!m_enabled || m_frameCount < m_warmupFrames || m_frames.empty())
+        return;
+
+    switch (metric)
+    {
+        case METRIC_ACQUIRE:
+            m_frames.back().AcquireTime += milliseconds;
+            break;
+        case METRIC_PRESENT:
+            m_frames.back().PresentTime += milliseconds;
+            break;
+    }
+}
+
+void VKBenchmark::SetLatency(uint32_t framesAgo, double milliseconds)
+{
+    // The current frame is the last one begun: m_frameCount is only incremented by EndFrame
+    if (!m_enabled || m_frameCount < m_warmupFrames + framesAgo)
+        return;
+
+    size_t frame = m_frameCount - m_warmupFrames - framesAgo;
+    if (frame < m_frames.size())
+        m_frames[frame].Latency = milliseconds;
+}
+
+bool VKBenchmark::GetTimestampCommandBuffers(VkCommandBuffer* beginCmdBuffer, VkCommandBuffer* endCmdBuffer)
+{
+    // Warm-up frames are not measured
+    if (!m_enabled || !m_timestamps.IsSupported() || m_frameTimed || m_frameCount < m_warmupFrames)
+        return false;
+
+    uint32_t slot = m_frameCount % BENCHMARK_QUERY_SLOTS;
+    *beginCmdBuffer = m_beginCmdBuffers[slot];
+    *endCmdBuffer = m_endCmdBuffers[slot];
+
+    m_pendingFrames[slot] = static_cast<int64_t>(m_frames.size()) - 1;
+    m_frameTimed = true;
+
+    return true;
+}
+
+void VKBenchmark::CollectResults()
+{
+    if (!m_timestamps.IsSupported())
+        return;
+
+    for (uint32_t i = 0; i < BENCHMARK_QUERY_SLOTS; i++)
+        ReadBack(i);
+}
+
+void VKBenchmark::ReadBack(uint32_t slot)
+{
+    if (m_pendingFrames[slot] < 0)
+        return;
+
+    // The slot is reused BENCHMARK_QUERY_SLOTS frames after it was submitted, so the wait
+    // is only a safety net: the results are already available at this point.
+    double gpuTime;
+    if (m_timestamps.GetElapsed(slot, true, &gpuTime))
+        m_frames[m_pendingFrames[slot]].GpuTime = gpuTime;
+
+    m_pendingFrames[slot] = -1;
+}
+
+void VKBenchmark::UpdateMemoryUsage()
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2KHR memoryProperties = {};
+    memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR;
+    memoryProperties.pNext = &budgetProperties;
+
+    vkGetPhysicalDeviceMemoryProperties2KHR(m_physicalDevice, &memoryProperties);
+
+    // Only device-local heaps are considered (on integrated GPUs they're usually the whole system memory)
+    VkDeviceSize usage = 0;
+    for (uint32_t i = 0; i < memoryProperties.memoryProperties.memoryHeapCount; i++)
+    {
+        if (memoryProperties.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            usage += budgetProperties.heapUsage[i];
+    }
+
+    m_peakMemoryUsage = std::max(m_peakMemoryUsage, usage);
+}
+
+BenchmarkStats VKBenchmark::GetStats(double BenchmarkFrame::*metric) const
+{
+    BenchmarkStats stats;
+
+    // Negative values are for frames the metric couldn't be measured for
+    std::vector<double> values;
+    values.reserve(m_frames.size());
+    for (const BenchmarkFrame& frame : m_frames)
+    {
+        if (frame.*metric >= 0.0)
+            values.push_back(frame.*metric);
+    }
+
+    if (values.empty())
+        return stats;
+
+    std::sort(values.begin(), values.end());
+
+    double sum = 0.0;
+    for (double value : values)
+        sum += value;
+
+    // Nearest-rank percentiles
+    auto percentile = [&values](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+        return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+    };
+
+    stats.Min = values.front();
+    stats.Max = values.back();
+    stats.Avg = sum / values.size();
+    stats.P50 = percentile(50.0);
+    stats.P95 = percentile(95.0);
+    stats.P99 = percentile(99.0);
+    stats.SampleCount = static_cast<uint32_t>(values.size());
+
+    return stats;
+}
+
+void VKBenchmark::PrintReport(const char* sampleName) const
+{
+    printf("\nBenchmark - %s - %s\n", sampleName, m_deviceName.c_str());
+    printf("%u frames measured (%u warm-up frames), %.1f fps\n",
+        static_cast<uint32_t>(m_frames.size()), m_warmupFrames,
+        m_totalTime > 0.0 ? 1000.0 * m_frames.size() / m_totalTime : 0.0);
+
+    if (vkGetPhysicalDeviceMemoryProperties2KHR)
+        printf("Peak device memory usage: %.2f MB\n", m_peakMemoryUsage / (1024.0 * 1024.0));
+
+    printf("%-12s %10s %10s %10s %10s %10s %10s\n", "(ms)", "min", "avg", "p50", "p95", "p99", "max");
+
+    const char* names[] = { "CPU", "GPU", "Acquire", "Present", "Latency" };
+    double BenchmarkFrame::*metrics[] = { &BenchmarkFrame::CpuTime, &BenchmarkFrame::GpuTime, &BenchmarkFrame::AcquireTime, &BenchmarkFrame::PresentTime, &BenchmarkFrame::Latency };
+
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        BenchmarkStats stats = GetStats(metrics[i]);
+        if (stats.SampleCount == 0)
+            printf("%-12s %10s\n", names[i], "n/a");
+        else
+            printf("%-12s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", names[i], stats.Min, stats.Avg, stats.P50, stats.P95, stats.P99, stats.Max);
+    }
+
+    fflush(stdout);
+}
+
+// Write the statistics of a metric on a single line, so that scripts can easily extract them
+static void WriteStats(FILE* file, const char* name, const BenchmarkStats& stats, bool last)
+{
+    if (stats.SampleCount == 0)
+        fprintf(file, "    \"%s\": null%s\n", name, last ? "" : ",");
+    else
+        fprintf(file, "    \"%s\": { \"min\": %.4f, \"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f }%s\n",
+            name, stats.Min, stats.Avg, stats.P50, stats.P95, stats.P99, stats.Max, last ? "" : ",");
+}
+
+static void WriteFrameValues(FILE* file, const char* name, const std::vector<BenchmarkFrame>& frames, double BenchmarkFrame::*metric, bool last)
+{
+    fprintf(file, "      \"%s\": [", name);
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        if (frames[i].*metric < 0.0)
+            fprintf(file, "%snull", i ? ", " : "");
+        else
+            fprintf(file, "%s%.4f", i ? ", " : "", frames[i].*metric);
+    }
+    fprintf(file, "]%s\n", last ? "" : ",");
+}
+
+bool VKBenchmark::WriteResults(const char* fileName, const char* sampleName) const
+{
+    FILE* file = fopen(fileName, "w");
+    if (!file)
+    {
+        printf("VKBenchmark: cannot write the results to %s\n", fileName);
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "    \"sample\": \"%s\",\n", sampleName);
+    fprintf(file, "    \"device\": \"%s\",\n", m_deviceName.c_str());
+    fprintf(file, "    \"frames\": %u,\n", static_cast<uint32_t>(m_frames.size()));
+    fprintf(file, "    \"warmupFrames\": %u,\n", m_warmupFrames);
+    fprintf(file, "    \"timeStep\": %.6f,\n", BENCHMARK_TIME_STEP);
+    fprintf(file, "    \"fps\": %.2f,\n", m_totalTime > 0.0 ? 1000.0 * m_frames.size() / m_totalTime : 0.0);
+
+    if (vkGetPhysicalDeviceMemoryProperties2KHR)
+        fprintf(file, "    \"peakDeviceMemoryMB\": %.3f,\n", m_peakMemoryUsage / (1024.0 * 1024.0));
+    else
+        fprintf(file, "    \"peakDeviceMemoryMB\": null,\n");
+
+    WriteStats(file, "cpuMs", GetStats(&BenchmarkFrame::CpuTime), false);
+    WriteStats(file, "gpuMs", GetStats(&BenchmarkFrame::GpuTime), false);
+    WriteStats(file, "acquireMs", GetStats(&BenchmarkFrame::AcquireTime), false);
+    WriteStats(file, "presentMs", GetStats(&BenchmarkFrame::PresentTime), false);
+    WriteStats(file, "latencyMs", GetStats(&BenchmarkFrame::Latency), false);
+
+    fprintf(file, "    \"perFrame\": {\n");
+    WriteFrameValues(file, "cpuMs", m_frames, &BenchmarkFrame::CpuTime, false);
+    WriteFrameValues(file, "gpuMs", m_frames, &BenchmarkFrame::GpuTime, false);
+    WriteFrameValues(file, "acquireMs", m_frames, &BenchmarkFrame::AcquireTime, false);
+    WriteFrameValues(file, "presentMs", m_frames, &BenchmarkFrame::PresentTime, false);
+    WriteFrameValues(file, "latencyMs", m_frames, &BenchmarkFrame::Latency, true);
+    fprintf(file, "    }\n");
+    fprintf(file, "}\n");
+
+    fclose(file);
+    printf("Benchmark results written to %s\n", fileName);
+
+    return true;
+}
@@ -0,0 +1,281 @@
+#include "stdafx.h"
+#include "VKDebug.hpp"
+#include "VKBindless.hpp"
+
+VKBindless::VKBindless() :
+    m_device(VK_NULL_HANDLE),
+    m_pool(VK_NULL_HANDLE),
+    m_setLayout(VK_NULL_HANDLE),
+    m_set(VK_NULL_HANDLE),
+    m_sampledImages(),
+    m_storageBuffers()
+{
+}
+
+VKBindless::~VKBindless()
+{
+    Destroy();
+}
+
+bool VKBindless::QuerySupport(VkInstance instance, VkPhysicalDevice physicalDevice,
+                              std::vector<const char*>& deviceExtensions,
+                              VkPhysicalDeviceDescriptorIndexingFeaturesEXT& features)
+{
+    // VK_EXT_descriptor_indexing requires VK_KHR_maintenance3 (both are core in Vulkan 1.2, but the samples target Vulkan 1.0)
+    const char* requiredExtensions[] = { VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, VK_KHR_MAINTENANCE3_EXTENSION_NAME };
+
+    uint32_t extCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, extensions.data());
+
+    for (const char* requiredExtension : requiredExtensions)
+    {
+        if (std::find_if(extensions.begin(), extensions.end(), [requiredExtension](const VkExtensionProperties& ext) { return strcmp(ext.extensionName, requiredExtension) == 0; }) == extensions.end())
+            return false;
+    }
+
+    // The descriptor indexing features are queried through vkGetPhysicalDeviceFeatures2KHR,
+    // which is only available if the instance enabled VK_KHR_get_physical_device_properties2.
+    PFN_vkGetPhysicalDeviceFeatures2KHR vkGetPhysicalDeviceFeatures2KHR =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if (!vkGetPhysicalDeviceFeatures2KHR)
+        return false;
+
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT supportedFeatures = {};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2KHR features2 = {};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features2.pNext = &supportedFeatures;
+    vkGetPhysicalDeviceFeatures2KHR(physicalDevice, &features2);
+
+    // Runtime-sized descriptor arrays in the shaders, elements of the arrays that are never written,
+    // and descriptor updates while the set is bound.
+    // Indices are expected to be dynamically uniform (push constants, for example), so the non-uniform
+    // indexing features are not required.
+    if (!supportedFeatures.runtimeDescriptorArray ||
+        !supportedFeatures.descriptorBindingPartiallyBound ||
+        !supportedFeatures.descriptorBindingSampledImageUpdateAfterBind ||
+        !supportedFeatures.descriptorBindingStorageBufferUpdateAfterBind)
+        return false;
+
+    // Enable the required features only
+    features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    features.runtimeDescriptorArray = VK_TRUE;
+    features.descriptorBindingPartiallyBound = VK_TRUE;
+    features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+
+    for (const char* requiredExtension : requiredExtensions)
+        deviceExtensions.push_back(requiredExtension);
+
+    return true;
+}
+
+void VKBindless::Init(VkInstance instance, VkPhysicalDevice physicalDevice, VkDevice device,
+                      uint32_t maxSampledImages, uint32_t maxStorageBuffers)
+{
+    m_device = device;
+
+    //
+    // Clamp the size of the arrays to the limits on the descriptors of update-after-bind sets.
+    // A combined image sampler counts both as a sampler and as a sampled image.
+    //
+
+    PFN_vkGetPhysicalDeviceProperties2KHR vkGetPhysicalDeviceProperties2KHR =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceProperties2KHR>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceProperties2KHR"));
+    assert(vkGetPhysicalDeviceProperties2KHR);
+
+    VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties = {};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2KHR properties2 = {};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+    properties2.pNext = &indexingProperties;
+    vkGetPhysicalDeviceProperties2KHR(physicalDevice, &properties2);
+
+    maxSampledImages = std::min({ maxSampledImages,
+                                  indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                  indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                                  indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                  indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers });
+    maxStorageBuffers = std::min({ maxStorageBuffers,
+                                   indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                                   indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+
+    // Leave room for the resources of the other sets in maxPerStageUpdateAfterBindResources, if any
+    uint32_t maxResources = indexingProperties.maxPerStageUpdateAfterBindResources;
+    if (maxSampledImages + maxStorageBuffers > maxResources)
+    {
+        maxSampledImages = std::min(maxSampledImages, maxResources / 2);
+        maxStorageBuffers = std::min(maxStorageBuffers, maxResources - maxSampledImages);
+    }
+
+    m_sampledImages = { maxSampledImages, 0, {} };
+    m_storageBuffers = { maxStorageBuffers, 0, {} };
+
+    //
+    // Create the descriptor set layout.
+    // Both arrays are accessible from any stage, can be updated after the set is bound, and may contain
+    // elements that are never written (as long as the shaders don't access them).
+    //
+
+    VkDescriptorSetLayoutBinding layoutBindings[2] = {};
+    layoutBindings[0].binding = BINDLESS_BINDING_SAMPLED_IMAGES;
+    layoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    layoutBindings[0].descriptorCount = m_sampledImages.Size;
+    layoutBindings[0].stageFlags = VK_SHADER_STAGE_ALL;
+
+    layoutBindings[1].binding = BINDLESS_BINDING_STORAGE_BUFFERS;
+    layoutBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBindings[1].descriptorCount = m_storageBuffers.Size;
+    layoutBindings[1].stageFlags = VK_SHADER_STAGE_ALL;
+
+    VkDescriptorBindingFlagsEXT bindingFlags[2] = {
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT
+    };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo = {};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+    bindingFlagsInfo.bindingCount = 2;
+    bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    layoutInfo.bindingCount = 2;
+    layoutInfo.pBindings = layoutBindings;
+    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_setLayout));
+
+    //
+    // Create a pool for the single set, and allocate it
+    //
+
+    VkDescriptorPoolSize poolSizes[2] = {};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSizes[0].descriptorCount = m_sampledImages.Size;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = m_storageBuffers.Size;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 2;
+    poolInfo.pPoolSizes = poolSizes;
+    VK_CHECK_RESULT(vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_pool));
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_pool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_setLayout;
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_device, &allocInfo, &m_set));
+}
+
+void VKBindless::Destroy()
+{
+    if (m_device == VK_NULL_HANDLE)
+        return;
+
+    // Destroying the pool frees the set allocated from it
+    vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+    vkDestroyDescriptorSetLayout(m_device, m_setLayout, nullptr);
+
+    m_pool = VK_NULL_HANDLE;
+    m_setLayout = VK_NULL_HANDLE;
+    m_set = VK_NULL_HANDLE;
+    m_sampledImages = {};
+    m_storageBuffers = {};
+    m_device = VK_NULL_HANDLE;
+}
+
+uint32_t VKBindless::AddSampledImage(const VkDescriptorImageInfo& imageInfo)
+{
+    uint32_t index = AllocateIndex(m_sampledImages);
+    if (index != BINDLESS_INVALID_INDEX)
+        UpdateSampledImage(index, imageInfo);
+    return index;
+}
+
+uint32_t VKBindless::AddStorageBuffer(const VkDescriptorBufferInfo& bufferInfo)
+{
+    uint32_t index = AllocateIndex(m_storageBuffers);
+    if (index != BINDLESS_INVALID_INDEX)
+        UpdateStorageBuffer(index, bufferInfo);
+    return index;
+}
+
+void VKBindless::UpdateSampledImage(uint32_t index, const VkDescriptorImageInfo& imageInfo)
+{
+    assert(index < m_sampledImages.Next);
+    WriteDescriptor(BINDLESS_BINDING_SAMPLED_IMAGES, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, index, &imageInfo, nullptr);
+}
+
+void VKBindless::UpdateStorageBuffer(uint32_t index, const VkDescriptorBufferInfo& bufferInfo)
+{
+    assert(index < m_storageBuffers.Next);
+    WriteDescriptor(BINDLESS_BINDING_STORAGE_BUFFERS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, index, nullptr, &bufferInfo);
+}
+
+void VKBindless::RemoveSampledImage(uint32_t index)
+{
+    FreeIndex(m_sampledImages, index);
+}
+
+void VKBindless::RemoveStorageBuffer(uint32_t index)
+{
+    FreeIndex(m_storageBuffers, index);
+}
+
+void VKBindless::Bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t firstSet) const
+{
+    vkCmdBindDescriptorSets(cmd, bindPoint, layout, firstSet, 1, &m_set, 0, nullptr);
+}
+
+uint32_t VKBindless::AllocateIndex(IndexTable& table)
+{
+    // Reuse the most recently removed index, if any
+    if (!table.FreeIndices.empty())
+    {
+        uint32_t index = table.FreeIndices.back();
+        table.FreeIndices.pop_back();
+        return index;
+    }
+
+    if (table.Next == table.Size)
+    {
+        printf("The bindless descriptor array is full (%u descriptors)!\n", table.Size);
+        return BINDLESS_INVALID_INDEX;
+    }
+
+    return table.Next++;
+}
+
+void VKBindless::FreeIndex(IndexTable& table, uint32_t index)
+{
+    assert(index < table.Next);
+    assert(std::find(table.FreeIndices.begin(), table.FreeIndices.end(), index) == table.FreeIndices.end());
+
+    // The descriptor is left as it is: the array is partially bound, so an element that is not accessed
+    // by the shaders doesn't need to be valid.
+    table.FreeIndices.push_back(index);
+}
+
+void VKBindless::WriteDescriptor(uint32_t binding, VkDescriptorType type, uint32_t index,
+                                 const VkDescriptorImageInfo* imageInfo, const VkDescriptorBufferInfo* bufferInfo)
+{
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.dstSet = m_set;
+    writeDescriptorSet.dstBinding = binding;
+    writeDescriptorSet.dstArrayElement = index;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.descriptorType = type;
+    writeDescriptorSet.pImageInfo = imageInfo;
+    writeDescriptorSet.pBufferInfo = bufferInfo;
+
+    vkUpdateDescriptorSets(m_device, 1, &writeDescriptorSet, 0, nullptr);
+}
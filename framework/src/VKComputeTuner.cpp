@@ -0,0 +1,147 @@
+#include "stdafx.h"
+#include "VKDebug.hpp"
+#include "VKComputeTuner.hpp"
+
+VKComputeTuner::VKComputeTuner() :
+    m_device(VK_NULL_HANDLE),
+    m_queue(VK_NULL_HANDLE),
+    m_commandPool(VK_NULL_HANDLE),
+    m_commandBuffer(VK_NULL_HANDLE),
+    m_fence(VK_NULL_HANDLE)
+{
+}
+
+VKComputeTuner::~VKComputeTuner()
+{
+    Destroy();
+}
+
+void VKComputeTuner::Init(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, uint32_t queueFamilyIndex)
+{
+    m_device = device;
+    m_queue = queue;
+
+    // Command pool, command buffer and fence used for the measurements
+    VkCommandPoolCreateInfo commandPoolInfo = {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    commandPoolInfo.queueFamilyIndex = queueFamilyIndex;
+    VK_CHECK_RESULT(vkCreateCommandPool(m_device, &commandPoolInfo, nullptr, &m_commandPool));
+
+    VkCommandBufferAllocateInfo commandBufferInfo = {};
+    commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferInfo.commandPool = m_commandPool;
+    commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferInfo.commandBufferCount = 1;
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &commandBufferInfo, &m_commandBuffer));
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    VK_CHECK_RESULT(vkCreateFence(m_device, &fenceInfo, nullptr, &m_fence));
+
+    // A pair of timestamp queries, written at the beginning and at the end of a measurement
+    if (!m_timestamps.Init(physicalDevice, device, queueFamilyIndex, 1))
+        printf("VKComputeTuner: timestamps are not supported by queue family %u, the variants can't be measured.\n", queueFamilyIndex);
+}
+
+void VKComputeTuner::Destroy()
+{
+    if (m_device == VK_NULL_HANDLE)
+        return;
+
+    m_timestamps.Destroy();
+    vkDestroyFence(m_device, m_fence, nullptr);
+    vkDestroyCommandPool(m_device, m_commandPool, nullptr);   // Also frees the command buffer
+
+    m_fence = VK_NULL_HANDLE;
+    m_commandPool = VK_NULL_HANDLE;
+    m_commandBuffer = VK_NULL_HANDLE;
+    m_device = VK_NULL_HANDLE;
+}
+
+double VKComputeTuner::Run(const std::function<void(VkCommandBuffer)>& record, uint32_t iterations)
+{
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_commandBuffer, &beginInfo));
+
+    m_timestamps.Begin(m_commandBuffer, 0);
+
+    // Each execution waits for the previous one and sees its writes, as consecutive passes would
+    VkMemoryBarrier memoryBarrier = {};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        if (i > 0)
+            vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                                 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+        record(m_commandBuffer);
+    }
+
+    m_timestamps.End(m_commandBuffer, 0);
+    VK_CHECK_RESULT(vkEndCommandBuffer(m_commandBuffer));
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &m_commandBuffer;
+    VK_CHECK_RESULT(vkQueueSubmit(m_queue, 1, &submitInfo, m_fence));
+    VK_CHECK_RESULT(vkWaitForFences(m_device, 1, &m_fence, VK_TRUE, UINT64_MAX));
+    VK_CHECK_RESULT(vkResetFences(m_device, 1, &m_fence));
+
+    double time;
+    if (!m_timestamps.GetElapsed(0, true, &time))
+        return -1.0;
+
+    return time / iterations;
+}
+
+double VKComputeTuner::Measure(const std::function<void(VkCommandBuffer)>& record, uint32_t iterations)
+{
+    if (!IsSupported() || iterations == 0)
+        return -1.0;
+
+    // The first execution warms up the caches (and the clocks of the GPU), and is not measured
+    Run(record, 1);
+
+    double best = -1.0;
+    for (uint32_t run = 0; run < COMPUTE_TUNER_RUNS; run++)
+    {
+        double time = Run(record, iterations);
+        if (time >= 0.0 && (best < 0.0 || time < best))
+            best = time;
+    }
+
+    return best;
+}
+
+uint32_t VKComputeTuner::SelectFastest(uint32_t variantCount, const std::function<void(VkCommandBuffer, uint32_t)>& record, 
+                                       std::vector<double>* times)
+{
+    if (times)
+        times->assign(variantCount, -1.0);
+
+    if (!IsSupported())
+        return 0;
+
+    uint32_t fastest = 0;
+    double fastestTime = -1.0;
+    for (uint32_t i = 0; i < variantCount; i++)
+    {
+        double time = Measure([&record, i](VkCommandBuffer commandBuffer) { record(commandBuffer, i); });
+        if (times)
+            (*times)[i] = time;
+
+        if (time >= 0.0 && (fastestTime < 0.0 || time < fastestTime))
+        {
+            fastest = i;
+            fastestTime = time;
+        }
+    }
+
+    return fastest;
+}
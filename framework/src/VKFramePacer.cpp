@@ -0,0 +1,241 @@
+#include "stdafx.h"
+#include "VKDebug.hpp"
+#include "VKFramePacer.hpp"
+#include <cmath>
+
+// Number of latencies kept to compute the statistics (the ones of the last frames)
+#define FRAME_PACER_HISTORY 4096
+
+VKFramePacer::VKFramePacer() :
+    m_device(VK_NULL_HANDLE),
+    m_swapchain(VK_NULL_HANDLE),
+    m_framesInFlight(DEFAULT_FRAMES_IN_FLIGHT),
+    m_presentWait(false),
+    vkWaitForPresentKHR(nullptr),
+    m_frameNumber(0),
+    m_lastPresented(0),
+    m_firstOfSwapchain(0),
+    m_latencyCount(0)
+{
+}
+
+VKFramePacer::~VKFramePacer()
+{
+}
+
+bool VKFramePacer::QuerySupport(VkInstance instance, VkPhysicalDevice physicalDevice,
+                                std::vector<const char*>& deviceExtensions,
+                                VkPhysicalDevicePresentIdFeaturesKHR& presentIdFeatures,
+                                VkPhysicalDevicePresentWaitFeaturesKHR& presentWaitFeatures)
+{
+    // VK_KHR_present_wait requires VK_KHR_present_id (and VK_KHR_swapchain, which is always enabled when presenting)
+    const char* requiredExtensions[] = { VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME };
+
+    uint32_t extCount = 0;
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extCount);
+    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, extensions.data());
+
+    for (const char* requiredExtension : requiredExtensions)
+    {
+        if (std::find_if(extensions.begin(), extensions.end(), [requiredExtension](const VkExtensionProperties& ext) { return strcmp(ext.extensionName, requiredExtension) == 0; }) == extensions.end())
+            return false;
+    }
+
+    // The features are queried through vkGetPhysicalDeviceFeatures2KHR,
+    // which is only available if the instance enabled VK_KHR_get_physical_device_properties2.
+    PFN_vkGetPhysicalDeviceFeatures2KHR vkGetPhysicalDeviceFeatures2KHR =
+        reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceFeatures2KHR"));
+    if (!vkGetPhysicalDeviceFeatures2KHR)
+        return false;
+
+    VkPhysicalDevicePresentWaitFeaturesKHR supportedWaitFeatures = {};
+    supportedWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    VkPhysicalDevicePresentIdFeaturesKHR supportedIdFeatures = {};
+    supportedIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    supportedIdFeatures.pNext = &supportedWaitFeatures;
+    VkPhysicalDeviceFeatures2KHR features2 = {};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+    features2.pNext = &supportedIdFeatures;
+    vkGetPhysicalDeviceFeatures2KHR(physicalDevice, &features2);
+
+    if (!supportedIdFeatures.presentId || !supportedWaitFeatures.presentWait)
+        return false;
+
+    presentWaitFeatures = {};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    presentWaitFeatures.presentWait = VK_TRUE;
+
+    presentIdFeatures = {};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+    presentIdFeatures.presentId = VK_TRUE;
+
+    for (const char* requiredExtension : requiredExtensions)
+        deviceExtensions.push_back(requiredExtension);
+
+    return true;
+}
+
+bool VKFramePacer::ParsePresentMode(const char* name, VkPresentModeKHR* presentMode)
+{
+    if (strcmp(name, "fifo") == 0)
+        *presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    else if (strcmp(name, "fifo_relaxed") == 0)
+        *presentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    else if (strcmp(name, "mailbox") == 0)
+        *presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    else if (strcmp(name, "immediate") == 0)
+        *presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    else
+        return false;
+
+    return true;
+}
+
+const char* VKFramePacer::GetPresentModeName(VkPresentModeKHR presentMode)
+{
+    switch (presentMode)
+    {
+        case VK_PRESENT_MODE_FIFO_KHR:          return "fifo";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:  return "fifo_relaxed";
+        case VK_PRESENT_MODE_MAILBOX_KHR:       return "mailbox";
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:     return "immediate";
+        default:                                return "unknown";
+    }
+}
+
+void VKFramePacer::Init(VkDevice device, uint32_t framesInFlight, bool presentWait)
+{
+    m_device = device;
+    m_framesInFlight = framesInFlight;
+    m_presentWait = presentWait;
+    m_frameNumber = 0;
+    m_lastPresented = 0;
+    m_firstOfSwapchain = 0;
+
+    // The input time of a frame is read framesInFlight frames later, when its presentation is waited for
+    m_inputTimes.assign(framesInFlight + 1, std::chrono::steady_clock::time_point());
+    m_latencies.clear();
+    m_latencyCount = 0;
+
+    if (m_presentWait)
+    {
+        vkWaitForPresentKHR = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(device, "vkWaitForPresentKHR"));
+        assert(vkWaitForPresentKHR);
+    }
+}
+
+void VKFramePacer::SetSwapchain(VkSwapchainKHR swapchain)
+{
+    m_swapchain = swapchain;
+
+    // Present IDs are per swapchain: only the frames presented from now on can be waited for
+    m_firstOfSwapchain = m_frameNumber + 1;
+}
+
+double VKFramePacer::ElapsedMs(uint64_t frame) const
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_inputTimes[frame % m_inputTimes.size()]).count();
+}
+
+void VKFramePacer::AddLatency(double latency)
+{
+    // Once the history is full, overwrite the oldest latency
+    if (m_latencies.size() < FRAME_PACER_HISTORY)
+        m_latencies.push_back(latency);
+    else
+        m_latencies[m_latencyCount % FRAME_PACER_HISTORY] = latency;
+
+    m_latencyCount++;
+}
+
+bool VKFramePacer::BeginFrame(uint32_t* framesAgo, double* latency)
+{
+    if (m_device == VK_NULL_HANDLE)
+        return false;
+
+    m_frameNumber++;
+
+    // Wait for the presentation of the frame framesInFlight frames back, if it was actually presented
+    // to the current swapchain (presents can be skipped, for e.g. if the swapchain is out of date).
+    bool measured = false;
+    if (m_presentWait && m_frameNumber > m_framesInFlight)
+    {
+        uint64_t waitFrame = m_frameNumber - m_framesInFlight;
+        if (waitFrame >= m_firstOfSwapchain && waitFrame <= m_lastPresented)
+        {
+            VkResult result = vkWaitForPresentKHR(m_device, m_swapchain, waitFrame, FRAME_PACER_WAIT_TIMEOUT);
+
+            // The presentation of the frame could time out (for e.g. if the window is minimized) or the swapchain
+            // could be out of date: the frame is simply not measured.
+            if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+            {
+                *framesAgo = m_framesInFlight;
+                *latency = ElapsedMs(waitFrame);
+                measured = true;
+            }
+        }
+    }
+
+    // The input of the frame is sampled right after this call
+    m_inputTimes[m_frameNumber % m_inputTimes.size()] = std::chrono::steady_clock::now();
+
+    if (measured)
+        AddLatency(*latency);
+
+    return measured;
+}
+
+void VKFramePacer::ChainPresentId(VkPresentInfoKHR& presentInfo, VkPresentIdKHR& presentId)
+{
+    m_lastPresented = m_frameNumber;
+
+    if (!m_presentWait)
+        return;
+
+    presentId = {};
+    presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    presentId.pNext = presentInfo.pNext;
+    presentId.swapchainCount = 1;
+    presentId.pPresentIds = &m_lastPresented;
+    presentInfo.pNext = &presentId;
+
+    assert(presentInfo.swapchainCount == 1);
+}
+
+bool VKFramePacer::EndFrame(double* latency)
+{
+    if (m_device == VK_NULL_HANDLE || m_presentWait || m_frameNumber == 0)
+        return false;
+
+    *latency = ElapsedMs(m_frameNumber);
+    AddLatency(*latency);
+
+    return true;
+}
+
+void VKFramePacer::PrintReport() const
+{
+    if (m_latencies.empty())
+        return;
+
+    std::vector<double> values(m_latencies);
+    std::sort(values.begin(), values.end());
+
+    double sum = 0.0;
+    for (double value : values)
+        sum += value;
+
+    // Nearest-rank percentiles
+    auto percentile = [&values](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * values.size()));
+        return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+    };
+
+    printf("Latency from input to %s (last %u frames, %u in flight): avg %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms\n",
+           m_presentWait ? "present" : "present call",
+           static_cast<uint32_t>(values.size()), m_framesInFlight,
+           sum / values.size(), percentile(50.0), percentile(95.0), percentile(99.0));
+    fflush(stdout);
+}
@@ -0,0 +1,92 @@
+#include "stdafx.h"
+#include "VKJobSystem.hpp"
+
+VKJobSystem::VKJobSystem() :
+    m_job(nullptr),
+    m_jobCount(0),
+    m_nextJob(0),
+    m_pendingJobs(0),
+    m_quit(false)
+{
+}
+
+VKJobSystem::~VKJobSystem()
+{
+    Destroy();
+}
+
+void VKJobSystem::Init(uint32_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    threadCount = std::min(threadCount, static_cast<uint32_t>(JOB_SYSTEM_MAX_THREADS));
+
+    m_quit = false;
+    for (uint32_t i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&VKJobSystem::WorkerMain, this, i);
+}
+
+void VKJobSystem::Destroy()
+{
+    if (m_threads.empty())
+        return;
+
+    // Wake up the workers and wait for them to exit
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (std::thread& thread : m_threads)
+        thread.join();
+
+    m_threads.clear();
+}
+
+void VKJobSystem::Run(uint32_t jobCount, const std::function<void(uint32_t jobIndex, uint32_t threadIndex)>& job)
+{
+    if (jobCount == 0)
+        return;
+
+    // Publish the batch of jobs and wake up the workers
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_jobCount = jobCount;
+        m_nextJob = 0;
+        m_pendingJobs = jobCount;
+    }
+    m_wakeCondition.notify_all();
+
+    // Wait for all the jobs to complete
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] { return m_pendingJobs == 0; });
+    m_job = nullptr;
+}
+
+void VKJobSystem::WorkerMain(uint32_t threadIndex)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    for (;;)
+    {
+        // Sleep until there is a job to run (or the job system is destroyed)
+        m_wakeCondition.wait(lock, [this] { return m_quit || m_nextJob < m_jobCount; });
+        if (m_quit)
+            return;
+
+        // Take the next job of the batch, and run it without holding the lock.
+        // Jobs are expected to be coarse (e.g. recording a command buffer), so the cost of the lock is negligible.
+        uint32_t jobIndex = m_nextJob++;
+        const std::function<void(uint32_t, uint32_t)>* job = m_job;
+
+        lock.unlock();
+        (*job)(jobIndex, threadIndex);
+        lock.lock();
+
+        if (--m_pendingJobs == 0)
+            m_doneCondition.notify_one();
+    }
+}
@@ -0,0 +1,379 @@
+#include "stdafx.h"
+#include "VKDebug.hpp"
+#include "VKMemoryAllocator.hpp"
+
+// Round value up to the next multiple of alignment (which must be a power of two)
+static VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Check if the last byte of a resource and the first byte of another one lie on the same "page",
+// where pageSize is bufferImageGranularity.
+static bool OnSamePage(VkDeviceSize endA, VkDeviceSize startB, VkDeviceSize pageSize)
+{
+    return ((endA - 1) & ~(pageSize - 1)) == (startB & ~(pageSize - 1));
+}
+
+VKMemoryAllocator::VKMemoryAllocator() :
+    m_device(VK_NULL_HANDLE),
+    m_memoryProperties{},
+    m_limits{},
+    m_blockSize{},
+    m_deviceAllocationCount(0)
+{
+}
+
+VKMemoryAllocator::~VKMemoryAllocator()
+{
+    Destroy();
+}
+
+void VKMemoryAllocator::Init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize)
+{
+    m_device = device;
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memoryProperties);
+    m_limits = deviceProperties.limits;
+
+    // Use smaller blocks for small heaps (for e.g. the 256 MiB device-local, host-visible heap
+    // exposed by many discrete GPUs) so that a single block can't take up most of the heap.
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+    {
+        VkDeviceSize heapSize = m_memoryProperties.memoryHeaps[m_memoryProperties.memoryTypes[i].heapIndex].size;
+        m_blockSize[i] = (heapSize <= 1024ull * 1024 * 1024) ? std::min(blockSize, heapSize / 8) : blockSize;
+    }
+}
+
+void VKMemoryAllocator::Destroy()
+{
+    if (m_device == VK_NULL_HANDLE)
+        return;
+
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; i++)
+    {
+        for (MemoryBlock* block : m_blocks[i])
+        {
+            if (!block->Allocations.empty())
+                printf("VKMemoryAllocator: %zu allocation(s) still alive in memory type %u at destruction!\n", block->Allocations.size(), i);
+
+            DestroyBlock(block);
+        }
+        m_blocks[i].clear();
+    }
+
+    m_device = VK_NULL_HANDLE;
+}
+
+MemoryAllocation VKMemoryAllocator::Allocate(const VkMemoryRequirements& memReqs, VkMemoryPropertyFlags memFlags, bool linear)
+{
+    MemoryAllocation allocation;
+
+    uint32_t memoryTypeIndex = FindMemoryType(memReqs.memoryTypeBits, memFlags);
+    assert(memoryTypeIndex != UINT32_MAX);
+
+    VkDeviceSize size = memReqs.size;
+    VkDeviceSize alignment = std::max<VkDeviceSize>(memReqs.alignment, 1);
+
+    // Ranges of host-visible memory that is not coherent need to be flushed\invalidated explicitly,
+    // and that must be done in multiples of nonCoherentAtomSize. Align them so that flushing a range
+    // never touches the memory of another resource.
+    VkMemoryPropertyFlags typeFlags = m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+    if ((typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        alignment = std::max(alignment, m_limits.nonCoherentAtomSize);
+        size = AlignUp(size, m_limits.nonCoherentAtomSize);
+    }
+
+    MemoryBlock* block = nullptr;
+    VkDeviceSize offset = 0;
+
+    // Large resources get their own device memory object, as they would waste a lot of space
+    // in the blocks (and take a whole block for themselves anyway).
+    if (size > m_blockSize[memoryTypeIndex] / 2)
+    {
+        block = CreateBlock(memoryTypeIndex, size, true);
+        AllocateFromBlock(block, size, alignment, linear, offset);
+    }
+    else
+    {
+        // Search the existing blocks for a free range large enough to hold the resource
+        for (MemoryBlock* b : m_blocks[memoryTypeIndex])
+        {
+            if (!b->Dedicated && AllocateFromBlock(b, size, alignment, linear, offset))
+            {
+                block = b;
+                break;
+            }
+        }
+
+        // No room left: allocate a new block
+        if (!block)
+        {
+            block = CreateBlock(memoryTypeIndex, m_blockSize[memoryTypeIndex], false);
+            bool allocated = AllocateFromBlock(block, size, alignment, linear, offset);
+            assert(allocated);
+        }
+    }
+
+    allocation.Memory = block->Memory;
+    allocation.Offset = offset;
+    allocation.Size = size;
+    allocation.MemoryTypeIndex = memoryTypeIndex;
+    allocation.Block = block;
+    allocation.MappedMemory = block->MappedMemory ? block->MappedMemory + offset : nullptr;
+
+    return allocation;
+}
+
+void VKMemoryAllocator::Free(MemoryAllocation& allocation)
+{
+    MemoryBlock* block = allocation.Block;
+    if (!block)
+        return;
+
+    block->Allocations.erase(allocation.Offset);
+
+    // Give the range back to the free list, merging it with the adjacent free ranges
+    VkDeviceSize offset = allocation.Offset;
+    VkDeviceSize size = allocation.Size;
+
+    auto next = block->FreeRanges.lower_bound(offset);
+    if (next != block->FreeRanges.end() && next->first == offset + size)
+    {
+        size += next->second;
+        next = block->FreeRanges.erase(next);
+    }
+    if (next != block->FreeRanges.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            block->FreeRanges.erase(prev);
+        }
+    }
+    block->FreeRanges[offset] = size;
+
+    // Release dedicated blocks as soon as their resource is gone. Empty blocks are released as well,
+    // but we keep one of them around per memory type to avoid allocating\freeing a block over and over
+    // when a resource is repeatedly created and destroyed.
+    if (block->Allocations.empty())
+    {
+        std::vector<MemoryBlock*>& blocks = m_blocks[block->MemoryTypeIndex];
+        size_t emptyBlocks = std::count_if(blocks.begin(), blocks.end(),
+                                           [](const MemoryBlock* b) { return !b->Dedicated && b->Allocations.empty(); });
+
+        if (block->Dedicated || emptyBlocks > 1)
+        {
+            blocks.erase(std::find(blocks.begin(), blocks.end(), block));
+            DestroyBlock(block);
+        }
+    }
+
+    allocation = MemoryAllocation();
+}
+
+void VKMemoryAllocator::AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags memFlags, MemoryAllocation& allocation)
+{
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(m_device, buffer, &memReqs);
+
+    allocation = Allocate(memReqs, memFlags, true);
+    VK_CHECK_RESULT(vkBindBufferMemory(m_device, buffer, allocation.Memory, allocation.Offset));
+}
+
+void VKMemoryAllocator::AllocateImageMemory(VkImage image, VkMemoryPropertyFlags memFlags, MemoryAllocation& allocation, bool linearTiling)
+{
+    VkMemoryRequirements memReqs;
+    vkGetImageMemoryRequirements(m_device, image, &memReqs);
+
+    allocation = Allocate(memReqs, memFlags, linearTiling);
+    VK_CHECK_RESULT(vkBindImageMemory(m_device, image, allocation.Memory, allocation.Offset));
+}
+
+MemoryStats VKMemoryAllocator::GetStats(uint32_t memoryTypeIndex) const
+{
+    MemoryStats stats;
+    VkDeviceSize freeBytes = 0;
+
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; i++)
+    {
+        if (memoryTypeIndex != UINT32_MAX && memoryTypeIndex != i)
+            continue;
+
+        for (const MemoryBlock* block : m_blocks[i])
+        {
+            stats.BlockCount++;
+            stats.DedicatedBlockCount += block->Dedicated ? 1 : 0;
+            stats.BlockBytes += block->Size;
+            stats.AllocationCount += static_cast<uint32_t>(block->Allocations.size());
+            stats.FreeRangeCount += static_cast<uint32_t>(block->FreeRanges.size());
+
+            for (const auto& alloc : block->Allocations)
+                stats.UsedBytes += alloc.second.Size;
+
+            for (const auto& range : block->FreeRanges)
+            {
+                freeBytes += range.second;
+                stats.LargestFreeRange = std::max(stats.LargestFreeRange, range.second);
+            }
+        }
+    }
+
+    // Free memory split in many small ranges can't hold large resources
+    if (freeBytes > 0)
+        stats.Fragmentation = 1.0f - static_cast<float>(stats.LargestFreeRange) / static_cast<float>(freeBytes);
+
+    return stats;
+}
+
+void VKMemoryAllocator::PrintStats() const
+{
+    const double MiB = 1024.0 * 1024.0;
+
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+    {
+        if (m_blocks[i].empty())
+            continue;
+
+        MemoryStats stats = GetStats(i);
+        printf("Memory type %u (heap %u): %u block(s) (%u dedicated), %.2f MiB allocated, %.2f MiB used by %u resource(s), "
+               "%u free range(s), largest %.2f MiB, fragmentation %.1f%%\n",
+               i, m_memoryProperties.memoryTypes[i].heapIndex,
+               stats.BlockCount, stats.DedicatedBlockCount, stats.BlockBytes / MiB, stats.UsedBytes / MiB, stats.AllocationCount,
+               stats.FreeRangeCount, stats.LargestFreeRange / MiB, stats.Fragmentation * 100.0f);
+    }
+
+    MemoryStats total = GetStats();
+    printf("Device memory: %u vkAllocateMemory call(s) for %u resource(s) (maxMemoryAllocationCount: %u)\n",
+           m_deviceAllocationCount, total.AllocationCount, m_limits.maxMemoryAllocationCount);
+}
+
+MemoryBlock* VKMemoryAllocator::CreateBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated)
+{
+    if (m_deviceAllocationCount >= m_limits.maxMemoryAllocationCount)
+    {
+        printf("VKMemoryAllocator: maxMemoryAllocationCount (%u) exceeded!\n", m_limits.maxMemoryAllocationCount);
+        assert(0);
+    }
+
+    MemoryBlock* block = new MemoryBlock();
+    block->Size = size;
+    block->MemoryTypeIndex = memoryTypeIndex;
+    block->MappedMemory = nullptr;
+    block->Dedicated = dedicated;
+
+    VkMemoryAllocateInfo memAlloc = {};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.allocationSize = size;
+    memAlloc.memoryTypeIndex = memoryTypeIndex;
+    VK_CHECK_RESULT(vkAllocateMemory(m_device, &memAlloc, nullptr, &block->Memory));
+    m_deviceAllocationCount++;
+
+    // Map host-visible blocks once and leave them mapped for their whole lifetime (persistent mapping),
+    // so that resources never need to be mapped\unmapped to update their data.
+    if (m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        VK_CHECK_RESULT(vkMapMemory(m_device, block->Memory, 0, VK_WHOLE_SIZE, 0, (void**)&block->MappedMemory));
+
+    // The whole block is free
+    block->FreeRanges[0] = size;
+
+    m_blocks[memoryTypeIndex].push_back(block);
+    return block;
+}
+
+void VKMemoryAllocator::DestroyBlock(MemoryBlock* block)
+{
+    if (block->MappedMemory)
+        vkUnmapMemory(m_device, block->Memory);
+
+    vkFreeMemory(m_device, block->Memory, nullptr);
+    m_deviceAllocationCount--;
+
+    delete block;
+}
+
+bool VKMemoryAllocator::AllocateFromBlock(MemoryBlock* block, VkDeviceSize size, VkDeviceSize alignment, bool linear, VkDeviceSize& offset)
+{
+    VkDeviceSize granularity = m_limits.bufferImageGranularity;
+
+    auto bestRange = block->FreeRanges.end();
+    VkDeviceSize bestOffset = 0;
+
+    // Best-fit: look for the smallest free range that can hold the resource
+    for (auto range = block->FreeRanges.begin(); range != block->FreeRanges.end(); ++range)
+    {
+        VkDeviceSize rangeStart = range->first;
+        VkDeviceSize rangeEnd = range->first + range->second;
+
+        if (range->second < size)
+            continue;
+
+        VkDeviceSize candidate = AlignUp(rangeStart, alignment);
+
+        // Linear and non-linear resources (buffers and optimal-tiling images) can't share a "page"
+        // of bufferImageGranularity bytes, or they could alias each other on some implementations.
+        // So, if the previous resource in the block is of the other kind, and ends on the same page, move to the next page.
+        if (granularity > 1)
+        {
+            auto prev = block->Allocations.lower_bound(rangeStart);
+            if (prev != block->Allocations.begin())
+            {
+                --prev;
+                if (prev->second.Linear != linear && OnSamePage(prev->first + prev->second.Size, candidate, granularity))
+                    candidate = AlignUp(candidate, granularity);
+            }
+        }
+
+        if (candidate + size > rangeEnd)
+            continue;
+
+        // Likewise, the resource can't end on the page where the next resource of the other kind starts.
+        if (granularity > 1)
+        {
+            auto next = block->Allocations.lower_bound(rangeEnd);
+            if (next != block->Allocations.end() && next->second.Linear != linear && OnSamePage(candidate + size, next->first, granularity))
+                continue;
+        }
+
+        if (bestRange == block->FreeRanges.end() || range->second < bestRange->second)
+        {
+            bestRange = range;
+            bestOffset = candidate;
+        }
+    }
+
+    if (bestRange == block->FreeRanges.end())
+        return false;
+
+    // Split the free range: the padding before the resource (if any) and the space left after it remain free.
+    VkDeviceSize rangeStart = bestRange->first;
+    VkDeviceSize rangeEnd = bestRange->first + bestRange->second;
+    block->FreeRanges.erase(bestRange);
+
+    if (bestOffset > rangeStart)
+        block->FreeRanges[rangeStart] = bestOffset - rangeStart;
+    if (bestOffset + size < rangeEnd)
+        block->FreeRanges[bestOffset + size] = rangeEnd - (bestOffset + size);
+
+    block->Allocations[bestOffset] = { size, linear };
+
+    offset = bestOffset;
+    return true;
+}
+
+uint32_t VKMemoryAllocator::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags memFlags) const
+{
+    for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeBits & (1 << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & memFlags) == memFlags)
+            return i;
+    }
+
+    printf("Could not find a suitable memory type!\n");
+    return UINT32_MAX;
+}
@@ -0,0 +1,155 @@
+#include "stdafx.h"
+#include "VKDebug.hpp"
+#include "VKProfiler.hpp"
+
+VKProfiler::VKProfiler() :
+    m_frameCount(0),
+    m_frameIndex(0),
+    m_enabled(false)
+{
+}
+
+VKProfiler::~VKProfiler()
+{
+    Destroy();
+}
+
+void VKProfiler::Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount)
+{
+    // A pair of timestamp queries for each scope, in each frame slot
+    if (!m_timestamps.Init(physicalDevice, device, queueFamilyIndex, frameCount * PROFILER_MAX_SCOPES))
+    {
+        printf("VKProfiler: timestamps are not supported by queue family %u, GPU profiling disabled.\n", queueFamilyIndex);
+        return;
+    }
+
+    m_frameCount = frameCount;
+    m_enabled = true;
+}
+
+void VKProfiler::Destroy()
+{
+    m_timestamps.Destroy();
+    m_scopes.clear();
+    m_enabled = false;
+}
+
+void VKProfiler::BeginFrame(uint32_t frameIndex)
+{
+    m_frameIndex = frameIndex;
+}
+
+void VKProfiler::BeginScope(VkCommandBuffer cmd, const char* name, VkPipelineStageFlagBits stage)
+{
+    if (!m_enabled)
+        return;
+
+    int scopeIndex = FindScope(name);
+    if (scopeIndex < 0)
+    {
+        if (m_scopes.size() == PROFILER_MAX_SCOPES)
+        {
+            printf("VKProfiler: too many scopes (max %u), %s won't be profiled.\n", PROFILER_MAX_SCOPES, name);
+            return;
+        }
+
+        Scope scope;
+        scope.Name = name;
+        scope.Pending.resize(m_frameCount, false);
+        scope.History.resize(PROFILER_HISTORY_SIZE, 0.0f);
+        scope.HistoryIndex = 0;
+        scope.SampleCount = 0;
+        m_scopes.push_back(scope);
+        scopeIndex = static_cast<int>(m_scopes.size()) - 1;
+    }
+
+    // Read the timestamps written the last time this scope was recorded in the current frame slot
+    // before resetting the queries to reuse them.
+    ReadBack(scopeIndex);
+
+    m_timestamps.Begin(cmd, GetPair(scopeIndex), stage);
+}
+
+void VKProfiler::EndScope(VkCommandBuffer cmd, const char* name, VkPipelineStageFlagBits stage)
+{
+    if (!m_enabled)
+        return;
+
+    int scopeIndex = FindScope(name);
+    if (scopeIndex < 0)
+        return;
+
+    m_timestamps.End(cmd, GetPair(scopeIndex), stage);
+    m_scopes[scopeIndex].Pending[m_frameIndex] = true;
+}
+
+ProfilerStats VKProfiler::GetStats(const char* name) const
+{
+    ProfilerStats stats;
+
+    int scopeIndex = FindScope(name);
+    if (scopeIndex < 0 || m_scopes[scopeIndex].SampleCount == 0)
+        return stats;
+
+    const Scope& scope = m_scopes[scopeIndex];
+    uint32_t count = std::min<uint32_t>(scope.SampleCount, PROFILER_HISTORY_SIZE);
+
+    // Sort a copy of the samples to get min and 99th percentile
+    std::vector<float> samples(scope.History.begin(), scope.History.begin() + count);
+    std::sort(samples.begin(), samples.end());
+
+    float sum = 0.0f;
+    for (float sample : samples)
+        sum += sample;
+
+    stats.Min = samples.front();
+    stats.Avg = sum / count;
+    stats.P99 = samples[(count * 99 + 99) / 100 - 1];
+    stats.Last = scope.History[(scope.HistoryIndex + PROFILER_HISTORY_SIZE - 1) % PROFILER_HISTORY_SIZE];
+    stats.SampleCount = count;
+
+    return stats;
+}
+
+void VKProfiler::PrintReport() const
+{
+    if (!m_enabled)
+        return;
+
+    for (const Scope& scope : m_scopes)
+    {
+        ProfilerStats stats = GetStats(scope.Name.c_str());
+        printf("GPU %-16s min %.3f ms, avg %.3f ms, p99 %.3f ms (last %u frames)\n",
+               scope.Name.c_str(), stats.Min, stats.Avg, stats.P99, stats.SampleCount);
+    }
+}
+
+int VKProfiler::FindScope(const char* name) const
+{
+    for (size_t i = 0; i < m_scopes.size(); i++)
+    {
+        if (m_scopes[i].Name == name)
+            return static_cast<int>(i);
+    }
+
+    return -1;
+}
+
+void VKProfiler::ReadBack(uint32_t scopeIndex)
+{
+    Scope& scope = m_scopes[scopeIndex];
+
+    if (!scope.Pending[m_frameIndex])
+        return;
+
+    scope.Pending[m_frameIndex] = false;
+
+    // Don't wait for the queries: if (for any reason) the timestamps are not available yet we just drop this sample.
+    double elapsed;
+    if (!m_timestamps.GetElapsed(GetPair(scopeIndex), false, &elapsed))
+        return;
+
+    scope.History[scope.HistoryIndex] = static_cast<float>(elapsed);
+    scope.HistoryIndex = (scope.HistoryIndex + 1) % PROFILER_HISTORY_SIZE;
+    scope.SampleCount++;
+}
@@ -2,6 +2,7 @@
 #include "VKApplication.hpp"
 #include "VKSample.hpp"
 #include "VKDebug.hpp"
+#include <fstream>
 
 VKSample::VKSample(unsigned int width, unsigned int height, std::string name) :
     m_width(width),
@@ -39,12 +40,20 @@ void VKSample::CreateInstance()
     appInfo.pEngineName = GetTitle();      // "VK Hello Window"
     appInfo.apiVersion = VK_API_VERSION_1_0;
 
-    // Add platform-specific surface extension.
+    // In headless mode we don't render on the screen, so no surface extension is needed.
+    if (VKApplication::settings.headless)
+    {
+        m_vulkanParams.InstanceExtensions.clear();
+    }
+    else
+    {
+        // Add platform-specific surface extension.
 #if defined(_WIN32)
-    m_vulkanParams.InstanceExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+        m_vulkanParams.InstanceExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
 #elif defined(VK_USE_PLATFORM_XLIB_KHR)
-    m_vulkanParams.InstanceExtensions.push_back(VK_KHR_XLIB_SURFACE_EXTENSION_NAME);
+        m_vulkanParams.InstanceExtensions.push_back(VK_KHR_XLIB_SURFACE_EXTENSION_NAME);
 #endif
+    }
 
     // Add extension supporting validation layers
     if (VKApplication::settings.validation)
@@ -74,6 +83,16 @@ void VKSample::CreateInstance()
     // Enable instance extensions
     EnableInstanceExtensions(m_vulkanParams.InstanceExtensions);
 
+    // In benchmark mode the memory budget of the device is queried through vkGetPhysicalDeviceMemoryProperties2KHR,
+    // and the support for present wait is queried through vkGetPhysicalDeviceFeatures2KHR,
+    // so enable VK_KHR_get_physical_device_properties2 if it's supported (and not already enabled).
+    if ((VKApplication::settings.benchmark || VKApplication::settings.presentWait) &&
+        std::find(extensionNames.begin(), extensionNames.end(), VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) != extensionNames.end() &&
+        std::find_if(m_vulkanParams.InstanceExtensions.begin(), m_vulkanParams.InstanceExtensions.end(), [](const char* ext) { return strcmp(ext, VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) == 0; }) == m_vulkanParams.InstanceExtensions.end())
+    {
+        m_vulkanParams.InstanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+    }
+
     //
     // Create our vulkan instance
     // 
@@ -138,6 +157,10 @@ void VKSample::CreateInstance()
 
 void VKSample::CreateSurface()
 {
+    // There is no window (and so no surface) in headless mode
+    if (VKApplication::settings.headless)
+        return;
+
     VkResult err = VK_SUCCESS;
 
     // Create the os-specific surface
@@ -183,8 +206,10 @@ void VKSample::CreateDevice(VkQueueFlags requestedQueueTypes)
     }
 
     // Select a physical device that provides a queue which support the specified operations (graphics, compute, etc.)
+    // Transfer operations are not checked, as they are implicitly supported by any queue supporting graphics or compute
+    // operations (even if the family doesn't report VK_QUEUE_TRANSFER_BIT). A transfer queue is selected below.
     for (unsigned int i = 0; i < gpuCount; ++i) {
-        if (CheckPhysicalDeviceProperties(physicalDevices[i], requestedQueueTypes, m_vulkanParams)) 
+        if (CheckPhysicalDeviceProperties(physicalDevices[i], requestedQueueTypes & ~VK_QUEUE_TRANSFER_BIT, m_vulkanParams)) 
         {
             m_vulkanParams.PhysicalDevice = physicalDevices[i];
             vkGetPhysicalDeviceProperties(m_vulkanParams.PhysicalDevice, &m_deviceProperties);
@@ -203,6 +228,10 @@ void VKSample::CreateDevice(VkQueueFlags requestedQueueTypes)
         vkGetPhysicalDeviceMemoryProperties(m_vulkanParams.PhysicalDevice, &m_deviceMemoryProperties);
     }
 
+    // The swapchain extension is not needed in headless mode since there is nothing to present
+    if (VKApplication::settings.headless)
+        m_vulkanParams.DeviceExtensions.clear();
+
     // Enable device extensions and features
     EnableDeviceExtensions(m_vulkanParams.DeviceExtensions);
     EnableFeatures(m_vulkanParams.EnabledFeatures);
@@ -225,6 +254,71 @@ void VKSample::CreateDevice(VkQueueFlags requestedQueueTypes)
     queueInfo.pQueuePriorities = queuePriorities;
     queueCreateInfos.push_back(queueInfo);
 
+    // If compute work is requested, look for a queue family that supports compute but not graphics operations.
+    // Queues of such a family usually map to dedicated hardware queues (async compute), so that compute work 
+    // can execute in parallel with the graphics work submitted to the graphics queue.
+    // If there is no such family, the graphics queue (whose family also supports compute) is used.
+    m_vulkanParams.ComputeQueue.FamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+    if (requestedQueueTypes & VK_QUEUE_COMPUTE_BIT)
+    {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanParams.PhysicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanParams.PhysicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+
+        for (uint32_t i = 0; i < queueFamilyCount; ++i)
+        {
+            if ((queueFamilyProperties[i].queueCount > 0) && 
+                (queueFamilyProperties[i].queueFlags & VK_QUEUE_COMPUTE_BIT) && 
+                !(queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
+            {
+                m_vulkanParams.ComputeQueue.FamilyIndex = i;
+                break;
+            }
+        }
+
+        // Request a single queue from the dedicated compute family
+        if (m_vulkanParams.ComputeQueue.FamilyIndex != m_vulkanParams.GraphicsQueue.FamilyIndex)
+        {
+            queueInfo.queueFamilyIndex = m_vulkanParams.ComputeQueue.FamilyIndex;
+            queueCreateInfos.push_back(queueInfo);
+        }
+    }
+
+    // If transfer work is requested, look for a queue family that supports transfer but neither graphics nor compute operations.
+    // Queues of such a family usually map to the DMA engines of the GPU, so that uploads can execute in parallel with 
+    // the work submitted to the other queues. Only families that can copy images at the granularity of a single texel
+    // (minImageTransferGranularity of 1x1x1) are considered, so that any region of an image can be uploaded.
+    // If there is no such family, the graphics queue (whose family implicitly supports transfer) is used.
+    m_vulkanParams.TransferQueue.FamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+    if (requestedQueueTypes & VK_QUEUE_TRANSFER_BIT)
+    {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanParams.PhysicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanParams.PhysicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+
+        for (uint32_t i = 0; i < queueFamilyCount; ++i)
+        {
+            const VkExtent3D& granularity = queueFamilyProperties[i].minImageTransferGranularity;
+            if ((queueFamilyProperties[i].queueCount > 0) && 
+                (queueFamilyProperties[i].queueFlags & VK_QUEUE_TRANSFER_BIT) && 
+                !(queueFamilyProperties[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+                granularity.width == 1 && granularity.height == 1 && granularity.depth == 1)
+            {
+                m_vulkanParams.TransferQueue.FamilyIndex = i;
+                break;
+            }
+        }
+
+        // Request a single queue from the dedicated transfer family
+        if (m_vulkanParams.TransferQueue.FamilyIndex != m_vulkanParams.GraphicsQueue.FamilyIndex)
+        {
+            queueInfo.queueFamilyIndex = m_vulkanParams.TransferQueue.FamilyIndex;
+            queueCreateInfos.push_back(queueInfo);
+        }
+    }
+
     // Get list of supported device extensions
     uint32_t extCount = 0;
     std::vector<std::string> supportedDeviceExtensions;
@@ -252,6 +346,23 @@ void VKSample::CreateDevice(VkQueueFlags requestedQueueTypes)
     deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
     deviceCreateInfo.pEnabledFeatures = &m_vulkanParams.EnabledFeatures;
 
+    // If frame pacing with present wait is requested, enable VK_KHR_present_id and VK_KHR_present_wait (if supported),
+    // and chain their features to the ones enabled by the device create info.
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+    bool presentWait = false;
+    if (VKApplication::settings.presentWait && !VKApplication::settings.headless)
+    {
+        presentWait = VKFramePacer::QuerySupport(m_vulkanParams.Instance, m_vulkanParams.PhysicalDevice, m_vulkanParams.DeviceExtensions, presentIdFeatures, presentWaitFeatures);
+        if (presentWait)
+        {
+            presentWaitFeatures.pNext = const_cast<void*>(deviceCreateInfo.pNext);
+            deviceCreateInfo.pNext = &presentIdFeatures;
+        }
+        else
+            printf("VK_KHR_present_wait is not supported: frames are not paced, and their latency is measured up to the present call.\n");
+    }
+
     // Check that the device extensions we want to enable are supported
     if (m_vulkanParams.DeviceExtensions.size() > 0)
     {
@@ -270,10 +381,23 @@ void VKSample::CreateDevice(VkQueueFlags requestedQueueTypes)
     }
 
     VK_CHECK_RESULT(vkCreateDevice(m_vulkanParams.PhysicalDevice, &deviceCreateInfo, nullptr, &m_vulkanParams.Device));
+
+    // Initialize frame pacing (waiting for presents only if the extensions were enabled above)
+    m_framePacer.Init(m_vulkanParams.Device, m_framesInFlight, presentWait);
+
+    // Create the allocator used to sub-allocate device memory for buffers and images
+    m_memAllocator.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device);
 }
 
 void VKSample::CreateSwapchain(uint32_t* width, uint32_t* height, bool vsync)
 {
+    // In headless mode we render to a ring of offscreen images in place of the swapchain ones
+    if (VKApplication::settings.headless)
+    {
+        CreateHeadlessImages(*width, *height);
+        return;
+    }
+
     // Store the current swap chain handle so we can use it later on to ease up recreation
     VkSwapchainKHR oldSwapchain = m_vulkanParams.SwapChain.Handle;
 
@@ -296,9 +420,17 @@ void VKSample::CreateSwapchain(uint32_t* width, uint32_t* height, bool vsync)
     // This mode waits for the vertical blank ("v-sync").
     VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
 
-    // If v-sync is not requested, try to find a mailbox mode.
+    // If a present mode is requested explicitly (--present-mode), use it if it's supported.
+    if (VKApplication::settings.presentMode != VK_PRESENT_MODE_MAX_ENUM_KHR)
+    {
+        if (std::find(presentModes.begin(), presentModes.end(), VKApplication::settings.presentMode) != presentModes.end())
+            swapchainPresentMode = VKApplication::settings.presentMode;
+        else
+            printf("Present mode %s is not supported by the surface: fifo is used instead.\n", VKFramePacer::GetPresentModeName(VKApplication::settings.presentMode));
+    }
+    // Otherwise, if v-sync is not requested, try to find a mailbox mode.
     // It's the lowest latency non-tearing present mode available.
-    if (!vsync)
+    else if (!vsync)
     {
         for (size_t i = 0; i < presentModeCount; i++)
         {
@@ -316,6 +448,10 @@ void VKSample::CreateSwapchain(uint32_t* width, uint32_t* height, bool vsync)
 
     // Determine the number of images in the swapchain.
     uint32_t desiredNumberOfSwapchainImages = surfCaps.minImageCount + 1;
+
+    // With fewer images than frames in flight, the CPU would block on vkAcquireNextImageKHR rather than on the frame fences.
+    desiredNumberOfSwapchainImages = std::max(desiredNumberOfSwapchainImages, m_framesInFlight);
+
     if ((surfCaps.maxImageCount > 0) && (desiredNumberOfSwapchainImages > surfCaps.maxImageCount))
     {
         desiredNumberOfSwapchainImages = surfCaps.maxImageCount;
@@ -431,6 +567,9 @@ void VKSample::CreateSwapchain(uint32_t* width, uint32_t* height, bool vsync)
 
     VK_CHECK_RESULT(vkCreateSwapchainKHR(m_vulkanParams.Device, &swapchainCI, nullptr, &m_vulkanParams.SwapChain.Handle));
 
+    // Frames are now presented to the new swapchain
+    m_framePacer.SetSwapchain(m_vulkanParams.SwapChain.Handle);
+
     // If an existing swap chain is re-created, destroy the old swap chain.
     // This also cleans up all the presentable images.
     if (oldSwapchain != VK_NULL_HANDLE)
@@ -481,12 +620,27 @@ void VKSample::CreateDepthStencilImage(uint32_t width, uint32_t height)
     VkFormat depthFormat = VK_FORMAT_UNDEFINED;
     VkFormatProperties props;
 
-    // Find the highest precision depth-stencil (combined) format
-    std::vector<VkFormat> depthFormats = {
-        VK_FORMAT_D32_SFLOAT_S8_UINT,
-        VK_FORMAT_D24_UNORM_S8_UINT,
-        VK_FORMAT_D16_UNORM_S8_UINT
-    };
+    // Find the highest precision depth-stencil (combined) format.
+    // Depth-only formats are also accepted, unless the sample uses the stencil buffer.
+    std::vector<VkFormat> depthFormats;
+    if (m_stencilBuffer)
+    {
+        depthFormats = {
+            VK_FORMAT_D32_SFLOAT_S8_UINT,
+            VK_FORMAT_D24_UNORM_S8_UINT,
+            VK_FORMAT_D16_UNORM_S8_UINT
+        };
+    }
+    else
+    {
+        depthFormats = {
+            VK_FORMAT_D32_SFLOAT_S8_UINT,
+            VK_FORMAT_D32_SFLOAT,
+            VK_FORMAT_D24_UNORM_S8_UINT,
+            VK_FORMAT_D16_UNORM_S8_UINT,
+            VK_FORMAT_D16_UNORM
+        };
+    }
 
     VkFormatProperties formatProps;
     for (auto& format : depthFormats)
@@ -522,21 +676,9 @@ void VKSample::CreateDepthStencilImage(uint32_t width, uint32_t height)
         imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         VK_CHECK_RESULT(vkCreateImage(m_vulkanParams.Device, &imageCreateInfo, nullptr, &m_vulkanParams.DepthStencilImage.Handle));
 
-        // Used to request an allocation of a specific size from a certain memory type.
-        VkMemoryAllocateInfo memAlloc = {};
-        memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        VkMemoryRequirements memReqs;
-
-        // Request a memory allocation from local device memory that is large enough to hold the depth-stencil image.
-        vkGetImageMemoryRequirements(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, &memReqs);
-        memAlloc.allocationSize = memReqs.size;
-        memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_deviceMemoryProperties);
-        VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vulkanParams.DepthStencilImage.Memory));
-
-        // Bind the image object to the backing local device memory just allocated.
-        VK_CHECK_RESULT(vkBindImageMemory(m_vulkanParams.Device, 
-                                            m_vulkanParams.DepthStencilImage.Handle, 
-                                            m_vulkanParams.DepthStencilImage.Memory, 0));
+        // Sub-allocate local device memory that is large enough to hold the depth-stencil image, 
+        // and bind it to the image object.
+        m_memAllocator.AllocateImageMemory(m_vulkanParams.DepthStencilImage.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vulkanParams.DepthStencilImage.Allocation);
 
         //
         // Create a depth-stencil image view
@@ -569,6 +711,10 @@ void VKSample::CreateRenderPass()
 {
     // This example will use a single render pass with one subpass
 
+    // The depth-stencil attachment (and its subpass dependency) is only used 
+    // by the samples that created a depth-stencil image.
+    bool depthStencil = (m_vulkanParams.DepthStencilImage.View != VK_NULL_HANDLE);
+
     // Descriptors for the attachments used by this renderpass
     std::array<VkAttachmentDescription, 2> attachments = {};
 
@@ -582,14 +728,21 @@ void VKSample::CreateRenderPass()
     attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;                       // Layout at render pass start. Initial doesn't matter, so we use undefined
     attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;                   // Layout to which the attachment is transitioned when the render pass is finished
                                                                                     // As we want to present the color attachment, we transition to PRESENT_KHR
+    if (VKApplication::settings.headless)                                           // In headless mode there is nothing to present, so we transition 
+        attachments[0].finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;          // to a layout suitable to read the color attachment back
 
     // Depth-stencil attachment
     attachments[1].format = m_vulkanParams.DepthStencilImage.Format;                // Use the format selected for the depth-stencil image
     attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;                                 // We don't use multi sampling in this example
     attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;                            // Clear this attachment at the start of the render pass
     attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;                      // Discard its contents after the render pass is finished
-    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;                     // Similar to loadOp, but for stenciling
-    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;                   // Similar to storeOp, but for stenciling
+    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;                 // Similar to loadOp, but for stenciling
+    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;               // Similar to storeOp, but for stenciling
+    if (m_stencilBuffer)                                                            // If the sample uses the stencil buffer, clear it at the start of the render pass
+    {                                                                               // and keep its contents after the render pass is finished
+        attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+    }
     attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;                       // Layout at render pass start. Initial doesn't matter, so we use undefined
     attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;  // Layout to which the attachment is transitioned when the render pass is finished
 
@@ -609,7 +762,7 @@ void VKSample::CreateRenderPass()
     subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpassDescription.colorAttachmentCount = 1;                            // Subpass uses one color attachment
     subpassDescription.pColorAttachments = &colorReference;                 // Reference to the color attachment in slot 0
-    subpassDescription.pDepthStencilAttachment = &depthReference;           // Reference to the depth-stencil attachment in slot 1
+    subpassDescription.pDepthStencilAttachment = depthStencil ? &depthReference : nullptr; // Reference to the depth-stencil attachment in slot 1
     subpassDescription.inputAttachmentCount = 0;                            // Input attachments can be used to sample from contents of a previous subpass
     subpassDescription.pInputAttachments = nullptr;                         // (Input attachments not used by this sample)
     subpassDescription.preserveAttachmentCount = 0;                         // Preserved attachments can be used to loop (and preserve) attachments through subpasses
@@ -640,11 +793,11 @@ void VKSample::CreateRenderPass()
     // Create the render pass object
     VkRenderPassCreateInfo renderPassInfo = {};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());  // Number of attachments used by this render pass
+    renderPassInfo.attachmentCount = depthStencil ? 2 : 1;                       // Number of attachments used by this render pass
     renderPassInfo.pAttachments = attachments.data();                            // Descriptions of the attachments used by the render pass
     renderPassInfo.subpassCount = 1;                                             // We only use one subpass in this example
     renderPassInfo.pSubpasses = &subpassDescription;                             // Description of that subpass
-    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size()); // Number of subpass dependencies
+    renderPassInfo.dependencyCount = depthStencil ? 2 : 1;                       // Number of subpass dependencies
     renderPassInfo.pDependencies = dependencies.data();                          // Subpass dependencies used by the render pass
 
     VK_CHECK_RESULT(vkCreateRenderPass(m_vulkanParams.Device, &renderPassInfo, nullptr, &m_sampleParams.RenderPass));
@@ -653,13 +806,13 @@ void VKSample::CreateRenderPass()
 void VKSample::CreateFrameBuffers()
 {
     VkImageView attachments[2] = {};
-    attachments[1] = m_vulkanParams.DepthStencilImage.View; // Depth-stemcil view\attachment is the same for each framebuffer
+    attachments[1] = m_vulkanParams.DepthStencilImage.View; // Depth-stencil view\attachment (if any) is the same for each framebuffer
 
     VkFramebufferCreateInfo frameBufferCreateInfo = {};
     frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
     frameBufferCreateInfo.pNext = NULL;
     frameBufferCreateInfo.renderPass = m_sampleParams.RenderPass;
-    frameBufferCreateInfo.attachmentCount = 2;
+    frameBufferCreateInfo.attachmentCount = (attachments[1] != VK_NULL_HANDLE) ? 2 : 1;
     frameBufferCreateInfo.pAttachments = attachments;
     frameBufferCreateInfo.width = m_width;
     frameBufferCreateInfo.height = m_height;
@@ -685,23 +838,23 @@ void VKSample::AllocateCommandBuffers()
         VK_CHECK_RESULT(vkCreateCommandPool(m_vulkanParams.Device, &cmdPoolInfo, nullptr, &m_sampleParams.CommandPool));
     }
 
-    // Create one command buffer for each swap chain image
-    m_sampleParams.FrameRes.CommandBuffers.resize(MAX_FRAME_LAG);
+    // Create one command buffer for each frame in flight
+    m_sampleParams.FrameRes.CommandBuffers.resize(m_framesInFlight);
 
     VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
     commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     commandBufferAllocateInfo.commandPool = m_sampleParams.CommandPool;
     commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, m_sampleParams.FrameRes.CommandBuffers.data()));
 }
 
 void VKSample::CreateSynchronizationObjects()
 {
-    m_sampleParams.FrameRes.ImageAvailableSemaphores.resize(MAX_FRAME_LAG);
-    m_sampleParams.FrameRes.RenderingCompleteSemaphores.resize(MAX_FRAME_LAG);
-    m_sampleParams.FrameRes.Fences.resize(MAX_FRAME_LAG);
+    m_sampleParams.FrameRes.ImageAvailableSemaphores.resize(m_framesInFlight);
+    m_sampleParams.FrameRes.RenderingCompleteSemaphores.resize(m_framesInFlight);
+    m_sampleParams.FrameRes.Fences.resize(m_framesInFlight);
 
     // Create semaphores to synchronize acquiring presentable images before rendering and 
     // waiting for drawing to be complete before presenting
@@ -714,7 +867,7 @@ void VKSample::CreateSynchronizationObjects()
     fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create an unsignaled semaphore
         VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleParams.FrameRes.ImageAvailableSemaphores[i]));
@@ -727,15 +880,290 @@ void VKSample::CreateSynchronizationObjects()
     }
 }
 
-void VKSample::EnableInstanceExtensions(std::vector<const char*>& instanceExtensions)
+void VKSample::EnableInstanceExtensions(std::vector<const char*>& /*instanceExtensions*/)
 { }
 
-void VKSample::EnableDeviceExtensions(std::vector<const char*>& deviceExtensions)
+void VKSample::EnableDeviceExtensions(std::vector<const char*>& /*deviceExtensions*/)
 { }
 
-void VKSample::EnableFeatures(VkPhysicalDeviceFeatures& features)
+void VKSample::EnableFeatures(VkPhysicalDeviceFeatures& /*features*/)
 { }
 
+void VKSample::CreateHeadlessImages(uint32_t width, uint32_t height)
+{
+    // Destroy the previous offscreen images, if any (for e.g. on window resize)
+    for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
+    {
+        vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+        vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+        m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+    }
+    m_vulkanParams.SwapChain.Images.clear();
+    // One image more than the frames in flight (see AcquireNextImage)
+    m_vulkanParams.SwapChain.Images.resize(m_framesInFlight + 1);
+    m_headlessImageIndex = 0;
+
+    // Four-component, 32-bit unsigned normalized format with 8 bits per component.
+    // Support for this format as color attachment is mandatory, so there is no need to check it.
+    m_vulkanParams.SwapChain.Format = VK_FORMAT_R8G8B8A8_UNORM;
+    m_vulkanParams.SwapChain.Extent = { width, height };
+
+    // The offscreen images are used as color attachments, and can be copied back (for e.g. to take a screenshot)
+    VkImageCreateInfo imageCreateInfo = {};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.format = m_vulkanParams.SwapChain.Format;
+    imageCreateInfo.extent = {width, height, 1};
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = 1;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
+    {
+        ImageParameters& image = m_vulkanParams.SwapChain.Images[i];
+        VK_CHECK_RESULT(vkCreateImage(m_vulkanParams.Device, &imageCreateInfo, nullptr, &image.Handle));
+
+        // Sub-allocate local device memory that is large enough to hold the image, and bind it to the image object.
+        m_memAllocator.AllocateImageMemory(image.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image.Allocation);
+
+        // Create an image view, as we do for the swapchain images
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image.Handle;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = m_vulkanParams.SwapChain.Format;
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        VK_CHECK_RESULT(vkCreateImageView(m_vulkanParams.Device, &viewInfo, nullptr, &image.View));
+    }
+}
+
+VkResult VKSample::AcquireNextImage(uint64_t timeout, VkSemaphore semaphore, VkFence fence, uint32_t* imageIndex)
+{
+    // In benchmark mode, measure the time spent waiting for an image to render to
+    VKBenchmarkScope benchmarkScope(m_benchmark, VKBenchmark::METRIC_ACQUIRE);
+
+    if (!VKApplication::settings.headless)
+        return vkAcquireNextImageKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, timeout, semaphore, fence, imageIndex);
+
+    // In headless mode the offscreen images are used in a round-robin fashion.
+    // There is always one image more than the frames in flight, and the fence signaled by a 
+    // submission also guarantees the completion of all the previous ones, so the image returned 
+    // is no longer in use once the sample waited for the fence of the current frame.
+    *imageIndex = m_headlessImageIndex;
+    m_headlessImageIndex = (m_headlessImageIndex + 1) % static_cast<uint32_t>(m_vulkanParams.SwapChain.Images.size());
+
+    // Signal the semaphore (and the fence) as the presentation engine would do, 
+    // so that the sample can wait on it before rendering as usual.
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.signalSemaphoreCount = (semaphore != VK_NULL_HANDLE) ? 1 : 0;
+    submitInfo.pSignalSemaphores = &semaphore;
+    return vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, fence);
+}
+
+VkResult VKSample::QueuePresent(VkQueue queue, const VkPresentInfoKHR* presentInfo)
+{
+    // In benchmark mode, measure the time spent queuing the image for presentation
+    VKBenchmarkScope benchmarkScope(m_benchmark, VKBenchmark::METRIC_PRESENT);
+
+    VkResult result;
+    if (!VKApplication::settings.headless)
+    {
+        // Tag the present with the number of the frame, so that its presentation can be waited for (see BeginFramePacing)
+        VkPresentInfoKHR pacedPresentInfo = *presentInfo;
+        VkPresentIdKHR presentId;
+        m_framePacer.ChainPresentId(pacedPresentInfo, presentId);
+
+        result = vkQueuePresentKHR(queue, &pacedPresentInfo);
+    }
+    else
+    {
+        // In headless mode there is nothing to present, but we still need to wait on the semaphores 
+        // the presentation engine would wait on, so that they are unsignaled before being reused.
+        std::vector<VkPipelineStageFlags> waitStageMasks(presentInfo->waitSemaphoreCount, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount = presentInfo->waitSemaphoreCount;
+        submitInfo.pWaitSemaphores = presentInfo->pWaitSemaphores;
+        submitInfo.pWaitDstStageMask = waitStageMasks.data();
+        result = vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE);
+    }
+
+    // Without present wait, the latency of the frame is measured up to here
+    double latency;
+    if (m_framePacer.EndFrame(&latency))
+        m_benchmark.SetLatency(0, latency);
+
+    return result;
+}
+
+void VKSample::BeginFramePacing()
+{
+    // Wait for the presentation of the frame m_framesInFlight frames back (with present wait), 
+    // and record its latency in benchmark mode.
+    uint32_t framesAgo;
+    double latency;
+    if (m_framePacer.BeginFrame(&framesAgo, &latency))
+        m_benchmark.SetLatency(framesAgo, latency);
+}
+
+VkResult VKSample::QueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence)
+{
+    // The GPU time of a frame is measured on the graphics queue only
+    VkCommandBuffer beginCmdBuffer, endCmdBuffer;
+    if (submitCount == 0 || queue != m_vulkanParams.GraphicsQueue.Handle || 
+        !m_benchmark.GetTimestampCommandBuffers(&beginCmdBuffer, &endCmdBuffer))
+    {
+        return vkQueueSubmit(queue, submitCount, submits, fence);
+    }
+
+    // Add a command buffer writing a timestamp before the command buffers of the first batch,
+    // and another one writing a timestamp after the command buffers of the last batch.
+    std::vector<VkSubmitInfo> timedSubmits(submits, submits + submitCount);
+
+    std::vector<VkCommandBuffer> firstCmdBuffers(submits[0].pCommandBuffers, submits[0].pCommandBuffers + submits[0].commandBufferCount);
+    firstCmdBuffers.insert(firstCmdBuffers.begin(), beginCmdBuffer);
+
+    std::vector<VkCommandBuffer> lastCmdBuffers;
+    if (submitCount == 1)
+    {
+        firstCmdBuffers.push_back(endCmdBuffer);
+    }
+    else
+    {
+        lastCmdBuffers.assign(submits[submitCount - 1].pCommandBuffers, submits[submitCount - 1].pCommandBuffers + submits[submitCount - 1].commandBufferCount);
+        lastCmdBuffers.push_back(endCmdBuffer);
+        timedSubmits[submitCount - 1].commandBufferCount = static_cast<uint32_t>(lastCmdBuffers.size());
+        timedSubmits[submitCount - 1].pCommandBuffers = lastCmdBuffers.data();
+    }
+
+    timedSubmits[0].commandBufferCount = static_cast<uint32_t>(firstCmdBuffers.size());
+    timedSubmits[0].pCommandBuffers = firstCmdBuffers.data();
+
+    return vkQueueSubmit(queue, submitCount, timedSubmits.data(), fence);
+}
+
+void VKSample::BeginBenchmark()
+{
+    // Advance the simulation by the same amount of time at every frame, so that every run renders the same frames
+    m_timer.SetFixedTimeStep(true);
+    m_timer.SetTargetElapsedSeconds(BENCHMARK_TIME_STEP);
+    m_timer.ResetElapsedTime();
+
+    m_benchmark.Init(m_vulkanParams.Instance, m_vulkanParams.PhysicalDevice, m_vulkanParams.Device, 
+                     m_vulkanParams.GraphicsQueue.FamilyIndex, VKApplication::settings.warmupFrames);
+}
+
+void VKSample::EndBenchmark()
+{
+    if (!m_benchmark.IsEnabled())
+        return;
+
+    // Wait for the GPU to complete the last frames, so that their GPU times can be read back
+    vkDeviceWaitIdle(m_vulkanParams.Device);
+    m_benchmark.CollectResults();
+
+    m_benchmark.PrintReport(GetTitle());
+    if (!VKApplication::settings.benchmarkOutput.empty())
+        m_benchmark.WriteResults(VKApplication::settings.benchmarkOutput.c_str(), GetTitle());
+
+    m_benchmark.Destroy();
+}
+
+void VKSample::CreatePipelineCache()
+{
+    // Try to initialize the pipeline cache with the data saved by a previous run.
+    // This way, the driver can skip the compilation of the pipelines it has already seen.
+    std::string cacheFile = GetAssetsPath() + "/" + PIPELINE_CACHE_FILE;
+    std::vector<char> cacheData;
+    
+    std::ifstream is(cacheFile, std::ios::binary | std::ios::in | std::ios::ate);
+
+    if (is.is_open())
+    {
+        cacheData.resize(static_cast<size_t>(is.tellg()));
+        is.seekg(0, std::ios::beg);
+        is.read(cacheData.data(), cacheData.size());
+        is.close();
+    }
+
+    // Pipeline cache data begins with a header that identifies the device and driver that created it:
+    //
+    // uint32_t    length in bytes of the header
+    // uint32_t    VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+    // uint32_t    vendor ID
+    // uint32_t    device ID
+    // uint8_t     pipeline cache UUID [VK_UUID_SIZE]
+    //
+    // Data created by a different device or driver version can't be reused (and not all drivers
+    // validate it), so we only use it if the header matches the properties of the physical device.
+    const size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+    m_warmPipelineCache = false;
+
+    if (cacheData.size() >= headerSize)
+    {
+        uint32_t header[4];
+        memcpy(header, cacheData.data(), sizeof(header));
+
+        m_warmPipelineCache = header[0] >= headerSize &&
+                              header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                              header[2] == m_deviceProperties.vendorID &&
+                              header[3] == m_deviceProperties.deviceID &&
+                              memcmp(cacheData.data() + sizeof(header), m_deviceProperties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    if (!cacheData.empty() && !m_warmPipelineCache)
+        printf("Discarding %s: it was created by a different device or driver.\n", cacheFile.c_str());
+
+    // Create the pipeline cache (empty if no valid data was found on disk)
+    VkPipelineCacheCreateInfo pipelineCacheInfo = {};
+    pipelineCacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheInfo.initialDataSize = m_warmPipelineCache ? cacheData.size() : 0;
+    pipelineCacheInfo.pInitialData = m_warmPipelineCache ? cacheData.data() : nullptr;
+    VK_CHECK_RESULT(vkCreatePipelineCache(m_vulkanParams.Device, &pipelineCacheInfo, nullptr, &m_pipelineCache));
+
+    // Start measuring the time spent creating the pipeline objects
+    m_pipelineCreationStart = std::chrono::steady_clock::now();
+}
+
+void VKSample::ReportPipelineCreationTime()
+{
+    // Compare this value between the first run (cold start) and the following ones (warm start)
+    // to see how much the pipeline cache saved.
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_pipelineCreationStart;
+    printf("Pipeline objects created in %.2f ms (%s start)\n", elapsed.count(), m_warmPipelineCache ? "warm" : "cold");
+}
+
+void VKSample::DestroyPipelineCache()
+{
+    if (m_pipelineCache == VK_NULL_HANDLE)
+        return;
+
+    // Retrieve the data of the pipeline cache (header included), and save it to disk for the next run
+    size_t dataSize = 0;
+    VK_CHECK_RESULT(vkGetPipelineCacheData(m_vulkanParams.Device, m_pipelineCache, &dataSize, nullptr));
+    std::vector<char> cacheData(dataSize);
+    VK_CHECK_RESULT(vkGetPipelineCacheData(m_vulkanParams.Device, m_pipelineCache, &dataSize, cacheData.data()));
+
+    std::string cacheFile = GetAssetsPath() + "/" + PIPELINE_CACHE_FILE;
+    std::ofstream os(cacheFile, std::ios::binary | std::ios::out | std::ios::trunc);
+
+    if (os.is_open())
+    {
+        os.write(cacheData.data(), dataSize);
+        os.close();
+    }
+    else
+        printf("Could not save the pipeline cache to %s\n", cacheFile.c_str());
+
+    vkDestroyPipelineCache(m_vulkanParams.Device, m_pipelineCache, nullptr);
+    m_pipelineCache = VK_NULL_HANDLE;
+}
+
 void VKSample::WindowResize(uint32_t width, uint32_t height)
 {
     if (!m_initialized)
@@ -749,13 +1177,16 @@ void VKSample::WindowResize(uint32_t width, uint32_t height)
     // Recreate swap chain
     m_width = width;
     m_height = height;
-    CreateSwapchain(&m_width, &m_height, false);
+    CreateSwapchain(&m_width, &m_height, VKApplication::settings.vsync);
 
-    // Recreate Depth-stencil image
-    vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
-    vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
-    CreateDepthStencilImage(m_width, m_height);
+    // Recreate Depth-stencil image (if the sample uses one)
+    if (m_vulkanParams.DepthStencilImage.View != VK_NULL_HANDLE)
+    {
+        vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
+        m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
+        vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
+        CreateDepthStencilImage(m_width, m_height);
+    }
 
     // Recreate the frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -778,4 +1209,69 @@ void VKSample::WindowResize(uint32_t width, uint32_t height)
     OnResize();
 
     m_initialized = true;
-}
\ No newline at end of file
+}
+
+void VKSample::CreateThreadCommandPools()
+{
+    // Command pools are externally synchronized, so each thread needs its own pool.
+    // Also, a pool can only be reset when the GPU has finished executing all the command buffers 
+    // allocated from it, so each thread has a pool for each frame in flight.
+    // Secondary command buffers are re-recorded every frame, so they are allocated from transient pools
+    // that are reset as a whole (cheaper than resetting the command buffers individually).
+    m_threadCommandPools.resize(m_jobSystem.GetThreadCount());
+
+    VkCommandPoolCreateInfo cmdPoolInfo = {};
+    cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolInfo.queueFamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+    cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+    for (std::vector<ThreadCommandPool>& threadPools : m_threadCommandPools)
+    {
+        threadPools.resize(m_framesInFlight);
+        for (ThreadCommandPool& pool : threadPools)
+            VK_CHECK_RESULT(vkCreateCommandPool(m_vulkanParams.Device, &cmdPoolInfo, nullptr, &pool.Handle));
+    }
+}
+
+void VKSample::DestroyThreadCommandPools()
+{
+    // Destroying a command pool frees all the command buffers allocated from it
+    for (std::vector<ThreadCommandPool>& threadPools : m_threadCommandPools)
+    {
+        for (ThreadCommandPool& pool : threadPools)
+            vkDestroyCommandPool(m_vulkanParams.Device, pool.Handle, nullptr);
+    }
+
+    m_threadCommandPools.clear();
+}
+
+void VKSample::ResetThreadCommandPools()
+{
+    // Must be called after waiting for the fence of the current frame, and before the worker threads start recording.
+    for (std::vector<ThreadCommandPool>& threadPools : m_threadCommandPools)
+    {
+        VK_CHECK_RESULT(vkResetCommandPool(m_vulkanParams.Device, threadPools[m_frameIndex].Handle, 0));
+        threadPools[m_frameIndex].UsedCount = 0;
+    }
+}
+
+VkCommandBuffer VKSample::GetSecondaryCommandBuffer(uint32_t threadIndex)
+{
+    // Only called by the worker thread threadIndex, so no lock is needed to access its pools
+    ThreadCommandPool& pool = m_threadCommandPools[threadIndex][m_frameIndex];
+
+    if (pool.UsedCount == pool.SecondaryCommandBuffers.size())
+    {
+        VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+        commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferAllocateInfo.commandPool = pool.Handle;
+        commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        commandBufferAllocateInfo.commandBufferCount = 1;
+
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, &cmd));
+        pool.SecondaryCommandBuffers.push_back(cmd);
+    }
+
+    return pool.SecondaryCommandBuffers[pool.UsedCount++];
+}
@@ -28,9 +28,10 @@ bool CheckPhysicalDeviceProperties(
         }
     }
 
-    std::vector<const char*> deviceExtensions = {
-      VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
+    // The swapchain extension is only required if there is a surface to present to (that is, not in headless mode)
+    std::vector<const char*> deviceExtensions;
+    if (vulkan_param.PresentationSurface != VK_NULL_HANDLE)
+        deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
 
     // Check that the device extensions we want to enable are supported
     if (deviceExtensions.size() > 0)
@@ -64,10 +65,14 @@ bool CheckPhysicalDeviceProperties(
     for (uint32_t i = 0; i < queueFamilyCount; ++i) {
 
         // Query if presentation is supported on a specific surface
-        vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, vulkan_param.PresentationSurface, &queuePresentSupport[i]);
+        // (in headless mode there is no surface, so any queue family will do)
+        if (vulkan_param.PresentationSurface != VK_NULL_HANDLE)
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, vulkan_param.PresentationSurface, &queuePresentSupport[i]);
+        else
+            queuePresentSupport[i] = VK_TRUE;
 
-        // Check if the queue family support the specified operations (graphics, compute, etc.)
-        if ((queueFamilyProperties[i].queueCount > 0) && (queueFamilyProperties[i].queueFlags & requestedQueueTypes))
+        // Check if the queue family support all the specified operations (graphics, compute, etc.)
+        if ((queueFamilyProperties[i].queueCount > 0) && ((queueFamilyProperties[i].queueFlags & requestedQueueTypes) == requestedQueueTypes))
         {
             // If the queue family also supports presentation on our surface, prefer it
             if (queuePresentSupport[i])
@@ -203,15 +208,19 @@ void TransitionImageLayout(VkCommandBuffer cmd,
 
 void SetBufferMemoryBarrier(VkCommandBuffer cmd, 
                             VkBuffer buffer, VkDeviceSize size, VkDeviceSize offset, 
-                            VkAccessFlagBits srcAccessMask, VkPipelineStageFlags srcStages, 
-                            VkAccessFlagBits dstAccessMask, VkPipelineStageFlags dstStages)
+                            VkAccessFlags srcAccessMask, VkPipelineStageFlags srcStages, 
+                            VkAccessFlags dstAccessMask, VkPipelineStageFlags dstStages,
+                            uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex)
 {
+    // If srcQueueFamilyIndex and dstQueueFamilyIndex differ, the barrier defines a queue family ownership transfer:
+    // it must be recorded as a release operation on a queue of the source family, and as a matching acquire operation 
+    // on a queue of the destination family.
     VkBufferMemoryBarrier bufferMemoryBarrier = {};
     bufferMemoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
     bufferMemoryBarrier.srcAccessMask = srcAccessMask;
     bufferMemoryBarrier.dstAccessMask = dstAccessMask;
-    bufferMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    bufferMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferMemoryBarrier.srcQueueFamilyIndex = srcQueueFamilyIndex;
+    bufferMemoryBarrier.dstQueueFamilyIndex = dstQueueFamilyIndex;
     bufferMemoryBarrier.buffer = buffer;
     bufferMemoryBarrier.size = size;
     bufferMemoryBarrier.offset = offset;
@@ -219,61 +228,32 @@ void SetBufferMemoryBarrier(VkCommandBuffer cmd,
     vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0, 0, NULL, 1, &bufferMemoryBarrier, 0, NULL);
 }
 
-void CreateBuffer(VkDevice device, 
+void CreateBuffer(VKMemoryAllocator& allocator, 
                     VkBufferCreateInfo bufferInfo, 
                     BufferParameters& bufParams, 
-                    VkMemoryPropertyFlags memFlags,
-                    VkPhysicalDeviceMemoryProperties devMemProps)
+                    VkMemoryPropertyFlags memFlags)
 {
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-
-    VK_CHECK_RESULT(vkCreateBuffer(device, &bufferInfo, nullptr, &bufParams.Handle));
-
-    // Request a memory allocation from device memory that is large enough to hold the buffer.
-    vkGetBufferMemoryRequirements(device, bufParams.Handle, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, memFlags, devMemProps);
-    VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &bufParams.Memory));
+    VK_CHECK_RESULT(vkCreateBuffer(allocator.GetDevice(), &bufferInfo, nullptr, &bufParams.Handle));
 
-    // Map device memory just allocated (it only works if space is allocated in host-visible device memory).
-    // Leave it mapped so that we don't have to map and unmap it every time we want to update the buffer data.
-    VK_CHECK_RESULT(vkMapMemory(device, bufParams.Memory, 0, memAlloc.allocationSize, 0, &bufParams.MappedMemory));
+    // Sub-allocate device memory that is large enough to hold the buffer, and bind it to the buffer object.
+    allocator.AllocateBufferMemory(bufParams.Handle, memFlags, bufParams.Allocation);
 
-    // Bind the buffer object to the device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(device, bufParams.Handle, bufParams.Memory, 0));
+    // Host-visible memory blocks are persistently mapped by the allocator, so we don't have to map and unmap 
+    // the buffer every time we want to update its data (MappedMemory is nullptr if memory is not host-visible).
+    bufParams.MappedMemory = bufParams.Allocation.MappedMemory;
 }
 
-void CreateBuffer(VkDevice device, 
+void CreateBuffer(VKMemoryAllocator& allocator, 
                     VkBufferCreateInfo bufferInfo, 
                     VkBuffer& buffer,
-                    VkDeviceMemory& memory,
-                    void *mappedMemory,
-                    VkMemoryPropertyFlags memFlags,
-                    VkPhysicalDeviceMemoryProperties devMemProps)
+                    MemoryAllocation& allocation,
+                    VkMemoryPropertyFlags memFlags)
 {
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-
-    VK_CHECK_RESULT(vkCreateBuffer(device, &bufferInfo, nullptr, &buffer));
-
-    // Request a memory allocation from device memory that is large enough to hold the buffer.
-    vkGetBufferMemoryRequirements(device, buffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, memFlags, devMemProps);
-    VK_CHECK_RESULT(vkAllocateMemory(device, &memAlloc, nullptr, &memory));
-
-    // Map device memory just allocated (it only works if space is allocated in host-visible device memory).
-    // Leave it mapped so that we don't have to map and unmap it every time we want to update the buffer data.
-    if (mappedMemory)
-        VK_CHECK_RESULT(vkMapMemory(device, memory, 0, memAlloc.allocationSize, 0, &mappedMemory));
-
-    // Bind the buffer object to the device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(device, buffer, memory, 0));
+    VK_CHECK_RESULT(vkCreateBuffer(allocator.GetDevice(), &bufferInfo, nullptr, &buffer));
+
+    // Sub-allocate device memory that is large enough to hold the buffer, and bind it to the buffer object.
+    // If memory is host-visible, allocation.MappedMemory points to the (persistently mapped) buffer data.
+    allocator.AllocateBufferMemory(buffer, memFlags, allocation);
 }
 
 void* AlignedAlloc(size_t size, size_t alignment)
@@ -311,38 +291,4 @@ void FlushInitCommandBuffer(VkDevice device, VkQueue queue, VkCommandBuffer cmd,
     VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, fence));
 
     VK_CHECK_RESULT(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
-}
-
-std::string errorString(VkResult errorCode)
-{
-    switch (errorCode)
-    {
-#define STR(r) case VK_ ##r: return #r
-        STR(NOT_READY);
-        STR(TIMEOUT);
-        STR(EVENT_SET);
-        STR(EVENT_RESET);
-        STR(INCOMPLETE);
-        STR(ERROR_OUT_OF_HOST_MEMORY);
-        STR(ERROR_OUT_OF_DEVICE_MEMORY);
-        STR(ERROR_INITIALIZATION_FAILED);
-        STR(ERROR_DEVICE_LOST);
-        STR(ERROR_MEMORY_MAP_FAILED);
-        STR(ERROR_LAYER_NOT_PRESENT);
-        STR(ERROR_EXTENSION_NOT_PRESENT);
-        STR(ERROR_FEATURE_NOT_PRESENT);
-        STR(ERROR_INCOMPATIBLE_DRIVER);
-        STR(ERROR_TOO_MANY_OBJECTS);
-        STR(ERROR_FORMAT_NOT_SUPPORTED);
-        STR(ERROR_SURFACE_LOST_KHR);
-        STR(ERROR_NATIVE_WINDOW_IN_USE_KHR);
-        STR(SUBOPTIMAL_KHR);
-        STR(ERROR_OUT_OF_DATE_KHR);
-        STR(ERROR_INCOMPATIBLE_DISPLAY_KHR);
-        STR(ERROR_VALIDATION_FAILED_EXT);
-        STR(ERROR_INVALID_SHADER_NV);
-#undef STR
-    default:
-        return "UNKNOWN_ERROR";
-    }
 }
\ No newline at end of file
@@ -0,0 +1,497 @@
+#include "stdafx.h"
+#include "VKDebug.hpp"
+#include "VKStagingRing.hpp"
+
+// Least common multiple of two alignments (which are not necessarily powers of two, for e.g. a texel size of 12 bytes)
+static VkDeviceSize LeastCommonMultiple(VkDeviceSize a, VkDeviceSize b)
+{
+    VkDeviceSize x = a, y = b;
+    while (y != 0)
+    {
+        VkDeviceSize t = x % y;
+        x = y;
+        y = t;
+    }
+    return a / x * b;
+}
+
+VKStagingRing::VKStagingRing() :
+    m_device(VK_NULL_HANDLE),
+    m_transferQueue(VK_NULL_HANDLE),
+    m_graphicsQueue(VK_NULL_HANDLE),
+    m_transferFamilyIndex(UINT32_MAX),
+    m_graphicsFamilyIndex(UINT32_MAX),
+    m_transferCommandPool(VK_NULL_HANDLE),
+    m_graphicsCommandPool(VK_NULL_HANDLE),
+    m_buffer(VK_NULL_HANDLE),
+    m_memory(VK_NULL_HANDLE),
+    m_mappedMemory(nullptr),
+    m_size(0),
+    m_copyOffsetAlignment(1),
+    m_head(0),
+    m_tail(0),
+    m_currentBatch(0),
+    m_pendingBatches(0)
+{
+}
+
+VKStagingRing::~VKStagingRing()
+{
+    Destroy();
+}
+
+void VKStagingRing::Init(VkPhysicalDevice physicalDevice, VkDevice device,
+                         VkQueue transferQueue, uint32_t transferFamilyIndex,
+                         VkQueue graphicsQueue, uint32_t graphicsFamilyIndex,
+                         VkDeviceSize size, uint32_t batchCount)
+{
+    assert(batchCount > 0);
+
+    m_device = device;
+    m_transferQueue = transferQueue;
+    m_transferFamilyIndex = transferFamilyIndex;
+    m_graphicsQueue = graphicsQueue;
+    m_graphicsFamilyIndex = graphicsFamilyIndex;
+    m_size = size;
+    m_head = m_tail = 0;
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+    m_copyOffsetAlignment = std::max<VkDeviceSize>(deviceProperties.limits.optimalBufferCopyOffsetAlignment, 1);
+
+    //
+    // Create the staging buffer in coherent, host-visible memory, and map it for the whole lifetime of the ring.
+    //
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VK_CHECK_RESULT(vkCreateBuffer(m_device, &bufferInfo, nullptr, &m_buffer));
+
+    VkMemoryRequirements memReqs;
+    vkGetBufferMemoryRequirements(m_device, m_buffer, &memReqs);
+
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    const VkMemoryPropertyFlags memFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        if ((memReqs.memoryTypeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & memFlags) == memFlags)
+        {
+            memoryTypeIndex = i;
+            break;
+        }
+    }
+    assert(memoryTypeIndex != UINT32_MAX);
+
+    VkMemoryAllocateInfo memAlloc = {};
+    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memAlloc.allocationSize = memReqs.size;
+    memAlloc.memoryTypeIndex = memoryTypeIndex;
+    VK_CHECK_RESULT(vkAllocateMemory(m_device, &memAlloc, nullptr, &m_memory));
+    VK_CHECK_RESULT(vkBindBufferMemory(m_device, m_buffer, m_memory, 0));
+    VK_CHECK_RESULT(vkMapMemory(m_device, m_memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&m_mappedMemory)));
+
+    //
+    // Create the command buffers and the synchronization objects of the batches
+    //
+
+    VkCommandPoolCreateInfo cmdPoolInfo = {};
+    cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmdPoolInfo.queueFamilyIndex = m_transferFamilyIndex;
+    VK_CHECK_RESULT(vkCreateCommandPool(m_device, &cmdPoolInfo, nullptr, &m_transferCommandPool));
+
+    if (UsesDedicatedQueue())
+    {
+        cmdPoolInfo.queueFamilyIndex = m_graphicsFamilyIndex;
+        VK_CHECK_RESULT(vkCreateCommandPool(m_device, &cmdPoolInfo, nullptr, &m_graphicsCommandPool));
+    }
+
+    VkCommandBufferAllocateInfo cmdBufAllocInfo = {};
+    cmdBufAllocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    cmdBufAllocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cmdBufAllocInfo.commandBufferCount = 1;
+
+    VkFenceCreateInfo fenceCreateInfo = {};
+    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    m_batches.resize(batchCount);
+    for (Batch& batch : m_batches)
+    {
+        batch.GraphicsCmdBuffer = VK_NULL_HANDLE;
+        batch.Semaphore = VK_NULL_HANDLE;
+        batch.End = 0;
+        batch.Pending = false;
+
+        cmdBufAllocInfo.commandPool = m_transferCommandPool;
+        VK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &cmdBufAllocInfo, &batch.TransferCmdBuffer));
+        VK_CHECK_RESULT(vkCreateFence(m_device, &fenceCreateInfo, nullptr, &batch.Fence));
+
+        if (UsesDedicatedQueue())
+        {
+            cmdBufAllocInfo.commandPool = m_graphicsCommandPool;
+            VK_CHECK_RESULT(vkAllocateCommandBuffers(m_device, &cmdBufAllocInfo, &batch.GraphicsCmdBuffer));
+            VK_CHECK_RESULT(vkCreateSemaphore(m_device, &semaphoreCreateInfo, nullptr, &batch.Semaphore));
+        }
+    }
+
+    m_currentBatch = 0;
+    m_pendingBatches = 0;
+}
+
+void VKStagingRing::Destroy()
+{
+    if (m_device == VK_NULL_HANDLE)
+        return;
+
+    // The batches still in flight read from the staging buffer
+    while (m_pendingBatches > 0)
+        WaitOldestBatch();
+
+    for (Batch& batch : m_batches)
+    {
+        vkDestroyFence(m_device, batch.Fence, nullptr);
+        if (batch.Semaphore != VK_NULL_HANDLE)
+            vkDestroySemaphore(m_device, batch.Semaphore, nullptr);
+    }
+    m_batches.clear();
+
+    // Destroying the pools frees their command buffers
+    vkDestroyCommandPool(m_device, m_transferCommandPool, nullptr);
+    if (m_graphicsCommandPool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(m_device, m_graphicsCommandPool, nullptr);
+    m_transferCommandPool = m_graphicsCommandPool = VK_NULL_HANDLE;
+
+    vkDestroyBuffer(m_device, m_buffer, nullptr);
+    vkFreeMemory(m_device, m_memory, nullptr);
+    m_buffer = VK_NULL_HANDLE;
+    m_memory = VK_NULL_HANDLE;
+    m_mappedMemory = nullptr;
+
+    m_device = VK_NULL_HANDLE;
+}
+
+VkDeviceSize VKStagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    assert(size > 0 && size <= GetMaxUploadSize());
+
+    for (;;)
+    {
+        // Align the offset in the buffer, and wrap around to the beginning of the buffer if the range
+        // doesn't fit in the space left before the end (that space is wasted until the next lap).
+        VkDeviceSize bufferOffset = m_head % m_size;
+        VkDeviceSize alignedOffset = (bufferOffset + alignment - 1) / alignment * alignment;
+        VkDeviceSize head = (alignedOffset + size <= m_size) ?
+                            m_head + (alignedOffset - bufferOffset) :
+                            m_head + (m_size - bufferOffset);
+
+        if (head + size - m_tail <= m_size)
+        {
+            m_head = head + size;
+            return head % m_size;
+        }
+
+        // Not enough room: reclaim the space used by the oldest batch in flight, or submit
+        // the current batch if it's the only one using the ring.
+        if (m_pendingBatches > 0)
+            WaitOldestBatch();
+        else if (!m_batches[m_currentBatch].Empty())
+            Submit();
+        else
+            m_head = m_tail = 0;
+    }
+}
+
+void VKStagingRing::WaitOldestBatch()
+{
+    uint32_t batchCount = static_cast<uint32_t>(m_batches.size());
+    Batch& batch = m_batches[(m_currentBatch + batchCount - m_pendingBatches) % batchCount];
+
+    VK_CHECK_RESULT(vkWaitForFences(m_device, 1, &batch.Fence, VK_TRUE, UINT64_MAX));
+    VK_CHECK_RESULT(vkResetFences(m_device, 1, &batch.Fence));
+    batch.Pending = false;
+    m_pendingBatches--;
+
+    // The GPU is done with the ring up to the end of the batch
+    m_tail = batch.End;
+
+    // Restart from the beginning of the buffer when the ring is empty, to avoid wrapping around in the middle of an upload
+    if (m_pendingBatches == 0 && m_batches[m_currentBatch].Empty())
+        m_head = m_tail = 0;
+}
+
+void* VKStagingRing::MapBufferUpload(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size)
+{
+    VkDeviceSize srcOffset = Allocate(size, std::max<VkDeviceSize>(m_copyOffsetAlignment, 4));
+
+    // Allocate can submit the current batch, so get it afterwards
+    Batch& batch = m_batches[m_currentBatch];
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = offset;
+    copyRegion.size = size;
+    batch.BufferCopies.push_back(std::make_pair(buffer, copyRegion));
+
+    if (UsesDedicatedQueue())
+    {
+        VkBufferMemoryBarrier bufferBarrier = {};
+        bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        bufferBarrier.srcQueueFamilyIndex = m_transferFamilyIndex;
+        bufferBarrier.dstQueueFamilyIndex = m_graphicsFamilyIndex;
+        bufferBarrier.buffer = buffer;
+        bufferBarrier.offset = offset;
+        bufferBarrier.size = size;
+        batch.BufferBarriers.push_back(bufferBarrier);
+    }
+
+    return m_mappedMemory + srcOffset;
+}
+
+void VKStagingRing::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+
+    // Split the upload in chunks that fit in the ring
+    for (VkDeviceSize copied = 0; copied < size; )
+    {
+        VkDeviceSize chunkSize = std::min(size - copied, GetMaxUploadSize());
+        memcpy(MapBufferUpload(buffer, offset + copied, chunkSize), src + copied, static_cast<size_t>(chunkSize));
+        copied += chunkSize;
+    }
+}
+
+void VKStagingRing::UploadImage(VkImage image, uint32_t width, uint32_t height, uint32_t texelSize, const void* data,
+                                VkImageLayout finalLayout, uint32_t mipLevel, uint32_t arrayLayer)
+{
+    // A non-compressed format is a block-compressed format with blocks of a single texel
+    UploadCompressedImage(image, width, height, 1, 1, texelSize, data, finalLayout, mipLevel, arrayLayer);
+}
+
+void VKStagingRing::UploadCompressedImage(VkImage image, uint32_t width, uint32_t height, 
+                                          uint32_t blockWidth, uint32_t blockHeight, uint32_t blockSize, const void* data,
+                                          VkImageLayout finalLayout, uint32_t mipLevel, uint32_t arrayLayer)
+{
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    const uint32_t blockRowCount = (height + blockHeight - 1) / blockHeight;
+    const VkDeviceSize rowPitch = static_cast<VkDeviceSize>((width + blockWidth - 1) / blockWidth) * blockSize;    // Size of a row of blocks
+    assert(rowPitch <= GetMaxUploadSize());
+
+    // The offset of a buffer-to-image copy must be a multiple of both 4 and the texel (block) size
+    const VkDeviceSize alignment = LeastCommonMultiple(LeastCommonMultiple(m_copyOffsetAlignment, 4), blockSize);
+
+    // Split the upload in bands of rows (of blocks) that fit in the ring
+    const uint32_t rowsPerChunk = static_cast<uint32_t>(std::min<VkDeviceSize>(GetMaxUploadSize() / rowPitch, blockRowCount));
+
+    for (uint32_t row = 0; row < blockRowCount; row += rowsPerChunk)
+    {
+        uint32_t rows = std::min(rowsPerChunk, blockRowCount - row);
+        VkDeviceSize chunkSize = rowPitch * rows;
+        VkDeviceSize srcOffset = Allocate(chunkSize, alignment);
+        memcpy(m_mappedMemory + srcOffset, src + rowPitch * row, static_cast<size_t>(chunkSize));
+
+        Batch& batch = m_batches[m_currentBatch];
+
+        // Transition the image layout to provide optimal performance for transfering operations that use the image as a destination.
+        // The chunks submitted in later batches are executed after this transition, as they are submitted to the same queue.
+        if (row == 0)
+        {
+            VkImageMemoryBarrier imageBarrier = {};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imageBarrier.srcAccessMask = 0;
+            imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = image;
+            imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 1, arrayLayer, 1};
+            batch.ImageTransitions.push_back(imageBarrier);
+        }
+
+        // The extent of the copy is in texels, and can only be a partial block on the edges of the image
+        const uint32_t y = row * blockHeight;
+
+        VkBufferImageCopy copyRegion = {};
+        copyRegion.bufferOffset = srcOffset;
+        copyRegion.bufferRowLength = 0;      // Tightly packed
+        copyRegion.bufferImageHeight = 0;
+        copyRegion.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, arrayLayer, 1};
+        copyRegion.imageOffset = {0, static_cast<int32_t>(y), 0};
+        copyRegion.imageExtent = {width, std::min(rows * blockHeight, height - y), 1};
+        batch.ImageCopies.push_back(std::make_pair(image, copyRegion));
+    }
+
+    // Transition the image to its final layout (and transfer its ownership) at the end of the batch including the last chunk
+    VkImageMemoryBarrier imageBarrier = {};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageBarrier.newLayout = finalLayout;
+    imageBarrier.srcQueueFamilyIndex = UsesDedicatedQueue() ? m_transferFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = UsesDedicatedQueue() ? m_graphicsFamilyIndex : VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = image;
+    imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 1, arrayLayer, 1};
+    m_batches[m_currentBatch].ImageBarriers.push_back(imageBarrier);
+}
+
+void VKStagingRing::Submit()
+{
+    Batch& batch = m_batches[m_currentBatch];
+    if (batch.Empty())
+        return;
+
+    VkCommandBufferBeginInfo cmdBufferInfo = {};
+    cmdBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufferInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(batch.TransferCmdBuffer, &cmdBufferInfo));
+
+    if (!batch.ImageTransitions.empty())
+        vkCmdPipelineBarrier(batch.TransferCmdBuffer,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                             0, nullptr, 0, nullptr,
+                             static_cast<uint32_t>(batch.ImageTransitions.size()), batch.ImageTransitions.data());
+
+    //
+    // Issue a single copy command for each destination resource, with a region for each of the uploads to that resource.
+    // The sort is stable, so the uploads to the same range are still executed in the order they were requested.
+    //
+
+    std::stable_sort(batch.BufferCopies.begin(), batch.BufferCopies.end(),
+                     [](const std::pair<VkBuffer, VkBufferCopy>& a, const std::pair<VkBuffer, VkBufferCopy>& b) { return a.first < b.first; });
+
+    std::vector<VkBufferCopy> bufferRegions;
+    for (size_t i = 0; i < batch.BufferCopies.size(); )
+    {
+        VkBuffer dstBuffer = batch.BufferCopies[i].first;
+        bufferRegions.clear();
+        for (; i < batch.BufferCopies.size() && batch.BufferCopies[i].first == dstBuffer; ++i)
+            bufferRegions.push_back(batch.BufferCopies[i].second);
+
+        vkCmdCopyBuffer(batch.TransferCmdBuffer, m_buffer, dstBuffer, static_cast<uint32_t>(bufferRegions.size()), bufferRegions.data());
+    }
+
+    std::stable_sort(batch.ImageCopies.begin(), batch.ImageCopies.end(),
+                     [](const std::pair<VkImage, VkBufferImageCopy>& a, const std::pair<VkImage, VkBufferImageCopy>& b) { return a.first < b.first; });
+
+    std::vector<VkBufferImageCopy> imageRegions;
+    for (size_t i = 0; i < batch.ImageCopies.size(); )
+    {
+        VkImage dstImage = batch.ImageCopies[i].first;
+        imageRegions.clear();
+        for (; i < batch.ImageCopies.size() && batch.ImageCopies[i].first == dstImage; ++i)
+            imageRegions.push_back(batch.ImageCopies[i].second);
+
+        vkCmdCopyBufferToImage(batch.TransferCmdBuffer, m_buffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(imageRegions.size()), imageRegions.data());
+    }
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+
+    if (!UsesDedicatedQueue())
+    {
+        // A single barrier makes the result of all the copies visible to any command submitted later to the queue,
+        // and transitions the uploaded images to their final layout.
+        VkMemoryBarrier memoryBarrier = {};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+        for (VkImageMemoryBarrier& imageBarrier : batch.ImageBarriers)
+            imageBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+        vkCmdPipelineBarrier(batch.TransferCmdBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             1, &memoryBarrier, 0, nullptr,
+                             static_cast<uint32_t>(batch.ImageBarriers.size()), batch.ImageBarriers.data());
+
+        VK_CHECK_RESULT(vkEndCommandBuffer(batch.TransferCmdBuffer));
+
+        submitInfo.pCommandBuffers = &batch.TransferCmdBuffer;
+        VK_CHECK_RESULT(vkQueueSubmit(m_transferQueue, 1, &submitInfo, batch.Fence));
+    }
+    else
+    {
+        // Release the ownership of the uploaded resources to the graphics queue family.
+        // dstAccessMask is ignored by release operations, and the visibility of the writes is handled by the acquire operations.
+        vkCmdPipelineBarrier(batch.TransferCmdBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                             0, nullptr,
+                             static_cast<uint32_t>(batch.BufferBarriers.size()), batch.BufferBarriers.data(),
+                             static_cast<uint32_t>(batch.ImageBarriers.size()), batch.ImageBarriers.data());
+
+        VK_CHECK_RESULT(vkEndCommandBuffer(batch.TransferCmdBuffer));
+
+        submitInfo.pCommandBuffers = &batch.TransferCmdBuffer;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &batch.Semaphore;
+        VK_CHECK_RESULT(vkQueueSubmit(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE));
+
+        // Acquire the ownership on the graphics queue, with the same barriers used for the release.
+        // As the ring doesn't know how the resources will be used, they are made visible to any later command.
+        for (VkBufferMemoryBarrier& bufferBarrier : batch.BufferBarriers)
+        {
+            bufferBarrier.srcAccessMask = 0;
+            bufferBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        }
+
+        for (VkImageMemoryBarrier& imageBarrier : batch.ImageBarriers)
+        {
+            imageBarrier.srcAccessMask = 0;
+            imageBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+        }
+
+        VK_CHECK_RESULT(vkBeginCommandBuffer(batch.GraphicsCmdBuffer, &cmdBufferInfo));
+
+        vkCmdPipelineBarrier(batch.GraphicsCmdBuffer,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             0, nullptr,
+                             static_cast<uint32_t>(batch.BufferBarriers.size()), batch.BufferBarriers.data(),
+                             static_cast<uint32_t>(batch.ImageBarriers.size()), batch.ImageBarriers.data());
+
+        VK_CHECK_RESULT(vkEndCommandBuffer(batch.GraphicsCmdBuffer));
+
+        // The fence is signaled by the graphics submission, which completes after the transfer one
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        submitInfo.pCommandBuffers = &batch.GraphicsCmdBuffer;
+        submitInfo.signalSemaphoreCount = 0;
+        submitInfo.pSignalSemaphores = nullptr;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &batch.Semaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        VK_CHECK_RESULT(vkQueueSubmit(m_graphicsQueue, 1, &submitInfo, batch.Fence));
+    }
+
+    batch.End = m_head;
+    batch.Pending = true;
+    batch.BufferCopies.clear();
+    batch.ImageCopies.clear();
+    batch.ImageTransitions.clear();
+    batch.BufferBarriers.clear();
+    batch.ImageBarriers.clear();
+
+    // Move to the next batch, waiting for it if it's still in flight
+    m_pendingBatches++;
+    m_currentBatch = (m_currentBatch + 1) % static_cast<uint32_t>(m_batches.size());
+    if (m_batches[m_currentBatch].Pending)
+        WaitOldestBatch();
+}
+
+void VKStagingRing::Flush()
+{
+    Submit();
+
+    while (m_pendingBatches > 0)
+        WaitOldestBatch();
+}
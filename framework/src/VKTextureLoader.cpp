@@ -0,0 +1,938 @@
+#include "stdafx.h"
+#include "VKTextureLoader.hpp"
+
+#include <fstream>
+
+//
+// Formats
+//
+
+enum FormatFamily {
+    FORMAT_FAMILY_UNCOMPRESSED,
+    FORMAT_FAMILY_BC,
+    FORMAT_FAMILY_ETC2,
+    FORMAT_FAMILY_ASTC
+};
+
+// Layout of the blocks of a format, and family of compressed formats it belongs to (which sets the device feature it requires)
+struct FormatInfo {
+    VkFormat        Format;
+    uint32_t        BlockWidth;
+    uint32_t        BlockHeight;
+    uint32_t        BlockSize;
+    FormatFamily    Family;
+    const char*     Name;
+};
+
+static const FormatInfo s_formats[] = {
+    { VK_FORMAT_R8_UNORM,                   1,  1,  1, FORMAT_FAMILY_UNCOMPRESSED, "R8_UNORM" },
+    { VK_FORMAT_R8G8_UNORM,                 1,  1,  2, FORMAT_FAMILY_UNCOMPRESSED, "R8G8_UNORM" },
+    { VK_FORMAT_R8G8B8A8_UNORM,             1,  1,  4, FORMAT_FAMILY_UNCOMPRESSED, "R8G8B8A8_UNORM" },
+    { VK_FORMAT_R8G8B8A8_SRGB,              1,  1,  4, FORMAT_FAMILY_UNCOMPRESSED, "R8G8B8A8_SRGB" },
+    { VK_FORMAT_B8G8R8A8_UNORM,             1,  1,  4, FORMAT_FAMILY_UNCOMPRESSED, "B8G8R8A8_UNORM" },
+    { VK_FORMAT_B8G8R8A8_SRGB,              1,  1,  4, FORMAT_FAMILY_UNCOMPRESSED, "B8G8R8A8_SRGB" },
+    { VK_FORMAT_R16G16B16A16_SFLOAT,        1,  1,  8, FORMAT_FAMILY_UNCOMPRESSED, "R16G16B16A16_SFLOAT" },
+    { VK_FORMAT_R32G32B32A32_SFLOAT,        1,  1, 16, FORMAT_FAMILY_UNCOMPRESSED, "R32G32B32A32_SFLOAT" },
+
+    { VK_FORMAT_BC1_RGB_UNORM_BLOCK,        4,  4,  8, FORMAT_FAMILY_BC, "BC1_RGB_UNORM" },
+    { VK_FORMAT_BC1_RGB_SRGB_BLOCK,         4,  4,  8, FORMAT_FAMILY_BC, "BC1_RGB_SRGB" },
+    { VK_FORMAT_BC1_RGBA_UNORM_BLOCK,       4,  4,  8, FORMAT_FAMILY_BC, "BC1_RGBA_UNORM" },
+    { VK_FORMAT_BC1_RGBA_SRGB_BLOCK,        4,  4,  8, FORMAT_FAMILY_BC, "BC1_RGBA_SRGB" },
+    { VK_FORMAT_BC2_UNORM_BLOCK,            4,  4, 16, FORMAT_FAMILY_BC, "BC2_UNORM" },
+    { VK_FORMAT_BC2_SRGB_BLOCK,             4,  4, 16, FORMAT_FAMILY_BC, "BC2_SRGB" },
+    { VK_FORMAT_BC3_UNORM_BLOCK,            4,  4, 16, FORMAT_FAMILY_BC, "BC3_UNORM" },
+    { VK_FORMAT_BC3_SRGB_BLOCK,             4,  4, 16, FORMAT_FAMILY_BC, "BC3_SRGB" },
+    { VK_FORMAT_BC4_UNORM_BLOCK,            4,  4,  8, FORMAT_FAMILY_BC, "BC4_UNORM" },
+    { VK_FORMAT_BC4_SNORM_BLOCK,            4,  4,  8, FORMAT_FAMILY_BC, "BC4_SNORM" },
+    { VK_FORMAT_BC5_UNORM_BLOCK,            4,  4, 16, FORMAT_FAMILY_BC, "BC5_UNORM" },
+    { VK_FORMAT_BC5_SNORM_BLOCK,            4,  4, 16, FORMAT_FAMILY_BC, "BC5_SNORM" },
+    { VK_FORMAT_BC6H_UFLOAT_BLOCK,          4,  4, 16, FORMAT_FAMILY_BC, "BC6H_UFLOAT" },
+    { VK_FORMAT_BC6H_SFLOAT_BLOCK,          4,  4, 16, FORMAT_FAMILY_BC, "BC6H_SFLOAT" },
+    { VK_FORMAT_BC7_UNORM_BLOCK,            4,  4, 16, FORMAT_FAMILY_BC, "BC7_UNORM" },
+    { VK_FORMAT_BC7_SRGB_BLOCK,             4,  4, 16, FORMAT_FAMILY_BC, "BC7_SRGB" },
+
+    { VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK,    4,  4,  8, FORMAT_FAMILY_ETC2, "ETC2_R8G8B8_UNORM" },
+    { VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK,     4,  4,  8, FORMAT_FAMILY_ETC2, "ETC2_R8G8B8_SRGB" },
+    { VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK,  4,  4,  8, FORMAT_FAMILY_ETC2, "ETC2_R8G8B8A1_UNORM" },
+    { VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK,   4,  4,  8, FORMAT_FAMILY_ETC2, "ETC2_R8G8B8A1_SRGB" },
+    { VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK,  4,  4, 16, FORMAT_FAMILY_ETC2, "ETC2_R8G8B8A8_UNORM" },
+    { VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK,   4,  4, 16, FORMAT_FAMILY_ETC2, "ETC2_R8G8B8A8_SRGB" },
+    { VK_FORMAT_EAC_R11_UNORM_BLOCK,        4,  4,  8, FORMAT_FAMILY_ETC2, "EAC_R11_UNORM" },
+    { VK_FORMAT_EAC_R11_SNORM_BLOCK,        4,  4,  8, FORMAT_FAMILY_ETC2, "EAC_R11_SNORM" },
+    { VK_FORMAT_EAC_R11G11_UNORM_BLOCK,     4,  4, 16, FORMAT_FAMILY_ETC2, "EAC_R11G11_UNORM" },
+    { VK_FORMAT_EAC_R11G11_SNORM_BLOCK,     4,  4, 16, FORMAT_FAMILY_ETC2, "EAC_R11G11_SNORM" },
+
+    { VK_FORMAT_ASTC_4x4_UNORM_BLOCK,       4,  4, 16, FORMAT_FAMILY_ASTC, "ASTC_4x4_UNORM" },
+    { VK_FORMAT_ASTC_4x4_SRGB_BLOCK,        4,  4, 16, FORMAT_FAMILY_ASTC, "ASTC_4x4_SRGB" },
+    { VK_FORMAT_ASTC_5x4_UNORM_BLOCK,       5,  4, 16, FORMAT_FAMILY_ASTC, "ASTC_5x4_UNORM" },
+    { VK_FORMAT_ASTC_5x4_SRGB_BLOCK,        5,  4, 16, FORMAT_FAMILY_ASTC, "ASTC_5x4_SRGB" },
+    { VK_FORMAT_ASTC_5x5_UNORM_BLOCK,       5,  5, 16, FORMAT_FAMILY_ASTC, "ASTC_5x5_UNORM" },
+    { VK_FORMAT_ASTC_5x5_SRGB_BLOCK,        5,  5, 16, FORMAT_FAMILY_ASTC, "ASTC_5x5_SRGB" },
+    { VK_FORMAT_ASTC_6x5_UNORM_BLOCK,       6,  5, 16, FORMAT_FAMILY_ASTC, "ASTC_6x5_UNORM" },
+    { VK_FORMAT_ASTC_6x5_SRGB_BLOCK,        6,  5, 16, FORMAT_FAMILY_ASTC, "ASTC_6x5_SRGB" },
+    { VK_FORMAT_ASTC_6x6_UNORM_BLOCK,       6,  6, 16, FORMAT_FAMILY_ASTC, "ASTC_6x6_UNORM" },
+    { VK_FORMAT_ASTC_6x6_SRGB_BLOCK,        6,  6, 16, FORMAT_FAMILY_ASTC, "ASTC_6x6_SRGB" },
+    { VK_FORMAT_ASTC_8x5_UNORM_BLOCK,       8,  5, 16, FORMAT_FAMILY_ASTC, "ASTC_8x5_UNORM" },
+    { VK_FORMAT_ASTC_8x5_SRGB_BLOCK,        8,  5, 16, FORMAT_FAMILY_ASTC, "ASTC_8x5_SRGB" },
+    { VK_FORMAT_ASTC_8x6_UNORM_BLOCK,       8,  6, 16, FORMAT_FAMILY_ASTC, "ASTC_8x6_UNORM" },
+    { VK_FORMAT_ASTC_8x6_SRGB_BLOCK,        8,  6, 16, FORMAT_FAMILY_ASTC, "ASTC_8x6_SRGB" },
+    { VK_FORMAT_ASTC_8x8_UNORM_BLOCK,       8,  8, 16, FORMAT_FAMILY_ASTC, "ASTC_8x8_UNORM" },
+    { VK_FORMAT_ASTC_8x8_SRGB_BLOCK,        8,  8, 16, FORMAT_FAMILY_ASTC, "ASTC_8x8_SRGB" },
+    { VK_FORMAT_ASTC_10x5_UNORM_BLOCK,     10,  5, 16, FORMAT_FAMILY_ASTC, "ASTC_10x5_UNORM" },
+    { VK_FORMAT_ASTC_10x5_SRGB_BLOCK,      10,  5, 16, FORMAT_FAMILY_ASTC, "ASTC_10x5_SRGB" },
+    { VK_FORMAT_ASTC_10x6_UNORM_BLOCK,     10,  6, 16, FORMAT_FAMILY_ASTC, "ASTC_10x6_UNORM" },
+    { VK_FORMAT_ASTC_10x6_SRGB_BLOCK,      10,  6, 16, FORMAT_FAMILY_ASTC, "ASTC_10x6_SRGB" },
+    { VK_FORMAT_ASTC_10x8_UNORM_BLOCK,     10,  8, 16, FORMAT_FAMILY_ASTC, "ASTC_10x8_UNORM" },
+    { VK_FORMAT_ASTC_10x8_SRGB_BLOCK,      10,  8, 16, FORMAT_FAMILY_ASTC, "ASTC_10x8_SRGB" },
+    { VK_FORMAT_ASTC_10x10_UNORM_BLOCK,    10, 10, 16, FORMAT_FAMILY_ASTC, "ASTC_10x10_UNORM" },
+    { VK_FORMAT_ASTC_10x10_SRGB_BLOCK,     10, 10, 16, FORMAT_FAMILY_ASTC, "ASTC_10x10_SRGB" },
+    { VK_FORMAT_ASTC_12x10_UNORM_BLOCK,    12, 10, 16, FORMAT_FAMILY_ASTC, "ASTC_12x10_UNORM" },
+    { VK_FORMAT_ASTC_12x10_SRGB_BLOCK,     12, 10, 16, FORMAT_FAMILY_ASTC, "ASTC_12x10_SRGB" },
+    { VK_FORMAT_ASTC_12x12_UNORM_BLOCK,    12, 12, 16, FORMAT_FAMILY_ASTC, "ASTC_12x12_UNORM" },
+    { VK_FORMAT_ASTC_12x12_SRGB_BLOCK,     12, 12, 16, FORMAT_FAMILY_ASTC, "ASTC_12x12_SRGB" },
+};
+
+static const FormatInfo* FindFormat(VkFormat format)
+{
+    for (const FormatInfo& info : s_formats)
+        if (info.Format == format)
+            return &info;
+    return nullptr;
+}
+
+static uint8_t Clamp255(int value)
+{
+    return static_cast<uint8_t>(std::min(std::max(value, 0), 255));
+}
+
+//
+// BC1-BC5 decoders. Each decoder writes the 16 texels of a 4x4 block, as RGBA8 in row-major order.
+//
+
+// Color block of BC1, BC2 and BC3: two RGB565 endpoints and a 2-bit index per texel into a palette interpolated between them.
+// In BC1, if the first endpoint is not greater than the second one, the palette has 3 colors and black (transparent, with punchthrough alpha).
+static void DecodeBCColor(const uint8_t* block, uint8_t* out, bool fourColorsOnly, bool punchthroughAlpha)
+{
+    const uint32_t c0 = block[0] | (block[1] << 8);
+    const uint32_t c1 = block[2] | (block[3] << 8);
+
+    uint8_t palette[4][4];
+    const uint32_t endpoints[2] = { c0, c1 };
+    for (uint32_t e = 0; e < 2; e++)
+    {
+        uint32_t r = (endpoints[e] >> 11) & 0x1f, g = (endpoints[e] >> 5) & 0x3f, b = endpoints[e] & 0x1f;
+        palette[e][0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        palette[e][1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        palette[e][2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        palette[e][3] = 0xff;
+    }
+
+    for (uint32_t c = 0; c < 3; c++)
+    {
+        if (c0 > c1 || fourColorsOnly)
+        {
+            palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+        else
+        {
+            palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 0xff;
+    palette[3][3] = (c0 > c1 || fourColorsOnly || !punchthroughAlpha) ? 0xff : 0x00;
+
+    const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+    for (uint32_t i = 0; i < 16; i++)
+        memcpy(out + i * 4, palette[(indices >> (2 * i)) & 3], 4);
+}
+
+// Single channel block of BC3 (alpha), BC4 and BC5: two 8-bit endpoints and a 3-bit index per texel into a palette
+// of 8 values (or 6 values, 0 and 255, if the first endpoint is not greater than the second one).
+static void DecodeBCChannel(const uint8_t* block, uint8_t* out, uint32_t channel)
+{
+    const uint32_t a0 = block[0], a1 = block[1];
+
+    uint8_t palette[8] = { static_cast<uint8_t>(a0), static_cast<uint8_t>(a1) };
+    if (a0 > a1)
+    {
+        for (uint32_t i = 1; i < 7; i++)
+            palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1) / 7);
+    }
+    else
+    {
+        for (uint32_t i = 1; i < 5; i++)
+            palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1) / 5);
+        palette[6] = 0x00;
+        palette[7] = 0xff;
+    }
+
+    uint64_t indices = 0;
+    for (uint32_t i = 0; i < 6; i++)
+        indices |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+    for (uint32_t i = 0; i < 16; i++)
+        out[i * 4 + channel] = palette[(indices >> (3 * i)) & 7];
+}
+
+static void DecodeBC1RGB(const uint8_t* block, uint8_t* out)
+{
+    DecodeBCColor(block, out, false, false);
+}
+
+static void DecodeBC1RGBA(const uint8_t* block, uint8_t* out)
+{
+    DecodeBCColor(block, out, false, true);
+}
+
+static void DecodeBC2(const uint8_t* block, uint8_t* out)
+{
+    // Explicit 4-bit alpha per texel, followed by a color block
+    DecodeBCColor(block + 8, out, true, false);
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        uint32_t alpha = (block[i / 2] >> (4 * (i % 2))) & 0xf;
+        out[i * 4 + 3] = static_cast<uint8_t>(alpha * 17);
+    }
+}
+
+static void DecodeBC3(const uint8_t* block, uint8_t* out)
+{
+    // Alpha block, followed by a color block
+    DecodeBCColor(block + 8, out, true, false);
+    DecodeBCChannel(block, out, 3);
+}
+
+static void DecodeBC4(const uint8_t* block, uint8_t* out)
+{
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        out[i * 4 + 1] = 0x00;
+        out[i * 4 + 2] = 0x00;
+        out[i * 4 + 3] = 0xff;
+    }
+    DecodeBCChannel(block, out, 0);
+}
+
+static void DecodeBC5(const uint8_t* block, uint8_t* out)
+{
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        out[i * 4 + 2] = 0x00;
+        out[i * 4 + 3] = 0xff;
+    }
+    DecodeBCChannel(block, out, 0);
+    DecodeBCChannel(block + 8, out, 1);
+}
+
+//
+// BC7 decoder. A block selects one of 8 modes, which sets how many subsets (partitions of the block with their own pair
+// of endpoints) it uses, and the precision of the endpoints and of the indices.
+//
+
+struct BC7Mode {
+    uint32_t SubsetCount;
+    uint32_t PartitionBits;
+    uint32_t RotationBits;
+    uint32_t IndexSelectionBits;
+    uint32_t ColorBits;
+    uint32_t AlphaBits;
+    uint32_t EndpointPBits;     // A P-bit (shared LSB of the channels) per endpoint
+    uint32_t SharedPBits;       // A P-bit per subset, shared by its two endpoints
+    uint32_t IndexBits;
+    uint32_t IndexBits2;        // Separate alpha (or color, depending on the index selection bit) indices
+};
+
+static const BC7Mode s_bc7Modes[8] = {
+    { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+    { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+    { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+    { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+    { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+    { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+    { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+    { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+// Subset of each texel for the 64 partitions of blocks with 2 and 3 subsets
+static const uint8_t s_bc7Partitions2[64][16] = {
+    {0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1}, {0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1}, {0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1}, {0,0,0,1,0,0,1,1,0,0,1,1,0,1,1,1},
+    {0,0,0,0,0,0,0,1,0,0,0,1,0,0,1,1}, {0,0,1,1,0,1,1,1,0,1,1,1,1,1,1,1}, {0,0,0,1,0,0,1,1,0,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,1,0,0,1,1,0,1,1,1},
+    {0,0,0,0,0,0,0,0,0,0,0,1,0,0,1,1}, {0,0,1,1,0,1,1,1,1,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,1,0,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,0,0,0,0,1,0,1,1,1},
+    {0,0,0,1,0,1,1,1,1,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,1}, {0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1}, {0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1},
+    {0,0,0,0,1,0,0,0,1,1,1,0,1,1,1,1}, {0,1,1,1,0,0,0,1,0,0,0,0,0,0,0,0}, {0,0,0,0,0,0,0,0,1,0,0,0,1,1,1,0}, {0,1,1,1,0,0,1,1,0,0,0,1,0,0,0,0},
+    {0,0,1,1,0,0,0,1,0,0,0,0,0,0,0,0}, {0,0,0,0,1,0,0,0,1,1,0,0,1,1,1,0}, {0,0,0,0,0,0,0,0,1,0,0,0,1,1,0,0}, {0,1,1,1,0,0,1,1,0,0,1,1,0,0,0,1},
+    {0,0,1,1,0,0,0,1,0,0,0,1,0,0,0,0}, {0,0,0,0,1,0,0,0,1,0,0,0,1,1,0,0}, {0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0}, {0,0,1,1,0,1,1,0,0,1,1,0,1,1,0,0},
+    {0,0,0,1,0,1,1,1,1,1,1,0,1,0,0,0}, {0,0,0,0,1,1,1,1,1,1,1,1,0,0,0,0}, {0,1,1,1,0,0,0,1,1,0,0,0,1,1,1,0}, {0,0,1,1,1,0,0,1,1,0,0,1,1,1,0,0},
+    {0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1}, {0,0,0,0,1,1,1,1,0,0,0,0,1,1,1,1}, {0,1,0,1,1,0,1,0,0,1,0,1,1,0,1,0}, {0,0,1,1,0,0,1,1,1,1,0,0,1,1,0,0},
+    {0,0,1,1,1,1,0,0,0,0,1,1,1,1,0,0}, {0,1,0,1,0,1,0,1,1,0,1,0,1,0,1,0}, {0,1,1,0,1,0,0,1,0,1,1,0,1,0,0,1}, {0,1,0,1,1,0,1,0,1,0,1,0,0,1,0,1},
+    {0,1,1,1,0,0,1,1,1,1,0,0,1,1,1,0}, {0,0,0,1,0,0,1,1,1,1,0,0,1,0,0,0}, {0,0,1,1,0,0,1,0,0,1,0,0,1,1,0,0}, {0,0,1,1,1,0,1,1,1,1,0,1,1,1,0,0},
+    {0,1,1,0,1,0,0,1,1,0,0,1,0,1,1,0}, {0,0,1,1,1,1,0,0,1,1,0,0,0,0,1,1}, {0,1,1,0,0,1,1,0,1,0,0,1,1,0,0,1}, {0,0,0,0,0,1,1,0,0,1,1,0,0,0,0,0},
+    {0,1,0,0,1,1,1,0,0,1,0,0,0,0,0,0}, {0,0,1,0,0,1,1,1,0,0,1,0,0,0,0,0}, {0,0,0,0,0,0,1,0,0,1,1,1,0,0,1,0}, {0,0,0,0,0,1,0,0,1,1,1,0,0,1,0,0},
+    {0,1,1,0,1,1,0,0,1,0,0,1,0,0,1,1}, {0,0,1,1,0,1,1,0,1,1,0,0,1,0,0,1}, {0,1,1,0,0,0,1,1,1,0,0,1,1,1,0,0}, {0,0,1,1,1,0,0,1,1,1,0,0,0,1,1,0},
+    {0,1,1,0,1,1,0,0,1,1,0,0,1,0,0,1}, {0,1,1,0,0,0,1,1,0,0,1,1,1,0,0,1}, {0,1,1,1,1,1,1,0,1,0,0,0,0,0,0,1}, {0,0,0,1,1,0,0,0,1,1,1,0,0,1,1,1},
+    {0,0,0,0,1,1,1,1,0,0,1,1,0,0,1,1}, {0,0,1,1,0,0,1,1,1,1,1,1,0,0,0,0}, {0,0,1,0,0,0,1,0,1,1,1,0,1,1,1,0}, {0,1,0,0,0,1,0,0,0,1,1,1,0,1,1,1},
+};
+
+static const uint8_t s_bc7Partitions3[64][16] = {
+    {0,0,1,1,0,0,1,1,0,2,2,1,2,2,2,2}, {0,0,0,1,0,0,1,1,2,2,1,1,2,2,2,1}, {0,0,0,0,2,0,0,1,2,2,1,1,2,2,1,1}, {0,2,2,2,0,0,2,2,0,0,1,1,0,1,1,1},
+    {0,0,0,0,0,0,0,0,1,1,2,2,1,1,2,2}, {0,0,1,1,0,0,1,1,0,0,2,2,0,0,2,2}, {0,0,2,2,0,0,2,2,1,1,1,1,1,1,1,1}, {0,0,1,1,0,0,1,1,2,2,1,1,2,2,1,1},
+    {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2}, {0,0,0,0,1,1,1,1,1,1,1,1,2,2,2,2}, {0,0,0,0,1,1,1,1,2,2,2,2,2,2,2,2}, {0,0,1,2,0,0,1,2,0,0,1,2,0,0,1,2},
+    {0,1,1,2,0,1,1,2,0,1,1,2,0,1,1,2}, {0,1,2,2,0,1,2,2,0,1,2,2,0,1,2,2}, {0,0,1,1,0,1,1,2,1,1,2,2,1,2,2,2}, {0,0,1,1,2,0,0,1,2,2,0,0,2,2,2,0},
+    {0,0,0,1,0,0,1,1,0,1,1,2,1,1,2,2}, {0,1,1,1,0,0,1,1,2,0,0,1,2,2,0,0}, {0,0,0,0,1,1,2,2,1,1,2,2,1,1,2,2}, {0,0,2,2,0,0,2,2,0,0,2,2,1,1,1,1},
+    {0,1,1,1,0,1,1,1,0,2,2,2,0,2,2,2}, {0,0,0,1,0,0,0,1,2,2,2,1,2,2,2,1}, {0,0,0,0,0,0,1,1,0,1,2,2,0,1,2,2}, {0,0,0,0,1,1,0,0,2,2,1,0,2,2,1,0},
+    {0,1,2,2,0,1,2,2,0,0,1,1,0,0,0,0}, {0,0,1,2,0,0,1,2,1,1,2,2,2,2,2,2}, {0,1,1,0,1,2,2,1,1,2,2,1,0,1,1,0}, {0,0,0,0,0,1,1,0,1,2,2,1,1,2,2,1},
+    {0,0,2,2,1,1,0,2,1,1,0,2,0,0,2,2}, {0,1,1,0,0,1,1,0,2,0,0,2,2,2,2,2}, {0,0,1,1,0,1,2,2,0,1,2,2,0,0,1,1}, {0,0,0,0,2,0,0,0,2,2,1,1,2,2,2,1},
+    {0,0,0,0,0,0,0,2,1,1,2,2,1,2,2,2}, {0,2,2,2,0,0,2,2,0,0,1,2,0,0,1,1}, {0,0,1,1,0,0,1,2,0,0,2,2,0,2,2,2}, {0,1,2,0,0,1,2,0,0,1,2,0,0,1,2,0},
+    {0,0,0,0,1,1,1,1,2,2,2,2,0,0,0,0}, {0,1,2,0,1,2,0,1,2,0,1,2,0,1,2,0}, {0,1,2,0,2,0,1,2,1,2,0,1,0,1,2,0}, {0,0,1,1,2,2,0,0,1,1,2,2,0,0,1,1},
+    {0,0,1,1,1,1,2,2,2,2,0,0,0,0,1,1}, {0,1,0,1,0,1,0,1,2,2,2,2,2,2,2,2}, {0,0,0,0,0,0,0,0,2,1,2,1,2,1,2,1}, {0,0,2,2,1,1,2,2,0,0,2,2,1,1,2,2},
+    {0,0,2,2,0,0,1,1,0,0,2,2,0,0,1,1}, {0,2,2,0,1,2,2,1,0,2,2,0,1,2,2,1}, {0,1,0,1,2,2,2,2,2,2,2,2,0,1,0,1}, {0,0,0,0,2,1,2,1,2,1,2,1,2,1,2,1},
+    {0,1,0,1,0,1,0,1,0,1,0,1,2,2,2,2}, {0,2,2,2,0,1,1,1,0,2,2,2,0,1,1,1}, {0,0,0,2,1,1,1,2,0,0,0,2,1,1,1,2}, {0,0,0,0,2,1,1,2,2,1,1,2,2,1,1,2},
+    {0,2,2,2,0,1,1,1,0,1,1,1,0,2,2,2}, {0,0,0,2,1,1,1,2,1,1,1,2,0,0,0,2}, {0,1,1,0,0,1,1,0,0,1,1,0,2,2,2,2}, {0,0,0,0,0,0,0,0,2,1,1,2,2,1,1,2},
+    {0,1,1,0,0,1,1,0,2,2,2,2,2,2,2,2}, {0,0,2,2,0,0,1,1,0,0,1,1,0,0,2,2}, {0,0,2,2,1,1,2,2,1,1,2,2,0,0,2,2}, {0,0,0,0,0,0,0,0,0,0,0,0,2,1,1,2},
+    {0,0,0,2,0,0,0,1,0,0,0,2,0,0,0,1}, {0,2,2,2,1,2,2,2,0,2,2,2,1,2,2,2}, {0,1,0,1,2,2,2,2,2,2,2,2,2,2,2,2}, {0,1,1,1,2,0,1,1,2,2,0,1,2,2,2,0},
+};
+
+// Anchor texels (whose index has an implicit MSB of 0) of the second subset of the 2-subset partitions,
+// and of the second and third subsets of the 3-subset partitions (the anchor of the first subset is always texel 0)
+static const uint8_t s_bc7Anchors2[64] = {
+    15,15,15,15,15,15,15,15, 15,15,15,15,15,15,15,15, 15, 2, 8, 2, 2, 8, 8,15,  2, 8, 2, 2, 8, 8, 2, 2,
+    15,15, 6, 8, 2, 8,15,15,  2, 8, 2, 2, 2,15,15, 6,  6, 2, 6, 8,15,15, 2, 2, 15,15,15,15,15, 2, 2,15,
+};
+
+static const uint8_t s_bc7Anchors3a[64] = {
+     3, 3,15,15, 8, 3,15,15,  8, 8, 6, 6, 6, 5, 3, 3,  3, 3, 8,15, 3, 3, 6,10,  5, 8, 8, 6, 8, 5,15,15,
+     8,15, 3, 5, 6,10, 8,15, 15, 3,15, 5,15,15,15,15,  3,15, 5, 5, 5, 8, 5,10,  5,10, 8,13,15,12, 3, 3,
+};
+
+static const uint8_t s_bc7Anchors3b[64] = {
+    15, 8, 8, 3,15,15, 3, 8, 15,15,15,15,15,15,15, 8, 15, 8,15, 3,15, 8,15, 8,  3,15, 6,10,15,15,10, 8,
+    15, 3,15,10,10, 8, 9,10,  6,15, 8,15, 3, 6, 6, 8, 15, 3,15,15,15,15,15,15, 15,15,15,15, 3,15,15, 8,
+};
+
+static const uint32_t s_bc7Weights2[4] = { 0, 21, 43, 64 };
+static const uint32_t s_bc7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const uint32_t s_bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Read the bits of a block in order, starting from the LSB of the first byte
+struct BlockBitReader {
+    const uint8_t* Data;
+    uint32_t Position;
+
+    uint32_t Read(uint32_t count)
+    {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < count; i++, Position++)
+            value |= ((Data[Position >> 3] >> (Position & 7)) & 1u) << i;
+        return value;
+    }
+};
+
+static uint8_t InterpolateBC7(uint32_t e0, uint32_t e1, uint32_t index, uint32_t indexBits)
+{
+    const uint32_t w = (indexBits == 2) ? s_bc7Weights2[index] : (indexBits == 3) ? s_bc7Weights3[index] : s_bc7Weights4[index];
+    return static_cast<uint8_t>(((64 - w) * e0 + w * e1 + 32) >> 6);
+}
+
+static void DecodeBC7(const uint8_t* block, uint8_t* out)
+{
+    // The mode is the position of the first bit set
+    uint32_t mode = 0;
+    while (mode < 8 && !(block[0] & (1u << mode)))
+        mode++;
+
+    if (mode == 8)
+    {
+        memset(out, 0, 64);     // Reserved mode: transparent black
+        return;
+    }
+
+    const BC7Mode& m = s_bc7Modes[mode];
+    BlockBitReader bits = { block, mode + 1 };
+
+    const uint32_t partition = bits.Read(m.PartitionBits);
+    const uint32_t rotation = bits.Read(m.RotationBits);
+    const uint32_t indexSelection = bits.Read(m.IndexSelectionBits);
+
+    // Endpoints of each subset: all the red components first, then the green ones, the blue ones and the alpha ones
+    uint32_t endpoints[3][2][4] = {};
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        uint32_t bitCount = (c < 3) ? m.ColorBits : m.AlphaBits;
+        for (uint32_t s = 0; s < m.SubsetCount; s++)
+            for (uint32_t e = 0; e < 2; e++)
+                endpoints[s][e][c] = bits.Read(bitCount);
+    }
+
+    uint32_t pBits[3][2] = {};
+    for (uint32_t s = 0; s < m.SubsetCount; s++)
+    {
+        if (m.EndpointPBits)
+        {
+            pBits[s][0] = bits.Read(1);
+            pBits[s][1] = bits.Read(1);
+        }
+    }
+    for (uint32_t s = 0; s < m.SubsetCount; s++)
+    {
+        if (m.SharedPBits)
+            pBits[s][0] = pBits[s][1] = bits.Read(1);
+    }
+
+    // Expand the endpoints to 8 bits (appending the P-bit, if any, and replicating the MSBs in the LSBs)
+    for (uint32_t s = 0; s < m.SubsetCount; s++)
+    {
+        for (uint32_t e = 0; e < 2; e++)
+        {
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                uint32_t bitCount = (c < 3) ? m.ColorBits : m.AlphaBits;
+                if (bitCount == 0)
+                {
+                    endpoints[s][e][c] = 0xff;      // No alpha: opaque
+                    continue;
+                }
+
+                uint32_t value = endpoints[s][e][c];
+                if (m.EndpointPBits || m.SharedPBits)
+                {
+                    value = (value << 1) | pBits[s][e];
+                    bitCount++;
+                }
+                value <<= (8 - bitCount);
+                endpoints[s][e][c] = value | (value >> bitCount);
+            }
+        }
+    }
+
+    static const uint8_t s_singleSubset[16] = {};
+    const uint8_t* subsets = (m.SubsetCount == 2) ? s_bc7Partitions2[partition] :
+                             (m.SubsetCount == 3) ? s_bc7Partitions3[partition] : s_singleSubset;
+
+    auto isAnchor = [&](uint32_t texel) {
+        return texel == 0 ||
+               (m.SubsetCount == 2 && texel == s_bc7Anchors2[partition]) ||
+               (m.SubsetCount == 3 && (texel == s_bc7Anchors3a[partition] || texel == s_bc7Anchors3b[partition]));
+    };
+
+    uint32_t indices[16];
+    uint32_t indices2[16] = {};
+    for (uint32_t i = 0; i < 16; i++)
+        indices[i] = bits.Read(isAnchor(i) ? m.IndexBits - 1 : m.IndexBits);
+    if (m.IndexBits2)
+    {
+        for (uint32_t i = 0; i < 16; i++)
+            indices2[i] = bits.Read(i == 0 ? m.IndexBits2 - 1 : m.IndexBits2);
+    }
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        const uint32_t* e0 = endpoints[subsets[i]][0];
+        const uint32_t* e1 = endpoints[subsets[i]][1];
+
+        // Modes 4 and 5 have separate color and alpha indices (swapped by the index selection bit in mode 4)
+        uint32_t colorIndex = indices[i], colorBits = m.IndexBits;
+        uint32_t alphaIndex = indices[i], alphaBits = m.IndexBits;
+        if (m.IndexBits2)
+        {
+            alphaIndex = indices2[i];
+            alphaBits = m.IndexBits2;
+            if (indexSelection)
+            {
+                std::swap(colorIndex, alphaIndex);
+                std::swap(colorBits, alphaBits);
+            }
+        }
+
+        uint8_t* texel = out + i * 4;
+        for (uint32_t c = 0; c < 3; c++)
+            texel[c] = InterpolateBC7(e0[c], e1[c], colorIndex, colorBits);
+        texel[3] = InterpolateBC7(e0[3], e1[3], alphaIndex, alphaBits);
+
+        // The rotation swaps the alpha channel with a color channel, so that the channel with separate indices can be any of them
+        if (rotation > 0)
+            std::swap(texel[3], texel[rotation - 1]);
+    }
+}
+
+//
+// ETC2 decoders. Blocks are stored in big-endian order, and the texels are indexed in column-major order.
+//
+
+static const int s_etcModifiers[8][4] = {
+    { 2, 8, -2, -8 }, { 5, 17, -5, -17 }, { 9, 29, -9, -29 }, { 13, 42, -13, -42 },
+    { 18, 60, -18, -60 }, { 24, 80, -24, -80 }, { 33, 106, -33, -106 }, { 47, 183, -47, -183 },
+};
+
+static const int s_etcDistances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int s_eacModifiers[16][8] = {
+    { -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+    { -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 }, { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+    { -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 }, { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+    { -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 }, { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 },
+};
+
+static uint64_t ReadBigEndian64(const uint8_t* block)
+{
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < 8; i++)
+        value = (value << 8) | block[i];
+    return value;
+}
+
+// Bits [high, high - count + 1] of a block
+static int BlockField(uint64_t bits, uint32_t high, uint32_t count)
+{
+    return static_cast<int>((bits >> (high - count + 1)) & ((1ull << count) - 1));
+}
+
+// Color block of ETC2: two base colors, each modulated by a table of 4 offsets in half the block (the ETC1 modes),
+// or a palette of 4 colors (T and H modes), or a plane (planar mode). With punchthrough alpha, the blocks without the
+// opaque bit use the index 2 for transparent texels.
+static void DecodeETC2Color(const uint8_t* block, uint8_t* out, bool punchthroughAlpha)
+{
+    const uint64_t bits = ReadBigEndian64(block);
+    const bool differential = BlockField(bits, 33, 1) != 0;     // The opaque bit, with punchthrough alpha
+    const bool flip = BlockField(bits, 32, 1) != 0;
+    const bool opaque = !punchthroughAlpha || differential;
+
+    // 2-bit index of texel (x, y): MSB in the bits [31, 16], LSB in the bits [15, 0]
+    auto texelIndex = [bits](uint32_t x, uint32_t y) {
+        uint32_t j = x * 4 + y;
+        return static_cast<uint32_t>((((bits >> (16 + j)) & 1) << 1) | ((bits >> j) & 1));
+    };
+
+    auto writeTexel = [out](uint32_t x, uint32_t y, int r, int g, int b, uint8_t a) {
+        uint8_t* texel = out + (y * 4 + x) * 4;
+        texel[0] = Clamp255(r);
+        texel[1] = Clamp255(g);
+        texel[2] = Clamp255(b);
+        texel[3] = a;
+    };
+
+    auto expand4 = [](int v) { return v * 17; };
+    auto expand5 = [](int v) { return (v << 3) | (v >> 2); };
+    auto expand6 = [](int v) { return (v << 2) | (v >> 4); };
+    auto expand7 = [](int v) { return (v << 1) | (v >> 6); };
+
+    int baseColors[2][3];
+    if (!punchthroughAlpha && !differential)
+    {
+        // Individual mode: two 4-bit base colors
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            baseColors[0][c] = expand4(BlockField(bits, 63 - c * 8, 4));
+            baseColors[1][c] = expand4(BlockField(bits, 59 - c * 8, 4));
+        }
+    }
+    else
+    {
+        // Differential mode: a 5-bit base color and a 3-bit signed offset to the second one.
+        // An overflow of the second color selects the T (red), H (green) or planar (blue) mode.
+        int base[3], second[3];
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            base[c] = BlockField(bits, 63 - c * 8, 5);
+            int delta = BlockField(bits, 58 - c * 8, 3);
+            second[c] = base[c] + ((delta & 4) ? delta - 8 : delta);
+        }
+
+        if (second[0] < 0 || second[0] > 31)
+        {
+            // T mode: the first color, and the second color with two offsets
+            int c1[3] = { expand4((BlockField(bits, 60, 2) << 2) | BlockField(bits, 57, 2)), expand4(BlockField(bits, 55, 4)), expand4(BlockField(bits, 51, 4)) };
+            int c2[3] = { expand4(BlockField(bits, 47, 4)), expand4(BlockField(bits, 43, 4)), expand4(BlockField(bits, 39, 4)) };
+            int d = s_etcDistances[(BlockField(bits, 35, 2) << 1) | BlockField(bits, 32, 1)];
+
+            int palette[4][3];
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                palette[0][c] = c1[c];
+                palette[1][c] = c2[c] + d;
+                palette[2][c] = c2[c];
+                palette[3][c] = c2[c] - d;
+            }
+
+            for (uint32_t y = 0; y < 4; y++)
+                for (uint32_t x = 0; x < 4; x++)
+                {
+                    uint32_t index = texelIndex(x, y);
+                    if (!opaque && index == 2)
+                        writeTexel(x, y, 0, 0, 0, 0x00);
+                    else
+                        writeTexel(x, y, palette[index][0], palette[index][1], palette[index][2], 0xff);
+                }
+            return;
+        }
+
+        if (second[1] < 0 || second[1] > 31)
+        {
+            // H mode: two colors, each with two offsets
+            int r1 = BlockField(bits, 62, 4), g1 = (BlockField(bits, 58, 3) << 1) | BlockField(bits, 52, 1), b1 = (BlockField(bits, 51, 1) << 3) | BlockField(bits, 49, 3);
+            int r2 = BlockField(bits, 46, 4), g2 = BlockField(bits, 42, 4), b2 = BlockField(bits, 38, 4);
+            int order = ((r1 << 8) | (g1 << 4) | b1) >= ((r2 << 8) | (g2 << 4) | b2) ? 1 : 0;
+            int d = s_etcDistances[(BlockField(bits, 34, 1) << 2) | (BlockField(bits, 32, 1) << 1) | order];
+
+            int c1[3] = { expand4(r1), expand4(g1), expand4(b1) };
+            int c2[3] = { expand4(r2), expand4(g2), expand4(b2) };
+            int palette[4][3];
+            for (uint32_t c = 0; c < 3; c++)
+            {
+                palette[0][c] = c1[c] + d;
+                palette[1][c] = c1[c] - d;
+                palette[2][c] = c2[c] + d;
+                palette[3][c] = c2[c] - d;
+            }
+
+            for (uint32_t y = 0; y < 4; y++)
+                for (uint32_t x = 0; x < 4; x++)
+                {
+                    uint32_t index = texelIndex(x, y);
+                    if (!opaque && index == 2)
+                        writeTexel(x, y, 0, 0, 0, 0x00);
+                    else
+                        writeTexel(x, y, palette[index][0], palette[index][1], palette[index][2], 0xff);
+                }
+            return;
+        }
+
+        if (second[2] < 0 || second[2] > 31)
+        {
+            // Planar mode: the colors at the origin, and at the right and bottom edges of the block, interpolated (always opaque)
+            int o[3] = { expand6(BlockField(bits, 62, 6)),
+                         expand7((BlockField(bits, 56, 1) << 6) | BlockField(bits, 54, 6)),
+                         expand6((BlockField(bits, 48, 1) << 5) | (BlockField(bits, 44, 2) << 3) | BlockField(bits, 41, 3)) };
+            int h[3] = { expand6((BlockField(bits, 38, 5) << 1) | BlockField(bits, 32, 1)), expand7(BlockField(bits, 31, 7)), expand6(BlockField(bits, 24, 6)) };
+            int v[3] = { expand6(BlockField(bits, 18, 6)), expand7(BlockField(bits, 12, 7)), expand6(BlockField(bits, 5, 6)) };
+
+            for (uint32_t y = 0; y < 4; y++)
+                for (uint32_t x = 0; x < 4; x++)
+                {
+                    int color[3];
+                    for (uint32_t c = 0; c < 3; c++)
+                        color[c] = (static_cast<int>(x) * (h[c] - o[c]) + static_cast<int>(y) * (v[c] - o[c]) + 4 * o[c] + 2) >> 2;
+                    writeTexel(x, y, color[0], color[1], color[2], 0xff);
+                }
+            return;
+        }
+
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            baseColors[0][c] = expand5(base[c]);
+            baseColors[1][c] = expand5(second[c]);
+        }
+    }
+
+    // Individual and differential modes: the block is split in two halves (side by side, or one above the other if flipped)
+    const int tables[2] = { BlockField(bits, 39, 3), BlockField(bits, 36, 3) };
+    for (uint32_t y = 0; y < 4; y++)
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            uint32_t half = flip ? (y >= 2) : (x >= 2);
+            uint32_t index = texelIndex(x, y);
+            if (!opaque && index == 2)
+            {
+                writeTexel(x, y, 0, 0, 0, 0x00);
+                continue;
+            }
+
+            int modifier = (!opaque && index == 0) ? 0 : s_etcModifiers[tables[half]][index];
+            const int* base = baseColors[half];
+            writeTexel(x, y, base[0] + modifier, base[1] + modifier, base[2] + modifier, 0xff);
+        }
+}
+
+// Alpha block of ETC2 RGBA8 (EAC): a base value, and a multiplier of a table of 8 offsets, with a 3-bit index per texel
+static void DecodeEACAlpha(const uint8_t* block, uint8_t* out)
+{
+    const uint64_t bits = ReadBigEndian64(block);
+    const int base = BlockField(bits, 63, 8);
+    const int multiplier = BlockField(bits, 55, 4);
+    const int* modifiers = s_eacModifiers[BlockField(bits, 51, 4)];
+
+    for (uint32_t j = 0; j < 16; j++)
+    {
+        uint32_t x = j / 4, y = j % 4;
+        out[(y * 4 + x) * 4 + 3] = Clamp255(base + modifiers[BlockField(bits, 47 - j * 3, 3)] * multiplier);
+    }
+}
+
+static void DecodeETC2RGB(const uint8_t* block, uint8_t* out)
+{
+    DecodeETC2Color(block, out, false);
+}
+
+static void DecodeETC2RGBA1(const uint8_t* block, uint8_t* out)
+{
+    DecodeETC2Color(block, out, true);
+}
+
+static void DecodeETC2RGBA(const uint8_t* block, uint8_t* out)
+{
+    // Alpha block, followed by a color block
+    DecodeETC2Color(block + 8, out, false);
+    DecodeEACAlpha(block, out);
+}
+
+//
+// VKTextureLoader
+//
+
+VKTextureLoader::VKTextureLoader() :
+    m_format(VK_FORMAT_UNDEFINED),
+    m_width(0),
+    m_height(0),
+    m_blockWidth(1),
+    m_blockHeight(1),
+    m_blockSize(0)
+{
+}
+
+bool VKTextureLoader::LoadKTX2(const std::string& fileName)
+{
+    std::ifstream is(fileName, std::ios::binary | std::ios::in);
+    if (!is.is_open())
+    {
+        printf("Could not open %s\n", fileName.c_str());
+        return false;
+    }
+
+    // Size of the file, to check that the mip levels are inside it before reading them
+    is.seekg(0, std::ios::end);
+    const uint64_t fileSize = static_cast<uint64_t>(is.tellg());
+    is.seekg(0, std::ios::beg);
+
+    // Header: identifier, format and size of the texture, and number of mip levels (see the KTX 2.0 specification)
+    static const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    struct Header {
+        uint8_t  Identifier[12];
+        uint32_t VkFormat;
+        uint32_t TypeSize;
+        uint32_t PixelWidth;
+        uint32_t PixelHeight;
+        uint32_t PixelDepth;
+        uint32_t LayerCount;
+        uint32_t FaceCount;
+        uint32_t LevelCount;
+        uint32_t SupercompressionScheme;
+        uint32_t DfdByteOffset;
+        uint32_t DfdByteLength;
+        uint32_t KvdByteOffset;
+        uint32_t KvdByteLength;
+        uint64_t SgdByteOffset;
+        uint64_t SgdByteLength;
+    } header;
+    static_assert(sizeof(Header) == 80, "Unexpected padding in the KTX2 header");
+
+    // Byte offset and size of each mip level in the file, from the largest one
+    struct LevelIndex {
+        uint64_t ByteOffset;
+        uint64_t ByteLength;
+        uint64_t UncompressedByteLength;
+    };
+
+    is.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!is || memcmp(header.Identifier, identifier, sizeof(identifier)) != 0)
+    {
+        printf("%s is not a KTX2 file\n", fileName.c_str());
+        return false;
+    }
+
+    const FormatInfo* format = FindFormat(static_cast<VkFormat>(header.VkFormat));
+    if (format == nullptr)
+    {
+        // VK_FORMAT_UNDEFINED is used by Basis Universal textures, which must be transcoded
+        printf("%s: unsupported format (VkFormat %u)\n", fileName.c_str(), header.VkFormat);
+        return false;
+    }
+
+    if (header.SupercompressionScheme != 0)
+    {
+        printf("%s: supercompressed textures are not supported\n", fileName.c_str());
+        return false;
+    }
+
+    if (header.PixelWidth == 0 || header.PixelHeight == 0 || header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount > 1)
+    {
+        printf("%s: only 2D textures are supported\n", fileName.c_str());
+        return false;
+    }
+
+    // A level count of 0 asks the application to generate the mip levels: only the first one is in the file.
+    // A full mip chain has floor(log2(max(width, height))) + 1 levels: a larger count means the file is corrupt.
+    uint32_t maxLevelCount = 1;
+    while ((std::max(header.PixelWidth, header.PixelHeight) >> maxLevelCount) != 0)
+        maxLevelCount++;
+
+    if (header.LevelCount > maxLevelCount)
+    {
+        printf("%s: invalid number of mip levels (%u, max %u for %ux%u)\n", fileName.c_str(), 
+               header.LevelCount, maxLevelCount, header.PixelWidth, header.PixelHeight);
+        return false;
+    }
+
+    const uint32_t levelCount = std::max(header.LevelCount, 1u);
+    std::vector<LevelIndex> levelIndex(levelCount);
+    is.read(reinterpret_cast<char*>(levelIndex.data()), levelCount * sizeof(LevelIndex));
+    if (!is)
+    {
+        printf("%s is truncated\n", fileName.c_str());
+        return false;
+    }
+
+    m_format = format->Format;
+    m_width = header.PixelWidth;
+    m_height = header.PixelHeight;
+    m_blockWidth = format->BlockWidth;
+    m_blockHeight = format->BlockHeight;
+    m_blockSize = format->BlockSize;
+    m_levels.resize(levelCount);
+
+    for (uint32_t i = 0; i < levelCount; i++)
+    {
+        Level& level = m_levels[i];
+        level.Width = std::max(m_width >> i, 1u);
+        level.Height = std::max(m_height >> i, 1u);
+
+        const uint64_t size = static_cast<uint64_t>((level.Width + m_blockWidth - 1) / m_blockWidth) *
+                              ((level.Height + m_blockHeight - 1) / m_blockHeight) * m_blockSize;
+        if (levelIndex[i].ByteLength < size)
+        {
+            printf("%s: mip level %u is too small (%llu bytes, %llu expected)\n", fileName.c_str(), i,
+                   static_cast<unsigned long long>(levelIndex[i].ByteLength), static_cast<unsigned long long>(size));
+            m_levels.clear();
+            return false;
+        }
+
+        // The texels must be inside the file (this also rejects sizes too large to be allocated)
+        if (levelIndex[i].ByteOffset > fileSize || size > fileSize - levelIndex[i].ByteOffset)
+        {
+            printf("%s: mip level %u is outside the file\n", fileName.c_str(), i);
+            m_levels.clear();
+            return false;
+        }
+
+        level.Data.resize(static_cast<size_t>(size));
+        is.seekg(static_cast<std::streamoff>(levelIndex[i].ByteOffset));
+        is.read(reinterpret_cast<char*>(level.Data.data()), static_cast<std::streamsize>(size));
+        if (!is)
+        {
+            printf("%s is truncated\n", fileName.c_str());
+            m_levels.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool VKTextureLoader::IsFormatSupported(VkPhysicalDevice physicalDevice, const VkPhysicalDeviceFeatures& enabledFeatures,
+                                        VkFormatFeatureFlags requiredFeatures) const
+{
+    const FormatInfo* format = FindFormat(m_format);
+    if (format == nullptr)
+        return false;
+
+    // Compressed formats can't be used unless the feature of their family is enabled
+    if ((format->Family == FORMAT_FAMILY_BC && !enabledFeatures.textureCompressionBC) ||
+        (format->Family == FORMAT_FAMILY_ETC2 && !enabledFeatures.textureCompressionETC2) ||
+        (format->Family == FORMAT_FAMILY_ASTC && !enabledFeatures.textureCompressionASTC_LDR))
+        return false;
+
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, m_format, &props);
+    return (props.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
+
+bool VKTextureLoader::Decode()
+{
+    void (*decodeBlock)(const uint8_t* block, uint8_t* out) = nullptr;
+    bool srgb = false;
+
+    switch (m_format)
+    {
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:          srgb = true;    // Fall through
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:         decodeBlock = DecodeBC1RGB; break;
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:         srgb = true;    // Fall through
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:        decodeBlock = DecodeBC1RGBA; break;
+    case VK_FORMAT_BC2_SRGB_BLOCK:              srgb = true;    // Fall through
+    case VK_FORMAT_BC2_UNORM_BLOCK:             decodeBlock = DecodeBC2; break;
+    case VK_FORMAT_BC3_SRGB_BLOCK:              srgb = true;    // Fall through
+    case VK_FORMAT_BC3_UNORM_BLOCK:             decodeBlock = DecodeBC3; break;
+    case VK_FORMAT_BC4_UNORM_BLOCK:             decodeBlock = DecodeBC4; break;
+    case VK_FORMAT_BC5_UNORM_BLOCK:             decodeBlock = DecodeBC5; break;
+    case VK_FORMAT_BC7_SRGB_BLOCK:              srgb = true;    // Fall through
+    case VK_FORMAT_BC7_UNORM_BLOCK:             decodeBlock = DecodeBC7; break;
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:      srgb = true;    // Fall through
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:     decodeBlock = DecodeETC2RGB; break;
+    case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:    srgb = true;    // Fall through
+    case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:   decodeBlock = DecodeETC2RGBA1; break;
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:    srgb = true;    // Fall through
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:   decodeBlock = DecodeETC2RGBA; break;
+    default:
+        return false;
+    }
+
+    for (Level& level : m_levels)
+    {
+        const uint32_t blocksX = (level.Width + 3) / 4;
+        const uint32_t blocksY = (level.Height + 3) / 4;
+        std::vector<uint8_t> texels(static_cast<size_t>(level.Width) * level.Height * 4);
+
+        for (uint32_t by = 0; by < blocksY; by++)
+        {
+            for (uint32_t bx = 0; bx < blocksX; bx++)
+            {
+                uint8_t decoded[16 * 4];
+                decodeBlock(level.Data.data() + (static_cast<size_t>(by) * blocksX + bx) * m_blockSize, decoded);
+
+                // Copy the texels of the block inside the level (the blocks on the edges can be partial)
+                for (uint32_t y = 0; y < 4 && by * 4 + y < level.Height; y++)
+                {
+                    uint32_t width = std::min(4u, level.Width - bx * 4);
+                    memcpy(texels.data() + ((static_cast<size_t>(by) * 4 + y) * level.Width + bx * 4) * 4, decoded + y * 16, width * 4);
+                }
+            }
+        }
+
+        level.Data.swap(texels);
+    }
+
+    m_format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    m_blockWidth = 1;
+    m_blockHeight = 1;
+    m_blockSize = 4;
+
+    return true;
+}
+
+const char* VKTextureLoader::GetFormatName() const
+{
+    const FormatInfo* format = FindFormat(m_format);
+    return format ? format->Name : "UNDEFINED";
+}
+
+size_t VKTextureLoader::GetSize() const
+{
+    size_t size = 0;
+    for (const Level& level : m_levels)
+        size += level.Data.size();
+    return size;
+}
+
+size_t VKTextureLoader::GetUncompressedSize() const
+{
+    size_t size = 0;
+    for (const Level& level : m_levels)
+        size += static_cast<size_t>(level.Width) * level.Height * 4;
+    return size;
+}
+
+void VKTextureLoader::EnableCompressionFeatures(const VkPhysicalDeviceFeatures& supportedFeatures, VkPhysicalDeviceFeatures& enabledFeatures)
+{
+    enabledFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    enabledFeatures.textureCompressionETC2 = supportedFeatures.textureCompressionETC2;
+    enabledFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+}
@@ -0,0 +1,631 @@
+#include "stdafx.h"
+#include "VKTextureSynth.hpp"
+#include "VKJobSystem.hpp"
+
+#include <math.h>
+
+// Instruction sets available to build the rows. AVX2 is compiled in on x86 (with GCC and Clang), and only used if
+// the CPU supports it; with MSVC it requires /arch:AVX2. SSE2 is always available on x86-64, as NEON on ARM64.
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define SYNTH_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define SYNTH_AVX2 1
+#define SYNTH_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#define SYNTH_AVX2 1
+#define SYNTH_TARGET_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define SYNTH_NEON 1
+#include <arm_neon.h>
+#endif
+
+//
+// Row kernels
+//
+// Every instruction set implements the same operations on a row (or a span of a row):
+//     FillRow       dst[i] = color                                  (runs of a checkerboard, color bars)
+//     Ramp          dst[i] = start + step * i                       (gradients)
+//     Colorize      dst[i] = lerp(color0, color1, clamp(t[i]))      (from the float values of a row to RGBA8 texels)
+//     AddNoise      dst[i] += L + (R - L) * u[i], where L = la + lb * fx[i] and R = ra + rb * fx[i]
+//
+// AddNoise adds an octave of noise to a row, within a cell of the lattice, where it only depends on the position in
+// the cell (fx, and the fade curve u) and on the 4 coefficients of the cell, so that the random values, or gradients,
+// at the vertices of the lattice are computed once per cell rather than for every texel.
+//
+
+struct RowKernels {
+    const char* Name;
+    void (*FillRow)(uint32_t* dst, uint32_t count, uint32_t color);
+    void (*Ramp)(float* dst, uint32_t count, float start, float step);
+    void (*Colorize)(uint32_t* dst, const float* t, uint32_t count, uint32_t color0, uint32_t color1);
+    void (*AddNoise)(float* dst, uint32_t count, const float* fx, const float* u, const float* coefficients);
+};
+
+// Component c of an RGBA8 color, and the difference between two colors, as floats
+static float Channel(uint32_t color, uint32_t c)
+{
+    return static_cast<float>((color >> (c * 8)) & 0xff);
+}
+
+static float ChannelDelta(uint32_t color0, uint32_t color1, uint32_t c)
+{
+    return Channel(color1, c) - Channel(color0, c);
+}
+
+static void FillRowScalar(uint32_t* dst, uint32_t count, uint32_t color)
+{
+    for (uint32_t i = 0; i < count; i++)
+        dst[i] = color;
+}
+
+static void RampScalar(float* dst, uint32_t count, float start, float step)
+{
+    for (uint32_t i = 0; i < count; i++)
+        dst[i] = start + step * static_cast<float>(i);
+}
+
+static void ColorizeScalar(uint32_t* dst, const float* t, uint32_t count, uint32_t color0, uint32_t color1)
+{
+    float base[4], delta[4];
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        base[c] = Channel(color0, c) + 0.5f;   // Rounded to the nearest integer by the truncation
+        delta[c] = ChannelDelta(color0, color1, c);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float value = std::min(std::max(t[i], 0.0f), 1.0f);
+        uint32_t texel = 0;
+        for (uint32_t c = 0; c < 4; c++)
+            texel |= static_cast<uint32_t>(base[c] + delta[c] * value) << (c * 8);
+        dst[i] = texel;
+    }
+}
+
+static void AddNoiseScalar(float* dst, uint32_t count, const float* fx, const float* u, const float* coefficients)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        float left = coefficients[0] + coefficients[1] * fx[i];
+        float right = coefficients[2] + coefficients[3] * fx[i];
+        dst[i] += left + (right - left) * u[i];
+    }
+}
+
+#if SYNTH_SSE2
+
+static void FillRowSSE2(uint32_t* dst, uint32_t count, uint32_t color)
+{
+    const __m128i value = _mm_set1_epi32(static_cast<int>(color));
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    FillRowScalar(dst + i, count - i, color);
+}
+
+static void RampSSE2(float* dst, uint32_t count, float start, float step)
+{
+    __m128 index = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 vstart = _mm_set1_ps(start);
+    const __m128 vstep = _mm_set1_ps(step);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4, index = _mm_add_ps(index, four))
+        _mm_storeu_ps(dst + i, _mm_add_ps(vstart, _mm_mul_ps(vstep, index)));
+    RampScalar(dst + i, count - i, start + step * static_cast<float>(i), step);
+}
+
+static void ColorizeSSE2(uint32_t* dst, const float* t, uint32_t count, uint32_t color0, uint32_t color1)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 base[4], delta[4];
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        base[c] = _mm_set1_ps(Channel(color0, c) + 0.5f);
+        delta[c] = _mm_set1_ps(ChannelDelta(color0, color1, c));
+    }
+
+    // 4 texels at a time: the channels are computed in separate registers, converted to integers and packed with shifts
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(t + i), zero), one);
+        __m128i r = _mm_cvttps_epi32(_mm_add_ps(base[0], _mm_mul_ps(delta[0], value)));
+        __m128i g = _mm_cvttps_epi32(_mm_add_ps(base[1], _mm_mul_ps(delta[1], value)));
+        __m128i b = _mm_cvttps_epi32(_mm_add_ps(base[2], _mm_mul_ps(delta[2], value)));
+        __m128i a = _mm_cvttps_epi32(_mm_add_ps(base[3], _mm_mul_ps(delta[3], value)));
+        __m128i texels = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), texels);
+    }
+    ColorizeScalar(dst + i, t + i, count - i, color0, color1);
+}
+
+static void AddNoiseSSE2(float* dst, uint32_t count, const float* fx, const float* u, const float* coefficients)
+{
+    const __m128 la = _mm_set1_ps(coefficients[0]);
+    const __m128 lb = _mm_set1_ps(coefficients[1]);
+    const __m128 ra = _mm_set1_ps(coefficients[2]);
+    const __m128 rb = _mm_set1_ps(coefficients[3]);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(fx + i);
+        __m128 left = _mm_add_ps(la, _mm_mul_ps(lb, x));
+        __m128 right = _mm_add_ps(ra, _mm_mul_ps(rb, x));
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_add_ps(left, _mm_mul_ps(_mm_sub_ps(right, left), _mm_loadu_ps(u + i)))));
+    }
+    AddNoiseScalar(dst + i, count - i, fx + i, u + i, coefficients);
+}
+
+#endif
+
+#if SYNTH_AVX2
+
+// The AVX2 kernels clear the upper halves of the registers (vzeroupper) before calling the scalar kernels for the last
+// elements, as the compiler doesn't do it for tail calls: SSE instructions executed while they are dirty are very slow.
+
+SYNTH_TARGET_AVX2 static void FillRowAVX2(uint32_t* dst, uint32_t count, uint32_t color)
+{
+    const __m256i value = _mm256_set1_epi32(static_cast<int>(color));
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), value);
+    _mm256_zeroupper();
+    FillRowScalar(dst + i, count - i, color);
+}
+
+SYNTH_TARGET_AVX2 static void RampAVX2(float* dst, uint32_t count, float start, float step)
+{
+    __m256 index = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    const __m256 eight = _mm256_set1_ps(8.0f);
+    const __m256 vstart = _mm256_set1_ps(start);
+    const __m256 vstep = _mm256_set1_ps(step);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8, index = _mm256_add_ps(index, eight))
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(vstart, _mm256_mul_ps(vstep, index)));
+    _mm256_zeroupper();
+    RampScalar(dst + i, count - i, start + step * static_cast<float>(i), step);
+}
+
+SYNTH_TARGET_AVX2 static void ColorizeAVX2(uint32_t* dst, const float* t, uint32_t count, uint32_t color0, uint32_t color1)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 base[4], delta[4];
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        base[c] = _mm256_set1_ps(Channel(color0, c) + 0.5f);
+        delta[c] = _mm256_set1_ps(ChannelDelta(color0, color1, c));
+    }
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(t + i), zero), one);
+        __m256i r = _mm256_cvttps_epi32(_mm256_add_ps(base[0], _mm256_mul_ps(delta[0], value)));
+        __m256i g = _mm256_cvttps_epi32(_mm256_add_ps(base[1], _mm256_mul_ps(delta[1], value)));
+        __m256i b = _mm256_cvttps_epi32(_mm256_add_ps(base[2], _mm256_mul_ps(delta[2], value)));
+        __m256i a = _mm256_cvttps_epi32(_mm256_add_ps(base[3], _mm256_mul_ps(delta[3], value)));
+        __m256i texels = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)), _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), texels);
+    }
+    _mm256_zeroupper();
+    ColorizeScalar(dst + i, t + i, count - i, color0, color1);
+}
+
+SYNTH_TARGET_AVX2 static void AddNoiseAVX2(float* dst, uint32_t count, const float* fx, const float* u, const float* coefficients)
+{
+    const __m256 la = _mm256_set1_ps(coefficients[0]);
+    const __m256 lb = _mm256_set1_ps(coefficients[1]);
+    const __m256 ra = _mm256_set1_ps(coefficients[2]);
+    const __m256 rb = _mm256_set1_ps(coefficients[3]);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(fx + i);
+        __m256 left = _mm256_add_ps(la, _mm256_mul_ps(lb, x));
+        __m256 right = _mm256_add_ps(ra, _mm256_mul_ps(rb, x));
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_add_ps(left, _mm256_mul_ps(_mm256_sub_ps(right, left), _mm256_loadu_ps(u + i)))));
+    }
+    _mm256_zeroupper();
+    AddNoiseScalar(dst + i, count - i, fx + i, u + i, coefficients);
+}
+
+#endif
+
+#if SYNTH_NEON
+
+static void FillRowNEON(uint32_t* dst, uint32_t count, uint32_t color)
+{
+    const uint32x4_t value = vdupq_n_u32(color);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_u32(dst + i, value);
+    FillRowScalar(dst + i, count - i, color);
+}
+
+static void RampNEON(float* dst, uint32_t count, float start, float step)
+{
+    static const float indices[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    float32x4_t index = vld1q_f32(indices);
+    const float32x4_t four = vdupq_n_f32(4.0f);
+    const float32x4_t vstart = vdupq_n_f32(start);
+    const float32x4_t vstep = vdupq_n_f32(step);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4, index = vaddq_f32(index, four))
+        vst1q_f32(dst + i, vaddq_f32(vstart, vmulq_f32(vstep, index)));
+    RampScalar(dst + i, count - i, start + step * static_cast<float>(i), step);
+}
+
+static void ColorizeNEON(uint32_t* dst, const float* t, uint32_t count, uint32_t color0, uint32_t color1)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    float32x4_t base[4], delta[4];
+    for (uint32_t c = 0; c < 4; c++)
+    {
+        base[c] = vdupq_n_f32(Channel(color0, c) + 0.5f);
+        delta[c] = vdupq_n_f32(ChannelDelta(color0, color1, c));
+    }
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t value = vminq_f32(vmaxq_f32(vld1q_f32(t + i), zero), one);
+        uint32x4_t r = vcvtq_u32_f32(vaddq_f32(base[0], vmulq_f32(delta[0], value)));
+        uint32x4_t g = vcvtq_u32_f32(vaddq_f32(base[1], vmulq_f32(delta[1], value)));
+        uint32x4_t b = vcvtq_u32_f32(vaddq_f32(base[2], vmulq_f32(delta[2], value)));
+        uint32x4_t a = vcvtq_u32_f32(vaddq_f32(base[3], vmulq_f32(delta[3], value)));
+        vst1q_u32(dst + i, vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 8)), vorrq_u32(vshlq_n_u32(b, 16), vshlq_n_u32(a, 24))));
+    }
+    ColorizeScalar(dst + i, t + i, count - i, color0, color1);
+}
+
+static void AddNoiseNEON(float* dst, uint32_t count, const float* fx, const float* u, const float* coefficients)
+{
+    const float32x4_t la = vdupq_n_f32(coefficients[0]);
+    const float32x4_t lb = vdupq_n_f32(coefficients[1]);
+    const float32x4_t ra = vdupq_n_f32(coefficients[2]);
+    const float32x4_t rb = vdupq_n_f32(coefficients[3]);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t x = vld1q_f32(fx + i);
+        float32x4_t left = vaddq_f32(la, vmulq_f32(lb, x));
+        float32x4_t right = vaddq_f32(ra, vmulq_f32(rb, x));
+        vst1q_f32(dst + i, vaddq_f32(vld1q_f32(dst + i), vaddq_f32(left, vmulq_f32(vsubq_f32(right, left), vld1q_f32(u + i)))));
+    }
+    AddNoiseScalar(dst + i, count - i, fx + i, u + i, coefficients);
+}
+
+#endif
+
+static RowKernels SelectRowKernels()
+{
+#if SYNTH_AVX2
+#if defined(__GNUC__) || defined(__clang__)
+    if (__builtin_cpu_supports("avx2"))
+#endif
+        return { "AVX2", FillRowAVX2, RampAVX2, ColorizeAVX2, AddNoiseAVX2 };
+#endif
+#if SYNTH_SSE2
+    return { "SSE2", FillRowSSE2, RampSSE2, ColorizeSSE2, AddNoiseSSE2 };
+#elif SYNTH_NEON
+    return { "NEON", FillRowNEON, RampNEON, ColorizeNEON, AddNoiseNEON };
+#else
+    return { "scalar", FillRowScalar, RampScalar, ColorizeScalar, AddNoiseScalar };
+#endif
+}
+
+static const RowKernels& GetRowKernels()
+{
+    static const RowKernels kernels = SelectRowKernels();
+    return kernels;
+}
+
+//
+// Noise
+//
+
+// Random value of the vertex (x, y) of the lattice
+static uint32_t Hash(uint32_t x, uint32_t y, uint32_t seed)
+{
+    uint32_t h = seed + x * 0x27d4eb2du + y * 0x165667b1u;
+    h ^= h >> 15;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// Gradients of Perlin noise: 8 unit vectors evenly spaced around the circle
+static const float s_gradients[8][2] = {
+    {  1.0f,        0.0f       }, {  0.7071068f,  0.7071068f }, {  0.0f,  1.0f }, { -0.7071068f,  0.7071068f },
+    { -1.0f,        0.0f       }, { -0.7071068f, -0.7071068f }, {  0.0f, -1.0f }, {  0.7071068f, -0.7071068f }
+};
+
+// Quintic fade curve of Perlin noise (smooth first and second derivatives at the vertices of the lattice)
+static float Fade(float t)
+{
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+// Lattice of an octave of noise, wrapping around the texture so that the noise tiles
+struct NoiseOctave {
+    uint32_t            CellWidth;
+    uint32_t            CellHeight;
+    uint32_t            CellsX;
+    uint32_t            CellsY;
+    float               Amplitude;
+    std::vector<float>  FX;         // Position of the texels in a cell (the same for all the cells), and its fade curve
+    std::vector<float>  U;
+};
+
+// Values of the noise, in [0, 1], for a row of the texture
+static void EvaluateNoiseRow(const RowKernels& kernels, const VKTextureSynth::Desc& desc, const std::vector<NoiseOctave>& octaves,
+                             uint32_t y, float* row)
+{
+    const bool perlin = desc.Type == VKTextureSynth::PATTERN_PERLIN_NOISE;
+
+    // Perlin noise is in [-sqrt(2)/2, sqrt(2)/2] and centered on 0.5; the amplitudes of the octaves are scaled accordingly
+    std::fill(row, row + desc.Width, perlin ? 0.5f : 0.0f);
+
+    for (size_t o = 0; o < octaves.size(); o++)
+    {
+        const NoiseOctave& octave = octaves[o];
+        const uint32_t seed = desc.Seed + static_cast<uint32_t>(o) * 0x9e3779b9u;
+
+        uint32_t iy = y / octave.CellHeight;
+        float fy = (static_cast<float>(y - iy * octave.CellHeight) + 0.5f) / octave.CellHeight;
+        float v = Fade(fy);
+        uint32_t iy0 = iy % octave.CellsY;
+        uint32_t iy1 = (iy + 1) % octave.CellsY;
+
+        // The vertices on the left of a cell are the ones on the right of the previous cell
+        uint32_t h0 = Hash(0, iy0, seed);
+        uint32_t h1 = Hash(0, iy1, seed);
+
+        for (uint32_t ix = 0; ix < octave.CellsX; ix++)
+        {
+            uint32_t next = (ix + 1) % octave.CellsX;
+            uint32_t h2 = Hash(next, iy0, seed);
+            uint32_t h3 = Hash(next, iy1, seed);
+
+            // Along the row, the noise in the cell is the interpolation (by the fade curve) of its values on the left and
+            // right edges, which are linear functions of the position in the cell: L = la + lb * fx, R = ra + rb * fx.
+            // The amplitude of the octave scales the coefficients.
+            float coefficients[4];
+            if (perlin)
+            {
+                // Dot products of the gradients of the vertices with the offsets from the vertices, interpolated along y
+                const float* g00 = s_gradients[h0 & 7];
+                const float* g01 = s_gradients[h1 & 7];
+                const float* g10 = s_gradients[h2 & 7];
+                const float* g11 = s_gradients[h3 & 7];
+                coefficients[0] = (1.0f - v) * g00[1] * fy + v * g01[1] * (fy - 1.0f);
+                coefficients[1] = (1.0f - v) * g00[0] + v * g01[0];
+                coefficients[3] = (1.0f - v) * g10[0] + v * g11[0];
+                coefficients[2] = (1.0f - v) * g10[1] * fy + v * g11[1] * (fy - 1.0f) - coefficients[3];
+            }
+            else
+            {
+                // Random values of the vertices, interpolated along y
+                const float scale = 1.0f / 4294967295.0f;
+                coefficients[0] = (h0 * scale) + ((h1 * scale) - (h0 * scale)) * v;
+                coefficients[1] = 0.0f;
+                coefficients[2] = (h2 * scale) + ((h3 * scale) - (h2 * scale)) * v;
+                coefficients[3] = 0.0f;
+            }
+
+            for (uint32_t c = 0; c < 4; c++)
+                coefficients[c] *= octave.Amplitude;
+
+            uint32_t start = ix * octave.CellWidth;
+            uint32_t count = std::min(octave.CellWidth, desc.Width - start);
+            kernels.AddNoise(row + start, count, octave.FX.data(), octave.U.data(), coefficients);
+
+            h0 = h2;
+            h1 = h3;
+        }
+    }
+}
+
+static void BuildNoiseOctaves(const VKTextureSynth::Desc& desc, uint32_t cellWidth, uint32_t cellHeight, std::vector<NoiseOctave>& octaves)
+{
+    // Each octave halves the size of the cells and the amplitude; the sum of the amplitudes is 1
+    // (sqrt(2)/2 for Perlin noise, whose range is [-sqrt(2)/2, sqrt(2)/2]).
+    float totalAmplitude = 0.0f;
+    for (uint32_t o = 0; o < std::max(desc.Octaves, 1u); o++)
+    {
+        uint32_t w = cellWidth >> o;
+        uint32_t h = cellHeight >> o;
+        if (w == 0 || h == 0)
+            break;
+
+        NoiseOctave octave;
+        octave.CellWidth = w;
+        octave.CellHeight = h;
+        octave.CellsX = (desc.Width + w - 1) / w;
+        octave.CellsY = (desc.Height + h - 1) / h;
+        octave.Amplitude = 1.0f / static_cast<float>(1u << o);
+        totalAmplitude += octave.Amplitude;
+
+        octave.FX.resize(w);
+        octave.U.resize(w);
+        for (uint32_t k = 0; k < w; k++)
+        {
+            octave.FX[k] = (static_cast<float>(k) + 0.5f) / w;
+            octave.U[k] = Fade(octave.FX[k]);
+        }
+
+        octaves.push_back(octave);
+    }
+
+    float normalization = (desc.Type == VKTextureSynth::PATTERN_PERLIN_NOISE ? 0.7071068f : 1.0f) / totalAmplitude;
+    for (NoiseOctave& octave : octaves)
+        octave.Amplitude *= normalization;
+}
+
+//
+// Test pattern
+//
+
+// Color bars (white, yellow, cyan, green, magenta, red, blue, black)
+static const uint32_t s_colorBars[8] = {
+    0xffffffff, 0xff00ffff, 0xffffff00, 0xff00ff00, 0xffff00ff, 0xff0000ff, 0xffff0000, 0xff000000
+};
+
+static const uint32_t s_gridColor = 0xff808080;
+
+//
+// VKTextureSynth
+//
+
+void VKTextureSynth::Generate(const Desc& desc, uint8_t* data, VKJobSystem* jobSystem)
+{
+    if (desc.Width == 0 || desc.Height == 0)
+        return;
+
+    // Split the rows in bands (a few per thread, to balance the load), generated in parallel.
+    // Small textures are generated by the calling thread, as waking up the workers would take longer.
+    uint32_t threadCount = jobSystem ? jobSystem->GetThreadCount() : 1;
+    if (threadCount <= 1 || static_cast<uint64_t>(desc.Width) * desc.Height < 256 * 256)
+    {
+        GenerateRows(desc, data, 0, desc.Height);
+        return;
+    }
+
+    uint32_t bandCount = std::min(desc.Height, threadCount * 4);
+    uint32_t bandHeight = (desc.Height + bandCount - 1) / bandCount;
+    bandCount = (desc.Height + bandHeight - 1) / bandHeight;
+
+    jobSystem->Run(bandCount, [&](uint32_t jobIndex, uint32_t)
+    {
+        uint32_t firstRow = jobIndex * bandHeight;
+        GenerateRows(desc, data, firstRow, std::min(bandHeight, desc.Height - firstRow));
+    });
+}
+
+void VKTextureSynth::GenerateRows(const Desc& desc, uint8_t* data, uint32_t firstRow, uint32_t rowCount)
+{
+    const RowKernels& kernels = GetRowKernels();
+    const size_t rowPitch = static_cast<size_t>(desc.Width) * 4;
+    const uint32_t cellWidth = desc.CellWidth ? desc.CellWidth : std::max(desc.Width >> 3, 1u);
+    const uint32_t cellHeight = desc.CellHeight ? desc.CellHeight : std::max(desc.Width >> 3, 1u);
+
+    // Buffer for the float values of a row
+    std::vector<float> row;
+    std::vector<NoiseOctave> octaves;
+    if (desc.Type != PATTERN_CHECKERBOARD)
+        row.resize(desc.Width);
+    if (desc.Type == PATTERN_VALUE_NOISE || desc.Type == PATTERN_PERLIN_NOISE)
+        BuildNoiseOctaves(desc, cellWidth, cellHeight, octaves);
+
+    // Rows that are the same as the previous one (kind of row) are copied rather than built again
+    uint32_t previousKind = UINT32_MAX;
+
+    for (uint32_t y = firstRow; y < firstRow + rowCount; y++)
+    {
+        uint32_t* texels = reinterpret_cast<uint32_t*>(data + y * rowPitch);
+
+        // Kind of row: the rows of the same kind are identical
+        uint32_t kind = y;
+        if (desc.Type == PATTERN_CHECKERBOARD)
+            kind = (y / cellHeight) & 1;
+        else if (desc.Type == PATTERN_TEST)
+            kind = (y % cellHeight == 0) ? 0 : (y < desc.Height * 2 / 3 ? 1 : 2);
+
+        if (kind == previousKind)
+        {
+            memcpy(texels, texels - desc.Width, rowPitch);
+            continue;
+        }
+        previousKind = kind;
+
+        switch (desc.Type)
+        {
+        case PATTERN_CHECKERBOARD:
+            // Runs of cellWidth texels of the two colors, starting with the first one on even rows of cells
+            for (uint32_t x = 0, i = kind; x < desc.Width; x += cellWidth, i++)
+                kernels.FillRow(texels + x, std::min(cellWidth, desc.Width - x), (i & 1) ? desc.Color1 : desc.Color0);
+            break;
+
+        case PATTERN_GRADIENT:
+        {
+            // t = (x + y) / (width + height - 2), along the diagonal
+            float scale = 1.0f / std::max(desc.Width + desc.Height - 2, 1u);
+            kernels.Ramp(row.data(), desc.Width, y * scale, scale);
+            kernels.Colorize(texels, row.data(), desc.Width, desc.Color0, desc.Color1);
+            break;
+        }
+
+        case PATTERN_VALUE_NOISE:
+        case PATTERN_PERLIN_NOISE:
+            EvaluateNoiseRow(kernels, desc, octaves, y, row.data());
+            kernels.Colorize(texels, row.data(), desc.Width, desc.Color0, desc.Color1);
+            break;
+
+        case PATTERN_TEST:
+            if (kind == 0)
+            {
+                // Horizontal line of the grid
+                kernels.FillRow(texels, desc.Width, s_gridColor);
+                break;
+            }
+
+            if (kind == 1)
+            {
+                // Color bars on the top two thirds
+                for (uint32_t b = 0; b < 8; b++)
+                {
+                    uint32_t start = desc.Width * b / 8;
+                    kernels.FillRow(texels + start, desc.Width * (b + 1) / 8 - start, s_colorBars[b]);
+                }
+            }
+            else
+            {
+                // Gray ramp from black to white on the bottom third
+                kernels.Ramp(row.data(), desc.Width, 0.0f, 1.0f / std::max(desc.Width - 1, 1u));
+                kernels.Colorize(texels, row.data(), desc.Width, 0xff000000, 0xffffffff);
+            }
+
+            // Vertical lines of the grid
+            for (uint32_t x = 0; x < desc.Width; x += cellWidth)
+                texels[x] = s_gridColor;
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+const char* VKTextureSynth::GetInstructionSet()
+{
+    return GetRowKernels().Name;
+}
+
+static const char* s_patternNames[VKTextureSynth::PATTERN_COUNT] = {
+    "checkerboard", "gradient", "value", "perlin", "test"
+};
+
+VKTextureSynth::Pattern VKTextureSynth::GetPattern(const char* name)
+{
+    for (uint32_t i = 0; i < PATTERN_COUNT; i++)
+        if (strcmp(name, s_patternNames[i]) == 0)
+            return static_cast<Pattern>(i);
+
+    return PATTERN_COUNT;
+}
+
+const char* VKTextureSynth::GetPatternName(Pattern pattern)
+{
+    return pattern < PATTERN_COUNT ? s_patternNames[pattern] : "unknown";
+}
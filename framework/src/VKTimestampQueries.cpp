@@ -0,0 +1,89 @@
+#include "stdafx.h"
+#include "VKDebug.hpp"
+#include "VKTimestampQueries.hpp"
+
+VKTimestampQueries::VKTimestampQueries() :
+    m_device(VK_NULL_HANDLE),
+    m_queryPool(VK_NULL_HANDLE),
+    m_timestampPeriod(1.0f),
+    m_timestampMask(0)
+{
+}
+
+VKTimestampQueries::~VKTimestampQueries()
+{
+    Destroy();
+}
+
+bool VKTimestampQueries::Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamilyIndex, uint32_t pairCount)
+{
+    m_device = device;
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+
+    // Timestamps are only supported if the queue family exposes at least one valid bit for them.
+    uint32_t validBits = queueFamilyProperties[queueFamilyIndex].timestampValidBits;
+    if (validBits == 0)
+        return false;
+
+    m_timestampMask = (validBits >= 64) ? UINT64_MAX : ((1ull << validBits) - 1);
+    m_timestampPeriod = deviceProperties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo queryPoolInfo = {};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = 2 * pairCount;
+    VK_CHECK_RESULT(vkCreateQueryPool(m_device, &queryPoolInfo, nullptr, &m_queryPool));
+
+    return true;
+}
+
+void VKTimestampQueries::Destroy()
+{
+    if (m_queryPool != VK_NULL_HANDLE)
+        vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+
+    m_queryPool = VK_NULL_HANDLE;
+    m_device = VK_NULL_HANDLE;
+}
+
+void VKTimestampQueries::Begin(VkCommandBuffer cmd, uint32_t pair, VkPipelineStageFlagBits stage)
+{
+    vkCmdResetQueryPool(cmd, m_queryPool, 2 * pair, 2);
+    vkCmdWriteTimestamp(cmd, stage, m_queryPool, 2 * pair);
+}
+
+void VKTimestampQueries::End(VkCommandBuffer cmd, uint32_t pair, VkPipelineStageFlagBits stage)
+{
+    vkCmdWriteTimestamp(cmd, stage, m_queryPool, 2 * pair + 1);
+}
+
+bool VKTimestampQueries::GetElapsed(uint32_t pair, bool wait, double* milliseconds) const
+{
+    // Without waiting, each result is followed by its availability value: if (for any reason)
+    // the timestamps are not available yet, the caller just drops this sample.
+    uint64_t results[4] = {};
+    VkResult res;
+
+    if (wait)
+        res = vkGetQueryPoolResults(m_device, m_queryPool, 2 * pair, 2, sizeof(results), results, 2 * sizeof(uint64_t),
+                                    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    else
+        res = vkGetQueryPoolResults(m_device, m_queryPool, 2 * pair, 2, sizeof(results), results, 2 * sizeof(uint64_t),
+                                    VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+    if (res != VK_SUCCESS || (!wait && (results[1] == 0 || results[3] == 0)))
+        return false;
+
+    // Masking the difference with the valid bits handles the case where the counter wrapped around.
+    uint64_t ticks = (results[2] - results[0]) & m_timestampMask;
+    *milliseconds = static_cast<double>(ticks) * m_timestampPeriod / 1000000.0;
+
+    return true;
+}
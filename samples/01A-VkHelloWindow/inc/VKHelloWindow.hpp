@@ -13,6 +13,12 @@ public:
     virtual void OnRender();
     virtual void OnDestroy();
 
+protected:
+    // A single frame is rendered at a time: command buffers are allocated for each swapchain image,
+    // and a single pair of semaphores is used instead of the per-frame resources of VKSample
+    virtual void AllocateCommandBuffers();
+    virtual void CreateSynchronizationObjects();
+
 private:
     void InitVulkan();
     void SetupPipeline();
@@ -21,5 +27,10 @@ private:
     void SubmitCommandBuffer(uint32_t currentBufferIndex);
     void PresentImage(uint32_t imageIndex);
 
+    // Semaphores signaled when a swapchain image is available, and when the rendering is finished
+    VkSemaphore m_imageAvailableSemaphore = VK_NULL_HANDLE;
+    VkSemaphore m_renderingFinishedSemaphore = VK_NULL_HANDLE;
+
     uint32_t m_commandBufferIndex = 0;
+    uint32_t m_commandBufferCount = 0;
 };
\ No newline at end of file
@@ -13,7 +13,7 @@ if exist "%VULKAN_SDK%\Include\vulkan\vulkan.h" (
     SET VULKAN_INCLUDE=..\..\external\include\vulkan
 )
 
-SET includes=/I inc ^
+SET includes=/I inc /I ..\..\framework\inc ^
 /I %VULKAN_INCLUDE%
 
 SET defines=/D DEBUG /D _WIN32 /D VK_USE_PLATFORM_WIN32_KHR /D _CRT_SECURE_NO_WARNINGS
@@ -29,6 +29,6 @@ SET links=/link kernel32.lib user32.lib shell32.lib gdi32.lib vulkan-1.lib ^
 
 echo Building Project...
 
-cl src/*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
+cl src/*.cpp ..\..\framework\src\*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
 
 del *.obj vc*.idb vc*.pdb
\ No newline at end of file
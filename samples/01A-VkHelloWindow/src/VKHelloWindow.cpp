@@ -1,7 +1,7 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloWindow.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
 
 VKHelloWindow::VKHelloWindow(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name)
@@ -47,7 +47,7 @@ void VKHelloWindow::OnRender()
 {
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, UINT64_MAX, m_sampleParams.ImageAvailableSemaphore, nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, m_imageAvailableSemaphore, nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -87,29 +87,41 @@ void VKHelloWindow::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy semaphores
-    vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.ImageAvailableSemaphore, NULL);
-    vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.RenderingFinishedSemaphore, NULL);
+    vkDestroySemaphore(m_vulkanParams.Device, m_imageAvailableSemaphore, NULL);
+    vkDestroySemaphore(m_vulkanParams.Device, m_renderingFinishedSemaphore, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -118,8 +130,12 @@ void VKHelloWindow::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -153,11 +169,11 @@ void VKHelloWindow::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_t
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentIndexImage];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], &cmdBufInfo));
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -165,7 +181,7 @@ void VKHelloWindow::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_t
     viewport.width = (float)m_width;
     viewport.minDepth = (float)0.0f;
     viewport.maxDepth = (float)1.0f;
-    vkCmdSetViewport(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -173,13 +189,13 @@ void VKHelloWindow::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_t
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 0, 1, &scissor);
 
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]);
 
-    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]));
+    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]));
 }
 
 void VKHelloWindow::SubmitCommandBuffer(uint32_t currentBufferIndex)
@@ -192,13 +208,13 @@ void VKHelloWindow::SubmitCommandBuffer(uint32_t currentBufferIndex)
     submitInfo.pWaitDstStageMask = &waitStageMask;                                           // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                       // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                     // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]; // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]; // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                       // One command buffer
 
-    submitInfo.pWaitSemaphores = &m_sampleParams.ImageAvailableSemaphore;          // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.RenderingFinishedSemaphore;     // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pWaitSemaphores = &m_imageAvailableSemaphore;          // Semaphore(s) to wait upon before the submitted command buffers start executing
+    submitInfo.pSignalSemaphores = &m_renderingFinishedSemaphore;     // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
 }
 
 void VKHelloWindow::PresentImage(uint32_t imageIndex)
@@ -213,13 +229,13 @@ void VKHelloWindow::PresentImage(uint32_t imageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &imageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.RenderingFinishedSemaphore != VK_NULL_HANDLE)
+    if (m_renderingFinishedSemaphore != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.RenderingFinishedSemaphore;
+        presentInfo.pWaitSemaphores = &m_renderingFinishedSemaphore;
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -227,4 +243,46 @@ void VKHelloWindow::PresentImage(uint32_t imageIndex)
         else
             VK_CHECK_RESULT(present);
     }
+}
+
+// In this sample the CPU waits for the GPU to complete each frame, so one command buffer 
+// is recorded for each swapchain image rather than for each frame in flight.
+void VKHelloWindow::AllocateCommandBuffers()
+{
+    if (!m_sampleParams.CommandPool)
+    {
+        VkCommandPoolCreateInfo cmdPoolInfo = {};
+        cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmdPoolInfo.queueFamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+        cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        VK_CHECK_RESULT(vkCreateCommandPool(m_vulkanParams.Device, &cmdPoolInfo, nullptr, &m_sampleParams.CommandPool));
+    }
+
+    // Create one command buffer for each swap chain image
+    m_commandBufferCount = static_cast<uint32_t>(m_vulkanParams.SwapChain.Images.size());
+    m_commandBufferIndex = 0;
+    m_sampleParams.FrameRes.CommandBuffers.resize(m_commandBufferCount);
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.commandPool = m_sampleParams.CommandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = m_commandBufferCount;
+
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, m_sampleParams.FrameRes.CommandBuffers.data()));
+}
+
+void VKHelloWindow::CreateSynchronizationObjects()
+{
+    // Create semaphores to synchronize acquiring presentable images before rendering and 
+    // waiting for drawing to be complete before presenting
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
+
+    // Return an unsignaled semaphore
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_imageAvailableSemaphore));
+
+    // Return an unsignaled semaphore
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_renderingFinishedSemaphore));
 }
\ No newline at end of file
@@ -13,6 +13,12 @@ public:
     virtual void OnRender();
     virtual void OnDestroy();
 
+protected:
+    // A single frame is rendered at a time: command buffers are allocated for each swapchain image,
+    // and a single pair of semaphores is used instead of the per-frame resources of VKSample
+    virtual void AllocateCommandBuffers();
+    virtual void CreateSynchronizationObjects();
+
 private:
     
     void InitVulkan();
@@ -34,9 +40,17 @@ private:
     
     // Vertex buffer
     struct {
-    	VkDeviceMemory memory; // Handle to the device memory backing the vertex buffer
+    	MemoryAllocation memory; // Device memory (sub-allocation) backing the vertex buffer
     	VkBuffer buffer;       // Handle to the Vulkan buffer object that the memory is bound to
     } m_vertices;
     
+    // Semaphores signaled when a swapchain image is available, and when the rendering is finished
+    VkSemaphore m_imageAvailableSemaphore = VK_NULL_HANDLE;
+    VkSemaphore m_renderingFinishedSemaphore = VK_NULL_HANDLE;
+
     uint32_t m_commandBufferIndex = 0;
+    uint32_t m_commandBufferCount = 0;
+
+    // Handles of the named pipeline (registered in the constructor)
+    TableHandle m_pipelineTriangle;
 };
\ No newline at end of file
@@ -7,11 +7,11 @@ else
     VULKAN_INCLUDE=../../external/include/vulkan/
 fi
 
-includes="-Iinc -I$VULKAN_INCLUDE"
+includes="-Iinc -I../../framework/inc -I$VULKAN_INCLUDE"
 
 defines="-DDEBUG -DVK_USE_PLATFORM_XLIB_KHR"
 
-links="-lX11 -lvulkan"
+links="-L../../framework/lib -lvkframework -lX11 -lvulkan -lpthread"
 
 echo Compiling shader...
 cd ../../bin
@@ -19,8 +19,13 @@ glslangValidator -V ../samples/01B-VkHelloTriangle/data/shaders/triangle.vert -o
 glslangValidator -V ../samples/01B-VkHelloTriangle/data/shaders/triangle.frag -o ../samples/01B-VkHelloTriangle/data/shaders/triangle.frag.spv
 
 cd ../samples/01B-VkHelloTriangle
+if [ "$SKIP_FRAMEWORK" != "1" ]; then
+    (cd ../../framework && bash scripts/build.sh) || exit 1
+fi
+
 echo Building project...
 
-g++ -g src/*.cpp -o 01B-VkHelloTriangle.out $includes $defines $links
+source ../../scripts/compile.sh
 
-rm -f *.o
\ No newline at end of file
+compile_sources obj "$includes $defines" src/*.cpp || exit 1
+link_executable 01B-VkHelloTriangle.out ../../framework/lib/libvkframework.a "$links" $OBJECTS || exit 1
\ No newline at end of file
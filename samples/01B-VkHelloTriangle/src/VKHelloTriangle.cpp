@@ -1,11 +1,13 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloTriangle.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
 
 VKHelloTriangle::VKHelloTriangle(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name)
 {
+    // Register the named pipeline, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineTriangle = m_sampleParams.Pipelines.Register("Triangle");
 }
 
 void VKHelloTriangle::OnInit()
@@ -31,7 +33,9 @@ void VKHelloTriangle::SetupPipeline()
 {
     CreateVertexBuffer();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
     m_initialized = true;
 }
 
@@ -50,7 +54,7 @@ void VKHelloTriangle::OnRender()
 {
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, UINT64_MAX, m_sampleParams.ImageAvailableSemaphore, nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, m_imageAvailableSemaphore, nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -83,11 +87,11 @@ void VKHelloTriangle::OnDestroy()
 
     // Destroy vertex buffer object and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertices.buffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertices.memory, nullptr);
+    m_memAllocator.Free(m_vertices.memory);
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.GraphicsPipeline, nullptr);
+    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.Pipelines[m_pipelineTriangle], nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -98,29 +102,44 @@ void VKHelloTriangle::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy semaphores
-    vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.ImageAvailableSemaphore, NULL);
-    vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.RenderingFinishedSemaphore, NULL);
+    vkDestroySemaphore(m_vulkanParams.Device, m_imageAvailableSemaphore, NULL);
+    vkDestroySemaphore(m_vulkanParams.Device, m_renderingFinishedSemaphore, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -129,8 +148,12 @@ void VKHelloTriangle::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -165,15 +188,6 @@ void VKHelloTriangle::CreateVertexBuffer()
     // This is not recommended as it can often result in lower rendering performance
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -185,19 +199,10 @@ void VKHelloTriangle::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertices.buffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertices.memory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertices.memory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, vertexBuffer.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertices.memory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertices.buffer, m_vertices.memory, 0));
+    m_memAllocator.AllocateBufferMemory(m_vertices.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertices.memory);
+
+    // Copy the vertex data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertices.memory.MappedMemory, vertexBuffer.data(), vertexBufferSize);
 }
 
 void VKHelloTriangle::CreatePipelineLayout()
@@ -402,7 +407,7 @@ void VKHelloTriangle::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline using the specified states
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipeline));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineTriangle]));
     
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -437,11 +442,11 @@ void VKHelloTriangle::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentIndexImage];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], &cmdBufInfo));
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -449,7 +454,7 @@ void VKHelloTriangle::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_
     viewport.width = (float)m_width;
     viewport.minDepth = (float)0.0f;
     viewport.maxDepth = (float)1.0f;
-    vkCmdSetViewport(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -457,25 +462,25 @@ void VKHelloTriangle::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 0, 1, &scissor);
 
     // Bind the graphics pipeline.
     // The pipeline object contains all states of the graphics pipeline, 
     // binding it will set all the states specified at pipeline creation time
-    vkCmdBindPipeline(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_sampleParams.GraphicsPipeline);
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_sampleParams.Pipelines[m_pipelineTriangle]);
     
     // Bind triangle vertex buffer (contains position and colors)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 0, 1, &m_vertices.buffer, offsets);
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 0, 1, &m_vertices.buffer, offsets);
     
     // Draw triangle
-    vkCmdDraw(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 3, 1, 0, 0);
+    vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 3, 1, 0, 0);
     
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]);
     
-     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]));
+     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]));
 }
 
 void VKHelloTriangle::SubmitCommandBuffer(uint32_t currentBufferIndex)
@@ -488,13 +493,13 @@ void VKHelloTriangle::SubmitCommandBuffer(uint32_t currentBufferIndex)
     submitInfo.pWaitDstStageMask = &waitStageMask;                                           // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                       // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                     // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]; // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]; // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                       // One command buffer
 
-    submitInfo.pWaitSemaphores = &m_sampleParams.ImageAvailableSemaphore;          // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.RenderingFinishedSemaphore;     // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pWaitSemaphores = &m_imageAvailableSemaphore;          // Semaphore(s) to wait upon before the submitted command buffers start executing
+    submitInfo.pSignalSemaphores = &m_renderingFinishedSemaphore;     // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
 }
 
 void VKHelloTriangle::PresentImage(uint32_t imageIndex)
@@ -509,13 +514,13 @@ void VKHelloTriangle::PresentImage(uint32_t imageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &imageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.RenderingFinishedSemaphore != VK_NULL_HANDLE)
+    if (m_renderingFinishedSemaphore != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.RenderingFinishedSemaphore;
+        presentInfo.pWaitSemaphores = &m_renderingFinishedSemaphore;
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -523,4 +528,46 @@ void VKHelloTriangle::PresentImage(uint32_t imageIndex)
         else
             VK_CHECK_RESULT(present);
     }
+}
+
+// In this sample the CPU waits for the GPU to complete each frame, so one command buffer 
+// is recorded for each swapchain image rather than for each frame in flight.
+void VKHelloTriangle::AllocateCommandBuffers()
+{
+    if (!m_sampleParams.CommandPool)
+    {
+        VkCommandPoolCreateInfo cmdPoolInfo = {};
+        cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmdPoolInfo.queueFamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+        cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        VK_CHECK_RESULT(vkCreateCommandPool(m_vulkanParams.Device, &cmdPoolInfo, nullptr, &m_sampleParams.CommandPool));
+    }
+
+    // Create one command buffer for each swap chain image
+    m_commandBufferCount = static_cast<uint32_t>(m_vulkanParams.SwapChain.Images.size());
+    m_commandBufferIndex = 0;
+    m_sampleParams.FrameRes.CommandBuffers.resize(m_commandBufferCount);
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.commandPool = m_sampleParams.CommandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = m_commandBufferCount;
+
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, m_sampleParams.FrameRes.CommandBuffers.data()));
+}
+
+void VKHelloTriangle::CreateSynchronizationObjects()
+{
+    // Create semaphores to synchronize acquiring presentable images before rendering and 
+    // waiting for drawing to be complete before presenting
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
+
+    // Return an unsignaled semaphore
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_imageAvailableSemaphore));
+
+    // Return an unsignaled semaphore
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_renderingFinishedSemaphore));
 }
\ No newline at end of file
@@ -13,7 +13,9 @@
 #include <algorithm>
 #include <string>
 #include <vector>
+#include <map>
 #include <array>
+#include <chrono>
 #include <string.h>
 #include <assert.h>
 
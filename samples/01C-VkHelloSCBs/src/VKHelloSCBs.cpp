@@ -1,11 +1,13 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloSCBs.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
 
 VKHelloSCB::VKHelloSCB(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name)
 {
+    // Register the named pipeline, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineTriangle = m_sampleParams.Pipelines.Register("Triangle");
 }
 
 void VKHelloSCB::OnInit()
@@ -31,7 +33,9 @@ void VKHelloSCB::SetupPipeline()
 {
     CreateVertexBuffer();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
     AllocateSCBs();
     PopulateSCBs();
     m_initialized = true;
@@ -44,7 +48,7 @@ void VKHelloSCB::AllocateSCBs()
 
     VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
     commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    commandBufferAllocateInfo.commandPool = m_sampleParams.GraphicsCommandPool;
+    commandBufferAllocateInfo.commandPool = m_sampleParams.CommandPool;
     commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
     commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(m_secondaryCommandBuffers.size());
 
@@ -94,7 +98,7 @@ void VKHelloSCB::PopulateSCBs()
         // Bind the graphics pipeline.
         // The pipeline object contains all states of the graphics pipeline, 
         // binding it will set all the states specified at pipeline creation time
-        vkCmdBindPipeline(m_secondaryCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_sampleParams.GraphicsPipeline);
+        vkCmdBindPipeline(m_secondaryCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, m_sampleParams.Pipelines[m_pipelineTriangle]);
         
         // Bind triangle vertex buffer (contains position and colors)
         VkDeviceSize offsets[1] = { 0 };
@@ -123,7 +127,7 @@ void VKHelloSCB::OnRender()
 {
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, UINT64_MAX, m_sampleParams.ImageAvailableSemaphore, nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, m_imageAvailableSemaphore, nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -156,11 +160,11 @@ void VKHelloSCB::OnDestroy()
 
     // Destroy vertex buffer object and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertices.buffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertices.memory, nullptr);
+    m_memAllocator.Free(m_vertices.memory);
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.GraphicsPipeline, nullptr);
+    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.Pipelines[m_pipelineTriangle], nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -171,35 +175,50 @@ void VKHelloSCB::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                         static_cast<uint32_t>(m_sampleParams.GraphicsCommandBuffers.size()), 
-                         m_sampleParams.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                         static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                         m_sampleParams.FrameRes.CommandBuffers.data());
 
     // Free allocated secondary command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
+                         m_sampleParams.CommandPool,
                          static_cast<uint32_t>(m_secondaryCommandBuffers.size()), 
                          m_secondaryCommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy semaphores
-    vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.ImageAvailableSemaphore, NULL);
-    vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.RenderingFinishedSemaphore, NULL);
+    vkDestroySemaphore(m_vulkanParams.Device, m_imageAvailableSemaphore, NULL);
+    vkDestroySemaphore(m_vulkanParams.Device, m_renderingFinishedSemaphore, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -208,8 +227,12 @@ void VKHelloSCB::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -244,15 +267,6 @@ void VKHelloSCB::CreateVertexBuffer()
     // This is not recommended as it can often result in lower rendering performance
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -264,19 +278,10 @@ void VKHelloSCB::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertices.buffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertices.memory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertices.memory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, vertexBuffer.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertices.memory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertices.buffer, m_vertices.memory, 0));
+    m_memAllocator.AllocateBufferMemory(m_vertices.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertices.memory);
+
+    // Copy the vertex data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertices.memory.MappedMemory, vertexBuffer.data(), vertexBufferSize);
 }
 
 void VKHelloSCB::CreatePipelineLayout()
@@ -481,7 +486,7 @@ void VKHelloSCB::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline using the specified states
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipeline));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineTriangle]));
     
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -516,21 +521,21 @@ void VKHelloSCB::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_t cur
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentIndexImage];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], &cmdBufInfo));
 
     // Begin a render pass instance specifying that the contents are recorded in secondary command buffers.
     // vkCmdExecuteCommands is the only valid command on the primary command buffer.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
     // Execute render commands from a secondary command buffer
-    vkCmdExecuteCommands(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 1, &m_secondaryCommandBuffers[currentIndexImage]);
+    vkCmdExecuteCommands(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 1, &m_secondaryCommandBuffers[currentIndexImage]);
 
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]);
     
-     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]));
+     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]));
 }
 
 void VKHelloSCB::SubmitCommandBuffer(uint32_t currentBufferIndex)
@@ -543,13 +548,13 @@ void VKHelloSCB::SubmitCommandBuffer(uint32_t currentBufferIndex)
     submitInfo.pWaitDstStageMask = &waitStageMask;                                           // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                       // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                     // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]; // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]; // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                       // One command buffer
 
-    submitInfo.pWaitSemaphores = &m_sampleParams.ImageAvailableSemaphore;          // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.RenderingFinishedSemaphore;     // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pWaitSemaphores = &m_imageAvailableSemaphore;          // Semaphore(s) to wait upon before the submitted command buffers start executing
+    submitInfo.pSignalSemaphores = &m_renderingFinishedSemaphore;     // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
 }
 
 void VKHelloSCB::PresentImage(uint32_t imageIndex)
@@ -564,13 +569,13 @@ void VKHelloSCB::PresentImage(uint32_t imageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &imageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.RenderingFinishedSemaphore != VK_NULL_HANDLE)
+    if (m_renderingFinishedSemaphore != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.RenderingFinishedSemaphore;
+        presentInfo.pWaitSemaphores = &m_renderingFinishedSemaphore;
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -580,34 +585,53 @@ void VKHelloSCB::PresentImage(uint32_t imageIndex)
     }
 }
 
-void VKHelloSCB::WindowResize(uint32_t width, uint32_t height)
+void VKHelloSCB::OnResize()
 {
-    if (!m_initialized)
-    return;
+    // Secondary Command buffers need to be recreated as they may store
+    // references to the recreated frame buffer
+    vkFreeCommandBuffers(m_vulkanParams.Device, m_sampleParams.CommandPool, static_cast<uint32_t>(m_secondaryCommandBuffers.size()),m_secondaryCommandBuffers.data());
+    AllocateSCBs();
+    PopulateSCBs();
+}
 
-    m_initialized = false;
+// In this sample the CPU waits for the GPU to complete each frame, so one command buffer 
+// is recorded for each swapchain image rather than for each frame in flight.
+void VKHelloSCB::AllocateCommandBuffers()
+{
+    if (!m_sampleParams.CommandPool)
+    {
+        VkCommandPoolCreateInfo cmdPoolInfo = {};
+        cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmdPoolInfo.queueFamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+        cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        VK_CHECK_RESULT(vkCreateCommandPool(m_vulkanParams.Device, &cmdPoolInfo, nullptr, &m_sampleParams.CommandPool));
+    }
 
-    // Ensure all operations on the device have been finished before destroying resources
-    vkDeviceWaitIdle(m_vulkanParams.Device);
+    // Create one command buffer for each swap chain image
+    m_commandBufferCount = static_cast<uint32_t>(m_vulkanParams.SwapChain.Images.size());
+    m_commandBufferIndex = 0;
+    m_sampleParams.FrameRes.CommandBuffers.resize(m_commandBufferCount);
 
-    // Recreate swap chain
-    m_width = width;
-    m_height = height;
-    CreateSwapchain(&m_width, &m_height, false);
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.commandPool = m_sampleParams.CommandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = m_commandBufferCount;
 
-    // Recreate the frame buffers
-    for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
-        vkDestroyFramebuffer(m_vulkanParams.Device, m_sampleParams.Framebuffers[i], nullptr);
-    }
-    CreateFrameBuffers();
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, m_sampleParams.FrameRes.CommandBuffers.data()));
+}
 
+void VKHelloSCB::CreateSynchronizationObjects()
+{
+    // Create semaphores to synchronize acquiring presentable images before rendering and 
+    // waiting for drawing to be complete before presenting
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
 
-    // Secondary Command buffers need to be recreated as they may store
-    // references to the recreated frame buffer
-    vkFreeCommandBuffers(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, static_cast<uint32_t>(m_secondaryCommandBuffers.size()),m_secondaryCommandBuffers.data());
-    AllocateSCBs();
-    PopulateSCBs();
-    vkDeviceWaitIdle(m_vulkanParams.Device);
+    // Return an unsignaled semaphore
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_imageAvailableSemaphore));
 
-    m_initialized = true;
+    // Return an unsignaled semaphore
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_renderingFinishedSemaphore));
 }
\ No newline at end of file
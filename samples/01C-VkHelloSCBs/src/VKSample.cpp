@@ -1,631 +0,0 @@
-#include "stdafx.h"
-#include "VKApplication.hpp"
-#include "VKSample.hpp"
-#include "VKDebug.h"
-
-VKSample::VKSample(unsigned int width, unsigned int height, std::string name) :
-    m_width(width),
-    m_height(height),
-    m_title(name),
-    m_initialized(false),
-    m_deviceProperties{},
-    m_frameCounter(0),
-    m_lastFPS{}
-{
-    m_aspectRatio = static_cast<float>(width) / static_cast<float>(height);
-}
-
-VKSample::~VKSample()
-{
-}
-
-// Helper function for setting the window's title text.
-const std::string VKSample::GetWindowTitle()
-{
-    std::string device(m_deviceProperties.deviceName);
-    std::string windowTitle;
-    windowTitle = m_title + " - " + device + " - " + std::string(m_lastFPS);
-
-    return windowTitle;
-}
-
-void VKSample::CreateInstance()
-{
-    // Application info
-    VkApplicationInfo appInfo = {};
-    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    appInfo.pApplicationName = GetTitle(); // "VK Hello Window"
-    appInfo.pEngineName = GetTitle();      // "VK Hello Window"
-    appInfo.apiVersion = VK_API_VERSION_1_0;
-
-    // Add a generic surface extension, which specifies we want to render on the screen
-    std::vector<const char*> instanceExtensions = { 
-        VK_KHR_SURFACE_EXTENSION_NAME 
-    };
-
-    // However we also need to add platform-specific surface extensions as well.
-#if defined(_WIN32)
-    instanceExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
-#elif defined(VK_USE_PLATFORM_XLIB_KHR)
-    instanceExtensions.push_back(VK_KHR_XLIB_SURFACE_EXTENSION_NAME);
-#endif
-
-    // Add extension supporting validation layers
-    if (VKApplication::settings.validation)
-        instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-
-    // Get supported instance extensions
-    uint32_t extCount = 0;
-    std::vector<std::string> extensionNames;
-    vkEnumerateInstanceExtensionProperties(nullptr, &extCount, nullptr);
-    if (extCount > 0)
-    {
-        std::vector<VkExtensionProperties> supportedInstanceExtensions(extCount);
-        if (vkEnumerateInstanceExtensionProperties(nullptr, &extCount, &supportedInstanceExtensions.front()) == VK_SUCCESS)
-        {
-            for (const VkExtensionProperties& extension : supportedInstanceExtensions)
-            {
-                extensionNames.push_back(extension.extensionName);
-            }
-        }
-        else
-        {
-            printf("vkEnumerateInstanceExtensionProperties did not return VK_SUCCESS.\n");
-            assert(0);
-        }
-    }
-
-    //
-    // Create our vulkan instance
-    // 
-
-    VkInstanceCreateInfo instanceCreateInfo = {};
-    instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-    instanceCreateInfo.pNext = NULL;
-    instanceCreateInfo.pApplicationInfo = &appInfo;
-
-    // Check that the instance extensions we want to enable are supported
-    if (instanceExtensions.size() > 0)
-    {
-        for (const char* instanceExt : instanceExtensions)
-        {
-            // Output message if requested extension is not available
-            if (std::find(extensionNames.begin(), extensionNames.end(), instanceExt) == extensionNames.end())
-            {
-                printf("Instance extension not present!\n");
-                assert(0);
-            }
-        }
-
-        // Set extension to enable
-        instanceCreateInfo.enabledExtensionCount = (uint32_t)instanceExtensions.size();
-        instanceCreateInfo.ppEnabledExtensionNames = instanceExtensions.data();
-    }
-
-    // The VK_LAYER_KHRONOS_validation contains all current validation functionality.
-    const char* validationLayerName = "VK_LAYER_KHRONOS_validation";
-    if (VKApplication::settings.validation)
-    {
-        // Check if this layer is available at instance level
-        uint32_t instanceLayerCount;
-        vkEnumerateInstanceLayerProperties(&instanceLayerCount, nullptr);
-        std::vector<VkLayerProperties> instanceLayerProperties(instanceLayerCount);
-        vkEnumerateInstanceLayerProperties(&instanceLayerCount, instanceLayerProperties.data());
-        bool validationLayerPresent = false;
-        for (const VkLayerProperties& layer : instanceLayerProperties) {
-            if (strcmp(layer.layerName, validationLayerName) == 0) {
-                validationLayerPresent = true;
-                break;
-            }
-        }
-        if (validationLayerPresent) { // Enable validation layer
-            instanceCreateInfo.ppEnabledLayerNames = &validationLayerName;
-            instanceCreateInfo.enabledLayerCount = 1;
-        }
-        else
-        {
-            printf("Validation layer VK_LAYER_KHRONOS_validation not present, validation is disabled\n");
-            assert(0);
-        }
-    }
-
-    // Create the Vulkan instance
-    VK_CHECK_RESULT(vkCreateInstance(&instanceCreateInfo, nullptr, &m_vulkanParams.Instance));
-    
-    // Set callback to handle validation messages
-    if (VKApplication::settings.validation)
-        setupDebugUtil(m_vulkanParams.Instance);
-}
-
-void VKSample::CreateSurface()
-{
-    VkResult err = VK_SUCCESS;
-
-    // Create the os-specific surface
-#if defined(VK_USE_PLATFORM_WIN32_KHR)
-    VkWin32SurfaceCreateInfoKHR surfaceCreateInfo = {};
-    surfaceCreateInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
-    surfaceCreateInfo.hinstance = VKApplication::winParams.hInstance;
-    surfaceCreateInfo.hwnd = VKApplication::winParams.hWindow;
-    err = vkCreateWin32SurfaceKHR(m_vulkanParams.Instance, &surfaceCreateInfo, nullptr, &m_vulkanParams.PresentationSurface);
-#elif defined(VK_USE_PLATFORM_XLIB_KHR)
-    VkXlibSurfaceCreateInfoKHR surfaceCreateInfo = {};
-    surfaceCreateInfo.sType = VK_STRUCTURE_TYPE_XLIB_SURFACE_CREATE_INFO_KHR;
-    surfaceCreateInfo.dpy = VKApplication::winParams.DisplayPtr;
-    surfaceCreateInfo.window = VKApplication::winParams.Handle;
-    err = vkCreateXlibSurfaceKHR(m_vulkanParams.Instance, &surfaceCreateInfo, nullptr, &m_vulkanParams.PresentationSurface);
-#endif
-
-    VK_CHECK_RESULT(err);
-}
-
-void VKSample::CreateDevice(VkQueueFlags requestedQueueTypes)
-{
-    //
-    // Select physical device
-    //
-
-    unsigned int gpuCount = 0;
-    // Get number of available physical devices
-    vkEnumeratePhysicalDevices(m_vulkanParams.Instance, &gpuCount, nullptr);
-    if (gpuCount == 0)
-    {
-        printf("No device with Vulkan support found\n");
-        assert(0);
-    }
-
-    // Enumerate devices
-    std::vector<VkPhysicalDevice> physicalDevices(gpuCount);
-    VkResult err = vkEnumeratePhysicalDevices(m_vulkanParams.Instance, &gpuCount, physicalDevices.data());
-    if (err)
-    {
-        printf("Could not enumerate physical devices\n");
-        assert(0);
-    }
-
-    // Select a physical device that provides a graphics queue which allows to present on our surface
-    for (unsigned int i = 0; i < gpuCount; ++i) {
-        if (CheckPhysicalDeviceProperties(physicalDevices[i], m_vulkanParams)) 
-        {
-            m_vulkanParams.PhysicalDevice = physicalDevices[i];
-            vkGetPhysicalDeviceProperties(m_vulkanParams.PhysicalDevice, &m_deviceProperties);
-            break;
-        }
-    }
-
-    if (m_vulkanParams.PhysicalDevice == VK_NULL_HANDLE || m_vulkanParams.GraphicsQueue.FamilyIndex == UINT32_MAX)
-    {
-        printf("Could not select physical device based on the chosen properties!\n");
-        assert(0);
-    }
-    else // Get device features and properties
-    {
-        vkGetPhysicalDeviceFeatures(m_vulkanParams.PhysicalDevice, &m_deviceFeatures);
-        vkGetPhysicalDeviceMemoryProperties(m_vulkanParams.PhysicalDevice, &m_deviceMemoryProperties);
-    }
-
-    // Desired queues need to be requested upon logical device creation.
-    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos{};
-
-    // Array of normalized floating point values (between 0.0 and 1.0 inclusive) specifying priorities of 
-    // work to each requested queue. 
-    // Higher values indicate a higher priority, with 0.0 being the lowest priority and 1.0 being the highest.
-    // Within the same device, queues with higher priority may be allotted more processing time than 
-    // queues with lower priority.
-    const float queuePriorities[] = {1.0f};
-
-    // Request a single Graphics queue
-    VkDeviceQueueCreateInfo queueInfo{};
-    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueInfo.queueFamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
-    queueInfo.queueCount = 1;
-    queueInfo.pQueuePriorities = queuePriorities;
-    queueCreateInfos.push_back(queueInfo);
-
-    // Add swapchain extension
-    std::vector<const char*> deviceExtensions = {
-      VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
-
-    // Get list of supported device extensions
-    uint32_t extCount = 0;
-    std::vector<std::string> supportedDeviceExtensions;
-    vkEnumerateDeviceExtensionProperties(m_vulkanParams.PhysicalDevice, nullptr, &extCount, nullptr);
-    if (extCount > 0)
-    {
-        std::vector<VkExtensionProperties> extensions(extCount);
-        if (vkEnumerateDeviceExtensionProperties(m_vulkanParams.PhysicalDevice, nullptr, &extCount, &extensions.front()) == VK_SUCCESS)
-        {
-            for (const VkExtensionProperties& ext : extensions)
-            {
-                supportedDeviceExtensions.push_back(ext.extensionName);
-            }
-        }
-    }
-
-    //
-    // Create logical device
-    //
-
-    VkDeviceCreateInfo deviceCreateInfo = {};
-    deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());;
-    deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
-
-    // Check that the device extensions we want to enable are supported
-    if (deviceExtensions.size() > 0)
-    {
-        for (const char* enabledExtension : deviceExtensions)
-        {
-            // Output message if requested extension is not available
-            if (std::find(supportedDeviceExtensions.begin(), supportedDeviceExtensions.end(), enabledExtension) == supportedDeviceExtensions.end())
-            {
-                printf("Device extension not present!\n");
-                assert(0);
-            }
-        }
-
-        deviceCreateInfo.enabledExtensionCount = (uint32_t)deviceExtensions.size();
-        deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
-    }
-
-    VK_CHECK_RESULT(vkCreateDevice(m_vulkanParams.PhysicalDevice, &deviceCreateInfo, nullptr, &m_vulkanParams.Device));
-}
-
-void VKSample::CreateSwapchain(uint32_t* width, uint32_t* height, bool vsync)
-{
-    // Store the current swap chain handle so we can use it later on to ease up recreation
-    VkSwapchainKHR oldSwapchain = m_vulkanParams.SwapChain.Handle;
-
-    // Get physical device surface capabilities
-    VkSurfaceCapabilitiesKHR surfCaps;
-    VK_CHECK_RESULT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_vulkanParams.PhysicalDevice, m_vulkanParams.PresentationSurface, &surfCaps));
-
-    // Get available present modes
-    uint32_t presentModeCount;
-    VK_CHECK_RESULT(vkGetPhysicalDeviceSurfacePresentModesKHR(m_vulkanParams.PhysicalDevice, m_vulkanParams.PresentationSurface, &presentModeCount, NULL));
-    assert(presentModeCount > 0);
-
-    std::vector<VkPresentModeKHR> presentModes(presentModeCount);
-    VK_CHECK_RESULT(vkGetPhysicalDeviceSurfacePresentModesKHR(m_vulkanParams.PhysicalDevice, m_vulkanParams.PresentationSurface, &presentModeCount, presentModes.data()));
-
-    //
-    // Select a present mode for the swapchain
-    //	
-    // The VK_PRESENT_MODE_FIFO_KHR mode must always be present as per spec.
-    // This mode waits for the vertical blank ("v-sync").
-    VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_FIFO_KHR;
-
-    // If v-sync is not requested, try to find a mailbox mode.
-    // It's the lowest latency non-tearing present mode available.
-    if (!vsync)
-    {
-        for (size_t i = 0; i < presentModeCount; i++)
-        {
-            if (presentModes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
-            {
-                swapchainPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
-                break;
-            }
-            if (presentModes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR)
-            {
-                swapchainPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
-            }
-        }
-    }
-
-    // Determine the number of images and set the number of command buffers.
-    uint32_t desiredNumberOfSwapchainImages = m_commandBufferCount = surfCaps.minImageCount + 1;
-    if ((surfCaps.maxImageCount > 0) && (desiredNumberOfSwapchainImages > surfCaps.maxImageCount))
-    {
-        desiredNumberOfSwapchainImages = surfCaps.maxImageCount;
-    }
-
-    // Find a surface-supported transformation to apply to the image prior to presentation.
-    VkSurfaceTransformFlagsKHR preTransform;
-    if (surfCaps.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR)
-    {
-        // We prefer a non-rotated transform
-        preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
-    }
-    else
-    {
-        // otherwise, use the current transform relative to the presentation engine’s natural orientation
-        preTransform = surfCaps.currentTransform;
-    }
-
-    VkExtent2D swapchainExtent = {};
-    // If width (and height) equals the special value 0xFFFFFFFF, the size of the surface is undefined
-    if (surfCaps.currentExtent.width == (uint32_t)-1)
-    {
-        // The size is set to the size of window's client area.
-        swapchainExtent.width = *width;
-        swapchainExtent.height = *height;
-    }
-    else
-    {
-        // If the surface size is defined, the size of the swapchain images must match
-        swapchainExtent = surfCaps.currentExtent;
-
-        // Save the result in the sample's members in case the inferred surface size and
-        // the size of the client area mismatch.
-        *width = surfCaps.currentExtent.width;
-        *height = surfCaps.currentExtent.height;
-    }
-    
-    // Save the size of the swapchain images
-    m_vulkanParams.SwapChain.Extent = swapchainExtent;
-
-    // Get list of supported surface formats
-    uint32_t formatCount;
-    VK_CHECK_RESULT(vkGetPhysicalDeviceSurfaceFormatsKHR(m_vulkanParams.PhysicalDevice, m_vulkanParams.PresentationSurface, &formatCount, NULL));
-    assert(formatCount > 0);
-
-    std::vector<VkSurfaceFormatKHR> surfaceFormats(formatCount);
-    VK_CHECK_RESULT(vkGetPhysicalDeviceSurfaceFormatsKHR(m_vulkanParams.PhysicalDevice, m_vulkanParams.PresentationSurface, &formatCount, surfaceFormats.data()));
-
-    // Iterate over the list of available surface format and check for the presence of a four-component, 32-bit unsigned normalized format
-    // with 8 bits per component.
-    bool preferredFormatFound = false;
-    for (auto&& surfaceFormat : surfaceFormats)
-    {
-        if (surfaceFormat.format == VK_FORMAT_B8G8R8A8_UNORM || surfaceFormat.format == VK_FORMAT_R8G8B8A8_UNORM)
-        {
-            m_vulkanParams.SwapChain.Format = surfaceFormat.format;
-            m_vulkanParams.SwapChain.ColorSpace = surfaceFormat.colorSpace;
-            preferredFormatFound = true;
-            break;
-        }
-    }
-
-    // Can't find our preferred formats... Falling back to first exposed format. Rendering may be incorrect.
-    if (!preferredFormatFound)
-    {
-        m_vulkanParams.SwapChain.Format = surfaceFormats[0].format;
-        m_vulkanParams.SwapChain.ColorSpace = surfaceFormats[0].colorSpace;
-    }
-
-    // Find a supported composite alpha mode (not all devices support alpha opaque)
-    VkCompositeAlphaFlagBitsKHR compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
-    // Simply select the first composite alpha mode available
-    std::vector<VkCompositeAlphaFlagBitsKHR> compositeAlphaFlags = {
-        VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-        VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR,
-        VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR,
-        VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
-    };
-    for (auto& compositeAlphaFlag : compositeAlphaFlags) {
-        if (surfCaps.supportedCompositeAlpha & compositeAlphaFlag) {
-            compositeAlpha = compositeAlphaFlag;
-            break;
-        };
-    }
-
-    VkSwapchainCreateInfoKHR swapchainCI = {};
-    swapchainCI.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-    swapchainCI.surface = m_vulkanParams.PresentationSurface;
-    swapchainCI.minImageCount = desiredNumberOfSwapchainImages;
-    swapchainCI.imageFormat = m_vulkanParams.SwapChain.Format;
-    swapchainCI.imageColorSpace = m_vulkanParams.SwapChain.ColorSpace;
-    swapchainCI.imageExtent = { swapchainExtent.width, swapchainExtent.height };
-    swapchainCI.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-    swapchainCI.preTransform = (VkSurfaceTransformFlagBitsKHR)preTransform;
-    swapchainCI.imageArrayLayers = 1;
-    swapchainCI.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
-    swapchainCI.presentMode = swapchainPresentMode;
-    // Setting oldSwapChain to the saved handle of the previous swapchain aids in resource reuse and makes sure that we can still present already acquired images
-    swapchainCI.oldSwapchain = oldSwapchain;
-    // Setting clipped to VK_TRUE allows the implementation to discard rendering outside of the surface area
-    swapchainCI.clipped = VK_TRUE;
-    swapchainCI.compositeAlpha = compositeAlpha;
-
-    // Enable transfer source on swap chain images if supported
-    if (surfCaps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
-        swapchainCI.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-    }
-
-    // Enable transfer destination on swap chain images if supported
-    if (surfCaps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) {
-        swapchainCI.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-    }
-
-    VK_CHECK_RESULT(vkCreateSwapchainKHR(m_vulkanParams.Device, &swapchainCI, nullptr, &m_vulkanParams.SwapChain.Handle));
-
-    // If an existing swap chain is re-created, destroy the old swap chain.
-    // This also cleans up all the presentable images.
-    if (oldSwapchain != VK_NULL_HANDLE)
-    {
-        for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
-        {
-            vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
-        }
-        vkDestroySwapchainKHR(m_vulkanParams.Device, oldSwapchain, nullptr);
-    }
-
-    // Get the swap chain images
-    uint32_t imageCount = 0;
-    VK_CHECK_RESULT(vkGetSwapchainImagesKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, &imageCount, NULL));
-
-    m_vulkanParams.SwapChain.Images.resize(imageCount);
-    std::vector<VkImage> images(imageCount);
-    VK_CHECK_RESULT(vkGetSwapchainImagesKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, &imageCount, images.data()));	
-
-    // Get the swapchain buffers containing the image and imageview
-    VkImageViewCreateInfo colorAttachmentView = {};
-    colorAttachmentView.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    colorAttachmentView.format = m_vulkanParams.SwapChain.Format;
-    colorAttachmentView.components = { // Equivalent to:
-        VK_COMPONENT_SWIZZLE_R,        // VK_COMPONENT_SWIZZLE_IDENTITY
-        VK_COMPONENT_SWIZZLE_G,        // VK_COMPONENT_SWIZZLE_IDENTITY
-        VK_COMPONENT_SWIZZLE_B,        // VK_COMPONENT_SWIZZLE_IDENTITY
-        VK_COMPONENT_SWIZZLE_A         // VK_COMPONENT_SWIZZLE_IDENTITY
-    };
-    colorAttachmentView.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    colorAttachmentView.subresourceRange.baseMipLevel = 0;
-    colorAttachmentView.subresourceRange.levelCount = 1;
-    colorAttachmentView.subresourceRange.baseArrayLayer = 0;
-    colorAttachmentView.subresourceRange.layerCount = 1;
-    colorAttachmentView.viewType = VK_IMAGE_VIEW_TYPE_2D;
-
-    // Create the image views, and save them (along with the image objects).
-    for (uint32_t i = 0; i < imageCount; i++)
-    {
-        m_vulkanParams.SwapChain.Images[i].Handle = images[i];
-        colorAttachmentView.image = m_vulkanParams.SwapChain.Images[i].Handle;
-        VK_CHECK_RESULT(vkCreateImageView(m_vulkanParams.Device, &colorAttachmentView, nullptr, &m_vulkanParams.SwapChain.Images[i].View));
-    }
-}
-
-// Create a Render Pass object.
-void VKSample::CreateRenderPass()
-{
-    // This example will use a single render pass with one subpass
-
-    // Descriptors for the attachments used by this renderpass
-    std::array<VkAttachmentDescription, 1> attachments = {};
-
-    // Color attachment
-    attachments[0].format = m_vulkanParams.SwapChain.Format;                        // Use the color format selected by the swapchain
-    attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;                                 // We don't use multi sampling in this example
-    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;                            // Clear this attachment at the start of the render pass
-    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;                          // Keep its contents after the render pass is finished (for displaying it)
-    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;                 // Similar to loadOp, but for stenciling (we don't use stencil here)
-    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;               // Similar to storeOp, but for stenciling (we don't use stencil here)
-    attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;                       // Layout at render pass start. Initial doesn't matter, so we use undefined
-    attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;                   // Layout to which the attachment is transitioned when the render pass is finished
-                                                                                    // As we want to present the color attachment, we transition to PRESENT_KHR
-
-    // Setup attachment references
-    VkAttachmentReference colorReference = {};
-    colorReference.attachment = 0;                                    // Attachment 0 is color
-    colorReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; // Attachment layout used as color during the subpass
-
-    // Setup a single subpass reference
-    VkSubpassDescription subpassDescription = {};
-    subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpassDescription.colorAttachmentCount = 1;                            // Subpass uses one color attachment
-    subpassDescription.pColorAttachments = &colorReference;                 // Reference to the color attachment in slot 0
-    subpassDescription.pDepthStencilAttachment = nullptr;                   // (Depth attachments not used by this sample)
-    subpassDescription.inputAttachmentCount = 0;                            // Input attachments can be used to sample from contents of a previous subpass
-    subpassDescription.pInputAttachments = nullptr;                         // (Input attachments not used by this example)
-    subpassDescription.preserveAttachmentCount = 0;                         // Preserved attachments can be used to loop (and preserve) attachments through subpasses
-    subpassDescription.pPreserveAttachments = nullptr;                      // (Preserve attachments not used by this example)
-    subpassDescription.pResolveAttachments = nullptr;                       // Resolve attachments are resolved at the end of a sub pass and can be used for e.g. multi sampling
-
-    // Setup subpass dependencies
-    std::array<VkSubpassDependency, 1> dependencies = {};
-
-    // Setup dependency and add implicit layout transition from final to initial layout for the color attachment.
-    // (The actual usage layout is preserved through the layout specified in the attachment reference).
-    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependencies[0].dstSubpass = 0;
-    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    dependencies[0].srcAccessMask = VK_ACCESS_NONE;
-    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
-
-    // Create the render pass object
-    VkRenderPassCreateInfo renderPassInfo = {};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());  // Number of attachments used by this render pass
-    renderPassInfo.pAttachments = attachments.data();                            // Descriptions of the attachments used by the render pass
-    renderPassInfo.subpassCount = 1;                                             // We only use one subpass in this example
-    renderPassInfo.pSubpasses = &subpassDescription;                             // Description of that subpass
-    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size()); // Number of subpass dependencies
-    renderPassInfo.pDependencies = dependencies.data();                          // Subpass dependencies used by the render pass
-
-    VK_CHECK_RESULT(vkCreateRenderPass(m_vulkanParams.Device, &renderPassInfo, nullptr, &m_sampleParams.RenderPass));
-}
-
-void VKSample::CreateFrameBuffers()
-{
-    VkImageView attachments[1] = {};
-
-    VkFramebufferCreateInfo frameBufferCreateInfo = {};
-    frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-    frameBufferCreateInfo.pNext = NULL;
-    frameBufferCreateInfo.renderPass = m_sampleParams.RenderPass;
-    frameBufferCreateInfo.attachmentCount = 1;
-    frameBufferCreateInfo.pAttachments = attachments;
-    frameBufferCreateInfo.width = m_width;
-    frameBufferCreateInfo.height = m_height;
-    frameBufferCreateInfo.layers = 1;
-
-    // Create a framebuffer for each swapchain image view
-    m_sampleParams.Framebuffers.resize(m_vulkanParams.SwapChain.Images.size());
-    for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++)
-    {
-        attachments[0] = m_vulkanParams.SwapChain.Images[i].View;
-        VK_CHECK_RESULT(vkCreateFramebuffer(m_vulkanParams.Device, &frameBufferCreateInfo, nullptr, &m_sampleParams.Framebuffers[i]));
-    }
-}
-
-void VKSample::AllocateCommandBuffers()
-{
-    if (!m_sampleParams.GraphicsCommandPool)
-    {
-        VkCommandPoolCreateInfo cmdPoolInfo = {};
-        cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        cmdPoolInfo.queueFamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
-        cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-        VK_CHECK_RESULT(vkCreateCommandPool(m_vulkanParams.Device, &cmdPoolInfo, nullptr, &m_sampleParams.GraphicsCommandPool));
-    }
-
-    // Create one command buffer for each swap chain image
-    m_sampleParams.GraphicsCommandBuffers.resize(m_commandBufferCount);
-
-    VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
-    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    commandBufferAllocateInfo.commandPool = m_sampleParams.GraphicsCommandPool;
-    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(m_sampleParams.GraphicsCommandBuffers.size());
-
-    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, m_sampleParams.GraphicsCommandBuffers.data()));
-}
-
-void VKSample::CreateSynchronizationObjects()
-{
-    // Create semaphores to synchronize acquiring presentable images before rendering and 
-    // waiting for drawing to be complete before presenting
-    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
-    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    semaphoreCreateInfo.pNext = nullptr;
-
-    // Return an unsignaled semaphore
-    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleParams.ImageAvailableSemaphore));
-
-    // Return an unsignaled semaphore
-    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleParams.RenderingFinishedSemaphore));
-}
-
-void VKSample::WindowResize(uint32_t width, uint32_t height)
-{
-    if (!m_initialized)
-        return;
-
-    m_initialized = false;
-
-    // Ensure all operations on the device have been finished before destroying resources
-    vkDeviceWaitIdle(m_vulkanParams.Device);
-
-    // Recreate swap chain
-    m_width = width;
-    m_height = height;
-    CreateSwapchain(&m_width, &m_height, false);
-
-    // Recreate the frame buffers
-    for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
-        vkDestroyFramebuffer(m_vulkanParams.Device, m_sampleParams.Framebuffers[i], nullptr);
-    }
-    CreateFrameBuffers();
-
-
-    // Secondary Command buffers need to be recreated as they may store
-    // references to the recreated frame buffer
-    vkFreeCommandBuffers(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, static_cast<uint32_t>(m_sampleParams.GraphicsCommandBuffers.size()), m_sampleParams.GraphicsCommandBuffers.data());
-    AllocateCommandBuffers();
-
-    vkDeviceWaitIdle(m_vulkanParams.Device);
-
-    m_initialized = true;
-}
\ No newline at end of file
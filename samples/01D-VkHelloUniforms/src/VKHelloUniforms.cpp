@@ -1,11 +1,13 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloUniforms.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
 
 VKHelloUniforms::VKHelloUniforms(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name)
 {
+    // Register the named pipeline, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineTriangle = m_sampleParams.Pipelines.Register("Triangle");
 }
 
 void VKHelloUniforms::OnInit()
@@ -35,7 +37,9 @@ void VKHelloUniforms::SetupPipeline()
     CreateDescriptorSetLayout();
     AllocateDescriptorSet();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
     m_initialized = true;
 }
 
@@ -57,7 +61,7 @@ void VKHelloUniforms::OnRender()
 {
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, UINT64_MAX, m_sampleParams.ImageAvailableSemaphore, nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, m_imageAvailableSemaphore, nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -85,29 +89,26 @@ void VKHelloUniforms::OnDestroy()
 {
     m_initialized = false;
 
-    // Unmap host-visible device memory
-    vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.HostVisibleBuffer.Memory);
-
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
     // Destroy vertex buffer object and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertices.buffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertices.memory, nullptr);
+    m_memAllocator.Free(m_vertices.memory);
 
     // Destroy buffer object and deallocate backing memory
-    vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.HostVisibleBuffer.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_sampleParams.HostVisibleBuffer.Memory, nullptr);
+    vkDestroyBuffer(m_vulkanParams.Device, m_hostVisibleBuffer.Handle, nullptr);
+    m_memAllocator.Free(m_hostVisibleBuffer.Allocation);
 
     // Destroy descriptor pool
-    vkDestroyDescriptorPool(m_vulkanParams.Device, m_sampleParams.DescriptorSet.Pool, nullptr);
+    vkDestroyDescriptorPool(m_vulkanParams.Device, m_sampleParams.DescriptorPool, nullptr);
 
     // Destroy descriptor set layout
-    vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_sampleParams.DescriptorSet.Layout, nullptr);
+    vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_sampleParams.DescriptorSetLayout, nullptr);
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.GraphicsPipeline, nullptr);
+    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.Pipelines[m_pipelineTriangle], nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -118,29 +119,44 @@ void VKHelloUniforms::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy semaphores
-    vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.ImageAvailableSemaphore, NULL);
-    vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.RenderingFinishedSemaphore, NULL);
+    vkDestroySemaphore(m_vulkanParams.Device, m_imageAvailableSemaphore, NULL);
+    vkDestroySemaphore(m_vulkanParams.Device, m_renderingFinishedSemaphore, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -149,8 +165,12 @@ void VKHelloUniforms::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -185,15 +205,6 @@ void VKHelloUniforms::CreateVertexBuffer()
     // This is not recommended as it can often result in lower rendering performance
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -205,19 +216,10 @@ void VKHelloUniforms::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertices.buffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertices.memory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertices.memory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, vertexBuffer.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertices.memory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertices.buffer, m_vertices.memory, 0));
+    m_memAllocator.AllocateBufferMemory(m_vertices.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertices.memory);
+
+    // Copy the vertex data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertices.memory.MappedMemory, vertexBuffer.data(), vertexBufferSize);
 }
 
 void VKHelloUniforms::CreateHostVisibleBuffer()
@@ -227,38 +229,26 @@ void VKHelloUniforms::CreateHostVisibleBuffer()
     // since it needs to be updated from the CPU on a per-frame basis.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
     // Create the buffer object
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-    VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_sampleParams.HostVisibleBuffer.Handle));
+    VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_hostVisibleBuffer.Handle));
 
     // Request a memory allocation from coherent, host-visible device memory that is large 
     // enough to hold the buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device,m_sampleParams.HostVisibleBuffer.Handle, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_sampleParams.HostVisibleBuffer.Memory));
-
-    // Map the host-visible device memory just allocated.
-    // Leave it mapped so that we don't have to map and unmap it every time we want to update the buffer data.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_sampleParams.HostVisibleBuffer.Memory, 0, memAlloc.allocationSize, 0, &m_sampleParams.HostVisibleBuffer.MappedMemory));
-
-    // Bind the buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_sampleParams.HostVisibleBuffer.Handle, m_sampleParams.HostVisibleBuffer.Memory, 0));
+    // The allocator leaves host-visible memory persistently mapped, so that we don't have to map and unmap it 
+    // every time we want to update the buffer data.
+    m_memAllocator.AllocateBufferMemory(m_hostVisibleBuffer.Handle, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_hostVisibleBuffer.Allocation);
+    m_hostVisibleBuffer.MappedMemory = m_hostVisibleBuffer.Allocation.MappedMemory;
 
     // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
-    m_sampleParams.HostVisibleBuffer.Descriptor.buffer = m_sampleParams.HostVisibleBuffer.Handle;
-    m_sampleParams.HostVisibleBuffer.Descriptor.offset = 0;
-    m_sampleParams.HostVisibleBuffer.Descriptor.range = sizeof(uBufVS);
+    m_hostVisibleBuffer.Descriptor.buffer = m_hostVisibleBuffer.Handle;
+    m_hostVisibleBuffer.Descriptor.offset = 0;
+    m_hostVisibleBuffer.Descriptor.range = sizeof(uBufVS);
 }
 
 void VKHelloUniforms::UpdateHostVisibleBufferData()
@@ -275,7 +265,7 @@ void VKHelloUniforms::UpdateHostVisibleBufferData()
 
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    memcpy(m_sampleParams.HostVisibleBuffer.MappedMemory, &uBufVS, sizeof(uBufVS));
+    memcpy(m_hostVisibleBuffer.MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
 void VKHelloUniforms::CreateDescriptorPool()
@@ -306,7 +296,7 @@ void VKHelloUniforms::CreateDescriptorPool()
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
     descriptorPoolInfo.maxSets = 1;
 
-    VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorSet.Pool));
+    VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
 
 void VKHelloUniforms::CreateDescriptorSetLayout()
@@ -329,7 +319,7 @@ void VKHelloUniforms::CreateDescriptorSetLayout()
     descriptorLayout.bindingCount = 1;
     descriptorLayout.pBindings = &layoutBinding;
 
-    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_sampleParams.DescriptorSet.Layout));
+    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_sampleParams.DescriptorSetLayout));
 }
 
 void VKHelloUniforms::AllocateDescriptorSet()
@@ -338,11 +328,11 @@ void VKHelloUniforms::AllocateDescriptorSet()
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor set.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = m_sampleParams.DescriptorSet.Pool;
+    allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
     allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &m_sampleParams.DescriptorSet.Layout;
+    allocInfo.pSetLayouts = &m_sampleParams.DescriptorSetLayout;
 
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, &m_sampleParams.DescriptorSet.Handle));
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, &m_descriptorSet));
 
     //
     // Write the descriptors updating the corresponding descriptor set.
@@ -356,10 +346,10 @@ void VKHelloUniforms::AllocateDescriptorSet()
     // We need to pass the descriptor set where it is store and 
     // the binding point associated with descriptor in the descriptor set.
     writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    writeDescriptorSet.dstSet = m_sampleParams.DescriptorSet.Handle;
+    writeDescriptorSet.dstSet = m_descriptorSet;
     writeDescriptorSet.descriptorCount = 1;
     writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    writeDescriptorSet.pBufferInfo = &m_sampleParams.HostVisibleBuffer.Descriptor;
+    writeDescriptorSet.pBufferInfo = &m_hostVisibleBuffer.Descriptor;
     writeDescriptorSet.dstBinding = 0;
 
     vkUpdateDescriptorSets(m_vulkanParams.Device, 1, &writeDescriptorSet, 0, nullptr);
@@ -373,7 +363,7 @@ void VKHelloUniforms::CreatePipelineLayout()
     pPipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pPipelineLayoutCreateInfo.pNext = nullptr;
     pPipelineLayoutCreateInfo.setLayoutCount = 1;
-    pPipelineLayoutCreateInfo.pSetLayouts = &m_sampleParams.DescriptorSet.Layout;
+    pPipelineLayoutCreateInfo.pSetLayouts = &m_sampleParams.DescriptorSetLayout;
     
     VK_CHECK_RESULT(vkCreatePipelineLayout(m_vulkanParams.Device, &pPipelineLayoutCreateInfo, nullptr, &m_sampleParams.PipelineLayout));
 }
@@ -560,7 +550,7 @@ void VKHelloUniforms::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline using the specified states
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipeline));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineTriangle]));
     
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -595,11 +585,11 @@ void VKHelloUniforms::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentIndexImage];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], &cmdBufInfo));
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -607,7 +597,7 @@ void VKHelloUniforms::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_
     viewport.width = (float)m_width;
     viewport.minDepth = (float)0.0f;
     viewport.maxDepth = (float)1.0f;
-    vkCmdSetViewport(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -615,35 +605,35 @@ void VKHelloUniforms::PopulateCommandBuffer(uint32_t currentBufferIndex, uint32_
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 0, 1, &scissor);
 
     // Bind descriptor sets
-    vkCmdBindDescriptorSets(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 
+    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 
                             VK_PIPELINE_BIND_POINT_GRAPHICS, 
                             m_sampleParams.PipelineLayout, 
                             0, 1, 
-                            &m_sampleParams.DescriptorSet.Handle, 
+                            &m_descriptorSet, 
                             0, nullptr);
 
     // Bind the graphics pipeline.
     // The pipeline object contains all states of the graphics pipeline, 
     // binding it will set all the states specified at pipeline creation time
-    vkCmdBindPipeline(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 
                       VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                      m_sampleParams.GraphicsPipeline);
+                      m_sampleParams.Pipelines[m_pipelineTriangle]);
     
     // Bind triangle vertex buffer (contains position and colors)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 0, 1, &m_vertices.buffer, offsets);
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 0, 1, &m_vertices.buffer, offsets);
     
     // Draw triangle
-    vkCmdDraw(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex], 3, 1, 0, 0);
+    vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex], 3, 1, 0, 0);
     
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]);
     
-     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]));
+     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]));
 }
 
 void VKHelloUniforms::SubmitCommandBuffer(uint32_t currentBufferIndex)
@@ -656,13 +646,13 @@ void VKHelloUniforms::SubmitCommandBuffer(uint32_t currentBufferIndex)
     submitInfo.pWaitDstStageMask = &waitStageMask;                                           // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                       // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                     // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.GraphicsCommandBuffers[currentBufferIndex]; // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[currentBufferIndex]; // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                       // One command buffer
 
-    submitInfo.pWaitSemaphores = &m_sampleParams.ImageAvailableSemaphore;          // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.RenderingFinishedSemaphore;     // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pWaitSemaphores = &m_imageAvailableSemaphore;          // Semaphore(s) to wait upon before the submitted command buffers start executing
+    submitInfo.pSignalSemaphores = &m_renderingFinishedSemaphore;     // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
 }
 
 void VKHelloUniforms::PresentImage(uint32_t imageIndex)
@@ -677,13 +667,13 @@ void VKHelloUniforms::PresentImage(uint32_t imageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &imageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.RenderingFinishedSemaphore != VK_NULL_HANDLE)
+    if (m_renderingFinishedSemaphore != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.RenderingFinishedSemaphore;
+        presentInfo.pWaitSemaphores = &m_renderingFinishedSemaphore;
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -691,4 +681,46 @@ void VKHelloUniforms::PresentImage(uint32_t imageIndex)
         else
             VK_CHECK_RESULT(present);
     }
+}
+
+// In this sample the CPU waits for the GPU to complete each frame, so one command buffer 
+// is recorded for each swapchain image rather than for each frame in flight.
+void VKHelloUniforms::AllocateCommandBuffers()
+{
+    if (!m_sampleParams.CommandPool)
+    {
+        VkCommandPoolCreateInfo cmdPoolInfo = {};
+        cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmdPoolInfo.queueFamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+        cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        VK_CHECK_RESULT(vkCreateCommandPool(m_vulkanParams.Device, &cmdPoolInfo, nullptr, &m_sampleParams.CommandPool));
+    }
+
+    // Create one command buffer for each swap chain image
+    m_commandBufferCount = static_cast<uint32_t>(m_vulkanParams.SwapChain.Images.size());
+    m_commandBufferIndex = 0;
+    m_sampleParams.FrameRes.CommandBuffers.resize(m_commandBufferCount);
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.commandPool = m_sampleParams.CommandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = m_commandBufferCount;
+
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, m_sampleParams.FrameRes.CommandBuffers.data()));
+}
+
+void VKHelloUniforms::CreateSynchronizationObjects()
+{
+    // Create semaphores to synchronize acquiring presentable images before rendering and 
+    // waiting for drawing to be complete before presenting
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = nullptr;
+
+    // Return an unsignaled semaphore
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_imageAvailableSemaphore));
+
+    // Return an unsignaled semaphore
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_renderingFinishedSemaphore));
 }
\ No newline at end of file
@@ -52,7 +52,11 @@ private:
     
     // Vertex buffer
     struct {
-        VkDeviceMemory memory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation memory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer buffer;       // Handle to the Vulkan buffer object that the memory is bound to
     } m_vertices;
+
+    // Handles of the named pipeline and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineTriangle;
+    TableHandle m_descSetGraphics;
 };
\ No newline at end of file
@@ -1,11 +1,14 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloFrameBuffering.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
 
 VKHelloFrameBuffering::VKHelloFrameBuffering(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name)
 {
+    // Register the named pipeline and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineTriangle = m_sampleParams.Pipelines.Register("Triangle");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
 }
 
 void VKHelloFrameBuffering::OnInit()
@@ -35,7 +38,9 @@ void VKHelloFrameBuffering::SetupPipeline()
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
     m_initialized = true;
 }
 
@@ -55,17 +60,15 @@ void VKHelloFrameBuffering::OnUpdate()
 // Render the scene.
 void VKHelloFrameBuffering::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -81,7 +84,7 @@ void VKHelloFrameBuffering::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKHelloFrameBuffering::OnDestroy()
@@ -93,17 +96,14 @@ void VKHelloFrameBuffering::OnDestroy()
 
     // Destroy vertex buffer object and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertices.buffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertices.memory, nullptr);
+    m_memAllocator.Free(m_vertices.memory);
 
     // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -111,7 +111,7 @@ void VKHelloFrameBuffering::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
@@ -122,7 +122,7 @@ void VKHelloFrameBuffering::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.GraphicsPipeline, nullptr);
+    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.Pipelines[m_pipelineTriangle], nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -133,25 +133,40 @@ void VKHelloFrameBuffering::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -160,8 +175,12 @@ void VKHelloFrameBuffering::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -196,15 +215,6 @@ void VKHelloFrameBuffering::CreateVertexBuffer()
     // This is not recommended as it can often result in lower rendering performance
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -216,19 +226,10 @@ void VKHelloFrameBuffering::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertices.buffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertices.memory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertices.memory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, vertexBuffer.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertices.memory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertices.buffer, m_vertices.memory, 0));
+    m_memAllocator.AllocateBufferMemory(m_vertices.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertices.memory);
+
+    // Copy the vertex data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertices.memory.MappedMemory, vertexBuffer.data(), vertexBufferSize);
 }
 
 void VKHelloFrameBuffering::CreateHostVisibleBuffers()
@@ -238,19 +239,14 @@ void VKHelloFrameBuffering::CreateHostVisibleBuffers()
     // since they need to be updated from the CPU on a per-frame basis.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
     // Create buffer object
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle));
 
@@ -258,22 +254,12 @@ void VKHelloFrameBuffering::CreateHostVisibleBuffers()
         // enough to hold the buffer.
         // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
         // will be directly visible to the device without requiring the explicit flushing of cached memory.
-        vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, &memReqs);
-        memAlloc.allocationSize = memReqs.size;
-        memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-        VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory));
-
-        // Map the host-visible device memory just allocated.
-        // Leave it mapped so that we don't have to map and unmap it every time we want to update the buffer data.
-        VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, 
-                                    m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, 
-                                    0, memAlloc.allocationSize, 
-                                    0, &m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory));
-
-        // Bind the buffer object to the backing host-visible device memory just allocated.
-        VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, 
-                                           m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, 
-                                           m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, 0));
+        // The allocator leaves host-visible memory persistently mapped, so that we don't have to map and unmap it 
+        // every time we want to update the buffer data.
+        m_memAllocator.AllocateBufferMemory(m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, 
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
+                                            m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
+        m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory = m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation.MappedMemory;
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -315,11 +301,11 @@ void VKHelloFrameBuffering::CreateDescriptorPool()
     //
 
     // Describe the number of descriptors per type.
-    // This sample uses one descriptor type (uniform buffer) and requests MAX_FRAME_LAG descriptors 
-    // of this type (one for each of the MAX_FRAME_LAG descriptor sets we will use to preserve frame resources)
+    // This sample uses one descriptor type (uniform buffer) and requests m_framesInFlight descriptors 
+    // of this type (one for each of the m_framesInFlight descriptor sets we will use to preserve frame resources)
     VkDescriptorPoolSize typeCounts[1];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     // For additional types you need to add new entries in the type count list
     // E.g. for two combined image samplers:
     // typeCounts[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -333,7 +319,7 @@ void VKHelloFrameBuffering::CreateDescriptorPool()
     descriptorPoolInfo.poolSizeCount = 1;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -363,17 +349,17 @@ void VKHelloFrameBuffering::CreateDescriptorSetLayout()
 
 void VKHelloFrameBuffering::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -383,13 +369,13 @@ void VKHelloFrameBuffering::AllocateDescriptorSets()
 
     VkWriteDescriptorSet writeDescriptorSet = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with descriptor in the descriptor set.
         writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet.dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet.dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet.descriptorCount = 1;
         writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet.pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -594,7 +580,7 @@ void VKHelloFrameBuffering::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline using the specified states
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipeline));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineTriangle]));
     
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -629,11 +615,11 @@ void VKHelloFrameBuffering::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -641,7 +627,7 @@ void VKHelloFrameBuffering::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = (float)0.0f;
     viewport.maxDepth = (float)1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -649,35 +635,35 @@ void VKHelloFrameBuffering::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
 
     // Bind descriptor sets
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                             VK_PIPELINE_BIND_POINT_GRAPHICS, 
                             m_sampleParams.PipelineLayout, 
                             0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
                             0, nullptr);
 
     // Bind the graphics pipeline.
     // The pipeline object contains all states of the graphics pipeline, 
     // binding it will set all the states specified at pipeline creation time
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                       VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                      m_sampleParams.GraphicsPipeline);
+                      m_sampleParams.Pipelines[m_pipelineTriangle]);
     
     // Bind triangle vertex buffer (contains position and colors)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertices.buffer, offsets);
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_vertices.buffer, offsets);
     
     // Draw triangle
-    vkCmdDraw(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 3, 1, 0, 0);
+    vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 3, 1, 0, 0);
     
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
     
-     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKHelloFrameBuffering::SubmitCommandBuffer()
@@ -690,13 +676,13 @@ void VKHelloFrameBuffering::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKHelloFrameBuffering::PresentImage(uint32_t currentImageIndex)
@@ -711,13 +697,13 @@ void VKHelloFrameBuffering::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
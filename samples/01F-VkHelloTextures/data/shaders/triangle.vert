@@ -5,6 +5,7 @@ layout (location = 1) in vec4 inTexCoord;
 
 layout(std140, set = 0, binding = 0) uniform buf {
     vec4 displacement;
+    vec4 texCoordScale;    // Number of times the texture is repeated over the triangle (xy)
 } uBuf;
 
 layout (location = 0) out vec4 outTexCoord;
@@ -13,5 +14,5 @@ void main()
 {
     gl_Position = vec4(inPos, 1.0) + uBuf.displacement;    // Shift vertex position
     gl_Position.y = -gl_Position.y;	                       // Flip y-coords.
-    outTexCoord = inTexCoord;                              // Pass texel coordinates to the next stage
+    outTexCoord = inTexCoord * vec4(uBuf.texCoordScale.xy, 1.0, 1.0);    // Pass (scaled) texel coordinates to the next stage
 }
\ No newline at end of file
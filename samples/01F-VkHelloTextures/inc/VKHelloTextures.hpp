@@ -2,6 +2,9 @@
 
 #include "VKSample.hpp"
 #include "VKSampleHelper.hpp"
+#include "VKTextureLoader.hpp"
+#include "VKTextureSynth.hpp"
+#include "VKJobSystem.hpp"
 
 class VKHelloTextures : public VKSample
 {
@@ -13,6 +16,8 @@ public:
     virtual void OnRender();
     virtual void OnDestroy();
 
+    virtual void EnableFeatures(VkPhysicalDeviceFeatures& features);
+
 private:
     
     void InitVulkan();
@@ -33,19 +38,27 @@ private:
     void UpdateHostVisibleBufferData();   // Update buffer data
 
     std::vector<uint8_t> GenerateTextureData();  // Generate texture data
-    void CreateStagingBuffer();                  // Create a staging buffer
+    bool LoadTextureFile(VKTextureLoader& textureFile);  // Load the texture from a KTX2 file
     void CreateTexture();                        // Create a texture
+    void GenerateMipmaps();                      // Generate the mip levels of the texture from the first one
+
+    // Record the generation of the mip levels with a chain of blits, or with a single dispatch of a compute shader
+    void RecordMipmapBlits(VkCommandBuffer commandBuffer);
+    void RecordMipmapDownsampler(VkCommandBuffer commandBuffer);
+    void DestroyDownsampler();
 
     // For simplicity we use the same uniform block layout as in the vertex shader:
     //
     // layout(set = 0, binding = 0) uniform buf {
     //    vec4 displacement;
+    //    vec4 texCoordScale;
     // } uBuf;
     //
     // This way we can just memcopy the uBufVS data to match the uBuf memory layout.
     // Note: You should use data types that align with the GPU in order to avoid manual padding (vec4, mat4)
     struct {
         float displacement[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float texCoordScale[4] = {1.0f, 1.0f, 0.0f, 0.0f};
     } uBufVS;
     
     // Vertex layout used in this sample
@@ -56,18 +69,50 @@ private:
     
     // Vertex buffer
     struct {
-        VkDeviceMemory memory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation memory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer buffer;       // Handle to the Vulkan buffer object that the memory is bound to
     } m_vertices;
 
     // Texture
     struct {
-        BufferParameters StagingBuffer;    // Staging buffer
         ImageParameters  TextureImage;     // Texture image
 
-        // Texture and texel dimensions
-        const uint32_t TextureWidth = 256;
-        const uint32_t TextureHeight = 256;
-        const uint32_t TextureTexelSize = 4;  // The number of bytes used to represent a texel in the texture.
+        // Texture and texel dimensions (a square, power-of-two texture whose size can be set with --texture-size N,
+        // unless the texture is loaded from a file)
+        uint32_t TextureWidth = 256;
+        uint32_t TextureHeight = 256;
+        const uint32_t TextureTexelSize = 4;  // The number of bytes used to represent a texel in the generated texture.
+        uint32_t MipLevels = 1;               // Number of mip levels (a full chain, down to 1x1, if mipmaps are generated)
+        VkFormat Format = VK_FORMAT_R8G8B8A8_UNORM;   // The format of the file, if the texture is loaded from a file
     } m_texture;
+
+    // How the mip levels of the texture are generated (--mips none|blit|compute)
+    enum MipmapMode {
+        MIPMAPS_NONE,       // A single level
+        MIPMAPS_BLIT,       // A chain of vkCmdBlitImage, each level from the previous one
+        MIPMAPS_COMPUTE     // A single dispatch of a compute shader generating all the levels (see downsample.comp)
+    };
+
+    MipmapMode m_mipmapMode;
+    uint32_t m_anisotropy;    // Max anisotropy of the sampler (--anisotropy N, 0 or 1 to disable anisotropic filtering)
+    uint32_t m_overdraw;      // Number of times the triangle is drawn (--overdraw N), to make the frame texture-bound
+    float m_tiling;           // Number of times the texture is repeated over the triangle (--tiling N)
+    std::string m_textureFile;  // KTX2 file loaded as texture (--texture file.ktx2), which can be block-compressed
+    VKTextureSynth::Pattern m_pattern;  // Pattern of the generated texture (--pattern name)
+
+    // Objects used by the compute downsampler, only needed while generating the mip levels
+    struct {
+        VkDescriptorSetLayout DescriptorSetLayout;
+        VkPipelineLayout PipelineLayout;
+        VkPipeline Pipeline;
+        VkDescriptorPool DescriptorPool;
+        VkDescriptorSet DescriptorSet;
+        std::vector<VkImageView> LevelViews;   // A storage view of each level of the texture
+        VkBuffer CounterBuffer;                // Number of workgroups done (see downsample.comp)
+        MemoryAllocation CounterMemory;
+    } m_downsampler;
+
+    // Handles of the named pipeline and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineTextured;
+    TableHandle m_descSetGraphics;
 };
\ No newline at end of file
@@ -1,15 +1,78 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloTextures.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
+
+// The compute downsampler writes at most 12 levels after the first one, so it supports textures up to 4096x4096.
+// Each workgroup reduces a 64x64 tile of the first level (see downsample.comp).
+#define DOWNSAMPLER_MAX_LEVELS 12
+#define DOWNSAMPLER_TILE_SIZE 64
+
+// Default max anisotropy of the sampler (clamped to the limit of the device)
+#define DEFAULT_ANISOTROPY 16
 
 VKHelloTextures::VKHelloTextures(uint32_t width, uint32_t height, std::string name) :
-VKSample(width, height, name)
+VKSample(width, height, name),
+m_mipmapMode(MIPMAPS_BLIT),
+m_anisotropy(DEFAULT_ANISOTROPY),
+m_overdraw(1),
+m_tiling(1.0f),
+m_pattern(VKTextureSynth::PATTERN_CHECKERBOARD),
+m_downsampler()
 {
+    // Register the named pipeline and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineTextured = m_sampleParams.Pipelines.Register("Textured");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
 }
 
 void VKHelloTextures::OnInit()
 {
+    // --texture loads the texture from a KTX2 file, while --pattern selects the pattern of the generated one
+    // (checkerboard, gradient, value, perlin or test). --mips selects how the mip levels of the texture are generated 
+    // (none, blit or compute), and --anisotropy sets the max anisotropy of the sampler. --texture-size, --tiling and --overdraw make the frame bound by the
+    // texture bandwidth: a large texture, repeated several times over the triangle (so that it's minified), drawn
+    // several times.
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--mips") == 0 && i + 1 < args.size())
+        {
+            const char* mode = args[++i];
+            if (strcmp(mode, "none") == 0)
+                m_mipmapMode = MIPMAPS_NONE;
+            else if (strcmp(mode, "blit") == 0)
+                m_mipmapMode = MIPMAPS_BLIT;
+            else if (strcmp(mode, "compute") == 0)
+                m_mipmapMode = MIPMAPS_COMPUTE;
+            else
+                printf("Unknown mipmap mode: %s (available modes: none, blit, compute)\n", mode);
+        }
+        else if (strcmp(args[i], "--anisotropy") == 0 && i + 1 < args.size())
+            m_anisotropy = static_cast<uint32_t>(strtoul(args[++i], nullptr, 10));
+        else if (strcmp(args[i], "--texture-size") == 0 && i + 1 < args.size())
+            m_texture.TextureWidth = m_texture.TextureHeight = static_cast<uint32_t>(strtoul(args[++i], nullptr, 10));
+        else if (strcmp(args[i], "--tiling") == 0 && i + 1 < args.size())
+            m_tiling = static_cast<float>(strtoul(args[++i], nullptr, 10));
+        else if (strcmp(args[i], "--overdraw") == 0 && i + 1 < args.size())
+            m_overdraw = static_cast<uint32_t>(strtoul(args[++i], nullptr, 10));
+        else if (strcmp(args[i], "--texture") == 0 && i + 1 < args.size())
+            m_textureFile = args[++i];
+        else if (strcmp(args[i], "--pattern") == 0 && i + 1 < args.size())
+        {
+            const char* name = args[++i];
+            VKTextureSynth::Pattern pattern = VKTextureSynth::GetPattern(name);
+            if (pattern != VKTextureSynth::PATTERN_COUNT)
+                m_pattern = pattern;
+            else
+                printf("Unknown pattern: %s (available patterns: checkerboard, gradient, value, perlin, test)\n", name);
+        }
+    }
+
+    m_overdraw = std::max(m_overdraw, 1u);
+    m_tiling = std::max(m_tiling, 1.0f);
+    uBufVS.texCoordScale[0] = m_tiling;
+    uBufVS.texCoordScale[1] = m_tiling;
+
     InitVulkan();
     SetupPipeline();
 }
@@ -18,8 +81,12 @@ void VKHelloTextures::InitVulkan()
 {
     CreateInstance();
     CreateSurface();
-    CreateDevice(VK_QUEUE_GRAPHICS_BIT);
+    CreateDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_TRANSFER_BIT); // Also look for a dedicated transfer queue to upload the texture
     GetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.FamilyIndex, m_vulkanParams.GraphicsQueue.Handle);
+    GetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.TransferQueue.FamilyIndex, m_vulkanParams.TransferQueue.Handle);
+    m_stagingRing.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device,
+                       m_vulkanParams.TransferQueue.Handle, m_vulkanParams.TransferQueue.FamilyIndex,
+                       m_vulkanParams.GraphicsQueue.Handle, m_vulkanParams.GraphicsQueue.FamilyIndex);
     CreateSwapchain(&m_width, &m_height, VKApplication::settings.vsync);
     CreateRenderPass();
     CreateFrameBuffers();
@@ -31,17 +98,29 @@ void VKHelloTextures::SetupPipeline()
 {
     CreateVertexBuffer();
     CreateHostVisibleBuffers();
-    CreateStagingBuffer();
     CreateTexture();
     CreateDescriptorPool();
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
 
     m_initialized = true;
 }
 
+void VKHelloTextures::EnableFeatures(VkPhysicalDeviceFeatures& features)
+{
+    // Anisotropic filtering is an optional feature
+    if (m_anisotropy > 1)
+        features.samplerAnisotropy = m_deviceFeatures.samplerAnisotropy;
+
+    // So is the support of each family of compressed formats (BC, ETC2 and ASTC)
+    if (!m_textureFile.empty())
+        VKTextureLoader::EnableCompressionFeatures(m_deviceFeatures, features);
+}
+
 // Update frame-based values.
 void VKHelloTextures::OnUpdate()
 {
@@ -58,17 +137,15 @@ void VKHelloTextures::OnUpdate()
 // Render the scene.
 void VKHelloTextures::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -84,7 +161,7 @@ void VKHelloTextures::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKHelloTextures::OnDestroy()
@@ -96,25 +173,20 @@ void VKHelloTextures::OnDestroy()
 
     // Destroy vertex buffer object and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertices.buffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertices.memory, nullptr);
+    m_memAllocator.Free(m_vertices.memory);
 
     // Destroy texture resources
-    vkDestroyBuffer(m_vulkanParams.Device, m_texture.StagingBuffer.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_texture.StagingBuffer.Memory, nullptr);
     vkDestroyImageView(m_vulkanParams.Device, m_texture.TextureImage.Descriptor.imageView, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_texture.TextureImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_texture.TextureImage.Memory, nullptr);
+    m_memAllocator.Free(m_texture.TextureImage.Allocation);
     vkDestroySampler(m_vulkanParams.Device, m_texture.TextureImage.Descriptor.sampler, nullptr);
 
     // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -122,7 +194,7 @@ void VKHelloTextures::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
@@ -133,7 +205,7 @@ void VKHelloTextures::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.GraphicsPipeline, nullptr);
+    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.Pipelines[m_pipelineTextured], nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -144,25 +216,43 @@ void VKHelloTextures::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Destroy the staging ring buffer
+    m_stagingRing.Destroy();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -171,8 +261,12 @@ void VKHelloTextures::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -216,15 +310,6 @@ void VKHelloTextures::CreateVertexBuffer()
     // This is not recommended as it can often result in lower rendering performance
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -236,19 +321,10 @@ void VKHelloTextures::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertices.buffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertices.memory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertices.memory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, vertexBuffer.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertices.memory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertices.buffer, m_vertices.memory, 0));
+    m_memAllocator.AllocateBufferMemory(m_vertices.buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertices.memory);
+
+    // Copy the vertex data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertices.memory.MappedMemory, vertexBuffer.data(), vertexBufferSize);
 }
 
 void VKHelloTextures::CreateHostVisibleBuffers()
@@ -258,19 +334,14 @@ void VKHelloTextures::CreateHostVisibleBuffers()
     // since they need to be updated from the CPU on a per-frame basis.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
     // Create the buffer object
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle));
 
@@ -278,22 +349,12 @@ void VKHelloTextures::CreateHostVisibleBuffers()
         // enough to hold the buffer.
         // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
         // will be directly visible to the device without requiring the explicit flushing of cached memory.
-        vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, &memReqs);
-        memAlloc.allocationSize = memReqs.size;
-        memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-        VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory));
-
-        // Map the host-visible device memory just allocated.
-        // Leave it mapped so that we don't have to map and unmap it every time we want to update the buffer data.
-        VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, 
-                                    m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, 
-                                    0, memAlloc.allocationSize, 
-                                    0, &m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory));
-
-        // Bind the buffer object to the backing host-visible device memory just allocated.
-        VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, 
-                                           m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, 
-                                           m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, 0));
+        // The allocator leaves host-visible memory persistently mapped, so that we don't have to map and unmap it 
+        // every time we want to update the buffer data.
+        m_memAllocator.AllocateBufferMemory(m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, 
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
+                                            m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
+        m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory = m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation.MappedMemory;
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -302,182 +363,220 @@ void VKHelloTextures::CreateHostVisibleBuffers()
     }
 }
 
-void VKHelloTextures::CreateStagingBuffer()
+std::vector<uint8_t> VKHelloTextures::GenerateTextureData()
 {
-    // Create a buffer object
-    VkBufferCreateInfo bufferInfo = {};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = m_texture.TextureWidth * m_texture.TextureHeight * m_texture.TextureTexelSize,
-    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_texture.StagingBuffer.Handle));
-
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-
-    // Request a memory allocation from coherent, host-visible device memory that is large 
-    // enough to hold the staging buffer.
-    // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
-    // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_texture.StagingBuffer.Handle, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_texture.StagingBuffer.Memory));
-
-    // Bind the buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, 
-                                        m_texture.StagingBuffer.Handle, 
-                                        m_texture.StagingBuffer.Memory, 0));
-
-    // Map the host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, 
-                                m_texture.StagingBuffer.Memory, 
-                                0, memAlloc.allocationSize, 
-                                0, &m_texture.StagingBuffer.MappedMemory));
-
-    // Copy texture data in the staging buffer
-    std::vector<uint8_t> texData = GenerateTextureData();
-    memcpy(m_texture.StagingBuffer.MappedMemory, texData.data(), texData.size());
-
-    // Unmap staging buffer
-    vkUnmapMemory(m_vulkanParams.Device, m_texture.StagingBuffer.Memory);
+    // Generate the texture selected with --pattern (a black and white checkerboard by default).
+    // VKTextureSynth builds whole rows with SIMD instructions, and splits large textures in bands generated
+    // by the threads of a job system, created for the occasion.
+    VKTextureSynth::Desc desc;
+    desc.Type = m_pattern;
+    desc.Width = m_texture.TextureWidth;
+    desc.Height = m_texture.TextureHeight;
+    desc.Color0 = 0xff000000;   // Black (RGBA8, R in the lowest byte)
+    desc.Color1 = 0xffffffff;   // White
+
+    std::vector<uint8_t> data(static_cast<size_t>(desc.Width) * desc.Height * m_texture.TextureTexelSize);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    VKJobSystem jobSystem;
+    jobSystem.Init();
+    VKTextureSynth::Generate(desc, data.data(), &jobSystem);
+    jobSystem.Destroy();
+    double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    printf("Generated %s texture: %ux%u in %.2f ms (%s, %u threads)\n", VKTextureSynth::GetPatternName(desc.Type), 
+           desc.Width, desc.Height, time, VKTextureSynth::GetInstructionSet(), jobSystem.GetThreadCount());
+ 
+    return data;
 }
 
-std::vector<uint8_t> VKHelloTextures::GenerateTextureData()
+bool VKHelloTextures::LoadTextureFile(VKTextureLoader& textureFile)
 {
-    const size_t rowPitch = m_texture.TextureWidth * m_texture.TextureTexelSize;
-    const size_t cellPitch = rowPitch >> 3;                        // The width of a cell in the checkerboard texture.
-    const size_t cellHeight = m_texture.TextureWidth >> 3;         // The height of a cell in the checkerboard texture.
-    const size_t textureSize = rowPitch * m_texture.TextureHeight;
- 
-    std::vector<uint8_t> data(textureSize);
-    uint8_t* pData = &data[0];
- 
-    for (size_t n = 0; n < textureSize; n += m_texture.TextureTexelSize)
+    if (!textureFile.LoadKTX2(m_textureFile))
+        return false;
+
+    if (textureFile.GetWidth() > m_deviceProperties.limits.maxImageDimension2D || textureFile.GetHeight() > m_deviceProperties.limits.maxImageDimension2D)
     {
-        size_t x = n % rowPitch;
-        size_t y = n / rowPitch;
-        size_t i = x / cellPitch;
-        size_t j = y / cellHeight;
- 
-        if (i % 2 == j % 2)
-        {
-            pData[n] = 0x00;        // R
-            pData[n + 1] = 0x00;    // G
-            pData[n + 2] = 0x00;    // B
-            pData[n + 3] = 0xff;    // A
-        }
-        else
+        printf("%s is too large (%ux%u, max %u)\n", m_textureFile.c_str(), 
+               textureFile.GetWidth(), textureFile.GetHeight(), m_deviceProperties.limits.maxImageDimension2D);
+        return false;
+    }
+
+    // A compressed texture is uploaded and sampled as it is if the device supports its format (with linear filtering,
+    // for trilinear and anisotropic filtering). Otherwise, it's decoded to R8G8B8A8 on the CPU: the texture looks the 
+    // same, but takes as much memory and bandwidth as a non-compressed one.
+    const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    if (!textureFile.IsFormatSupported(m_vulkanParams.PhysicalDevice, m_vulkanParams.EnabledFeatures, requiredFeatures))
+    {
+        const char* fileFormat = textureFile.GetFormatName();
+        if (!textureFile.Decode())
         {
-            pData[n] = 0xff;        // R
-            pData[n + 1] = 0xff;    // G
-            pData[n + 2] = 0xff;    // B
-            pData[n + 3] = 0xff;    // A
+            printf("%s: %s is not supported by the device and can't be decoded on the CPU\n", m_textureFile.c_str(), fileFormat);
+            return false;
         }
+        printf("%s: %s is not supported by the device: decoded to %s on the CPU\n", m_textureFile.c_str(), fileFormat, textureFile.GetFormatName());
     }
- 
-    return data;
+
+    return true;
 }
 
 void VKHelloTextures::CreateTexture()
 {
-    const VkFormat tex_format = VK_FORMAT_R8G8B8A8_UNORM;
+    // Load the texture from the KTX2 file passed with --texture, if any, or generate a checkerboard texture.
+    // A file that can't be used is an error, rather than silently showing a different texture.
+    VKTextureLoader textureFile;
+    const bool fromFile = !m_textureFile.empty();
+    if (fromFile && !LoadTextureFile(textureFile))
+    {
+        printf("The texture file %s can't be used.\nExiting ...\n", m_textureFile.c_str());
+        fflush(stdout);
+        exit(1);
+    }
+
+    m_texture.Format = fromFile ? textureFile.GetFormat() : VK_FORMAT_R8G8B8A8_UNORM;
     VkFormatProperties props;
 
-    vkGetPhysicalDeviceFormatProperties(m_vulkanParams.PhysicalDevice, tex_format, &props);
+    vkGetPhysicalDeviceFormatProperties(m_vulkanParams.PhysicalDevice, m_texture.Format, &props);
+
+    if (fromFile)
+    {
+        m_texture.TextureWidth = textureFile.GetWidth();
+        m_texture.TextureHeight = textureFile.GetHeight();
+    }
+    else
+    {
+        // The generated texture is a square with a power-of-two size (for a simple mip chain, each level being half 
+        // the size of the previous one), of at least 8x8 texels (the checkerboard has 8x8 cells).
+        uint32_t size = 8;
+        while (size * 2 <= std::min(m_texture.TextureWidth, m_deviceProperties.limits.maxImageDimension2D))
+            size *= 2;
+        if (size != m_texture.TextureWidth)
+            printf("The size of the texture must be a power of two between 8 and %u: using %u\n", m_deviceProperties.limits.maxImageDimension2D, size);
+        m_texture.TextureWidth = size;
+        m_texture.TextureHeight = size;
+    }
+
+    if (fromFile && textureFile.GetLevelCount() > 1)
+    {
+        // The mip levels are loaded from the file (a compressed format can't be the destination of a blit or a 
+        // storage image anyway: compressed mip chains must be generated offline).
+        m_mipmapMode = MIPMAPS_NONE;
+        m_texture.MipLevels = textureFile.GetLevelCount();
+    }
+    else
+    {
+        // Number of levels of a full mip chain, down to 1x1
+        const uint32_t size = std::max(m_texture.TextureWidth, m_texture.TextureHeight);
+        uint32_t fullChainLevels = 1;
+        while ((size >> fullChainLevels) > 0)
+            fullChainLevels++;
+
+        // Blits need a format supporting linear filtering, and the compute downsampler a square, power-of-two 
+        // R8G8B8A8_UNORM texture, in a format supporting storage (see downsample.comp).
+        // Fall back on the other mode (or no mipmaps) if the requested one is not supported.
+        const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        bool blitSupported = (props.optimalTilingFeatures & blitFeatures) == blitFeatures;
+        bool computeSupported = (props.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT) && (fullChainLevels - 1 <= DOWNSAMPLER_MAX_LEVELS) &&
+                                m_texture.Format == VK_FORMAT_R8G8B8A8_UNORM && m_texture.TextureWidth == m_texture.TextureHeight && (size & (size - 1)) == 0;
+
+        if (m_mipmapMode == MIPMAPS_COMPUTE && !computeSupported)
+        {
+            printf("The compute downsampler doesn't support this texture (format or size): %s\n", blitSupported ? "using blits" : "no mipmaps");
+            m_mipmapMode = blitSupported ? MIPMAPS_BLIT : MIPMAPS_NONE;
+        }
+        if (m_mipmapMode == MIPMAPS_BLIT && !blitSupported)
+        {
+            printf("The texture format doesn't support linear blits: %s\n", computeSupported ? "using the compute downsampler" : "no mipmaps");
+            m_mipmapMode = computeSupported ? MIPMAPS_COMPUTE : MIPMAPS_NONE;
+        }
 
-    // Check if the device can sample from R8G8B8A8 textures in local device memory
+        m_texture.MipLevels = (m_mipmapMode == MIPMAPS_NONE) ? 1 : fullChainLevels;
+    }
+
+    // Check if the device can sample from textures of this format in local device memory
     if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
     {
-        // Create a texture image
+        // Create a texture image.
+        // The mip levels are generated from the first one by blits (which read the image as a transfer source) or
+        // by a compute shader (which reads and writes the image as a storage image).
         VkImageCreateInfo imageCreateInfo = {};
         imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageCreateInfo.format = tex_format;
+        imageCreateInfo.format = m_texture.Format;
         imageCreateInfo.extent = {m_texture.TextureWidth, m_texture.TextureHeight, 1};
-        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.mipLevels = m_texture.MipLevels;
         imageCreateInfo.arrayLayers = 1;
         imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
         imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
         imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        if (m_mipmapMode == MIPMAPS_BLIT)
+            imageCreateInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        else if (m_mipmapMode == MIPMAPS_COMPUTE)
+            imageCreateInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
         imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
         VK_CHECK_RESULT(vkCreateImage(m_vulkanParams.Device, &imageCreateInfo, nullptr, &m_texture.TextureImage.Handle));
 
-        // Used to request an allocation of a specific size from a certain memory type.
-        VkMemoryAllocateInfo memAlloc = {};
-        memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        VkMemoryRequirements memReqs;
-
-        // Request a memory allocation from local device memory that is large 
-        // enough to hold the texture image.
-        vkGetImageMemoryRequirements(m_vulkanParams.Device, m_texture.TextureImage.Handle, &memReqs);
-        memAlloc.allocationSize = memReqs.size;
-        memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_deviceMemoryProperties);
-        VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_texture.TextureImage.Memory));
-
-        // Bind the image object to the backing local device memory just allocated.
-        VK_CHECK_RESULT(vkBindImageMemory(m_vulkanParams.Device, 
-                                            m_texture.TextureImage.Handle, 
-                                            m_texture.TextureImage.Memory, 0));
-
-        // We need to record some commands to copy staging buffer data to texture image in local device memory
-        VkCommandBufferBeginInfo cmdBufferInfo = {};
-        cmdBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        cmdBufferInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[0], &cmdBufferInfo);
-
-        // Transition the image layout to provide optimal performance for transfering operations that use the image as a destination
-        TransitionImageLayout(m_sampleParams.FrameRes.GraphicsCommandBuffers[0],
-                                m_texture.TextureImage.Handle, VK_IMAGE_ASPECT_COLOR_BIT, 
-                                VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                VK_ACCESS_NONE, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
-                                VK_PIPELINE_STAGE_TRANSFER_BIT);
-
-        // Copy from staging buffer to texture in local device memory
-        VkBufferImageCopy copyRegion = {};
-        copyRegion.bufferOffset = 0;
-        copyRegion.bufferRowLength = 0;
-        copyRegion.bufferImageHeight = 0;
-        copyRegion.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
-        copyRegion.imageOffset = {0, 0, 0};
-        copyRegion.imageExtent = {m_texture.TextureWidth, m_texture.TextureHeight, 1};
-
-        vkCmdCopyBufferToImage(m_sampleParams.FrameRes.GraphicsCommandBuffers[0], 
-                                m_texture.StagingBuffer.Handle, m_texture.TextureImage.Handle, 
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-
-        // Transition the image layout to provide optimal performance for reading by shaders
-        TransitionImageLayout(m_sampleParams.FrameRes.GraphicsCommandBuffers[0],
-                        m_texture.TextureImage.Handle, VK_IMAGE_ASPECT_COLOR_BIT, 
-                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                        VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
-                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
-
-        // Save the last image layout
+        // Sub-allocate local device memory that is large enough to hold the texture image, 
+        // and bind it to the image object.
+        m_memAllocator.AllocateImageMemory(m_texture.TextureImage.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_texture.TextureImage.Allocation);
+
+        // Copy the texture data to the first level of the image in local device memory through the staging ring buffer,
+        // which also transitions its layout to provide optimal performance for reading by shaders, or for reading it
+        // while generating the other levels (as a blit source, or as a storage image in the general layout).
+        VkImageLayout uploadLayout = (m_mipmapMode == MIPMAPS_BLIT) ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL :
+                                     (m_mipmapMode == MIPMAPS_COMPUTE) ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        if (fromFile)
+        {
+            // Upload the levels of the file as they are stored (blocks of texels, for a compressed format)
+            for (uint32_t level = 0; level < textureFile.GetLevelCount(); level++)
+            {
+                const VKTextureLoader::Level& levelData = textureFile.GetLevel(level);
+                m_stagingRing.UploadCompressedImage(m_texture.TextureImage.Handle, levelData.Width, levelData.Height,
+                                                    textureFile.GetBlockWidth(), textureFile.GetBlockHeight(), textureFile.GetBlockSize(),
+                                                    levelData.Data.data(), uploadLayout, level);
+            }
+        }
+        else
+        {
+            std::vector<uint8_t> texData = GenerateTextureData();
+            m_stagingRing.UploadImage(m_texture.TextureImage.Handle, 
+                                      m_texture.TextureWidth, m_texture.TextureHeight, m_texture.TextureTexelSize, 
+                                      texData.data(), uploadLayout);
+        }
+
+        // Save the last image layout (all the levels are left in this layout once generated, see GenerateMipmaps)
         m_texture.TextureImage.Descriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
         //
         // Create a sampler and a view
         //
 
+        // Trilinear filtering: bilinear filtering of the two mip levels closest to the size of the pixel footprint 
+        // in the texture, blended together. A minified texture is then read from a level with about one texel per 
+        // pixel, rather than skipping most of the texels of the first level, which aliases and thrashes the texture cache.
+        // Anisotropic filtering (if supported) takes several samples along the longest axis of the footprint, 
+        // which keeps the texture sharp when seen at grazing angles.
         VkSamplerCreateInfo samplerInfo = {};
         samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-        samplerInfo.magFilter = VK_FILTER_NEAREST;
-        samplerInfo.minFilter = VK_FILTER_NEAREST;
-        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
-        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
-        samplerInfo.anisotropyEnable = VK_FALSE;
+        samplerInfo.magFilter = VK_FILTER_LINEAR;
+        samplerInfo.minFilter = VK_FILTER_LINEAR;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;    // The texture can be repeated over the triangle (--tiling N)
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = static_cast<float>(m_texture.MipLevels);
+        samplerInfo.anisotropyEnable = m_vulkanParams.EnabledFeatures.samplerAnisotropy;
+        samplerInfo.maxAnisotropy = std::min(static_cast<float>(m_anisotropy), m_deviceProperties.limits.maxSamplerAnisotropy);
         samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
 
         VkImageViewCreateInfo viewInfo = {};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
         viewInfo.image = m_texture.TextureImage.Handle;
         viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = tex_format;
+        viewInfo.format = m_texture.Format;
         viewInfo.components =
             {
                 VK_COMPONENT_SWIZZLE_IDENTITY,  // R
@@ -485,7 +584,7 @@ void VKHelloTextures::CreateTexture()
                 VK_COMPONENT_SWIZZLE_IDENTITY,  // B
                 VK_COMPONENT_SWIZZLE_IDENTITY,  // A
             };
-        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}; // The texture stores colors and includes one mipmap level (index 0) and one array layer (index 0)
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_texture.MipLevels, 0, 1}; // The texture stores colors and includes all its mip levels and one array layer (index 0)
 
         // Create a sampler
         VK_CHECK_RESULT(vkCreateSampler(m_vulkanParams.Device, &samplerInfo, NULL, &m_texture.TextureImage.Descriptor.sampler));
@@ -494,12 +593,327 @@ void VKHelloTextures::CreateTexture()
         VK_CHECK_RESULT(vkCreateImageView(m_vulkanParams.Device, &viewInfo, NULL, &m_texture.TextureImage.Descriptor.imageView));
     }
     else {
-        /* Can't support VK_FORMAT_R8G8B8A8_UNORM !? */
+        /* Can't support VK_FORMAT_R8G8B8A8_UNORM !? (the format of a file is checked when it's loaded) */
         assert(!"No support for R8G8B8A8_UNORM as texture image format");
     }
 
-    // Flush the command buffer
-    FlushInitCommandBuffer(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.Handle, m_sampleParams.FrameRes.GraphicsCommandBuffers[0], m_sampleParams.FrameRes.Fences[0]);
+    // Submit the upload. There's no need to wait for it to complete, as the copies are executed before (and made
+    // visible to) any command buffer submitted to the graphics queue later on, including the one generating the mip levels.
+    // If mipmaps are generated, wait for it anyway so that the time measured by GenerateMipmaps only includes the generation.
+    if (m_mipmapMode == MIPMAPS_NONE)
+        m_stagingRing.Submit();
+    else
+        m_stagingRing.Flush();
+
+    GenerateMipmaps();
+
+    printf("Texture: %ux%u, %u mip level(s) (%s), %s\n", m_texture.TextureWidth, m_texture.TextureHeight, m_texture.MipLevels,
+           (fromFile && m_texture.MipLevels > 1) ? "file" : (m_mipmapMode == MIPMAPS_BLIT) ? "blit" : (m_mipmapMode == MIPMAPS_COMPUTE) ? "compute" : "none",
+           m_vulkanParams.EnabledFeatures.samplerAnisotropy ? "anisotropic filtering" : "trilinear filtering");
+
+    // Memory taken by the texture, compared to a non-compressed texture
+    if (fromFile)
+        printf("Texture file: %s, %s, %.2f MB (%.2f MB as R8G8B8A8)\n", m_textureFile.c_str(), textureFile.GetFormatName(), 
+               textureFile.GetSize() / (1024.0 * 1024.0), textureFile.GetUncompressedSize() / (1024.0 * 1024.0));
+}
+
+void VKHelloTextures::GenerateMipmaps()
+{
+    if (m_mipmapMode == MIPMAPS_NONE)
+        return;
+
+    // Record the generation of the mip levels in a command buffer executed once by the graphics queue
+    VkCommandBufferAllocateInfo commandBufferInfo = {};
+    commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferInfo.commandPool = m_sampleParams.CommandPool;
+    commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferInfo, &commandBuffer));
+
+    VkCommandBufferBeginInfo cmdBufInfo = {};
+    cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &cmdBufInfo));
+
+    if (m_mipmapMode == MIPMAPS_BLIT)
+        RecordMipmapBlits(commandBuffer);
+    else
+        RecordMipmapDownsampler(commandBuffer);
+
+    VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+
+    // Submit and wait for the generation (from submission to completion, so this includes the submission overhead)
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
+    VK_CHECK_RESULT(vkQueueWaitIdle(m_vulkanParams.GraphicsQueue.Handle));
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    printf("Mip levels generated with %s in %.3f ms\n", (m_mipmapMode == MIPMAPS_BLIT) ? "blits" : "the compute downsampler", elapsed.count());
+
+    vkFreeCommandBuffers(m_vulkanParams.Device, m_sampleParams.CommandPool, 1, &commandBuffer);
+
+    // The objects used by the compute downsampler are no longer needed
+    if (m_mipmapMode == MIPMAPS_COMPUTE)
+        DestroyDownsampler();
+}
+
+void VKHelloTextures::RecordMipmapBlits(VkCommandBuffer commandBuffer)
+{
+    // Each level is generated from the previous one by a blit with a linear filter, which averages 2x2 texels
+    // for power-of-two sizes. Every blit must wait for the previous one, so the GPU executes a chain of small,
+    // serialized copies, the last ones using a tiny fraction of the GPU.
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = m_texture.TextureImage.Handle;
+
+    // The first level was left in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL by the upload.
+    // Transition the other ones to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL (discarding their content).
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 1, m_texture.MipLevels - 1, 0, 1};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    for (uint32_t level = 1; level < m_texture.MipLevels; level++)
+    {
+        VkImageBlit blit = {};
+        blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+        blit.srcOffsets[1] = { static_cast<int32_t>(std::max(m_texture.TextureWidth >> (level - 1), 1u)), 
+                               static_cast<int32_t>(std::max(m_texture.TextureHeight >> (level - 1), 1u)), 1 };
+        blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        blit.dstOffsets[1] = { static_cast<int32_t>(std::max(m_texture.TextureWidth >> level, 1u)), 
+                               static_cast<int32_t>(std::max(m_texture.TextureHeight >> level, 1u)), 1 };
+
+        vkCmdBlitImage(commandBuffer, 
+                       m_texture.TextureImage.Handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 
+                       m_texture.TextureImage.Handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
+                       1, &blit, VK_FILTER_LINEAR);
+
+        // The level just written is the source of the next blit
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    // Transition all the levels to a layout optimal for sampling in the fragment shader
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_texture.MipLevels, 0, 1};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void VKHelloTextures::RecordMipmapDownsampler(VkCommandBuffer commandBuffer)
+{
+    //
+    // Create the objects used by the downsampler (see downsample.comp): a descriptor set with a storage view 
+    // of each level of the texture and a counter buffer, and a compute pipeline.
+    //
+
+    VkDescriptorSetLayoutBinding layoutBinding[3] = {};
+
+    // Binding 0: First level (read)
+    layoutBinding[0].binding = 0;
+    layoutBinding[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    layoutBinding[0].descriptorCount = 1;
+    layoutBinding[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // Binding 1: Other levels (written)
+    layoutBinding[1].binding = 1;
+    layoutBinding[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    layoutBinding[1].descriptorCount = DOWNSAMPLER_MAX_LEVELS;
+    layoutBinding[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    // Binding 2: Counter of the workgroups done
+    layoutBinding[2].binding = 2;
+    layoutBinding[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBinding[2].descriptorCount = 1;
+    layoutBinding[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
+    descriptorLayout.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorLayout.bindingCount = 3;
+    descriptorLayout.pBindings = layoutBinding;
+    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_downsampler.DescriptorSetLayout));
+
+    // The size of the texture, its number of levels and the number of workgroups are passed through push constants
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = 3 * sizeof(uint32_t);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &m_downsampler.DescriptorSetLayout;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK_RESULT(vkCreatePipelineLayout(m_vulkanParams.Device, &pipelineLayoutCreateInfo, nullptr, &m_downsampler.PipelineLayout));
+
+    VkPipelineShaderStageCreateInfo shaderStage = {};
+    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStage.module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/downsample.comp.spv");
+    shaderStage.pName = "main";
+    assert(shaderStage.module != VK_NULL_HANDLE);
+
+    VkComputePipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.layout = m_downsampler.PipelineLayout;
+    pipelineCreateInfo.stage = shaderStage;
+
+    // The pipeline is used only once, at startup (and the pipeline cache is not created yet)
+    VK_CHECK_RESULT(vkCreateComputePipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_downsampler.Pipeline));
+    vkDestroyShaderModule(m_vulkanParams.Device, shaderStage.module, nullptr);
+
+    // A view of each level of the texture
+    m_downsampler.LevelViews.resize(m_texture.MipLevels);
+    for (uint32_t level = 0; level < m_texture.MipLevels; level++)
+    {
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = m_texture.TextureImage.Handle;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+        viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1};
+        VK_CHECK_RESULT(vkCreateImageView(m_vulkanParams.Device, &viewInfo, nullptr, &m_downsampler.LevelViews[level]));
+    }
+
+    // Counter buffer in local device memory (cleared below)
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(uint32_t);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_downsampler.CounterBuffer));
+
+    m_memAllocator.AllocateBufferMemory(m_downsampler.CounterBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_downsampler.CounterMemory);
+
+    // Descriptor pool and set
+    VkDescriptorPoolSize typeCounts[2];
+    typeCounts[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    typeCounts[0].descriptorCount = 1 + DOWNSAMPLER_MAX_LEVELS;
+    typeCounts[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    typeCounts[1].descriptorCount = 1;
+
+    VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
+    descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolInfo.poolSizeCount = 2;
+    descriptorPoolInfo.pPoolSizes = typeCounts;
+    descriptorPoolInfo.maxSets = 1;
+    VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_downsampler.DescriptorPool));
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_downsampler.DescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &m_downsampler.DescriptorSetLayout;
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, &m_downsampler.DescriptorSet));
+
+    // All the elements of the array of levels must be valid descriptors, as the shader statically accesses them:
+    // the ones past the last level of the texture reference the last level (they are never written).
+    VkDescriptorImageInfo levelInfos[1 + DOWNSAMPLER_MAX_LEVELS] = {};
+    for (uint32_t i = 0; i <= DOWNSAMPLER_MAX_LEVELS; i++)
+    {
+        levelInfos[i].imageView = m_downsampler.LevelViews[std::min(i, m_texture.MipLevels - 1)];
+        levelInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    }
+
+    VkDescriptorBufferInfo counterInfo = { m_downsampler.CounterBuffer, 0, VK_WHOLE_SIZE };
+
+    VkWriteDescriptorSet writeDescriptorSet[3] = {};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        writeDescriptorSet[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet[i].dstSet = m_downsampler.DescriptorSet;
+        writeDescriptorSet[i].dstBinding = i;
+        writeDescriptorSet[i].descriptorType = layoutBinding[i].descriptorType;
+        writeDescriptorSet[i].descriptorCount = layoutBinding[i].descriptorCount;
+    }
+    writeDescriptorSet[0].pImageInfo = &levelInfos[0];
+    writeDescriptorSet[1].pImageInfo = &levelInfos[1];
+    writeDescriptorSet[2].pBufferInfo = &counterInfo;
+    vkUpdateDescriptorSets(m_vulkanParams.Device, 3, writeDescriptorSet, 0, nullptr);
+
+    //
+    // Record the generation
+    //
+
+    // Clear the counter, and transition the levels to be written to VK_IMAGE_LAYOUT_GENERAL 
+    // (the first one was left in this layout by the upload).
+    vkCmdFillBuffer(commandBuffer, m_downsampler.CounterBuffer, 0, VK_WHOLE_SIZE, 0);
+
+    VkBufferMemoryBarrier bufferBarrier = {};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = m_downsampler.CounterBuffer;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+
+    VkImageMemoryBarrier imageBarrier = {};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = 0;
+    imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = m_texture.TextureImage.Handle;
+    imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 1, m_texture.MipLevels - 1, 0, 1};
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                         0, 0, nullptr, 1, &bufferBarrier, 1, &imageBarrier);
+
+    // A workgroup for each 64x64 tile of the first level
+    const uint32_t tileCount = (m_texture.TextureWidth + DOWNSAMPLER_TILE_SIZE - 1) / DOWNSAMPLER_TILE_SIZE;
+    const uint32_t pushConstants[3] = { m_texture.TextureWidth, m_texture.MipLevels, tileCount * tileCount };
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_downsampler.Pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_downsampler.PipelineLayout, 0, 1, &m_downsampler.DescriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_downsampler.PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), pushConstants);
+    vkCmdDispatch(commandBuffer, tileCount, tileCount, 1);
+
+    // Transition all the levels to a layout optimal for sampling in the fragment shader
+    imageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_texture.MipLevels, 0, 1};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+                         0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+}
+
+void VKHelloTextures::DestroyDownsampler()
+{
+    for (VkImageView view : m_downsampler.LevelViews)
+        vkDestroyImageView(m_vulkanParams.Device, view, nullptr);
+    m_downsampler.LevelViews.clear();
+
+    vkDestroyBuffer(m_vulkanParams.Device, m_downsampler.CounterBuffer, nullptr);
+    m_memAllocator.Free(m_downsampler.CounterMemory);
+    vkDestroyDescriptorPool(m_vulkanParams.Device, m_downsampler.DescriptorPool, nullptr);    // Also frees the descriptor set
+    vkDestroyPipeline(m_vulkanParams.Device, m_downsampler.Pipeline, nullptr);
+    vkDestroyPipelineLayout(m_vulkanParams.Device, m_downsampler.PipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_downsampler.DescriptorSetLayout, nullptr);
 }
 
 void VKHelloTextures::UpdateHostVisibleBufferData()
@@ -538,9 +952,9 @@ void VKHelloTextures::CreateDescriptorPool()
     // This sample uses two descriptor types (uniform buffer and combined image sampler)
     VkDescriptorPoolSize typeCounts[2];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);;
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);;
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
@@ -550,7 +964,7 @@ void VKHelloTextures::CreateDescriptorPool()
     descriptorPoolInfo.poolSizeCount = 2;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -587,17 +1001,17 @@ void VKHelloTextures::CreateDescriptorSetLayout()
 
 void VKHelloTextures::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -606,13 +1020,13 @@ void VKHelloTextures::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[2] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -620,7 +1034,7 @@ void VKHelloTextures::AllocateDescriptorSets()
 
         // Write the descriptor of the combined image sampler.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         writeDescriptorSet[1].pImageInfo = &m_texture.TextureImage.Descriptor;
@@ -825,7 +1239,7 @@ void VKHelloTextures::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline using the specified states
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipeline));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineTextured]));
     
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -858,11 +1272,11 @@ void VKHelloTextures::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -870,7 +1284,7 @@ void VKHelloTextures::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = (float)0.0f;
     viewport.maxDepth = (float)1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -878,35 +1292,35 @@ void VKHelloTextures::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
 
     // Bind descriptor sets
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                             VK_PIPELINE_BIND_POINT_GRAPHICS, 
                             m_sampleParams.PipelineLayout, 
                             0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
                             0, nullptr);
 
     // Bind the graphics pipeline.
     // The pipeline object contains all states of the graphics pipeline, 
     // binding it will set all the states specified at pipeline creation time
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                       VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                      m_sampleParams.GraphicsPipeline);
+                      m_sampleParams.Pipelines[m_pipelineTextured]);
     
     // Bind triangle vertex buffer (contains positions and texture coordinates)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertices.buffer, offsets);
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_vertices.buffer, offsets);
     
-    // Draw triangle
-    vkCmdDraw(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 3, 1, 0, 0);
+    // Draw triangle (several times in the same place with --overdraw N, to make the frame bound by texture sampling)
+    vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 3, m_overdraw, 0, 0);
     
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
     
-     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKHelloTextures::SubmitCommandBuffer()
@@ -919,13 +1333,13 @@ void VKHelloTextures::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKHelloTextures::PresentImage(uint32_t currentImageIndex)
@@ -940,13 +1354,13 @@ void VKHelloTextures::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
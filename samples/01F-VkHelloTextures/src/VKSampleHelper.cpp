@@ -1,244 +0,0 @@
-#include "stdafx.h"
-#include "VKSampleHelper.hpp"
-#include <fstream>
-
-void GetDeviceQueue(const VkDevice& device, unsigned int graphicsQueueFamilyIndex, VkQueue& graphicsQueue)
-{
-    vkGetDeviceQueue(device, graphicsQueueFamilyIndex, 0, &graphicsQueue);
-}
-
-bool CheckPhysicalDeviceProperties(
-    const VkPhysicalDevice& physicalDevice, 
-    VulkanCommonParameters& vulkan_param)
-{
-    // Get list of supported device extensions
-    uint32_t extCount = 0;
-    std::vector<std::string> extensionNames;
-    vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, nullptr);
-    if (extCount > 0)
-    {
-        std::vector<VkExtensionProperties> extensions(extCount);
-        if (vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extCount, &extensions.front()) == VK_SUCCESS)
-        {
-            for (const VkExtensionProperties& ext : extensions)
-            {
-                extensionNames.push_back(ext.extensionName);
-            }
-        }
-    }
-
-    std::vector<const char*> deviceExtensions = {
-      VK_KHR_SWAPCHAIN_EXTENSION_NAME
-    };
-
-    // Check that the device extensions we want to enable are supported
-    if (deviceExtensions.size() > 0)
-    {
-        for (const char* deviceExt : deviceExtensions)
-        {
-            // Output message if requested extension is not available
-            if (std::find(extensionNames.begin(), extensionNames.end(), deviceExt) == extensionNames.end())
-            {
-                printf("Device extension not present!\n");
-                assert(0);
-            }
-        }
-    }
-
-    // Get device queue family properties
-    unsigned int queueFamilyCount = 0;
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
-    if (queueFamilyCount == 0)
-    {
-        printf("Physical device doesn't have any queue families!\n");
-        assert(0);
-    }
-
-    std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
-    std::vector<VkBool32> queuePresentSupport(queueFamilyCount);
-
-    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilyProperties.data());
-
-    // for each queue family...
-    for (uint32_t i = 0; i < queueFamilyCount; ++i) {
-
-        // Query if presentation is supported on a specific surface
-        vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, vulkan_param.PresentationSurface, &queuePresentSupport[i]);
-
-        if ((queueFamilyProperties[i].queueCount > 0) && (queueFamilyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT))
-        {
-            // If the queue family supports both graphics operations and presentation on our surface - prefer it
-            if (queuePresentSupport[i])
-            {
-                vulkan_param.GraphicsQueue.FamilyIndex = i;
-                return true;
-            }
-        }
-    }
-
-    return false;
-}
-
-// This function is used to request a device memory type that supports all the property 
-// flags we request (e.g. device local, host visible).
-// Upon success it will return the index of the memory type that fits our requested memory properties.
-// This is necessary as implementations can offer an arbitrary number of memory types with different
-// memory properties.
-uint32_t GetMemoryTypeIndex(uint32_t typeBits, VkMemoryPropertyFlags properties, VkPhysicalDeviceMemoryProperties deviceMemoryProperties)
-{
-    // Iterate over all memory types available for the device used in this sample
-    for (uint32_t i = 0; i < deviceMemoryProperties.memoryTypeCount; i++)
-    {
-        if ((typeBits & 1) == 1)
-        {
-            if ((deviceMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
-            {
-                return i;
-            }
-        }
-        typeBits >>= 1;
-    }
-    
-    printf("Could not find a suitable memory type!\n");
-    assert(0);
-    return 0;
-}
-
-VkShaderModule LoadSPIRVShaderModule(VkDevice device, std::string filename)
-{
-    size_t shaderSize;
-    char* shaderCode = NULL;
-    
-    std::ifstream is(filename, std::ios::binary | std::ios::in | std::ios::ate);
-
-    if (is.is_open())
-    {
-        shaderSize = is.tellg();
-        is.seekg(0, std::ios::beg);
-        // Copy file contents into a buffer
-        shaderCode = new char[shaderSize];
-        is.read(shaderCode, shaderSize);
-        is.close();
-        assert(shaderSize > 0);
-    }
-
-    if (shaderCode)
-    {
-        // Create a new shader module that will be used for pipeline creation
-        VkShaderModuleCreateInfo moduleCreateInfo{};
-        moduleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        moduleCreateInfo.codeSize = shaderSize;
-        moduleCreateInfo.pCode = (uint32_t*)shaderCode;
-
-        VkShaderModule shaderModule;
-        VK_CHECK_RESULT(vkCreateShaderModule(device, &moduleCreateInfo, NULL, &shaderModule));
-
-        delete[] shaderCode;
-
-        return shaderModule;
-    }
-    else
-    {
-        printf("Error: Could not open shader file %s\n", filename.c_str());
-        return VK_NULL_HANDLE;
-    }
-}
-
-void TransitionImageLayout(VkCommandBuffer cmd, 
-                            VkImage image, VkImageAspectFlags aspectMask, 
-                            VkImageLayout oldImageLayout, VkImageLayout newImageLayout, 
-                            VkAccessFlagBits srcAccessMask, VkPipelineStageFlags srcStages, 
-                            VkPipelineStageFlags dstStages)
-{
-    VkImageMemoryBarrier imageMemoryBarrier = {};
-     imageMemoryBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-     imageMemoryBarrier.srcAccessMask = srcAccessMask;
-     imageMemoryBarrier.dstAccessMask = 0;
-     imageMemoryBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-     imageMemoryBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-     imageMemoryBarrier.oldLayout = oldImageLayout;
-     imageMemoryBarrier.newLayout = newImageLayout;
-     imageMemoryBarrier.image = image;
-     imageMemoryBarrier.subresourceRange = {aspectMask, 0, 1, 0, 1};
-
-    switch (newImageLayout) {
-    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-        break;
-
-    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
-        imageMemoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-        break;
-
-    default:
-        imageMemoryBarrier.dstAccessMask = 0;
-        break;
-    }
-
-    vkCmdPipelineBarrier(cmd, srcStages, dstStages, 0, 0, NULL, 0, NULL, 1, &imageMemoryBarrier);
-}
-
-void FlushInitCommandBuffer(VkDevice device, VkQueue queue, VkCommandBuffer cmd, VkFence fence)
-{
-    VK_CHECK_RESULT(vkEndCommandBuffer(cmd));
-    VK_CHECK_RESULT(vkResetFences(device, 1, &fence));
-
-    VkSubmitInfo submitInfo = {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pCommandBuffers = &cmd;
-    submitInfo.commandBufferCount = 1;
-
-    VK_CHECK_RESULT(vkQueueSubmit(queue, 1, &submitInfo, fence));
-
-    VK_CHECK_RESULT(vkWaitForFences(device, 1, &fence, VK_TRUE, UINT64_MAX));
-}
-
-std::string errorString(VkResult errorCode)
-{
-    switch (errorCode)
-    {
-#define STR(r) case VK_ ##r: return #r
-        STR(NOT_READY);
-        STR(TIMEOUT);
-        STR(EVENT_SET);
-        STR(EVENT_RESET);
-        STR(INCOMPLETE);
-        STR(ERROR_OUT_OF_HOST_MEMORY);
-        STR(ERROR_OUT_OF_DEVICE_MEMORY);
-        STR(ERROR_INITIALIZATION_FAILED);
-        STR(ERROR_DEVICE_LOST);
-        STR(ERROR_MEMORY_MAP_FAILED);
-        STR(ERROR_LAYER_NOT_PRESENT);
-        STR(ERROR_EXTENSION_NOT_PRESENT);
-        STR(ERROR_FEATURE_NOT_PRESENT);
-        STR(ERROR_INCOMPATIBLE_DRIVER);
-        STR(ERROR_TOO_MANY_OBJECTS);
-        STR(ERROR_FORMAT_NOT_SUPPORTED);
-        STR(ERROR_SURFACE_LOST_KHR);
-        STR(ERROR_NATIVE_WINDOW_IN_USE_KHR);
-        STR(SUBOPTIMAL_KHR);
-        STR(ERROR_OUT_OF_DATE_KHR);
-        STR(ERROR_INCOMPATIBLE_DISPLAY_KHR);
-        STR(ERROR_VALIDATION_FAILED_EXT);
-        STR(ERROR_INVALID_SHADER_NV);
-#undef STR
-    default:
-        return "UNKNOWN_ERROR";
-    }
-}
\ No newline at end of file
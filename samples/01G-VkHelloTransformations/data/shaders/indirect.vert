@@ -0,0 +1,25 @@
+#version 450
+
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec4 inColor;
+
+layout(std140, set = 0, binding = 0) uniform buf {
+    mat4 View;
+    mat4 Projection;
+} uBuf;
+
+// World matrices of the objects, computed by the culling shader.
+// The draw command of each object sets firstInstance to the index of the object, so gl_InstanceIndex selects its world matrix.
+layout(std430, set = 0, binding = 1) readonly buffer bufInstances {
+    mat4 World[ ];
+} instances;
+
+layout (location = 0) out vec4 outColor;
+
+void main() 
+{
+    outColor = inColor;                                                      // Pass color to the next stage
+    vec4 worldPos = instances.World[gl_InstanceIndex] * vec4(inPos, 1.0);    // Local to World
+    vec4 viewPos = uBuf.View * worldPos;                                     // World to View
+    gl_Position = uBuf.Projection * viewPos;                                 // View to Clip
+}
@@ -0,0 +1,22 @@
+#version 450
+
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec4 inColor;
+
+// World matrix of the instance, read from the per-instance vertex buffer (locations 2 to 5, one for each column)
+layout (location = 2) in mat4 inWorld;
+
+layout(std140, set = 0, binding = 0) uniform buf {
+    mat4 View;
+    mat4 Projection;
+} uBuf;
+
+layout (location = 0) out vec4 outColor;
+
+void main() 
+{
+    outColor = inColor;                                  // Pass color to the next stage
+    vec4 worldPos = inWorld * vec4(inPos, 1.0);          // Local to World
+    vec4 viewPos = uBuf.View * worldPos;                 // World to View
+    gl_Position = uBuf.Projection * viewPos;             // View to Clip
+}
@@ -6,6 +6,12 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "glm/glm.hpp"
 
+// Number of objects drawn in GPU-driven mode if not specified on the command line (--objects N)
+#define GPU_DRIVEN_DEFAULT_OBJECT_COUNT 100000
+
+// Number of invocations in a workgroup of the culling shader
+#define CULLING_WORKGROUP_SIZE 64
+
 class VKHelloTransformations : public VKSample
 {
 public:
@@ -19,6 +25,9 @@ public:
 
     virtual void OnResize();
 
+    virtual void EnableDeviceExtensions(std::vector<const char*>& deviceExtensions);
+    virtual void EnableFeatures(VkPhysicalDeviceFeatures& features);
+
 private:
     
     void InitVulkan();
@@ -29,17 +38,25 @@ private:
     void PresentImage(uint32_t currentImageIndex);
     
     void CreateVertexBuffer();              // Create a vertex buffer
+    void CreateObjects();                   // Place the objects in the scene
+    void CreateStorageBuffers();            // Create the buffers read and written by the culling shader (GPU-driven mode)
     void CreateHostVisibleBuffers();        // Create a buffer in host-visible memory
     void CreateHostVisibleDynamicBuffers(); // Create a dynamic buffer
+    void CreatePerInstanceBuffers();        // Create the per-instance vertex buffers (instanced mode)
     void CreateDescriptorPool();            // Create a descriptor pool
     void CreateDescriptorSetLayout();       // Create a descriptor set layout
     void AllocateDescriptorSets();          // Allocate a descriptor set
     void CreatePipelineLayout();            // Create a pipeline layout
     void CreatePipelineObjects();           // Create a pipeline object
+    void CreateCullingPipeline();           // Create the compute pipeline culling the objects (GPU-driven mode)
+
+    // Record the culling of the objects, which writes the indirect draw commands of the visible ones (GPU-driven mode)
+    void RecordCulling(VkCommandBuffer commandBuffer);
 
     // Update buffer data
     void UpdateHostVisibleBufferData();
     void UpdateHostVisibleDynamicBufferData();
+    void UpdatePerInstanceBufferData();
 
     // For simplicity we use the same uniform block layout as in the vertex shader:
     //
@@ -75,17 +92,77 @@ private:
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffer;
 
-    // In this sample we have two draw calls for each frame.
-    const unsigned int m_numDrawCalls = 2;
+    // Per-object data, stored in a storage buffer read by the culling shader (GPU-driven mode).
+    // Same layout as the ObjectData structure in cull.comp (std430).
+    struct ObjectData {
+        glm::mat4 world;          // Placement of the object, before the rotation around the z-axis
+        glm::vec4 boundingSphere; // Center (xyz) and radius (w) of the bounding sphere, in local space
+        glm::vec4 rotation;       // x: rotation around the z-axis, as a multiple of m_curRotationAngleRad
+    };
+
+    // Push constants used in the culling shader:
+    //
+    // layout(push_constant) uniform pushConsts {
+    //     vec4 frustumPlanes[6];
+    //     float rotationAngle;
+    // } params;
+    struct {
+        glm::vec4 frustumPlanes[6];   // Left, right, bottom, top, near and far planes, in world space
+        float rotationAngle;
+    } m_cullingPushConstants;
+
+    // Specialization constants used in the culling shader:
+    //
+    // layout (local_size_x_id = 0) in;
+    // layout (constant_id = 1) const uint OBJECT_COUNT = 2;
+    // layout (constant_id = 2) const uint INDEX_COUNT = 36;
+    // layout (constant_id = 3) const bool COMPACT_DRAWS = false;
+    struct CullingSpecConsts {
+        uint32_t workGroupSize;
+        uint32_t objectCount;
+        uint32_t indexCount;
+        VkBool32 compactDraws;
+    } m_cullingSpecConstants;
+
+    // Instanced mode (--instanced).
+    // The world matrices of the objects are tightly packed in a per-instance vertex buffer (64 bytes per object, 
+    // rather than a slot of the dynamic uniform buffer aligned to minUniformBufferOffsetAlignment), and all the
+    // objects are drawn by a single instanced draw call:
+    //
+    // layout (location = 2) in mat4 inWorld;
+    //
+    bool m_instanced;
+    std::vector<BufferParameters> m_perInstanceBuffers;   // One for each frame in flight
+
+    // Objects in the scene. The first two are the cubes of the original sample, the others are scattered around them.
+    std::vector<ObjectData> m_objects;
+
+    // GPU-driven mode (--gpu-driven).
+    // A compute shader culls the objects against the view frustum, computes the world matrices of the visible ones
+    // and writes their draw commands to an indirect buffer, consumed by a single vkCmdDrawIndexedIndirect(Count).
+    bool m_gpuDriven;
+    bool m_drawIndirectCount;                          // VK_KHR_draw_indirect_count is supported and enabled
+    BufferParameters m_objectBuffer;                   // Per-object data (device-local, never updated)
+    std::vector<BufferParameters> m_instanceBuffers;   // World matrices of the objects (one buffer for each frame in flight)
+    std::vector<BufferParameters> m_drawBuffers;       // Indirect draw commands (one buffer for each frame in flight)
+    std::vector<BufferParameters> m_drawCountBuffers;  // Number of indirect draw commands (one buffer for each frame in flight)
+    VkPipeline m_cullingPipeline;
+    uint32_t m_dispatchGroupCount[2];                  // Number of workgroups dispatched in X and Y to cull all the objects
+    PFN_vkCmdDrawIndexedIndirectCountKHR vkCmdDrawIndexedIndirectCountKHR;
 
     // Sample members
     float m_curRotationAngleRad;
     size_t m_dynamicUBOAlignment;
+    uint32_t m_objectCount;            // Number of objects (and of draw calls) in the scene (set at launch with --objects N)
+
+    // Handles of the named pipeline and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineVertexColor;
+    TableHandle m_descSetGraphics;
 };
\ No newline at end of file
@@ -7,19 +7,27 @@ else
     VULKAN_INCLUDE=../../external/include/vulkan/
 fi
 
-includes="-Iinc -I../../external/include/ -I$VULKAN_INCLUDE"
+includes="-Iinc -I../../framework/inc -I../../external/include/ -I$VULKAN_INCLUDE"
 
 defines="-DDEBUG -DVK_USE_PLATFORM_XLIB_KHR"
 
-links="-lX11 -lvulkan"
+links="-L../../framework/lib -lvkframework -lX11 -lvulkan -lpthread"
 
 echo Compiling shader...
 
 /../../bin/glslangValidator -V -g ./data/shaders/main.vert -o ./data/shaders/main.vert.spv
 /../../bin/glslangValidator -V -g ./data/shaders/main.frag -o ./data/shaders/main.frag.spv
+/../../bin/glslangValidator -V -g ./data/shaders/indirect.vert -o ./data/shaders/indirect.vert.spv
+/../../bin/glslangValidator -V -g ./data/shaders/instanced.vert -o ./data/shaders/instanced.vert.spv
+/../../bin/glslangValidator -V -g ./data/shaders/cull.comp -o ./data/shaders/cull.comp.spv
+
+if [ "$SKIP_FRAMEWORK" != "1" ]; then
+    (cd ../../framework && bash scripts/build.sh) || exit 1
+fi
 
 echo Building project...
 
-g++ -g src/*.cpp -o 01G-VkHelloTransformations.out $includes $defines $links
+source ../../scripts/compile.sh
 
-rm -f *.o
\ No newline at end of file
+compile_sources obj "$includes $defines" src/*.cpp || exit 1
+link_executable 01G-VkHelloTransformations.out ../../framework/lib/libvkframework.a "$links" $OBJECTS || exit 1
\ No newline at end of file
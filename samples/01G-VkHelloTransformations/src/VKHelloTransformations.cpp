@@ -1,16 +1,29 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloTransformations.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
+#include "VKStagingRing.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/ext/scalar_constants.hpp"
 
+#include <random>
+
 VKHelloTransformations::VKHelloTransformations(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
+m_instanced(false),
+m_gpuDriven(false),
+m_drawIndirectCount(false),
+m_cullingPipeline(VK_NULL_HANDLE),
+vkCmdDrawIndexedIndirectCountKHR(nullptr),
 m_curRotationAngleRad(0.0f),
-m_dynamicUBOAlignment(0)
+m_dynamicUBOAlignment(0),
+m_objectCount(0)
 {
+    // Register the named pipeline and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineVertexColor = m_sampleParams.Pipelines.Register("VertexColor");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
+
     // Initialize the pointer to the memory region that will store the array of world matrices.
     dynUBufVS.worldMatrix = nullptr;
 
@@ -32,6 +45,23 @@ VKHelloTransformations::~VKHelloTransformations()
 
 void VKHelloTransformations::OnInit()
 {
+    // --instanced draws all the objects with a single instanced draw call, reading their world matrices from a vertex buffer.
+    // --gpu-driven culls the objects and generates their draw commands on the GPU (it takes precedence over --instanced).
+    // The number of objects can be specified on the command line (--objects N).
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--objects") == 0 && i + 1 < args.size())
+            m_objectCount = std::max(1u, static_cast<uint32_t>(strtoul(args[i + 1], nullptr, 10)));
+        else if (strcmp(args[i], "--instanced") == 0)
+            m_instanced = true;
+        else if (strcmp(args[i], "--gpu-driven") == 0)
+            m_gpuDriven = true;
+    }
+
+    if (m_objectCount == 0)
+        m_objectCount = m_gpuDriven ? GPU_DRIVEN_DEFAULT_OBJECT_COUNT : 2;
+
     InitVulkan();
     SetupPipeline();
 
@@ -51,22 +81,89 @@ void VKHelloTransformations::InitVulkan()
     CreateFrameBuffers();
     AllocateCommandBuffers();
     CreateSynchronizationObjects();
+
+    // Get extension function adresses 
+    if (m_drawIndirectCount)
+        vkCmdDrawIndexedIndirectCountKHR = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(m_vulkanParams.Device, "vkCmdDrawIndexedIndirectCountKHR"));
 }
 
 void VKHelloTransformations::SetupPipeline()
 {
+    // --gpu-driven takes precedence over --instanced, unless the device doesn't support it (see EnableFeatures)
+    if (m_gpuDriven)
+        m_instanced = false;
+
     CreateVertexBuffer();
+    CreateObjects();
+    if (m_gpuDriven)
+        CreateStorageBuffers();
+    if (m_instanced)
+        CreatePerInstanceBuffers();
     CreateHostVisibleBuffers();
-    CreateHostVisibleDynamicBuffers();
+    if (!m_gpuDriven && !m_instanced)
+        CreateHostVisibleDynamicBuffers();
     CreateDescriptorPool();
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    if (m_gpuDriven)
+        CreateCullingPipeline();
+    ReportPipelineCreationTime();
+
+    printf("Drawing %u objects with %s\n", m_objectCount, 
+           m_instanced ? "a single instanced draw call" :
+           !m_gpuDriven ? "a draw call each (CPU-driven)" :
+           m_drawIndirectCount ? "GPU culling and vkCmdDrawIndexedIndirectCount" : "GPU culling and vkCmdDrawIndexedIndirect");
 
     m_initialized = true;
 }
 
+void VKHelloTransformations::EnableDeviceExtensions(std::vector<const char*>& deviceExtensions)
+{
+    if (!m_gpuDriven)
+        return;
+
+    // If VK_KHR_draw_indirect_count is supported, the culling shader packs the draw commands of the visible objects 
+    // and writes their number to a buffer, so that the GPU only executes those. Otherwise, each object has its own 
+    // draw command, with no instances to draw if the object is culled.
+    uint32_t extCount = 0;
+    vkEnumerateDeviceExtensionProperties(m_vulkanParams.PhysicalDevice, nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extCount);
+    vkEnumerateDeviceExtensionProperties(m_vulkanParams.PhysicalDevice, nullptr, &extCount, extensions.data());
+
+    for (const VkExtensionProperties& ext : extensions)
+    {
+        if (strcmp(ext.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0)
+        {
+            deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+            m_drawIndirectCount = true;
+            break;
+        }
+    }
+}
+
+void VKHelloTransformations::EnableFeatures(VkPhysicalDeviceFeatures& features)
+{
+    if (!m_gpuDriven)
+        return;
+
+    // All the objects are drawn by a single indirect draw (multiDrawIndirect), and each draw command passes the index 
+    // of its object to the vertex shader as the index of the first instance (drawIndirectFirstInstance).
+    if (m_deviceFeatures.multiDrawIndirect && m_deviceFeatures.drawIndirectFirstInstance)
+    {
+        features.multiDrawIndirect = VK_TRUE;
+        features.drawIndirectFirstInstance = VK_TRUE;
+    }
+    else
+    {
+        printf("Selected device does not support multi-draw indirect: falling back to a draw call per object\n");
+        m_gpuDriven = false;
+        m_drawIndirectCount = false;
+    }
+}
+
 // Update frame-based values.
 void VKHelloTransformations::OnUpdate()
 {
@@ -76,24 +173,35 @@ void VKHelloTransformations::OnUpdate()
     snprintf(m_lastFPS, (size_t)32, "%u fps", m_timer.GetFramesPerSecond());
     m_frameCounter++;
 
-    // Update dynamic buffer data (world matrices).
-    UpdateHostVisibleDynamicBufferData();
+    const float rotationSpeed = 0.8f;
+
+    // Update the rotation angle
+    m_curRotationAngleRad += rotationSpeed * m_timer.GetElapsedSeconds();
+    if (m_curRotationAngleRad >= glm::two_pi<float>())
+    {
+        m_curRotationAngleRad -= glm::two_pi<float>();
+    }
+
+    // Update dynamic buffer data (world matrices), or the per-instance vertex buffer in instanced mode.
+    // In GPU-driven mode the world matrices are computed by the culling shader.
+    if (m_instanced)
+        UpdatePerInstanceBufferData();
+    else if (!m_gpuDriven)
+        UpdateHostVisibleDynamicBufferData();
 }
 
 // Render the scene.
 void VKHelloTransformations::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -109,7 +217,7 @@ void VKHelloTransformations::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKHelloTransformations::OnDestroy()
@@ -119,25 +227,45 @@ void VKHelloTransformations::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffer.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffer.IBmemory);
 
     // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
-        // Destroy dynamic buffer object and deallocate backing memory
-        vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        if (m_gpuDriven)
+        {
+            // Destroy the buffers written by the culling shader and deallocate backing memory
+            vkDestroyBuffer(m_vulkanParams.Device, m_instanceBuffers[i].Handle, nullptr);
+            vkDestroyBuffer(m_vulkanParams.Device, m_drawBuffers[i].Handle, nullptr);
+            vkDestroyBuffer(m_vulkanParams.Device, m_drawCountBuffers[i].Handle, nullptr);
+            m_memAllocator.Free(m_instanceBuffers[i].Allocation);
+            m_memAllocator.Free(m_drawBuffers[i].Allocation);
+            m_memAllocator.Free(m_drawCountBuffers[i].Allocation);
+        }
+        else if (m_instanced)
+        {
+            // Destroy the per-instance vertex buffer and deallocate backing memory
+            vkDestroyBuffer(m_vulkanParams.Device, m_perInstanceBuffers[i].Handle, nullptr);
+            m_memAllocator.Free(m_perInstanceBuffers[i].Allocation);
+        }
+        else
+        {
+            // Destroy dynamic buffer object and deallocate backing memory
+            vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
+            m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
+        }
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -145,7 +273,14 @@ void VKHelloTransformations::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
+    }
+
+    // Destroy the buffer storing the per-object data and deallocate backing memory
+    if (m_gpuDriven)
+    {
+        vkDestroyBuffer(m_vulkanParams.Device, m_objectBuffer.Handle, nullptr);
+        m_memAllocator.Free(m_objectBuffer.Allocation);
     }
 
     // Destroy descriptor pool
@@ -156,7 +291,9 @@ void VKHelloTransformations::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.GraphicsPipeline, nullptr);
+    vkDestroyPipeline(m_vulkanParams.Device, m_sampleParams.Pipelines[m_pipelineVertexColor], nullptr);
+    if (m_cullingPipeline != VK_NULL_HANDLE)
+        vkDestroyPipeline(m_vulkanParams.Device, m_cullingPipeline, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -167,30 +304,45 @@ void VKHelloTransformations::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -199,8 +351,12 @@ void VKHelloTransformations::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -285,15 +441,6 @@ void VKHelloTransformations::CreateVertexBuffer()
     // This is not recommended as it can result in lower rendering performance.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -305,19 +452,10 @@ void VKHelloTransformations::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.VBmemory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, cubeVertices.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory);
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.VBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.VBmemory);
 
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, m_vertexindexBuffer.VBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.VBmemory.MappedMemory, cubeVertices.data(), vertexBufferSize);
 
     // Create the index buffer object
     VkBufferCreateInfo indexBufferInfo = {};
@@ -326,16 +464,135 @@ void VKHelloTransformations::CreateVertexBuffer()
     indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &indexBufferInfo, nullptr, &m_vertexindexBuffer.IBbuffer));
 
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.IBmemory));
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.IBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.IBmemory);
 
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, indexBuffer.data(), indexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory);
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.IBmemory.MappedMemory, indexBuffer.data(), indexBufferSize);
+}
+
+void VKHelloTransformations::CreateObjects()
+{
+    // In GPU-driven mode the draw commands of all the objects are executed by a single indirect draw, and the
+    // per-object data is read by the culling shader from a single storage buffer: both have a size limit.
+    if (m_gpuDriven)
+    {
+        uint32_t maxObjectCount = std::min(m_deviceProperties.limits.maxDrawIndirectCount, 
+                                           m_deviceProperties.limits.maxStorageBufferRange / static_cast<uint32_t>(sizeof(ObjectData)));
+        if (m_objectCount > maxObjectCount)
+        {
+            printf("Number of objects clamped to %u (device limits)\n", maxObjectCount);
+            m_objectCount = maxObjectCount;
+        }
+    }
+
+    m_objects.resize(m_objectCount);
+
+    // All the objects are cubes, whose bounding sphere is centered at the origin (in local space) and passes 
+    // through the eight vertices.
+    for (ObjectData& object : m_objects)
+        object.boundingSphere = glm::vec4(0.0f, 0.0f, 0.0f, sqrtf(3.0f));
 
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, m_vertexindexBuffer.IBmemory, 0));
+    // The cube at the center of the scene rotates around the z-axis
+    m_objects[0].world = glm::identity<glm::mat4>();
+    m_objects[0].rotation = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
+
+    // The second cube rotates around the first cube at double velocity and in reverse direction.
+    if (m_objectCount > 1)
+    {
+        glm::mat4 Tran = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, 5.0f, 0.0f));
+        glm::mat4 Scale = glm::scale(glm::mat4(1.0f), glm::vec3(0.2f, 0.2f, 0.2f)); // both glm::mat4(1.0f) and glm::identity<glm::mat4>() build a 4x4 identity matrix
+        m_objects[1].world = Tran * Scale;
+        m_objects[1].rotation = glm::vec4(-2.0f, 0.0f, 0.0f, 0.0f);
+
+        // Once rotated (see UpdateHostVisibleDynamicBufferData), equivalent to:
+        // glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), -2.0f * m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
+        // glm::mat4 TranRotZ = glm::translate(RotZ, glm::vec3(0.0f, 5.0f, 0.0f));
+        // glm::mat4 TranRotZScale = glm::scale(TranRotZ, glm::vec3(0.2f, 0.2f, 0.2f));
+    }
+
+    // Any other cube is scattered around the first two, many of them outside the view frustum.
+    // They rotate around the z-axis at an integer multiple of the rotation angle, so that their position doesn't 
+    // jump when the angle wraps around. The seed is fixed to get the same scene at every run.
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float rotations[] = { -2.0f, -1.0f, 1.0f, 2.0f };
+    for (uint32_t i = 2; i < m_objectCount; i++)
+    {
+        float angle = unit(generator) * glm::two_pi<float>();
+        float distance = 7.0f + 53.0f * unit(generator);
+        float height = -15.0f + 30.0f * unit(generator);
+        float scale = 0.1f + 0.2f * unit(generator);
+
+        glm::mat4 Tran = glm::translate(glm::identity<glm::mat4>(), glm::vec3(distance * cosf(angle), distance * sinf(angle), height));
+        glm::mat4 Scale = glm::scale(glm::mat4(1.0f), glm::vec3(scale, scale, scale));
+        m_objects[i].world = Tran * Scale;
+        m_objects[i].rotation = glm::vec4(rotations[generator() % 4], 0.0f, 0.0f, 0.0f);
+    }
+}
+
+void VKHelloTransformations::CreateStorageBuffers()
+{
+    //
+    // Create the buffer storing the per-object data read by the culling shader.
+    // It never changes, so it's stored in device-local memory.
+    //
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_objectCount * sizeof(ObjectData);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    CreateBuffer(m_memAllocator, bufferInfo, m_objectBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    m_objectBuffer.Descriptor.buffer = m_objectBuffer.Handle;
+    m_objectBuffer.Descriptor.offset = 0;
+    m_objectBuffer.Descriptor.range = VK_WHOLE_SIZE;
+    m_objectBuffer.Size = bufferInfo.size;
+
+    // Upload the per-object data through a staging ring buffer, which is no longer needed once the copies are complete.
+    VKStagingRing stagingRing;
+    stagingRing.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device,
+                     m_vulkanParams.GraphicsQueue.Handle, m_vulkanParams.GraphicsQueue.FamilyIndex,
+                     m_vulkanParams.GraphicsQueue.Handle, m_vulkanParams.GraphicsQueue.FamilyIndex);
+    stagingRing.UploadBuffer(m_objectBuffer.Handle, 0, m_objects.data(), m_objectBuffer.Size);
+    stagingRing.Flush();
+    stagingRing.Destroy();
+
+    //
+    // Create the buffers written by the culling shader.
+    // They are read by the draw (and the vertex shader) of the same frame, so each frame in flight needs its own buffers.
+    // Only the GPU accesses them, so they are stored in device-local memory as well.
+    //
+
+    m_instanceBuffers.resize(m_framesInFlight);
+    m_drawBuffers.resize(m_framesInFlight);
+    m_drawCountBuffers.resize(m_framesInFlight);
+
+    for (size_t i = 0; i < m_framesInFlight; i++)
+    {
+        // World matrices of the objects, indexed by the vertex shader with gl_InstanceIndex
+        bufferInfo.size = m_objectCount * sizeof(glm::mat4);
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        CreateBuffer(m_memAllocator, bufferInfo, m_instanceBuffers[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Indirect draw commands (one for each object)
+        bufferInfo.size = m_objectCount * sizeof(VkDrawIndexedIndirectCommand);
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        CreateBuffer(m_memAllocator, bufferInfo, m_drawBuffers[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Number of indirect draw commands (reset by vkCmdFillBuffer at every frame)
+        bufferInfo.size = sizeof(uint32_t);
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        CreateBuffer(m_memAllocator, bufferInfo, m_drawCountBuffers[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Store information needed to write the corresponding descriptors (storage buffers) in the descriptor set later.
+        for (BufferParameters* buffer : { &m_instanceBuffers[i], &m_drawBuffers[i], &m_drawCountBuffers[i] })
+        {
+            buffer->Descriptor.buffer = buffer->Handle;
+            buffer->Descriptor.offset = 0;
+            buffer->Descriptor.range = VK_WHOLE_SIZE;
+        }
+    }
 }
 
 void VKHelloTransformations::CreateHostVisibleBuffers()
@@ -356,15 +613,14 @@ void VKHelloTransformations::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -384,7 +640,7 @@ void VKHelloTransformations::CreateHostVisibleDynamicBuffers()
 	if (minUBOAlignment > 0)
 		m_dynamicUBOAlignment = (m_dynamicUBOAlignment + minUBOAlignment - 1) & ~(minUBOAlignment - 1);
     
-	size_t dynBufferSize = m_numDrawCalls * m_dynamicUBOAlignment;
+	size_t dynBufferSize = m_objectCount * m_dynamicUBOAlignment;
 
     dynUBufVS.worldMatrix = (glm::mat4*)AlignedAlloc(dynBufferSize, m_dynamicUBOAlignment);
 	assert(dynUBufVS.worldMatrix);
@@ -400,15 +656,14 @@ void VKHelloTransformations::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -427,45 +682,19 @@ void VKHelloTransformations::UpdateHostVisibleBufferData()
 {
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
         memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
 void VKHelloTransformations::UpdateHostVisibleDynamicBufferData()
 {
-    const float rotationSpeed = 0.8f;
-
-    // Update the rotation angle
-    m_curRotationAngleRad += rotationSpeed * m_timer.GetElapsedSeconds();
-    if (m_curRotationAngleRad >= glm::two_pi<float>())
-    {
-        m_curRotationAngleRad -= glm::two_pi<float>();
-    }
-
-    for (size_t i = 0; i < m_numDrawCalls; i++)
+    for (size_t i = 0; i < m_objectCount; i++)
     {
         glm::mat4* worldMat = (glm::mat4*)((uint64_t)dynUBufVS.worldMatrix + (i * m_dynamicUBOAlignment));
 
-        if (!i)
-        {
-            // Rotate the cube at the center of the scene around the z-axis
-            glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
-            *worldMat = RotZ;
-        }
-        else
-        {
-            // Rotate the second cube around the first cube at double velocity and in reverse direction.
-            glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), -2.0f * m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
-            glm::mat4 Tran = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, 5.0f, 0.0f));
-            glm::mat4 Scale = glm::scale(glm::mat4(1.0f), glm::vec3(0.2f, 0.2f, 0.2f)); // both glm::mat4(1.0f) and glm::identity<glm::mat4>() build a 4x4 identity matrix
-            *worldMat = RotZ * Tran * Scale;
-
-            // Equivalent to:
-            // glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), -2.0f * m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
-            // glm::mat4 TranRotZ = glm::translate(RotZ, glm::vec3(0.0f, 5.0f, 0.0f));
-            // glm::mat4 TranRotZScale = glm::scale(TranRotZ, glm::vec3(0.2f, 0.2f, 0.2f));
-            // *worldMat = TranRotZScale;
-        }
+        // Rotate the object around the z-axis of the scene (see CreateObjects)
+        glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), m_objects[i].rotation.x * m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
+        *worldMat = RotZ * m_objects[i].world;
     }
 
     // Update dynamic uniform buffer data
@@ -475,6 +704,45 @@ void VKHelloTransformations::UpdateHostVisibleDynamicBufferData()
            m_sampleParams.FrameRes.HostVisibleDynamicBuffers[m_frameIndex].Size);
 }
 
+void VKHelloTransformations::CreatePerInstanceBuffers()
+{
+    //
+    // Create the per-instance vertex buffers storing the world matrices of the objects.
+    // They are updated from the CPU at every frame, so each frame in flight needs its own buffer 
+    // in host-visible device memory.
+    //
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_objectCount * sizeof(glm::mat4);
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+    m_perInstanceBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
+    {
+        CreateBuffer(m_memAllocator, 
+                     bufferInfo, 
+                     m_perInstanceBuffers[i],
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        m_perInstanceBuffers[i].Size = bufferInfo.size;
+    }
+}
+
+void VKHelloTransformations::UpdatePerInstanceBufferData()
+{
+    // Write the world matrices directly to the per-instance vertex buffer of the current frame, with no padding between them.
+    // Note: Since we requested a host coherent memory type for the buffer, the writes are instantly visible to the GPU
+    glm::mat4* worldMat = static_cast<glm::mat4*>(m_perInstanceBuffers[m_frameIndex].MappedMemory);
+
+    for (size_t i = 0; i < m_objectCount; i++)
+    {
+        // Rotate the object around the z-axis of the scene (see CreateObjects)
+        glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), m_objects[i].rotation.x * m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
+        worldMat[i] = RotZ * m_objects[i].world;
+    }
+}
+
 void VKHelloTransformations::CreateDescriptorPool()
 {
     //
@@ -484,22 +752,24 @@ void VKHelloTransformations::CreateDescriptorPool()
     //
 
     // Describe the number of descriptors per type.
-    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer)
+    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer).
+    // In GPU-driven mode, the dynamic uniform buffer is replaced by four storage buffers.
+    // In instanced mode, it's replaced by a per-instance vertex buffer, which is not accessed through a descriptor.
     VkDescriptorPoolSize typeCounts[2];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
+    typeCounts[1].type = m_gpuDriven ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight) * (m_gpuDriven ? 4 : 1);
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
     VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
     descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptorPoolInfo.pNext = nullptr;
-    descriptorPoolInfo.poolSizeCount = 2;
+    descriptorPoolInfo.poolSizeCount = m_instanced ? 1 : 2;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -511,24 +781,41 @@ void VKHelloTransformations::CreateDescriptorSetLayout()
     // in the shader code to descriptors within descriptor sets.
     //
     // Binding 0: Uniform buffer (Vertex shader)
-    VkDescriptorSetLayoutBinding layoutBinding[2] = {};
+    VkDescriptorSetLayoutBinding layoutBinding[5] = {};
     layoutBinding[0].binding = 0;
     layoutBinding[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     layoutBinding[0].descriptorCount = 1;
     layoutBinding[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     layoutBinding[0].pImmutableSamplers = nullptr;
 
-    // Binding 1: Dynamic uniform buffer (Vertex shader)
+    // Binding 1: Dynamic uniform buffer (Vertex shader; not used in instanced mode)
     layoutBinding[1].binding = 1;
     layoutBinding[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     layoutBinding[1].descriptorCount = 1;
     layoutBinding[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     layoutBinding[1].pImmutableSamplers = nullptr;
 
+    // In GPU-driven mode:
+    // Binding 1: Storage buffer with the world matrices (written by the compute shader, read by the vertex shader)
+    // Binding 2: Storage buffer with the per-object data (Compute shader)
+    // Binding 3: Storage buffer with the indirect draw commands (Compute shader)
+    // Binding 4: Storage buffer with the number of indirect draw commands (Compute shader)
+    if (m_gpuDriven)
+    {
+        for (uint32_t i = 1; i < 5; i++)
+        {
+            layoutBinding[i].binding = i;
+            layoutBinding[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            layoutBinding[i].descriptorCount = 1;
+            layoutBinding[i].stageFlags = (i == 1) ? VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT : VK_SHADER_STAGE_COMPUTE_BIT;
+            layoutBinding[i].pImmutableSamplers = nullptr;
+        }
+    }
+
     VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
     descriptorLayout.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     descriptorLayout.pNext = nullptr;
-    descriptorLayout.bindingCount = 2;
+    descriptorLayout.bindingCount = m_gpuDriven ? 5 : (m_instanced ? 1 : 2);
     descriptorLayout.pBindings = layoutBinding;
 
     VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_sampleParams.DescriptorSetLayout));
@@ -536,46 +823,72 @@ void VKHelloTransformations::CreateDescriptorSetLayout()
 
 void VKHelloTransformations::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
     // For every binding point used in a shader code there needs to be at least a descriptor 
     // in a descriptor set matching that binding point.
     //
-    VkWriteDescriptorSet writeDescriptorSet[2] = {};
+    VkWriteDescriptorSet writeDescriptorSet[5] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
         writeDescriptorSet[0].dstBinding = 0;
 
-        // Write the descriptor of the dynamic uniform buffer.
-        writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
-        writeDescriptorSet[1].descriptorCount = 1;
-        writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-        writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
-        writeDescriptorSet[1].dstBinding = 1;
-
-        vkUpdateDescriptorSets(m_vulkanParams.Device, 2, writeDescriptorSet, 0, nullptr);
+        if (m_gpuDriven)
+        {
+            // Write the descriptors of the storage buffers read and written by the culling shader.
+            const VkDescriptorBufferInfo* storageBuffers[4] = { &m_instanceBuffers[i].Descriptor, 
+                                                                &m_objectBuffer.Descriptor, 
+                                                                &m_drawBuffers[i].Descriptor, 
+                                                                &m_drawCountBuffers[i].Descriptor };
+            for (uint32_t j = 1; j < 5; j++)
+            {
+                writeDescriptorSet[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writeDescriptorSet[j].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
+                writeDescriptorSet[j].descriptorCount = 1;
+                writeDescriptorSet[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                writeDescriptorSet[j].pBufferInfo = storageBuffers[j - 1];
+                writeDescriptorSet[j].dstBinding = j;
+            }
+
+            vkUpdateDescriptorSets(m_vulkanParams.Device, 5, writeDescriptorSet, 0, nullptr);
+        }
+        else if (m_instanced)
+        {
+            vkUpdateDescriptorSets(m_vulkanParams.Device, 1, writeDescriptorSet, 0, nullptr);
+        }
+        else
+        {
+            // Write the descriptor of the dynamic uniform buffer.
+            writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
+            writeDescriptorSet[1].descriptorCount = 1;
+            writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+            writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
+            writeDescriptorSet[1].dstBinding = 1;
+
+            vkUpdateDescriptorSets(m_vulkanParams.Device, 2, writeDescriptorSet, 0, nullptr);
+        }
     }
 }
 
@@ -583,11 +896,20 @@ void VKHelloTransformations::CreatePipelineLayout()
 {
     // Create a pipeline layout that will be used to create one or more pipeline objects.
     // In this case we have a pipeline layout with a single descriptor set layout.
+    // In GPU-driven mode the same layout is used by the culling (compute) pipeline, which also needs
+    // a push constant range for the frustum planes and the rotation angle.
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(m_cullingPushConstants);
+
     VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo = {};
     pPipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pPipelineLayoutCreateInfo.pNext = nullptr;
     pPipelineLayoutCreateInfo.setLayoutCount = 1;
     pPipelineLayoutCreateInfo.pSetLayouts = &m_sampleParams.DescriptorSetLayout;
+    pPipelineLayoutCreateInfo.pushConstantRangeCount = m_gpuDriven ? 1 : 0;
+    pPipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
     
     VK_CHECK_RESULT(vkCreatePipelineLayout(m_vulkanParams.Device, &pPipelineLayoutCreateInfo, nullptr, &m_sampleParams.PipelineLayout));
 }
@@ -603,15 +925,20 @@ void VKHelloTransformations::CreatePipelineObjects()
     //    
     // Vertex binding descriptions describe the input assembler binding points where vertex buffers will be bound.
     // This sample uses a single vertex buffer at binding point 0 (see vkCmdBindVertexBuffers).
-    VkVertexInputBindingDescription vertexInputBinding = {};
-    vertexInputBinding.binding = 0;
-    vertexInputBinding.stride = sizeof(Vertex);
-    vertexInputBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    // In instanced mode, a second vertex buffer at binding point 1 provides the world matrices: its input rate
+    // is per-instance, so the input assembler advances to the next matrix for each instance rather than each vertex.
+    std::array<VkVertexInputBindingDescription, 2> vertexInputBindings;
+    vertexInputBindings[0].binding = 0;
+    vertexInputBindings[0].stride = sizeof(Vertex);
+    vertexInputBindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    vertexInputBindings[1].binding = 1;
+    vertexInputBindings[1].stride = sizeof(glm::mat4);
+    vertexInputBindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
     
     // Vertex attribute descriptions describe the vertex shader attribute locations and memory layouts, 
     // as well as the binding points from which the input assembler should retrieve data to pass to the 
     // corresponding vertex shader input attributes.
-    std::array<VkVertexInputAttributeDescription, 2> vertexInputAttributs;
+    std::array<VkVertexInputAttributeDescription, 6> vertexInputAttributs;
     // These match the following shader layout (see vertex shader):
     //	layout (location = 0) in vec3 inPos;
     //	layout (location = 1) in vec4 inColor;
@@ -628,6 +955,16 @@ void VKHelloTransformations::CreatePipelineObjects()
     // Color attribute is two 32-bit signed (SFLOAT) floats (R32 G32 B32 A32)
     vertexInputAttributs[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
     vertexInputAttributs[1].offset = offsetof(Vertex, color);
+    // Attribute locations 2 to 5: World matrix from the per-instance vertex buffer at binding point 1 (instanced mode).
+    //	layout (location = 2) in mat4 inWorld;
+    // A mat4 input takes four consecutive locations, one for each column (four 32-bit floats).
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        vertexInputAttributs[2 + i].binding = 1;
+        vertexInputAttributs[2 + i].location = 2 + i;
+        vertexInputAttributs[2 + i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        vertexInputAttributs[2 + i].offset = i * sizeof(glm::vec4);
+    }
     
     // Vertex input state used for pipeline creation.
     // The Vulkan specification uses it to specify the input of the entire pipeline, 
@@ -635,9 +972,9 @@ void VKHelloTransformations::CreatePipelineObjects()
     // part of the input assembler state.
     VkPipelineVertexInputStateCreateInfo vertexInputState = {};
     vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputState.vertexBindingDescriptionCount = 1;
-    vertexInputState.pVertexBindingDescriptions = &vertexInputBinding;
-    vertexInputState.vertexAttributeDescriptionCount = 2;
+    vertexInputState.vertexBindingDescriptionCount = m_instanced ? 2 : 1;
+    vertexInputState.pVertexBindingDescriptions = vertexInputBindings.data();
+    vertexInputState.vertexAttributeDescriptionCount = m_instanced ? 6 : 2;
     vertexInputState.pVertexAttributeDescriptions = vertexInputAttributs.data();
     
     // Input assembly state describes how primitives are assembled by the input assembler.
@@ -729,8 +1066,9 @@ void VKHelloTransformations::CreatePipelineObjects()
     shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     // Set pipeline stage for this shader
     shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-    // Load binary SPIR-V shader module
-    shaderStages[0].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/main.vert.spv");
+    // Load binary SPIR-V shader module (in GPU-driven and instanced modes, the world matrices are read from a storage and a vertex buffer, respectively)
+    const char* vertexShader = m_gpuDriven ? "/data/shaders/indirect.vert.spv" : (m_instanced ? "/data/shaders/instanced.vert.spv" : "/data/shaders/main.vert.spv");
+    shaderStages[0].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + vertexShader);
     // Main entry point for the shader
     shaderStages[0].pName = "main";
     assert(shaderStages[0].module != VK_NULL_HANDLE);
@@ -771,7 +1109,7 @@ void VKHelloTransformations::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline using the specified states
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipeline));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineVertexColor]));
     
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -779,6 +1117,164 @@ void VKHelloTransformations::CreatePipelineObjects()
     vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[1].module, nullptr);
 }
 
+void VKHelloTransformations::CreateCullingPipeline()
+{
+    //
+    // Workgroup size and number of workgroups
+    //
+
+    // Use the preferred workgroup size, unless it exceeds the device limits
+    const VkPhysicalDeviceLimits& limits = m_deviceProperties.limits;
+    m_cullingSpecConstants.workGroupSize = std::min({ static_cast<uint32_t>(CULLING_WORKGROUP_SIZE), 
+                                                      limits.maxComputeWorkGroupSize[0], 
+                                                      limits.maxComputeWorkGroupInvocations });
+    m_cullingSpecConstants.objectCount = m_objectCount;
+    m_cullingSpecConstants.indexCount = static_cast<uint32_t>(m_vertexindexBuffer.indexBufferCount);
+    m_cullingSpecConstants.compactDraws = m_drawIndirectCount ? VK_TRUE : VK_FALSE;
+
+    // Dispatch an invocation for each object. If the number of workgroups exceeds the max number 
+    // of workgroups that can be dispatched in the X dimension, lay them out on a 2D grid.
+    uint32_t groupCount = (m_objectCount + m_cullingSpecConstants.workGroupSize - 1) / m_cullingSpecConstants.workGroupSize;
+    m_dispatchGroupCount[0] = std::min(groupCount, limits.maxComputeWorkGroupCount[0]);
+    m_dispatchGroupCount[1] = (groupCount + m_dispatchGroupCount[0] - 1) / m_dispatchGroupCount[0];
+    assert(m_dispatchGroupCount[1] <= limits.maxComputeWorkGroupCount[1]);
+
+    //
+    // Set specialization constants
+    //
+
+    // Each VkSpecializationMapEntry maps a constant ID to an offset into the buffer specified by VkSpecializationInfo::pData
+    std::array<VkSpecializationMapEntry, 4> specializationMapEntries;
+
+    // This entry maps constant ID 0 (local_size_x_id) to CullingSpecConsts::workGroupSize
+    specializationMapEntries[0].constantID = 0;
+    specializationMapEntries[0].size = sizeof(CullingSpecConsts::workGroupSize);
+    specializationMapEntries[0].offset = offsetof(CullingSpecConsts, workGroupSize);
+
+    // This entry maps constant ID 1 to CullingSpecConsts::objectCount
+    specializationMapEntries[1].constantID = 1;
+    specializationMapEntries[1].size = sizeof(CullingSpecConsts::objectCount);
+    specializationMapEntries[1].offset = offsetof(CullingSpecConsts, objectCount);
+
+    // This entry maps constant ID 2 to CullingSpecConsts::indexCount
+    specializationMapEntries[2].constantID = 2;
+    specializationMapEntries[2].size = sizeof(CullingSpecConsts::indexCount);
+    specializationMapEntries[2].offset = offsetof(CullingSpecConsts, indexCount);
+
+    // This entry maps constant ID 3 to CullingSpecConsts::compactDraws
+    specializationMapEntries[3].constantID = 3;
+    specializationMapEntries[3].size = sizeof(CullingSpecConsts::compactDraws);
+    specializationMapEntries[3].offset = offsetof(CullingSpecConsts, compactDraws);
+
+    // Prepare specialization info for the shader stage
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.dataSize = sizeof(m_cullingSpecConstants);
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationMapEntries.size());
+    specializationInfo.pMapEntries = specializationMapEntries.data();
+    specializationInfo.pData = &m_cullingSpecConstants;
+
+    VkPipelineShaderStageCreateInfo shaderStage{};
+    
+    // Compute shader
+    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    // Set pipeline stage for this shader
+    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    // Load binary SPIR-V shader module
+    shaderStage.module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/cull.comp.spv");
+    // Main entry point for the shader
+    shaderStage.pName = "main";
+    // Specialization info (workgroup size, number of objects, number of indices per object and packing of the draw commands)
+    shaderStage.pSpecializationInfo = &specializationInfo;
+    assert(shaderStage.module != VK_NULL_HANDLE);
+
+    //
+    // Create the compute pipeline
+    //
+
+    VkComputePipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    // The pipeline layout is shared with the graphics pipeline
+    pipelineCreateInfo.layout = m_sampleParams.PipelineLayout;    
+    // Set pipeline shader stage
+    pipelineCreateInfo.stage = shaderStage;
+    
+    VK_CHECK_RESULT(vkCreateComputePipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_cullingPipeline));
+
+    // Destroy shader module
+    vkDestroyShaderModule(m_vulkanParams.Device, shaderStage.module, nullptr);
+}
+
+void VKHelloTransformations::RecordCulling(VkCommandBuffer commandBuffer)
+{
+    //
+    // Extract the planes of the view frustum, in world space, from the rows of the view-projection matrix.
+    // A point p is inside the frustum if dot(plane.xyz, p) + plane.w >= 0 for all the six planes, and a 
+    // sphere is (at least partially) inside if that distance is greater than minus its radius.
+    //
+
+    glm::mat4 viewProj = uBufVS.projectionMatrix * uBufVS.viewMatrix;
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+        rows[i] = glm::vec4(viewProj[0][i], viewProj[1][i], viewProj[2][i], viewProj[3][i]);
+
+    m_cullingPushConstants.frustumPlanes[0] = rows[3] + rows[0];  // Left   (-w <= x)
+    m_cullingPushConstants.frustumPlanes[1] = rows[3] - rows[0];  // Right  (x <= w)
+    m_cullingPushConstants.frustumPlanes[2] = rows[3] + rows[1];  // Bottom (-w <= y)
+    m_cullingPushConstants.frustumPlanes[3] = rows[3] - rows[1];  // Top    (y <= w)
+    m_cullingPushConstants.frustumPlanes[4] = rows[2];            // Near   (0 <= z)
+    m_cullingPushConstants.frustumPlanes[5] = rows[3] - rows[2];  // Far    (z <= w)
+
+    // Normalize the planes so that the distance from them is expressed in world units
+    for (glm::vec4& plane : m_cullingPushConstants.frustumPlanes)
+        plane /= glm::length(glm::vec3(plane));
+
+    m_cullingPushConstants.rotationAngle = m_curRotationAngleRad;
+
+    // Reset the number of draw commands before the culling shader increments it
+    if (m_drawIndirectCount)
+    {
+        vkCmdFillBuffer(commandBuffer, m_drawCountBuffers[m_frameIndex].Handle, 0, sizeof(uint32_t), 0);
+
+        VkMemoryBarrier fillBarrier = {};
+        fillBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        fillBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        fillBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             1, &fillBarrier,
+                             0, nullptr,
+                             0, nullptr);
+    }
+
+    // Cull the objects, writing the world matrices and the draw commands of the visible ones
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullingPipeline);
+    vkCmdBindDescriptorSets(commandBuffer, 
+                            VK_PIPELINE_BIND_POINT_COMPUTE, 
+                            m_sampleParams.PipelineLayout, 
+                            0, 1, 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                            0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_sampleParams.PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(m_cullingPushConstants), &m_cullingPushConstants);
+    vkCmdDispatch(commandBuffer, m_dispatchGroupCount[0], m_dispatchGroupCount[1], 1);
+
+    // The draw commands (and their number) are read by the indirect draw, and the world matrices by the vertex shader
+    VkMemoryBarrier cullingBarrier = {};
+    cullingBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    cullingBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    cullingBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                         0,
+                         1, &cullingBarrier,
+                         0, nullptr,
+                         0, nullptr);
+}
+
 void VKHelloTransformations::PopulateCommandBuffer(uint32_t currentImageIndex)
 {
     VkCommandBufferBeginInfo cmdBufInfo = {};
@@ -805,11 +1301,15 @@ void VKHelloTransformations::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
+
+    // In GPU-driven mode, cull the objects before the render pass begins (dispatches are not allowed inside a render pass)
+    if (m_gpuDriven)
+        RecordCulling(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -817,7 +1317,7 @@ void VKHelloTransformations::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -825,45 +1325,86 @@ void VKHelloTransformations::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
 
     // Bind the graphics pipeline.
     // The pipeline object contains all states of the graphics pipeline, 
     // binding it will set all the states specified at pipeline creation time
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                       VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                      m_sampleParams.GraphicsPipeline);
+                      m_sampleParams.Pipelines[m_pipelineVertexColor]);
     
     // Bind the vertex buffer (contains positions and colors)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
 
     // Bind the index buffer
-	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
 
-    // Render multiple objects using different world matrices by dynamically offsetting into one uniform buffer
-    for (uint32_t j = 0; j < m_numDrawCalls; j++)
+    if (m_gpuDriven)
     {
-        // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing all world matrices
-        uint32_t dynamicOffset = j * static_cast<uint32_t>(m_dynamicUBOAlignment);
+        // Bind the descriptor set (the world matrices are read from a storage buffer, so no dynamic offset is needed)
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                m_sampleParams.PipelineLayout, 
+                                0, 1, 
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                                0, nullptr);
+
+        // Draw all the visible objects with a single command, whose parameters are read from the buffers written by the culling shader.
+        // With VK_KHR_draw_indirect_count the number of draws is read from a buffer as well (up to m_objectCount).
+        if (m_drawIndirectCount)
+            vkCmdDrawIndexedIndirectCountKHR(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                             m_drawBuffers[m_frameIndex].Handle, 0, 
+                                             m_drawCountBuffers[m_frameIndex].Handle, 0, 
+                                             m_objectCount, sizeof(VkDrawIndexedIndirectCommand));
+        else
+            vkCmdDrawIndexedIndirect(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                     m_drawBuffers[m_frameIndex].Handle, 0, 
+                                     m_objectCount, sizeof(VkDrawIndexedIndirectCommand));
+    }
+    else if (m_instanced)
+    {
+        // Bind the per-instance vertex buffer (contains the world matrices of the current frame)
+        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 1, 1, &m_perInstanceBuffers[m_frameIndex].Handle, offsets);
 
-        // Bind descriptor sets for drawing a mesh using a dynamic offset
-        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+        // Bind the descriptor set once for all the objects
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                                 VK_PIPELINE_BIND_POINT_GRAPHICS, 
                                 m_sampleParams.PipelineLayout, 
                                 0, 1, 
-                                &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                                1, &dynamicOffset);
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                                0, nullptr);
 
-        // Draw a cube
-        vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, 1, 0, 0, 0);
+        // Draw an instance of the cube for each object
+        vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, m_objectCount, 0, 0, 0);
+    }
+    else
+    {
+        // Render multiple objects using different world matrices by dynamically offsetting into one uniform buffer
+        for (uint32_t j = 0; j < m_objectCount; j++)
+        {
+            // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing all world matrices
+            uint32_t dynamicOffset = j * static_cast<uint32_t>(m_dynamicUBOAlignment);
+
+            // Bind descriptor sets for drawing a mesh using a dynamic offset
+            vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                    m_sampleParams.PipelineLayout, 
+                                    0, 1, 
+                                    &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                                    1, &dynamicOffset);
+
+            // Draw a cube
+            vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, 1, 0, 0, 0);
+        }
     }
     
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
     
-     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKHelloTransformations::SubmitCommandBuffer()
@@ -876,13 +1417,13 @@ void VKHelloTransformations::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKHelloTransformations::PresentImage(uint32_t currentImageIndex)
@@ -897,13 +1438,13 @@ void VKHelloTransformations::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -0,0 +1,27 @@
+#version 450
+
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec3 inNormal;
+
+// Per-instance attributes, read from the vertex buffer at binding point 1
+layout (location = 2) in mat4 inWorld;          // Locations 2 to 5, one for each column
+layout (location = 6) in vec4 inSolidColor;
+
+layout(std140, set = 0, binding = 0) uniform buf {
+    mat4 View;
+    mat4 Projection;
+    vec4 lightDirs[2];
+    vec4 lightColors[2];
+} uBuf;
+
+layout (location = 0) out vec3 outNormal;
+layout (location = 1) out vec4 outSolidColor;
+
+void main() 
+{
+    outNormal = mat3(inWorld) * inNormal;                // Transforms the normal vector and pass it to the next stage
+    vec4 worldPos = inWorld * vec4(inPos, 1.0);          // Local to World
+    vec4 viewPos = uBuf.View * worldPos;                 // World to View
+    gl_Position = uBuf.Projection * viewPos;             // View to Clip
+    outSolidColor = inSolidColor;                        // Pass the solid color to the next stage
+}
\ No newline at end of file
@@ -10,11 +10,6 @@ layout(std140, set = 0, binding = 0) uniform buf {
     vec4 lightColors[2];
 } uBuf;
 
-layout(std140, set = 0, binding = 1) uniform dynbuf {
-    mat4 World;
-    vec4 solidColor;
-} dynBuf;
-
 // Fragment shader applying Lambertian lighting using two directional lights
 void main() 
 {
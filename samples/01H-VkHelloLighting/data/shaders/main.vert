@@ -16,6 +16,7 @@ layout(std140, set = 0, binding = 1) uniform dynbuf {
 } dynBuf;
 
 layout (location = 0) out vec3 outNormal;
+layout (location = 1) out vec4 outSolidColor;
 
 void main() 
 {
@@ -23,4 +24,5 @@ void main()
     vec4 worldPos = dynBuf.World * vec4(inPos, 1.0);     // Local to World
     vec4 viewPos = uBuf.View * worldPos;                 // World to View
     gl_Position = uBuf.Projection * viewPos;             // View to Clip
+    outSolidColor = dynBuf.solidColor;                   // Pass the solid color to the next stage
 }
\ No newline at end of file
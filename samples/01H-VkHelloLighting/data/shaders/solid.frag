@@ -1,6 +1,7 @@
 #version 450
 
 layout (location = 0) in vec3 inNormal;
+layout (location = 1) in vec4 inSolidColor;
 layout (location = 0) out vec4 outFragColor;
 
 layout(std140, set = 0, binding = 0) uniform buf {
@@ -10,13 +11,8 @@ layout(std140, set = 0, binding = 0) uniform buf {
     vec4 lightColors[2];
 } uBuf;
 
-layout(std140, set = 0, binding = 1) uniform dynbuf {
-    mat4 World;
-    vec4 solidColor;
-} dynBuf;
-
 // Fragment shader applying solid color
 void main() 
 {
-  outFragColor = dynBuf.solidColor;
+  outFragColor = inSolidColor;
 }
\ No newline at end of file
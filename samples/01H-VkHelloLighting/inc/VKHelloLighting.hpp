@@ -29,8 +29,10 @@ private:
     void PresentImage(uint32_t currentImageIndex);
     
     void CreateVertexBuffer();              // Create a vertex buffer
+    void CreateObjects();                   // Place the lit cubes in the scene
     void CreateHostVisibleBuffers();        // Create a buffer in host-visible memory
     void CreateHostVisibleDynamicBuffers(); // Create a dynamic buffer
+    void CreatePerInstanceBuffers();        // Create the per-instance vertex buffers (instanced mode)
     void CreateDescriptorPool();            // Create a descriptor pool
     void CreateDescriptorSetLayout();       // Create a descriptor set layout
     void AllocateDescriptorSets();          // Allocate a descriptor set
@@ -40,6 +42,7 @@ private:
     // Update buffer data
     void UpdateHostVisibleBufferData();
     void UpdateHostVisibleDynamicBufferData();
+    void UpdatePerInstanceBufferData();
 
     // For simplicity we use the same uniform block layout as in the vertex shader:
     //
@@ -85,17 +88,45 @@ private:
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffer;
 
-    // In this sample we have three draw calls for each frame.
-    const unsigned int m_numDrawCalls = 3;
+    // Placement of a cube lit by the light sources
+    struct ObjectData {
+        glm::mat4 world;          // Placement of the cube, before the rotation around the z-axis
+        float rotation;           // Rotation around the z-axis, as a multiple of m_curRotationAngleRad
+    };
+
+    // Compute the world matrix and solid color of a cube for the current frame
+    void GetMeshInfo(uint32_t objectIndex, MeshInfo& meshInfo);
+
+    // Lit cubes in the scene (the first one is the cube at the center of the scene, the others are scattered around it).
+    // In the dynamic uniform buffer and in the per-instance vertex buffer they are followed by the two cubes 
+    // representing the light sources, drawn with a solid color.
+    std::vector<ObjectData> m_objects;
+
+    // Instanced mode (--instanced).
+    // The mesh info of the cubes is tightly packed in a per-instance vertex buffer (80 bytes per cube, rather 
+    // than a slot of the dynamic uniform buffer aligned to minUniformBufferOffsetAlignment), and all the cubes 
+    // drawn with the same pipeline are drawn by a single instanced draw call:
+    //
+    // layout (location = 2) in mat4 inWorld;
+    // layout (location = 6) in vec4 inSolidColor;
+    //
+    bool m_instanced;
+    std::vector<BufferParameters> m_perInstanceBuffers;   // One for each frame in flight
+
+    // Handles of the named pipelines and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineLambertian;
+    TableHandle m_pipelineSolidColor;
+    TableHandle m_descSetGraphics;
 
     // Sample members
     float m_curRotationAngleRad;
     size_t m_dynamicUBOAlignment;
+    uint32_t m_objectCount;            // Number of cubes in the scene, including the light sources (set at launch with --objects N)
 };
\ No newline at end of file
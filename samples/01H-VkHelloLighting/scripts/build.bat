@@ -13,7 +13,7 @@ if exist "%VULKAN_SDK%\Include\vulkan\vulkan.h" (
     SET VULKAN_INCLUDE=..\..\external\include\vulkan
 )
 
-SET includes=/I inc /I ..\..\external\include ^
+SET includes=/I inc /I ..\..\framework\inc /I ..\..\external\include ^
 /I %VULKAN_INCLUDE%
 
 SET defines=/D DEBUG /D _WIN32 /D VK_USE_PLATFORM_WIN32_KHR /D _CRT_SECURE_NO_WARNINGS
@@ -30,11 +30,12 @@ SET links=/link kernel32.lib user32.lib shell32.lib gdi32.lib vulkan-1.lib ^
 echo Compiling shader...
 
 ..\..\bin\glslangValidator -V -g .\data\shaders\main.vert -o .\data\shaders\main.vert.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\instanced.vert -o .\data\shaders\instanced.vert.spv
 ..\..\bin\glslangValidator -V -g .\data\shaders\solid.frag -o .\data\shaders\solid.frag.spv
 ..\..\bin\glslangValidator -V -g .\data\shaders\lambertian.frag -o .\data\shaders\lambertian.frag.spv
 
 echo Building project...
 
-cl src/*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
+cl src/*.cpp ..\..\framework\src\*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
 
 del *.obj vc*.idb vc*.pdb
\ No newline at end of file
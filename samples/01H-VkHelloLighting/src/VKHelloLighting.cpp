@@ -1,16 +1,25 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloLighting.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/ext/scalar_constants.hpp"
 
+#include <random>
+
 VKHelloLighting::VKHelloLighting(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
+m_instanced(false),
 m_curRotationAngleRad(0.0f),
-m_dynamicUBOAlignment(0)
+m_dynamicUBOAlignment(0),
+m_objectCount(3)
 {
+    // Register the named pipelines and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineLambertian = m_sampleParams.Pipelines.Register("Lambertian");
+    m_pipelineSolidColor = m_sampleParams.Pipelines.Register("SolidColor");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
+
     // Initialize the pointer to the memory region that will store the array of world matrices.
     dynUBufVS.meshInfo = nullptr;
 
@@ -38,6 +47,18 @@ VKHelloLighting::~VKHelloLighting()
 
 void VKHelloLighting::OnInit()
 {
+    // --instanced draws all the cubes with the same pipeline by a single instanced draw call, reading their
+    // world matrices and colors from a vertex buffer.
+    // The number of cubes, including the two light sources, can be specified on the command line (--objects N).
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--objects") == 0 && i + 1 < args.size())
+            m_objectCount = std::max(3u, static_cast<uint32_t>(strtoul(args[i + 1], nullptr, 10)));
+        else if (strcmp(args[i], "--instanced") == 0)
+            m_instanced = true;
+    }
+
     InitVulkan();
     SetupPipeline();
 }
@@ -59,13 +80,21 @@ void VKHelloLighting::InitVulkan()
 void VKHelloLighting::SetupPipeline()
 {
     CreateVertexBuffer();
+    CreateObjects();
     CreateHostVisibleBuffers();
-    CreateHostVisibleDynamicBuffers();
+    if (m_instanced)
+        CreatePerInstanceBuffers();
+    else
+        CreateHostVisibleDynamicBuffers();
     CreateDescriptorPool();
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
+
+    printf("Drawing %u objects with %s\n", m_objectCount, m_instanced ? "an instanced draw call per pipeline" : "a draw call each");
 
     m_initialized = true;
 }
@@ -79,27 +108,38 @@ void VKHelloLighting::OnUpdate()
     snprintf(m_lastFPS, (size_t)32, "%u fps", m_timer.GetFramesPerSecond());
     m_frameCounter++;
 
-    // Update dynamic buffer data (world matrices and solid colors)
-    UpdateHostVisibleDynamicBufferData();
+    const float rotationSpeed = 0.8f;
+
+    // Update the rotation angle
+    m_curRotationAngleRad += rotationSpeed * m_timer.GetElapsedSeconds();
+    if (m_curRotationAngleRad >= glm::two_pi<float>())
+    {
+        m_curRotationAngleRad -= glm::two_pi<float>();
+    }
 
     // Update buffer data (light direction, view and projection matrices)
     UpdateHostVisibleBufferData();
+
+    // Update dynamic buffer data (world matrices and solid colors), or the per-instance vertex buffer in instanced mode.
+    // The light sources are placed along the light directions, so this must follow the update above.
+    if (m_instanced)
+        UpdatePerInstanceBufferData();
+    else
+        UpdateHostVisibleDynamicBufferData();
 }
 
 // Render the scene.
 void VKHelloLighting::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -115,7 +155,7 @@ void VKHelloLighting::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKHelloLighting::OnDestroy()
@@ -125,25 +165,35 @@ void VKHelloLighting::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffer.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffer.IBmemory);
 
     // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
-        // Destroy dynamic buffer object and deallocate backing memory
-        vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        if (m_instanced)
+        {
+            // Destroy the per-instance vertex buffer and deallocate backing memory
+            vkDestroyBuffer(m_vulkanParams.Device, m_perInstanceBuffers[i].Handle, nullptr);
+            m_memAllocator.Free(m_perInstanceBuffers[i].Allocation);
+        }
+        else
+        {
+            // Destroy dynamic buffer object and deallocate backing memory
+            vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
+            m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
+        }
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -151,7 +201,7 @@ void VKHelloLighting::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
@@ -162,8 +212,8 @@ void VKHelloLighting::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.GraphicsPipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -174,30 +224,45 @@ void VKHelloLighting::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -206,8 +271,12 @@ void VKHelloLighting::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -317,15 +386,6 @@ void VKHelloLighting::CreateVertexBuffer()
     // This is not recommended as it can result in lower rendering performance.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -337,19 +397,10 @@ void VKHelloLighting::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.VBmemory));
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.VBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.VBmemory);
 
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, cubeVertices.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, m_vertexindexBuffer.VBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.VBmemory.MappedMemory, cubeVertices.data(), vertexBufferSize);
 
     // Create the index buffer object
     VkBufferCreateInfo indexBufferInfo = {};
@@ -358,16 +409,10 @@ void VKHelloLighting::CreateVertexBuffer()
     indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &indexBufferInfo, nullptr, &m_vertexindexBuffer.IBbuffer));
 
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.IBmemory));
-
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, indexBuffer.data(), indexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory);
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.IBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.IBmemory);
 
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, m_vertexindexBuffer.IBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.IBmemory.MappedMemory, indexBuffer.data(), indexBufferSize);
 }
 
 void VKHelloLighting::CreateHostVisibleBuffers()
@@ -388,15 +433,14 @@ void VKHelloLighting::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -416,7 +460,7 @@ void VKHelloLighting::CreateHostVisibleDynamicBuffers()
 	if (minUBOAlignment > 0)
 		m_dynamicUBOAlignment = (m_dynamicUBOAlignment + minUBOAlignment - 1) & ~(minUBOAlignment - 1);
     
-	size_t dynBufferSize = m_numDrawCalls * m_dynamicUBOAlignment;
+	size_t dynBufferSize = m_objectCount * m_dynamicUBOAlignment;
 
     dynUBufVS.meshInfo = (MeshInfo*)AlignedAlloc(dynBufferSize, m_dynamicUBOAlignment);
 	assert(dynUBufVS.meshInfo);
@@ -432,15 +476,14 @@ void VKHelloLighting::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -469,35 +512,60 @@ void VKHelloLighting::UpdateHostVisibleBufferData()
     memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[m_frameIndex].MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
-void VKHelloLighting::UpdateHostVisibleDynamicBufferData()
+void VKHelloLighting::CreateObjects()
 {
-    const float rotationSpeed = 0.8f;
+    m_objects.resize(m_objectCount - 2);
+
+    // The cube at the center of the scene rotates around the z-axis
+    m_objects[0].world = glm::identity<glm::mat4>();
+    m_objects[0].rotation = 1.0f;
+
+    // Any other lit cube is scattered around the first one.
+    // They rotate around the z-axis at an integer multiple of the rotation angle, so that their position doesn't 
+    // jump when the angle wraps around. The seed is fixed to get the same scene at every run.
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float rotations[] = { -2.0f, -1.0f, 1.0f, 2.0f };
+    for (size_t i = 1; i < m_objects.size(); i++)
+    {
+        float angle = unit(generator) * glm::two_pi<float>();
+        float distance = 7.0f + 53.0f * unit(generator);
+        float height = -15.0f + 30.0f * unit(generator);
+        float scale = 0.1f + 0.2f * unit(generator);
+
+        glm::mat4 Tran = glm::translate(glm::identity<glm::mat4>(), glm::vec3(distance * cosf(angle), distance * sinf(angle), height));
+        glm::mat4 Scale = glm::scale(glm::mat4(1.0f), glm::vec3(scale, scale, scale));
+        m_objects[i].world = Tran * Scale;
+        m_objects[i].rotation = rotations[generator() % 4];
+    }
+}
 
-    // Update the rotation angle
-    m_curRotationAngleRad += rotationSpeed * m_timer.GetElapsedSeconds();
-    if (m_curRotationAngleRad >= glm::two_pi<float>())
+void VKHelloLighting::GetMeshInfo(uint32_t objectIndex, MeshInfo& meshInfo)
+{
+    if (objectIndex < m_objects.size())
     {
-        m_curRotationAngleRad -= glm::two_pi<float>();
+        // Rotate the lit cube around the z-axis of the scene (see CreateObjects)
+        glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), m_objects[objectIndex].rotation * m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
+        meshInfo.worldMatrix = RotZ * m_objects[objectIndex].world;
+        meshInfo.solidColor = glm::vec4(1.0f); // Not used by the lambertian pipeline
     }
+    else
+    {
+        // Set light positions using the corresponding light directions.
+        size_t light = objectIndex - m_objects.size();
+        glm::mat4 Tran = glm::translate(glm::identity<glm::mat4>(), 5.0f * glm::vec3(uBufVS.lightDirs[light]));
+        glm::mat4 Scale = glm::scale(glm::mat4(1.0f), glm::vec3(0.2f, 0.2f, 0.2f));
+        meshInfo.worldMatrix = Tran * Scale;
+        meshInfo.solidColor = uBufVS.lightColors[light];
+    }
+}
 
-    for (size_t i = 0; i < m_numDrawCalls; i++)
+void VKHelloLighting::UpdateHostVisibleDynamicBufferData()
+{
+    for (uint32_t i = 0; i < m_objectCount; i++)
     {
         MeshInfo* mesh_info = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + (i * m_dynamicUBOAlignment));
-
-        if (!i)
-        {
-            // Rotate the cube at the center of the scene around the z-axis
-            glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
-            mesh_info->worldMatrix = RotZ;
-        }
-        else
-        {
-            // Set light positions using the corresponding light directions.
-            glm::mat4 Tran = glm::translate(glm::identity<glm::mat4>(), 5.0f * glm::vec3(uBufVS.lightDirs[i-1]));
-            glm::mat4 Scale = glm::scale(glm::mat4(1.0f), glm::vec3(0.2f, 0.2f, 0.2f));
-            mesh_info->worldMatrix = Tran * Scale;
-            mesh_info->solidColor = uBufVS.lightColors[i-1];
-        }
+        GetMeshInfo(i, *mesh_info);
     }
 
     // Update dynamic uniform buffer data
@@ -507,6 +575,41 @@ void VKHelloLighting::UpdateHostVisibleDynamicBufferData()
            m_sampleParams.FrameRes.HostVisibleDynamicBuffers[m_frameIndex].Size);
 }
 
+void VKHelloLighting::CreatePerInstanceBuffers()
+{
+    //
+    // Create the per-instance vertex buffers storing the mesh info of the cubes.
+    // They are updated from the CPU at every frame, so each frame in flight needs its own buffer 
+    // in host-visible device memory.
+    //
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_objectCount * sizeof(MeshInfo);
+    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+    m_perInstanceBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
+    {
+        CreateBuffer(m_memAllocator, 
+                     bufferInfo, 
+                     m_perInstanceBuffers[i],
+                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        m_perInstanceBuffers[i].Size = bufferInfo.size;
+    }
+}
+
+void VKHelloLighting::UpdatePerInstanceBufferData()
+{
+    // Write the mesh info directly to the per-instance vertex buffer of the current frame, with no padding between cubes.
+    // Note: Since we requested a host coherent memory type for the buffer, the writes are instantly visible to the GPU
+    MeshInfo* meshInfo = static_cast<MeshInfo*>(m_perInstanceBuffers[m_frameIndex].MappedMemory);
+
+    for (uint32_t i = 0; i < m_objectCount; i++)
+        GetMeshInfo(i, meshInfo[i]);
+}
+
 void VKHelloLighting::CreateDescriptorPool()
 {
     //
@@ -516,22 +619,23 @@ void VKHelloLighting::CreateDescriptorPool()
     //
 
     // Describe the number of descriptors per type.
-    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer)
+    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer).
+    // In instanced mode, the dynamic uniform buffer is replaced by a per-instance vertex buffer, which is not accessed through a descriptor.
     VkDescriptorPoolSize typeCounts[2];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
     VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
     descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptorPoolInfo.pNext = nullptr;
-    descriptorPoolInfo.poolSizeCount = 2;
+    descriptorPoolInfo.poolSizeCount = m_instanced ? 1 : 2;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -550,17 +654,17 @@ void VKHelloLighting::CreateDescriptorSetLayout()
     layoutBinding[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
     layoutBinding[0].pImmutableSamplers = nullptr;
 
-    // Binding 1: Dynamic uniform buffer (vertex and fragment shader)
+    // Binding 1: Dynamic uniform buffer (vertex shader; not used in instanced mode)
     layoutBinding[1].binding = 1;
     layoutBinding[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     layoutBinding[1].descriptorCount = 1;
-    layoutBinding[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    layoutBinding[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     layoutBinding[1].pImmutableSamplers = nullptr;
 
     VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
     descriptorLayout.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     descriptorLayout.pNext = nullptr;
-    descriptorLayout.bindingCount = 2;
+    descriptorLayout.bindingCount = m_instanced ? 1 : 2;
     descriptorLayout.pBindings = layoutBinding;
 
     VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_sampleParams.DescriptorSetLayout));
@@ -568,17 +672,17 @@ void VKHelloLighting::CreateDescriptorSetLayout()
 
 void VKHelloLighting::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -587,13 +691,13 @@ void VKHelloLighting::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[2] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -601,13 +705,13 @@ void VKHelloLighting::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
         writeDescriptorSet[1].dstBinding = 1;
 
-        vkUpdateDescriptorSets(m_vulkanParams.Device, 2, writeDescriptorSet, 0, nullptr);
+        vkUpdateDescriptorSets(m_vulkanParams.Device, m_instanced ? 1 : 2, writeDescriptorSet, 0, nullptr);
     }
 }
 
@@ -635,15 +739,20 @@ void VKHelloLighting::CreatePipelineObjects()
     //    
     // Vertex binding descriptions describe the input assembler binding points where vertex buffers will be bound.
     // This sample uses a single vertex buffer at binding point 0 (see vkCmdBindVertexBuffers).
-    VkVertexInputBindingDescription vertexInputBinding = {};
-    vertexInputBinding.binding = 0;
-    vertexInputBinding.stride = sizeof(Vertex);
-    vertexInputBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    // In instanced mode, a second vertex buffer at binding point 1 provides the mesh info: its input rate
+    // is per-instance, so the input assembler advances to the next cube for each instance rather than each vertex.
+    std::array<VkVertexInputBindingDescription, 2> vertexInputBindings;
+    vertexInputBindings[0].binding = 0;
+    vertexInputBindings[0].stride = sizeof(Vertex);
+    vertexInputBindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    vertexInputBindings[1].binding = 1;
+    vertexInputBindings[1].stride = sizeof(MeshInfo);
+    vertexInputBindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
     
     // Vertex attribute descriptions describe the vertex shader attribute locations and memory layouts, 
     // as well as the binding points from which the input assembler should retrieve data to pass to the 
     // corresponding vertex shader input attributes.
-    std::array<VkVertexInputAttributeDescription, 2> vertexInputAttributs;
+    std::array<VkVertexInputAttributeDescription, 7> vertexInputAttributs;
     // These match the following shader layout (see vertex shader):
     //	layout (location = 0) in vec3 inPos;
     //	layout (location = 1) in vec3 inNormal;
@@ -660,6 +769,22 @@ void VKHelloLighting::CreatePipelineObjects()
     // Normal attribute is three 32-bit signed (SFLOAT) floats (R32 G32 B32)
     vertexInputAttributs[1].format = VK_FORMAT_R32G32B32_SFLOAT;
     vertexInputAttributs[1].offset = offsetof(Vertex, normal);
+    // Attribute locations 2 to 5: World matrix from the per-instance vertex buffer at binding point 1 (instanced mode).
+    //	layout (location = 2) in mat4 inWorld;
+    // A mat4 input takes four consecutive locations, one for each column (four 32-bit floats).
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        vertexInputAttributs[2 + i].binding = 1;
+        vertexInputAttributs[2 + i].location = 2 + i;
+        vertexInputAttributs[2 + i].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+        vertexInputAttributs[2 + i].offset = offsetof(MeshInfo, worldMatrix) + i * sizeof(glm::vec4);
+    }
+    // Attribute location 6: Solid color from the per-instance vertex buffer at binding point 1 (instanced mode).
+    //	layout (location = 6) in vec4 inSolidColor;
+    vertexInputAttributs[6].binding = 1;
+    vertexInputAttributs[6].location = 6;
+    vertexInputAttributs[6].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    vertexInputAttributs[6].offset = offsetof(MeshInfo, solidColor);
     
     // Vertex input state used for pipeline creation.
     // The Vulkan specification uses it to specify the input of the entire pipeline, 
@@ -667,9 +792,9 @@ void VKHelloLighting::CreatePipelineObjects()
     // part of the input assembler state.
     VkPipelineVertexInputStateCreateInfo vertexInputState = {};
     vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputState.vertexBindingDescriptionCount = 1;
-    vertexInputState.pVertexBindingDescriptions = &vertexInputBinding;
-    vertexInputState.vertexAttributeDescriptionCount = 2;
+    vertexInputState.vertexBindingDescriptionCount = m_instanced ? 2 : 1;
+    vertexInputState.pVertexBindingDescriptions = vertexInputBindings.data();
+    vertexInputState.vertexAttributeDescriptionCount = m_instanced ? 7 : 2;
     vertexInputState.pVertexAttributeDescriptions = vertexInputAttributs.data();
     
     // Input assembly state describes how primitives are assembled by the input assembler.
@@ -761,8 +886,8 @@ void VKHelloLighting::CreatePipelineObjects()
     shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     // Set pipeline stage for this shader
     shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-    // Load binary SPIR-V shader module
-    shaderStages[0].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/main.vert.spv");
+    // Load binary SPIR-V shader module (in instanced mode, the mesh info is read from the per-instance vertex buffer)
+    shaderStages[0].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + (m_instanced ? "/data/shaders/instanced.vert.spv" : "/data/shaders/main.vert.spv"));
     // Main entry point for the shader
     shaderStages[0].pName = "main";
     assert(shaderStages[0].module != VK_NULL_HANDLE);
@@ -803,13 +928,13 @@ void VKHelloLighting::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline for lambertian illumination
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipelines["Lambertian"]));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineLambertian]));
 
     // Specify a different fragment shader
     vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[1].module, nullptr);
 	shaderStages[1].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/solid.frag.spv");
 	// Create a graphics pipeline to draw using a solid color
-	VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipelines["SolidColor"]));
+	VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineSolidColor]));
     
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -843,11 +968,11 @@ void VKHelloLighting::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -855,7 +980,7 @@ void VKHelloLighting::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -863,43 +988,71 @@ void VKHelloLighting::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
     
     // Bind the vertex buffer (contains positions and colors)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
 
     // Bind the index buffer
-	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
 
-    // Render multiple objects by using different pipelines and dynamically offsetting into a uniform buffer
-    for (uint32_t j = 0; j < m_numDrawCalls; j++)
-    {
-        // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
-        uint32_t dynamicOffset = j * static_cast<uint32_t>(m_dynamicUBOAlignment);
+    // The lit cubes are drawn with the lambertian pipeline, the two light sources with the solid color one
+    uint32_t litCubeCount = static_cast<uint32_t>(m_objects.size());
 
-        // Bind the graphics pipeline
-        vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            (!j) ? m_sampleParams.GraphicsPipelines["Lambertian"] : m_sampleParams.GraphicsPipelines["SolidColor"]);
+    if (m_instanced)
+    {
+        // Bind the per-instance vertex buffer (contains the mesh info of the current frame)
+        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 1, 1, &m_perInstanceBuffers[m_frameIndex].Handle, offsets);
 
-        // Bind descriptor sets for drawing a mesh using a dynamic offset
-        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+        // Bind the descriptor set once for all the cubes
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                                 VK_PIPELINE_BIND_POINT_GRAPHICS, 
                                 m_sampleParams.PipelineLayout, 
                                 0, 1, 
-                                &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                                1, &dynamicOffset);
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                                0, nullptr);
 
-        // Draw a cube
-        vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, 1, 0, 0, 0);
+        // Draw an instance of the cube for each lit cube...
+        vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_sampleParams.Pipelines[m_pipelineLambertian]);
+        vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, litCubeCount, 0, 0, 0);
+
+        // ...and for each light source, starting from the instance that follows the lit cubes in the per-instance vertex buffer
+        vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_sampleParams.Pipelines[m_pipelineSolidColor]);
+        vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, m_objectCount - litCubeCount, 0, 0, litCubeCount);
+    }
+    else
+    {
+        // Render multiple objects by using different pipelines and dynamically offsetting into a uniform buffer
+        for (uint32_t j = 0; j < m_objectCount; j++)
+        {
+            // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
+            uint32_t dynamicOffset = j * static_cast<uint32_t>(m_dynamicUBOAlignment);
+
+            // Bind the graphics pipeline (only when it changes)
+            if (j == 0 || j == litCubeCount)
+                vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                  (j < litCubeCount) ? m_sampleParams.Pipelines[m_pipelineLambertian] : m_sampleParams.Pipelines[m_pipelineSolidColor]);
+
+            // Bind descriptor sets for drawing a mesh using a dynamic offset
+            vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                    m_sampleParams.PipelineLayout, 
+                                    0, 1, 
+                                    &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                                    1, &dynamicOffset);
+
+            // Draw a cube
+            vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, 1, 0, 0, 0);
+        }
     }
     
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
     
-     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKHelloLighting::SubmitCommandBuffer()
@@ -912,13 +1065,13 @@ void VKHelloLighting::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKHelloLighting::PresentImage(uint32_t currentImageIndex)
@@ -933,13 +1086,13 @@ void VKHelloLighting::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -103,9 +103,9 @@ private:
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffer;
@@ -113,6 +113,11 @@ private:
     // In this sample we have three draw calls for each frame.
     const unsigned int m_numDrawCalls = 3;
 
+    // Handles of the named pipelines and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineLambertian;
+    TableHandle m_pipelineSolidColor;
+    TableHandle m_descSetGraphics;
+
     // Sample members
     float m_curRotationAngleRad;
     size_t m_dynamicUBOAlignment;
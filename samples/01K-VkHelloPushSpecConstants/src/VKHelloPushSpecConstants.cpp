@@ -1,7 +1,7 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKHelloPushSpecConstants.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/ext/scalar_constants.hpp"
@@ -11,6 +11,11 @@ VKSample(width, height, name),
 m_curRotationAngleRad(0.0f),
 m_dynamicUBOAlignment(0)
 {
+    // Register the named pipelines and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineLambertian = m_sampleParams.Pipelines.Register("Lambertian");
+    m_pipelineSolidColor = m_sampleParams.Pipelines.Register("SolidColor");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
+
     // Initialize the pointer to the memory region that will store the array of world matrices.
     m_dynUBufVS.meshInfo = nullptr;
 
@@ -68,7 +73,9 @@ void VKHelloPushSpecConstants::SetupPipeline()
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
 
     m_initialized = true;
 }
@@ -92,17 +99,15 @@ void VKHelloPushSpecConstants::OnUpdate()
 // Render the scene.
 void VKHelloPushSpecConstants::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -118,7 +123,7 @@ void VKHelloPushSpecConstants::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKHelloPushSpecConstants::OnDestroy()
@@ -128,25 +133,26 @@ void VKHelloPushSpecConstants::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffer.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffer.IBmemory);
 
     // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Destroy dynamic buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -154,7 +160,7 @@ void VKHelloPushSpecConstants::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
@@ -165,8 +171,8 @@ void VKHelloPushSpecConstants::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.GraphicsPipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -177,30 +183,45 @@ void VKHelloPushSpecConstants::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -209,8 +230,12 @@ void VKHelloPushSpecConstants::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -323,15 +348,6 @@ void VKHelloPushSpecConstants::CreateVertexBuffer()
     // This is not recommended as it can result in lower rendering performance.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -343,19 +359,10 @@ void VKHelloPushSpecConstants::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.VBmemory));
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.VBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.VBmemory);
 
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, cubeVertices.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, m_vertexindexBuffer.VBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.VBmemory.MappedMemory, cubeVertices.data(), vertexBufferSize);
 
     // Create the index buffer object
     VkBufferCreateInfo indexBufferInfo = {};
@@ -364,16 +371,10 @@ void VKHelloPushSpecConstants::CreateVertexBuffer()
     indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &indexBufferInfo, nullptr, &m_vertexindexBuffer.IBbuffer));
 
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.IBmemory));
-
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, indexBuffer.data(), indexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory);
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.IBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.IBmemory);
 
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, m_vertexindexBuffer.IBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.IBmemory.MappedMemory, indexBuffer.data(), indexBufferSize);
 }
 
 void VKHelloPushSpecConstants::CreateHostVisibleBuffers()
@@ -394,15 +395,14 @@ void VKHelloPushSpecConstants::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(m_uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -438,15 +438,14 @@ void VKHelloPushSpecConstants::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -465,7 +464,7 @@ void VKHelloPushSpecConstants::UpdateHostVisibleBufferData()
 {
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
         memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory, &m_uBufVS, sizeof(m_uBufVS));
 }
 
@@ -519,9 +518,9 @@ void VKHelloPushSpecConstants::CreateDescriptorPool()
     // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer)
     VkDescriptorPoolSize typeCounts[2];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
@@ -531,7 +530,7 @@ void VKHelloPushSpecConstants::CreateDescriptorPool()
     descriptorPoolInfo.poolSizeCount = 2;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -568,17 +567,17 @@ void VKHelloPushSpecConstants::CreateDescriptorSetLayout()
 
 void VKHelloPushSpecConstants::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -587,13 +586,13 @@ void VKHelloPushSpecConstants::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[2] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -601,7 +600,7 @@ void VKHelloPushSpecConstants::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
@@ -840,14 +839,14 @@ void VKHelloPushSpecConstants::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline for lambertian illumination
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipelines["Lambertian"]));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineLambertian]));
 
     // Specify a different fragment shader
     vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[1].module, nullptr);
 	shaderStages[1].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/solid.frag.spv");
     shaderStages[1].pSpecializationInfo = nullptr;
 	// Create a graphics pipeline to draw using a solid color
-	VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipelines["SolidColor"]));
+	VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineSolidColor]));
     
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -881,11 +880,11 @@ void VKHelloPushSpecConstants::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -893,7 +892,7 @@ void VKHelloPushSpecConstants::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -901,14 +900,14 @@ void VKHelloPushSpecConstants::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
     
     // Bind the vertex buffer (contains positions and colors)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
 
     // Bind the index buffer
-	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
 
     // Render multiple objects by using different pipelines and dynamically offsetting into a uniform buffer
     for (uint32_t j = 0; j < m_numDrawCalls; j++)
@@ -917,16 +916,16 @@ void VKHelloPushSpecConstants::PopulateCommandBuffer(uint32_t currentImageIndex)
         uint32_t dynamicOffset = j * static_cast<uint32_t>(m_dynamicUBOAlignment);
 
         // Bind the graphics pipeline
-        vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+        vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                             VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            (!j) ? m_sampleParams.GraphicsPipelines["Lambertian"] : m_sampleParams.GraphicsPipelines["SolidColor"]);
+                            (!j) ? m_sampleParams.Pipelines[m_pipelineLambertian] : m_sampleParams.Pipelines[m_pipelineSolidColor]);
 
         // Bind descriptor sets for drawing a mesh using a dynamic offset
-        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                                 VK_PIPELINE_BIND_POINT_GRAPHICS, 
                                 m_sampleParams.PipelineLayout, 
                                 0, 1, 
-                                &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
                                 1, &dynamicOffset);
 
         if (!j)
@@ -938,7 +937,7 @@ void VKHelloPushSpecConstants::PopulateCommandBuffer(uint32_t currentImageIndex)
             glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), -2.0f * m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
             m_pushConstants.lightDirs[1] = RotZ * m_pushConstants.lightDirs[1];
 
-            vkCmdPushConstants(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+            vkCmdPushConstants(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                                m_sampleParams.PipelineLayout, 
                                VK_SHADER_STAGE_FRAGMENT_BIT, 
                                0, sizeof(m_pushConstants), 
@@ -946,14 +945,14 @@ void VKHelloPushSpecConstants::PopulateCommandBuffer(uint32_t currentImageIndex)
         }
 
         // Draw a cube
-        vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, 1, 0, 0, 0);
+        vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, 1, 0, 0, 0);
     }
     
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
     
-    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKHelloPushSpecConstants::SubmitCommandBuffer()
@@ -966,13 +965,13 @@ void VKHelloPushSpecConstants::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKHelloPushSpecConstants::PresentImage(uint32_t currentImageIndex)
@@ -987,13 +986,13 @@ void VKHelloPushSpecConstants::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
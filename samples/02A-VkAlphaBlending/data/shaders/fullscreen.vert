@@ -0,0 +1,10 @@
+#version 450
+
+// Full-screen triangle, with no vertex buffer: the three vertices (gl_VertexIndex 0, 1 and 2) are at (-1, -1),
+// (3, -1) and (-1, 3) in clip space, so that the triangle covers the whole viewport.
+
+void main() 
+{
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 450
+
+// Weighted blended order-independent transparency (--oit weighted), composite pass.
+// The average color of the transparent fragments of the pixel (accumulated color divided by accumulated alpha) is
+// blended over the opaque color with SRC_ALPHA, ONE_MINUS_SRC_ALPHA, where the alpha is 1 - revealage: the opaque
+// color is weighted with the product of (1 - alpha) of the fragments in front of it.
+
+layout (input_attachment_index = 0, set = 1, binding = 0) uniform subpassInput accumInput;
+layout (input_attachment_index = 1, set = 1, binding = 1) uniform subpassInput revealInput;
+
+layout (location = 0) out vec4 outFragColor;
+
+void main() 
+{
+    float reveal = subpassLoad(revealInput).r;
+
+    // No transparent fragments on this pixel
+    if (reveal >= 1.0)
+        discard;
+
+    vec4 accum = subpassLoad(accumInput);
+
+    // Prevent overflows of the 16-bit float accumulation target from turning the color into infinity or NaN
+    if (isinf(max(max(abs(accum.r), abs(accum.g)), abs(accum.b))))
+        accum.rgb = vec3(accum.a);
+
+    outFragColor = vec4(accum.rgb / max(accum.a, 1e-5), 1.0 - reveal);
+}
@@ -0,0 +1,49 @@
+#version 450
+
+// Per-pixel linked lists (--oit linked), build pass.
+// Each transparent fragment gets a node from the node buffer through an atomic counter, and is inserted at the head
+// of the list of its pixel, whose index is stored in the head image. Nothing is written to the color attachment:
+// the lists are sorted and blended by oitResolve.frag.
+
+// Occluded fragments are discarded by the depth test before they are stored
+layout (early_fragment_tests) in;
+
+layout(std140, set = 0, binding = 0) uniform buf {
+    mat4 View;
+    mat4 Projection;
+} uBuf;
+
+layout(std140, set = 0, binding = 1) uniform dynbuf {
+    mat4 World;
+    vec4 solidColor;
+} dynBuf;
+
+// Index of the first node of the list of each pixel (0xffffffff for an empty list)
+layout(set = 1, binding = 0, r32ui) uniform coherent uimage2D headImage;
+
+struct Node {
+    uint color;     // RGBA8 (packUnorm4x8)
+    float depth;
+    uint next;      // Index of the next node in the list, or 0xffffffff
+};
+
+layout(std430, set = 1, binding = 1) buffer Nodes {
+    Node nodes[];
+};
+
+// Number of nodes allocated in the frame (it can exceed the length of the node buffer: see the overflow check below)
+layout(std430, set = 1, binding = 2) buffer Counter {
+    uint nodeCount;
+};
+
+void main() 
+{
+    uint index = atomicAdd(nodeCount, 1);
+
+    // Fragments that don't fit in the node buffer are dropped
+    if (index >= uint(nodes.length()))
+        return;
+
+    uint next = imageAtomicExchange(headImage, ivec2(gl_FragCoord.xy), index);
+    nodes[index] = Node(packUnorm4x8(dynBuf.solidColor), gl_FragCoord.z, next);
+}
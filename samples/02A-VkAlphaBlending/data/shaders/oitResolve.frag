@@ -0,0 +1,69 @@
+#version 450
+
+// Per-pixel linked lists (--oit linked), resolve pass.
+// The nodes of the list of the pixel are sorted by depth and blended front to back. The result (premultiplied
+// color, and 1 - transmittance in alpha) is blended over the opaque color with ONE, ONE_MINUS_SRC_ALPHA.
+
+// Fragments sorted for each pixel: if the list is longer, the farthest fragments are dropped. Behind MAX_FRAGMENTS
+// transparent layers the opaque color, and the dropped fragments, are almost completely hidden.
+#define MAX_FRAGMENTS 32
+
+layout(set = 1, binding = 0, r32ui) uniform readonly uimage2D headImage;
+
+struct Node {
+    uint color;     // RGBA8 (packUnorm4x8)
+    float depth;
+    uint next;      // Index of the next node in the list, or 0xffffffff
+};
+
+layout(std430, set = 1, binding = 1) readonly buffer Nodes {
+    Node nodes[];
+};
+
+layout (location = 0) out vec4 outFragColor;
+
+void main() 
+{
+    uint index = imageLoad(headImage, ivec2(gl_FragCoord.xy)).r;
+
+    // No transparent fragments on this pixel
+    if (index == 0xffffffff)
+        discard;
+
+    // Insertion sort of the nodes by increasing depth, keeping the nearest MAX_FRAGMENTS ones
+    uint colors[MAX_FRAGMENTS];
+    float depths[MAX_FRAGMENTS];
+    int count = 0;
+
+    while (index != 0xffffffff)
+    {
+        Node node = nodes[index];
+        index = node.next;
+
+        if (count == MAX_FRAGMENTS && node.depth >= depths[MAX_FRAGMENTS - 1])
+            continue;
+
+        int i = min(count, MAX_FRAGMENTS - 1);
+        while (i > 0 && depths[i - 1] > node.depth)
+        {
+            colors[i] = colors[i - 1];
+            depths[i] = depths[i - 1];
+            i--;
+        }
+        colors[i] = node.color;
+        depths[i] = node.depth;
+        count = min(count + 1, MAX_FRAGMENTS);
+    }
+
+    // Front-to-back blending
+    vec3 color = vec3(0.0);
+    float transmittance = 1.0;
+    for (int i = 0; i < count; i++)
+    {
+        vec4 fragment = unpackUnorm4x8(colors[i]);
+        color += transmittance * fragment.a * fragment.rgb;
+        transmittance *= 1.0 - fragment.a;
+    }
+
+    outFragColor = vec4(color, 1.0 - transmittance);
+}
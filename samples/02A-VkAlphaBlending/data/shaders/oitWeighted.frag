@@ -0,0 +1,33 @@
+#version 450
+
+// Weighted blended order-independent transparency (--oit weighted), accumulation pass.
+// Each transparent fragment adds its premultiplied color, scaled by a weight that decreases with the distance from
+// the camera, to the accumulation target, and multiplies the revealage target by (1 - alpha). Both operations are
+// commutative, so the quads can be drawn in any order (see oitComposite.frag for the final color).
+
+layout (location = 0) out vec4 outAccum;     // Blended with ONE, ONE
+layout (location = 1) out float outReveal;   // Blended with ZERO, ONE_MINUS_SRC_COLOR
+
+layout(std140, set = 0, binding = 0) uniform buf {
+    mat4 View;
+    mat4 Projection;
+} uBuf;
+
+layout(std140, set = 0, binding = 1) uniform dynbuf {
+    mat4 World;
+    vec4 solidColor;
+} dynBuf;
+
+void main() 
+{
+    vec4 color = dynBuf.solidColor;
+
+    // View-space depth of the fragment, from the depth in the framebuffer (z_ndc = P[2][2] + P[3][2] / z_view)
+    float viewZ = uBuf.Projection[3][2] / (gl_FragCoord.z - uBuf.Projection[2][2]);
+
+    // Weight function (eq. 9 of "Weighted Blended Order-Independent Transparency", McGuire and Bavoil)
+    float weight = color.a * clamp(10.0 / (1e-5 + pow(viewZ / 5.0, 2.0) + pow(viewZ / 200.0, 6.0)), 1e-2, 3e3);
+
+    outAccum = vec4(color.rgb * color.a, color.a) * weight;
+    outReveal = color.a;
+}
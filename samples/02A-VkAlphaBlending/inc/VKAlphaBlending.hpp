@@ -6,6 +6,9 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "glm/glm.hpp"
 
+// Average number of nodes per pixel in the node buffer of the per-pixel linked lists (--oit-nodes N)
+#define DEFAULT_OIT_NODES_PER_PIXEL 8
+
 class VKAlphaBlending : public VKSample
 {
 public:
@@ -19,10 +22,16 @@ public:
 
     virtual void OnResize();
 
+    virtual void EnableFeatures(VkPhysicalDeviceFeatures& features);
+
 private:
     
     void InitVulkan();
     void SetupPipeline();
+
+    // The render pass and the framebuffers include the subpasses and attachments of the OIT mode
+    virtual void CreateRenderPass();
+    virtual void CreateFrameBuffers();
     
     void PopulateCommandBuffer(uint32_t currentImageIndex);
     void SubmitCommandBuffer();
@@ -81,15 +90,75 @@ private:
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffer;
 
-    // In this sample we have three draw calls for each frame.
-    const unsigned int m_numDrawCalls = 3;
+    // In this sample we have a draw call for the cube, plus one for each quad.
+    uint32_t m_numDrawCalls;
+
+    // Handles of the named pipelines and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineOpaque;
+    TableHandle m_pipelineTransparent;
+    TableHandle m_pipelineComposite;
+    TableHandle m_descSetGraphics;
+
+    // Transparent quads
+    struct QuadInfo {
+        glm::vec3 position;
+        float size;
+        glm::vec4 color;
+    };
+
+    void GenerateQuads();
+    void SortQuads();                       // Sort the quads back to front (OIT_SORTED)
+
+    std::vector<QuadInfo> m_quads;
+    bool m_quadField;                       // Quads generated with --quads N, rotating around the cube
+    std::vector<uint32_t> m_drawOrder;      // Order in which the quads are drawn
+    std::vector<float> m_quadDepths;        // View-space depth of the center of each quad
+
+    // Order-independent transparency (--oit sorted|weighted|linked)
+    enum OITMode {
+        OIT_SORTED,         // The quads are sorted back to front on the CPU, and blended over the opaque color
+        OIT_WEIGHTED,       // Weighted blended OIT: accumulation and revealage targets, plus a composite pass
+        OIT_LINKED_LISTS    // Per-pixel linked lists of fragments, sorted and blended by a resolve pass
+    };
+
+    void CreateOITResources();              // Create the attachments or buffers that depend on the size of the framebuffer
+    void DestroyOITResources();
+    void CreateNodeCounterBuffers();        // Create the counter of the nodes of the linked lists, and its readback buffers
+    void WriteOITDescriptorSet();           // Write the descriptors of the OIT resources
+    void ReadNodeCount(uint32_t frameIndex);
+
+    OITMode m_oitMode;
+
+    // Descriptor set (set = 1) with the OIT resources read or written by the transparent and composite passes.
+    // There's a single set, since the resources are shared by the frames in flight (as the depth-stencil image).
+    VkDescriptorSetLayout m_oitDescriptorSetLayout;
+    VkDescriptorSet m_oitDescriptorSet;
+
+    // Weighted blended OIT
+    ImageParameters m_accumImage;           // Sum of the weighted, premultiplied colors (RGBA16F)
+    ImageParameters m_revealImage;          // Product of (1 - alpha) (R16F)
+
+    // Per-pixel linked lists
+    static const uint32_t s_nodeSize = 12;  // Size of a node (see the Node structure in oitLinkedList.frag)
+    ImageParameters m_headImage;            // Index of the first node of each pixel (R32_UINT)
+    BufferParameters m_nodeBuffer;
+    BufferParameters m_nodeCounterBuffer;
+    uint32_t m_nodesPerPixel;
+    uint32_t m_nodeCapacity;
+
+    // The number of nodes allocated in a frame is copied to a host-visible buffer, and read only when the fence of
+    // the frame is signaled, to report whether the node buffer overflowed.
+    std::vector<BufferParameters> m_nodeCountReadback;
+    std::vector<bool> m_nodeCountPending;
+    uint32_t m_nodeCountMax;
+    uint64_t m_overflowFrames;
 
     // Sample members
     float m_curRotationAngleRad;
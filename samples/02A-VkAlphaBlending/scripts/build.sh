@@ -7,20 +7,30 @@ else
     VULKAN_INCLUDE=../../external/include/vulkan/
 fi
 
-includes="-Iinc -I../../external/include/ -I$VULKAN_INCLUDE"
+includes="-Iinc -I../../framework/inc -I../../external/include/ -I$VULKAN_INCLUDE"
 
 defines="-DDEBUG -DVK_USE_PLATFORM_XLIB_KHR"
 
-links="-lX11 -lvulkan"
+links="-L../../framework/lib -lvkframework -lX11 -lvulkan -lpthread"
 
 echo Compiling shader...
 
 /../../bin/glslangValidator -V -g ./data/shaders/main.vert -o ./data/shaders/main.vert.spv
 /../../bin/glslangValidator -V -g ./data/shaders/solid.frag -o ./data/shaders/solid.frag.spv
 /../../bin/glslangValidator -V -g ./data/shaders/interpolated.frag -o ./data/shaders/interpolated.frag.spv
+/../../bin/glslangValidator -V -g ./data/shaders/fullscreen.vert -o ./data/shaders/fullscreen.vert.spv
+/../../bin/glslangValidator -V -g ./data/shaders/oitWeighted.frag -o ./data/shaders/oitWeighted.frag.spv
+/../../bin/glslangValidator -V -g ./data/shaders/oitComposite.frag -o ./data/shaders/oitComposite.frag.spv
+/../../bin/glslangValidator -V -g ./data/shaders/oitLinkedList.frag -o ./data/shaders/oitLinkedList.frag.spv
+/../../bin/glslangValidator -V -g ./data/shaders/oitResolve.frag -o ./data/shaders/oitResolve.frag.spv
+
+if [ "$SKIP_FRAMEWORK" != "1" ]; then
+    (cd ../../framework && bash scripts/build.sh) || exit 1
+fi
 
 echo Building project...
 
-g++ -g src/*.cpp -o 02A-VkAlphaBlending.out $includes $defines $links
+source ../../scripts/compile.sh
 
-rm -f *.o
\ No newline at end of file
+compile_sources obj "$includes $defines" src/*.cpp || exit 1
+link_executable 02A-VkAlphaBlending.out ../../framework/lib/libvkframework.a "$links" $OBJECTS || exit 1
\ No newline at end of file
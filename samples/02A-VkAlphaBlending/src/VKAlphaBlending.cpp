@@ -1,7 +1,7 @@
 #include "stdafx.h"
 #include "VKApplication.hpp"
 #include "VKAlphaBlending.hpp"
-#include "VKDebug.h"
+#include "VKDebug.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/ext/scalar_constants.hpp"
@@ -9,8 +9,28 @@
 VKAlphaBlending::VKAlphaBlending(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
 m_curRotationAngleRad(0.0f),
-m_dynamicUBOAlignment(0)
+m_dynamicUBOAlignment(0),
+m_numDrawCalls(0),
+m_quadField(false),
+m_oitMode(OIT_SORTED),
+m_oitDescriptorSetLayout(VK_NULL_HANDLE),
+m_oitDescriptorSet(VK_NULL_HANDLE),
+m_nodesPerPixel(DEFAULT_OIT_NODES_PER_PIXEL),
+m_nodeCapacity(0),
+m_nodeCountMax(0),
+m_overflowFrames(0)
 {
+    // Register the named pipelines and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineOpaque = m_sampleParams.Pipelines.Register("Opaque");
+    m_pipelineTransparent = m_sampleParams.Pipelines.Register("Transparent");
+    m_pipelineComposite = m_sampleParams.Pipelines.Register("Composite");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
+
+    // Formats of the OIT resources (color attachments and storage images in these formats are supported by all devices)
+    m_accumImage.Format = VK_FORMAT_R16G16B16A16_SFLOAT;
+    m_revealImage.Format = VK_FORMAT_R16_SFLOAT;
+    m_headImage.Format = VK_FORMAT_R32_UINT;
+
     // Initialize the pointer to the memory region that will store the array of world matrices.
     dynUBufVS.meshInfo = nullptr;
 
@@ -32,9 +52,44 @@ VKAlphaBlending::~VKAlphaBlending()
 
 void VKAlphaBlending::OnInit()
 {
+    // --oit selects how the transparent quads are blended (sorted, weighted or linked): sorted back to front on the
+    // CPU with standard alpha blending (as in the tutorial), with weighted blended OIT, or with per-pixel linked lists
+    // sorted on the GPU. --quads N replaces the two quads of the tutorial with N quads rotating around the cube, and
+    // --oit-nodes N sets the average number of fragments per pixel the linked lists can store.
+    uint32_t quadCount = 0;
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--oit") == 0 && i + 1 < args.size())
+        {
+            const char* mode = args[++i];
+            if (strcmp(mode, "sorted") == 0)
+                m_oitMode = OIT_SORTED;
+            else if (strcmp(mode, "weighted") == 0)
+                m_oitMode = OIT_WEIGHTED;
+            else if (strcmp(mode, "linked") == 0)
+                m_oitMode = OIT_LINKED_LISTS;
+            else
+                printf("Unknown OIT mode: %s (available modes: sorted, weighted, linked)\n", mode);
+        }
+        else if (strcmp(args[i], "--quads") == 0 && i + 1 < args.size())
+        {
+            m_quadField = true;
+            quadCount = std::max(1u, static_cast<uint32_t>(strtoul(args[++i], nullptr, 10)));
+        }
+        else if (strcmp(args[i], "--oit-nodes") == 0 && i + 1 < args.size())
+            m_nodesPerPixel = std::max(1u, static_cast<uint32_t>(strtoul(args[++i], nullptr, 10)));
+    }
+
+    m_quads.resize(m_quadField ? quadCount : 2);
+    GenerateQuads();
+
     InitVulkan();
     SetupPipeline();
 
+    const char* modeNames[] = { "sorted alpha blending", "weighted blended OIT", "per-pixel linked lists" };
+    printf("Transparency: %s, %u quads\n", modeNames[m_oitMode], static_cast<uint32_t>(m_quads.size()));
+
     // Update buffer data (view and projection matrices)
     UpdateHostVisibleBufferData();
 }
@@ -53,20 +108,251 @@ void VKAlphaBlending::InitVulkan()
     CreateSynchronizationObjects();
 }
 
+void VKAlphaBlending::CreateRenderPass()
+{
+    // Sorted alpha blending draws everything in a single subpass, as in the tutorial
+    if (m_oitMode == OIT_SORTED)
+    {
+        VKSample::CreateRenderPass();
+        return;
+    }
+
+    // OIT modes use three subpasses:
+    // 0. the opaque objects are drawn to the color and depth attachments;
+    // 1. the transparent quads are drawn with the depth test (but no depth writes), to the accumulation and revealage
+    //    attachments (weighted) or to the linked lists (linked);
+    // 2. a full-screen triangle blends the transparent fragments of each pixel over the color attachment.
+    std::vector<VkAttachmentDescription> attachments(m_oitMode == OIT_WEIGHTED ? 4 : 2);
+
+    // Color attachment
+    attachments[0].format = m_vulkanParams.SwapChain.Format;
+    attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[0].finalLayout = VKApplication::settings.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    // Depth-stencil attachment
+    attachments[1].format = m_vulkanParams.DepthStencilImage.Format;
+    attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+    attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+    // Accumulation and revealage attachments (weighted blended OIT only): they are cleared at the start of the
+    // render pass (to 0 and 1), and only read as input attachments by the composite subpass, so they don't need to be stored.
+    if (m_oitMode == OIT_WEIGHTED)
+    {
+        attachments[2].format = m_accumImage.Format;
+        attachments[2].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[2].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[2].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[2].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[2].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[2].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[2].finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        attachments[3] = attachments[2];
+        attachments[3].format = m_revealImage.Format;
+    }
+
+    VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    VkAttachmentReference depthReference = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+    VkAttachmentReference oitColorReferences[2] = { 
+        { 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL }, 
+        { 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL } 
+    };
+    VkAttachmentReference oitInputReferences[2] = { 
+        { 2, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }, 
+        { 3, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL } 
+    };
+    uint32_t preservedAttachment = 0;
+
+    std::array<VkSubpassDescription, 3> subpasses = {};
+
+    // Opaque subpass
+    subpasses[0].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[0].colorAttachmentCount = 1;
+    subpasses[0].pColorAttachments = &colorReference;
+    subpasses[0].pDepthStencilAttachment = &depthReference;
+
+    // Transparent subpass: the color attachment is not used, but its contents must be preserved for the composite subpass
+    subpasses[1].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[1].colorAttachmentCount = (m_oitMode == OIT_WEIGHTED) ? 2 : 0;
+    subpasses[1].pColorAttachments = (m_oitMode == OIT_WEIGHTED) ? oitColorReferences : nullptr;
+    subpasses[1].pDepthStencilAttachment = &depthReference;
+    subpasses[1].preserveAttachmentCount = 1;
+    subpasses[1].pPreserveAttachments = &preservedAttachment;
+
+    // Composite subpass
+    subpasses[2].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[2].colorAttachmentCount = 1;
+    subpasses[2].pColorAttachments = &colorReference;
+    subpasses[2].inputAttachmentCount = (m_oitMode == OIT_WEIGHTED) ? 2 : 0;
+    subpasses[2].pInputAttachments = (m_oitMode == OIT_WEIGHTED) ? oitInputReferences : nullptr;
+
+    std::vector<VkSubpassDependency> dependencies(5);
+
+    // Layout transitions of the color and depth-stencil attachments at the start of the render pass (as in VKSample::CreateRenderPass)
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].dstSubpass = 0;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[0].srcAccessMask = VK_ACCESS_NONE;
+    dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT;
+
+    dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].dstSubpass = 0;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    // The transparent quads are depth tested against the depth of the opaque objects
+    dependencies[2].srcSubpass = 0;
+    dependencies[2].dstSubpass = 1;
+    dependencies[2].srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[2].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[2].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[2].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+    dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    // The composite subpass blends over the opaque color
+    dependencies[3].srcSubpass = 0;
+    dependencies[3].dstSubpass = 2;
+    dependencies[3].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[3].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[3].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[3].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependencies[3].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+    // The composite subpass reads what the transparent subpass wrote: the accumulation and revealage attachments
+    // (read as input attachments at the same pixel, so the dependency is by region), or the linked lists.
+    dependencies[4].srcSubpass = 1;
+    dependencies[4].dstSubpass = 2;
+    if (m_oitMode == OIT_WEIGHTED)
+    {
+        dependencies[4].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[4].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[4].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies[4].dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+        dependencies[4].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+        // The accumulation and revealage attachments are cleared while the previous frame may still read them
+        VkSubpassDependency dependency = {};
+        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependency.dstSubpass = 1;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependency.srcAccessMask = VK_ACCESS_NONE;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        dependencies.push_back(dependency);
+    }
+    else
+    {
+        dependencies[4].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[4].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        dependencies[4].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        dependencies[4].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    }
+
+    VkRenderPassCreateInfo renderPassInfo = {};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+    renderPassInfo.pAttachments = attachments.data();
+    renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+    renderPassInfo.pSubpasses = subpasses.data();
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    renderPassInfo.pDependencies = dependencies.data();
+
+    VK_CHECK_RESULT(vkCreateRenderPass(m_vulkanParams.Device, &renderPassInfo, nullptr, &m_sampleParams.RenderPass));
+}
+
+void VKAlphaBlending::CreateFrameBuffers()
+{
+    // The OIT resources have the size of the framebuffers, so they are created (again) with them
+    CreateOITResources();
+
+    if (m_oitMode != OIT_WEIGHTED)
+    {
+        VKSample::CreateFrameBuffers();
+        return;
+    }
+
+    // Depth-stencil, accumulation and revealage attachments are the same for each framebuffer
+    VkImageView attachments[4] = {};
+    attachments[1] = m_vulkanParams.DepthStencilImage.View;
+    attachments[2] = m_accumImage.View;
+    attachments[3] = m_revealImage.View;
+
+    VkFramebufferCreateInfo frameBufferCreateInfo = {};
+    frameBufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    frameBufferCreateInfo.renderPass = m_sampleParams.RenderPass;
+    frameBufferCreateInfo.attachmentCount = 4;
+    frameBufferCreateInfo.pAttachments = attachments;
+    frameBufferCreateInfo.width = m_width;
+    frameBufferCreateInfo.height = m_height;
+    frameBufferCreateInfo.layers = 1;
+
+    // Create a framebuffer for each swapchain image view
+    m_sampleParams.Framebuffers.resize(m_vulkanParams.SwapChain.Images.size());
+    for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++)
+    {
+        attachments[0] = m_vulkanParams.SwapChain.Images[i].View;
+        VK_CHECK_RESULT(vkCreateFramebuffer(m_vulkanParams.Device, &frameBufferCreateInfo, nullptr, &m_sampleParams.Framebuffers[i]));
+    }
+}
+
 void VKAlphaBlending::SetupPipeline()
 {
     CreateVertexBuffer();
     CreateHostVisibleBuffers();
     CreateHostVisibleDynamicBuffers();
+    if (m_oitMode == OIT_LINKED_LISTS)
+        CreateNodeCounterBuffers();
     CreateDescriptorPool();
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
 
     m_initialized = true;
 }
 
+void VKAlphaBlending::EnableFeatures(VkPhysicalDeviceFeatures& features)
+{
+    // Weighted blended OIT blends its two targets with different blend states
+    if (m_oitMode == OIT_WEIGHTED)
+    {
+        if (m_deviceFeatures.independentBlend)
+            features.independentBlend = VK_TRUE;
+        else
+        {
+            printf("independentBlend is not supported: the quads are sorted instead of using weighted blended OIT.\n");
+            m_oitMode = OIT_SORTED;
+        }
+    }
+
+    // The linked lists are built by the fragment shader with atomic operations on a storage image and buffers
+    if (m_oitMode == OIT_LINKED_LISTS)
+    {
+        if (m_deviceFeatures.fragmentStoresAndAtomics)
+            features.fragmentStoresAndAtomics = VK_TRUE;
+        else
+        {
+            printf("fragmentStoresAndAtomics is not supported: the quads are sorted instead of using linked lists.\n");
+            m_oitMode = OIT_SORTED;
+        }
+    }
+}
+
 // Update frame-based values.
 void VKAlphaBlending::OnUpdate()
 {
@@ -83,17 +369,19 @@ void VKAlphaBlending::OnUpdate()
 // Render the scene.
 void VKAlphaBlending::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
+    // The frame that last used this command buffer is done: read the number of nodes it allocated
+    if (m_oitMode == OIT_LINKED_LISTS)
+        ReadNodeCount(m_frameIndex);
+
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -109,7 +397,7 @@ void VKAlphaBlending::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKAlphaBlending::OnDestroy()
@@ -119,25 +407,46 @@ void VKAlphaBlending::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffer.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffer.IBmemory);
 
-    // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    // Report whether the node buffer of the linked lists was large enough for the frames whose counts have been read back
+    if (m_oitMode == OIT_LINKED_LISTS)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
+        for (uint32_t i = 0; i < m_framesInFlight; i++)
+            ReadNodeCount(i);
+        printf("Linked lists: up to %u fragments in a frame, storage for %u (%llu frames overflowed)\n", 
+               m_nodeCountMax, m_nodeCapacity, static_cast<unsigned long long>(m_overflowFrames));
+
+        vkDestroyBuffer(m_vulkanParams.Device, m_nodeCounterBuffer.Handle, nullptr);
+        m_memAllocator.Free(m_nodeCounterBuffer.Allocation);
+        for (BufferParameters& readback : m_nodeCountReadback)
+        {
+            vkDestroyBuffer(m_vulkanParams.Device, readback.Handle, nullptr);
+            m_memAllocator.Free(readback.Allocation);
+        }
+    }
 
+    // Destroy the attachments and buffers of the OIT mode
+    DestroyOITResources();
+
+    // Destroy\Unmap frame resources
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
+    {
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Destroy dynamic buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -145,19 +454,21 @@ void VKAlphaBlending::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
     vkDestroyDescriptorPool(m_vulkanParams.Device, m_sampleParams.DescriptorPool, nullptr);
 
-    // Destroy descriptor set layout
+    // Destroy descriptor set layouts
     vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_sampleParams.DescriptorSetLayout, nullptr);
+    if (m_oitDescriptorSetLayout != VK_NULL_HANDLE)
+        vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_oitDescriptorSetLayout, nullptr);
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.GraphicsPipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -168,30 +479,45 @@ void VKAlphaBlending::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -200,8 +526,12 @@ void VKAlphaBlending::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -214,6 +544,55 @@ void VKAlphaBlending::OnResize()
     uBufVS.projectionMatrix = glm::perspectiveLH(glm::quarter_pi<float>(), (float)m_width/m_height, 0.01f, 100.0f);
 
     UpdateHostVisibleBufferData();
+
+    // The OIT resources have been created again with the framebuffers (see CreateFrameBuffers)
+    if (m_oitDescriptorSet != VK_NULL_HANDLE)
+        WriteOITDescriptorSet();
+}
+
+void VKAlphaBlending::GenerateQuads()
+{
+    m_numDrawCalls = 1 + static_cast<uint32_t>(m_quads.size());
+    m_drawOrder.resize(m_quads.size());
+    m_quadDepths.resize(m_quads.size());
+    for (uint32_t i = 0; i < m_quads.size(); i++)
+        m_drawOrder[i] = i;
+
+    if (!m_quadField)
+    {
+        // The quads of the tutorial, placed in decreasing distance from the camera.
+        // Set the second component of the positions to (-5.0f + i * 2) to define the quads in reverse order
+        // (they are still drawn back to front, unless they are blended with an OIT mode).
+        for (uint32_t i = 0; i < m_quads.size(); i++)
+        {
+            m_quads[i].position = glm::vec3(-1.0f + i * 2, -3.0f - i * 2, 1.0f);
+            m_quads[i].size = 1.5f;
+            m_quads[i].color = i ? glm::vec4(1.0f, 1.0f, 1.0f, 0.3f) : glm::vec4(1.0f, 0.0f, 0.0f, 0.4f);
+        }
+        return;
+    }
+
+    // Small quads with random positions, colors and opacities around the cube, overlapping each other
+    for (QuadInfo& quad : m_quads)
+    {
+        quad.position = glm::vec3((rand() % 1000) / 100.0f - 5.0f, (rand() % 1000) / 100.0f - 5.0f, (rand() % 600) / 100.0f - 2.0f);
+        quad.size = 0.5f;
+        quad.color = glm::vec4(0.2f + (rand() % 80) / 100.0f, 0.2f + (rand() % 80) / 100.0f, 0.2f + (rand() % 80) / 100.0f, 0.2f + (rand() % 40) / 100.0f);
+    }
+}
+
+void VKAlphaBlending::SortQuads()
+{
+    // Sort the quads by decreasing view-space depth of their centers: the translation of the world matrix is the
+    // center of the quad, and the Z axis of the view space points forward (left-handed).
+    for (uint32_t i = 0; i < m_quads.size(); i++)
+    {
+        MeshInfo* mesh_info = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + ((i + 1) * m_dynamicUBOAlignment));
+        m_quadDepths[i] = (uBufVS.viewMatrix * mesh_info->worldMatrix[3]).z;
+    }
+
+    std::sort(m_drawOrder.begin(), m_drawOrder.end(), 
+              [this](uint32_t a, uint32_t b) { return m_quadDepths[a] > m_quadDepths[b]; });
 }
 
 // Create vertex and index buffers describing a cube
@@ -286,15 +665,6 @@ void VKAlphaBlending::CreateVertexBuffer()
     // This is not recommended as it can result in lower rendering performance.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -306,19 +676,10 @@ void VKAlphaBlending::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.VBmemory));
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.VBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.VBmemory);
 
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, cubeVertices.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, m_vertexindexBuffer.VBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.VBmemory.MappedMemory, cubeVertices.data(), vertexBufferSize);
 
     // Create the index buffer object
     VkBufferCreateInfo indexBufferInfo = {};
@@ -327,16 +688,10 @@ void VKAlphaBlending::CreateVertexBuffer()
     indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &indexBufferInfo, nullptr, &m_vertexindexBuffer.IBbuffer));
 
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.IBmemory));
-
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, indexBuffer.data(), indexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory);
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.IBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.IBmemory);
 
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, m_vertexindexBuffer.IBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.IBmemory.MappedMemory, indexBuffer.data(), indexBufferSize);
 }
 
 void VKAlphaBlending::CreateHostVisibleBuffers()
@@ -357,15 +712,14 @@ void VKAlphaBlending::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -401,15 +755,14 @@ void VKAlphaBlending::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -424,11 +777,126 @@ void VKAlphaBlending::CreateHostVisibleDynamicBuffers()
     }    
 }
 
+void VKAlphaBlending::CreateOITResources()
+{
+    // Destroy the previous resources, if any (for e.g. on window resize)
+    DestroyOITResources();
+
+    // Create a device-local image with the size of the framebuffer, and a view of it
+    auto createImage = [this](ImageParameters& image, VkImageUsageFlags usage)
+    {
+        VkImageCreateInfo imageCreateInfo = {};
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.format = image.Format;
+        imageCreateInfo.extent = { m_width, m_height, 1 };
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.usage = usage;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VK_CHECK_RESULT(vkCreateImage(m_vulkanParams.Device, &imageCreateInfo, nullptr, &image.Handle));
+
+        m_memAllocator.AllocateImageMemory(image.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image.Allocation);
+
+        VkImageViewCreateInfo viewInfo = {};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image.Handle;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = image.Format;
+        viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+        VK_CHECK_RESULT(vkCreateImageView(m_vulkanParams.Device, &viewInfo, nullptr, &image.View));
+    };
+
+    if (m_oitMode == OIT_WEIGHTED)
+    {
+        // Written as color attachments by the transparent subpass, and read as input attachments by the composite one
+        createImage(m_accumImage, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
+        createImage(m_revealImage, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT);
+    }
+    else if (m_oitMode == OIT_LINKED_LISTS)
+    {
+        // Storage image with the heads of the lists, cleared at the start of every frame
+        createImage(m_headImage, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+        // Node buffer, limited by the max size of the range of a storage buffer descriptor
+        uint64_t nodeCapacity = static_cast<uint64_t>(m_width) * m_height * m_nodesPerPixel;
+        uint64_t maxNodeCapacity = m_deviceProperties.limits.maxStorageBufferRange / s_nodeSize;
+        if (nodeCapacity > maxNodeCapacity)
+        {
+            printf("%llu nodes exceed maxStorageBufferRange: the node buffer is clamped to %llu nodes.\n", 
+                   static_cast<unsigned long long>(nodeCapacity), static_cast<unsigned long long>(maxNodeCapacity));
+            nodeCapacity = maxNodeCapacity;
+        }
+        m_nodeCapacity = static_cast<uint32_t>(nodeCapacity);
+
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = static_cast<VkDeviceSize>(m_nodeCapacity) * s_nodeSize;
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+        CreateBuffer(m_memAllocator, bufferInfo, m_nodeBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+}
+
+void VKAlphaBlending::DestroyOITResources()
+{
+    for (ImageParameters* image : { &m_accumImage, &m_revealImage, &m_headImage })
+    {
+        if (image->Handle == VK_NULL_HANDLE)
+            continue;
+
+        vkDestroyImageView(m_vulkanParams.Device, image->View, nullptr);
+        vkDestroyImage(m_vulkanParams.Device, image->Handle, nullptr);
+        m_memAllocator.Free(image->Allocation);
+        image->Handle = VK_NULL_HANDLE;
+        image->View = VK_NULL_HANDLE;
+    }
+
+    if (m_nodeBuffer.Handle != VK_NULL_HANDLE)
+    {
+        vkDestroyBuffer(m_vulkanParams.Device, m_nodeBuffer.Handle, nullptr);
+        m_memAllocator.Free(m_nodeBuffer.Allocation);
+        m_nodeBuffer.Handle = VK_NULL_HANDLE;
+    }
+}
+
+void VKAlphaBlending::CreateNodeCounterBuffers()
+{
+    // Counter of the nodes allocated by the fragment shader, reset at the start of every frame
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = sizeof(uint32_t);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    CreateBuffer(m_memAllocator, bufferInfo, m_nodeCounterBuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Host-visible copies of the counter written by each frame in flight
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    m_nodeCountReadback.resize(m_framesInFlight);
+    m_nodeCountPending.assign(m_framesInFlight, false);
+    for (size_t i = 0; i < m_framesInFlight; i++)
+        CreateBuffer(m_memAllocator, bufferInfo, m_nodeCountReadback[i], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+void VKAlphaBlending::ReadNodeCount(uint32_t frameIndex)
+{
+    if (!m_nodeCountPending[frameIndex])
+        return;
+
+    // The counter is incremented for every transparent fragment, including the ones that didn't fit in the node buffer
+    uint32_t nodeCount = *static_cast<const uint32_t*>(m_nodeCountReadback[frameIndex].MappedMemory);
+    m_nodeCountMax = std::max(m_nodeCountMax, nodeCount);
+    if (nodeCount > m_nodeCapacity)
+        m_overflowFrames++;
+
+    m_nodeCountPending[frameIndex] = false;
+}
+
 void VKAlphaBlending::UpdateHostVisibleBufferData()
 {
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
         memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
@@ -456,17 +924,27 @@ void VKAlphaBlending::UpdateHostVisibleDynamicBufferData()
         }
         else
         {
-            // Set quad positions, orientations and colors
-            // Quads are placed in decreasing distance from the camera.
-            // Set the second component of the vec3 passed to glm::translate to (-5.0f + (i-1) * 2) to draw quads in reverse order.
-            glm::mat4 Tran = glm::translate(glm::identity<glm::mat4>(), glm::vec3(-1.0f + (i-1) * 2, -3.0f - (i-1) * 2, 1.0f));
+            // Set quad positions, orientations and colors (see GenerateQuads)
+            const QuadInfo& quad = m_quads[i - 1];
+            glm::mat4 Tran = glm::translate(glm::identity<glm::mat4>(), quad.position);
             glm::mat4 RotX = glm::rotate(glm::mat4(1.0f), glm::half_pi<float>(), glm::vec3(1.0f, 0.0f, 0.0f));
-            glm::mat4 Scale = glm::scale(glm::mat4(1.0f), glm::vec3(1.5f, 1.5f, 1.5f));
+            glm::mat4 Scale = glm::scale(glm::mat4(1.0f), glm::vec3(quad.size, quad.size, quad.size));
             mesh_info->worldMatrix = Tran * RotX * Scale;
-            mesh_info->solidColor = (i-1) ? glm::vec4(1.0f, 1.0f, 1.0f, 0.3f) : glm::vec4(1.0f, 0.0f, 0.0f, 0.4f);
+            mesh_info->solidColor = quad.color;
+
+            // The quads generated with --quads N rotate around the cube with it, so their order changes every frame
+            if (m_quadField)
+            {
+                glm::mat4 RotZ = glm::rotate(glm::identity<glm::mat4>(), m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
+                mesh_info->worldMatrix = RotZ * mesh_info->worldMatrix;
+            }
         }
     }
 
+    // Standard alpha blending needs the quads to be drawn back to front
+    if (m_oitMode == OIT_SORTED)
+        SortQuads();
+
     // Update dynamic uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
     memcpy(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[m_frameIndex].MappedMemory,
@@ -483,22 +961,30 @@ void VKAlphaBlending::CreateDescriptorPool()
     //
 
     // Describe the number of descriptors per type.
-    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer)
-    VkDescriptorPoolSize typeCounts[2];
+    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer), plus the ones
+    // of the descriptor set used by the OIT subpasses (input attachments, or storage image and buffers).
+    std::vector<VkDescriptorPoolSize> typeCounts(2);
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
+    if (m_oitMode == OIT_WEIGHTED)
+        typeCounts.push_back({ VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 2 });
+    else if (m_oitMode == OIT_LINKED_LISTS)
+    {
+        typeCounts.push_back({ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1 });
+        typeCounts.push_back({ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 });
+    }
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
     VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
     descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptorPoolInfo.pNext = nullptr;
-    descriptorPoolInfo.poolSizeCount = 2;
-    descriptorPoolInfo.pPoolSizes = typeCounts;
+    descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(typeCounts.size());
+    descriptorPoolInfo.pPoolSizes = typeCounts.data();
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight) + (m_oitMode != OIT_SORTED ? 1 : 0);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -531,21 +1017,59 @@ void VKAlphaBlending::CreateDescriptorSetLayout()
     descriptorLayout.pBindings = layoutBinding;
 
     VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_sampleParams.DescriptorSetLayout));
+
+    if (m_oitMode == OIT_SORTED)
+        return;
+
+    //
+    // Descriptor set layout of the resources shared by the transparent and composite subpasses (set 1).
+    // Weighted blended OIT:
+    // Binding 0: Accumulation attachment (input attachment)
+    // Binding 1: Revealage attachment (input attachment)
+    // Linked lists:
+    // Binding 0: Heads of the lists (storage image)
+    // Binding 1: Nodes (storage buffer)
+    // Binding 2: Node counter (storage buffer)
+    //
+    VkDescriptorSetLayoutBinding oitBinding[3] = {};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        oitBinding[i].binding = i;
+        oitBinding[i].descriptorCount = 1;
+        oitBinding[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    }
+
+    if (m_oitMode == OIT_WEIGHTED)
+    {
+        oitBinding[0].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+        oitBinding[1].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+        descriptorLayout.bindingCount = 2;
+    }
+    else
+    {
+        oitBinding[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        oitBinding[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        oitBinding[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorLayout.bindingCount = 3;
+    }
+    descriptorLayout.pBindings = oitBinding;
+
+    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_oitDescriptorSetLayout));
 }
 
 void VKAlphaBlending::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -554,13 +1078,13 @@ void VKAlphaBlending::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[2] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -568,7 +1092,7 @@ void VKAlphaBlending::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
@@ -576,17 +1100,80 @@ void VKAlphaBlending::AllocateDescriptorSets()
 
         vkUpdateDescriptorSets(m_vulkanParams.Device, 2, writeDescriptorSet, 0, nullptr);
     }
+
+    // The OIT resources are not updated by the CPU, so a single descriptor set is shared by all the frames in flight
+    if (m_oitMode != OIT_SORTED)
+    {
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &m_oitDescriptorSetLayout;
+        VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, &m_oitDescriptorSet));
+
+        WriteOITDescriptorSet();
+    }
+}
+
+void VKAlphaBlending::WriteOITDescriptorSet()
+{
+    // Write the descriptors of the OIT resources (again, when they are created again on window resize)
+    VkWriteDescriptorSet writeDescriptorSet[3] = {};
+    VkDescriptorImageInfo imageInfo[2] = {};
+    VkDescriptorBufferInfo bufferInfo[2] = {};
+    uint32_t writeCount = 0;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        writeDescriptorSet[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writeDescriptorSet[i].dstSet = m_oitDescriptorSet;
+        writeDescriptorSet[i].dstBinding = i;
+        writeDescriptorSet[i].descriptorCount = 1;
+    }
+
+    if (m_oitMode == OIT_WEIGHTED)
+    {
+        // Input attachments are read in the layout they have during the composite subpass
+        imageInfo[0].imageView = m_accumImage.View;
+        imageInfo[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo[1].imageView = m_revealImage.View;
+        imageInfo[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            writeDescriptorSet[i].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            writeDescriptorSet[i].pImageInfo = &imageInfo[i];
+        }
+        writeCount = 2;
+    }
+    else
+    {
+        // Storage images are accessed in the general layout
+        imageInfo[0].imageView = m_headImage.View;
+        imageInfo[0].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writeDescriptorSet[0].pImageInfo = &imageInfo[0];
+
+        bufferInfo[0] = { m_nodeBuffer.Handle, 0, VK_WHOLE_SIZE };
+        bufferInfo[1] = { m_nodeCounterBuffer.Handle, 0, sizeof(uint32_t) };
+        for (uint32_t i = 1; i < 3; i++)
+        {
+            writeDescriptorSet[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeDescriptorSet[i].pBufferInfo = &bufferInfo[i - 1];
+        }
+        writeCount = 3;
+    }
+
+    vkUpdateDescriptorSets(m_vulkanParams.Device, writeCount, writeDescriptorSet, 0, nullptr);
 }
 
 void VKAlphaBlending::CreatePipelineLayout()
 {
     // Create a pipeline layout that will be used to create one or more pipeline objects.
-    // In this case we have a pipeline layout with a single descriptor set layout.
+    // In this case we have a pipeline layout with a single descriptor set layout, plus the one of the OIT resources (set 1).
+    VkDescriptorSetLayout setLayouts[2] = { m_sampleParams.DescriptorSetLayout, m_oitDescriptorSetLayout };
     VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo = {};
     pPipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pPipelineLayoutCreateInfo.pNext = nullptr;
-    pPipelineLayoutCreateInfo.setLayoutCount = 1;
-    pPipelineLayoutCreateInfo.pSetLayouts = &m_sampleParams.DescriptorSetLayout;
+    pPipelineLayoutCreateInfo.setLayoutCount = (m_oitMode == OIT_SORTED) ? 1 : 2;
+    pPipelineLayoutCreateInfo.pSetLayouts = setLayouts;
     
     VK_CHECK_RESULT(vkCreatePipelineLayout(m_vulkanParams.Device, &pPipelineLayoutCreateInfo, nullptr, &m_sampleParams.PipelineLayout));
 }
@@ -771,10 +1358,13 @@ void VKAlphaBlending::CreatePipelineObjects()
     pipelineCreateInfo.pDynamicState = &dynamicState;
     
     // Create a graphics pipeline for opaque objects
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipelines["Opaque"]));
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineOpaque]));
+
+    // The quads are rotated in the field (--quads N), so their back faces must be drawn too
+    rasterizationState.cullMode = VK_CULL_MODE_NONE;
 
     // Create a new blend attachment state for alpha blending
-    VkPipelineColorBlendAttachmentState transparentBlendAttachmentState[1] = {};
+    VkPipelineColorBlendAttachmentState transparentBlendAttachmentState[2] = {};
     transparentBlendAttachmentState[0].colorWriteMask = 0xf;
     transparentBlendAttachmentState[0].blendEnable = VK_TRUE;
     transparentBlendAttachmentState[0].srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
@@ -784,12 +1374,91 @@ void VKAlphaBlending::CreatePipelineObjects()
     colorBlendState.pAttachments = transparentBlendAttachmentState;
     // Specify a different fragment shader
     vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[1].module, nullptr);
-	shaderStages[1].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/solid.frag.spv");
-	// Create a graphics pipeline to draw using a solid color with blending enabled
-	VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.GraphicsPipelines["Transparent"]));
-    
-    // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
-    // since the SPIR-V modules are compiled during pipeline creation.
+
+    if (m_oitMode == OIT_SORTED)
+    {
+        shaderStages[1].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/solid.frag.spv");
+        // Create a graphics pipeline to draw using a solid color with blending enabled
+        VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineTransparent]));
+
+        // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
+        // since the SPIR-V modules are compiled during pipeline creation.
+        vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[0].module, nullptr);
+        vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[1].module, nullptr);
+        return;
+    }
+
+    //
+    // Order-independent transparency: the quads are drawn in the second subpass, in any order, 
+    // and the third subpass composites them over the opaque objects with a fullscreen triangle.
+    //
+    pipelineCreateInfo.subpass = 1;
+
+    // The quads are tested against the depth of the opaque objects, but they don't write it
+    depthStencilState.depthWriteEnable = VK_FALSE;
+
+    if (m_oitMode == OIT_WEIGHTED)
+    {
+        // Accumulation: sum of the weighted premultiplied colors (and of the weighted alphas)
+        transparentBlendAttachmentState[0].srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        transparentBlendAttachmentState[0].dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        transparentBlendAttachmentState[0].srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        transparentBlendAttachmentState[0].dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        transparentBlendAttachmentState[0].alphaBlendOp = VK_BLEND_OP_ADD;
+
+        // Revealage: product of the (1 - alpha) of the quads (requires the independentBlend feature)
+        transparentBlendAttachmentState[1].colorWriteMask = VK_COLOR_COMPONENT_R_BIT;
+        transparentBlendAttachmentState[1].blendEnable = VK_TRUE;
+        transparentBlendAttachmentState[1].srcColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+        transparentBlendAttachmentState[1].dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+        transparentBlendAttachmentState[1].colorBlendOp = VK_BLEND_OP_ADD;
+        colorBlendState.attachmentCount = 2;
+
+        shaderStages[1].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/oitWeighted.frag.spv");
+    }
+    else
+    {
+        // The fragments are stored in the linked lists: nothing is written to the color attachments of the subpass
+        colorBlendState.attachmentCount = 0;
+
+        shaderStages[1].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/oitLinkedList.frag.spv");
+    }
+    assert(shaderStages[1].module != VK_NULL_HANDLE);
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineTransparent]));
+
+    vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[0].module, nullptr);
+    vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[1].module, nullptr);
+
+    // The composite pipeline draws a fullscreen triangle with no vertex buffer (see fullscreen.vert)
+    VkPipelineVertexInputStateCreateInfo emptyVertexInputState = {};
+    emptyVertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    pipelineCreateInfo.pVertexInputState = &emptyVertexInputState;
+    pipelineCreateInfo.subpass = 2;
+
+    depthStencilState.depthTestEnable = VK_FALSE;
+
+    // The transparent color is blended over the opaque objects in the swapchain image
+    transparentBlendAttachmentState[0] = {};
+    transparentBlendAttachmentState[0].colorWriteMask = 0xf;
+    transparentBlendAttachmentState[0].blendEnable = VK_TRUE;
+    transparentBlendAttachmentState[0].srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    transparentBlendAttachmentState[0].dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    transparentBlendAttachmentState[0].colorBlendOp = VK_BLEND_OP_ADD;
+    colorBlendState.attachmentCount = 1;
+
+    shaderStages[0].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/fullscreen.vert.spv");
+    assert(shaderStages[0].module != VK_NULL_HANDLE);
+    if (m_oitMode == OIT_WEIGHTED)
+        shaderStages[1].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/oitComposite.frag.spv");
+    else
+    {
+        // The resolve shader blends the sorted fragments front to back, so its color is already premultiplied
+        transparentBlendAttachmentState[0].srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        shaderStages[1].module = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/oitResolve.frag.spv");
+    }
+    assert(shaderStages[1].module != VK_NULL_HANDLE);
+    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, m_pipelineCache, 1, &pipelineCreateInfo, nullptr, &m_sampleParams.Pipelines[m_pipelineComposite]));
+
     vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[0].module, nullptr);
     vkDestroyShaderModule(m_vulkanParams.Device, shaderStages[1].module, nullptr);
 }
@@ -801,9 +1470,12 @@ void VKAlphaBlending::PopulateCommandBuffer(uint32_t currentImageIndex)
     cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     // Values used to clear the framebuffer attachments at the start of the subpasses that use them.
-    VkClearValue clearValues[2];
+    // The accumulation and revealage attachments of weighted blended OIT start at 0 and 1.
+    VkClearValue clearValues[4];
     clearValues[0].color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
     clearValues[1].depthStencil = { 1.0f, 0 };
+    clearValues[2].color = { { 0.0f, 0.0f, 0.0f, 0.0f } };
+    clearValues[3].color = { { 1.0f, 0.0f, 0.0f, 0.0f } };
 
     VkRenderPassBeginInfo renderPassBeginInfo = {};
     renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -813,18 +1485,58 @@ void VKAlphaBlending::PopulateCommandBuffer(uint32_t currentImageIndex)
     renderPassBeginInfo.renderArea.extent.width = m_width;
     renderPassBeginInfo.renderArea.extent.height = m_height;
     // Set clear values for all framebuffer attachments with loadOp set to clear.
-    renderPassBeginInfo.clearValueCount = 2;
+    renderPassBeginInfo.clearValueCount = (m_oitMode == OIT_WEIGHTED) ? 4 : 2;
     renderPassBeginInfo.pClearValues = clearValues;
     // Set the render pass object used to begin an instance of.
     renderPassBeginInfo.renderPass = m_sampleParams.RenderPass;
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
+
+    // Reset the linked lists: every head points to no node (0xffffffff) and the node counter is zeroed.
+    // The previous frame may still be building or resolving the lists, so wait for its fragment shaders first.
+    if (m_oitMode == OIT_LINKED_LISTS)
+    {
+        VkImageMemoryBarrier headBarrier = {};
+        headBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        headBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        headBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        headBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        headBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        headBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        headBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        headBarrier.image = m_headImage.Handle;
+        headBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+        VkMemoryBarrier counterBarrier = {};
+        counterBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        counterBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+        counterBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex],
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 1, &counterBarrier, 0, nullptr, 1, &headBarrier);
+
+        VkClearColorValue headClear = {};
+        headClear.uint32[0] = 0xffffffff;
+        vkCmdClearColorImage(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_headImage.Handle, 
+                             VK_IMAGE_LAYOUT_GENERAL, &headClear, 1, &headBarrier.subresourceRange);
+        vkCmdFillBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_nodeCounterBuffer.Handle, 0, sizeof(uint32_t), 0);
+
+        // Make the cleared heads and counter visible to the fragment shaders of the transparent subpass
+        VkMemoryBarrier clearBarrier = {};
+        clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex],
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+    }
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -832,7 +1544,7 @@ void VKAlphaBlending::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -840,46 +1552,109 @@ void VKAlphaBlending::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
     
     // Bind the vertex buffer (contains positions and colors)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
 
     // Bind the index buffer
-	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
+
+    // Render multiple objects by using different pipelines and dynamically offsetting into a uniform buffer.
+    // The opaque cube is drawn first, using the mesh information at the start of the dynamic uniform buffer.
+    uint32_t dynamicOffset = 0;
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                        m_sampleParams.Pipelines[m_pipelineOpaque]);
+    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                            m_sampleParams.PipelineLayout, 
+                            0, 1, 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                            1, &dynamicOffset);
+    vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, 1, 0, 0, 0);
+
+    // Then the transparent quads: sorted back to front in the same subpass, or in any order in the next one
+    // with order-independent transparency.
+    if (m_oitMode != OIT_SORTED)
+        vkCmdNextSubpass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], VK_SUBPASS_CONTENTS_INLINE);
+
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                        m_sampleParams.Pipelines[m_pipelineTransparent]);
+
+    // The linked lists are built in the resources of set 1
+    if (m_oitMode == OIT_LINKED_LISTS)
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                m_sampleParams.PipelineLayout, 
+                                1, 1, &m_oitDescriptorSet, 0, nullptr);
 
-    // Render multiple objects by using different pipelines and dynamically offsetting into a uniform buffer
-    for (uint32_t j = 0; j < m_numDrawCalls; j++)
+    for (uint32_t j = 0; j < m_quads.size(); j++)
     {
-        // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
-        uint32_t dynamicOffset = j * static_cast<uint32_t>(m_dynamicUBOAlignment);
+        uint32_t quad = (m_oitMode == OIT_SORTED) ? m_drawOrder[j] : j;
 
-        // Bind the graphics pipeline
-        vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            (!j) ? m_sampleParams.GraphicsPipelines["Opaque"] : m_sampleParams.GraphicsPipelines["Transparent"]);
+        // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
+        dynamicOffset = (1 + quad) * static_cast<uint32_t>(m_dynamicUBOAlignment);
 
         // Bind descriptor sets for drawing a mesh using a dynamic offset
-        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                                 VK_PIPELINE_BIND_POINT_GRAPHICS, 
                                 m_sampleParams.PipelineLayout, 
                                 0, 1, 
-                                &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
                                 1, &dynamicOffset);
 
-        // Draw a cube
-        if (!j)
-            vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.indexBufferCount, 1, 0, 0, 0);
-        else
-            vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 6, 1, 0, 0, 0);
+        // Draw a quad (the first face of the cube)
+        vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 6, 1, 0, 0, 0);
+    }
+
+    // Composite the transparent fragments over the opaque objects with a fullscreen triangle
+    if (m_oitMode != OIT_SORTED)
+    {
+        vkCmdNextSubpass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], VK_SUBPASS_CONTENTS_INLINE);
+
+        vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                            m_sampleParams.Pipelines[m_pipelineComposite]);
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                m_sampleParams.PipelineLayout, 
+                                1, 1, &m_oitDescriptorSet, 0, nullptr);
+        vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 3, 1, 0, 0);
     }
     
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
+
+    // Copy the number of nodes allocated in this frame to the host-visible buffer of the frame (read by ReadNodeCount
+    // once the fence of the frame is signaled).
+    if (m_oitMode == OIT_LINKED_LISTS)
+    {
+        VkMemoryBarrier counterBarrier = {};
+        counterBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        counterBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        counterBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex],
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 1, &counterBarrier, 0, nullptr, 0, nullptr);
+
+        VkBufferCopy copyRegion = { 0, 0, sizeof(uint32_t) };
+        vkCmdCopyBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        m_nodeCounterBuffer.Handle, m_nodeCountReadback[m_frameIndex].Handle, 1, &copyRegion);
+
+        counterBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        counterBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex],
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 1, &counterBarrier, 0, nullptr, 0, nullptr);
+
+        m_nodeCountPending[m_frameIndex] = true;
+    }
     
-    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKAlphaBlending::SubmitCommandBuffer()
@@ -892,13 +1667,13 @@ void VKAlphaBlending::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKAlphaBlending::PresentImage(uint32_t currentImageIndex)
@@ -913,13 +1688,13 @@ void VKAlphaBlending::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
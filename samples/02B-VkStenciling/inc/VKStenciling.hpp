@@ -6,6 +6,14 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "glm/glm.hpp"
 
+// Mesh objects drawn for each cube: the cube itself, its reflection, its shadow and the reflection of its shadow
+#define CUBE_MESH_COUNT 4
+
+// Minimum number of draws recorded by a worker thread. Below twice this number, the draws of a frame are
+// recorded directly in the primary command buffer, since starting the jobs and executing the secondary 
+// command buffers would cost more than recording the draws on the main thread.
+#define MIN_DRAWS_PER_JOB 64
+
 class VKStenciling : public VKSample
 {
 public:
@@ -25,6 +33,7 @@ private:
     void SetupPipeline();
     
     void PopulateCommandBuffer(uint32_t currentImageIndex);
+    void RecordDrawRange(VkCommandBuffer cmd, uint32_t firstDraw, uint32_t drawCount);
     void SubmitCommandBuffer();
     void PresentImage(uint32_t currentImageIndex);
     
@@ -36,6 +45,10 @@ private:
     void AllocateDescriptorSets();          // Allocate a descriptor set
     void CreatePipelineLayout();            // Create a pipeline layout
     void CreatePipelineObjects();           // Create a pipeline object
+    void BuildDrawList();                   // Build the ordered list of draws of a frame
+
+    // Index of the mesh info of a cube mesh object (cube, reflected cube, and their shadows) for the cube cubeIndex
+    uint32_t CubeDynIndex(TableHandle mesh, uint32_t cubeIndex) { return m_meshObjects[mesh].dynIndex + CUBE_MESH_COUNT * cubeIndex; }
 
     // Update buffer data
     void UpdateHostVisibleBufferData();
@@ -96,18 +109,53 @@ private:
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffer;
 
-    // In this sample we have nine draw calls for each frame.
-    const unsigned int m_numDrawCalls = 9;
-
     // Mesh objects to draw
-    std::map<std::string, MeshObject> m_meshObjects;
+    VKHandleTable<MeshObject> m_meshObjects;
+
+    // A draw of a mesh object with a given pipeline and stencil reference value, using the mesh info at dynIndex
+    struct DrawItem
+    {
+        VkPipeline pipeline;
+        const MeshObject* mesh;
+        uint32_t stencilReference;
+        uint32_t dynIndex;
+    };
+
+    // Draws of a frame, in the order they need to be executed (the stencil technique depends on it).
+    // Handles and pointers are resolved in advance, so that the worker threads don't access any map.
+    std::vector<DrawItem> m_drawList;
+
+    // Number of worker threads recording the draws (set at launch with --threads N, 0 for one per hardware thread)
+    uint32_t m_threadCount;
+
+    // Number of cubes reflected by the mirror (set at launch with --objects N). 
+    // Each cube adds four draws to the five draws of the floor, the wall and the mirror.
+    uint32_t m_cubeCount;
+
+    // Handles of the named pipelines, mesh objects and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineLambertian;
+    TableHandle m_pipelineSolidColor;
+    TableHandle m_pipelineTransparent;
+    TableHandle m_pipelineStencil;
+    TableHandle m_pipelineReflectedLambertian;
+    TableHandle m_pipelineReflectedSolidColor;
+    TableHandle m_pipelineShadow;
+    TableHandle m_meshCube;
+    TableHandle m_meshFloor;
+    TableHandle m_meshWall;
+    TableHandle m_meshMirror;
+    TableHandle m_meshReflectedCube;
+    TableHandle m_meshReflectedFloor;
+    TableHandle m_meshShadowCube;
+    TableHandle m_meshShadowReflectedCube;
+    TableHandle m_descSetGraphics;
 
     // Sample members
     float m_curRotationAngleRad;
@@ -10,36 +10,61 @@
 VKStenciling::VKStenciling(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
 m_curRotationAngleRad(0.0f),
-m_dynamicUBOAlignment(0)
+m_dynamicUBOAlignment(0),
+m_threadCount(0),
+m_cubeCount(1)
 {
+    // The stencil buffer is used to draw the reflections only inside the mirror
+    m_stencilBuffer = true;
+
+    // Register the named pipelines, mesh objects and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineLambertian = m_sampleParams.Pipelines.Register("Lambertian");
+    m_pipelineSolidColor = m_sampleParams.Pipelines.Register("SolidColor");
+    m_pipelineTransparent = m_sampleParams.Pipelines.Register("Transparent");
+    m_pipelineStencil = m_sampleParams.Pipelines.Register("Stencil");
+    m_pipelineReflectedLambertian = m_sampleParams.Pipelines.Register("ReflectedLambertian");
+    m_pipelineReflectedSolidColor = m_sampleParams.Pipelines.Register("ReflectedSolidColor");
+    m_pipelineShadow = m_sampleParams.Pipelines.Register("Shadow");
+    m_meshCube = m_meshObjects.Register("cube");
+    m_meshFloor = m_meshObjects.Register("floor");
+    m_meshWall = m_meshObjects.Register("wall");
+    m_meshMirror = m_meshObjects.Register("mirror");
+    m_meshReflectedCube = m_meshObjects.Register("reflectedCube");
+    m_meshReflectedFloor = m_meshObjects.Register("reflectedFloor");
+    m_meshShadowCube = m_meshObjects.Register("shadowCube");
+    m_meshShadowReflectedCube = m_meshObjects.Register("shadowReflectedCube");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
+
     // Initialize the pointer to the memory region that will store the array of world matrices.
     dynUBufVS.meshInfo = nullptr;
 
-    // Initialize mesh objects
-    m_meshObjects["cube"] = {0, 36, 0, 0, 24, nullptr};
+    // Initialize mesh objects.
+    // The mesh infos of the cubes follow those of the other objects: the four cube mesh objects index the mesh infos 
+    // of the first cube, and each of the other cubes uses the next CUBE_MESH_COUNT mesh infos (see CubeDynIndex).
+    m_meshObjects[m_meshCube] = {4, 36, 0, 0, 24, nullptr};
 
-    m_meshObjects["floor"] = {1, 6, 
-                              m_meshObjects["cube"].indexCount, 
-                              m_meshObjects["cube"].vertexCount, 
+    m_meshObjects[m_meshFloor] = {0, 6, 
+                              m_meshObjects[m_meshCube].indexCount, 
+                              m_meshObjects[m_meshCube].vertexCount, 
                               4, nullptr};
 
-    m_meshObjects["wall"] = {2, 18, 
-                             m_meshObjects["cube"].indexCount + m_meshObjects["floor"].indexCount,
-                             m_meshObjects["cube"].vertexCount + m_meshObjects["floor"].vertexCount,
+    m_meshObjects[m_meshWall] = {1, 18, 
+                             m_meshObjects[m_meshCube].indexCount + m_meshObjects[m_meshFloor].indexCount,
+                             m_meshObjects[m_meshCube].vertexCount + m_meshObjects[m_meshFloor].vertexCount,
                              10, nullptr};
 
-    m_meshObjects["mirror"] = {3, 6, 
-                               m_meshObjects["cube"].indexCount + m_meshObjects["floor"].indexCount + m_meshObjects["wall"].indexCount, 
-                               m_meshObjects["cube"].vertexCount + m_meshObjects["floor"].vertexCount + m_meshObjects["wall"].vertexCount, 
+    m_meshObjects[m_meshMirror] = {2, 6, 
+                               m_meshObjects[m_meshCube].indexCount + m_meshObjects[m_meshFloor].indexCount + m_meshObjects[m_meshWall].indexCount, 
+                               m_meshObjects[m_meshCube].vertexCount + m_meshObjects[m_meshFloor].vertexCount + m_meshObjects[m_meshWall].vertexCount, 
                                4, nullptr};
 
-    m_meshObjects["reflectedCube"] = {4, 36, 0, 0, 24, nullptr};
+    m_meshObjects[m_meshReflectedCube] = {5, 36, 0, 0, 24, nullptr};
 
-    m_meshObjects["reflectedFloor"] = {5, m_meshObjects["floor"].indexCount, m_meshObjects["floor"].firstIndex, 
-                                       m_meshObjects["floor"].vertexOffset, m_meshObjects["floor"].vertexCount, nullptr};
+    m_meshObjects[m_meshReflectedFloor] = {3, m_meshObjects[m_meshFloor].indexCount, m_meshObjects[m_meshFloor].firstIndex, 
+                                       m_meshObjects[m_meshFloor].vertexOffset, m_meshObjects[m_meshFloor].vertexCount, nullptr};
 
-    m_meshObjects["shadowCube"] = {6, 36, 0, 0, 24, nullptr};
-    m_meshObjects["shadowReflectedCube"] = {7, 36, 0, 0, 24, nullptr};
+    m_meshObjects[m_meshShadowCube] = {6, 36, 0, 0, 24, nullptr};
+    m_meshObjects[m_meshShadowReflectedCube] = {7, 36, 0, 0, 24, nullptr};
 
     // Initialize the view matrix
     glm::vec3 c_pos = { 3.0f, -10.0f, 4.0f };
@@ -63,6 +88,17 @@ VKStenciling::~VKStenciling()
 
 void VKStenciling::OnInit()
 {
+    // The number of threads recording command buffers (--threads N) and the number of cubes 
+    // reflected by the mirror (--objects N) can be specified on the command line
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i + 1 < args.size(); i++)
+    {
+        if (strcmp(args[i], "--threads") == 0)
+            m_threadCount = static_cast<uint32_t>(strtoul(args[i + 1], nullptr, 10));
+        else if (strcmp(args[i], "--objects") == 0)
+            m_cubeCount = std::max(1u, static_cast<uint32_t>(strtoul(args[i + 1], nullptr, 10)));
+    }
+
     InitVulkan();
     SetupPipeline();
 
@@ -82,6 +118,11 @@ void VKStenciling::InitVulkan()
     CreateFrameBuffers();
     AllocateCommandBuffers();
     CreateSynchronizationObjects();
+
+    // Start the worker threads, and create their command pools
+    m_jobSystem.Init(m_threadCount);
+    CreateThreadCommandPools();
+    printf("Recording command buffers with %u threads\n", m_jobSystem.GetThreadCount());
 }
 
 void VKStenciling::SetupPipeline()
@@ -93,7 +134,10 @@ void VKStenciling::SetupPipeline()
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
+    BuildDrawList();
 
     m_initialized = true;
 }
@@ -114,17 +158,19 @@ void VKStenciling::OnUpdate()
 // Render the scene.
 void VKStenciling::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
+    // The secondary command buffers recorded m_framesInFlight frames ago have been executed, so the 
+    // command pools of the current frame can be reset.
+    ResetThreadCommandPools();
+
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -140,7 +186,7 @@ void VKStenciling::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKStenciling::OnDestroy()
@@ -150,25 +196,26 @@ void VKStenciling::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffer.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffer.IBmemory);
 
     // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Destroy dynamic buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -176,7 +223,7 @@ void VKStenciling::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
@@ -187,8 +234,8 @@ void VKStenciling::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.GraphicsPipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -199,30 +246,49 @@ void VKStenciling::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Stop the worker threads and destroy their command pools
+    m_jobSystem.Destroy();
+    DestroyThreadCommandPools();
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -231,8 +297,12 @@ void VKStenciling::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -372,15 +442,6 @@ void VKStenciling::CreateVertexBuffer()
     // This is not recommended as it can result in lower rendering performance.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -392,19 +453,10 @@ void VKStenciling::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.VBmemory));
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.VBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.VBmemory);
 
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, cubeVertices.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, m_vertexindexBuffer.VBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.VBmemory.MappedMemory, cubeVertices.data(), vertexBufferSize);
 
     // Create the index buffer object
     VkBufferCreateInfo indexBufferInfo = {};
@@ -413,16 +465,10 @@ void VKStenciling::CreateVertexBuffer()
     indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &indexBufferInfo, nullptr, &m_vertexindexBuffer.IBbuffer));
 
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.IBmemory));
-
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, indexBuffer.data(), indexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory);
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.IBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.IBmemory);
 
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, m_vertexindexBuffer.IBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.IBmemory.MappedMemory, indexBuffer.data(), indexBufferSize);
 }
 
 void VKStenciling::CreateHostVisibleBuffers()
@@ -443,15 +489,14 @@ void VKStenciling::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -471,7 +516,8 @@ void VKStenciling::CreateHostVisibleDynamicBuffers()
 	if (minUBOAlignment > 0)
 		m_dynamicUBOAlignment = (m_dynamicUBOAlignment + minUBOAlignment - 1) & ~(minUBOAlignment - 1);
     
-	size_t dynBufferSize = m_numDrawCalls * m_dynamicUBOAlignment;
+	// One mesh info for each object but the cubes, plus CUBE_MESH_COUNT mesh infos for each cube
+	size_t dynBufferSize = CubeDynIndex(m_meshCube, m_cubeCount) * m_dynamicUBOAlignment;
 
     dynUBufVS.meshInfo = (MeshInfo*)AlignedAlloc(dynBufferSize, m_dynamicUBOAlignment);
 	assert(dynUBufVS.meshInfo);
@@ -487,15 +533,14 @@ void VKStenciling::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -514,7 +559,7 @@ void VKStenciling::UpdateHostVisibleBufferData()
 {
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
         memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
@@ -529,57 +574,61 @@ void VKStenciling::UpdateHostVisibleDynamicBufferData()
         m_curRotationAngleRad -= glm::two_pi<float>();
     }
 
-    // Rotate the cube at the center of the scene around the z-axis
-    m_meshObjects["cube"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                        (m_meshObjects["cube"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
-    glm::mat4 transl = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -6.0f, 2.0f));
-    glm::mat4 rotZTransl = glm::rotate(transl, m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
-    m_meshObjects["cube"].meshInfo->worldMatrix = rotZTransl;
-
     // Set color of wall and floor
-    m_meshObjects["floor"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo +
-                                        (m_meshObjects["floor"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
-    m_meshObjects["floor"].meshInfo->worldMatrix = glm::identity<glm::mat4>();
-    m_meshObjects["floor"].meshInfo->solidColor = { 1.0f, 0.9f, 0.7f, 1.0f };
-    m_meshObjects["wall"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                        (m_meshObjects["wall"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
-    m_meshObjects["wall"].meshInfo->worldMatrix = glm::identity<glm::mat4>();
-    m_meshObjects["wall"].meshInfo->solidColor = { 0.6f, 0.3f, 0.0f, 1.0f };
+    m_meshObjects[m_meshFloor].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo +
+                                        (m_meshObjects[m_meshFloor].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshFloor].meshInfo->worldMatrix = glm::identity<glm::mat4>();
+    m_meshObjects[m_meshFloor].meshInfo->solidColor = { 1.0f, 0.9f, 0.7f, 1.0f };
+    m_meshObjects[m_meshWall].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
+                                        (m_meshObjects[m_meshWall].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshWall].meshInfo->worldMatrix = glm::identity<glm::mat4>();
+    m_meshObjects[m_meshWall].meshInfo->solidColor = { 0.6f, 0.3f, 0.0f, 1.0f };
 
     // Set color of mirror
-    m_meshObjects["mirror"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                            (m_meshObjects["mirror"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
-    m_meshObjects["mirror"].meshInfo->worldMatrix = glm::identity<glm::mat4>();
-    m_meshObjects["mirror"].meshInfo->solidColor = { 0.5f, 1.0f, 1.0f, 0.15f };
-
-    // Use the world matrix of the cube to reflect it with respect to the mirror plane
-    m_meshObjects["reflectedCube"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                                    (m_meshObjects["reflectedCube"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshMirror].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
+                                            (m_meshObjects[m_meshMirror].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshMirror].meshInfo->worldMatrix = glm::identity<glm::mat4>();
+    m_meshObjects[m_meshMirror].meshInfo->solidColor = { 0.5f, 1.0f, 1.0f, 0.15f };
+
+    // Use the world matrix of the floor to reflect it with respect to the mirror plane
+    m_meshObjects[m_meshReflectedFloor].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
+                                                    (m_meshObjects[m_meshReflectedFloor].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
     glm::vec4 mirrorPlane = {0.0f, 1.0f, 0.0f, 0.0f}; // xz-plane
     glm::mat4 R = MatrixReflect(mirrorPlane);
-    m_meshObjects["reflectedCube"].meshInfo->worldMatrix = R * m_meshObjects["cube"].meshInfo->worldMatrix;
+    m_meshObjects[m_meshReflectedFloor].meshInfo->worldMatrix = R * m_meshObjects[m_meshFloor].meshInfo->worldMatrix;
+    m_meshObjects[m_meshReflectedFloor].meshInfo->solidColor = m_meshObjects[m_meshFloor].meshInfo->solidColor;
 
-    // Use the world matrix of the floor to reflect it with respect to the mirror plane
-    m_meshObjects["reflectedFloor"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                                    (m_meshObjects["reflectedFloor"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
-    m_meshObjects["reflectedFloor"].meshInfo->worldMatrix = R * m_meshObjects["floor"].meshInfo->worldMatrix;
-    m_meshObjects["reflectedFloor"].meshInfo->solidColor = m_meshObjects["floor"].meshInfo->solidColor;
-
-    // Use the world matrix of the cube to project it onto the floor with respect to the light source,
-    // and raise it a little to prevent z-fighting.
-    m_meshObjects["shadowCube"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                                (m_meshObjects["shadowCube"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    // Matrices projecting the cubes onto the floor with respect to the light source, 
+    // and raising them a little to prevent z-fighting.
     glm::vec4 shadowPlane = {0.0f, 0.0f, 1.0f, 0.0f}; // xy-plane
     glm::mat4 S = MatrixShadow(shadowPlane, uBufVS.lightDir);
     glm::mat4 T = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, 0.0f, 0.003f));
-    m_meshObjects["shadowCube"].meshInfo->worldMatrix = T * S * m_meshObjects["cube"].meshInfo->worldMatrix;
-    m_meshObjects["shadowCube"].meshInfo->solidColor = { 0.0f, 0.0f, 0.0f, 0.2f };
 
-    // Use the world matrix of the shadow above to reflect it with respect to the mirror plane.
-    m_meshObjects["shadowReflectedCube"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                                        (m_meshObjects["shadowReflectedCube"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
-    m_meshObjects["shadowReflectedCube"].meshInfo->worldMatrix = R * m_meshObjects["shadowCube"].meshInfo->worldMatrix;
-    m_meshObjects["shadowReflectedCube"].meshInfo->solidColor = m_meshObjects["shadowCube"].meshInfo->solidColor;
+    for (uint32_t i = 0; i < m_cubeCount; i++)
+    {
+        MeshInfo* cube = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + (CubeDynIndex(m_meshCube, i) * m_dynamicUBOAlignment));
+        MeshInfo* reflectedCube = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + (CubeDynIndex(m_meshReflectedCube, i) * m_dynamicUBOAlignment));
+        MeshInfo* shadowCube = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + (CubeDynIndex(m_meshShadowCube, i) * m_dynamicUBOAlignment));
+        MeshInfo* shadowReflectedCube = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + (CubeDynIndex(m_meshShadowReflectedCube, i) * m_dynamicUBOAlignment));
+
+        // The first cube is at the center of the scene, and the others are placed alternately on its left and right,
+        // in rows of eight cubes moving away from the mirror. Each cube rotates around the z-axis.
+        float x = 3.0f * ((i % 8 + 1) / 2) * ((i % 2) ? -1.0f : 1.0f);
+        float y = -6.0f - 3.0f * (i / 8);
+        glm::mat4 transl = glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 2.0f));
+        cube->worldMatrix = glm::rotate(transl, m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
+
+        // Use the world matrix of the cube to reflect it with respect to the mirror plane
+        reflectedCube->worldMatrix = R * cube->worldMatrix;
+
+        // Use the world matrix of the cube to project it onto the floor
+        shadowCube->worldMatrix = T * S * cube->worldMatrix;
+        shadowCube->solidColor = { 0.0f, 0.0f, 0.0f, 0.2f };
+
+        // Use the world matrix of the shadow above to reflect it with respect to the mirror plane.
+        shadowReflectedCube->worldMatrix = R * shadowCube->worldMatrix;
+        shadowReflectedCube->solidColor = shadowCube->solidColor;
+    }
 
     // Update dynamic uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
@@ -600,9 +649,9 @@ void VKStenciling::CreateDescriptorPool()
     // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer)
     VkDescriptorPoolSize typeCounts[2];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
@@ -612,7 +661,7 @@ void VKStenciling::CreateDescriptorPool()
     descriptorPoolInfo.poolSizeCount = 2;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -649,17 +698,17 @@ void VKStenciling::CreateDescriptorSetLayout()
 
 void VKStenciling::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -668,13 +717,13 @@ void VKStenciling::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[2] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -682,7 +731,7 @@ void VKStenciling::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
@@ -892,9 +941,9 @@ void VKStenciling::CreatePipelineObjects()
     
     // Create a graphics pipeline for lambertian illumination
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["Lambertian"]));
+                                              &m_sampleParams.Pipelines[m_pipelineLambertian]));
 
     //
     // SolidColor
@@ -904,9 +953,9 @@ void VKStenciling::CreatePipelineObjects()
 	shaderStages[1].module = solidFS;
 	// Create a graphics pipeline to draw using a solid color
 	VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["SolidColor"]));
+                                              &m_sampleParams.Pipelines[m_pipelineSolidColor]));
 
     //
     // Transparent
@@ -920,9 +969,9 @@ void VKStenciling::CreatePipelineObjects()
     blendAttachmentState[0].colorBlendOp = VK_BLEND_OP_ADD;
 	// Create a graphics pipeline to draw using a solid color with blending enabled
 	VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["Transparent"]));
+                                              &m_sampleParams.Pipelines[m_pipelineTransparent]));
 
     //
     // Stencil
@@ -946,9 +995,9 @@ void VKStenciling::CreatePipelineObjects()
     depthStencilState.front.writeMask = 0xff;
     // Create a graphics pipeline for drawing on the stencil image (to create a mask)
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["Stencil"]));
+                                              &m_sampleParams.Pipelines[m_pipelineStencil]));
 
     //
     // ReflectedLambertian
@@ -970,9 +1019,9 @@ void VKStenciling::CreatePipelineObjects()
 	shaderStages[1].module = lambertianFS;
     // Create a graphics pipeline for drawing reflected, illuminated objects (using the stencil image as a mask)
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["ReflectedLambertian"]));
+                                              &m_sampleParams.Pipelines[m_pipelineReflectedLambertian]));
 
     //
     // ReflectedSolidColor
@@ -982,9 +1031,9 @@ void VKStenciling::CreatePipelineObjects()
 	shaderStages[1].module = solidFS;
     // Create a graphics pipeline for drawing reflected, NON-illuminated objects (using the stencil image as a mask)
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["ReflectedSolidColor"]));
+                                              &m_sampleParams.Pipelines[m_pipelineReflectedSolidColor]));
 
     //
     // Shadow
@@ -999,9 +1048,9 @@ void VKStenciling::CreatePipelineObjects()
     depthStencilState.front.passOp = VK_STENCIL_OP_INCREMENT_AND_CLAMP;
     // Create a graphics pipeline for drawing transparent objects projected onto other surfaces, like shadows.
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["Shadow"]));
+                                              &m_sampleParams.Pipelines[m_pipelineShadow]));
 
     // SPIR-V shader modules are no longer needed once the graphics pipeline has been created
     // since the SPIR-V modules are compiled during pipeline creation.
@@ -1010,8 +1059,90 @@ void VKStenciling::CreatePipelineObjects()
     vkDestroyShaderModule(m_vulkanParams.Device, solidFS, nullptr);
 }
 
+void VKStenciling::BuildDrawList()
+{
+    m_drawList.clear();
+
+    // Cubes (drawn with the semplified lambertian shading model)
+    for (uint32_t i = 0; i < m_cubeCount; i++)
+        m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineLambertian], &m_meshObjects[m_meshCube], 0, CubeDynIndex(m_meshCube, i) });
+
+    // Floor and Wall (opaque objects drawn with a solid color)
+    m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineSolidColor], &m_meshObjects[m_meshFloor], 0, m_meshObjects[m_meshFloor].dynIndex });
+    m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineSolidColor], &m_meshObjects[m_meshWall], 0, m_meshObjects[m_meshWall].dynIndex });
+
+    // Draw the mirror on the stencil image to create a mask (stencil reference value set to 1)
+    m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineStencil], &m_meshObjects[m_meshMirror], 1, m_meshObjects[m_meshMirror].dynIndex });
+
+    // Reflected cubes and reflected opaque objects (in this case, the floor only), drawn where the mask is set
+    for (uint32_t i = 0; i < m_cubeCount; i++)
+        m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineReflectedLambertian], &m_meshObjects[m_meshReflectedCube], 1, CubeDynIndex(m_meshReflectedCube, i) });
+    m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineReflectedSolidColor], &m_meshObjects[m_meshReflectedFloor], 1, m_meshObjects[m_meshReflectedFloor].dynIndex });
+
+    // Shadows of the cubes (stencil reference value set to 0) and of the reflected cubes (set to 1)
+    for (uint32_t i = 0; i < m_cubeCount; i++)
+        m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineShadow], &m_meshObjects[m_meshShadowCube], 0, CubeDynIndex(m_meshShadowCube, i) });
+    for (uint32_t i = 0; i < m_cubeCount; i++)
+        m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineShadow], &m_meshObjects[m_meshShadowReflectedCube], 1, CubeDynIndex(m_meshShadowReflectedCube, i) });
+
+    // Mirror (transparent object, stencil reference value set to 0)
+    m_drawList.push_back({ m_sampleParams.Pipelines[m_pipelineTransparent], &m_meshObjects[m_meshMirror], 0, m_meshObjects[m_meshMirror].dynIndex });
+}
+
 void VKStenciling::PopulateCommandBuffer(uint32_t currentImageIndex)
 {
+    //
+    // Record the draws in secondary command buffers, in parallel on the worker threads.
+    // The draw list is split in contiguous ranges (one for each job), and the secondary command buffers
+    // are executed in the order of the ranges, so that the draws are executed in the same order as
+    // if they were recorded in a single command buffer.
+    // Each job records at least MIN_DRAWS_PER_JOB draws: if there aren't enough draws for two jobs, 
+    // they are recorded inline in the primary command buffer instead.
+    //
+
+    uint32_t drawCount = static_cast<uint32_t>(m_drawList.size());
+    uint32_t jobCount = std::min(m_jobSystem.GetThreadCount(), drawCount / MIN_DRAWS_PER_JOB);
+    bool recordInline = (jobCount < 2);
+
+    std::vector<VkCommandBuffer> secondaryCommandBuffers;
+    if (!recordInline)
+    {
+        uint32_t drawsPerJob = (drawCount + jobCount - 1) / jobCount;
+        secondaryCommandBuffers.resize(jobCount);
+
+        // Secondary command buffers executed inside a render pass instance need to know the render pass, 
+        // the subpass and (optionally) the framebuffer they will be executed in.
+        VkCommandBufferInheritanceInfo inheritanceInfo = {};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = m_sampleParams.RenderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
+
+        m_jobSystem.Run(jobCount, [&](uint32_t jobIndex, uint32_t threadIndex)
+        {
+            // Get a secondary command buffer from the command pool of this thread for the current frame
+            VkCommandBuffer cmd = GetSecondaryCommandBuffer(threadIndex);
+
+            VkCommandBufferBeginInfo secondaryBeginInfo = {};
+            secondaryBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            secondaryBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            secondaryBeginInfo.pInheritanceInfo = &inheritanceInfo;
+
+            VK_CHECK_RESULT(vkBeginCommandBuffer(cmd, &secondaryBeginInfo));
+
+            uint32_t firstDraw = jobIndex * drawsPerJob;
+            RecordDrawRange(cmd, firstDraw, std::min(drawsPerJob, drawCount - firstDraw));
+
+            VK_CHECK_RESULT(vkEndCommandBuffer(cmd));
+
+            secondaryCommandBuffers[jobIndex] = cmd;
+        });
+    }
+
+    //
+    // Record the primary command buffer
+    //
+
     VkCommandBufferBeginInfo cmdBufInfo = {};
     cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
@@ -1036,11 +1167,42 @@ void VKStenciling::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
 
-    // Begin the render pass instance.
-    // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    if (recordInline)
+    {
+        // Begin the render pass instance.
+        // This will clear the color attachment.
+        // The contents of the subpass are recorded directly in the primary command buffer.
+        vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        RecordDrawRange(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, drawCount);
+    }
+    else
+    {
+        // Begin the render pass instance.
+        // This will clear the color attachment.
+        // The contents of the subpass will be recorded in secondary command buffers, so 
+        // vkCmdExecuteCommands is the only valid command on the primary command buffer.
+        vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+        // Execute the secondary command buffers in the order of their draw ranges
+        vkCmdExecuteCommands(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                             static_cast<uint32_t>(secondaryCommandBuffers.size()), 
+                             secondaryCommandBuffers.data());
+    }
+
+    // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
+    // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
+    
+     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
+}
+
+void VKStenciling::RecordDrawRange(VkCommandBuffer cmd, uint32_t firstDraw, uint32_t drawCount)
+{
+    // Secondary command buffers don't inherit any state from the primary command buffer (or from each other),
+    // so every range needs to set the dynamic states and bind the buffers it uses.
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -1048,7 +1210,7 @@ void VKStenciling::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -1056,251 +1218,51 @@ void VKStenciling::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(cmd, 0, 1, &scissor);
     
     // Bind the vertex buffer (contains positions and colors)
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
+    vkCmdBindVertexBuffers(cmd, 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
 
     // Bind the index buffer
-	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
-
-    // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
-
-    //
-    // Cube
-    //
+    vkCmdBindIndexBuffer(cmd, m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
 
-    uint32_t dynamicOffset = m_meshObjects["cube"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+    // Only record the state changes between consecutive draws
+    VkPipeline boundPipeline = VK_NULL_HANDLE;
+    uint32_t stencilReference = UINT32_MAX;
 
-    // Bind the graphics pipeline for drawing with the semplified lambertian shading model
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                        m_sampleParams.GraphicsPipelines["Lambertian"]);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Draw a cube
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_meshObjects["cube"].indexCount, 1, 0, 0, 0);
-
-    //
-    // Floor and Wall
-    //
-
-    // Bind the graphics pipeline for drawing opaque objects with a solid color
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                    m_sampleParams.GraphicsPipelines["SolidColor"]);
-
-    // Update dynamic offset
-    dynamicOffset = m_meshObjects["floor"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Draw the floor
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        m_meshObjects["floor"].indexCount, 1, 
-                        m_meshObjects["floor"].firstIndex, 
-                        m_meshObjects["floor"].vertexOffset, 0);
-
-
-    // Update dynamic offset
-    dynamicOffset = m_meshObjects["wall"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Draw the floor
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        m_meshObjects["wall"].indexCount, 1, 
-                        m_meshObjects["wall"].firstIndex, 
-                        m_meshObjects["wall"].vertexOffset, 0);
-
-    //
-    // Draw the mirror on the stencil image to create a mask
-    //
-
-    // Bind the graphics pipeline for drawing onto the stencil image
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                    m_sampleParams.GraphicsPipelines["Stencil"]);
-
-    // Update dynamic offset
-    dynamicOffset = m_meshObjects["mirror"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Set the stencil reference value to 1
-    vkCmdSetStencilReference(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], VK_STENCIL_FACE_FRONT_BIT, 1);
-
-    // Draw the mirror
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        m_meshObjects["mirror"].indexCount, 1, 
-                        m_meshObjects["mirror"].firstIndex, 
-                        m_meshObjects["mirror"].vertexOffset, 0);
-
-    //
-    // Reflected Cube
-    //
-
-    // Bind the graphics pipeline for drawing reflected objects using the semplified lambertian model
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                    m_sampleParams.GraphicsPipelines["ReflectedLambertian"]);
-
-    // Update dynamic offset
-    dynamicOffset = m_meshObjects["reflectedCube"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Draw the reflected cube
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        m_meshObjects["reflectedCube"].indexCount, 1, 
-                        m_meshObjects["reflectedCube"].firstIndex, 
-                        m_meshObjects["reflectedCube"].vertexOffset, 0);
-
-    //
-    // Reflected opaque objects (in this case, the floor only)
-    //
-
-    // Bind the graphics pipeline for drawing reflected objects with a solid color
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                    m_sampleParams.GraphicsPipelines["ReflectedSolidColor"]);
-
-    // Update dynamic offset
-    dynamicOffset = m_meshObjects["reflectedFloor"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Draw the reflected cube
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        m_meshObjects["reflectedFloor"].indexCount, 1, 
-                        m_meshObjects["reflectedFloor"].firstIndex, 
-                        m_meshObjects["reflectedFloor"].vertexOffset, 0);
-
-    //
-    // Shadow of the cube
-    //
-
-    // Bind the graphics pipeline for drawing shadows
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                    m_sampleParams.GraphicsPipelines["Shadow"]);
-
-    // Update dynamic offset
-    dynamicOffset = m_meshObjects["shadowCube"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Set the stencil reference value to 0
-    vkCmdSetStencilReference(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], VK_STENCIL_FACE_FRONT_BIT, 0);
-
-    // Draw the reflected cube
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        m_meshObjects["shadowCube"].indexCount, 1, 
-                        m_meshObjects["shadowCube"].firstIndex, 
-                        m_meshObjects["shadowCube"].vertexOffset, 0);
-
-    //
-    // Shadow of the reflected cube
-    //
-
-    // Update dynamic offset
-    dynamicOffset = m_meshObjects["shadowReflectedCube"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Set the stencil reference value to 1
-    vkCmdSetStencilReference(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], VK_STENCIL_FACE_FRONT_BIT, 1);
-
-    // Draw the reflected cube
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        m_meshObjects["shadowReflectedCube"].indexCount, 1, 
-                        m_meshObjects["shadowReflectedCube"].firstIndex, 
-                        m_meshObjects["shadowReflectedCube"].vertexOffset, 0);
-
-    //
-    // Mirror
-    //
-    
-    // Bind the graphics pipeline for drawing transparent objects
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                    m_sampleParams.GraphicsPipelines["Transparent"]);
-
-    // Update dynamic offset
-    dynamicOffset = m_meshObjects["mirror"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
-
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // Set the stencil reference value to 0
-    vkCmdSetStencilReference(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], VK_STENCIL_FACE_FRONT_BIT, 0);
-
-    // Draw the reflected cube
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        m_meshObjects["mirror"].indexCount, 1, 
-                        m_meshObjects["mirror"].firstIndex, 
-                        m_meshObjects["mirror"].vertexOffset, 0);
-
-    // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
-    // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
-    
-     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+    for (uint32_t i = firstDraw; i < firstDraw + drawCount; i++)
+    {
+        const DrawItem& draw = m_drawList[i];
+
+        // Bind the graphics pipeline
+        if (draw.pipeline != boundPipeline)
+        {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline);
+            boundPipeline = draw.pipeline;
+        }
+
+        // Set the stencil reference value (dynamic state in all the pipelines of this sample)
+        if (draw.stencilReference != stencilReference)
+        {
+            vkCmdSetStencilReference(cmd, VK_STENCIL_FACE_FRONT_BIT, draw.stencilReference);
+            stencilReference = draw.stencilReference;
+        }
+
+        // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
+        uint32_t dynamicOffset = draw.dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+
+        // Bind descriptor sets for drawing a mesh using a dynamic offset
+        vkCmdBindDescriptorSets(cmd, 
+                                VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                m_sampleParams.PipelineLayout, 
+                                0, 1, 
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                                1, &dynamicOffset);
+
+        // Draw the mesh
+        vkCmdDrawIndexed(cmd, draw.mesh->indexCount, 1, draw.mesh->firstIndex, draw.mesh->vertexOffset, 0);
+    }
 }
 
 void VKStenciling::SubmitCommandBuffer()
@@ -1313,13 +1275,13 @@ void VKStenciling::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKStenciling::PresentImage(uint32_t currentImageIndex)
@@ -1334,13 +1296,13 @@ void VKStenciling::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -0,0 +1,25 @@
+#version 450
+
+// Vertex shader of the normal lines generated by normals.comp (--normals compute):
+// the endpoints of the segments are in local space, so they only need to be transformed to clip space.
+
+layout (location = 0) in vec3 inPos;
+
+layout(std140, set = 0, binding = 0) uniform buf {
+    mat4 View;
+    mat4 Projection;
+    vec4 lightDir;
+    vec4 lightColor;
+} uBuf;
+
+layout(std140, set = 0, binding = 1) uniform dynbuf {
+    mat4 World;
+    vec4 solidColor;
+} dynBuf;
+
+void main()
+{
+    vec4 worldPos = dynBuf.World * vec4(inPos, 1.0);     // Local to World
+    vec4 viewPos = uBuf.View * worldPos;                 // World to View
+    gl_Position = uBuf.Projection * viewPos;             // View to Clip
+}
@@ -39,6 +39,14 @@ private:
     void CreatePipelineLayout();            // Create a pipeline layout
     void CreatePipelineObjects();           // Create a pipeline object
 
+    // Normal lines generated by a compute shader (--normals compute)
+    void CreateNormalLines();
+    void DestroyNormalLines();
+    void RecordNormalLines(VkCommandBuffer commandBuffer);
+
+    // Move the vertices of the sphere along their normals (--deform)
+    void DeformMesh();
+
     // Update buffer data
     void UpdateHostVisibleBufferData();
     void UpdateHostVisibleDynamicBufferData();
@@ -87,13 +95,20 @@ private:
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffer;
 
+    // How the normals of the triangles are drawn (--normals)
+    enum NormalsMode {
+        NORMALS_NONE,               // The normals are not drawn
+        NORMALS_GEOMETRY_SHADER,    // main.geom emits a line for each triangle drawn, every frame
+        NORMALS_COMPUTE             // normals.comp writes the lines to a vertex buffer when the mesh changes (see lines.vert)
+    };
+
     // Mesh object info
     struct MeshObject
     {
@@ -109,11 +124,39 @@ private:
     const unsigned int m_numDrawCalls = 2;
 
     // Mesh objects to draw
-    std::map<std::string, MeshObject> m_meshObjects;
+    VKHandleTable<MeshObject> m_meshObjects;
+
+    // Handles of the named pipelines, mesh objects and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineLambertian;
+    TableHandle m_pipelineSolidColor;
+    TableHandle m_pipelineNormalLines;
+    TableHandle m_meshSphere;
+    TableHandle m_descSetGraphics;
 
     // Sample members
     float m_curRotationAngleRad;
     size_t m_dynamicUBOAlignment;
+    NormalsMode m_normalsMode;
+    uint16_t m_sphereTessellation;                      // Tessellation of the sphere (--sphere-tessellation)
+    bool m_deform;
+
+    // Push constants of normals.comp
+    struct {
+        uint32_t triangleCount;
+        float lineLength;
+    } m_normalLinesConsts;
+
+    struct {
+        BufferParameters lines;                         // Two endpoints (vec4) per triangle, in device-local memory
+        std::vector<VkDescriptorSet> descriptorSets;
+        VkDescriptorSetLayout descriptorSetLayout;
+        VkPipelineLayout pipelineLayout;
+        VkPipeline pipeline;
+    } m_normalLinesParams;
+
+    uint64_t m_meshVersion;                             // Incremented every time the vertices of the sphere change
+    uint64_t m_normalLinesVersion;                      // Version of the mesh the normal lines were generated from
+    std::vector<BufferParameters> m_deformedVertices;   // Vertices of the deformed sphere of the frames in flight (--deform)
 
     // List of vertices and indices 
     std::vector<Vertex> vertices;
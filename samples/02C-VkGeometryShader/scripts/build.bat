@@ -13,7 +13,7 @@ if exist "%VULKAN_SDK%\Include\vulkan\vulkan.h" (
     SET VULKAN_INCLUDE=..\..\external\include\vulkan
 )
 
-SET includes=/I inc /I ..\..\external\include ^
+SET includes=/I inc /I ..\..\framework\inc /I ..\..\external\include ^
 /I %VULKAN_INCLUDE%
 
 SET defines=/D DEBUG /D _WIN32 /D VK_USE_PLATFORM_WIN32_KHR /D _CRT_SECURE_NO_WARNINGS
@@ -34,9 +34,11 @@ echo Compiling shader...
 ..\..\bin\glslangValidator -V -g .\data\shaders\main.geom -o .\data\shaders\main.geom.spv
 ..\..\bin\glslangValidator -V -g .\data\shaders\solid.frag -o .\data\shaders\solid.frag.spv
 ..\..\bin\glslangValidator -V -g .\data\shaders\lambertian.frag -o .\data\shaders\lambertian.frag.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\lines.vert -o .\data\shaders\lines.vert.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\normals.comp -o .\data\shaders\normals.comp.spv
 
 echo Building project...
 
-cl src/*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
+cl src/*.cpp ..\..\framework\src\*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
 
 del *.obj vc*.idb vc*.pdb
\ No newline at end of file
@@ -7,11 +7,11 @@ else
     VULKAN_INCLUDE=../../external/include/vulkan/
 fi
 
-includes="-Iinc -I../../external/include/ -I$VULKAN_INCLUDE"
+includes="-Iinc -I../../framework/inc -I../../external/include/ -I$VULKAN_INCLUDE"
 
 defines="-DDEBUG -DVK_USE_PLATFORM_XLIB_KHR"
 
-links="-lX11 -lvulkan"
+links="-L../../framework/lib -lvkframework -lX11 -lvulkan -lpthread"
 
 echo Compiling shader...
 
@@ -20,9 +20,16 @@ echo Compiling shader...
 /../../bin/glslangValidator -V -g ./data/shaders/main.geom -o ./data/shaders/main.geom.spv
 /../../bin/glslangValidator -V -g ./data/shaders/solid.frag -o ./data/shaders/solid.frag.spv
 /../../bin/glslangValidator -V -g ./data/shaders/lambertian.frag -o ./data/shaders/lambertian.frag.spv
+/../../bin/glslangValidator -V -g ./data/shaders/lines.vert -o ./data/shaders/lines.vert.spv
+/../../bin/glslangValidator -V -g ./data/shaders/normals.comp -o ./data/shaders/normals.comp.spv
+
+if [ "$SKIP_FRAMEWORK" != "1" ]; then
+    (cd ../../framework && bash scripts/build.sh) || exit 1
+fi
 
 echo Building project...
 
-g++ -g src/*.cpp -o 02C-VkGeometryShader.out $includes $defines $links
+source ../../scripts/compile.sh
 
-rm -f *.o
\ No newline at end of file
+compile_sources obj "$includes $defines" src/*.cpp || exit 1
+link_executable 02C-VkGeometryShader.out ../../framework/lib/libvkframework.a "$links" $OBJECTS || exit 1
\ No newline at end of file
@@ -10,13 +10,29 @@
 VKGeometryShader::VKGeometryShader(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
 m_curRotationAngleRad(0.0f),
-m_dynamicUBOAlignment(0)
+m_dynamicUBOAlignment(0),
+m_normalsMode(NORMALS_GEOMETRY_SHADER),
+m_sphereTessellation(20),
+m_deform(false),
+m_meshVersion(0),
+m_normalLinesVersion(UINT64_MAX)
 {
+    // Register the named pipelines, mesh objects and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineLambertian = m_sampleParams.Pipelines.Register("Lambertian");
+    m_pipelineSolidColor = m_sampleParams.Pipelines.Register("SolidColor");
+    m_pipelineNormalLines = m_sampleParams.Pipelines.Register("NormalLines");
+    m_meshSphere = m_meshObjects.Register("sphere");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
+
     // Initialize the pointer to the memory region that will store the array of world matrices.
     dynUBufVS.meshInfo = nullptr;
 
+    m_normalLinesParams.descriptorSetLayout = VK_NULL_HANDLE;
+    m_normalLinesParams.pipelineLayout = VK_NULL_HANDLE;
+    m_normalLinesParams.pipeline = VK_NULL_HANDLE;
+
     // Initialize mesh objects
-    m_meshObjects["sphere"] = {};
+    m_meshObjects[m_meshSphere] = {};
 
     // Initialize the view matrix
     glm::vec3 c_pos = { 0.0f, -10.0f, 2.0f };
@@ -40,9 +56,42 @@ VKGeometryShader::~VKGeometryShader()
 
 void VKGeometryShader::OnInit()
 {
+    // --normals selects how the normals of the triangles are drawn (none, gs or compute): by the geometry shader for
+    // every triangle in every frame (as in the tutorial), or as a list of lines generated by a compute shader only when
+    // the mesh changes. --sphere-tessellation sets the number of stacks of the sphere (twice as many slices), and
+    // --deform moves its vertices every frame, so that the normal lines need to be generated again.
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--normals") == 0 && i + 1 < args.size())
+        {
+            const char* mode = args[++i];
+            if (strcmp(mode, "none") == 0)
+                m_normalsMode = NORMALS_NONE;
+            else if (strcmp(mode, "gs") == 0)
+                m_normalsMode = NORMALS_GEOMETRY_SHADER;
+            else if (strcmp(mode, "compute") == 0)
+                m_normalsMode = NORMALS_COMPUTE;
+            else
+                printf("Unknown normals mode: %s (available modes: none, gs, compute)\n", mode);
+        }
+        else if (strcmp(args[i], "--sphere-tessellation") == 0 && i + 1 < args.size())
+        {
+            // (T + 1) * (2T + 1) vertices must be addressable with 16-bit indices
+            unsigned long tessellation = strtoul(args[++i], nullptr, 10);
+            m_sphereTessellation = static_cast<uint16_t>(std::min(std::max(tessellation, 3ul), 180ul));
+        }
+        else if (strcmp(args[i], "--deform") == 0)
+            m_deform = true;
+    }
+
     InitVulkan();
     SetupPipeline();
 
+    const char* modeNames[] = { "none", "geometry shader", "compute shader" };
+    printf("Normals: %s, %u triangles, %s sphere\n", modeNames[m_normalsMode], 
+           m_meshObjects[m_meshSphere].indexCount / 3, m_deform ? "deforming" : "static");
+
     // Update buffer data (light direction and color, plus view and projection matrices)
     UpdateHostVisibleBufferData();
 }
@@ -53,6 +102,21 @@ void VKGeometryShader::InitVulkan()
     CreateSurface();
     CreateDevice(VK_QUEUE_GRAPHICS_BIT);
     GetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.FamilyIndex, m_vulkanParams.GraphicsQueue.Handle);
+
+    // The normal lines are generated by a compute shader dispatched on the graphics queue
+    if (m_normalsMode == NORMALS_COMPUTE)
+    {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanParams.PhysicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanParams.PhysicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+
+        if (!(queueFamilyProperties[m_vulkanParams.GraphicsQueue.FamilyIndex].queueFlags & VK_QUEUE_COMPUTE_BIT))
+        {
+            printf("The graphics queue doesn't support compute operations: the normals are drawn by the geometry shader\n");
+            m_normalsMode = m_vulkanParams.EnabledFeatures.geometryShader ? NORMALS_GEOMETRY_SHADER : NORMALS_NONE;
+        }
+    }
     CreateSwapchain(&m_width, &m_height, VKApplication::settings.vsync);
     CreateDepthStencilImage(m_width, m_height);
     CreateRenderPass();
@@ -70,18 +134,23 @@ void VKGeometryShader::SetupPipeline()
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    if (m_normalsMode == NORMALS_COMPUTE)
+        CreateNormalLines();
+    ReportPipelineCreationTime();
 
     m_initialized = true;
 }
 
 void VKGeometryShader::EnableFeatures(VkPhysicalDeviceFeatures& features)
 {
+    // Geometry shaders are only required to draw the normals with main.geom
     if (m_deviceFeatures.geometryShader)
     {
         m_vulkanParams.EnabledFeatures.geometryShader = VK_TRUE;
     }
-    else
+    else if (m_normalsMode == NORMALS_GEOMETRY_SHADER)
     {
         assert(!"Selected device does not support geometry shaders!");
     }
@@ -103,17 +172,19 @@ void VKGeometryShader::OnUpdate()
 // Render the scene.
 void VKGeometryShader::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
+    // The vertex buffer of the frame is no longer in use by the GPU, so it can be updated
+    if (m_deform)
+        DeformMesh();
+
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -129,7 +200,7 @@ void VKGeometryShader::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKGeometryShader::OnDestroy()
@@ -139,25 +210,35 @@ void VKGeometryShader::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffer.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffer.IBmemory);
 
-    // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (BufferParameters& deformedVertices : m_deformedVertices)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
+        vkDestroyBuffer(m_vulkanParams.Device, deformedVertices.Handle, nullptr);
+        m_memAllocator.Free(deformedVertices.Allocation);
+    }
+
+    if (m_normalsMode == NORMALS_COMPUTE)
+        DestroyNormalLines();
 
+    // Destroy\Unmap frame resources
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
+    {
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Destroy dynamic buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -165,7 +246,7 @@ void VKGeometryShader::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
@@ -176,8 +257,8 @@ void VKGeometryShader::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.GraphicsPipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -188,30 +269,45 @@ void VKGeometryShader::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -220,8 +316,12 @@ void VKGeometryShader::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -247,10 +347,10 @@ void VKGeometryShader::CreateVertexBuffer()
     // Create the vertex and index buffers.
     //
 
-    ComputeSphere(vertices, indices, 5, 20);
+    ComputeSphere(vertices, indices, 5, m_sphereTessellation);
 
-    m_meshObjects["sphere"].vertexCount = vertices.size();
-    m_meshObjects["sphere"].indexCount = indices.size();
+    m_meshObjects[m_meshSphere].vertexCount = vertices.size();
+    m_meshObjects[m_meshSphere].indexCount = indices.size();
     size_t vertexBufferSize = vertices.size() * sizeof(Vertex);
     size_t indexBufferSize = indices.size() * sizeof(uint16_t);
 
@@ -259,57 +359,77 @@ void VKGeometryShader::CreateVertexBuffer()
     // This is not recommended as it can result in lower rendering performance.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     vertexBufferInfo.size = vertexBufferSize;
-    vertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;    
+    // The compute shader generating the normal lines reads the vertex and index buffers as storage buffers.
+    vertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &vertexBufferInfo, nullptr, &m_vertexindexBuffer.VBbuffer));
 
     // Request a memory allocation from coherent, host-visible device memory that is large 
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.VBmemory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, vertices.data(), vertexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBmemory);
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.VBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.VBmemory);
 
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.VBbuffer, m_vertexindexBuffer.VBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.VBmemory.MappedMemory, vertices.data(), vertexBufferSize);
 
     // Create the index buffer object
     VkBufferCreateInfo indexBufferInfo = {};
     indexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    indexBufferInfo.size = vertexBufferSize;
-    indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;    
+    indexBufferInfo.size = indexBufferSize;
+    indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &indexBufferInfo, nullptr, &m_vertexindexBuffer.IBbuffer));
 
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffer.IBmemory));
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffer.IBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffer.IBmemory);
+
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffer.IBmemory.MappedMemory, indices.data(), indexBufferSize);
+
+    // With --deform each frame in flight draws its own copy of the vertices, moved by DeformMesh
+    if (m_deform)
+    {
+        vertexBufferInfo.size = vertexBufferSize;
+        m_deformedVertices.resize(m_framesInFlight);
+        for (size_t i = 0; i < m_framesInFlight; i++)
+        {
+            CreateBuffer(m_memAllocator, vertexBufferInfo, m_deformedVertices[i], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            memcpy(m_deformedVertices[i].MappedMemory, vertices.data(), vertexBufferSize);
+
+            m_deformedVertices[i].Descriptor.buffer = m_deformedVertices[i].Handle;
+            m_deformedVertices[i].Descriptor.offset = 0;
+            m_deformedVertices[i].Descriptor.range = vertexBufferSize;
+        }
+    }
+}
 
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, indices.data(), indexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBmemory);
+// Scale the sphere along the normals by a factor that depends on the latitude and on time: 1 + a * sin(k * n.z + w * t).
+// The radius only depends on n.z, so the normals can be computed analytically: for a surface r(phi) * n, the normal is
+// r * n - dr/dphi * u_phi, where cos(phi) * u_phi = z - n.z * n (which is why there's no singularity at the poles).
+void VKGeometryShader::DeformMesh()
+{
+    const float amplitude = 0.08f;
+    const float frequency = 6.0f;
+    const float speed = 3.0f;
+    const float t = static_cast<float>(m_timer.GetTotalSeconds());
+
+    Vertex* deformedVertices = static_cast<Vertex*>(m_deformedVertices[m_frameIndex].MappedMemory);
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const glm::vec3& n = vertices[i].normal;
+        float angle = frequency * n.z + speed * t;
+        float scale = 1.0f + amplitude * glm::sin(angle);
+        float radius = glm::length(vertices[i].position);
+
+        // dr/dphi = radius * amplitude * frequency * cos(angle) * cos(phi)
+        glm::vec3 tangent = glm::vec3(0.0f, 0.0f, 1.0f) - n.z * n;
+        deformedVertices[i].position = vertices[i].position * scale;
+        deformedVertices[i].normal = glm::normalize(radius * scale * n - radius * amplitude * frequency * glm::cos(angle) * tangent);
+    }
 
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffer.IBbuffer, m_vertexindexBuffer.IBmemory, 0));
+    m_meshVersion++;
 }
 
 void VKGeometryShader::ComputeSphere(std::vector<Vertex>& vertices, std::vector<uint16_t>& indices, float diameter, uint16_t tessellation)
@@ -415,15 +535,14 @@ void VKGeometryShader::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -459,15 +578,14 @@ void VKGeometryShader::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -486,7 +604,7 @@ void VKGeometryShader::UpdateHostVisibleBufferData()
 {
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
         memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
@@ -502,13 +620,13 @@ void VKGeometryShader::UpdateHostVisibleDynamicBufferData()
     }
 
     // Rotate the sphere at the center of the scene around the z-axis
-    m_meshObjects["sphere"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                        (m_meshObjects["sphere"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshSphere].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
+                                        (m_meshObjects[m_meshSphere].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
     glm::mat4 rotZ = glm::rotate(glm::identity<glm::mat4>(), m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
-    m_meshObjects["sphere"].meshInfo->worldMatrix = rotZ;
+    m_meshObjects[m_meshSphere].meshInfo->worldMatrix = rotZ;
 
     // Set yellow as solid color for drawing the normals
-    m_meshObjects["sphere"].meshInfo->solidColor = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
+    m_meshObjects[m_meshSphere].meshInfo->solidColor = glm::vec4(1.0f, 1.0f, 0.0f, 1.0f);
 
     // Update dynamic uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
@@ -526,22 +644,27 @@ void VKGeometryShader::CreateDescriptorPool()
     //
 
     // Describe the number of descriptors per type.
-    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer)
-    VkDescriptorPoolSize typeCounts[2];
+    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer), plus the storage buffers
+    // of the compute shader generating the normal lines (vertices, indices and lines for each frame in flight).
+    VkDescriptorPoolSize typeCounts[3];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
+    typeCounts[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    typeCounts[2].descriptorCount = static_cast<uint32_t>(3 * m_framesInFlight);
+
+    const bool computeNormals = (m_normalsMode == NORMALS_COMPUTE);
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
     VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
     descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptorPoolInfo.pNext = nullptr;
-    descriptorPoolInfo.poolSizeCount = 2;
+    descriptorPoolInfo.poolSizeCount = computeNormals ? 3 : 2;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(computeNormals ? 2 * m_framesInFlight : m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -578,17 +701,17 @@ void VKGeometryShader::CreateDescriptorSetLayout()
 
 void VKGeometryShader::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -597,13 +720,13 @@ void VKGeometryShader::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[2] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -611,7 +734,7 @@ void VKGeometryShader::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
@@ -764,6 +887,7 @@ void VKGeometryShader::CreatePipelineObjects()
     //
     VkShaderModule mainVS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/main.vert.spv");
     VkShaderModule passThroughVS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/passthrough.vert.spv");
+    VkShaderModule linesVS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/lines.vert.spv");
     VkShaderModule mainGS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/main.geom.spv");
     VkShaderModule lambertianFS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/lambertian.frag.spv");
     VkShaderModule solidFS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/solid.frag.spv");
@@ -832,9 +956,9 @@ void VKGeometryShader::CreatePipelineObjects()
     
     // Create a graphics pipeline for lambertian illumination
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["Lambertian"]));
+                                              &m_sampleParams.Pipelines[m_pipelineLambertian]));
 
     //
     // SolidColor
@@ -846,10 +970,35 @@ void VKGeometryShader::CreatePipelineObjects()
     shaderStages[1].module = solidFS;
     shaderStages[2].module = mainGS;
     // Create a graphics pipeline to draw using a solid color
-    VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
-                                              &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["SolidColor"]));
+    if (m_normalsMode == NORMALS_GEOMETRY_SHADER)
+    {
+        VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
+                                                  m_pipelineCache, 1, 
+                                                  &pipelineCreateInfo, nullptr, 
+                                                  &m_sampleParams.Pipelines[m_pipelineSolidColor]));
+    }
+
+    //
+    // NormalLines
+    //
+
+    // Draw the list of lines generated by normals.comp with a solid color and no geometry shader.
+    // The endpoints of the lines are vec4 positions (stride: 16 bytes), of which the vertex shader only reads xyz.
+    if (m_normalsMode == NORMALS_COMPUTE)
+    {
+        vertexInputBinding.stride = sizeof(glm::vec4);
+        vertexInputAttributs[0].offset = 0;
+        vertexInputState.vertexAttributeDescriptionCount = 1;
+        inputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+
+        pipelineCreateInfo.stageCount = 2;
+        shaderStages[0].module = linesVS;
+        shaderStages[1].module = solidFS;
+        VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
+                                                  m_pipelineCache, 1, 
+                                                  &pipelineCreateInfo, nullptr, 
+                                                  &m_sampleParams.Pipelines[m_pipelineNormalLines]));
+    }
 
     //
     // Destroy shader modules
@@ -859,11 +1008,165 @@ void VKGeometryShader::CreatePipelineObjects()
     // since the SPIR-V modules are compiled during pipeline creation.
     vkDestroyShaderModule(m_vulkanParams.Device, mainVS, nullptr);
     vkDestroyShaderModule(m_vulkanParams.Device, passThroughVS, nullptr);
+    vkDestroyShaderModule(m_vulkanParams.Device, linesVS, nullptr);
     vkDestroyShaderModule(m_vulkanParams.Device, mainGS, nullptr);
     vkDestroyShaderModule(m_vulkanParams.Device, lambertianFS, nullptr);
     vkDestroyShaderModule(m_vulkanParams.Device, solidFS, nullptr);
 }
 
+void VKGeometryShader::CreateNormalLines()
+{
+    m_normalLinesConsts.triangleCount = m_meshObjects[m_meshSphere].indexCount / 3;
+    m_normalLinesConsts.lineLength = 0.3f;  // Same length as in main.geom
+
+    //
+    // Line buffer, written by the compute shader and read as a vertex buffer
+    //
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = 2 * static_cast<VkDeviceSize>(m_normalLinesConsts.triangleCount) * sizeof(glm::vec4);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    CreateBuffer(m_memAllocator, bufferInfo, m_normalLinesParams.lines, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    m_normalLinesParams.lines.Descriptor.buffer = m_normalLinesParams.lines.Handle;
+    m_normalLinesParams.lines.Descriptor.offset = 0;
+    m_normalLinesParams.lines.Descriptor.range = bufferInfo.size;
+
+    //
+    // Descriptor set layout and descriptor sets of the compute shader
+    //
+    // Binding 0: Vertices
+    // Binding 1: Indices
+    // Binding 2: Lines
+    VkDescriptorSetLayoutBinding layoutBinding[3] = {};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        layoutBinding[i].binding = i;
+        layoutBinding[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        layoutBinding[i].descriptorCount = 1;
+        layoutBinding[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
+    descriptorLayout.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorLayout.bindingCount = 3;
+    descriptorLayout.pBindings = layoutBinding;
+    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_normalLinesParams.descriptorSetLayout));
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> descriptorSetLayouts(m_framesInFlight, m_normalLinesParams.descriptorSetLayout);
+    allocInfo.pSetLayouts = descriptorSetLayouts.data();
+
+    m_normalLinesParams.descriptorSets.resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_normalLinesParams.descriptorSets.data()));
+
+    // The vertices are read from the vertex buffer of the frame if the sphere is deformed
+    VkDescriptorBufferInfo vertexDescriptor = { m_vertexindexBuffer.VBbuffer, 0, VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo indexDescriptor = { m_vertexindexBuffer.IBbuffer, 0, VK_WHOLE_SIZE };
+
+    for (size_t i = 0; i < m_framesInFlight; i++)
+    {
+        const VkDescriptorBufferInfo* bufferDescriptors[3] = {
+            m_deform ? &m_deformedVertices[i].Descriptor : &vertexDescriptor,
+            &indexDescriptor,
+            &m_normalLinesParams.lines.Descriptor
+        };
+
+        VkWriteDescriptorSet writeDescriptorSet[3] = {};
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            writeDescriptorSet[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSet[j].dstSet = m_normalLinesParams.descriptorSets[i];
+            writeDescriptorSet[j].descriptorCount = 1;
+            writeDescriptorSet[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeDescriptorSet[j].pBufferInfo = bufferDescriptors[j];
+            writeDescriptorSet[j].dstBinding = j;
+        }
+
+        vkUpdateDescriptorSets(m_vulkanParams.Device, 3, writeDescriptorSet, 0, nullptr);
+    }
+
+    //
+    // Pipeline layout and compute pipeline
+    //
+    // The number of triangles and the length of the lines are passed as push constants
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(m_normalLinesConsts);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &m_normalLinesParams.descriptorSetLayout;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+    VK_CHECK_RESULT(vkCreatePipelineLayout(m_vulkanParams.Device, &pipelineLayoutCreateInfo, nullptr, &m_normalLinesParams.pipelineLayout));
+
+    VkShaderModule normalsCS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/normals.comp.spv");
+
+    VkPipelineShaderStageCreateInfo shaderStage = {};
+    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStage.module = normalsCS;
+    shaderStage.pName = "main";
+    assert(shaderStage.module != VK_NULL_HANDLE);
+
+    VkComputePipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.layout = m_normalLinesParams.pipelineLayout;
+    pipelineCreateInfo.stage = shaderStage;
+    VK_CHECK_RESULT(vkCreateComputePipelines(m_vulkanParams.Device, 
+                                              m_pipelineCache, 1, 
+                                              &pipelineCreateInfo, nullptr, 
+                                              &m_normalLinesParams.pipeline));
+
+    vkDestroyShaderModule(m_vulkanParams.Device, normalsCS, nullptr);
+}
+
+void VKGeometryShader::DestroyNormalLines()
+{
+    vkDestroyPipeline(m_vulkanParams.Device, m_normalLinesParams.pipeline, nullptr);
+    vkDestroyPipelineLayout(m_vulkanParams.Device, m_normalLinesParams.pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_normalLinesParams.descriptorSetLayout, nullptr);
+
+    vkDestroyBuffer(m_vulkanParams.Device, m_normalLinesParams.lines.Handle, nullptr);
+    m_memAllocator.Free(m_normalLinesParams.lines.Allocation);
+}
+
+void VKGeometryShader::RecordNormalLines(VkCommandBuffer commandBuffer)
+{
+    // The lines being overwritten may still be read as vertex buffer by the draws of the previous frames:
+    // wait for them to be done with the vertex input stage (write-after-read hazards only need an execution dependency).
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                         0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    // One invocation per triangle
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_normalLinesParams.pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_normalLinesParams.pipelineLayout, 
+                            0, 1, &m_normalLinesParams.descriptorSets[m_frameIndex], 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_normalLinesParams.pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 
+                       0, sizeof(m_normalLinesConsts), &m_normalLinesConsts);
+    vkCmdDispatch(commandBuffer, (m_normalLinesConsts.triangleCount + 63) / 64, 1, 1);
+
+    // Make the lines written by the compute shader visible to the vertex input stage
+    VkBufferMemoryBarrier bufferBarrier = {};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = m_normalLinesParams.lines.Handle;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 
+                         0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+}
+
 void VKGeometryShader::PopulateCommandBuffer(uint32_t currentImageIndex)
 {
     VkCommandBufferBeginInfo cmdBufInfo = {};
@@ -890,11 +1193,18 @@ void VKGeometryShader::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
+
+    // Generate the normal lines if the mesh changed since the last time (dispatches can't be recorded in a render pass)
+    if (m_normalsMode == NORMALS_COMPUTE && m_normalLinesVersion != m_meshVersion)
+    {
+        RecordNormalLines(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
+        m_normalLinesVersion = m_meshVersion;
+    }
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -902,7 +1212,7 @@ void VKGeometryShader::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -910,14 +1220,15 @@ void VKGeometryShader::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
     
-    // Bind the vertex buffer (contains positions and normals)
+    // Bind the vertex buffer (contains positions and normals), or the one of the frame if the sphere is deformed
     VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffer.VBbuffer, offsets);
+    VkBuffer vertexBuffer = m_deform ? m_deformedVertices[m_frameIndex].Handle : m_vertexindexBuffer.VBbuffer;
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &vertexBuffer, offsets);
 
     // Bind the index buffer
-	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
+	vkCmdBindIndexBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffer.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
 
     // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
 
@@ -925,43 +1236,57 @@ void VKGeometryShader::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Sphere
     //
 
-    uint32_t dynamicOffset = m_meshObjects["sphere"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+    uint32_t dynamicOffset = m_meshObjects[m_meshSphere].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
 
     // Bind the graphics pipeline for drawing with the semplified lambertian shading model
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                         VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                        m_sampleParams.GraphicsPipelines["Lambertian"]);
+                        m_sampleParams.Pipelines[m_pipelineLambertian]);
 
     // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                             VK_PIPELINE_BIND_POINT_GRAPHICS, 
                             m_sampleParams.PipelineLayout, 
                             0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
                             1, &dynamicOffset);
 
     // Draw the sphere using the lambertian shading model
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_meshObjects["sphere"].indexCount, 1, 0, 0, 0);
+    vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[m_meshSphere].indexCount, 1, 0, 0, 0);
 
     //
-    // Draw the sphere a second time passing its triangles to the geometry shader,
-    // which will emit line segments representing the normals of the input triangles.
+    // Draw the normals of the triangles of the sphere: either draw the sphere a second time passing its triangles
+    // to the geometry shader, which will emit line segments representing the normals of the input triangles, or
+    // draw the line segments generated by the compute shader.
     //
 
-    // Bind the graphics pipeline for drawing opaque objects with a solid color, 
-    // passing through a geometry shader that emits lines from triangles
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                    VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                    m_sampleParams.GraphicsPipelines["SolidColor"]);
+    if (m_normalsMode == NORMALS_GEOMETRY_SHADER)
+    {
+        // Bind the graphics pipeline for drawing opaque objects with a solid color, 
+        // passing through a geometry shader that emits lines from triangles
+        vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                        m_sampleParams.Pipelines[m_pipelineSolidColor]);
 
-    // Draw the sphere
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_meshObjects["sphere"].indexCount, 1, 0, 0, 0);
+        // Draw the sphere
+        vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[m_meshSphere].indexCount, 1, 0, 0, 0);
+    }
+    else if (m_normalsMode == NORMALS_COMPUTE)
+    {
+        // Draw the line segments generated by the compute shader (two vertices per triangle) with the same solid color
+        vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                        m_sampleParams.Pipelines[m_pipelineNormalLines]);
+
+        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_normalLinesParams.lines.Handle, offsets);
+        vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 2 * m_normalLinesConsts.triangleCount, 1, 0, 0);
+    }
 
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
     
-    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKGeometryShader::SubmitCommandBuffer()
@@ -974,13 +1299,13 @@ void VKGeometryShader::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKGeometryShader::PresentImage(uint32_t currentImageIndex)
@@ -995,13 +1320,13 @@ void VKGeometryShader::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -0,0 +1,27 @@
+#version 450
+
+// Pass the particles through to emit.geom, which updates them and captures the result with transform feedback (--emit)
+
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec2 inSize;
+layout (location = 2) in float inSpeed;
+layout (location = 3) in float inAge;
+layout (location = 4) in uint inType;
+
+layout (location = 0) out outVS
+{
+    vec3 outPos;
+    vec2 outSize;
+    float outSpeed;
+    float outAge;
+    uint outType;
+};
+
+void main()
+{
+    outPos = inPos;
+    outSize = inSize;
+    outSpeed = inSpeed;
+    outAge = inAge;
+    outType = inType;
+}
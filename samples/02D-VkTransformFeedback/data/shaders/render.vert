@@ -3,18 +3,22 @@
 layout (location = 0) in vec3 inPos;
 layout (location = 1) in vec2 inSize;
 layout (location = 2) in float inSpeed;
+layout (location = 3) in float inAge;
+layout (location = 4) in uint inType;
 
 layout (location = 0) out outVS
 {
     vec3 outPos;
     vec2 outSize;
     float outSpeed;
+    uint outType;
 };
 
 // Equivalent to:
 // layout (location = 0) out vec3 outPos;
 // layout (location = 1) out vec2 outSize;
 // layout (location = 2) out float outSpeed;
+// layout (location = 3) out uint outType;
 
 void main()
 {
@@ -23,4 +27,5 @@ void main()
     outPos = inPos;
     outSize = inSize;
     outSpeed = inSpeed;
+    outType = inType;
 }
\ No newline at end of file
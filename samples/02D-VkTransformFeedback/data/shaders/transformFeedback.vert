@@ -3,20 +3,26 @@
 layout (location = 0) in vec3 inPos;
 layout (location = 1) in vec2 inSize;
 layout (location = 2) in float inSpeed;
+layout (location = 3) in float inAge;
+layout (location = 4) in uint inType;
 
 // all xfb_ layout qualifiers except xfb_offset can be omitted in this case 
 // (xfb_buffer = 0 global default, xfb_stride can be inferred)
-layout(location = 0, xfb_buffer = 0, xfb_offset = 0, xfb_stride = 24) out outVS
+layout(location = 0, xfb_buffer = 0, xfb_offset = 0, xfb_stride = 32) out outVS
 {
     vec3 outPos;    // location 0, TF buffer 0, offset = 0
     vec2 outSize;   // location 1, TF buffer 0, offset = 12
     float outSpeed; // location 2, TF buffer 0, offset = 20
+    float outAge;   // location 3, TF buffer 0, offset = 24
+    uint outType;   // location 4, TF buffer 0, offset = 28
 }; // If no instance name is defined, the variables in the block are scoped at the global level
 
 // Equivalent to:
 //layout (location = 0, xfb_buffer = 0, xfb_offset = 0) out vec3 outPos;
 //layout (location = 1, xfb_buffer = 0, xfb_offset = 12) out vec2 outSize;
 //layout (location = 2, xfb_buffer = 0, xfb_offset = 20) out float outSpeed;
+//layout (location = 3, xfb_buffer = 0, xfb_offset = 24) out float outAge;
+//layout (location = 4, xfb_buffer = 0, xfb_offset = 28) out uint outType;
 
 layout(std140, set = 0, binding = 0) uniform buf {
     mat4 viewMatrix;
@@ -46,4 +52,6 @@ void main()
 
     outSize = inSize;
     outSpeed = inSpeed;
+    outAge = inAge + uBuf.deltaTime;
+    outType = inType;
 }
\ No newline at end of file
@@ -6,6 +6,9 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "glm/glm.hpp"
 
+// Number of particles simulated if not specified on the command line (--particles N)
+#define DEFAULT_PARTICLE_COUNT 81
+
 class VKTransformFeedback : public VKSample
 {
 public:
@@ -34,6 +37,7 @@ private:
     PFN_vkCmdEndTransformFeedbackEXT             vkCmdEndTransformFeedbackEXT;
     PFN_vkCmdDrawIndirectByteCountEXT            vkCmdDrawIndirectByteCountEXT;
     VkPhysicalDeviceTransformFeedbackFeaturesEXT featuresTF;
+    VkPhysicalDeviceTransformFeedbackPropertiesEXT propertiesTF;
     
     void PopulateCommandBuffer(uint32_t currentImageIndex);
     void SubmitCommandBuffer();
@@ -59,6 +63,7 @@ private:
     //     mat4 Projection;
     //     vec3 cameraPos;
     //     float deltaTime;
+    //     vec4 emitParams;
     // } uBuf;
     //
     // This way we can just memcopy the uBufVS data to match the uBuf memory layout.
@@ -68,6 +73,7 @@ private:
         glm::mat4 projectionMatrix;   // 64 bytes
         glm::vec3 cameraPos;          // 12 bytes
         float     deltaTime;          // 4 bytes
+        glm::vec4 emitParams;         // 16 bytes (x: seconds between two raindrops spawned by an emitter, y: time, z: size of the area covered by an emitter)
     } uBufVS;
 
     // Uniform block defined in the vertex shader to be used as a dynamic uniform buffer:
@@ -88,18 +94,25 @@ private:
         MeshInfo *meshInfo;        // pointer to an array of mesh info
     } dynUBufVS;
     
-    // Vertex layout used in this sample (stride: 24 bytes)
+    // Vertex layout used in this sample (stride: 32 bytes)
     struct Vertex {
         glm::vec3 position;
         glm::vec2 size;
         float     speed;
+        float     age;      // Time since the spawn of a raindrop, or since the last emission of an emitter
+        uint32_t  type;     // PARTICLE_RAINDROP or PARTICLE_EMITTER
+    };
+
+    enum ParticleType {
+        PARTICLE_RAINDROP,
+        PARTICLE_EMITTER    // Spawns raindrops and is never drawn (--emit)
     };
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffers;
@@ -119,7 +132,13 @@ private:
     const unsigned int m_numDrawCalls = 2;
 
     // Mesh objects to draw
-    std::map<std::string, MeshObject> m_meshObjects;
+    VKHandleTable<MeshObject> m_meshObjects;
+
+    // Handles of the named pipelines, mesh objects and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineTransformFeedback;
+    TableHandle m_pipelineRainfall;
+    TableHandle m_meshParticleGrid;
+    TableHandle m_descSetGraphics;
 
     // Sample members
     size_t m_dynamicUBOAlignment;
@@ -130,11 +149,33 @@ private:
     // Create buffers for the Transform Feedback stage
     void CreateTransformFeedbackBuffers();
 
-    // Transform Feedback buffers
-    struct {
-        VkDeviceMemory TFmemory;        // Handle to the device memory backing the Transform Feedback buffer
+    // Transform Feedback buffers.
+    // There are two streams used in turn: each frame draws the particles in one of them, and captures the updated
+    // particles in the other one, so that a draw never reads the buffer it writes.
+    struct TransformFeedbackBuffers {
+        MemoryAllocation TFmemory;        // Device memory (sub-allocation) backing the Transform Feedback buffer
         VkBuffer TFbuffer;              // Handle to the Transform Feedback buffer
-        VkDeviceMemory CounterMemory;   // Handle to the device memory backing the Counter buffer
-        VkBuffer CounterBuffer;         // Handle to the Counter buffer
-    } m_transformFeedbackBuffers;
+        MemoryAllocation CounterMemory;   // Device memory (sub-allocation) backing the Counter buffer
+        VkBuffer CounterBuffer;         // Handle to the Counter buffer (number of bytes captured in the Transform Feedback buffer)
+    } m_transformFeedbackBuffers[2];
+
+    static const uint32_t s_raindropsPerEmitter = 64;   // Raindrops alive at the same time for each emitter, on average
+    static const uint32_t s_maxEmittedPerFrame = 8;     // Raindrops an emitter can spawn in a frame (MAX_EMITTED in emit.geom)
+
+    uint32_t m_particleCount;                           // Number of raindrops at launch (--particles N)
+    bool m_emit;                                        // Emitters spawn the raindrops, which die when they leave the volume (--emit)
+    uint32_t m_emitterCount;
+    uint32_t m_streamCapacity;                          // Max number of particles in a stream
+    uint32_t m_inputStream;                             // Stream drawn by the next frame (the other one is written)
+    bool m_streamsInitialized;                          // False until the initial particles have been captured in a stream
+
+    // The number of live particles is copied from the counter buffer of the frame to a host-visible buffer, and read
+    // only when the fence of the frame is signaled: the CPU never waits for it.
+    void ReadLiveParticleCount(uint32_t frameIndex);
+    std::vector<BufferParameters> m_liveCountReadback;
+    std::vector<bool> m_liveCountPending;
+    uint32_t m_liveCountMin;
+    uint32_t m_liveCountMax;
+    uint64_t m_liveCountSum;
+    uint64_t m_liveCountSamples;
 };
\ No newline at end of file
@@ -7,21 +7,28 @@ else
     VULKAN_INCLUDE=../../external/include/vulkan/
 fi
 
-includes="-Iinc -I../../external/include/ -I$VULKAN_INCLUDE"
+includes="-Iinc -I../../framework/inc -I../../external/include/ -I$VULKAN_INCLUDE"
 
 defines="-DDEBUG -DVK_USE_PLATFORM_XLIB_KHR"
 
-links="-lX11 -lvulkan"
+links="-L../../framework/lib -lvkframework -lX11 -lvulkan -lpthread"
 
 echo Compiling shader...
 
 /../../bin/glslangValidator -V -g ./data/shaders/transformFeedback.vert -o ./data/shaders/transformFeedback.vert.spv
+/../../bin/glslangValidator -V -g ./data/shaders/emit.vert -o ./data/shaders/emit.vert.spv
+/../../bin/glslangValidator -V -g ./data/shaders/emit.geom -o ./data/shaders/emit.geom.spv
 /../../bin/glslangValidator -V -g ./data/shaders/render.vert -o ./data/shaders/render.vert.spv
 /../../bin/glslangValidator -V -g ./data/shaders/render.geom -o ./data/shaders/render.geom.spv
 /../../bin/glslangValidator -V -g ./data/shaders/render.frag -o ./data/shaders/render.frag.spv
 
+if [ "$SKIP_FRAMEWORK" != "1" ]; then
+    (cd ../../framework && bash scripts/build.sh) || exit 1
+fi
+
 echo Building project...
 
-g++ -g src/*.cpp -o 02D-VkTransformFeedback.out $includes $defines $links
+source ../../scripts/compile.sh
 
-rm -f *.o
\ No newline at end of file
+compile_sources obj "$includes $defines" src/*.cpp || exit 1
+link_executable 02D-VkTransformFeedback.out ../../framework/lib/libvkframework.a "$links" $OBJECTS || exit 1
\ No newline at end of file
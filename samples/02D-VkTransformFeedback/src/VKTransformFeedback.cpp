@@ -10,10 +10,27 @@
 VKTransformFeedback::VKTransformFeedback(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
 m_dynamicUBOAlignment(0),
-featuresTF{}
+featuresTF{},
+propertiesTF{},
+m_particleCount(DEFAULT_PARTICLE_COUNT),
+m_emit(false),
+m_emitterCount(0),
+m_streamCapacity(0),
+m_inputStream(0),
+m_streamsInitialized(false),
+m_liveCountMin(UINT32_MAX),
+m_liveCountMax(0),
+m_liveCountSum(0),
+m_liveCountSamples(0)
 {
+    // Register the named pipelines, mesh objects and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineTransformFeedback = m_sampleParams.Pipelines.Register("TransformFeedback");
+    m_pipelineRainfall = m_sampleParams.Pipelines.Register("Rainfall");
+    m_meshParticleGrid = m_meshObjects.Register("particleGrid");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
+
     // Initialize mesh objects
-    m_meshObjects["particleGrid"] = {};
+    m_meshObjects[m_meshParticleGrid] = {};
 
     // Initialize the pointer to the memory region that will store the array of world matrices.
     dynUBufVS.meshInfo = nullptr;
@@ -29,6 +46,9 @@ featuresTF{}
 
     // Initialize the projection matrix by setting the frustum information
     uBufVS.projectionMatrix = glm::perspectiveLH(glm::quarter_pi<float>(), (float)width/height, 0.01f, 100.0f);
+
+    uBufVS.deltaTime = 0.0f;
+    uBufVS.emitParams = glm::vec4(0.0f);
 }
 
 VKTransformFeedback::~VKTransformFeedback()
@@ -39,8 +59,25 @@ VKTransformFeedback::~VKTransformFeedback()
 
 void VKTransformFeedback::OnInit()
 {
+    // The number of raindrops can be specified on the command line (--particles N), as in the compute particles
+    // sample (02.G). With --emit the raindrops are spawned by emitters and die when they leave the volume, instead of
+    // being moved back to the top, so that the number of live particles changes over time.
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--particles") == 0 && i + 1 < args.size())
+            m_particleCount = std::max(1u, static_cast<uint32_t>(strtoul(args[++i], nullptr, 10)));
+        else if (strcmp(args[i], "--emit") == 0)
+            m_emit = true;
+    }
+
     InitVulkan();
     SetupPipeline();
+
+    if (m_emit)
+        printf("Transform feedback: %u raindrops and %u emitters, streams of %u particles\n", m_particleCount, m_emitterCount, m_streamCapacity);
+    else
+        printf("Transform feedback: %u raindrops\n", m_particleCount);
 }
 
 void VKTransformFeedback::InitVulkan()
@@ -73,7 +110,9 @@ void VKTransformFeedback::SetupPipeline()
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    ReportPipelineCreationTime();
 
     m_initialized = true;
 }
@@ -97,8 +136,18 @@ void VKTransformFeedback::EnableFeatures(VkPhysicalDeviceFeatures& features)
     
     vkGetPhysicalDeviceFeatures2(m_vulkanParams.PhysicalDevice, &features2);
 
-    // We need both geometry shader and transform feedback for this sample
-    if (m_deviceFeatures.geometryShader && featuresTF.transformFeedback)
+    // The limits of the transform feedback buffers, and the support for vkCmdDrawIndirectByteCountEXT
+    propertiesTF.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TRANSFORM_FEEDBACK_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &propertiesTF;
+
+    vkGetPhysicalDeviceProperties2(m_vulkanParams.PhysicalDevice, &properties2);
+
+    // We need both geometry shader and transform feedback for this sample, and we draw the captured particles
+    // with vkCmdDrawIndirectByteCountEXT
+    if (m_deviceFeatures.geometryShader && featuresTF.transformFeedback && propertiesTF.transformFeedbackDraw &&
+        propertiesTF.maxTransformFeedbackBufferDataStride >= sizeof(Vertex))
     {
         m_vulkanParams.EnabledFeatures.geometryShader = VK_TRUE;
                 
@@ -130,17 +179,18 @@ void VKTransformFeedback::OnUpdate()
 // Render the scene.
 void VKTransformFeedback::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
+    // The number of live particles captured by the last frame that used this frame index is now available
+    ReadLiveParticleCount(m_frameIndex);
+
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -156,7 +206,7 @@ void VKTransformFeedback::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKTransformFeedback::OnDestroy()
@@ -166,31 +216,48 @@ void VKTransformFeedback::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, nullptr);
     //vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffers.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory, nullptr);
-    //vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffers.VBmemory);
+    //m_memAllocator.Free(m_vertexindexBuffers.IBmemory);
+
+    // Report the number of live particles drawn in the frames whose counts have been read back
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
+        ReadLiveParticleCount(i);
+    if (m_liveCountSamples > 0)
+        printf("Live particles: avg %.0f, min %u, max %u (streams of %u particles)\n", 
+               static_cast<double>(m_liveCountSum) / m_liveCountSamples, m_liveCountMin, m_liveCountMax, m_streamCapacity);
 
     // Destroy transform feedback buffer objects and deallocate backing memory
-    vkDestroyBuffer(m_vulkanParams.Device, m_transformFeedbackBuffers.TFbuffer, nullptr);
-    vkDestroyBuffer(m_vulkanParams.Device, m_transformFeedbackBuffers.CounterBuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_transformFeedbackBuffers.TFmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_transformFeedbackBuffers.CounterMemory, nullptr);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        vkDestroyBuffer(m_vulkanParams.Device, m_transformFeedbackBuffers[i].TFbuffer, nullptr);
+        vkDestroyBuffer(m_vulkanParams.Device, m_transformFeedbackBuffers[i].CounterBuffer, nullptr);
+        m_memAllocator.Free(m_transformFeedbackBuffers[i].TFmemory);
+        m_memAllocator.Free(m_transformFeedbackBuffers[i].CounterMemory);
+    }
 
-    // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (BufferParameters& readback : m_liveCountReadback)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
+        vkDestroyBuffer(m_vulkanParams.Device, readback.Handle, nullptr);
+        m_memAllocator.Free(readback.Allocation);
+    }
 
+    // Destroy\Unmap frame resources
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
+    {
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Destroy dynamic buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -198,7 +265,7 @@ void VKTransformFeedback::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
@@ -209,8 +276,8 @@ void VKTransformFeedback::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.GraphicsPipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -221,30 +288,45 @@ void VKTransformFeedback::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -253,8 +335,12 @@ void VKTransformFeedback::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -277,32 +363,65 @@ void VKTransformFeedback::CreateVertexBuffer()
     // Create the vertex and index buffers.
     //
 
-    // Define a grid of 9 * 9 particles lying in the XY plane of the local space inside the square [-20, 20] x [-20, 20].
-    for (int i = 0; i < 81; ++i)
+    // With --emit, each emitter keeps s_raindropsPerEmitter raindrops alive on average. The streams are larger than
+    // the initial number of particles since the number of live particles changes over time: if a stream is full, the
+    // particles that don't fit are simply not captured.
+    m_emitterCount = m_emit ? (m_particleCount + s_raindropsPerEmitter - 1) / s_raindropsPerEmitter : 0;
+    m_streamCapacity = m_emit ? m_particleCount + m_particleCount / 4 + m_emitterCount * (1 + s_maxEmittedPerFrame) : m_particleCount;
+
+    // The size of the transform feedback buffers is limited by maxTransformFeedbackBufferSize
+    VkDeviceSize maxStreamCapacity = propertiesTF.maxTransformFeedbackBufferSize / sizeof(Vertex);
+    if (m_streamCapacity > maxStreamCapacity)
+    {
+        m_particleCount = static_cast<uint32_t>(static_cast<VkDeviceSize>(m_particleCount) * maxStreamCapacity / m_streamCapacity);
+        m_emitterCount = m_emit ? (m_particleCount + s_raindropsPerEmitter - 1) / s_raindropsPerEmitter : 0;
+        m_streamCapacity = m_emit ? m_particleCount + m_particleCount / 4 + m_emitterCount * (1 + s_maxEmittedPerFrame) : m_particleCount;
+        m_streamCapacity = std::min(m_streamCapacity, static_cast<uint32_t>(maxStreamCapacity));
+        printf("The particles exceed maxTransformFeedbackBufferSize: the number of raindrops is clamped to %u.\n", m_particleCount);
+    }
+
+    // The emitters come first, on a grid at the top of the volume: each one spawns raindrops in its cell
+    // (see emit.geom), and they must stay at the beginning of the streams.
+    uint32_t emitterGridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(m_emitterCount))));
+    float emitterCellSize = (emitterGridSize > 0) ? 40.0f / emitterGridSize : 0.0f;
+    for (uint32_t i = 0; i < m_emitterCount; ++i)
+    {
+        Vertex v;
+        v.position = glm::vec3{ (i % emitterGridSize + 0.5f) * emitterCellSize - 20.0f, (i / emitterGridSize + 0.5f) * emitterCellSize - 20.0f, 50.0f };
+        v.size = { 0.0f, 0.0f };
+        v.speed = 0.0f;
+        v.age = 0.0f;
+        v.type = PARTICLE_EMITTER;
+        particles.push_back(v);
+    }
+
+    // Define a grid of particles lying in the XY plane of the local space inside the square [-20, 20] x [-20, 20]
+    // (9 * 9 particles, 5 units apart, by default).
+    uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(m_particleCount))));
+    float gridSpacing = (gridSize > 1) ? 40.0f / (gridSize - 1) : 0.0f;
+    for (uint32_t i = 0; i < m_particleCount; ++i)
     {
         Vertex v;
-        v.position = glm::vec3{ i % 9 * 5.0f - 20.0f, i / 9 * 5.0f - 20.0f, 0.0f };
+        v.position = glm::vec3{ i % gridSize * gridSpacing - 20.0f, i / gridSize * gridSpacing - 20.0f, 0.0f };
         v.size = { 0.05f, 5.0f }; // { 0.3f, 5.0f } for the interstellar travel effect
         v.speed = static_cast<float>(100 + rand() % 200);
+        v.age = 0.0f;
+        v.type = PARTICLE_RAINDROP;
         particles.push_back(v);
     }
 
-    m_meshObjects["particleGrid"].vertexCount = static_cast<uint32_t>(particles.size());
+    m_meshObjects[m_meshParticleGrid].vertexCount = static_cast<uint32_t>(particles.size());
+
+    // A raindrop falls for 100 / speed seconds, which is 0.5 * ln(3) seconds on average for speeds in [100, 300):
+    // an emitter keeping s_raindropsPerEmitter raindrops alive needs to spawn one every (0.5 * ln(3)) / s_raindropsPerEmitter seconds.
+    uBufVS.emitParams.x = 0.5f * std::log(3.0f) / s_raindropsPerEmitter;
+    uBufVS.emitParams.z = emitterCellSize;
 
     //
     // Create the vertex and index buffers in host-visible device memory for convenience. 
     // This is not recommended as it can result in lower rendering performance.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -314,19 +433,10 @@ void VKTransformFeedback::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffers.VBmemory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, particles.data(), static_cast<size_t>(particles.size()) * sizeof(Vertex));
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, m_vertexindexBuffers.VBmemory, 0));
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffers.VBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffers.VBmemory);
+
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffers.VBmemory.MappedMemory, particles.data(), static_cast<size_t>(particles.size()) * sizeof(Vertex));
 }
 
 void VKTransformFeedback::CreateTransformFeedbackBuffers()
@@ -335,38 +445,59 @@ void VKTransformFeedback::CreateTransformFeedbackBuffers()
     // Create buffers required to use the transform feedback stage in this sample
     //
 
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Transform feedback buffer
+    // Two streams, each with a transform feedback buffer and a counter buffer
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        // Transform feedback buffer
+        VkBufferCreateInfo bufferInfo = {};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = static_cast<VkDeviceSize>(m_streamCapacity) * sizeof(Vertex);
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFORM_FEEDBACK_BUFFER_BIT_EXT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+
+        // Create the transform feedback buffer in local device memory.
+        CreateBuffer(m_memAllocator, 
+                        bufferInfo, 
+                        m_transformFeedbackBuffers[i].TFbuffer,
+                        m_transformFeedbackBuffers[i].TFmemory,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        // Counter buffer (also copied to a host-visible buffer to report the number of live particles)
+        bufferInfo.size = sizeof(uint32_t);
+        bufferInfo.usage = VK_BUFFER_USAGE_TRANSFORM_FEEDBACK_COUNTER_BUFFER_BIT_EXT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        // Create the counter buffer in local device memory.
+        CreateBuffer(m_memAllocator, 
+                        bufferInfo, 
+                        m_transformFeedbackBuffers[i].CounterBuffer,
+                        m_transformFeedbackBuffers[i].CounterMemory,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+
+    // Host-visible copies of the counter buffer written by each frame in flight
     VkBufferCreateInfo bufferInfo = {};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = particles.size() * sizeof(Vertex);
-    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFORM_FEEDBACK_BUFFER_BIT_EXT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-
-    // Create the transform feedback buffer in local device memory.
-    CreateBuffer(m_vulkanParams.Device, 
-                    bufferInfo, 
-                    m_transformFeedbackBuffers.TFbuffer,
-                    m_transformFeedbackBuffers.TFmemory,
-                    nullptr,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                    m_deviceMemoryProperties);
-
-    // Counter buffer
     bufferInfo.size = sizeof(uint32_t);
-    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFORM_FEEDBACK_COUNTER_BUFFER_BIT_EXT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
-
-    // Create the counter buffer in local device memory.
-    CreateBuffer(m_vulkanParams.Device, 
-                    bufferInfo, 
-                    m_transformFeedbackBuffers.CounterBuffer,
-                    m_transformFeedbackBuffers.CounterMemory,
-                    nullptr,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                    m_deviceMemoryProperties);
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    m_liveCountReadback.resize(m_framesInFlight);
+    m_liveCountPending.assign(m_framesInFlight, false);
+    for (size_t i = 0; i < m_framesInFlight; i++)
+        CreateBuffer(m_memAllocator, bufferInfo, m_liveCountReadback[i], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+}
+
+void VKTransformFeedback::ReadLiveParticleCount(uint32_t frameIndex)
+{
+    if (!m_liveCountPending[frameIndex])
+        return;
+
+    // The counter stores the number of bytes captured in the stream
+    uint32_t liveCount = *static_cast<const uint32_t*>(m_liveCountReadback[frameIndex].MappedMemory) / sizeof(Vertex);
+    m_liveCountMin = std::min(m_liveCountMin, liveCount);
+    m_liveCountMax = std::max(m_liveCountMax, liveCount);
+    m_liveCountSum += liveCount;
+    m_liveCountSamples++;
+
+    m_liveCountPending[frameIndex] = false;
 }
 
 void VKTransformFeedback::CreateHostVisibleBuffers()
@@ -387,15 +518,14 @@ void VKTransformFeedback::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -431,15 +561,14 @@ void VKTransformFeedback::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -458,6 +587,7 @@ void VKTransformFeedback::UpdateHostVisibleBufferData()
 {
     // Update time
     uBufVS.deltaTime = static_cast<float>(m_timer.GetElapsedSeconds());
+    uBufVS.emitParams.y = static_cast<float>(m_timer.GetTotalSeconds());
 
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
@@ -467,12 +597,12 @@ void VKTransformFeedback::UpdateHostVisibleBufferData()
 void VKTransformFeedback::UpdateHostVisibleDynamicBufferData()
 {
     // Grid of particle is not affect by world transformations
-    m_meshObjects["particleGrid"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                        (m_meshObjects["particleGrid"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
-    m_meshObjects["particleGrid"].meshInfo->worldMatrix = glm::identity<glm::mat4>();
+    m_meshObjects[m_meshParticleGrid].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
+                                        (m_meshObjects[m_meshParticleGrid].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshParticleGrid].meshInfo->worldMatrix = glm::identity<glm::mat4>();
 
     // Set a half-transparent white color
-    m_meshObjects["particleGrid"].meshInfo->solidColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.5f);
+    m_meshObjects[m_meshParticleGrid].meshInfo->solidColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.5f);
 
     // Update dynamic uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
@@ -493,9 +623,9 @@ void VKTransformFeedback::CreateDescriptorPool()
     // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer)
     VkDescriptorPoolSize typeCounts[2];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
@@ -505,7 +635,7 @@ void VKTransformFeedback::CreateDescriptorPool()
     descriptorPoolInfo.poolSizeCount = 2;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -542,17 +672,17 @@ void VKTransformFeedback::CreateDescriptorSetLayout()
 
 void VKTransformFeedback::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -561,13 +691,13 @@ void VKTransformFeedback::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[2] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -575,7 +705,7 @@ void VKTransformFeedback::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
@@ -617,11 +747,13 @@ void VKTransformFeedback::CreatePipelineObjects()
     // Vertex attribute descriptions describe the vertex shader attribute locations and memory layouts, 
     // as well as the binding points from which the input assembler should retrieve data to pass to the 
     // corresponding vertex shader input attributes.
-    std::array<VkVertexInputAttributeDescription, 3> vertexInputAttributs;
+    std::array<VkVertexInputAttributeDescription, 5> vertexInputAttributs;
     // These match the following shader layout (see vertex shader):
     //	layout (location = 0) in vec3 inPos;
     //	layout (location = 1) in vec3 inSize;
     //  layout (location = 2) in float inSpeed;
+    //  layout (location = 3) in float inAge;
+    //  layout (location = 4) in uint inType;
     //
     // Attribute location 0: Position from vertex buffer at binding point 0
     vertexInputAttributs[0].binding = 0;
@@ -641,6 +773,18 @@ void VKTransformFeedback::CreatePipelineObjects()
     // Speed attribute is a 32-bit signed float (R32)
     vertexInputAttributs[2].format = VK_FORMAT_R32_SFLOAT;
     vertexInputAttributs[2].offset = offsetof(Vertex, speed);
+    // Attribute location 3: Age from vertex buffer at binding point 0
+    vertexInputAttributs[3].binding = 0;
+    vertexInputAttributs[3].location = 3;
+    // Age attribute is a 32-bit signed float (R32)
+    vertexInputAttributs[3].format = VK_FORMAT_R32_SFLOAT;
+    vertexInputAttributs[3].offset = offsetof(Vertex, age);
+    // Attribute location 4: Type from vertex buffer at binding point 0
+    vertexInputAttributs[4].binding = 0;
+    vertexInputAttributs[4].location = 4;
+    // Type attribute is a 32-bit unsigned integer (R32)
+    vertexInputAttributs[4].format = VK_FORMAT_R32_UINT;
+    vertexInputAttributs[4].offset = offsetof(Vertex, type);
     
     // Vertex input state used for pipeline creation.
     // The Vulkan specification uses it to specify the input of the entire pipeline, 
@@ -650,7 +794,7 @@ void VKTransformFeedback::CreatePipelineObjects()
     vertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vertexInputState.vertexBindingDescriptionCount = 1;
     vertexInputState.pVertexBindingDescriptions = &vertexInputBinding;
-    vertexInputState.vertexAttributeDescriptionCount = 3;
+    vertexInputState.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertexInputAttributs.size());
     vertexInputState.pVertexAttributeDescriptions = vertexInputAttributs.data();
     
     // Input assembly state describes how primitives are assembled by the input assembler.
@@ -738,6 +882,8 @@ void VKTransformFeedback::CreatePipelineObjects()
     VkShaderModule renderVS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/render.vert.spv");
     VkShaderModule renderGS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/render.geom.spv");
     VkShaderModule renderFS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/render.frag.spv");
+    VkShaderModule emitVS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/emit.vert.spv");
+    VkShaderModule emitGS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/emit.geom.spv");
 
     // This sample will use three programmable stage: Vertex, Geometry and Fragment shaders
     std::array<VkPipelineShaderStageCreateInfo, 3> shaderStages{};
@@ -790,6 +936,19 @@ void VKTransformFeedback::CreatePipelineObjects()
     // Set pipeline shader stage info (it only includes the VS shader for capturing the result in the TF stage)
     pipelineCreateInfo.stageCount = static_cast<uint32_t>(shaderStages.size() - 2);
     pipelineCreateInfo.pStages = shaderStages.data();
+
+    // With --emit, particles are updated by a geometry shader that can emit new raindrops or discard the dead ones,
+    // so the number of captured particles can change from frame to frame (the VS only passes them through).
+    std::array<VkPipelineShaderStageCreateInfo, 2> emitStages = { shaderStages[0], shaderStages[2] };
+    if (m_emit)
+    {
+        emitStages[0].module = emitVS;
+        emitStages[1].module = emitGS;
+        assert(emitStages[0].module != VK_NULL_HANDLE && emitStages[1].module != VK_NULL_HANDLE);
+
+        pipelineCreateInfo.stageCount = static_cast<uint32_t>(emitStages.size());
+        pipelineCreateInfo.pStages = emitStages.data();
+    }
     
     // Assign the pipeline states to the pipeline creation info structure
     pipelineCreateInfo.pVertexInputState = &vertexInputState;
@@ -803,9 +962,9 @@ void VKTransformFeedback::CreatePipelineObjects()
     
     // Create a graphics pipeline for capturing particles updated by the VS work
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["TransformFeedback"]));
+                                              &m_sampleParams.Pipelines[m_pipelineTransformFeedback]));
 
     //
     // Rainfall
@@ -816,6 +975,7 @@ void VKTransformFeedback::CreatePipelineObjects()
 
     // Specify different shaders for rendering raindrops
     pipelineCreateInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+    pipelineCreateInfo.pStages = shaderStages.data();
     shaderStages[0].module = renderVS;
     shaderStages[1].module = renderFS;
     shaderStages[2].module = renderGS;
@@ -829,9 +989,9 @@ void VKTransformFeedback::CreatePipelineObjects()
 
     // Create a graphics pipeline to draw using a solid color
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["Rainfall"]));
+                                              &m_sampleParams.Pipelines[m_pipelineRainfall]));
 
     //
     // Destroy shader modules
@@ -843,12 +1003,12 @@ void VKTransformFeedback::CreatePipelineObjects()
     vkDestroyShaderModule(m_vulkanParams.Device, renderVS, nullptr);
     vkDestroyShaderModule(m_vulkanParams.Device, renderGS, nullptr);
     vkDestroyShaderModule(m_vulkanParams.Device, renderFS, nullptr);
+    vkDestroyShaderModule(m_vulkanParams.Device, emitVS, nullptr);
+    vkDestroyShaderModule(m_vulkanParams.Device, emitGS, nullptr);
 }
 
 void VKTransformFeedback::PopulateCommandBuffer(uint32_t currentImageIndex)
 {
-    static bool first = true;
-
     VkCommandBufferBeginInfo cmdBufInfo = {};
     cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
@@ -873,11 +1033,22 @@ void VKTransformFeedback::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
+
+    // The particles are read from one stream and captured in the other one, which becomes the input of the next frame.
+    // The first frame reads the initial particles from the vertex buffer.
+    TransformFeedbackBuffers& inputStream = m_transformFeedbackBuffers[m_inputStream];
+    TransformFeedbackBuffers& outputStream = m_transformFeedbackBuffers[1 - m_inputStream];
+
+    // The output stream was read by the previous frame (as a vertex buffer, and its counter as an indirect argument
+    // and by a copy): wait for those reads before overwriting it (write-after-read hazard).
+    vkCmdPipelineBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT, 
+                        0, 0, nullptr, 0, nullptr, 0, nullptr);
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -885,7 +1056,7 @@ void VKTransformFeedback::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -893,47 +1064,53 @@ void VKTransformFeedback::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
     
-    // Bind the vertex buffer (with position, size and normal attributes)
+    // Bind the vertex buffer (with position, size, speed, age and type attributes)
     VkDeviceSize offsets[1] = { 0 };
-    if (first)
-        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffers.VBbuffer, offsets);
+    if (m_streamsInitialized)
+        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &inputStream.TFbuffer, offsets);
     else
-        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_transformFeedbackBuffers.TFbuffer, offsets);
+        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffers.VBbuffer, offsets);
 
     //
     // Update and capture particles
     //
 
     // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
-    uint32_t dynamicOffset = m_meshObjects["particleGrid"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+    uint32_t dynamicOffset = m_meshObjects[m_meshParticleGrid].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
 
     // Bind the graphics pipeline for capturing updated particles
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                         VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                        m_sampleParams.GraphicsPipelines["TransformFeedback"]);
+                        m_sampleParams.Pipelines[m_pipelineTransformFeedback]);
 
     // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                             VK_PIPELINE_BIND_POINT_GRAPHICS, 
                             m_sampleParams.PipelineLayout, 
                             0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
                             1, &dynamicOffset);
 
-    // Bind the transform feedback buffer to the command buffer specifying zero as binding point
-    vkCmdBindTransformFeedbackBuffersEXT(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_transformFeedbackBuffers.TFbuffer, offsets, nullptr);
+    // Bind the output transform feedback buffer to the command buffer specifying zero as binding point
+    vkCmdBindTransformFeedbackBuffersEXT(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &outputStream.TFbuffer, offsets, nullptr);
 
-    // Active the Transform Feedback for the Transform Feedback buffer bound to the command buffer
-    vkCmdBeginTransformFeedbackEXT(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 0, nullptr, nullptr);
+    // Active the Transform Feedback for the Transform Feedback buffer bound to the command buffer.
+    // No counter buffer is passed, so the particles are captured from the beginning of the buffer.
+    vkCmdBeginTransformFeedbackEXT(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 0, nullptr, nullptr);
 
-    // Draw the grid of particles to update their position in the VS and capture them in the transform feedback buffer
-    vkCmdDraw(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_meshObjects["particleGrid"].vertexCount, 1, 0, 0);
+    // Draw the particles to update them and capture the result in the output transform feedback buffer.
+    // The first frame draws the initial particles; after that, the number of particles to draw is the number of bytes
+    // captured in the input stream (divided by the stride), which is read by the GPU with no round trip to the CPU.
+    if (m_streamsInitialized)
+        vkCmdDrawIndirectByteCountEXT(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 1, 0, inputStream.CounterBuffer, 0, 0, sizeof(Vertex));
+    else
+        vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[m_meshParticleGrid].vertexCount, 1, 0, 0);
 
     // Made the Transform Feedback inactive for the Transform Feedback buffer bound to the command buffer.
     // Specify the counter buffer where to store the current byte position in the transform feedback buffer.
-    vkCmdEndTransformFeedbackEXT(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_transformFeedbackBuffers.CounterBuffer, offsets);
+    vkCmdEndTransformFeedbackEXT(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &outputStream.CounterBuffer, offsets);
 
     //
     // Raindrops render
@@ -943,35 +1120,54 @@ void VKTransformFeedback::PopulateCommandBuffer(uint32_t currentImageIndex)
 
     // Bind the graphics pipeline for drawing raindrops with a transparent, white color, 
     // Use the geometry shader for emitting two triangle (quad) from points (grid particles).
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+    vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                     VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                    m_sampleParams.GraphicsPipelines["Rainfall"]);
+                    m_sampleParams.Pipelines[m_pipelineRainfall]);
 
-    // Use the updated particle positions by binding the transform feedback buffer as vertex buffer
-    if (first)
-    {
-        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_transformFeedbackBuffers.TFbuffer, offsets);
-        first = false;
-    }
-
-    // Set pipeline barrier for the counter buffer
-    vkCmdPipelineBarrier(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 
-                        0, 0, nullptr, 0, nullptr, 0, nullptr);
+    // Use the updated particles by binding the output transform feedback buffer as vertex buffer
+    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &outputStream.TFbuffer, offsets);
 
-    // Set pipeline barrier for the transform feecback buffer
-    // vkCmdPipelineBarrier(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-    //                 VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
-    //                 0, 0, nullptr, 0, nullptr, 0, nullptr);
+    // Set pipeline barrier for the transform feedback buffer and its counter buffer:
+    // the captured particles are read as vertices, and the counter as the argument of the indirect draw.
+    VkMemoryBarrier memoryBarrier = {};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT | VK_ACCESS_TRANSFORM_FEEDBACK_COUNTER_WRITE_BIT_EXT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_TRANSFORM_FEEDBACK_COUNTER_READ_BIT_EXT;
+    vkCmdPipelineBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 
+                        0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
 
     // Draw the raindrops 
-    vkCmdDrawIndirectByteCountEXT(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 1, 0, m_transformFeedbackBuffers.CounterBuffer, 0, 0, sizeof(Vertex));
+    vkCmdDrawIndirectByteCountEXT(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 1, 0, outputStream.CounterBuffer, 0, 0, sizeof(Vertex));
 
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
+
+    // Copy the counter buffer to a host-visible buffer to report the number of live particles when the frame is done
+    // (see ReadLiveParticleCount). The CPU never waits for it: the draws above use the counter directly.
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFORM_FEEDBACK_COUNTER_WRITE_BIT_EXT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                        0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.size = sizeof(uint32_t);
+    vkCmdCopyBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], outputStream.CounterBuffer, m_liveCountReadback[m_frameIndex].Handle, 1, &copyRegion);
+
+    memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                        VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 
+                        0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+    m_liveCountPending[m_frameIndex] = true;
     
-    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
+
+    // The output stream is the input of the next frame
+    m_inputStream = 1 - m_inputStream;
+    m_streamsInitialized = true;
 }
 
 void VKTransformFeedback::SubmitCommandBuffer()
@@ -984,13 +1180,13 @@ void VKTransformFeedback::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKTransformFeedback::PresentImage(uint32_t currentImageIndex)
@@ -1005,13 +1201,13 @@ void VKTransformFeedback::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -0,0 +1,26 @@
+#version 450
+
+// Vertex shader of the patches tessellated by tessellate.comp (--tess-compute):
+// the vertices are already on the surface of the patches, so they only need to be transformed.
+
+layout (location = 0) in vec3 inPos;
+
+layout(std140, set = 0, binding = 0) uniform buf {
+    mat4 viewMatrix;
+    mat4 projMatrix;
+    vec4 viewport;
+    vec4 tessParams;
+} uBuf;
+
+layout(std140, set = 0, binding = 1) uniform dynbuf {
+    mat4 worldMatrix;
+    vec4 solidColor;
+} dynBuf;
+
+
+void main()
+{
+    vec4 worldPos = dynBuf.worldMatrix * vec4(inPos, 1.0);     // Local to World
+    vec4 viewPos = uBuf.viewMatrix * worldPos;                 // World to View
+    gl_Position = uBuf.projMatrix * viewPos;                   // View to Clip
+}
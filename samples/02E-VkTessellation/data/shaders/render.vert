@@ -3,9 +3,26 @@
 layout (location = 0) in vec3 inPos;
 
 layout (location = 0) out vec3 outPos;
+layout (location = 1) out vec4 outClipPos;
+
+layout(std140, set = 0, binding = 0) uniform buf {
+    mat4 viewMatrix;
+    mat4 projMatrix;
+    vec4 viewport;
+    vec4 tessParams;
+} uBuf;
+
+layout(std140, set = 0, binding = 1) uniform dynbuf {
+    mat4 worldMatrix;
+    vec4 solidColor;
+} dynBuf;
 
 
 void main()
 {
     outPos = inPos;
+
+    // Position of the control point in clip space, used by the TCS to compute the tessellation levels of the patch
+    // from the size of its edges on the screen, and to cull the patches outside the view frustum.
+    outClipPos = uBuf.projMatrix * uBuf.viewMatrix * dynBuf.worldMatrix * vec4(inPos, 1.0);
 }
\ No newline at end of file
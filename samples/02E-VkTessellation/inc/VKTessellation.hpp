@@ -3,6 +3,8 @@
 #include "VKSample.hpp"
 #include "VKSampleHelper.hpp"
 
+#include <unordered_map>
+
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "glm/glm.hpp"
 
@@ -41,6 +43,14 @@ private:
     void CreatePipelineLayout();            // Create a pipeline layout
     void CreatePipelineObjects();           // Create a pipeline object
 
+    // Tessellation of the patches by a compute shader (--tess-compute)
+    void CreateTessellationCache();         // Create the buffers, descriptor sets and pipelines of the compute tessellation
+    void DestroyTessellationCache();
+    void UpdateTessellationCache();         // Select the levels of the patches and the ones that need to be tessellated
+    void RecordTessellation(VkCommandBuffer commandBuffer);  // Tessellate the patches missing from the cache
+    void DrawTessellatedPatches(VkCommandBuffer commandBuffer);
+    uint32_t GetEdgeLevel(const uint16_t* points, uint32_t stride) const;
+
     // Update buffer data
     void UpdateHostVisibleBufferData();
     void UpdateHostVisibleDynamicBufferData();
@@ -50,6 +60,8 @@ private:
     // layout(std140, set = 0, binding = 0) uniform buf {
     //     mat4 View;
     //     mat4 Projection;
+    //     vec4 viewport;
+    //     vec4 tessParams;
     // } uBuf;
     //
     // This way we can just memcopy the uBufVS data to match the uBuf memory layout.
@@ -57,6 +69,8 @@ private:
     struct {
         glm::mat4 viewMatrix;         // 64 bytes
         glm::mat4 projectionMatrix;   // 64 bytes
+        glm::vec4 viewport;           // xy: size of the viewport in pixels
+        glm::vec4 tessParams;         // x: target edge length in pixels, y: max tessellation level, z: fixed level (0 for adaptive levels)
     } uBufVS;
 
     // Uniform block defined in the vertex shader to be used as a dynamic uniform buffer:
@@ -84,9 +98,9 @@ private:
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffers;
@@ -106,9 +120,87 @@ private:
     const unsigned int m_numDrawCalls = 1;
 
     // Mesh objects to draw
-    std::map<std::string, MeshObject> m_meshObjects;
+    VKHandleTable<MeshObject> m_meshObjects;
+
+    // Handles of the named pipelines, mesh objects and descriptor sets (registered in the constructor)
+    TableHandle m_pipelineWireframeNoCull;
+    TableHandle m_pipelineMeshWireframeNoCull;
+    TableHandle m_meshPatchControlPoints;
+    TableHandle m_descSetGraphics;
 
     // Sample members
     float m_curRotationAngleRad;
     size_t m_dynamicUBOAlignment;
+
+    // Tessellation settings.
+    // By default, the TCS sets the tessellation level of each edge of a patch so that the edges of the generated
+    // triangles are about m_tessPixels pixels long on the screen (--tess-pixels P), and culls the patches outside
+    // the view frustum. --tess-fixed L tessellates every edge with the same level instead (25 in the tutorial).
+    // --patches N replaces the patch of the tutorial with a terrain made of N x N patches sharing their edges.
+    float m_tessPixels;
+    float m_tessFixedLevel;
+    uint32_t m_patchGridSize;
+
+    // Compute tessellation (--tess-compute).
+    // Rather than evaluating the patches in the TES every frame, a compute shader tessellates each patch into a grid of
+    // vertices stored in a cache, and the grids are drawn with plain indexed draws. The levels of the edges are computed
+    // on the CPU with the same metric as the TCS, rounded up to a power of two, so that a patch only needs to be
+    // tessellated again when the level of one of its edges changes (or when it was evicted from the cache).
+    static const uint32_t s_tessCacheLevels = 7;    // Inner levels 1, 2, 4, ..., 64
+
+    // Tessellation job, read by tessellate.comp (std430)
+    struct TessJob {
+        uint32_t patchIndex;
+        uint32_t firstVertex;   // First vertex of the slot of the cache where the patch is tessellated
+        uint32_t levels;        // log2 of the inner level (bits 0-3) and of the levels of the 4 edges (bits 4-19)
+        uint32_t unused;
+    };
+
+    // Slot of the cache, holding the grid of vertices of a patch tessellated with some levels.
+    // The slots of the same inner level form a LRU list.
+    struct TessCacheSlot {
+        uint32_t key;               // Patch index and levels (UINT32_MAX if the slot is free)
+        uint64_t lastUsedFrame;
+        uint32_t prev, next;        // Previous (more recently used) and next slot in the LRU list
+    };
+
+    // Slots and grid of the patches tessellated with the same inner level
+    struct TessCacheLevel {
+        uint32_t firstVertex;       // First vertex of the slots of this level in the vertex cache
+        uint32_t vertexCount;       // Vertices per slot: (N + 1) x (N + 1)
+        uint32_t firstIndex;        // Indices of the triangles of the grid
+        uint32_t indexCount;
+        std::vector<TessCacheSlot> slots;
+        uint32_t mostRecent, leastRecent;
+    };
+
+    // Patch to draw in the current frame
+    struct TessDraw {
+        uint32_t level;
+        uint32_t firstVertex;
+    };
+
+    struct {
+        BufferParameters controlPoints;             // 16 control points (vec4) per patch
+        BufferParameters vertices;                  // Vertex cache (vec4 positions), in device-local memory
+        BufferParameters indices;                   // Indices of the grids of all the levels
+        std::vector<BufferParameters> jobs;         // Jobs of the frames in flight
+        std::vector<VkDescriptorSet> descriptorSets;
+        VkDescriptorSetLayout descriptorSetLayout;
+        VkPipelineLayout pipelineLayout;
+        VkPipeline pipeline;
+    } m_tessComputeParams;
+
+    bool m_tessCompute;
+    uint32_t m_tessCacheMB;                         // Size of the vertex cache (--tess-cache-mb)
+    float m_rotationSpeed;                          // Rotation speed of the patches in radians per second (--rotation-speed)
+    std::vector<glm::vec3> m_controlPoints;         // Copy of the control points and of their indices, used to compute
+    std::vector<uint16_t> m_controlPointIndices;    // the levels on the CPU
+    std::vector<glm::vec4> m_clipPositions;         // Control points in clip space
+    TessCacheLevel m_tessCache[s_tessCacheLevels];
+    std::unordered_map<uint32_t, uint32_t> m_tessCacheLookup;  // Key of a tessellated patch -> slot
+    std::vector<TessJob> m_tessJobs;                // Patches to tessellate in the current frame
+    std::vector<TessDraw> m_tessDraws;              // Patches to draw in the current frame
+    uint64_t m_tessCacheFrame;
+    uint64_t m_tessCacheHits, m_tessCacheMisses, m_tessCacheEvictions, m_tessCacheFull;
 };
\ No newline at end of file
@@ -13,7 +13,7 @@ if exist "%VULKAN_SDK%\Include\vulkan\vulkan.h" (
     SET VULKAN_INCLUDE=..\..\external\include\vulkan
 )
 
-SET includes=/I inc /I ..\..\external\include ^
+SET includes=/I inc /I ..\..\framework\inc /I ..\..\external\include ^
 /I %VULKAN_INCLUDE%
 
 SET defines=/D DEBUG /D _WIN32 /D VK_USE_PLATFORM_WIN32_KHR /D _CRT_SECURE_NO_WARNINGS
@@ -33,9 +33,11 @@ echo Compiling shader...
 ..\..\bin\glslangValidator -V -g .\data\shaders\render.tesc -o .\data\shaders\render.tesc.spv
 ..\..\bin\glslangValidator -V -g .\data\shaders\render.tese -o .\data\shaders\render.tese.spv
 ..\..\bin\glslangValidator -V -g .\data\shaders\render.frag -o .\data\shaders\render.frag.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\mesh.vert -o .\data\shaders\mesh.vert.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\tessellate.comp -o .\data\shaders\tessellate.comp.spv
 
 echo Building project...
 
-cl src/*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
+cl src/*.cpp ..\..\framework\src\*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
 
 del *.obj vc*.idb vc*.pdb
\ No newline at end of file
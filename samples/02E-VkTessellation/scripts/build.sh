@@ -7,11 +7,11 @@ else
     VULKAN_INCLUDE=../../external/include/vulkan/
 fi
 
-includes="-Iinc -I../../external/include/ -I$VULKAN_INCLUDE"
+includes="-Iinc -I../../framework/inc -I../../external/include/ -I$VULKAN_INCLUDE"
 
 defines="-DDEBUG -DVK_USE_PLATFORM_XLIB_KHR"
 
-links="-lX11 -lvulkan"
+links="-L../../framework/lib -lvkframework -lX11 -lvulkan -lpthread"
 
 echo Compiling shader...
 
@@ -19,9 +19,16 @@ echo Compiling shader...
 /../../bin/glslangValidator -V -g ./data/shaders/render.tesc -o ./data/shaders/render.tesc.spv
 /../../bin/glslangValidator -V -g ./data/shaders/render.tese -o ./data/shaders/render.tese.spv
 /../../bin/glslangValidator -V -g ./data/shaders/render.frag -o ./data/shaders/render.frag.spv
+/../../bin/glslangValidator -V -g ./data/shaders/mesh.vert -o ./data/shaders/mesh.vert.spv
+/../../bin/glslangValidator -V -g ./data/shaders/tessellate.comp -o ./data/shaders/tessellate.comp.spv
+
+if [ "$SKIP_FRAMEWORK" != "1" ]; then
+    (cd ../../framework && bash scripts/build.sh) || exit 1
+fi
 
 echo Building project...
 
-g++ -g src/*.cpp -o 02E-VkTessellation.out $includes $defines $links
+source ../../scripts/compile.sh
 
-rm -f *.o
\ No newline at end of file
+compile_sources obj "$includes $defines" src/*.cpp || exit 1
+link_executable 02E-VkTessellation.out ../../framework/lib/libvkframework.a "$links" $OBJECTS || exit 1
\ No newline at end of file
@@ -10,14 +10,35 @@
 VKTessellation::VKTessellation(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
 m_dynamicUBOAlignment(0),
-m_curRotationAngleRad(0.0f)
+m_curRotationAngleRad(0.0f),
+m_tessPixels(8.0f),
+m_tessFixedLevel(0.0f),
+m_patchGridSize(0),
+m_tessCompute(false),
+m_tessCacheMB(64),
+m_rotationSpeed(0.8f),
+m_tessCacheFrame(0),
+m_tessCacheHits(0),
+m_tessCacheMisses(0),
+m_tessCacheEvictions(0),
+m_tessCacheFull(0)
 {
+    // Register the named pipelines, mesh objects and descriptor sets, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineWireframeNoCull = m_sampleParams.Pipelines.Register("WireframeNoCull");
+    m_pipelineMeshWireframeNoCull = m_sampleParams.Pipelines.Register("MeshWireframeNoCull");
+    m_meshPatchControlPoints = m_meshObjects.Register("patchControlPoints");
+    m_descSetGraphics = m_sampleParams.FrameRes.DescriptorSets.Register("Graphics");
+
     // Initialize mesh objects
-    m_meshObjects["patchControlPoints"] = {};
+    m_meshObjects[m_meshPatchControlPoints] = {};
 
     // Initialize the pointer to the memory region that will store the array of mesh info.
     dynUBufVS.meshInfo = nullptr;
 
+    m_tessComputeParams.descriptorSetLayout = VK_NULL_HANDLE;
+    m_tessComputeParams.pipelineLayout = VK_NULL_HANDLE;
+    m_tessComputeParams.pipeline = VK_NULL_HANDLE;
+
     // Initialize the view matrix
     glm::vec3 c_pos = { 0.0f, -40.0f, 10.0f };
     glm::vec3 c_at =  { 0.0f, 0.0f, 0.0f };
@@ -36,9 +57,52 @@ VKTessellation::~VKTessellation()
 
 void VKTessellation::OnInit()
 {
+    // --tess-pixels sets the target length in pixels of the edges of the generated triangles, --tess-fixed sets the
+    // same tessellation level for all the edges (as in the tutorial), and --patches N draws a terrain of N x N patches.
+    // --tess-compute tessellates the patches with a compute shader into a cache of --tess-cache-mb MB instead of using
+    // the tessellation shaders, and --rotation-speed sets the speed of the rotation of the patches (0 to stop it).
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--tess-pixels") == 0 && i + 1 < args.size())
+            m_tessPixels = std::max(static_cast<float>(atof(args[++i])), 1.0f);
+        else if (strcmp(args[i], "--tess-fixed") == 0 && i + 1 < args.size())
+            m_tessFixedLevel = std::max(static_cast<float>(atof(args[++i])), 0.0f);
+        else if (strcmp(args[i], "--patches") == 0 && i + 1 < args.size())
+            m_patchGridSize = std::min(static_cast<uint32_t>(strtoul(args[++i], nullptr, 10)), 64u);  // 16-bit indices
+        else if (strcmp(args[i], "--tess-compute") == 0)
+            m_tessCompute = true;
+        else if (strcmp(args[i], "--tess-cache-mb") == 0 && i + 1 < args.size())
+            m_tessCacheMB = std::max(static_cast<uint32_t>(strtoul(args[++i], nullptr, 10)), 1u);
+        else if (strcmp(args[i], "--rotation-speed") == 0 && i + 1 < args.size())
+            m_rotationSpeed = static_cast<float>(atof(args[++i]));
+    }
+
     InitVulkan();
     SetupPipeline();
 
+    // Tessellation levels can't exceed the max level supported by the device (at least 64)
+    const float maxLevel = static_cast<float>(m_deviceProperties.limits.maxTessellationGenerationLevel);
+    m_tessFixedLevel = std::min(m_tessFixedLevel, maxLevel);
+    uBufVS.tessParams = glm::vec4(m_tessPixels, maxLevel, m_tessFixedLevel, 0.0f);
+    uBufVS.viewport = glm::vec4(static_cast<float>(m_width), static_cast<float>(m_height), 0.0f, 0.0f);
+
+    if (m_tessCompute)
+    {
+        uint64_t cacheSize = m_tessComputeParams.vertices.Size;
+        printf("Tessellation: compute shader, %s, %u patch(es), cache of %.1f MB (slots per level:", 
+               m_tessFixedLevel > 0.0f ? "fixed level" : "adaptive levels and frustum culling", m_meshObjects[m_meshPatchControlPoints].indexCount / 16,
+               cacheSize / (1024.0 * 1024.0));
+        for (uint32_t level = 0; level < s_tessCacheLevels; level++)
+            printf(" %u", static_cast<uint32_t>(m_tessCache[level].slots.size()));
+        printf(")\n");
+    }
+    else if (m_tessFixedLevel > 0.0f)
+        printf("Tessellation: fixed level %.1f, %u patch(es)\n", m_tessFixedLevel, m_meshObjects[m_meshPatchControlPoints].indexCount / 16);
+    else
+        printf("Tessellation: adaptive, %.1f pixels per edge, max level %.0f, frustum culling, %u patch(es)\n", 
+               m_tessPixels, maxLevel, m_meshObjects[m_meshPatchControlPoints].indexCount / 16);
+
     // Update buffer data (view and projection matrices)
     UpdateHostVisibleBufferData();
 }
@@ -49,6 +113,21 @@ void VKTessellation::InitVulkan()
     CreateSurface();
     CreateDevice(VK_QUEUE_GRAPHICS_BIT);
     GetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.FamilyIndex, m_vulkanParams.GraphicsQueue.Handle);
+
+    // The compute tessellation dispatches its compute shader on the graphics queue
+    if (m_tessCompute)
+    {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanParams.PhysicalDevice, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilyProperties(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_vulkanParams.PhysicalDevice, &queueFamilyCount, queueFamilyProperties.data());
+
+        if (!(queueFamilyProperties[m_vulkanParams.GraphicsQueue.FamilyIndex].queueFlags & VK_QUEUE_COMPUTE_BIT))
+        {
+            printf("The graphics queue doesn't support compute operations: the patches are tessellated by the tessellation shaders\n");
+            m_tessCompute = false;
+        }
+    }
     CreateSwapchain(&m_width, &m_height, VKApplication::settings.vsync);
     CreateDepthStencilImage(m_width, m_height);
     CreateRenderPass();
@@ -66,7 +145,11 @@ void VKTessellation::SetupPipeline()
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
+    if (m_tessCompute)
+        CreateTessellationCache();
+    ReportPipelineCreationTime();
 
     m_initialized = true;
 }
@@ -107,17 +190,15 @@ void VKTessellation::OnUpdate()
 // Render the scene.
 void VKTessellation::OnRender()
 {
-    // Ensure no more than MAX_FRAME_LAG frames are queued.
+    // Ensure no more than m_framesInFlight frames are queued.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
         if (acquire == VK_ERROR_OUT_OF_DATE_KHR)
@@ -126,6 +207,11 @@ void VKTessellation::OnRender()
             VK_CHECK_RESULT(acquire);
     }
 
+    // Select the patches to tessellate and to draw with the compute tessellation.
+    // This is done after waiting for the fence, since the jobs of the frame are written to a buffer of the frame.
+    if (m_tessCompute)
+        UpdateTessellationCache();
+
     PopulateCommandBuffer(imageIndex);
 
     SubmitCommandBuffer();
@@ -133,7 +219,7 @@ void VKTessellation::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKTessellation::OnDestroy()
@@ -143,25 +229,37 @@ void VKTessellation::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
+    // Report how many patches were found in the tessellation cache, and destroy it
+    if (m_tessCompute)
+    {
+        uint64_t draws = m_tessCacheHits + m_tessCacheMisses;
+        printf("Tessellation cache: %llu patches drawn, %llu hits (%.1f%%), %llu patches tessellated, %llu evictions, %llu patches skipped (cache full)\n",
+               (unsigned long long)draws, (unsigned long long)m_tessCacheHits, draws ? 100.0 * m_tessCacheHits / draws : 0.0,
+               (unsigned long long)m_tessCacheMisses, (unsigned long long)m_tessCacheEvictions, (unsigned long long)m_tessCacheFull);
+
+        DestroyTessellationCache();
+    }
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffers.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffers.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffers.IBmemory);
 
     // Destroy\Unmap frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Destroy dynamic buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
 
         // Wait for fence before destroying it
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -169,7 +267,7 @@ void VKTessellation::OnDestroy()
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingFinishedSemaphores[i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
     }
 
     // Destroy descriptor pool
@@ -180,8 +278,8 @@ void VKTessellation::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.GraphicsPipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -192,30 +290,45 @@ void VKTessellation::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
-                         m_sampleParams.GraphicsCommandPool,
-                          static_cast<uint32_t>(m_sampleParams.FrameRes.GraphicsCommandBuffers.size()), 
-                          m_sampleParams.FrameRes.GraphicsCommandBuffers.data());
+                         m_sampleParams.CommandPool,
+                          static_cast<uint32_t>(m_sampleParams.FrameRes.CommandBuffers.size()), 
+                          m_sampleParams.FrameRes.CommandBuffers.data());
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
     // Destroy command pool
-    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.GraphicsCommandPool, NULL);
+    vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -224,8 +337,12 @@ void VKTessellation::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -237,6 +354,9 @@ void VKTessellation::OnResize()
     // Recreate the projection matrix
     uBufVS.projectionMatrix = glm::perspectiveLH(glm::quarter_pi<float>(), (float)m_width/m_height, 0.01f, 100.0f);
 
+    // The tessellation levels depend on the size of the viewport
+    uBufVS.viewport = glm::vec4(static_cast<float>(m_width), static_cast<float>(m_height), 0.0f, 0.0f);
+
     // Update buffer data (light direction and color, and view and projection matrices)
     UpdateHostVisibleBufferData();
 }
@@ -279,9 +399,6 @@ void VKTessellation::CreateVertexBuffer()
         { { 25.0f, -15.0f, 10.0f } }
     };
 
-    size_t vertexBufferSize = static_cast<size_t>(patchVertices.size()) * sizeof(Vertex);
-    m_meshObjects["patchControlPoints"].vertexCount = static_cast<uint32_t>(patchVertices.size());
-
     // The indices of the control points are provided in order.
     std::vector<uint16_t> indices =
     {
@@ -291,27 +408,53 @@ void VKTessellation::CreateVertexBuffer()
 		12, 13, 14, 15
     };
 
+    // With --patches N, a terrain made of N x N patches of 10 x 10 units replaces the patch above.
+    // The control points form a grid of (3N + 1) x (3N + 1) points, and each patch indexes 4 x 4 of them:
+    // adjacent patches share the control points of their common edge, so the surface has no holes, and the TCS
+    // computes the same tessellation level for the edge in both patches, so there are no cracks either.
+    if (m_patchGridSize > 0)
+    {
+        const uint32_t gridSize = m_patchGridSize;
+        const uint32_t pointsPerRow = 3 * gridSize + 1;
+        const float spacing = 10.0f / 3.0f;
+        const float origin = -0.5f * spacing * (pointsPerRow - 1);
+
+        patchVertices.resize(pointsPerRow * pointsPerRow);
+        for (uint32_t y = 0; y < pointsPerRow; y++)
+        {
+            for (uint32_t x = 0; x < pointsPerRow; x++)
+            {
+                // Rolling hills
+                float px = origin + x * spacing;
+                float py = origin + y * spacing;
+                float height = 4.0f * sinf(px * 0.15f) * cosf(py * 0.11f) + 1.5f * sinf(px * 0.43f + py * 0.37f);
+                patchVertices[y * pointsPerRow + x] = { { px, py, height } };
+            }
+        }
+
+        indices.clear();
+        for (uint32_t py = 0; py < gridSize; py++)
+            for (uint32_t px = 0; px < gridSize; px++)
+                for (uint32_t i = 0; i < 4; i++)
+                    for (uint32_t j = 0; j < 4; j++)
+                        indices.push_back(static_cast<uint16_t>((3 * py + i) * pointsPerRow + 3 * px + j));
+    }
+
+    size_t vertexBufferSize = static_cast<size_t>(patchVertices.size()) * sizeof(Vertex);
+    m_meshObjects[m_meshPatchControlPoints].vertexCount = static_cast<uint32_t>(patchVertices.size());
+
     size_t indexBufferSize = static_cast<size_t>(indices.size()) * sizeof(uint16_t);
-    m_meshObjects["patchControlPoints"].indexCount = indices.size();
+    m_meshObjects[m_meshPatchControlPoints].indexCount = indices.size();
 
     //
     // Create the vertex and index buffers in host-visible device memory for convenience. 
     // This is not recommended as it can result in lower rendering performance.
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    vertexBufferInfo.size = static_cast<size_t>(patchVertices.size()) * sizeof(Vertex);
+    vertexBufferInfo.size = vertexBufferSize;
     vertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &vertexBufferInfo, nullptr, &m_vertexindexBuffers.VBbuffer));
 
@@ -319,37 +462,32 @@ void VKTessellation::CreateVertexBuffer()
     // enough to hold the vertex buffer.
     // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
     // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffers.VBmemory));
-
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, patchVertices.data(), static_cast<size_t>(patchVertices.size()) * sizeof(Vertex));
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory);
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffers.VBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffers.VBmemory);
 
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, m_vertexindexBuffers.VBmemory, 0));
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffers.VBmemory.MappedMemory, patchVertices.data(), vertexBufferSize);
 
     // Create the index buffer object
     VkBufferCreateInfo indexBufferInfo = {};
     indexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    indexBufferInfo.size = vertexBufferSize;
+    indexBufferInfo.size = indexBufferSize;
     indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;    
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &indexBufferInfo, nullptr, &m_vertexindexBuffers.IBbuffer));
 
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffers.IBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffers.IBmemory));
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffers.IBbuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_vertexindexBuffers.IBmemory);
 
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, indices.data(), indexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBmemory);
+    // Copy the data to the host-visible device memory, which is persistently mapped by the allocator.
+    memcpy(m_vertexindexBuffers.IBmemory.MappedMemory, indices.data(), indexBufferSize);
 
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBbuffer, m_vertexindexBuffers.IBmemory, 0));
+    // The compute tessellation computes the tessellation levels on the CPU
+    if (m_tessCompute)
+    {
+        m_controlPoints.resize(patchVertices.size());
+        for (size_t i = 0; i < patchVertices.size(); i++)
+            m_controlPoints[i] = patchVertices[i].position;
+        m_controlPointIndices = indices;
+        m_clipPositions.resize(patchVertices.size());
+    }
 }
 
 void VKTessellation::CreateHostVisibleBuffers()
@@ -370,15 +508,14 @@ void VKTessellation::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -414,15 +551,14 @@ void VKTessellation::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -441,30 +577,28 @@ void VKTessellation::UpdateHostVisibleBufferData()
 {
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
         memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
 void VKTessellation::UpdateHostVisibleDynamicBufferData()
 {
-    const float rotationSpeed = 0.8f;
-
     // Update the rotation angle
-    m_curRotationAngleRad += rotationSpeed * m_timer.GetElapsedSeconds();
+    m_curRotationAngleRad += m_rotationSpeed * m_timer.GetElapsedSeconds();
     if (m_curRotationAngleRad >= glm::two_pi<float>())
     {
         m_curRotationAngleRad -= glm::two_pi<float>();
     }
 
     // Rotate the patch around the z-axis
-    m_meshObjects["patchControlPoints"].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                        (m_meshObjects["patchControlPoints"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshPatchControlPoints].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
+                                        (m_meshObjects[m_meshPatchControlPoints].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
     
     glm::mat4 rotZ = glm::rotate(glm::identity<glm::mat4>(), m_curRotationAngleRad, glm::vec3(0.0f, 0.0f, 1.0f));
-    m_meshObjects["patchControlPoints"].meshInfo->worldMatrix = rotZ;
+    m_meshObjects[m_meshPatchControlPoints].meshInfo->worldMatrix = rotZ;
 
     // Set white color
-    m_meshObjects["patchControlPoints"].meshInfo->solidColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    m_meshObjects[m_meshPatchControlPoints].meshInfo->solidColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 
     // Update dynamic uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
@@ -482,22 +616,25 @@ void VKTessellation::CreateDescriptorPool()
     //
 
     // Describe the number of descriptors per type.
-    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer)
-    VkDescriptorPoolSize typeCounts[2];
+    // This sample uses two descriptor types (uniform buffer and dynamic uniform buffer), and the compute
+    // tessellation a descriptor set of three storage buffers per frame in flight.
+    VkDescriptorPoolSize typeCounts[3];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
+    typeCounts[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    typeCounts[2].descriptorCount = 3 * static_cast<uint32_t>(m_framesInFlight);
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
     VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
     descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptorPoolInfo.pNext = nullptr;
-    descriptorPoolInfo.poolSizeCount = 2;
+    descriptorPoolInfo.poolSizeCount = m_tessCompute ? 3 : 2;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight) * (m_tessCompute ? 2 : 1);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -508,19 +645,19 @@ void VKTessellation::CreateDescriptorSetLayout()
     // Create a Descriptor Set Layout to connect binding points (resource declarations)
     // in the shader code to descriptors within descriptor sets.
     //
-    // Binding 0: Uniform buffer (accessed by TES)
+    // Binding 0: Uniform buffer (accessed by VS, TCS and TES)
     VkDescriptorSetLayoutBinding layoutBinding[2] = {};
     layoutBinding[0].binding = 0;
     layoutBinding[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
     layoutBinding[0].descriptorCount = 1;
-    layoutBinding[0].stageFlags = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+    layoutBinding[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT | VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
     layoutBinding[0].pImmutableSamplers = nullptr;
 
-    // Binding 1: Dynamic uniform buffer (accessed by TES and FS)
+    // Binding 1: Dynamic uniform buffer (accessed by VS, TES and FS)
     layoutBinding[1].binding = 1;
     layoutBinding[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
     layoutBinding[1].descriptorCount = 1;
-    layoutBinding[1].stageFlags = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    layoutBinding[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
     layoutBinding[1].pImmutableSamplers = nullptr;
 
     VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
@@ -534,17 +671,17 @@ void VKTessellation::CreateDescriptorSetLayout()
 
 void VKTessellation::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets.resize(MAX_FRAME_LAG);
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets.data()));
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -553,13 +690,13 @@ void VKTessellation::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[2] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -567,7 +704,7 @@ void VKTessellation::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
@@ -798,9 +935,37 @@ void VKTessellation::CreatePipelineObjects()
     
     // Create a graphics pipeline for capturing particles updated by the VS work
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.GraphicsPipelines["WireframeNoCull"]));
+                                              &m_sampleParams.Pipelines[m_pipelineWireframeNoCull]));
+
+    //
+    // Wireframe with no culling, drawing the triangles of the patches tessellated by the compute shader
+    //
+
+    if (m_tessCompute)
+    {
+        VkShaderModule meshVS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/mesh.vert.spv");
+
+        // Vertex and fragment shaders only
+        shaderStages[0].module = meshVS;
+        assert(shaderStages[0].module != VK_NULL_HANDLE);
+        pipelineCreateInfo.stageCount = 2;
+
+        // The vertices in the cache are vec4 (written by the compute shader), of which the VS reads xyz
+        vertexInputBinding.stride = sizeof(glm::vec4);
+
+        // The grids are drawn as lists of triangles, with no tessellation state
+        inputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        pipelineCreateInfo.pTessellationState = nullptr;
+
+        VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
+                                                  m_pipelineCache, 1, 
+                                                  &pipelineCreateInfo, nullptr, 
+                                                  &m_sampleParams.Pipelines[m_pipelineMeshWireframeNoCull]));
+
+        vkDestroyShaderModule(m_vulkanParams.Device, meshVS, nullptr);
+    }
 
     //
     // Destroy shader modules
@@ -814,6 +979,402 @@ void VKTessellation::CreatePipelineObjects()
     vkDestroyShaderModule(m_vulkanParams.Device, renderFS, nullptr);
 }
 
+void VKTessellation::CreateTessellationCache()
+{
+    const uint32_t patchCount = static_cast<uint32_t>(m_controlPointIndices.size() / 16);
+
+    //
+    // Control points of the patches, read by the compute shader.
+    // They are stored patch by patch (16 control points each) so that the shader doesn't need the indices.
+    //
+    std::vector<glm::vec4> patchControlPoints(m_controlPointIndices.size());
+    for (size_t i = 0; i < m_controlPointIndices.size(); i++)
+        patchControlPoints[i] = glm::vec4(m_controlPoints[m_controlPointIndices[i]], 1.0f);
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = patchControlPoints.size() * sizeof(glm::vec4);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    CreateBuffer(m_memAllocator, bufferInfo, m_tessComputeParams.controlPoints, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    memcpy(m_tessComputeParams.controlPoints.MappedMemory, patchControlPoints.data(), bufferInfo.size);
+
+    m_tessComputeParams.controlPoints.Descriptor.buffer = m_tessComputeParams.controlPoints.Handle;
+    m_tessComputeParams.controlPoints.Descriptor.offset = 0;
+    m_tessComputeParams.controlPoints.Descriptor.range = bufferInfo.size;
+
+    //
+    // Slots of the cache and grids of each level.
+    // The cache is split evenly between the levels: the low levels get two slots per patch (enough for the
+    // tessellations of all the patches with their current levels and with the previous ones), while the high levels,
+    // which only the patches close to the camera need, get as many slots as fit in their part of the cache.
+    //
+    const size_t levelBudget = static_cast<size_t>(m_tessCacheMB) * 1024 * 1024 / s_tessCacheLevels;
+    std::vector<uint16_t> indices;
+    uint32_t vertexCount = 0;
+
+    for (uint32_t level = 0; level < s_tessCacheLevels; level++)
+    {
+        const uint32_t N = 1u << level;
+        TessCacheLevel& cache = m_tessCache[level];
+
+        cache.firstVertex = vertexCount;
+        cache.vertexCount = (N + 1) * (N + 1);
+        cache.firstIndex = static_cast<uint32_t>(indices.size());
+        cache.indexCount = 6 * N * N;
+
+        size_t slotCount = levelBudget / (cache.vertexCount * sizeof(glm::vec4));
+        slotCount = std::max(std::min(slotCount, static_cast<size_t>(2 * patchCount)), static_cast<size_t>(1));
+        vertexCount += static_cast<uint32_t>(slotCount) * cache.vertexCount;
+
+        // All the slots are free, in a LRU list from the first one to the last one
+        cache.slots.resize(slotCount);
+        for (uint32_t i = 0; i < slotCount; i++)
+        {
+            cache.slots[i].key = UINT32_MAX;
+            cache.slots[i].lastUsedFrame = 0;
+            cache.slots[i].prev = (i > 0) ? i - 1 : UINT32_MAX;
+            cache.slots[i].next = (i + 1 < slotCount) ? i + 1 : UINT32_MAX;
+        }
+        cache.mostRecent = 0;
+        cache.leastRecent = static_cast<uint32_t>(slotCount) - 1;
+
+        // Two triangles per cell of the grid. The vertex (a, b) of the grid, at u = a / N and v = b / N, is the vertex
+        // a * (N + 1) + b of the slot (see tessellate.comp).
+        for (uint32_t a = 0; a < N; a++)
+        {
+            for (uint32_t b = 0; b < N; b++)
+            {
+                uint16_t v00 = static_cast<uint16_t>(a * (N + 1) + b);
+                uint16_t v10 = static_cast<uint16_t>(v00 + N + 1);
+                indices.insert(indices.end(), { v00, v10, static_cast<uint16_t>(v10 + 1), v00, static_cast<uint16_t>(v10 + 1), static_cast<uint16_t>(v00 + 1) });
+            }
+        }
+    }
+
+    //
+    // Vertex cache, written by the compute shader and read as a vertex buffer
+    //
+    bufferInfo.size = static_cast<VkDeviceSize>(vertexCount) * sizeof(glm::vec4);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+    CreateBuffer(m_memAllocator, bufferInfo, m_tessComputeParams.vertices, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    m_tessComputeParams.vertices.Size = bufferInfo.size;
+
+    m_tessComputeParams.vertices.Descriptor.buffer = m_tessComputeParams.vertices.Handle;
+    m_tessComputeParams.vertices.Descriptor.offset = 0;
+    m_tessComputeParams.vertices.Descriptor.range = bufferInfo.size;
+
+    // Indices of the grids
+    bufferInfo.size = indices.size() * sizeof(uint16_t);
+    bufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+    CreateBuffer(m_memAllocator, bufferInfo, m_tessComputeParams.indices, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    memcpy(m_tessComputeParams.indices.MappedMemory, indices.data(), bufferInfo.size);
+
+    // Jobs of the frames in flight (at most one per patch)
+    bufferInfo.size = patchCount * sizeof(TessJob);
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    m_tessComputeParams.jobs.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
+    {
+        CreateBuffer(m_memAllocator, bufferInfo, m_tessComputeParams.jobs[i], VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        m_tessComputeParams.jobs[i].Descriptor.buffer = m_tessComputeParams.jobs[i].Handle;
+        m_tessComputeParams.jobs[i].Descriptor.offset = 0;
+        m_tessComputeParams.jobs[i].Descriptor.range = bufferInfo.size;
+    }
+
+    m_tessJobs.reserve(patchCount);
+    m_tessDraws.reserve(patchCount);
+
+    //
+    // Descriptor set layout and descriptor sets of the compute shader
+    //
+    // Binding 0: Control points
+    // Binding 1: Jobs
+    // Binding 2: Vertex cache
+    VkDescriptorSetLayoutBinding layoutBinding[3] = {};
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        layoutBinding[i].binding = i;
+        layoutBinding[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        layoutBinding[i].descriptorCount = 1;
+        layoutBinding[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
+    descriptorLayout.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorLayout.bindingCount = 3;
+    descriptorLayout.pBindings = layoutBinding;
+    VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_tessComputeParams.descriptorSetLayout));
+
+    VkDescriptorSetAllocateInfo allocInfo = {};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> descriptorSetLayouts(m_framesInFlight, m_tessComputeParams.descriptorSetLayout);
+    allocInfo.pSetLayouts = descriptorSetLayouts.data();
+
+    m_tessComputeParams.descriptorSets.resize(m_framesInFlight);
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_tessComputeParams.descriptorSets.data()));
+
+    for (size_t i = 0; i < m_framesInFlight; i++)
+    {
+        const VkDescriptorBufferInfo* bufferDescriptors[3] = {
+            &m_tessComputeParams.controlPoints.Descriptor,
+            &m_tessComputeParams.jobs[i].Descriptor,
+            &m_tessComputeParams.vertices.Descriptor
+        };
+
+        VkWriteDescriptorSet writeDescriptorSet[3] = {};
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            writeDescriptorSet[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSet[j].dstSet = m_tessComputeParams.descriptorSets[i];
+            writeDescriptorSet[j].descriptorCount = 1;
+            writeDescriptorSet[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeDescriptorSet[j].pBufferInfo = bufferDescriptors[j];
+            writeDescriptorSet[j].dstBinding = j;
+        }
+
+        vkUpdateDescriptorSets(m_vulkanParams.Device, 3, writeDescriptorSet, 0, nullptr);
+    }
+
+    //
+    // Pipeline layout and compute pipeline
+    //
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &m_tessComputeParams.descriptorSetLayout;
+    VK_CHECK_RESULT(vkCreatePipelineLayout(m_vulkanParams.Device, &pipelineLayoutCreateInfo, nullptr, &m_tessComputeParams.pipelineLayout));
+
+    VkShaderModule tessellateCS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/tessellate.comp.spv");
+
+    VkPipelineShaderStageCreateInfo shaderStage = {};
+    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStage.module = tessellateCS;
+    shaderStage.pName = "main";
+    assert(shaderStage.module != VK_NULL_HANDLE);
+
+    VkComputePipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.layout = m_tessComputeParams.pipelineLayout;
+    pipelineCreateInfo.stage = shaderStage;
+    VK_CHECK_RESULT(vkCreateComputePipelines(m_vulkanParams.Device, 
+                                              m_pipelineCache, 1, 
+                                              &pipelineCreateInfo, nullptr, 
+                                              &m_tessComputeParams.pipeline));
+
+    vkDestroyShaderModule(m_vulkanParams.Device, tessellateCS, nullptr);
+}
+
+void VKTessellation::DestroyTessellationCache()
+{
+    vkDestroyPipeline(m_vulkanParams.Device, m_tessComputeParams.pipeline, nullptr);
+    vkDestroyPipelineLayout(m_vulkanParams.Device, m_tessComputeParams.pipelineLayout, nullptr);
+    vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_tessComputeParams.descriptorSetLayout, nullptr);
+
+    BufferParameters* buffers[] = { &m_tessComputeParams.controlPoints, &m_tessComputeParams.vertices, &m_tessComputeParams.indices };
+    for (BufferParameters* buffer : buffers)
+    {
+        vkDestroyBuffer(m_vulkanParams.Device, buffer->Handle, nullptr);
+        m_memAllocator.Free(buffer->Allocation);
+    }
+
+    for (BufferParameters& jobs : m_tessComputeParams.jobs)
+    {
+        vkDestroyBuffer(m_vulkanParams.Device, jobs.Handle, nullptr);
+        m_memAllocator.Free(jobs.Allocation);
+    }
+}
+
+// Tessellation level of an edge (log2 of a power of two), from the control points points[0], points[stride], 
+// points[2 * stride] and points[3 * stride].
+// Same metric as EdgeLevel in render.tesc: the length in pixels of the control polygon, summed in an order that doesn't
+// depend on the direction of the edge, so that the patches sharing the edge compute exactly the same level for it.
+uint32_t VKTessellation::GetEdgeLevel(const uint16_t* points, uint32_t stride) const
+{
+    glm::vec2 p[4];
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        const glm::vec4& clipPos = m_clipPositions[points[i * stride]];
+        p[i] = glm::vec2(clipPos) / std::max(clipPos.w, 0.0001f) * 0.5f * glm::vec2(uBufVS.viewport);
+    }
+
+    float edgeLength = (glm::distance(p[0], p[1]) + glm::distance(p[2], p[3])) + glm::distance(p[1], p[2]);
+    float level = std::min(std::max(edgeLength / m_tessPixels, 1.0f), static_cast<float>(1u << (s_tessCacheLevels - 1)));
+
+    // Round up to a power of two
+    return static_cast<uint32_t>(ceilf(log2f(level)));
+}
+
+void VKTessellation::UpdateTessellationCache()
+{
+    m_tessCacheFrame++;
+    m_tessJobs.clear();
+    m_tessDraws.clear();
+
+    // Control points in clip space
+    const glm::mat4 worldViewProj = uBufVS.projectionMatrix * uBufVS.viewMatrix * m_meshObjects[m_meshPatchControlPoints].meshInfo->worldMatrix;
+    for (size_t i = 0; i < m_controlPoints.size(); i++)
+        m_clipPositions[i] = worldViewProj * glm::vec4(m_controlPoints[i], 1.0f);
+
+    // With --tess-fixed all the edges have the same level, rounded up to a power of two
+    uint32_t fixedLevel = 0;
+    if (m_tessFixedLevel > 0.0f)
+        fixedLevel = std::min(static_cast<uint32_t>(ceilf(log2f(std::max(m_tessFixedLevel, 1.0f)))), s_tessCacheLevels - 1);
+
+    const uint32_t patchCount = static_cast<uint32_t>(m_controlPointIndices.size() / 16);
+    for (uint32_t patch = 0; patch < patchCount; patch++)
+    {
+        const uint16_t* points = &m_controlPointIndices[16 * patch];
+
+        // A Bézier patch lies in the convex hull of its control points, so it's outside the view frustum
+        // if all the control points are outside the same plane of the frustum (as in render.tesc).
+        int outside = 0x3f;
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            const glm::vec4& p = m_clipPositions[points[i]];
+            int planes = (p.x < -p.w ? 0x01 : 0) | (p.x > p.w ? 0x02 : 0) |
+                         (p.y < -p.w ? 0x04 : 0) | (p.y > p.w ? 0x08 : 0) |
+                         (p.z < 0.0f ? 0x10 : 0) | (p.z > p.w ? 0x20 : 0);
+            outside &= planes;
+        }
+        if (outside != 0 && m_tessFixedLevel == 0.0f)
+            continue;
+
+        // Levels of the edges u = 0, v = 0, u = 1 and v = 1, and inner level (the max level of the edges)
+        uint32_t edgeLevels[4] = { fixedLevel, fixedLevel, fixedLevel, fixedLevel };
+        if (m_tessFixedLevel == 0.0f)
+        {
+            edgeLevels[0] = GetEdgeLevel(points, 1);
+            edgeLevels[1] = GetEdgeLevel(points, 4);
+            edgeLevels[2] = GetEdgeLevel(points + 12, 1);
+            edgeLevels[3] = GetEdgeLevel(points + 3, 4);
+        }
+        uint32_t innerLevel = std::max(std::max(edgeLevels[0], edgeLevels[1]), std::max(edgeLevels[2], edgeLevels[3]));
+
+        uint32_t levels = innerLevel | (edgeLevels[0] << 4) | (edgeLevels[1] << 8) | (edgeLevels[2] << 12) | (edgeLevels[3] << 16);
+        uint32_t key = (patch << 20) | levels;
+
+        TessCacheLevel& cache = m_tessCache[innerLevel];
+        uint32_t slot;
+
+        std::unordered_map<uint32_t, uint32_t>::iterator it = m_tessCacheLookup.find(key);
+        if (it != m_tessCacheLookup.end())
+        {
+            // The patch has already been tessellated with these levels
+            slot = it->second;
+            m_tessCacheHits++;
+        }
+        else
+        {
+            // Tessellate the patch into the least recently used slot of the level, unless it's drawn in this frame
+            // as well (in which case all the slots of the level are, and the patch can't be drawn).
+            slot = cache.leastRecent;
+            if (cache.slots[slot].lastUsedFrame == m_tessCacheFrame)
+            {
+                if (m_tessCacheFull++ == 0)
+                    printf("The tessellation cache is too small for the patches with level %u: increase --tess-cache-mb\n", 1u << innerLevel);
+                continue;
+            }
+
+            if (cache.slots[slot].key != UINT32_MAX)
+            {
+                m_tessCacheLookup.erase(cache.slots[slot].key);
+                m_tessCacheEvictions++;
+            }
+
+            cache.slots[slot].key = key;
+            m_tessCacheLookup[key] = slot;
+            m_tessCacheMisses++;
+
+            TessJob job = { patch, cache.firstVertex + slot * cache.vertexCount, levels, 0 };
+            m_tessJobs.push_back(job);
+        }
+
+        // Move the slot to the front of the LRU list
+        TessCacheSlot& cacheSlot = cache.slots[slot];
+        if (cache.mostRecent != slot)
+        {
+            cache.slots[cacheSlot.prev].next = cacheSlot.next;
+            if (cacheSlot.next != UINT32_MAX)
+                cache.slots[cacheSlot.next].prev = cacheSlot.prev;
+            else
+                cache.leastRecent = cacheSlot.prev;
+
+            cacheSlot.prev = UINT32_MAX;
+            cacheSlot.next = cache.mostRecent;
+            cache.slots[cache.mostRecent].prev = slot;
+            cache.mostRecent = slot;
+        }
+        cacheSlot.lastUsedFrame = m_tessCacheFrame;
+
+        TessDraw draw = { innerLevel, cache.firstVertex + slot * cache.vertexCount };
+        m_tessDraws.push_back(draw);
+    }
+
+    // Write the jobs of the frame
+    if (!m_tessJobs.empty())
+        memcpy(m_tessComputeParams.jobs[m_frameIndex].MappedMemory, m_tessJobs.data(), m_tessJobs.size() * sizeof(TessJob));
+}
+
+void VKTessellation::RecordTessellation(VkCommandBuffer commandBuffer)
+{
+    if (m_tessJobs.empty())
+        return;
+
+    // The slots being overwritten may still be read as vertex buffer by the draws of the previous frames:
+    // wait for them to be done with the vertex input stage (write-after-read hazards only need an execution dependency).
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                         0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    // One workgroup per patch to tessellate
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_tessComputeParams.pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_tessComputeParams.pipelineLayout, 
+                            0, 1, &m_tessComputeParams.descriptorSets[m_frameIndex], 0, nullptr);
+    vkCmdDispatch(commandBuffer, static_cast<uint32_t>(m_tessJobs.size()), 1, 1);
+
+    // Make the vertices written by the compute shader visible to the vertex input stage
+    VkBufferMemoryBarrier bufferBarrier = {};
+    bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    bufferBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+    bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    bufferBarrier.buffer = m_tessComputeParams.vertices.Handle;
+    bufferBarrier.offset = 0;
+    bufferBarrier.size = VK_WHOLE_SIZE;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 
+                         0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+}
+
+void VKTessellation::DrawTessellatedPatches(VkCommandBuffer commandBuffer)
+{
+    // Bind the vertex cache and the indices of the grids
+    VkDeviceSize offsets[1] = { 0 };
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &m_tessComputeParams.vertices.Handle, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, m_tessComputeParams.indices.Handle, 0, VK_INDEX_TYPE_UINT16);
+
+    uint32_t dynamicOffset = m_meshObjects[m_meshPatchControlPoints].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_sampleParams.Pipelines[m_pipelineMeshWireframeNoCull]);
+    vkCmdBindDescriptorSets(commandBuffer, 
+                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                            m_sampleParams.PipelineLayout, 
+                            0, 1, 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                            1, &dynamicOffset);
+
+    // One draw per patch: the indices of the grid of its level, offset to the first vertex of its slot
+    for (const TessDraw& draw : m_tessDraws)
+    {
+        const TessCacheLevel& cache = m_tessCache[draw.level];
+        vkCmdDrawIndexed(commandBuffer, cache.indexCount, 1, cache.firstIndex, static_cast<int32_t>(draw.firstVertex), 0);
+    }
+}
+
 void VKTessellation::PopulateCommandBuffer(uint32_t currentImageIndex)
 {
     VkCommandBufferBeginInfo cmdBufInfo = {};
@@ -840,11 +1401,15 @@ void VKTessellation::PopulateCommandBuffer(uint32_t currentImageIndex)
     // Set the frame buffer to specify the color attachment (render target) where to draw the current frame.
     renderPassBeginInfo.framebuffer = m_sampleParams.Framebuffers[currentImageIndex];
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &cmdBufInfo));
+    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
+
+    // Tessellate the patches missing from the cache (outside the render pass, as dispatches aren't allowed inside)
+    if (m_tessCompute)
+        RecordTessellation(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
 
     // Begin the render pass instance.
     // This will clear the color attachment.
-    vkCmdBeginRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     // Update dynamic viewport state
     VkViewport viewport = {};
@@ -852,7 +1417,7 @@ void VKTessellation::PopulateCommandBuffer(uint32_t currentImageIndex)
     viewport.width = (float)m_width;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &viewport);
+    vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Update dynamic scissor state
     VkRect2D scissor = {};
@@ -860,43 +1425,51 @@ void VKTessellation::PopulateCommandBuffer(uint32_t currentImageIndex)
     scissor.extent.height = m_height;
     scissor.offset.x = 0;
     scissor.offset.y = 0;
-    vkCmdSetScissor(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &scissor);
+    vkCmdSetScissor(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &scissor);
     
-    // Bind the vertex buffer (with positions)
-    VkDeviceSize offsets[1] = { 0 };
-    vkCmdBindVertexBuffers(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffers.VBbuffer, offsets);
-
-    // Bind the index buffer
-    vkCmdBindIndexBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_vertexindexBuffers.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
+    if (m_tessCompute)
+    {
+        // Draw the grids of vertices of the patches tessellated by the compute shader
+        DrawTessellatedPatches(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
+    }
+    else
+    {
+        // Bind the vertex buffer (with positions)
+        VkDeviceSize offsets[1] = { 0 };
+        vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_vertexindexBuffers.VBbuffer, offsets);
 
-    //
-    // Draw patch
-    //
+        // Bind the index buffer
+        vkCmdBindIndexBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffers.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
 
-    // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
-    uint32_t dynamicOffset = m_meshObjects["patchControlPoints"].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+        //
+        // Draw patch
+        //
 
-    // Bind the graphics pipeline for capturing updated particles
-    vkCmdBindPipeline(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
-                        VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                        m_sampleParams.GraphicsPipelines["WireframeNoCull"]);
+        // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
+        uint32_t dynamicOffset = m_meshObjects[m_meshPatchControlPoints].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
 
-    // Bind descriptor sets for drawing a mesh using a dynamic offset
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], 
+        // Bind the graphics pipeline for capturing updated particles
+        vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                             VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[m_frameIndex], 
-                            1, &dynamicOffset);
-
-    // "Draw" the grid of control points describing the patch
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex], m_meshObjects["patchControlPoints"].indexCount, 1, 0, 0, 0);
+                            m_sampleParams.Pipelines[m_pipelineWireframeNoCull]);
+
+        // Bind descriptor sets for drawing a mesh using a dynamic offset
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                m_sampleParams.PipelineLayout, 
+                                0, 1, 
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphics][m_frameIndex], 
+                                1, &dynamicOffset);
+
+        // "Draw" the grid of control points describing the patch
+        vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[m_meshPatchControlPoints].indexCount, 1, 0, 0, 0);
+    }
 
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
-    vkCmdEndRenderPass(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]);
+    vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
     
-    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex]));
+    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKTessellation::SubmitCommandBuffer()
@@ -909,13 +1482,13 @@ void VKTessellation::SubmitCommandBuffer()
     submitInfo.pWaitDstStageMask = &waitStageMask;                                                // Pointer to the list of pipeline stages that the semaphore waits will occur at
     submitInfo.waitSemaphoreCount = 1;                                                            // One wait semaphore
     submitInfo.signalSemaphoreCount = 1;                                                          // One signal semaphore
-    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.GraphicsCommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
+    submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];   // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
     submitInfo.pWaitSemaphores = &m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex];        // Semaphore(s) to wait upon before the submitted command buffers start executing
-    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pSignalSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKTessellation::PresentImage(uint32_t currentImageIndex)
@@ -930,13 +1503,13 @@ void VKTessellation::PresentImage(uint32_t currentImageIndex)
     presentInfo.pSwapchains = &m_vulkanParams.SwapChain.Handle;
     presentInfo.pImageIndices = &currentImageIndex;
     // Check if a wait semaphore has been specified to wait for before presenting the image
-    if (m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex] != VK_NULL_HANDLE)
+    if (m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] != VK_NULL_HANDLE)
     {
         presentInfo.waitSemaphoreCount = 1;
-        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingFinishedSemaphores[m_frameIndex];
+        presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -0,0 +1,21 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec2 inTexCoord;
+layout (location = 0) out vec4 outFragColor;
+
+// Textures of the bindless descriptor set, addressed by index
+layout (set = 0, binding = 0) uniform sampler2D textures[];
+
+layout(push_constant) uniform PushConstants {
+    uint frameBuffer;
+    uint meshBuffer;
+    uint meshIndex;
+    uint texture;
+} pc;
+
+
+void main() 
+{
+  outFragColor = texture(textures[pc.texture], inTexCoord.xy);
+}
\ No newline at end of file
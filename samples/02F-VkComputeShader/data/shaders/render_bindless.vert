@@ -0,0 +1,35 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec2 inTextCoord;
+
+layout (location = 0) out vec2 outTextCoord;
+
+// Storage buffers of the bindless descriptor set, addressed by index.
+// The same array is declared twice to access the buffers with different layouts.
+layout(std430, set = 0, binding = 1) readonly buffer FrameBuf {
+    mat4 View;
+    mat4 Projection;
+} frameBufs[];
+
+layout(std430, set = 0, binding = 1) readonly buffer MeshBuf {
+    mat4 World[];
+} meshBufs[];
+
+layout(push_constant) uniform PushConstants {
+    uint frameBuffer;    // Index of the buffer with the view and projection matrices
+    uint meshBuffer;     // Index of the buffer with the world matrices
+    uint meshIndex;      // Index of the world matrix of the object to draw
+    uint texture;        // Index of the texture to map on the object (see render_bindless.frag)
+} pc;
+
+
+void main() 
+{
+    mat4 world = meshBufs[pc.meshBuffer].World[pc.meshIndex];
+    outTextCoord = inTextCoord;                                      // Pass texture coordinates to the next stage
+    vec4 worldPos = world * vec4(inPos, 1.0);                        // Local to World
+    vec4 viewPos = frameBufs[pc.frameBuffer].View * worldPos;        // World to View
+    gl_Position = frameBufs[pc.frameBuffer].Projection * viewPos;    // View to Clip
+}
\ No newline at end of file
@@ -2,6 +2,11 @@
 
 #include "VKSample.hpp"
 #include "VKSampleHelper.hpp"
+#include "VKBindless.hpp"
+#include "VKComputeTuner.hpp"
+#include "VKTextureLoader.hpp"
+#include "VKTextureSynth.hpp"
+#include "VKJobSystem.hpp"
 
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "glm/glm.hpp"
@@ -40,18 +45,23 @@ private:
     void AllocateDescriptorSets();          // Allocate a descriptor set
     void CreatePipelineLayout();            // Create a pipeline layout
     void CreatePipelineObjects();           // Create a pipeline object
+    bool RegisterBindlessResources();       // Add the textures and buffers to the bindless descriptor set
 
     // Update buffer data
     void UpdateHostVisibleBufferData();
     void UpdateHostVisibleDynamicBufferData();
 
     // Texture creation
-    std::vector<uint8_t> GenerateTextureData();  // Generate texture data
-    void CreateStagingBuffer();                  // Create a staging buffer
-    void CreateInputTexture();                   // Create input texture
-    void CreateOutputTextures();                 // Create output textures
+    std::vector<uint8_t> GenerateTextureData();                                       // Generate texture data
+    bool LoadTextureData(const std::string& fileName, std::vector<uint8_t>& data);   // Load texture data from a PPM file
+    bool LoadTextureFile(const std::string& fileName, VKTextureLoader& textureFile);  // Load a texture from a KTX2 file
+    void BlitCompressedTexture(const VKTextureLoader& textureFile);                   // Decompress a texture into the input texture with a blit
+    void CreateInputTexture();                                                        // Create input texture
+    void CreateOutputTextures();                                                      // Create output and intermediate textures
+    void CreateHistogramBuffer();                                                     // Create the buffer storing the histogram computed by the levels filter
 
     // Compute setup and operations
+    void BuildComputeChain();
     void PrepareCompute();
     void PopulateComputeCommandBuffer();
     void SubmitComputeCommandBuffer();
@@ -95,9 +105,9 @@ private:
     
     // Vertex and index buffers
     struct {
-        VkDeviceMemory VBmemory; // Handle to the device memory backing the vertex buffer
+        MemoryAllocation VBmemory; // Device memory (sub-allocation) backing the vertex buffer
         VkBuffer VBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
-        VkDeviceMemory IBmemory; // Handle to the device memory backing the index buffer
+        MemoryAllocation IBmemory; // Device memory (sub-allocation) backing the index buffer
         VkBuffer IBbuffer;       // Handle to the Vulkan buffer object that the memory is bound to
         size_t indexBufferCount; // Number of indices
     } m_vertexindexBuffers;
@@ -115,12 +125,11 @@ private:
 
     // Texture info and data
     struct Texture2D {
-        BufferParameters StagingBuffer;    // Staging buffer
         ImageParameters  TextureImage;     // Texture image
 
-        // Texture and texel dimensions
-        const uint32_t TextureWidth = 256;
-        const uint32_t TextureHeight = 256;
+        // Texture and texel dimensions (the output and intermediate textures have the same size as the input one)
+        uint32_t TextureWidth = 256;
+        uint32_t TextureHeight = 256;
         const uint32_t TextureTexelSize = 4;  // The number of bytes used to represent a texel in the texture.
     };
 
@@ -129,7 +138,7 @@ private:
     const unsigned int m_numDrawCalls = 1;
 
     // Mesh objects to draw
-    std::map<std::string, MeshObject> m_meshObjects;
+    VKHandleTable<MeshObject> m_meshObjects;
 
     // Input texture and a set of output textures used to store the result of compute processing (one for each frame in flight).
     Texture2D m_inputTexture;
@@ -138,6 +147,151 @@ private:
     // Compute resources and variables
     SampleParameters m_sampleComputeParams;
 
+    //
+    // Chain of compute filters (--filters)
+    //
+    // Each filter is executed by one or more compute passes: the first pass reads the input texture, the last one
+    // writes the output texture of the frame, and the passes in between write to two intermediate textures
+    // used in turn (ping-pong), whatever the length of the chain. The intermediate textures are shared by all
+    // the frames in flight.
+    //
+
+    // Push constants with the parameters of a compute pass. The same block is declared by all the filter shaders:
+    //
+    // layout(push_constant) uniform FilterParams {
+    //     ivec2 direction;    // Direction of a blur pass ((1, 0) or (0, 1))
+    //     float sigma;        // Standard deviation of the spatial Gaussian of blur, convolution and bilateral filters
+    //     float rangeSigma;   // Standard deviation of the range Gaussian of the bilateral filter
+    //     float clipLow;      // Fraction of the texels clipped to black by the levels filter
+    //     float clipHigh;     // Fraction of the texels clipped to white by the levels filter
+    // } params;
+    //
+    struct FilterParams {
+        int32_t direction[2];
+        float sigma;
+        float rangeSigma;
+        float clipLow;
+        float clipHigh;
+    };
+
+    // Resources accessed by the compute passes (as bit masks)
+    enum ComputeResource {
+        COMPUTE_INPUT_TEXTURE  = 1 << 0,
+        COMPUTE_PING_TEXTURE   = 1 << 1,
+        COMPUTE_PONG_TEXTURE   = 1 << 2,
+        COMPUTE_OUTPUT_TEXTURE = 1 << 3,
+        COMPUTE_HISTOGRAM      = 1 << 4
+    };
+
+    // Compute shaders executing the filters
+    enum FilterShader {
+        FILTER_LUMINANCE,
+        FILTER_BLUR,
+        FILTER_SOBEL,
+        FILTER_HISTOGRAM,
+        FILTER_LEVELS,
+        FILTER_BILATERAL,
+        FILTER_CONVOLVE,
+        FILTER_SHADER_COUNT
+    };
+
+    // Specialization constants of the filter shaders, set when their pipelines are created:
+    //
+    // layout (local_size_x_id = 0, local_size_y_id = 1) in;    // Workgroup size
+    // layout (constant_id = 2) const int RADIUS;                // Radius of the kernel (blur, bilateral and convolve)
+    // layout (constant_id = 3) const int KERNEL;                // Kernel of the convolution (convolve)
+    //
+    // The histogram and levels shaders have a fixed workgroup size (one invocation per bin of the histogram).
+    struct FilterSpecialization {
+        uint32_t groupSizeX;
+        uint32_t groupSizeY;
+        int32_t radius;
+        int32_t kernel;
+    };
+
+    struct ComputePass {
+        std::string name;               // Name of the pass (and of its profiler scope)
+        FilterShader shader;
+        FilterSpecialization specialization;
+        TableHandle pipeline;           // Compute pipeline executing the pass (one for each variant of a shader)
+        FilterParams params;
+        uint32_t srcTexture;            // Texture read by the pass (binding 0)
+        uint32_t dstTexture;            // Texture written by the pass (binding 1), or 0 if it writes no texture
+        uint32_t reads;                 // Resources read by the pass
+        uint32_t writes;                // Resources written by the pass
+        uint32_t threadCountX;          // Number of invocations to dispatch (rounded up to whole workgroups)
+        uint32_t threadCountY;
+        bool tunable;                   // The workgroup size can be selected by the auto-tuner
+
+        // Barrier recorded before the pass, if it accesses resources written or read by the previous passes.
+        // Only the writes to the resources accessed by the pass are made visible to it.
+        bool barrier;
+        uint32_t barrierResources;      // Resources written by previous passes and accessed by this one
+        VkPipelineStageFlags barrierSrcStages;
+    };
+
+    void CreateStorageTexture(Texture2D& texture, VkImageUsageFlags usage);
+    void InsertComputeBarrier(VkCommandBuffer commandBuffer, const ComputePass& pass);
+    Texture2D& GetComputeTexture(uint32_t resource, uint32_t frameIndex);
+    VkPipeline CreateFilterPipeline(VkShaderModule shaderModule, const FilterSpecialization& specialization);
+    void TuneComputePass(VKComputeTuner& tuner, size_t passIndex, VkShaderModule shaderModule);
+    void RecordComputePass(VkCommandBuffer commandBuffer, const ComputePass& pass, const FilterSpecialization& specialization,
+                           VkPipeline pipeline, VkDescriptorSet descriptorSet);
+    static uint32_t GetSharedMemorySize(FilterShader shader, const FilterSpecialization& specialization);
+
+    std::string m_filterChain;                 // Comma-separated list of filters
+    std::vector<ComputePass> m_computePasses;
+    Texture2D m_intermediateTextures[2];       // Ping-pong textures
+    BufferParameters m_histogramBuffer;        // Histogram of the luminance (256 bins) computed for the levels filter
+    bool m_clearHistogram;                     // The histogram buffer is cleared at the beginning of the compute work
+    bool m_autotune;                           // Select the fastest workgroup size of each pass at setup (--autotune)
+
+    // Input image (--input file.ppm or file.ktx2), or size and pattern of the generated one (--input-size N, --pattern name)
+    std::string m_inputFile;
+    uint32_t m_inputSize;
+    VKTextureSynth::Pattern m_inputPattern;
+
+    // Bindless mode (--bindless).
+    // The textures and the per-frame buffers are registered once in a single descriptor set with 
+    // update-after-bind arrays of combined image samplers and storage buffers (see VKBindless), bound once
+    // per command buffer. The draws select their resources by index through push constants:
+    //
+    // layout(push_constant) uniform PushConstants {
+    //     uint frameBuffer;    // Index of the buffer with the view and projection matrices
+    //     uint meshBuffer;     // Index of the buffer with the world matrices
+    //     uint meshIndex;      // Index of the world matrix of the object to draw
+    //     uint texture;        // Index of the texture to map on the object
+    // } pc;
+    //
+    struct BindlessPushConstants {
+        uint32_t frameBuffer;
+        uint32_t meshBuffer;
+        uint32_t meshIndex;
+        uint32_t texture;
+    };
+
+    // Indices of the resources in the bindless descriptor set (one for each frame in flight, except the input texture)
+    struct {
+        std::vector<uint32_t> frameBuffers;
+        std::vector<uint32_t> meshBuffers;
+        std::vector<uint32_t> outputTextures;
+        uint32_t inputTexture;
+    } m_bindlessIndices;
+
+    bool m_bindless;
+    VKBindless m_bindlessSet;
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT m_descriptorIndexingFeatures;  // Chained to the device creation info
+
+    // Handles of the named pipelines, mesh objects, descriptor sets and semaphores (registered in the constructor,
+    // except the compute pipelines: one is registered for each variant of the filter shaders used by the chain)
+    TableHandle m_pipelineRender;
+    TableHandle m_meshQuad;
+    TableHandle m_descSetPreCompute;
+    TableHandle m_descSetPostCompute;
+    TableHandle m_descSetCompute;
+    TableHandle m_semaphoreCompComplete;
+    TableHandle m_semaphoreGraphComplete;
+
     // Sample members
     size_t m_dynamicUBOAlignment;
 };
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include <vector>
 #include <map>
 #include <array>
+#include <chrono>
 #include <string.h>
 #include <assert.h>
 
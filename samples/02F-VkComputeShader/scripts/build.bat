@@ -13,7 +13,7 @@ if exist "%VULKAN_SDK%\Include\vulkan\vulkan.h" (
     SET VULKAN_INCLUDE=..\..\external\include\vulkan
 )
 
-SET includes=/I inc /I ..\..\external\include ^
+SET includes=/I inc /I ..\..\framework\inc /I ..\..\external\include ^
 /I %VULKAN_INCLUDE%
 
 SET defines=/D DEBUG /D _WIN32 /D VK_USE_PLATFORM_WIN32_KHR /D _CRT_SECURE_NO_WARNINGS
@@ -31,10 +31,18 @@ echo Compiling shader...
 
 ..\..\bin\glslangValidator -V -g .\data\shaders\render.vert -o .\data\shaders\render.vert.spv
 ..\..\bin\glslangValidator -V -g .\data\shaders\render.frag -o .\data\shaders\render.frag.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\render_bindless.vert -o .\data\shaders\render_bindless.vert.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\render_bindless.frag -o .\data\shaders\render_bindless.frag.spv
 ..\..\bin\glslangValidator -V -g .\data\shaders\luminance.comp -o .\data\shaders\luminance.comp.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\blur.comp -o .\data\shaders\blur.comp.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\sobel.comp -o .\data\shaders\sobel.comp.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\histogram.comp -o .\data\shaders\histogram.comp.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\levels.comp -o .\data\shaders\levels.comp.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\bilateral.comp -o .\data\shaders\bilateral.comp.spv
+..\..\bin\glslangValidator -V -g .\data\shaders\convolve.comp -o .\data\shaders\convolve.comp.spv
 
 echo Building project...
 
-cl src/*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
+cl src/*.cpp ..\..\framework\src\*.cpp /MDd /EHsc /JMC /ZI %includes% %defines% %links%
 
 del *.obj vc*.idb vc*.pdb
\ No newline at end of file
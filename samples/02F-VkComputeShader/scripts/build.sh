@@ -7,20 +7,33 @@ else
     VULKAN_INCLUDE=../../external/include/vulkan/
 fi
 
-includes="-Iinc -I../../external/include/ -I$VULKAN_INCLUDE"
+includes="-Iinc -I../../framework/inc -I../../external/include/ -I$VULKAN_INCLUDE"
 
 defines="-DDEBUG -DVK_USE_PLATFORM_XLIB_KHR"
 
-links="-lX11 -lvulkan"
+links="-L../../framework/lib -lvkframework -lX11 -lvulkan -lpthread"
 
 echo Compiling shader...
 
 /../../bin/glslangValidator -V -g ./data/shaders/render.vert -o ./data/shaders/render.vert.spv
 /../../bin/glslangValidator -V -g ./data/shaders/render.frag -o ./data/shaders/render.frag.spv
+/../../bin/glslangValidator -V -g ./data/shaders/render_bindless.vert -o ./data/shaders/render_bindless.vert.spv
+/../../bin/glslangValidator -V -g ./data/shaders/render_bindless.frag -o ./data/shaders/render_bindless.frag.spv
 /../../bin/glslangValidator -V -g ./data/shaders/luminance.comp -o ./data/shaders/luminance.comp.spv
+/../../bin/glslangValidator -V -g ./data/shaders/blur.comp -o ./data/shaders/blur.comp.spv
+/../../bin/glslangValidator -V -g ./data/shaders/sobel.comp -o ./data/shaders/sobel.comp.spv
+/../../bin/glslangValidator -V -g ./data/shaders/histogram.comp -o ./data/shaders/histogram.comp.spv
+/../../bin/glslangValidator -V -g ./data/shaders/levels.comp -o ./data/shaders/levels.comp.spv
+/../../bin/glslangValidator -V -g ./data/shaders/bilateral.comp -o ./data/shaders/bilateral.comp.spv
+/../../bin/glslangValidator -V -g ./data/shaders/convolve.comp -o ./data/shaders/convolve.comp.spv
+
+if [ "$SKIP_FRAMEWORK" != "1" ]; then
+    (cd ../../framework && bash scripts/build.sh) || exit 1
+fi
 
 echo Building project...
 
-g++ -g src/*.cpp -o 02F-VkComputeShader.out $includes $defines $links
+source ../../scripts/compile.sh
 
-rm -f *.o
\ No newline at end of file
+compile_sources obj "$includes $defines" src/*.cpp || exit 1
+link_executable 02F-VkComputeShader.out ../../framework/lib/libvkframework.a "$links" $OBJECTS || exit 1
\ No newline at end of file
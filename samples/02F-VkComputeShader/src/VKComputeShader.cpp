@@ -3,6 +3,7 @@
 #include "VKComputeShader.hpp"
 #include "VKDebug.hpp"
 #include "MathHelper.hpp"
+#include <fstream>
 
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/ext/scalar_constants.hpp"
@@ -13,15 +14,62 @@
 #define DESC_SET_COMPUTE "DescSetCompute"
 #define PIPELINE_RENDER "PipelineRender"
 #define PIPELINE_LUMINANCE "PipelineLuminance"
+#define PIPELINE_BLUR "PipelineBlur"
+#define PIPELINE_SOBEL "PipelineSobel"
+#define PIPELINE_HISTOGRAM "PipelineHistogram"
+#define PIPELINE_LEVELS "PipelineLevels"
+#define PIPELINE_BILATERAL "PipelineBilateral"
+#define PIPELINE_CONVOLVE "PipelineConvolve"
 #define SEMAPHORE_GRAPH_COMPLETE "SemaphoreGraphicsComplete"
 #define SEMAPHORE_COMP_COMPLETE "SemaphoreComputeComplete"
 
+// Max number of compute passes in the chain of filters (each one is profiled in its own scope)
+#define MAX_COMPUTE_PASSES 12
+
+// Default workgroup sizes of the filter shaders (the histogram and levels shaders always use 16x16 workgroups)
+#define FILTER_TILE_SIZE 16
+#define BLUR_GROUP_SIZE 256
+
+// Max radius of the filters (the shared memory used by a workgroup grows with the radius)
+#define BLUR_MAX_RADIUS 32
+#define BILATERAL_MAX_RADIUS 8
+#define CONVOLVE_MAX_RADIUS 8
+
+// Kernels of the convolution (see KERNEL in convolve.comp)
+#define CONVOLVE_KERNEL_BOX 0
+#define CONVOLVE_KERNEL_GAUSSIAN 1
+#define CONVOLVE_KERNEL_SHARPEN 2
+
+// Name prefixes of the pipelines and SPIR-V files of the filter shaders (indexed by FilterShader)
+static const char* const s_filterPipelineNames[] = {
+    PIPELINE_LUMINANCE, PIPELINE_BLUR, PIPELINE_SOBEL, PIPELINE_HISTOGRAM, PIPELINE_LEVELS, PIPELINE_BILATERAL, PIPELINE_CONVOLVE
+};
+static const char* const s_filterShaderFiles[] = {
+    "luminance.comp.spv", "blur.comp.spv", "sobel.comp.spv", "histogram.comp.spv", "levels.comp.spv", "bilateral.comp.spv", "convolve.comp.spv"
+};
+
 VKComputeShader::VKComputeShader(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
+m_filterChain("luminance"),
+m_clearHistogram(false),
+m_autotune(false),
+m_inputSize(0),
+m_inputPattern(VKTextureSynth::PATTERN_CHECKERBOARD),
+m_bindless(false),
+m_descriptorIndexingFeatures(),
 m_dynamicUBOAlignment(0)
 {
+    // Register the named pipelines, mesh objects, descriptor sets and semaphores, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineRender = m_sampleParams.Pipelines.Register(PIPELINE_RENDER);
+    m_meshQuad = m_meshObjects.Register(MESH_QUAD);
+    m_descSetPreCompute = m_sampleParams.FrameRes.DescriptorSets.Register(DESC_SET_PRE_COMPUTE);
+    m_descSetPostCompute = m_sampleParams.FrameRes.DescriptorSets.Register(DESC_SET_POST_COMPUTE);
+    m_descSetCompute = m_sampleComputeParams.FrameRes.DescriptorSets.Register(DESC_SET_COMPUTE);
+    m_semaphoreCompComplete = m_sampleComputeParams.FrameRes.Semaphores.Register(SEMAPHORE_COMP_COMPLETE);
+    m_semaphoreGraphComplete = m_sampleComputeParams.FrameRes.Semaphores.Register(SEMAPHORE_GRAPH_COMPLETE);
+
     // Initialize mesh objects
-    m_meshObjects[MESH_QUAD] = {};
+    m_meshObjects[m_meshQuad] = {};
 
     // Initialize the pointer to the memory region that will store the array of mesh info.
     dynUBufVS.meshInfo = nullptr;
@@ -45,6 +93,36 @@ VKComputeShader::~VKComputeShader()
 
 void VKComputeShader::OnInit()
 {
+    // --bindless addresses the textures and buffers used by the graphics pipeline by index, 
+    // through a bindless descriptor set (if supported by the device, see EnableDeviceExtensions).
+    // --filters sets the chain of filters applied to the input texture by the compute work (see BuildComputeChain),
+    // and --input loads the input texture from a PPM or KTX2 file (or --input-size and --pattern set the size and the pattern
+    // of the generated one: checkerboard, gradient, value, perlin or test).
+    // --autotune times the workgroup sizes supported by each filter pass at setup, and keeps the fastest one.
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--bindless") == 0)
+            m_bindless = true;
+        else if (strcmp(args[i], "--filters") == 0 && i + 1 < args.size())
+            m_filterChain = args[++i];
+        else if (strcmp(args[i], "--input") == 0 && i + 1 < args.size())
+            m_inputFile = args[++i];
+        else if (strcmp(args[i], "--input-size") == 0 && i + 1 < args.size())
+            m_inputSize = static_cast<uint32_t>(strtoul(args[++i], nullptr, 10));
+        else if (strcmp(args[i], "--pattern") == 0 && i + 1 < args.size())
+        {
+            const char* name = args[++i];
+            VKTextureSynth::Pattern pattern = VKTextureSynth::GetPattern(name);
+            if (pattern != VKTextureSynth::PATTERN_COUNT)
+                m_inputPattern = pattern;
+            else
+                printf("Unknown pattern: %s (available patterns: checkerboard, gradient, value, perlin, test)\n", name);
+        }
+        else if (strcmp(args[i], "--autotune") == 0)
+            m_autotune = true;
+    }
+
     InitVulkan();
     SetupPipeline();
 
@@ -56,8 +134,13 @@ void VKComputeShader::InitVulkan()
 {
     CreateInstance();
     CreateSurface();
-    CreateDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT); // Check for a queue family supporting both graphics and compute operations
+    CreateDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT); // Check for a queue family supporting both graphics and compute operations, and look for a dedicated transfer queue
     GetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.FamilyIndex, m_vulkanParams.GraphicsQueue.Handle);
+    GetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.TransferQueue.FamilyIndex, m_vulkanParams.TransferQueue.Handle);
+    m_stagingRing.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device,
+                       m_vulkanParams.TransferQueue.Handle, m_vulkanParams.TransferQueue.FamilyIndex,
+                       m_vulkanParams.GraphicsQueue.Handle, m_vulkanParams.GraphicsQueue.FamilyIndex);
+    m_profiler.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.FamilyIndex, m_framesInFlight); // One timestamp query pool for each frame in flight
     CreateSwapchain(&m_width, &m_height, VKApplication::settings.vsync);
     CreateDepthStencilImage(m_width, m_height);
     CreateRenderPass();
@@ -69,29 +152,67 @@ void VKComputeShader::InitVulkan()
 void VKComputeShader::SetupPipeline()
 {
     CreateVertexBuffer();
-    CreateStagingBuffer();
     CreateInputTexture();
+    BuildComputeChain();       // The chain of filters depends on the size of the input texture
     CreateOutputTextures();
+    CreateHistogramBuffer();
     CreateHostVisibleBuffers();
     CreateHostVisibleDynamicBuffers();
-    CreateDescriptorPool();
-    CreateDescriptorSetLayout();
-    AllocateDescriptorSets();
+    CreateDescriptorPool();    // The descriptor sets of the compute pipeline are allocated from this pool in both modes
+    if (m_bindless && !RegisterBindlessResources())
+    {
+        // Not enough room in the bindless descriptor set: fall back to the descriptor sets
+        printf("The resources don't fit in the bindless descriptor set: --bindless will be ignored\n");
+        m_bindlessSet.Destroy();
+        m_bindless = false;
+    }
+    if (!m_bindless)
+    {
+        CreateDescriptorSetLayout();
+        AllocateDescriptorSets();
+    }
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
     PrepareCompute();
+    ReportPipelineCreationTime();
+
+    printf("Binding the resources of the graphics pipeline with %s\n", m_bindless ? "a bindless descriptor set" : "a descriptor set per draw");
 
     m_initialized = true;
 }
 
 void VKComputeShader::EnableInstanceExtensions(std::vector<const char*>& instanceExtensions)
-{ }
+{
+    // Needed to query the descriptor indexing features and properties of the device
+    if (m_bindless)
+        instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+}
 
 void VKComputeShader::EnableDeviceExtensions(std::vector<const char*>& deviceExtensions)
-{ }
+{
+    if (!m_bindless)
+        return;
+
+    // Enable the extensions and features needed by the bindless descriptor set, or fall back to the descriptor sets
+    if (VKBindless::QuerySupport(m_vulkanParams.Instance, m_vulkanParams.PhysicalDevice, deviceExtensions, m_descriptorIndexingFeatures))
+    {
+        m_vulkanParams.ExtFeatures = &m_descriptorIndexingFeatures;
+    }
+    else
+    {
+        printf("Descriptor indexing is not supported by the device: --bindless will be ignored\n");
+        m_bindless = false;
+    }
+}
 
 void VKComputeShader::EnableFeatures(VkPhysicalDeviceFeatures& features)
-{ }
+{
+    // The input texture can be loaded from a file with a compressed format (BC, ETC2 or ASTC), 
+    // whose support is an optional feature of each family of formats.
+    if (!m_inputFile.empty())
+        VKTextureLoader::EnableCompressionFeatures(m_deviceFeatures, features);
+}
 
 // Update frame-based values.
 void VKComputeShader::OnUpdate()
@@ -113,10 +234,13 @@ void VKComputeShader::OnRender()
     // Compute work
     //
 
-    // Ensure no more than MAX_FRAME_LAG command buffers are queued to the compute queue.
+    // Ensure no more than m_framesInFlight command buffers are queued to the compute queue.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleComputeParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleComputeParams.FrameRes.Fences[m_frameIndex]));
 
+    // Profile the scopes of this frame with the query pool of the current frame slot
+    m_profiler.BeginFrame(m_frameIndex);
+
     PopulateComputeCommandBuffer();
     SubmitComputeCommandBuffer();
 
@@ -124,17 +248,15 @@ void VKComputeShader::OnRender()
     // Graphics work
     //
 
-    // Ensure no more than MAX_FRAME_LAG frames are queued to the graphics queue.
+    // Ensure no more than m_framesInFlight frames are queued to the graphics queue.
     VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
     VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
 
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
 
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
@@ -150,7 +272,7 @@ void VKComputeShader::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKComputeShader::OnDestroy()
@@ -160,25 +282,29 @@ void VKComputeShader::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
+    // Report the GPU time of the profiled scopes over the last frames
+    m_profiler.PrintReport();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffers.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBmemory, nullptr);
+    m_memAllocator.Free(m_vertexindexBuffers.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffers.IBmemory);
 
     // Destroy\Unmap per-frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Destroy dynamic buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
 
         // Wait for fences before destroying them
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
@@ -189,24 +315,33 @@ void VKComputeShader::OnDestroy()
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], NULL);
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE][i], NULL);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE][i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete][i], NULL);
+        vkDestroySemaphore(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete][i], NULL);
 
         // Destroy output images and samplers
         vkDestroyImageView(m_vulkanParams.Device, m_outputTextures[i].TextureImage.Descriptor.imageView, nullptr);
         vkDestroyImage(m_vulkanParams.Device, m_outputTextures[i].TextureImage.Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_outputTextures[i].TextureImage.Memory, nullptr);
+        m_memAllocator.Free(m_outputTextures[i].TextureImage.Allocation);
         vkDestroySampler(m_vulkanParams.Device, m_outputTextures[i].TextureImage.Descriptor.sampler, nullptr);
     }
 
-    // Destroy staging buffer
-    vkDestroyBuffer(m_vulkanParams.Device, m_inputTexture.StagingBuffer.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_inputTexture.StagingBuffer.Memory, nullptr);
+    // Destroy the intermediate images (if used by the chain of filters) and the histogram buffer
+    for (Texture2D& texture : m_intermediateTextures)
+    {
+        if (texture.TextureImage.Handle == VK_NULL_HANDLE)
+            continue;
+
+        vkDestroyImageView(m_vulkanParams.Device, texture.TextureImage.Descriptor.imageView, nullptr);
+        vkDestroyImage(m_vulkanParams.Device, texture.TextureImage.Handle, nullptr);
+        m_memAllocator.Free(texture.TextureImage.Allocation);
+    }
+    vkDestroyBuffer(m_vulkanParams.Device, m_histogramBuffer.Handle, nullptr);
+    m_memAllocator.Free(m_histogramBuffer.Allocation);
 
     // Destroy input image and sampler
     vkDestroyImageView(m_vulkanParams.Device, m_inputTexture.TextureImage.Descriptor.imageView, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_inputTexture.TextureImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_inputTexture.TextureImage.Memory, nullptr);
+    m_memAllocator.Free(m_inputTexture.TextureImage.Allocation);
     vkDestroySampler(m_vulkanParams.Device, m_inputTexture.TextureImage.Descriptor.sampler, nullptr);
 
     // Destroy descriptor set layout for compute pipeline
@@ -214,19 +349,22 @@ void VKComputeShader::OnDestroy()
 
     // Destroy compute pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleComputeParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleComputeParams.Pipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleComputeParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy descriptor pool
     vkDestroyDescriptorPool(m_vulkanParams.Device, m_sampleParams.DescriptorPool, nullptr);
 
-    // Destroy descriptor set layout for graphics pipeline
-    vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_sampleParams.DescriptorSetLayout, nullptr);
+    // Destroy descriptor set layout for graphics pipeline, or the bindless descriptor set (along with its layout and pool)
+    if (m_bindless)
+        m_bindlessSet.Destroy();
+    else
+        vkDestroyDescriptorSetLayout(m_vulkanParams.Device, m_sampleParams.DescriptorSetLayout, nullptr);
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.Pipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -237,13 +375,21 @@ void VKComputeShader::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
@@ -256,11 +402,24 @@ void VKComputeShader::OnDestroy()
     // Destroy command pool
     vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
 
+    // Destroy the query pools used for GPU profiling
+    m_profiler.Destroy();
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Destroy the staging ring buffer
+    m_stagingRing.Destroy();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
+
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -269,8 +428,12 @@ void VKComputeShader::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -306,7 +469,7 @@ void VKComputeShader::CreateVertexBuffer()
     };
 
     size_t vertexBufferSize = static_cast<size_t>(quadVertices.size()) * sizeof(Vertex);
-    m_meshObjects[MESH_QUAD].vertexCount = static_cast<uint32_t>(quadVertices.size());
+    m_meshObjects[m_meshQuad].vertexCount = static_cast<uint32_t>(quadVertices.size());
 
     //
     //  3 ______ 2
@@ -323,64 +486,36 @@ void VKComputeShader::CreateVertexBuffer()
     };
 
     size_t indexBufferSize = static_cast<size_t>(indices.size()) * sizeof(uint16_t);
-    m_meshObjects[MESH_QUAD].indexCount = indices.size();
+    m_meshObjects[m_meshQuad].indexCount = indices.size();
 
     //
-    // Create the vertex and index buffers in host-visible device memory for convenience. 
-    // This is not recommended as it can result in lower rendering performance.
+    // Create the vertex and index buffers in local device memory, and upload their data through the staging ring buffer.
+    // The copies are submitted in the same batch as the upload of the input texture (see CreateInputTexture).
     //
     
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-    
-    // Pointer used to map host-visible device memory to the virtual address space of the application.
-    // The application can copy data to host-visible device memory only using this pointer.
-    void *data;    
-    
     // Create the vertex buffer object
     VkBufferCreateInfo vertexBufferInfo = {};
     vertexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    vertexBufferInfo.size = static_cast<size_t>(quadVertices.size()) * sizeof(Vertex);
-    vertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;    
+    vertexBufferInfo.size = vertexBufferSize;
+    vertexBufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &vertexBufferInfo, nullptr, &m_vertexindexBuffers.VBbuffer));
 
-    // Request a memory allocation from coherent, host-visible device memory that is large 
-    // enough to hold the vertex buffer.
-    // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
-    // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffers.VBmemory));
+    // Request a memory allocation from local device memory that is large 
+    // enough to hold the vertex buffer, and bind it to the buffer object.
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffers.VBbuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexindexBuffers.VBmemory);
 
-    // Map the host-visible device memory and copy the vertex data. 
-    // Once finished, we can unmap it since we no longer need to access the vertex buffer from the application.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, quadVertices.data(), static_cast<size_t>(quadVertices.size()) * sizeof(Vertex));
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory);
-
-    // Bind the vertex buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, m_vertexindexBuffers.VBmemory, 0));
+    m_stagingRing.UploadBuffer(m_vertexindexBuffers.VBbuffer, 0, quadVertices.data(), vertexBufferSize);
 
     // Create the index buffer object
     VkBufferCreateInfo indexBufferInfo = {};
     indexBufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    indexBufferInfo.size = vertexBufferSize;
-    indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;    
+    indexBufferInfo.size = indexBufferSize;
+    indexBufferInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
     VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &indexBufferInfo, nullptr, &m_vertexindexBuffers.IBbuffer));
 
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_vertexindexBuffers.IBbuffer, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_vertexindexBuffers.IBmemory));
-
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBmemory, 0, memAlloc.allocationSize, 0, &data));
-    memcpy(data, indices.data(), indexBufferSize);
-    vkUnmapMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBmemory);
+    m_memAllocator.AllocateBufferMemory(m_vertexindexBuffers.IBbuffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertexindexBuffers.IBmemory);
 
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBbuffer, m_vertexindexBuffers.IBmemory, 0));
+    m_stagingRing.UploadBuffer(m_vertexindexBuffers.IBbuffer, 0, indices.data(), indexBufferSize);
 }
 
 void VKComputeShader::CreateHostVisibleBuffers()
@@ -400,16 +535,17 @@ void VKComputeShader::CreateHostVisibleBuffers()
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    if (m_bindless)
+        bufferInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;  // Accessed as a storage buffer of the bindless descriptor set
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -444,16 +580,17 @@ void VKComputeShader::CreateHostVisibleDynamicBuffers()
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    if (m_bindless)
+        bufferInfo.usage |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;  // Accessed as a storage buffer of the bindless descriptor set
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -470,80 +607,233 @@ void VKComputeShader::CreateHostVisibleDynamicBuffers()
 
 std::vector<uint8_t> VKComputeShader::GenerateTextureData()
 {
-    const size_t rowPitch = m_inputTexture.TextureWidth * m_inputTexture.TextureTexelSize; // The size of a texture row in bytes
-    const size_t cellPitch = rowPitch >> 3;                                                // The width of a cell in the checkerboard texture, in bytes.
-    const size_t cellHeight = m_inputTexture.TextureWidth >> 3;                            // The height of a cell in the checkerboard texture, in texels.
-    const size_t textureSize = rowPitch * m_inputTexture.TextureHeight;                    // Texture size in bytes
- 
-    std::vector<uint8_t> data(textureSize);
-    uint8_t* pData = &data[0];
+    // Generate the input texture selected with --pattern (a checkerboard by default), whose size can be large
+    // (--input-size N). VKTextureSynth builds whole rows with SIMD instructions, and splits the texture in bands
+    // generated by the threads of a job system, created for the occasion.
+    VKTextureSynth::Desc desc;
+    desc.Type = m_inputPattern;
+    desc.Width = m_inputTexture.TextureWidth;
+    desc.Height = m_inputTexture.TextureHeight;
+    desc.Color0 = 0xffaaaaff;   // Pink (RGBA8, R in the lowest byte)
+    desc.Color1 = 0xff00ffa0;   // Green
+
+    std::vector<uint8_t> data(static_cast<size_t>(desc.Width) * desc.Height * m_inputTexture.TextureTexelSize);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    VKJobSystem jobSystem;
+    jobSystem.Init();
+    VKTextureSynth::Generate(desc, data.data(), &jobSystem);
+    jobSystem.Destroy();
+    double time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    printf("Generated %s input texture in %.2f ms (%s, %u threads)\n", VKTextureSynth::GetPatternName(desc.Type), 
+           time, VKTextureSynth::GetInstructionSet(), jobSystem.GetThreadCount());
  
-    for (size_t n = 0; n < textureSize; n += m_inputTexture.TextureTexelSize)
+    return data;
+}
+
+bool VKComputeShader::LoadTextureData(const std::string& fileName, std::vector<uint8_t>& data)
+{
+    // Binary PPM (P6) and PGM (P5) files are supported: a short text header (magic number, width, height and
+    // max value of a channel) followed by the texels, with three (PPM) or one (PGM) byte per texel.
+    std::ifstream is(fileName, std::ios::binary | std::ios::in);
+    if (!is.is_open())
     {
-        size_t x = n % rowPitch;    // horizontal byte position within a texture row
-        size_t y = n / rowPitch;    // vertical byte position within a texture column
-        size_t i = x / cellPitch;   // i-th column of cells within the checkerboard texture
-        size_t j = y / cellHeight;  // j-th row of cells within the checkerboard texture
- 
-        if (i % 2 == j % 2)
+        printf("Could not open %s: the input texture will be generated\n", fileName.c_str());
+        return false;
+    }
+
+    // Read a field of the header, skipping whitespaces and comments
+    auto readField = [&is]() {
+        std::string field;
+        is >> std::ws;
+        while (is.peek() == '#')
         {
-            pData[n] = 0xff;        // R
-            pData[n + 1] = 0xaa;    // G
-            pData[n + 2] = 0xaa;    // B
-            pData[n + 3] = 0xff;    // A
+            std::getline(is, field);
+            is >> std::ws;
         }
-        else
+        is >> field;
+        return field;
+    };
+
+    std::string magic = readField();
+    uint32_t width = static_cast<uint32_t>(strtoul(readField().c_str(), nullptr, 10));
+    uint32_t height = static_cast<uint32_t>(strtoul(readField().c_str(), nullptr, 10));
+    uint32_t maxValue = static_cast<uint32_t>(strtoul(readField().c_str(), nullptr, 10));
+    is.get();   // A single whitespace separates the header from the texels
+
+    if ((magic != "P6" && magic != "P5") || width == 0 || height == 0 || maxValue == 0 || maxValue > 255)
+    {
+        printf("%s is not a binary PPM or PGM file with 8-bit channels: the input texture will be generated\n", fileName.c_str());
+        return false;
+    }
+
+    if (width > m_deviceProperties.limits.maxImageDimension2D || height > m_deviceProperties.limits.maxImageDimension2D)
+    {
+        printf("%s is too large (%ux%u, max %u): the input texture will be generated\n", 
+               fileName.c_str(), width, height, m_deviceProperties.limits.maxImageDimension2D);
+        return false;
+    }
+
+    const size_t texelCount = static_cast<size_t>(width) * height;
+    const size_t channelCount = (magic == "P6") ? 3 : 1;
+    std::vector<uint8_t> texels(texelCount * channelCount);
+    is.read(reinterpret_cast<char*>(texels.data()), texels.size());
+    if (!is)
+    {
+        printf("%s is truncated: the input texture will be generated\n", fileName.c_str());
+        return false;
+    }
+
+    // Expand the texels to RGBA, scaling the channels to the [0, 255] range
+    data.resize(texelCount * m_inputTexture.TextureTexelSize);
+    for (size_t i = 0; i < texelCount; i++)
+    {
+        for (size_t c = 0; c < 3; c++)
+            data[i * 4 + c] = static_cast<uint8_t>(texels[i * channelCount + (channelCount == 3 ? c : 0)] * 255 / maxValue);
+        data[i * 4 + 3] = 0xff;
+    }
+
+    m_inputTexture.TextureWidth = width;
+    m_inputTexture.TextureHeight = height;
+
+    return true;
+}
+
+bool VKComputeShader::LoadTextureFile(const std::string& fileName, VKTextureLoader& textureFile)
+{
+    if (!textureFile.LoadKTX2(fileName))
+    {
+        printf("The input texture will be generated\n");
+        return false;
+    }
+
+    if (textureFile.GetWidth() > m_deviceProperties.limits.maxImageDimension2D || textureFile.GetHeight() > m_deviceProperties.limits.maxImageDimension2D)
+    {
+        printf("%s is too large (%ux%u, max %u): the input texture will be generated\n", 
+               fileName.c_str(), textureFile.GetWidth(), textureFile.GetHeight(), m_deviceProperties.limits.maxImageDimension2D);
+        return false;
+    }
+
+    // The filters read the input texture as an R8G8B8A8 storage image, which can't have a compressed format.
+    // A compressed texture is uploaded as it is to a temporary image, and decompressed by the GPU with a blit to the
+    // input texture (see BlitCompressedTexture), or decoded on the CPU if the device can't blit from its format.
+    // Only the first mip level is used.
+    if (textureFile.IsCompressed() && 
+        !textureFile.IsFormatSupported(m_vulkanParams.PhysicalDevice, m_vulkanParams.EnabledFeatures, VK_FORMAT_FEATURE_BLIT_SRC_BIT))
+    {
+        const char* fileFormat = textureFile.GetFormatName();
+        if (!textureFile.Decode())
         {
-            pData[n] = 0xa0;        // R
-            pData[n + 1] = 0xff;    // G
-            pData[n + 2] = 0x00;    // B
-            pData[n + 3] = 0xff;    // A
+            printf("%s: %s is not supported by the device and can't be decoded: the input texture will be generated\n", fileName.c_str(), fileFormat);
+            return false;
         }
+        printf("%s: %s is not supported by the device: decoded to %s on the CPU\n", fileName.c_str(), fileFormat, textureFile.GetFormatName());
     }
- 
-    return data;
+
+    // The texels of a non-compressed texture are copied as they are (sRGB values are filtered as they are, as for PPM files)
+    if (!textureFile.IsCompressed() && 
+        textureFile.GetFormat() != VK_FORMAT_R8G8B8A8_UNORM && textureFile.GetFormat() != VK_FORMAT_R8G8B8A8_SRGB)
+    {
+        printf("%s: %s is not supported as input (R8G8B8A8 or compressed formats only): the input texture will be generated\n", 
+               fileName.c_str(), textureFile.GetFormatName());
+        return false;
+    }
+
+    m_inputTexture.TextureWidth = textureFile.GetWidth();
+    m_inputTexture.TextureHeight = textureFile.GetHeight();
+
+    return true;
 }
 
-void VKComputeShader::CreateStagingBuffer()
+void VKComputeShader::BlitCompressedTexture(const VKTextureLoader& textureFile)
 {
-    // Create a buffer object
-    VkBufferCreateInfo bufferInfo = {};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = m_inputTexture.TextureWidth * m_inputTexture.TextureHeight * m_inputTexture.TextureTexelSize,
-    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_inputTexture.StagingBuffer.Handle));
+    // Temporary image, with the format of the file, holding its first mip level
+    VkImageCreateInfo imageCreateInfo = {};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.format = textureFile.GetFormat();
+    imageCreateInfo.extent = {textureFile.GetWidth(), textureFile.GetHeight(), 1};
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = 1;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkImage compressedImage = VK_NULL_HANDLE;
+    MemoryAllocation compressedAllocation;
+    VK_CHECK_RESULT(vkCreateImage(m_vulkanParams.Device, &imageCreateInfo, nullptr, &compressedImage));
+    m_memAllocator.AllocateImageMemory(compressedImage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, compressedAllocation);
+
+    // Upload the blocks as they are stored in the file (4 to 8 times less data than R8G8B8A8 texels), and submit the
+    // upload: it's executed before the command buffer submitted to the graphics queue below.
+    const VKTextureLoader::Level& level = textureFile.GetLevel(0);
+    m_stagingRing.UploadCompressedImage(compressedImage, level.Width, level.Height, 
+                                        textureFile.GetBlockWidth(), textureFile.GetBlockHeight(), textureFile.GetBlockSize(),
+                                        level.Data.data(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    m_stagingRing.Submit();
+
+    // Decompress the texture with a blit (of the same size) to the input texture, in a command buffer executed once
+    VkCommandBufferAllocateInfo commandBufferInfo = {};
+    commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferInfo.commandPool = m_sampleParams.CommandPool;
+    commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferInfo, &commandBuffer));
 
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
+    VkCommandBufferBeginInfo cmdBufInfo = {};
+    cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &cmdBufInfo));
+
+    VkImageMemoryBarrier imageBarrier = {};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = 0;
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = m_inputTexture.TextureImage.Handle;
+    imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                         0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkImageBlit blit = {};
+    blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    blit.srcOffsets[1] = { static_cast<int32_t>(level.Width), static_cast<int32_t>(level.Height), 1 };
+    blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    blit.dstOffsets[1] = blit.srcOffsets[1];
+    vkCmdBlitImage(commandBuffer, 
+                   compressedImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 
+                   m_inputTexture.TextureImage.Handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
+                   1, &blit, VK_FILTER_NEAREST);
+
+    // Transition the input texture for general access (read as a storage image by the compute shader, and sampled for display)
+    imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+                         0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
+    VK_CHECK_RESULT(vkQueueWaitIdle(m_vulkanParams.GraphicsQueue.Handle));
 
-    // Request a memory allocation from coherent, host-visible device memory that is large 
-    // enough to hold the staging buffer.
-    // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
-    // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_inputTexture.StagingBuffer.Handle, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_inputTexture.StagingBuffer.Memory));
-
-    // Bind the buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, 
-                                        m_inputTexture.StagingBuffer.Handle, 
-                                        m_inputTexture.StagingBuffer.Memory, 0));
-
-    // Map the host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, 
-                                m_inputTexture.StagingBuffer.Memory, 
-                                0, memAlloc.allocationSize, 
-                                0, &m_inputTexture.StagingBuffer.MappedMemory));
-
-    // Copy texture data in the staging buffer
-    std::vector<uint8_t> texData = GenerateTextureData();
-    memcpy(m_inputTexture.StagingBuffer.MappedMemory, texData.data(), texData.size());
-
-    // Unmap staging buffer
-    vkUnmapMemory(m_vulkanParams.Device, m_inputTexture.StagingBuffer.Memory);
+    // The compressed image is no longer needed
+    vkFreeCommandBuffers(m_vulkanParams.Device, m_sampleParams.CommandPool, 1, &commandBuffer);
+    vkDestroyImage(m_vulkanParams.Device, compressedImage, nullptr);
+    m_memAllocator.Free(compressedAllocation);
 }
 
 void VKComputeShader::CreateInputTexture()
@@ -553,6 +843,39 @@ void VKComputeShader::CreateInputTexture()
 
     vkGetPhysicalDeviceFormatProperties(m_vulkanParams.PhysicalDevice, tex_format, &props);
 
+    // Load the texture data from the file passed with --input (KTX2 or PPM), if any, or generate a checkerboard texture
+    // (of the size passed with --input-size, if any). The size of the texture is set accordingly.
+    std::vector<uint8_t> texData;
+    VKTextureLoader textureFile;
+    bool loaded = false;
+    if (m_inputFile.size() > 5 && m_inputFile.compare(m_inputFile.size() - 5, 5, ".ktx2") == 0)
+    {
+        loaded = LoadTextureFile(m_inputFile, textureFile);
+        if (loaded && !textureFile.IsCompressed())
+            texData = textureFile.GetLevel(0).Data;
+    }
+    else if (!m_inputFile.empty())
+    {
+        loaded = LoadTextureData(m_inputFile, texData);
+    }
+
+    if (!loaded)
+    {
+        if (m_inputSize > 0)
+        {
+            m_inputSize = std::min(m_inputSize, m_deviceProperties.limits.maxImageDimension2D);
+            m_inputTexture.TextureWidth = m_inputSize;
+            m_inputTexture.TextureHeight = m_inputSize;
+        }
+        texData = GenerateTextureData();
+    }
+
+    printf("Input texture: %ux%u\n", m_inputTexture.TextureWidth, m_inputTexture.TextureHeight);
+    if (loaded && textureFile.IsCompressed())
+        printf("Input file: %s, %.2f MB uploaded (%.2f MB as R8G8B8A8), decompressed by the GPU\n", textureFile.GetFormatName(), 
+               textureFile.GetLevel(0).Data.size() / (1024.0 * 1024.0), 
+               static_cast<double>(m_inputTexture.TextureWidth) * m_inputTexture.TextureHeight * 4 / (1024.0 * 1024.0));
+
     // Check if the device can sample from R8G8B8A8_UNORM textures in local device memory
     if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
     {
@@ -572,55 +895,20 @@ void VKComputeShader::CreateInputTexture()
 
         VK_CHECK_RESULT(vkCreateImage(m_vulkanParams.Device, &imageCreateInfo, nullptr, &m_inputTexture.TextureImage.Handle));
 
-        // Used to request an allocation of a specific size from a certain memory type.
-        VkMemoryAllocateInfo memAlloc = {};
-        memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        VkMemoryRequirements memReqs;
-
         // Request a memory allocation from local device memory that is large 
-        // enough to hold the texture image.
-        vkGetImageMemoryRequirements(m_vulkanParams.Device, m_inputTexture.TextureImage.Handle, &memReqs);
-        memAlloc.allocationSize = memReqs.size;
-        memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_deviceMemoryProperties);
-        VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_inputTexture.TextureImage.Memory));
-
-        // Bind the image object to the backing local device memory just allocated.
-        VK_CHECK_RESULT(vkBindImageMemory(m_vulkanParams.Device, 
-                                            m_inputTexture.TextureImage.Handle, 
-                                            m_inputTexture.TextureImage.Memory, 0));
-
-        // We need to record some commands to copy staging buffer data to texture image in local device memory
-        VkCommandBufferBeginInfo cmdBufferInfo = {};
-        cmdBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        cmdBufferInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-        vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[0], &cmdBufferInfo);
-
-        // Transition the image layout to provide optimal performance for transfering operations that use the image as a destination
-        TransitionImageLayout(m_sampleParams.FrameRes.CommandBuffers[0],
-                                m_inputTexture.TextureImage.Handle, VK_IMAGE_ASPECT_COLOR_BIT, 
-                                VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                VK_ACCESS_NONE, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
-                                VK_PIPELINE_STAGE_TRANSFER_BIT);
-
-        // Copy from staging buffer to texture in local device memory
-        VkBufferImageCopy copyRegion = {};
-        copyRegion.bufferOffset = 0;
-        copyRegion.bufferRowLength = 0;
-        copyRegion.bufferImageHeight = 0;
-        copyRegion.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
-        copyRegion.imageOffset = {0, 0, 0};
-        copyRegion.imageExtent = {m_inputTexture.TextureWidth, m_inputTexture.TextureHeight, 1};
-
-        vkCmdCopyBufferToImage(m_sampleParams.FrameRes.CommandBuffers[0], 
-                                m_inputTexture.StagingBuffer.Handle, m_inputTexture.TextureImage.Handle, 
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-
-        // Transition the image layout to provide optimal performance for reading by shaders
-        TransitionImageLayout(m_sampleParams.FrameRes.CommandBuffers[0],
-                        m_inputTexture.TextureImage.Handle, VK_IMAGE_ASPECT_COLOR_BIT, 
-                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL,
-                        VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
-                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+        // enough to hold the texture image, and bind it to the image object.
+        m_memAllocator.AllocateImageMemory(m_inputTexture.TextureImage.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_inputTexture.TextureImage.Allocation);
+
+        // Copy the texture data to the image in local device memory through the staging ring buffer, which also
+        // transitions the image layout for general access (the image is read as a storage image by the compute shader).
+        // The copy is batched with the upload of the vertex and index buffers.
+        // A compressed texture is decompressed into the image by the GPU instead.
+        if (loaded && textureFile.IsCompressed())
+            BlitCompressedTexture(textureFile);
+        else
+            m_stagingRing.UploadImage(m_inputTexture.TextureImage.Handle, 
+                                      m_inputTexture.TextureWidth, m_inputTexture.TextureHeight, m_inputTexture.TextureTexelSize, 
+                                      texData.data(), VK_IMAGE_LAYOUT_GENERAL);
 
         // Save the last image layout
         m_inputTexture.TextureImage.Descriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
@@ -664,90 +952,47 @@ void VKComputeShader::CreateInputTexture()
         assert(!"No support for R8G8B8A8_UNORM as texture image format");
     }
 
-    // Flush the command buffer
-    FlushInitCommandBuffer(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.Handle, m_sampleParams.FrameRes.CommandBuffers[0], m_sampleParams.FrameRes.Fences[0]);
+    // Submit the uploads of the vertex buffer, index buffer and input texture as a single batch.
+    // There's no need to wait for it to complete, as the copies are executed before (and made visible to) 
+    // any command buffer submitted to the graphics queue later on.
+    m_stagingRing.Submit();
 }
 
 void VKComputeShader::CreateOutputTextures()
 {
-    m_outputTextures.resize(MAX_FRAME_LAG);
+    m_outputTextures.resize(m_framesInFlight);
     const VkFormat tex_format = VK_FORMAT_R8G8B8A8_UNORM;
     VkFormatProperties props;
 
     // Get device properties for the R8G8B8A8_UNORM format
     vkGetPhysicalDeviceFormatProperties(m_vulkanParams.PhysicalDevice, tex_format, &props);
 
+    // Resources accessed by the chain of filters
+    uint32_t usedResources = 0;
+    for (const ComputePass& pass : m_computePasses)
+        usedResources |= pass.reads | pass.writes;
+
     // Check if the device can execute storage image operations from R8G8B8A8_UNORM textures in local device memory
     if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)
     {
-        for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+        // Create the textures to be used as storage images (in CS) and combined image samplers (in FS)
+        for (size_t i = 0; i < m_framesInFlight; i++)
+        {
+            m_outputTextures[i].TextureWidth = m_inputTexture.TextureWidth;
+            m_outputTextures[i].TextureHeight = m_inputTexture.TextureHeight;
+            CreateStorageTexture(m_outputTextures[i], VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+        }
+
+        // Create the intermediate textures used by the chain of filters (only accessed by the compute shaders)
+        const uint32_t intermediateResources[2] = { COMPUTE_PING_TEXTURE, COMPUTE_PONG_TEXTURE };
+        for (size_t i = 0; i < 2; i++)
         {
-            // Create a texture to be used as storage image (in CS) and combined image sampler (in FS)
-            VkImageCreateInfo imageCreateInfo = {};
-            imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-            imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
-            imageCreateInfo.format = tex_format;
-            imageCreateInfo.extent = {m_outputTextures[i].TextureWidth, m_outputTextures[i].TextureHeight, 1};
-            imageCreateInfo.mipLevels = 1;
-            imageCreateInfo.arrayLayers = 1;
-            imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-            imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
-            imageCreateInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
-            imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-            VK_CHECK_RESULT(vkCreateImage(m_vulkanParams.Device, &imageCreateInfo, nullptr, &m_outputTextures[i].TextureImage.Handle));
-
-            // Used to request an allocation of a specific size from a certain memory type.
-            VkMemoryAllocateInfo memAlloc = {};
-            memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-            VkMemoryRequirements memReqs;
-
-            // Request a memory allocation from local device memory that is large 
-            // enough to hold the texture image.
-            vkGetImageMemoryRequirements(m_vulkanParams.Device, m_outputTextures[i].TextureImage.Handle, &memReqs);
-            memAlloc.allocationSize = memReqs.size;
-            memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_deviceMemoryProperties);
-            VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_outputTextures[i].TextureImage.Memory));
-
-            // Bind the image object to the backing local device memory just allocated.
-            VK_CHECK_RESULT(vkBindImageMemory(m_vulkanParams.Device, 
-                                                m_outputTextures[i].TextureImage.Handle, 
-                                                m_outputTextures[i].TextureImage.Memory, 0));
-
-            //
-            // Create a sampler and a view
-            //
-
-            VkSamplerCreateInfo samplerInfo = {};
-            samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-            samplerInfo.magFilter = VK_FILTER_NEAREST;
-            samplerInfo.minFilter = VK_FILTER_NEAREST;
-            samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-            samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
-            samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
-            samplerInfo.anisotropyEnable = VK_FALSE;
-            samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
-
-            VkImageViewCreateInfo viewInfo = {};
-            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-            viewInfo.image = m_outputTextures[i].TextureImage.Handle;
-            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-            viewInfo.format = tex_format;
-            viewInfo.components =
-                {
-                    VK_COMPONENT_SWIZZLE_IDENTITY,  // R
-                    VK_COMPONENT_SWIZZLE_IDENTITY,  // G
-                    VK_COMPONENT_SWIZZLE_IDENTITY,  // B
-                    VK_COMPONENT_SWIZZLE_IDENTITY,  // A
-                };
-            viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}; // The texture stores colors and includes one mipmap level (index 0) and one array layer (index 0)
-
-            // Create a sampler
-            VK_CHECK_RESULT(vkCreateSampler(m_vulkanParams.Device, &samplerInfo, NULL, &m_outputTextures[i].TextureImage.Descriptor.sampler));
-
-            // Create an image view
-            VK_CHECK_RESULT(vkCreateImageView(m_vulkanParams.Device, &viewInfo, NULL, &m_outputTextures[i].TextureImage.Descriptor.imageView));
+            if (!(usedResources & intermediateResources[i]))
+                continue;
+
+            m_intermediateTextures[i].TextureWidth = m_inputTexture.TextureWidth;
+            m_intermediateTextures[i].TextureHeight = m_inputTexture.TextureHeight;
+            CreateStorageTexture(m_intermediateTextures[i], VK_IMAGE_USAGE_STORAGE_BIT);
         }
     }
     else 
@@ -765,37 +1010,127 @@ void VKComputeShader::CreateOutputTextures()
     cmdBufferInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[0], &cmdBufferInfo);
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    std::vector<Texture2D*> textures;
+    for (size_t i = 0; i < m_framesInFlight; i++)
+        textures.push_back(&m_outputTextures[i]);
+    for (Texture2D& texture : m_intermediateTextures)
+    {
+        if (texture.TextureImage.Handle != VK_NULL_HANDLE)
+            textures.push_back(&texture);
+    }
+
+    for (Texture2D* texture : textures)
     {
         TransitionImageLayout(m_sampleParams.FrameRes.CommandBuffers[0],
-                                m_outputTextures[i].TextureImage.Handle, VK_IMAGE_ASPECT_COLOR_BIT, 
+                                texture->TextureImage.Handle, VK_IMAGE_ASPECT_COLOR_BIT, 
                                 VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
                                 VK_ACCESS_NONE, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 
                                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
 
         // Save the last image layout
-        m_outputTextures[i].TextureImage.Descriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        texture->TextureImage.Descriptor.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
     }
 
     // Flush the command buffer
     FlushInitCommandBuffer(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.Handle, m_sampleParams.FrameRes.CommandBuffers[0], m_sampleParams.FrameRes.Fences[0]);
 }
 
+void VKComputeShader::CreateStorageTexture(Texture2D& texture, VkImageUsageFlags usage)
+{
+    const VkFormat tex_format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    VkImageCreateInfo imageCreateInfo = {};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageCreateInfo.format = tex_format;
+    imageCreateInfo.extent = {texture.TextureWidth, texture.TextureHeight, 1};
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = 1;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageCreateInfo.usage = usage;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VK_CHECK_RESULT(vkCreateImage(m_vulkanParams.Device, &imageCreateInfo, nullptr, &texture.TextureImage.Handle));
+
+    // Request a memory allocation from local device memory that is large 
+    // enough to hold the texture image, and bind it to the image object.
+    m_memAllocator.AllocateImageMemory(texture.TextureImage.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.TextureImage.Allocation);
+
+    //
+    // Create a sampler (if the texture is sampled) and a view
+    //
+
+    if (usage & VK_IMAGE_USAGE_SAMPLED_BIT)
+    {
+        VkSamplerCreateInfo samplerInfo = {};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = VK_FILTER_NEAREST;
+        samplerInfo.minFilter = VK_FILTER_NEAREST;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        samplerInfo.anisotropyEnable = VK_FALSE;
+        samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+
+        // Create a sampler
+        VK_CHECK_RESULT(vkCreateSampler(m_vulkanParams.Device, &samplerInfo, NULL, &texture.TextureImage.Descriptor.sampler));
+    }
+
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = texture.TextureImage.Handle;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = tex_format;
+    viewInfo.components =
+        {
+            VK_COMPONENT_SWIZZLE_IDENTITY,  // R
+            VK_COMPONENT_SWIZZLE_IDENTITY,  // G
+            VK_COMPONENT_SWIZZLE_IDENTITY,  // B
+            VK_COMPONENT_SWIZZLE_IDENTITY,  // A
+        };
+    viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}; // The texture stores colors and includes one mipmap level (index 0) and one array layer (index 0)
+
+    // Create an image view
+    VK_CHECK_RESULT(vkCreateImageView(m_vulkanParams.Device, &viewInfo, NULL, &texture.TextureImage.Descriptor.imageView));
+}
+
+void VKComputeShader::CreateHistogramBuffer()
+{
+    // The histogram (256 32-bit bins) is computed and read by the levels filter, and cleared at the beginning of
+    // the compute work of every frame. The buffer is created even if the chain doesn't include the levels filter
+    // (it's bound to the descriptor sets of all the passes, and it's very small).
+    m_histogramBuffer.Size = 256 * sizeof(uint32_t);
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_histogramBuffer.Size;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_histogramBuffer.Handle));
+
+    m_memAllocator.AllocateBufferMemory(m_histogramBuffer.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_histogramBuffer.Allocation);
+
+    m_histogramBuffer.Descriptor.buffer = m_histogramBuffer.Handle;
+    m_histogramBuffer.Descriptor.offset = 0;
+    m_histogramBuffer.Descriptor.range = m_histogramBuffer.Size;
+}
+
 void VKComputeShader::UpdateHostVisibleBufferData()
 {
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
         memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
 void VKComputeShader::UpdateHostVisibleDynamicBufferData()
 {
     // Set an identity matrix as world matrix
-    m_meshObjects[MESH_QUAD].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                        (m_meshObjects[MESH_QUAD].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshQuad].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
+                                        (m_meshObjects[m_meshQuad].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
     
-    m_meshObjects[MESH_QUAD].meshInfo->worldMatrix = glm::identity<glm::mat4>();
+    m_meshObjects[m_meshQuad].meshInfo->worldMatrix = glm::identity<glm::mat4>();
 
     // Update dynamic uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
@@ -812,27 +1147,32 @@ void VKComputeShader::CreateDescriptorPool()
     // per type we will include in those descriptor sets.
     //
 
+    // There is a compute descriptor set for each pass of the chain of filters (for each frame in flight)
+    const uint32_t computeSetCount = static_cast<uint32_t>(m_framesInFlight * m_computePasses.size());
+
     // Describe the number of descriptors per type.
-    // This sample uses four descriptor types (uniform buffer, dynamic uniform buffer, combined image sampler and storage image)
-    VkDescriptorPoolSize typeCounts[4];
+    // This sample uses five descriptor types (uniform buffer, dynamic uniform buffer, combined image sampler, storage image and storage buffer)
+    VkDescriptorPoolSize typeCounts[5];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG) * 2; // Pre and Post compute descriptor sets
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight) * 2; // Pre and Post compute descriptor sets
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG) * 2; // Pre and Post compute descriptor sets
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight) * 2; // Pre and Post compute descriptor sets
     typeCounts[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    typeCounts[2].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG) * 2; // Pre and Post compute descriptor sets
+    typeCounts[2].descriptorCount = static_cast<uint32_t>(m_framesInFlight) * 2; // Pre and Post compute descriptor sets
     typeCounts[3].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    typeCounts[3].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG) * 2; // Pre and Post compute descriptor sets
+    typeCounts[3].descriptorCount = computeSetCount * 2;                         // Input and output textures of the compute passes
+    typeCounts[4].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    typeCounts[4].descriptorCount = computeSetCount;                             // Histogram buffer of the compute passes
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
     VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
     descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
     descriptorPoolInfo.pNext = nullptr;
-    descriptorPoolInfo.poolSizeCount = 4;
+    descriptorPoolInfo.poolSizeCount = 5;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG) * 3; // Pre and Post compute descriptor sets (for graphics) and compute descriptor set (for compute)
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight) * 2 + computeSetCount; // Pre and Post compute descriptor sets (for graphics) and compute descriptor sets (for compute)
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -878,20 +1218,20 @@ void VKComputeShader::CreateDescriptorSetLayout()
 
 void VKComputeShader::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets[DESC_SET_PRE_COMPUTE].resize(MAX_FRAME_LAG);
-    m_sampleParams.FrameRes.DescriptorSets[DESC_SET_POST_COMPUTE].resize(MAX_FRAME_LAG);
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetPreCompute].resize(m_framesInFlight);
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetPostCompute].resize(m_framesInFlight);
 
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[DESC_SET_PRE_COMPUTE].data()));
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[DESC_SET_POST_COMPUTE].data()));
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetPreCompute].data()));
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetPostCompute].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -903,13 +1243,13 @@ void VKComputeShader::AllocateDescriptorSets()
     //
     // Input texture before compute shader
     //
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_PRE_COMPUTE][i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetPreCompute][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -917,7 +1257,7 @@ void VKComputeShader::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_PRE_COMPUTE][i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetPreCompute][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
@@ -925,7 +1265,7 @@ void VKComputeShader::AllocateDescriptorSets()
 
         // Write the descriptor of the combined image sampler.
         writeDescriptorSet[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[2].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_PRE_COMPUTE][i];
+        writeDescriptorSet[2].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetPreCompute][i];
         writeDescriptorSet[2].descriptorCount = 1;
         writeDescriptorSet[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         writeDescriptorSet[2].pImageInfo = &m_inputTexture.TextureImage.Descriptor;
@@ -937,13 +1277,13 @@ void VKComputeShader::AllocateDescriptorSets()
     //
     // Output texture after compute shader
     //
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_POST_COMPUTE][i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetPostCompute][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -951,7 +1291,7 @@ void VKComputeShader::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_POST_COMPUTE][i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetPostCompute][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
@@ -959,7 +1299,7 @@ void VKComputeShader::AllocateDescriptorSets()
 
         // Write the descriptor of the combined image sampler.
         writeDescriptorSet[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[2].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_POST_COMPUTE][i];
+        writeDescriptorSet[2].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetPostCompute][i];
         writeDescriptorSet[2].descriptorCount = 1;
         writeDescriptorSet[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         writeDescriptorSet[2].pImageInfo = &m_outputTextures[i].TextureImage.Descriptor;
@@ -969,6 +1309,46 @@ void VKComputeShader::AllocateDescriptorSets()
     }
 }
 
+bool VKComputeShader::RegisterBindlessResources()
+{
+    //
+    // Create the bindless descriptor set, and write the descriptors of the resources used by the graphics pipeline.
+    // This is done once: the shaders select the resources of each draw by index (see PopulateCommandBuffer), 
+    // so there are no descriptor sets to allocate, update or bind for each draw.
+    //
+
+    m_bindlessSet.Init(m_vulkanParams.Instance, m_vulkanParams.PhysicalDevice, m_vulkanParams.Device);
+
+    m_bindlessIndices.inputTexture = m_bindlessSet.AddSampledImage(m_inputTexture.TextureImage.Descriptor);
+
+    m_bindlessIndices.frameBuffers.resize(m_framesInFlight);
+    m_bindlessIndices.meshBuffers.resize(m_framesInFlight);
+    m_bindlessIndices.outputTextures.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
+    {
+        // The whole dynamic buffer is described, rather than the range of a single mesh info, since the 
+        // vertex shader indexes it as an array of world matrices.
+        VkDescriptorBufferInfo meshBufferInfo = m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
+        meshBufferInfo.range = VK_WHOLE_SIZE;
+
+        m_bindlessIndices.frameBuffers[i] = m_bindlessSet.AddStorageBuffer(m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor);
+        m_bindlessIndices.meshBuffers[i] = m_bindlessSet.AddStorageBuffer(meshBufferInfo);
+        m_bindlessIndices.outputTextures[i] = m_bindlessSet.AddSampledImage(m_outputTextures[i].TextureImage.Descriptor);
+    }
+
+    // Add* returns BINDLESS_INVALID_INDEX if an array of the set is full
+    bool registered = (m_bindlessIndices.inputTexture != BINDLESS_INVALID_INDEX);
+    for (size_t i = 0; i < m_framesInFlight; i++)
+    {
+        registered = registered && 
+                     (m_bindlessIndices.frameBuffers[i] != BINDLESS_INVALID_INDEX) && 
+                     (m_bindlessIndices.meshBuffers[i] != BINDLESS_INVALID_INDEX) && 
+                     (m_bindlessIndices.outputTextures[i] != BINDLESS_INVALID_INDEX);
+    }
+
+    return registered;
+}
+
 void VKComputeShader::CreatePipelineLayout()
 {
     // Create a pipeline layout that will be used to create one or more pipeline objects.
@@ -978,6 +1358,20 @@ void VKComputeShader::CreatePipelineLayout()
     pPipelineLayoutCreateInfo.pNext = nullptr;
     pPipelineLayoutCreateInfo.setLayoutCount = 1;
     pPipelineLayoutCreateInfo.pSetLayouts = &m_sampleParams.DescriptorSetLayout;
+
+    // In bindless mode, the layout of the bindless descriptor set is used instead, along with the
+    // push constant range selecting the resources of each draw (accessed by VS and FS).
+    VkDescriptorSetLayout bindlessSetLayout = m_bindlessSet.GetSetLayout();
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(BindlessPushConstants);
+    if (m_bindless)
+    {
+        pPipelineLayoutCreateInfo.pSetLayouts = &bindlessSetLayout;
+        pPipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+        pPipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+    }
     
     VK_CHECK_RESULT(vkCreatePipelineLayout(m_vulkanParams.Device, &pPipelineLayoutCreateInfo, nullptr, &m_sampleParams.PipelineLayout));
 }
@@ -1109,8 +1503,8 @@ void VKComputeShader::CreatePipelineObjects()
     //
     // Shaders
     //
-    VkShaderModule renderVS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/render.vert.spv");
-    VkShaderModule renderFS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/render.frag.spv");
+    VkShaderModule renderVS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + (m_bindless ? "/data/shaders/render_bindless.vert.spv" : "/data/shaders/render.vert.spv"));
+    VkShaderModule renderFS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + (m_bindless ? "/data/shaders/render_bindless.frag.spv" : "/data/shaders/render.frag.spv"));
 
 
     // This sample will use three programmable stage: Vertex, Geometry and Fragment shaders
@@ -1163,9 +1557,9 @@ void VKComputeShader::CreatePipelineObjects()
     
     // Create a graphics pipeline for rendering the quads
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.Pipelines[PIPELINE_RENDER]));
+                                              &m_sampleParams.Pipelines[m_pipelineRender]));
 
     //
     // Destroy shader modules
@@ -1177,6 +1571,190 @@ void VKComputeShader::CreatePipelineObjects()
     vkDestroyShaderModule(m_vulkanParams.Device, renderFS, nullptr);
 }
 
+void VKComputeShader::BuildComputeChain()
+{
+    //
+    // Translate the list of filters (--filters name[:radius],...) into a sequence of compute passes.
+    // Available filters:
+    //   luminance             Grayscale conversion
+    //   blur[:radius]         Separable Gaussian blur (two passes, 8 texels radius by default)
+    //   box[:radius]          Box blur (tiled convolution, 2 texels radius by default)
+    //   gaussian[:radius]     Gaussian blur (tiled convolution, 4 texels radius by default)
+    //   sharpen[:radius]      Unsharp mask (tiled convolution, 2 texels radius by default)
+    //   sobel                 Sobel edge detection
+    //   levels                Auto levels (a histogram pass followed by a levels pass)
+    //   bilateral[:radius]    Edge-preserving bilateral filter (4 texels radius by default)
+    //
+    // The radius is a specialization constant of the filter shaders, so each radius used by the chain has its own pipeline.
+    //
+
+    const uint32_t width = m_inputTexture.TextureWidth;
+    const uint32_t height = m_inputTexture.TextureHeight;
+
+    // Texture read by the next pass, and intermediate texture written by the next pass writing a texture
+    uint32_t srcTexture = COMPUTE_INPUT_TEXTURE;
+    uint32_t dstTexture = COMPUTE_PING_TEXTURE;
+
+    auto addPass = [&](const char* name, FilterShader shader, const FilterParams& params, int32_t radius, int32_t kernel,
+                       uint32_t threadCountX, uint32_t threadCountY, bool writesTexture) -> ComputePass& {
+        ComputePass pass = {};
+        pass.name = std::to_string(m_computePasses.size() + 1) + ". " + name;
+        pass.shader = shader;
+        pass.pipeline = INVALID_TABLE_HANDLE;    // Registered by PrepareCompute, once the workgroup size is known
+        pass.params = params;
+        pass.srcTexture = srcTexture;
+        pass.dstTexture = writesTexture ? dstTexture : 0;
+        pass.reads = pass.srcTexture;
+        pass.writes = pass.dstTexture;
+        pass.threadCountX = threadCountX;
+        pass.threadCountY = threadCountY;
+
+        // The blur passes process segments of lines, the other filters process square tiles.
+        // Only the histogram and levels shaders have a fixed workgroup size.
+        pass.specialization.groupSizeX = (shader == FILTER_BLUR) ? BLUR_GROUP_SIZE : FILTER_TILE_SIZE;
+        pass.specialization.groupSizeY = (shader == FILTER_BLUR) ? 1 : FILTER_TILE_SIZE;
+        pass.specialization.radius = radius;
+        pass.specialization.kernel = kernel;
+        pass.tunable = (shader != FILTER_HISTOGRAM) && (shader != FILTER_LEVELS);
+        m_computePasses.push_back(pass);
+
+        // The next pass reads the texture written by this one, and writes the other intermediate texture
+        if (writesTexture)
+        {
+            srcTexture = dstTexture;
+            dstTexture = (dstTexture == COMPUTE_PING_TEXTURE) ? COMPUTE_PONG_TEXTURE : COMPUTE_PING_TEXTURE;
+        }
+
+        return m_computePasses.back();
+    };
+
+    size_t start = 0;
+    while (start < m_filterChain.size())
+    {
+        size_t end = std::min(m_filterChain.find(',', start), m_filterChain.size());
+        std::string filter = m_filterChain.substr(start, end - start);
+        start = end + 1;
+
+        // Optional radius of the filter
+        size_t colon = filter.find(':');
+        std::string name = filter.substr(0, colon);
+        int32_t radius = (colon != std::string::npos) ? static_cast<int32_t>(strtol(filter.c_str() + colon + 1, nullptr, 10)) : 0;
+
+        FilterParams params = {};
+
+        if (name == "luminance")
+        {
+            addPass("luminance", FILTER_LUMINANCE, params, 0, 0, width, height, true);
+        }
+        else if (name == "blur")
+        {
+            // Horizontal pass over the rows, followed by a vertical pass over the columns
+            // (the invocations along x cover a line, the ones along y select the line).
+            radius = (radius > 0) ? std::min(radius, BLUR_MAX_RADIUS) : 8;
+            params.sigma = radius / 2.0f;
+            params.direction[0] = 1;
+            params.direction[1] = 0;
+            addPass("blur (horizontal)", FILTER_BLUR, params, radius, 0, width, height, true);
+            params.direction[0] = 0;
+            params.direction[1] = 1;
+            addPass("blur (vertical)", FILTER_BLUR, params, radius, 0, height, width, true);
+        }
+        else if (name == "box" || name == "gaussian" || name == "sharpen")
+        {
+            int32_t kernel = (name == "box") ? CONVOLVE_KERNEL_BOX : (name == "gaussian") ? CONVOLVE_KERNEL_GAUSSIAN : CONVOLVE_KERNEL_SHARPEN;
+            radius = (radius > 0) ? std::min(radius, CONVOLVE_MAX_RADIUS) : (kernel == CONVOLVE_KERNEL_GAUSSIAN) ? 4 : 2;
+            params.sigma = radius / 2.0f;
+            addPass(name.c_str(), FILTER_CONVOLVE, params, radius, kernel, width, height, true);
+        }
+        else if (name == "sobel")
+        {
+            addPass("sobel", FILTER_SOBEL, params, 0, 0, width, height, true);
+        }
+        else if (name == "levels")
+        {
+            // The histogram pass writes no texture: the levels pass reads the same texture, along with the histogram
+            params.clipLow = 0.01f;
+            params.clipHigh = 0.01f;
+            addPass("histogram", FILTER_HISTOGRAM, params, 0, 0, width, height, false).writes = COMPUTE_HISTOGRAM;
+            addPass("levels", FILTER_LEVELS, params, 0, 0, width, height, true).reads |= COMPUTE_HISTOGRAM;
+            m_clearHistogram = true;
+        }
+        else if (name == "bilateral")
+        {
+            radius = (radius > 0) ? std::min(radius, BILATERAL_MAX_RADIUS) : 4;
+            params.sigma = radius / 2.0f;
+            params.rangeSigma = 0.1f;
+            addPass("bilateral", FILTER_BILATERAL, params, radius, 0, width, height, true);
+        }
+        else if (!name.empty())
+        {
+            printf("Unknown filter: %s (available filters: luminance, blur[:radius], box[:radius], gaussian[:radius], sharpen[:radius], sobel, levels, bilateral[:radius])\n", name.c_str());
+        }
+    }
+
+    // Each pass is profiled in its own scope, so the number of passes is limited.
+    // Passes writing no texture can't end the chain.
+    if (m_computePasses.size() > MAX_COMPUTE_PASSES)
+    {
+        printf("Too many compute passes (%u): only the first %u are executed\n", static_cast<uint32_t>(m_computePasses.size()), MAX_COMPUTE_PASSES);
+        m_computePasses.resize(MAX_COMPUTE_PASSES);
+    }
+    while (!m_computePasses.empty() && m_computePasses.back().dstTexture == 0)
+        m_computePasses.pop_back();
+
+    if (m_computePasses.empty())
+    {
+        printf("No valid filter in the chain: the luminance filter is used\n");
+        srcTexture = COMPUTE_INPUT_TEXTURE;
+        dstTexture = COMPUTE_PING_TEXTURE;
+        addPass("luminance", FILTER_LUMINANCE, FilterParams(), 0, 0, width, height, true);
+    }
+
+    // The last pass writes the output texture of the frame, rather than an intermediate texture
+    ComputePass& lastPass = m_computePasses.back();
+    lastPass.writes = (lastPass.writes & ~lastPass.dstTexture) | COMPUTE_OUTPUT_TEXTURE;
+    lastPass.dstTexture = COMPUTE_OUTPUT_TEXTURE;
+
+    //
+    // Find the barriers needed between the passes.
+    // A pass must wait for the previous passes that wrote the resources it accesses (read after write and write after
+    // write), whose writes must also be made visible to it, and for the ones that read the resources it writes
+    // (write after read), which only requires an execution dependency. Any other pair of passes (for e.g. two passes
+    // reading the same texture) can overlap, and writes are only made visible to the passes that access them.
+    //
+
+    uint32_t unflushedWrites = m_clearHistogram ? COMPUTE_HISTOGRAM : 0;    // Written and not made visible by a barrier yet
+    uint32_t readsSinceBarrier = 0;                                         // Read since the last barrier
+    bool unflushedClear = m_clearHistogram;                                 // The clear of the histogram (a transfer) is not visible yet
+    uint32_t barrierCount = 0;
+
+    for (ComputePass& pass : m_computePasses)
+    {
+        pass.barrierResources = unflushedWrites & (pass.reads | pass.writes);
+        pass.barrier = (pass.barrierResources != 0) || (pass.writes & readsSinceBarrier) != 0;
+
+        if (pass.barrier)
+        {
+            pass.barrierSrcStages = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | (unflushedClear ? VK_PIPELINE_STAGE_TRANSFER_BIT : 0);
+            if (pass.barrierResources & COMPUTE_HISTOGRAM)
+                unflushedClear = false;
+
+            unflushedWrites &= ~pass.barrierResources;
+            readsSinceBarrier = 0;
+            barrierCount++;
+        }
+
+        unflushedWrites |= pass.writes;
+        readsSinceBarrier |= pass.reads;
+    }
+
+    std::string passNames;
+    for (const ComputePass& pass : m_computePasses)
+        passNames += (passNames.empty() ? "" : ", ") + pass.name.substr(pass.name.find(' ') + 1);
+
+    printf("Compute chain: %s (%u passes, %u barriers)\n", passNames.c_str(), static_cast<uint32_t>(m_computePasses.size()), barrierCount);
+}
+
 void VKComputeShader::PrepareCompute()
 {
     //
@@ -1193,7 +1771,7 @@ void VKComputeShader::PrepareCompute()
     // Create descriptor set layout
     //
 
-    VkDescriptorSetLayoutBinding layoutBinding[2] = {};
+    VkDescriptorSetLayoutBinding layoutBinding[3] = {};
 
     // Binding 0: Input texture
     layoutBinding[0].binding = 0;
@@ -1209,115 +1787,173 @@ void VKComputeShader::PrepareCompute()
     layoutBinding[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
     layoutBinding[1].pImmutableSamplers = nullptr;
 
+    // Binding 2: Histogram buffer
+    layoutBinding[2].binding = 2;
+    layoutBinding[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    layoutBinding[2].descriptorCount = 1;
+    layoutBinding[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    layoutBinding[2].pImmutableSamplers = nullptr;
+
     VkDescriptorSetLayoutCreateInfo descriptorLayout = {};
     descriptorLayout.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     descriptorLayout.pNext = nullptr;
-    descriptorLayout.bindingCount = 2;
+    descriptorLayout.bindingCount = 3;
     descriptorLayout.pBindings = layoutBinding;
 
     VK_CHECK_RESULT(vkCreateDescriptorSetLayout(m_vulkanParams.Device, &descriptorLayout, nullptr, &m_sampleComputeParams.DescriptorSetLayout));
 
     //
-    // Create a pipeline layout
+    // Create a pipeline layout, shared by all the filters
     //
 
+    // The parameters of each pass are passed through push constants
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(FilterParams);
+
     VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo = {};
     pPipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pPipelineLayoutCreateInfo.setLayoutCount = 1;
     pPipelineLayoutCreateInfo.pSetLayouts = &m_sampleComputeParams.DescriptorSetLayout;
+    pPipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pPipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
     
     VK_CHECK_RESULT(vkCreatePipelineLayout(m_vulkanParams.Device, &pPipelineLayoutCreateInfo, nullptr, &m_sampleComputeParams.PipelineLayout));
 
     //
     // Allocate descriptor sets and update descriptors
     //
-        
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+
+    // Allocate a descriptor set for each pass of the chain, for each frame in flight (the last pass writes
+    // the output texture of the frame), from the global descriptor pool.
+    // The descriptor set of pass p for frame f is at index f * passCount + p.
+    const size_t passCount = m_computePasses.size();
+    const size_t setCount = m_framesInFlight * passCount;
+
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleComputeParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(setCount);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(setCount, m_sampleComputeParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleComputeParams.FrameRes.DescriptorSets[DESC_SET_COMPUTE].resize(MAX_FRAME_LAG);
+    m_sampleComputeParams.FrameRes.DescriptorSets[m_descSetCompute].resize(setCount);
 
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleComputeParams.FrameRes.DescriptorSets[DESC_SET_COMPUTE].data()));
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleComputeParams.FrameRes.DescriptorSets[m_descSetCompute].data()));
 
     // Write the descriptors updating the corresponding descriptor sets.
-    VkWriteDescriptorSet writeDescriptorSet[2] = {};
+    VkWriteDescriptorSet writeDescriptorSet[3] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Write the descriptor of the input texture.
-        writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleComputeParams.FrameRes.DescriptorSets[DESC_SET_COMPUTE][i];
-        writeDescriptorSet[0].descriptorCount = 1;
-        writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        writeDescriptorSet[0].pImageInfo = &m_inputTexture.TextureImage.Descriptor;
-        writeDescriptorSet[0].dstBinding = 0;
-
-        // Write the descriptor of the output texture.
-        writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleComputeParams.FrameRes.DescriptorSets[DESC_SET_COMPUTE][i];
-        writeDescriptorSet[1].descriptorCount = 1;
-        writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        writeDescriptorSet[1].pImageInfo = &m_outputTextures[i].TextureImage.Descriptor;
-        writeDescriptorSet[1].dstBinding = 1;
-
-        vkUpdateDescriptorSets(m_vulkanParams.Device, 2, writeDescriptorSet, 0, nullptr);
+        for (size_t p = 0; p < passCount; p++)
+        {
+            const ComputePass& pass = m_computePasses[p];
+            VkDescriptorSet descriptorSet = m_sampleComputeParams.FrameRes.DescriptorSets[m_descSetCompute][i * passCount + p];
+            uint32_t writeCount = 0;
+
+            // Write the descriptor of the texture read by the pass.
+            writeDescriptorSet[writeCount].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSet[writeCount].dstSet = descriptorSet;
+            writeDescriptorSet[writeCount].descriptorCount = 1;
+            writeDescriptorSet[writeCount].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            writeDescriptorSet[writeCount].pImageInfo = &GetComputeTexture(pass.srcTexture, i).TextureImage.Descriptor;
+            writeDescriptorSet[writeCount].dstBinding = 0;
+            writeCount++;
+
+            // Write the descriptor of the texture written by the pass (if any).
+            if (pass.dstTexture != 0)
+            {
+                writeDescriptorSet[writeCount].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                writeDescriptorSet[writeCount].dstSet = descriptorSet;
+                writeDescriptorSet[writeCount].descriptorCount = 1;
+                writeDescriptorSet[writeCount].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+                writeDescriptorSet[writeCount].pImageInfo = &GetComputeTexture(pass.dstTexture, i).TextureImage.Descriptor;
+                writeDescriptorSet[writeCount].dstBinding = 1;
+                writeCount++;
+            }
+
+            // Write the descriptor of the histogram buffer.
+            writeDescriptorSet[writeCount].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            writeDescriptorSet[writeCount].dstSet = descriptorSet;
+            writeDescriptorSet[writeCount].descriptorCount = 1;
+            writeDescriptorSet[writeCount].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            writeDescriptorSet[writeCount].pBufferInfo = &m_histogramBuffer.Descriptor;
+            writeDescriptorSet[writeCount].dstBinding = 2;
+            writeCount++;
+
+            vkUpdateDescriptorSets(m_vulkanParams.Device, writeCount, writeDescriptorSet, 0, nullptr);
+        }
     }
 
     //
-    // Shaders
+    // Create the compute pipelines of the filters used by the chain
     //
 
-    VkShaderModule luminanceCS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/luminance.comp.spv");
+    // Load the shader modules of the filters used by the chain
+    VkShaderModule filterModules[FILTER_SHADER_COUNT] = {};
+    for (const ComputePass& pass : m_computePasses)
+    {
+        if (filterModules[pass.shader] == VK_NULL_HANDLE)
+        {
+            filterModules[pass.shader] = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/" + s_filterShaderFiles[pass.shader]);
+            assert(filterModules[pass.shader] != VK_NULL_HANDLE);
+        }
+    }
 
-    VkPipelineShaderStageCreateInfo shaderStage{};
-    
-    // Compute shader
-    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    // Set pipeline stage for this shader
-    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-    // Load binary SPIR-V shader module
-    shaderStage.module = luminanceCS;
-    // Main entry point for the shader
-    shaderStage.pName = "main";
-    assert(shaderStage.module != VK_NULL_HANDLE);
+    // With --autotune, the workgroup size of each pass is the fastest one on this device among the sizes it supports
+    // (see TuneComputePass). Otherwise, the passes use the default sizes set by BuildComputeChain.
+    if (m_autotune)
+    {
+        VKComputeTuner tuner;
+        tuner.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device, m_vulkanParams.ComputeQueue.Handle, m_vulkanParams.ComputeQueue.FamilyIndex);
 
-    //
-    // Create the compute pipeline used in this sample
-    //
+        if (tuner.IsSupported())
+        {
+            for (size_t p = 0; p < passCount; p++)
+            {
+                if (m_computePasses[p].tunable)
+                    TuneComputePass(tuner, p, filterModules[m_computePasses[p].shader]);
+            }
+        }
 
-    VkComputePipelineCreateInfo pipelineCreateInfo = {};
-    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-    // The pipeline layout used for this pipeline
-    pipelineCreateInfo.layout = m_sampleComputeParams.PipelineLayout;    
-    // Set pipeline shader stage
-    pipelineCreateInfo.stage = shaderStage;
-    
-    // Create a compute pipeline for computing the luminance of the input texture
-    VK_CHECK_RESULT(vkCreateComputePipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
-                                              &pipelineCreateInfo, nullptr, 
-                                              &m_sampleComputeParams.Pipelines[PIPELINE_LUMINANCE]));
+        tuner.Destroy();
+    }
+
+    // Create a pipeline for each variant of the filter shaders (workgroup size, radius and kernel) used by the chain.
+    // Passes using the same variant (for e.g. the passes of two luminance filters) share its pipeline.
+    for (ComputePass& pass : m_computePasses)
+    {
+        const FilterSpecialization& spec = pass.specialization;
+        std::string variantName = std::string(s_filterPipelineNames[pass.shader]) + " " +
+                                  std::to_string(spec.groupSizeX) + "x" + std::to_string(spec.groupSizeY) +
+                                  " r" + std::to_string(spec.radius) + " k" + std::to_string(spec.kernel);
+
+        pass.pipeline = m_sampleComputeParams.Pipelines.Register(variantName, VK_NULL_HANDLE);
+        if (m_sampleComputeParams.Pipelines[pass.pipeline] == VK_NULL_HANDLE)
+            m_sampleComputeParams.Pipelines[pass.pipeline] = CreateFilterPipeline(filterModules[pass.shader], spec);
+    }
 
     // Destroy shader modules
-    vkDestroyShaderModule(m_vulkanParams.Device, luminanceCS, nullptr);
+    for (VkShaderModule filterModule : filterModules)
+    {
+        if (filterModule != VK_NULL_HANDLE)
+            vkDestroyShaderModule(m_vulkanParams.Device, filterModule, nullptr);
+    }
 
     //
     // Allocate command buffers to store compute commands
     //
 
-    m_sampleComputeParams.FrameRes.CommandBuffers.resize(MAX_FRAME_LAG);
+    m_sampleComputeParams.FrameRes.CommandBuffers.resize(m_framesInFlight);
 
     VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
     commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     commandBufferAllocateInfo.commandPool = m_sampleParams.CommandPool;
     commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, m_sampleComputeParams.FrameRes.CommandBuffers.data()));
 
@@ -1325,8 +1961,8 @@ void VKComputeShader::PrepareCompute()
     // Create fences and semaphores
     //
 
-    m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE].resize(MAX_FRAME_LAG);
-    m_sampleComputeParams.FrameRes.Fences.resize(MAX_FRAME_LAG);
+    m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete].resize(m_framesInFlight);
+    m_sampleComputeParams.FrameRes.Fences.resize(m_framesInFlight);
 
     VkSemaphoreCreateInfo semaphoreCreateInfo = {};
     semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -1337,10 +1973,10 @@ void VKComputeShader::PrepareCompute()
     fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Semaphore synchronizing graphics and compute operations
-        VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE][i]));
+        VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete][i]));
 
         // Signaled fence for synchronizing frames in compute queue
         VK_CHECK_RESULT(vkCreateFence(m_vulkanParams.Device, &fenceCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Fences[i]));
@@ -1350,56 +1986,288 @@ void VKComputeShader::PrepareCompute()
     // Create and signal the graphics semaphores (to immediately submit the compute work during the creation of the first frame)
     //
 
-    m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE].resize(MAX_FRAME_LAG);
+    m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete].resize(m_framesInFlight);
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create an unsignaled semaphore
-        VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE][i]));
+        VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete][i]));
     }
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.signalSemaphoreCount = 2;
-    submitInfo.pSignalSemaphores = m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE].data();
+    submitInfo.signalSemaphoreCount = static_cast<uint32_t>(m_framesInFlight);
+    submitInfo.pSignalSemaphores = m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete].data();
     VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
     VK_CHECK_RESULT(vkQueueWaitIdle(m_vulkanParams.GraphicsQueue.Handle));
 }
 
-void VKComputeShader::PopulateComputeCommandBuffer()
+VkPipeline VKComputeShader::CreateFilterPipeline(VkShaderModule shaderModule, const FilterSpecialization& specialization)
 {
-    VkCommandBufferBeginInfo cmdBufInfo = {};
-    cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    // Map the members of FilterSpecialization to the constant IDs of the filter shaders.
+    // Entries whose ID is not declared by the shader (for e.g. the radius for the luminance shader) are ignored.
+    VkSpecializationMapEntry specializationEntries[4] = {};
+    specializationEntries[0] = { 0, offsetof(FilterSpecialization, groupSizeX), sizeof(uint32_t) };
+    specializationEntries[1] = { 1, offsetof(FilterSpecialization, groupSizeY), sizeof(uint32_t) };
+    specializationEntries[2] = { 2, offsetof(FilterSpecialization, radius), sizeof(int32_t) };
+    specializationEntries[3] = { 3, offsetof(FilterSpecialization, kernel), sizeof(int32_t) };
+
+    VkSpecializationInfo specializationInfo = {};
+    specializationInfo.mapEntryCount = 4;
+    specializationInfo.pMapEntries = specializationEntries;
+    specializationInfo.dataSize = sizeof(FilterSpecialization);
+    specializationInfo.pData = &specialization;
 
-    VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
+    VkPipelineShaderStageCreateInfo shaderStage{};
+    
+    // Compute shader
+    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    // Set pipeline stage for this shader
+    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    // Load binary SPIR-V shader module
+    shaderStage.module = shaderModule;
+    // Main entry point for the shader
+    shaderStage.pName = "main";
+    // Values of the specialization constants (workgroup size, radius and kernel)
+    shaderStage.pSpecializationInfo = &specializationInfo;
 
-    // "Transition" the image layout of the output texture to only set a memory barrier
-     TransitionImageLayout(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex],
-                    m_outputTextures[m_frameIndex].TextureImage.Handle, VK_IMAGE_ASPECT_COLOR_BIT, 
-                    VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL,
-                    VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
-                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    VkComputePipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    // The pipeline layout used for this pipeline
+    pipelineCreateInfo.layout = m_sampleComputeParams.PipelineLayout;    
+    // Set pipeline shader stage
+    pipelineCreateInfo.stage = shaderStage;
+    
+    // Create a compute pipeline executing the filter
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VK_CHECK_RESULT(vkCreateComputePipelines(m_vulkanParams.Device, 
+                                              m_pipelineCache, 1, 
+                                              &pipelineCreateInfo, nullptr, 
+                                              &pipeline));
+
+    return pipeline;
+}
+
+uint32_t VKComputeShader::GetSharedMemorySize(FilterShader shader, const FilterSpecialization& specialization)
+{
+    // Size of the shared arrays declared by the filter shaders (a texel is a vec4 of 16 bytes, or a float for sobel.comp)
+    const uint32_t groupSizeX = specialization.groupSizeX;
+    const uint32_t groupSizeY = specialization.groupSizeY;
+    const uint32_t halo = 2 * static_cast<uint32_t>(specialization.radius);
+    const uint32_t weightsSize = (static_cast<uint32_t>(specialization.radius) + 1) * 4;
+
+    switch (shader)
+    {
+        case FILTER_BLUR:       return (groupSizeX + halo) * groupSizeY * 16 + weightsSize;
+        case FILTER_SOBEL:      return (groupSizeX + 2) * (groupSizeY + 2) * 4;
+        case FILTER_BILATERAL:  return (groupSizeX + halo) * (groupSizeY + halo) * 16;
+        case FILTER_CONVOLVE:   return ((groupSizeX + halo) + groupSizeX) * (groupSizeY + halo) * 16 + weightsSize;
+        case FILTER_HISTOGRAM:  return 256 * 4;
+        case FILTER_LEVELS:     return 256 * 4 + 8;
+        default:                return 0;
+    }
+}
+
+void VKComputeShader::TuneComputePass(VKComputeTuner& tuner, size_t passIndex, VkShaderModule shaderModule)
+{
+    ComputePass& pass = m_computePasses[passIndex];
+    const VkPhysicalDeviceLimits& limits = m_deviceProperties.limits;
+
+    // Candidate workgroup sizes: segments of one or more lines for the blur passes, tiles of different shapes for the
+    // other filters. Larger workgroups share the halo among more invocations, but need more shared memory (which can
+    // limit the number of workgroups executing at the same time on a compute unit) and synchronize more invocations.
+    static const uint32_t lineGroupSizes[][2] = { {64, 1}, {128, 1}, {256, 1}, {512, 1}, {1024, 1}, {64, 2}, {64, 4}, {128, 2} };
+    static const uint32_t tileGroupSizes[][2] = { {8, 8}, {16, 8}, {8, 16}, {16, 16}, {32, 8}, {8, 32}, {32, 16}, {16, 32}, {32, 32} };
+
+    const uint32_t (*groupSizes)[2] = (pass.shader == FILTER_BLUR) ? lineGroupSizes : tileGroupSizes;
+    size_t groupSizeCount = (pass.shader == FILTER_BLUR) ? sizeof(lineGroupSizes) / sizeof(lineGroupSizes[0]) : sizeof(tileGroupSizes) / sizeof(tileGroupSizes[0]);
+
+    // Skip the sizes exceeding the limits of the device
+    std::vector<FilterSpecialization> candidates;
+    for (size_t i = 0; i < groupSizeCount; i++)
+    {
+        FilterSpecialization candidate = pass.specialization;
+        candidate.groupSizeX = groupSizes[i][0];
+        candidate.groupSizeY = groupSizes[i][1];
+
+        if (candidate.groupSizeX * candidate.groupSizeY > limits.maxComputeWorkGroupInvocations ||
+            candidate.groupSizeX > limits.maxComputeWorkGroupSize[0] ||
+            candidate.groupSizeY > limits.maxComputeWorkGroupSize[1] ||
+            GetSharedMemorySize(pass.shader, candidate) > limits.maxComputeSharedMemorySize)
+            continue;
+
+        candidates.push_back(candidate);
+    }
+
+    if (candidates.size() < 2)
+        return;
+
+    // Create a pipeline for each candidate, and time it on the textures of the first frame
+    std::vector<VkPipeline> pipelines;
+    for (const FilterSpecialization& candidate : candidates)
+        pipelines.push_back(CreateFilterPipeline(shaderModule, candidate));
+
+    VkDescriptorSet descriptorSet = m_sampleComputeParams.FrameRes.DescriptorSets[m_descSetCompute][passIndex];
+    std::vector<double> times;
+    uint32_t fastest = tuner.SelectFastest(static_cast<uint32_t>(candidates.size()), 
+                                           [&](VkCommandBuffer commandBuffer, uint32_t variant) {
+                                               RecordComputePass(commandBuffer, pass, candidates[variant], pipelines[variant], descriptorSet);
+                                           }, &times);
+
+    printf("Autotune %s:", pass.name.c_str());
+    for (size_t i = 0; i < candidates.size(); i++)
+        printf(" %ux%u %.3f ms%s", candidates[i].groupSizeX, candidates[i].groupSizeY, times[i], (i + 1 < candidates.size()) ? "," : "");
+    printf(" -> %ux%u\n", candidates[fastest].groupSizeX, candidates[fastest].groupSizeY);
+
+    pass.specialization = candidates[fastest];
 
+    for (VkPipeline pipeline : pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pipeline, nullptr);
+}
+
+void VKComputeShader::RecordComputePass(VkCommandBuffer commandBuffer, const ComputePass& pass, const FilterSpecialization& specialization,
+                                        VkPipeline pipeline, VkDescriptorSet descriptorSet)
+{
     // Bind the compute pipeline to a compute bind point of the command buffer
-    vkCmdBindPipeline(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], 
-                        VK_PIPELINE_BIND_POINT_COMPUTE, 
-                        m_sampleComputeParams.Pipelines[PIPELINE_LUMINANCE]);
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
 
     // Bind descriptor set
-    vkCmdBindDescriptorSets(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], 
+    vkCmdBindDescriptorSets(commandBuffer, 
                             VK_PIPELINE_BIND_POINT_COMPUTE, 
                             m_sampleComputeParams.PipelineLayout, 
                             0, 1, 
-                            &m_sampleComputeParams.FrameRes.DescriptorSets[DESC_SET_COMPUTE][m_frameIndex], 
+                            &descriptorSet, 
                             0, nullptr);
 
-    // Dispatch compute work
-    vkCmdDispatch(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], 
-                            m_outputTextures[m_frameIndex].TextureWidth / 16, 
-                            m_outputTextures[m_frameIndex].TextureHeight / 16, 1);
+    // Set the parameters of the pass
+    vkCmdPushConstants(commandBuffer, 
+                       m_sampleComputeParams.PipelineLayout, 
+                       VK_SHADER_STAGE_COMPUTE_BIT, 
+                       0, sizeof(FilterParams), &pass.params);
+
+    // Dispatch compute work (enough workgroups to cover all the invocations of the pass)
+    vkCmdDispatch(commandBuffer, 
+                  (pass.threadCountX + specialization.groupSizeX - 1) / specialization.groupSizeX, 
+                  (pass.threadCountY + specialization.groupSizeY - 1) / specialization.groupSizeY, 
+                  1);
+}
+
+void VKComputeShader::PopulateComputeCommandBuffer()
+{
+    VkCommandBuffer commandBuffer = m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex];
+
+    VkCommandBufferBeginInfo cmdBufInfo = {};
+    cmdBufInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cmdBufInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VK_CHECK_RESULT(vkBeginCommandBuffer(commandBuffer, &cmdBufInfo));
+
+    // The intermediate textures and the histogram buffer are shared by all the frames in flight, and the compute work 
+    // of the previous frame could still be executing (consecutive compute submissions are not synchronized by semaphores).
+    // Wait for it, and for the fragment shader reading the output texture of this frame slot, before writing any of them.
+    VkMemoryBarrier memoryBarrier = {};
+    memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, 
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 
+                         0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+    // Clear the histogram computed by the levels filter
+    if (m_clearHistogram)
+        vkCmdFillBuffer(commandBuffer, m_histogramBuffer.Handle, 0, VK_WHOLE_SIZE, 0);
+
+    // Record the passes of the chain of filters, each one with its pipeline, descriptor set and parameters
+    m_profiler.BeginScope(commandBuffer, "Compute");
+    for (size_t p = 0; p < m_computePasses.size(); p++)
+    {
+        const ComputePass& pass = m_computePasses[p];
+
+        // Wait for the previous passes accessing the same resources (see BuildComputeChain)
+        if (pass.barrier)
+            InsertComputeBarrier(commandBuffer, pass);
+
+        // Bind the pipeline, descriptor set and parameters of the pass, and dispatch its compute work
+        m_profiler.BeginScope(commandBuffer, pass.name.c_str());
+        RecordComputePass(commandBuffer, pass, pass.specialization, 
+                          m_sampleComputeParams.Pipelines[pass.pipeline], 
+                          m_sampleComputeParams.FrameRes.DescriptorSets[m_descSetCompute][m_frameIndex * m_computePasses.size() + p]);
+        m_profiler.EndScope(commandBuffer, pass.name.c_str());
+    }
+    m_profiler.EndScope(commandBuffer, "Compute");
+
+    VK_CHECK_RESULT(vkEndCommandBuffer(commandBuffer));
+}
+
+void VKComputeShader::InsertComputeBarrier(VkCommandBuffer commandBuffer, const ComputePass& pass)
+{
+    // Make the writes of the previous passes to the resources accessed by this pass visible to it.
+    // The layout of the textures is always VK_IMAGE_LAYOUT_GENERAL, so no transitions are needed.
+    std::vector<VkImageMemoryBarrier> imageBarriers;
+    std::vector<VkBufferMemoryBarrier> bufferBarriers;
+
+    for (uint32_t resource = COMPUTE_INPUT_TEXTURE; resource <= COMPUTE_HISTOGRAM; resource <<= 1)
+    {
+        if (!(pass.barrierResources & resource))
+            continue;
+
+        // Access of the pass to the resource
+        VkAccessFlags dstAccessMask = ((pass.reads & resource) ? VK_ACCESS_SHADER_READ_BIT : 0) | 
+                                      ((pass.writes & resource) ? VK_ACCESS_SHADER_WRITE_BIT : 0);
+
+        if (resource == COMPUTE_HISTOGRAM)
+        {
+            // The histogram is written by the clear at the beginning of the compute work, and by the histogram pass
+            VkBufferMemoryBarrier bufferBarrier = {};
+            bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            bufferBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | 
+                                          ((pass.barrierSrcStages & VK_PIPELINE_STAGE_TRANSFER_BIT) ? VK_ACCESS_TRANSFER_WRITE_BIT : 0);
+            bufferBarrier.dstAccessMask = dstAccessMask;
+            bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            bufferBarrier.buffer = m_histogramBuffer.Handle;
+            bufferBarrier.offset = 0;
+            bufferBarrier.size = VK_WHOLE_SIZE;
+            bufferBarriers.push_back(bufferBarrier);
+        }
+        else
+        {
+            VkImageMemoryBarrier imageBarrier = {};
+            imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            imageBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            imageBarrier.dstAccessMask = dstAccessMask;
+            imageBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+            imageBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+            imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            imageBarrier.image = GetComputeTexture(resource, m_frameIndex).TextureImage.Handle;
+            imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+            imageBarriers.push_back(imageBarrier);
+        }
+    }
+
+    // If there are no writes to make visible (the pass only writes a resource read by the previous passes),
+    // the barrier is an execution dependency only.
+    vkCmdPipelineBarrier(commandBuffer, 
+                         pass.barrierSrcStages, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+                         0, 0, nullptr, 
+                         static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(), 
+                         static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+}
 
-    VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex]));
+VKComputeShader::Texture2D& VKComputeShader::GetComputeTexture(uint32_t resource, uint32_t frameIndex)
+{
+    switch (resource)
+    {
+        case COMPUTE_INPUT_TEXTURE:   return m_inputTexture;
+        case COMPUTE_PING_TEXTURE:    return m_intermediateTextures[0];
+        case COMPUTE_PONG_TEXTURE:    return m_intermediateTextures[1];
+        case COMPUTE_OUTPUT_TEXTURE:  return m_outputTextures[frameIndex];
+        default:
+            assert(!"Not a texture accessed by the compute passes");
+            return m_inputTexture;
+    }
 }
 
 void VKComputeShader::PopulateCommandBuffer(uint32_t currentImageIndex)
@@ -1437,6 +2305,9 @@ void VKComputeShader::PopulateCommandBuffer(uint32_t currentImageIndex)
                     VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
                     VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
+    // Measure the GPU time of the render pass (timestamps must be reset outside render pass instances)
+    m_profiler.BeginScope(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], "Graphics");
+
     // Begin the render pass instance.
     // This will clear the color attachment.
     vkCmdBeginRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
@@ -1465,50 +2336,86 @@ void VKComputeShader::PopulateCommandBuffer(uint32_t currentImageIndex)
     vkCmdBindIndexBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_vertexindexBuffers.IBbuffer, 0, VK_INDEX_TYPE_UINT16);
 
     // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
-    uint32_t dynamicOffset = m_meshObjects[MESH_QUAD].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+    uint32_t dynamicOffset = m_meshObjects[m_meshQuad].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
 
     // Bind the graphics pipeline
     vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                         VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                        m_sampleParams.Pipelines[PIPELINE_RENDER]);
+                        m_sampleParams.Pipelines[m_pipelineRender]);
+
+    // In bindless mode, bind the bindless descriptor set once: the resources of each draw are selected by push constants
+    BindlessPushConstants pushConstants = {};
+    if (m_bindless)
+    {
+        m_bindlessSet.Bind(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_sampleParams.PipelineLayout);
+
+        pushConstants.frameBuffer = m_bindlessIndices.frameBuffers[m_frameIndex];
+        pushConstants.meshBuffer = m_bindlessIndices.meshBuffers[m_frameIndex];
+        pushConstants.meshIndex = dynamicOffset / sizeof(MeshInfo);  // The dynamic alignment is a multiple of sizeof(MeshInfo) (64 bytes)
+    }
 
     //
     // Pre compute
     //
 
-    // Bind descriptor set with the input texture
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[DESC_SET_PRE_COMPUTE][m_frameIndex], 
-                            1, &dynamicOffset);
+    if (m_bindless)
+    {
+        // Select the input texture
+        pushConstants.texture = m_bindlessIndices.inputTexture;
+        vkCmdPushConstants(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                           m_sampleParams.PipelineLayout, 
+                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 
+                           0, sizeof(pushConstants), &pushConstants);
+    }
+    else
+    {
+        // Bind descriptor set with the input texture
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                m_sampleParams.PipelineLayout, 
+                                0, 1, 
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetPreCompute][m_frameIndex], 
+                                1, &dynamicOffset);
+    }
 
     // Draw the quad where the input texture will be mapped
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[MESH_QUAD].indexCount, 1, 0, 0, 0);
+    vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[m_meshQuad].indexCount, 1, 0, 0, 0);
 
     //
     // Post compute
     //
 
-    // Bind descriptor set with the output texture
-    vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
-                            VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                            m_sampleParams.PipelineLayout, 
-                            0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[DESC_SET_POST_COMPUTE][m_frameIndex], 
-                            1, &dynamicOffset);
+    if (m_bindless)
+    {
+        // Select the output texture
+        pushConstants.texture = m_bindlessIndices.outputTextures[m_frameIndex];
+        vkCmdPushConstants(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                           m_sampleParams.PipelineLayout, 
+                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 
+                           0, sizeof(pushConstants), &pushConstants);
+    }
+    else
+    {
+        // Bind descriptor set with the output texture
+        vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
+                                VK_PIPELINE_BIND_POINT_GRAPHICS, 
+                                m_sampleParams.PipelineLayout, 
+                                0, 1, 
+                                &m_sampleParams.FrameRes.DescriptorSets[m_descSetPostCompute][m_frameIndex], 
+                                1, &dynamicOffset);
+    }
 
     // Shift viewport rectangle to select the right part of the render target
     viewport.x = (float)m_width / 2.0f;
     vkCmdSetViewport(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &viewport);
 
     // Draw the quad where the output texture will be mapped
-    vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[MESH_QUAD].indexCount, 1, 0, 0, 0);
+    vkCmdDrawIndexed(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[m_meshQuad].indexCount, 1, 0, 0, 0);
 
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
     vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
+    m_profiler.EndScope(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], "Graphics");
     
     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
@@ -1518,8 +2425,8 @@ void VKComputeShader::SubmitCommandBuffer()
     // Pipeline stages at which the queue submission will wait (via pWaitSemaphores)
     VkPipelineStageFlags waitStageMasks[] = {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     // Wait Semaphores
-    VkSemaphore waitSemaphores[] = { m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE][m_frameIndex], m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex] };
-    VkSemaphore signalSemaphores[] = { m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE][m_frameIndex], m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] };
+    VkSemaphore waitSemaphores[] = { m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete][m_frameIndex], m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex] };
+    VkSemaphore signalSemaphores[] = { m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete][m_frameIndex], m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] };
     // The submit info structure specifies a command buffer queue submission batch
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1532,7 +2439,7 @@ void VKComputeShader::SubmitCommandBuffer()
     submitInfo.pWaitSemaphores = waitSemaphores;        // Semaphore(s) to wait upon before the pWaitDstStageMask stagess start executing
     submitInfo.pSignalSemaphores = signalSemaphores;    // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKComputeShader::SubmitComputeCommandBuffer()
@@ -1548,8 +2455,8 @@ void VKComputeShader::SubmitComputeCommandBuffer()
     submitInfo.pCommandBuffers = &m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex];    // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
-    submitInfo.pWaitSemaphores = &m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE][m_frameIndex];    // Semaphore(s) to wait upon before the pWaitDstStageMask stages start executing
-    submitInfo.pSignalSemaphores = &m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE][m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pWaitSemaphores = &m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete][m_frameIndex];    // Semaphore(s) to wait upon before the pWaitDstStageMask stages start executing
+    submitInfo.pSignalSemaphores = &m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete][m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
     VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.ComputeQueue.Handle, 1, &submitInfo, m_sampleComputeParams.FrameRes.Fences[m_frameIndex]));
 }
@@ -1572,7 +2479,7 @@ void VKComputeShader::PresentImage(uint32_t currentImageIndex)
         presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -6,6 +6,12 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include "glm/glm.hpp"
 
+// Number of particles simulated if not specified on the command line (--particles N)
+#define DEFAULT_PARTICLE_COUNT 81
+
+// Preferred number of invocations in a compute workgroup (clamped to the device limits)
+#define PREFERRED_WORKGROUP_SIZE 256
+
 class VKComputeParticles : public VKSample
 {
 public:
@@ -46,13 +52,14 @@ private:
     void UpdateHostVisibleDynamicBufferData();
 
     // Buffer creation
-    void CreateStagingBuffer();                  // Create a staging buffer
     void CreateStorageBuffers();                 // Create storage buffers
 
     // Compute setup and operations
     void PrepareCompute();
     void PopulateComputeCommandBuffer();
     void SubmitComputeCommandBuffer();
+    void CreateTimelineSemaphores();
+    void WaitForFrameSlot();
 
 
     // For simplicity we use the same uniform block layout used in shader code:
@@ -91,15 +98,14 @@ private:
         MeshInfo *meshInfo;  // pointer to an array of mesh info
     } dynUBufVS;
     
-    // Vertex layout used in this sample (stride: 32 bytes)
+    // Vertex layout used in this sample (stride: 24 bytes)
     // We will store multiple vertices countiguously in storage buffers used both as vertex buffer and 
-    // uniform buffer, so we need to pad.
+    // storage buffer. The compute shader declares the particle with scalar members in the std430 layout, 
+    // so no padding is needed (the bandwidth wasted on padding matters with millions of particles).
     struct Vertex {
         glm::vec3 position;
-        float pad_1;
-        glm::vec2 size;
         float speed;
-        float pad_2;
+        glm::vec2 size;
     };
 
     // Mesh object info
@@ -117,25 +123,58 @@ private:
     struct StorageBuf {
         BufferParameters StorageBuffer;
 
-        // Buffer lenght and element size
-        static const uint32_t BufferLenght = 81; // num. of particles
+        // Element size (the number of elements is the number of particles)
         static const uint32_t BufferElementSize = sizeof(Vertex);  // byte size of each particle
     };
 
+    // Specialization constants used in the compute shader:
+    //
+    // layout (local_size_x_id = 0) in;
+    // layout (constant_id = 1) const uint PARTICLE_COUNT = 81;
+    // layout (constant_id = 2) const bool WRITE_STATE = false;
+    struct ComputeSpecConsts {
+        uint32_t workGroupSize;
+        uint32_t particleCount;
+        VkBool32 writeState;
+    } m_computeSpecConstants;
+
     // In this sample we have a single draw call.
     const unsigned int m_numDrawCalls = 1;
 
     // Mesh objects to draw
-    std::map<std::string, MeshObject> m_meshObjects;
+    VKHandleTable<MeshObject> m_meshObjects;
 
     // Storage buffers (one for each frame in flight).
     std::vector<StorageBuf> m_storageBuffers;
-    BufferParameters m_stagingBuffer;    // Staging buffer
+
+    // Simulation state (timeline semaphore scheduling only).
+    // Only accessed by the compute queue, which updates it in place and copies the particles 
+    // to the storage buffer of the current frame to be rendered by the graphics queue.
+    StorageBuf m_stateBuffer;
 
     // Compute resources and variables
     SampleParameters m_sampleComputeParams;
 
+    // Timeline semaphore scheduling (VK_KHR_timeline_semaphore).
+    // The value of each timeline semaphore is the number of the last frame whose compute or graphics work completed.
+    bool m_timelineSemaphores;                    // False if not supported or if --legacy-sync is specified
+    VkSemaphore m_computeTimeline;
+    VkSemaphore m_graphicsTimeline;
+    uint64_t m_frameNumber;                       // Number of the frame being recorded (the first one is 1)
+    PFN_vkWaitSemaphoresKHR vkWaitSemaphoresKHR;
+    VkPhysicalDeviceTimelineSemaphoreFeaturesKHR featuresTimeline;
+
+    // Handles of the named pipelines, mesh objects, descriptor sets and semaphores (registered in the constructor)
+    TableHandle m_pipelineRender;
+    TableHandle m_pipelineCompute;
+    TableHandle m_meshParticles;
+    TableHandle m_descSetGraphComp;
+    TableHandle m_semaphoreCompComplete;
+    TableHandle m_semaphoreGraphComplete;
+
     // Sample members
     size_t m_dynamicUBOAlignment;
-    std::vector<Vertex> m_particles;
+    uint32_t m_particleCount;           // Number of particles (set at launch with --particles N)
+    uint32_t m_dispatchGroupCount[2];   // Number of workgroups dispatched in X and Y to update all the particles
+    VKProfiler m_computeProfiler;       // Profiles the command buffers of the compute queue family (m_profiler those of the graphics one)
 };
\ No newline at end of file
@@ -16,10 +16,27 @@
 
 VKComputeParticles::VKComputeParticles(uint32_t width, uint32_t height, std::string name) :
 VKSample(width, height, name),
-m_dynamicUBOAlignment(0)
+m_computeSpecConstants{},
+m_dynamicUBOAlignment(0),
+m_particleCount(DEFAULT_PARTICLE_COUNT),
+m_dispatchGroupCount{1, 1},
+m_timelineSemaphores(true),
+m_computeTimeline(VK_NULL_HANDLE),
+m_graphicsTimeline(VK_NULL_HANDLE),
+m_frameNumber(0),
+vkWaitSemaphoresKHR(nullptr),
+featuresTimeline{}
 {
+    // Register the named pipelines, mesh objects, descriptor sets and semaphores, and keep their handles so that they are never looked up by name afterwards
+    m_pipelineRender = m_sampleParams.Pipelines.Register(PIPELINE_RENDER);
+    m_pipelineCompute = m_sampleComputeParams.Pipelines.Register(PIPELINE_COMPUTE);
+    m_meshParticles = m_meshObjects.Register(MESH_PARTICLES);
+    m_descSetGraphComp = m_sampleParams.FrameRes.DescriptorSets.Register(DESC_SET_GRAPH_COMP);
+    m_semaphoreCompComplete = m_sampleComputeParams.FrameRes.Semaphores.Register(SEMAPHORE_COMP_COMPLETE);
+    m_semaphoreGraphComplete = m_sampleComputeParams.FrameRes.Semaphores.Register(SEMAPHORE_GRAPH_COMPLETE);
+
     // Initialize mesh objects
-    m_meshObjects[MESH_PARTICLES] = {};
+    m_meshObjects[m_meshParticles] = {};
 
     // Initialize the pointer to the memory region that will store the array of mesh info.
     dynUBufVS.meshInfo = nullptr;
@@ -45,6 +62,17 @@ VKComputeParticles::~VKComputeParticles()
 
 void VKComputeParticles::OnInit()
 {
+    // The number of particles can be specified on the command line (--particles N).
+    // --legacy-sync disables the timeline semaphore scheduling, even if supported by the device.
+    std::vector<const char*>& args = *VKApplication::GetArgs();
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        if (strcmp(args[i], "--particles") == 0 && i + 1 < args.size())
+            m_particleCount = std::max(1u, static_cast<uint32_t>(strtoul(args[i + 1], nullptr, 10)));
+        else if (strcmp(args[i], "--legacy-sync") == 0)
+            m_timelineSemaphores = false;
+    }
+
     InitVulkan();
     SetupPipeline();
 }
@@ -53,20 +81,31 @@ void VKComputeParticles::InitVulkan()
 {
     CreateInstance();
     CreateSurface();
-    CreateDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT); // Check for a queue family supporting both graphics and compute operations
+    CreateDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT); // Check for a queue family supporting both graphics and compute operations, and look for a dedicated transfer queue
     GetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.FamilyIndex, m_vulkanParams.GraphicsQueue.Handle);
+    GetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.TransferQueue.FamilyIndex, m_vulkanParams.TransferQueue.Handle);
+    m_stagingRing.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device,
+                       m_vulkanParams.TransferQueue.Handle, m_vulkanParams.TransferQueue.FamilyIndex,
+                       m_vulkanParams.GraphicsQueue.Handle, m_vulkanParams.GraphicsQueue.FamilyIndex);
+    m_profiler.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.FamilyIndex, m_framesInFlight); // Timestamp queries for each frame in flight
+    // The compute command buffers can come from a dedicated compute queue family, whose timestamp support and valid bits
+    // can differ from the graphics one: the compute work is profiled with its own query pool, created for that family.
+    m_computeProfiler.Init(m_vulkanParams.PhysicalDevice, m_vulkanParams.Device, m_vulkanParams.ComputeQueue.FamilyIndex, m_framesInFlight);
     CreateSwapchain(&m_width, &m_height, VKApplication::settings.vsync);
     CreateDepthStencilImage(m_width, m_height);
     CreateRenderPass();
     CreateFrameBuffers();
     AllocateCommandBuffers();
     CreateSynchronizationObjects();
+
+    // Get extension function adresses 
+    if (m_timelineSemaphores)
+        vkWaitSemaphoresKHR = reinterpret_cast<PFN_vkWaitSemaphoresKHR>(vkGetDeviceProcAddr(m_vulkanParams.Device, "vkWaitSemaphoresKHR"));
 }
 
 void VKComputeParticles::SetupPipeline()
 {
     //CreateVertexBuffer();
-    CreateStagingBuffer();
     CreateStorageBuffers();
     CreateHostVisibleBuffers();
     CreateHostVisibleDynamicBuffers();
@@ -74,17 +113,42 @@ void VKComputeParticles::SetupPipeline()
     CreateDescriptorSetLayout();
     AllocateDescriptorSets();
     CreatePipelineLayout();
+    CreatePipelineCache();
     CreatePipelineObjects();
     PrepareCompute();
+    ReportPipelineCreationTime();
 
     m_initialized = true;
 }
 
 void VKComputeParticles::EnableInstanceExtensions(std::vector<const char*>& instanceExtensions)
-{ }
+{
+    // Needed to query the timeline semaphore feature
+    instanceExtensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+}
 
 void VKComputeParticles::EnableDeviceExtensions(std::vector<const char*>& deviceExtensions)
-{ }
+{
+    if (!m_timelineSemaphores)
+        return;
+
+    // Enable timeline semaphores if supported, otherwise fall back to fences and binary semaphores
+    uint32_t extCount = 0;
+    vkEnumerateDeviceExtensionProperties(m_vulkanParams.PhysicalDevice, nullptr, &extCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extCount);
+    vkEnumerateDeviceExtensionProperties(m_vulkanParams.PhysicalDevice, nullptr, &extCount, extensions.data());
+
+    m_timelineSemaphores = false;
+    for (const VkExtensionProperties& ext : extensions)
+    {
+        if (strcmp(ext.extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0)
+        {
+            deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+            m_timelineSemaphores = true;
+            break;
+        }
+    }
+}
 
 void VKComputeParticles::EnableFeatures(VkPhysicalDeviceFeatures& features)
 { 
@@ -96,6 +160,21 @@ void VKComputeParticles::EnableFeatures(VkPhysicalDeviceFeatures& features)
     {
         assert(!"Selected device does not support geometry shaders!");
     }
+
+    if (m_timelineSemaphores)
+    {
+        featuresTimeline.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &featuresTimeline;
+
+        vkGetPhysicalDeviceFeatures2(m_vulkanParams.PhysicalDevice, &features2);
+
+        if (featuresTimeline.timelineSemaphore)
+            m_vulkanParams.ExtFeatures = &featuresTimeline;
+        else
+            m_timelineSemaphores = false;
+    }
 }
 
 // Update frame-based values.
@@ -121,9 +200,23 @@ void VKComputeParticles::OnRender()
     // Compute work
     //
 
-    // Ensure no more than MAX_FRAME_LAG command buffers are queued to the compute queue.
-    VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleComputeParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
-    VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleComputeParams.FrameRes.Fences[m_frameIndex]));
+    if (m_timelineSemaphores)
+    {
+        // Wait for the frame that last used the resources of the current frame slot (only if the ring is full).
+        // The simulation of this frame can then run on the compute queue while the previous frame is still rendering.
+        m_frameNumber++;
+        WaitForFrameSlot();
+    }
+    else
+    {
+        // Ensure no more than m_framesInFlight command buffers are queued to the compute queue.
+        VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleComputeParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
+        VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleComputeParams.FrameRes.Fences[m_frameIndex]));
+    }
+
+    // Profile the scopes of this frame with the query pool of the current frame slot
+    m_profiler.BeginFrame(m_frameIndex);
+    m_computeProfiler.BeginFrame(m_frameIndex);
 
     PopulateComputeCommandBuffer();
     SubmitComputeCommandBuffer();
@@ -132,17 +225,19 @@ void VKComputeParticles::OnRender()
     // Graphics work
     //
 
-    // Ensure no more than MAX_FRAME_LAG frames are queued to the graphics queue.
-    VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
-    VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    // Ensure no more than m_framesInFlight frames are queued to the graphics queue.
+    // (with timeline semaphores this is guaranteed by WaitForFrameSlot)
+    if (!m_timelineSemaphores)
+    {
+        VK_CHECK_RESULT(vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex], VK_TRUE, UINT64_MAX));
+        VK_CHECK_RESULT(vkResetFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    }
 
     // Get the index of the next available image in the swap chain
     uint32_t imageIndex;
-    VkResult acquire = vkAcquireNextImageKHR(m_vulkanParams.Device, 
-                                             m_vulkanParams.SwapChain.Handle, 
-                                             UINT64_MAX, 
-                                             m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
-                                             nullptr, &imageIndex);
+    VkResult acquire = AcquireNextImage(UINT64_MAX, 
+                                        m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex], 
+                                        nullptr, &imageIndex);
 
     if (!((acquire == VK_SUCCESS) || (acquire == VK_SUBOPTIMAL_KHR)))
     {
@@ -158,7 +253,7 @@ void VKComputeParticles::OnRender()
     PresentImage(imageIndex);
 
     // Update command buffer index
-    m_frameIndex = (m_frameIndex + 1) % MAX_FRAME_LAG;
+    m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
 }
 
 void VKComputeParticles::OnDestroy()
@@ -168,41 +263,61 @@ void VKComputeParticles::OnDestroy()
     // Ensure all operations on the device have been finished before destroying resources
     vkDeviceWaitIdle(m_vulkanParams.Device);
 
+    // Report device memory usage and fragmentation before releasing the resources
+    if (VKApplication::settings.validation)
+        m_memAllocator.PrintStats();
+
+    // Report the GPU time of the profiled scopes over the last frames
+    m_computeProfiler.PrintReport();
+    m_profiler.PrintReport();
+
     // Destroy vertex and index buffer objects and deallocate backing memory
 /*  vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffers.VBbuffer, nullptr);
     vkDestroyBuffer(m_vulkanParams.Device, m_vertexindexBuffers.IBbuffer, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffers.VBmemory, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vertexindexBuffers.IBmemory, nullptr); */
+    m_memAllocator.Free(m_vertexindexBuffers.VBmemory);
+    m_memAllocator.Free(m_vertexindexBuffers.IBmemory); */
 
     // Destroy\Unmap per-frame resources
-    for (uint32_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (uint32_t i = 0; i < m_framesInFlight; i++)
     {
-        // Unmap host-visible device memory
-        vkUnmapMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory);
-
         // Destroy buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleBuffers[i].Allocation);
 
         // Destroy dynamic buffer object and deallocate backing memory
         vkDestroyBuffer(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Memory, nullptr);
+        m_memAllocator.Free(m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Allocation);
 
         // Wait for fences before destroying them
         vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
         vkDestroyFence(m_vulkanParams.Device, m_sampleParams.FrameRes.Fences[i], NULL);
-        vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleComputeParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
-        vkDestroyFence(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Fences[i], NULL);
 
         // Destroy semaphores
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.ImageAvailableSemaphores[i], nullptr);
         vkDestroySemaphore(m_vulkanParams.Device, m_sampleParams.FrameRes.RenderingCompleteSemaphores[i], nullptr);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE][i], nullptr);
-        vkDestroySemaphore(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE][i], nullptr);
+
+        // Destroy compute fences and semaphores (only created without timeline semaphores)
+        if (!m_timelineSemaphores)
+        {
+            vkWaitForFences(m_vulkanParams.Device, 1, &m_sampleComputeParams.FrameRes.Fences[i], VK_TRUE, UINT64_MAX);
+            vkDestroyFence(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Fences[i], NULL);
+            vkDestroySemaphore(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete][i], nullptr);
+            vkDestroySemaphore(m_vulkanParams.Device, m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete][i], nullptr);
+        }
 
         // Destroy storage buffers
         vkDestroyBuffer(m_vulkanParams.Device, m_storageBuffers[i].StorageBuffer.Handle, nullptr);
-        vkFreeMemory(m_vulkanParams.Device, m_storageBuffers[i].StorageBuffer.Memory, nullptr);
+        m_memAllocator.Free(m_storageBuffers[i].StorageBuffer.Allocation);
+    }
+
+    // Destroy timeline semaphores and the simulation state buffer
+    if (m_timelineSemaphores)
+    {
+        vkDestroySemaphore(m_vulkanParams.Device, m_computeTimeline, nullptr);
+        vkDestroySemaphore(m_vulkanParams.Device, m_graphicsTimeline, nullptr);
+
+        vkDestroyBuffer(m_vulkanParams.Device, m_stateBuffer.StorageBuffer.Handle, nullptr);
+        m_memAllocator.Free(m_stateBuffer.StorageBuffer.Allocation);
     }
 
     // Destroy descriptor set layout for compute pipeline
@@ -210,8 +325,8 @@ void VKComputeParticles::OnDestroy()
 
     // Destroy compute pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleComputeParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleComputeParams.Pipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleComputeParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy descriptor pool
     vkDestroyDescriptorPool(m_vulkanParams.Device, m_sampleParams.DescriptorPool, nullptr);
@@ -221,8 +336,8 @@ void VKComputeParticles::OnDestroy()
 
     // Destroy pipeline and pipeline layout objects
     vkDestroyPipelineLayout(m_vulkanParams.Device, m_sampleParams.PipelineLayout, nullptr);
-    for (auto const& pl : m_sampleParams.Pipelines)
-        vkDestroyPipeline(m_vulkanParams.Device, pl.second, nullptr);
+    for (VkPipeline pl : m_sampleParams.Pipelines)
+        vkDestroyPipeline(m_vulkanParams.Device, pl, nullptr);
 
     // Destroy frame buffers
     for (uint32_t i = 0; i < m_sampleParams.Framebuffers.size(); i++) {
@@ -233,13 +348,21 @@ void VKComputeParticles::OnDestroy()
     for (uint32_t i = 0; i < m_vulkanParams.SwapChain.Images.size(); i++)
     {
         vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].View, nullptr);
+
+        // In headless mode the images are owned by the sample rather than by the swapchain
+        if (m_vulkanParams.SwapChain.Images[i].Allocation.Memory != VK_NULL_HANDLE)
+        {
+            vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.SwapChain.Images[i].Handle, nullptr);
+            m_memAllocator.Free(m_vulkanParams.SwapChain.Images[i].Allocation);
+        }
     }
-    vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
+    if (m_vulkanParams.SwapChain.Handle != VK_NULL_HANDLE)
+        vkDestroySwapchainKHR(m_vulkanParams.Device, m_vulkanParams.SwapChain.Handle, nullptr);
 
     // Destroy depth-stencil image
     vkDestroyImageView(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.View, nullptr);
     vkDestroyImage(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_vulkanParams.DepthStencilImage.Memory, nullptr);
+    m_memAllocator.Free(m_vulkanParams.DepthStencilImage.Allocation);
 
     // Free allocated command buffers
     vkFreeCommandBuffers(m_vulkanParams.Device, 
@@ -249,14 +372,30 @@ void VKComputeParticles::OnDestroy()
 
     vkDestroyRenderPass(m_vulkanParams.Device, m_sampleParams.RenderPass, NULL);
 
-    // Destroy command pool
+    // Destroy command pools
     vkDestroyCommandPool(m_vulkanParams.Device, m_sampleParams.CommandPool, NULL);
+    if (m_sampleComputeParams.CommandPool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(m_vulkanParams.Device, m_sampleComputeParams.CommandPool, NULL);
+
+    // Destroy the query pools used for GPU profiling
+    m_computeProfiler.Destroy();
+    m_profiler.Destroy();
+
+    // Save the pipeline cache to disk and destroy it
+    DestroyPipelineCache();
+
+    // Destroy the staging ring buffer
+    m_stagingRing.Destroy();
+
+    // Release all the device memory blocks
+    m_memAllocator.Destroy();
 
     // Destroy device
     vkDestroyDevice(m_vulkanParams.Device, NULL);
 
     // Destroy surface
-    vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
+    if (m_vulkanParams.PresentationSurface != VK_NULL_HANDLE)
+        vkDestroySurfaceKHR(m_vulkanParams.Instance, m_vulkanParams.PresentationSurface, NULL);
 
     // Destroy debug messanger
     if ((VKApplication::settings.validation)) 
@@ -265,8 +404,12 @@ void VKComputeParticles::OnDestroy()
     }
 
 #if defined(VK_USE_PLATFORM_XLIB_KHR)
-    XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
-    XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    // No window (nor connection to the X server) is created in headless mode
+    if (!VKApplication::settings.headless)
+    {
+        XDestroyWindow(VKApplication::winParams.DisplayPtr, VKApplication::winParams.Handle);
+        XCloseDisplay(VKApplication::winParams.DisplayPtr);
+    }
 #endif
 
     // Destroy Vulkan instance
@@ -300,15 +443,14 @@ void VKComputeParticles::CreateHostVisibleBuffers()
     bufferInfo.size = sizeof(uBufVS);
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (uniform buffer) in the descriptor set later.
         m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor.buffer = m_sampleParams.FrameRes.HostVisibleBuffers[i].Handle;
@@ -344,15 +486,14 @@ void VKComputeParticles::CreateHostVisibleDynamicBuffers()
     bufferInfo.size = dynBufferSize;
     bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 
-    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(MAX_FRAME_LAG);
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    m_sampleParams.FrameRes.HostVisibleDynamicBuffers.resize(m_framesInFlight);
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create a buffer in coherent, host-visible device memory that is large enough to hold the array of world matrices.
-        CreateBuffer(m_vulkanParams.Device, 
+        CreateBuffer(m_memAllocator, 
                         bufferInfo, 
                         m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i],
-                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                        m_deviceMemoryProperties);
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
         // Store information needed to write\update the corresponding descriptor (dynamic uniform buffer) in the descriptor set later.
         // In this case:
@@ -367,70 +508,31 @@ void VKComputeParticles::CreateHostVisibleDynamicBuffers()
     }    
 }
 
-void VKComputeParticles::CreateStagingBuffer()
+void VKComputeParticles::CreateStorageBuffers()
 {
-    // Create a buffer object
-    VkBufferCreateInfo bufferInfo = {};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = StorageBuf::BufferLenght * StorageBuf::BufferElementSize;
-    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferInfo, nullptr, &m_stagingBuffer.Handle));
-
-    // Used to request an allocation of a specific size from a certain memory type.
-    VkMemoryAllocateInfo memAlloc = {};
-    memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VkMemoryRequirements memReqs;
-
-    // Request a memory allocation from coherent, host-visible device memory that is large 
-    // enough to hold the staging buffer.
-    // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT makes sure writes performed by the host (application)
-    // will be directly visible to the device without requiring the explicit flushing of cached memory.
-    vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_stagingBuffer.Handle, &memReqs);
-    memAlloc.allocationSize = memReqs.size;
-    memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_deviceMemoryProperties);
-    VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_stagingBuffer.Memory));
-
-    // Bind the buffer object to the backing host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, 
-                                        m_stagingBuffer.Handle, 
-                                        m_stagingBuffer.Memory, 0));
-
-    // Map the host-visible device memory just allocated.
-    VK_CHECK_RESULT(vkMapMemory(m_vulkanParams.Device, 
-                                m_stagingBuffer.Memory, 
-                                0, memAlloc.allocationSize, 
-                                0, &m_stagingBuffer.MappedMemory));
-
-    // Define a grid of 9 * 9 particles lying in the XY plane of the local space inside the square [-20, 20] x [-20, 20].
-    for (int i = 0; i < 81; ++i)
+    // Particles are stored in storage buffers, so their number is limited by the max size of the range of a 
+    // storage buffer descriptor (maxStorageBufferRange is at least 128 MiB, which is about 5.5 millions particles).
+    uint32_t maxParticleCount = m_deviceProperties.limits.maxStorageBufferRange / StorageBuf::BufferElementSize;
+    if (m_particleCount > maxParticleCount)
     {
-        Vertex v;
-        v.position = glm::vec4{ i % 9 * 5.0f - 20.0f, i / 9 * 5.0f - 20.0f, 0.0f, 1.0 };
-        v.size = { 0.05f, 5.0f }; // { 0.3f, 5.0f } for the interstellar travel effect
-        v.speed = {static_cast<float>(100 + rand() % 200) };
-        m_particles.push_back(v);
+        printf("%u particles exceed maxStorageBufferRange: the number of particles is clamped to %u.\n", m_particleCount, maxParticleCount);
+        m_particleCount = maxParticleCount;
     }
 
-    m_meshObjects[MESH_PARTICLES].vertexCount = static_cast<uint32_t>(m_particles.size());
+    m_meshObjects[m_meshParticles].vertexCount = m_particleCount;
 
-    // Copy particle data to the staging buffer
-    memcpy(m_stagingBuffer.MappedMemory, m_particles.data(), m_particles.size() * sizeof(Vertex));
+    m_storageBuffers.resize(m_framesInFlight);
 
-    // Unmap staging buffer
-    vkUnmapMemory(m_vulkanParams.Device, m_stagingBuffer.Memory);
-}
+    VkDeviceSize bufferSize = static_cast<VkDeviceSize>(m_particleCount) * StorageBuf::BufferElementSize;
 
-void VKComputeParticles::CreateStorageBuffers()
-{
-    m_storageBuffers.resize(MAX_FRAME_LAG);
-
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
-        // Create a buffer to be used as storage buffer (in CS) and vertex buffer (in VS)
+        // Create a buffer to be used as storage buffer (in CS) and vertex buffer (in VS).
+        // The first one is also the source of the copies initializing the others (see below).
         VkBufferCreateInfo bufferCreateInfo = {};
         bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        bufferCreateInfo.size = StorageBuf::BufferLenght * StorageBuf::BufferElementSize;
-        bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferCreateInfo.size = bufferSize;
+        bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
         bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
         VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferCreateInfo, nullptr, &m_storageBuffers[i].StorageBuffer.Handle));
@@ -438,51 +540,103 @@ void VKComputeParticles::CreateStorageBuffers()
         // Store information needed to write\update the corresponding descriptor (storage buffer) in the descriptor set later.
         m_storageBuffers[i].StorageBuffer.Descriptor.buffer = m_storageBuffers[i].StorageBuffer.Handle;
         m_storageBuffers[i].StorageBuffer.Descriptor.offset = 0;
-        m_storageBuffers[i].StorageBuffer.Descriptor.range = StorageBuf::BufferLenght * StorageBuf::BufferElementSize;
+        m_storageBuffers[i].StorageBuffer.Descriptor.range = bufferSize;
 
         // Save buffer size for later use
-        m_storageBuffers[i].StorageBuffer.Size = StorageBuf::BufferLenght * StorageBuf::BufferElementSize;
-
-        // Used to request an allocation of a specific size from a certain memory type.
-        VkMemoryAllocateInfo memAlloc = {};
-        memAlloc.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        VkMemoryRequirements memReqs;
+        m_storageBuffers[i].StorageBuffer.Size = bufferSize;
 
         // Request a memory allocation from local device memory that is large 
-        // enough to hold the storage buffer.
-        vkGetBufferMemoryRequirements(m_vulkanParams.Device, m_storageBuffers[i].StorageBuffer.Handle, &memReqs);
-        memAlloc.allocationSize = memReqs.size;
-        memAlloc.memoryTypeIndex = GetMemoryTypeIndex(memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_deviceMemoryProperties);
-        VK_CHECK_RESULT(vkAllocateMemory(m_vulkanParams.Device, &memAlloc, nullptr, &m_storageBuffers[i].StorageBuffer.Memory));
-
-        // Bind the buffer object to the backing local device memory just allocated.
-        VK_CHECK_RESULT(vkBindBufferMemory(m_vulkanParams.Device, 
-                                            m_storageBuffers[i].StorageBuffer.Handle, 
-                                            m_storageBuffers[i].StorageBuffer.Memory, 0));
+        // enough to hold the storage buffer, and bind it to the buffer object.
+        m_memAllocator.AllocateBufferMemory(m_storageBuffers[i].StorageBuffer.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_storageBuffers[i].StorageBuffer.Allocation);
+    }
+
+    // With timeline semaphores the compute shader updates the simulation state in a buffer only accessed by the 
+    // compute queue, and copies it to the storage buffer of the current frame. This way the simulation of a frame
+    // doesn't read the storage buffer of the previous frame, which can still be in use by the graphics queue.
+    if (m_timelineSemaphores)
+    {
+        VkBufferCreateInfo bufferCreateInfo = {};
+        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferCreateInfo.size = bufferSize;
+        bufferCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VK_CHECK_RESULT(vkCreateBuffer(m_vulkanParams.Device, &bufferCreateInfo, nullptr, &m_stateBuffer.StorageBuffer.Handle));
+
+        m_stateBuffer.StorageBuffer.Descriptor.buffer = m_stateBuffer.StorageBuffer.Handle;
+        m_stateBuffer.StorageBuffer.Descriptor.offset = 0;
+        m_stateBuffer.StorageBuffer.Descriptor.range = bufferSize;
+        m_stateBuffer.StorageBuffer.Size = bufferSize;
+
+        m_memAllocator.AllocateBufferMemory(m_stateBuffer.StorageBuffer.Handle, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_stateBuffer.StorageBuffer.Allocation);
     }
 
     //
-    // Copy staging buffer to storage buffers in device local memory
+    // Upload the initial particles to device local memory through the staging ring buffer
     //
 
+    // With timeline semaphores only the simulation state needs initial data: the storage buffers are entirely 
+    // written by the compute shader. Otherwise, the particles are uploaded to the first storage buffer, and 
+    // copied to the other ones in device local memory.
+    VkBuffer uploadBuffer = m_timelineSemaphores ? m_stateBuffer.StorageBuffer.Handle : m_storageBuffers[0].StorageBuffer.Handle;
+
+    // Define a grid of particles lying in the XY plane of the local space inside the square [-20, 20] x [-20, 20]
+    // (9 * 9 particles, 5 units apart, by default).
+    // Particles are written directly to the staging ring, in chunks that fit in it, to avoid an additional copy 
+    // (in system memory) of what can be hundreds of MiB of data. Each chunk is submitted as soon as it's written,
+    // so that its copy to device local memory overlaps the generation of the following one.
+    uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(m_particleCount))));
+    float gridSpacing = (gridSize > 1) ? 40.0f / (gridSize - 1) : 0.0f;
+    uint32_t chunkParticleCount = static_cast<uint32_t>(m_stagingRing.GetMaxUploadSize() / StorageBuf::BufferElementSize);
+
+    for (uint32_t first = 0; first < m_particleCount; first += chunkParticleCount)
+    {
+        uint32_t count = std::min(chunkParticleCount, m_particleCount - first);
+        Vertex* particles = static_cast<Vertex*>(m_stagingRing.MapBufferUpload(uploadBuffer, 
+                                                                                static_cast<VkDeviceSize>(first) * StorageBuf::BufferElementSize, 
+                                                                                static_cast<VkDeviceSize>(count) * StorageBuf::BufferElementSize));
+
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            Vertex v;
+            v.position = glm::vec3{ i % gridSize * gridSpacing - 20.0f, i / gridSize * gridSpacing - 20.0f, 0.0f };
+            v.size = { 0.05f, 5.0f }; // { 0.3f, 5.0f } for the interstellar travel effect
+            v.speed = {static_cast<float>(100 + rand() % 200) };
+            particles[i - first] = v;
+        }
+
+        m_stagingRing.Submit();
+    }
+
+    // The ring makes the particles available to the commands recorded below, as they are submitted to the graphics queue.
+
     VkCommandBufferBeginInfo cmdBufferInfo = {};
     cmdBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     cmdBufferInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[0], &cmdBufferInfo);
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    if (m_timelineSemaphores)
+    {
+        // Release the ownership of the simulation state to the compute queue family, if it differs from the graphics one.
+        // The matching acquire operation is recorded in the first compute command buffer.
+        if (m_vulkanParams.ComputeQueue.FamilyIndex != m_vulkanParams.GraphicsQueue.FamilyIndex)
+            SetBufferMemoryBarrier(m_sampleParams.FrameRes.CommandBuffers[0],
+                                   m_stateBuffer.StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
+                                   VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                   0, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                   m_vulkanParams.GraphicsQueue.FamilyIndex, m_vulkanParams.ComputeQueue.FamilyIndex);
+    }
+    else
     {
         VkBufferCopy copyRegion{};
-        copyRegion.size = StorageBuf::BufferLenght * StorageBuf::BufferElementSize;;
-        vkCmdCopyBuffer(m_sampleParams.FrameRes.CommandBuffers[0], m_stagingBuffer.Handle, m_storageBuffers[i].StorageBuffer.Handle, 1, &copyRegion);
+        copyRegion.size = bufferSize;
+
+        for (size_t i = 1; i < m_framesInFlight; i++)
+            vkCmdCopyBuffer(m_sampleParams.FrameRes.CommandBuffers[0], m_storageBuffers[0].StorageBuffer.Handle, m_storageBuffers[i].StorageBuffer.Handle, 1, &copyRegion);
     }
 
     // Flush the command buffer
     FlushInitCommandBuffer(m_vulkanParams.Device, m_vulkanParams.GraphicsQueue.Handle, m_sampleParams.FrameRes.CommandBuffers[0], m_sampleParams.FrameRes.Fences[0]);
-
-    // Free staging buffer
-    vkDestroyBuffer(m_vulkanParams.Device, m_stagingBuffer.Handle, nullptr);
-    vkFreeMemory(m_vulkanParams.Device, m_stagingBuffer.Memory, nullptr);
 }
 
 void VKComputeParticles::UpdateHostVisibleBufferData()
@@ -492,20 +646,20 @@ void VKComputeParticles::UpdateHostVisibleBufferData()
 
     // Update uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
         memcpy(m_sampleParams.FrameRes.HostVisibleBuffers[i].MappedMemory, &uBufVS, sizeof(uBufVS));
 }
 
 void VKComputeParticles::UpdateHostVisibleDynamicBufferData()
 {
     // Set an identity matrix as world matrix
-    m_meshObjects[MESH_PARTICLES].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
-                                        (m_meshObjects[MESH_PARTICLES].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
+    m_meshObjects[m_meshParticles].meshInfo = (MeshInfo*)((uint64_t)dynUBufVS.meshInfo + 
+                                        (m_meshObjects[m_meshParticles].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment)));
     
-    m_meshObjects[MESH_PARTICLES].meshInfo->worldMatrix = glm::identity<glm::mat4>();
+    m_meshObjects[m_meshParticles].meshInfo->worldMatrix = glm::identity<glm::mat4>();
 
     // Set a half-transparent white color
-    m_meshObjects[MESH_PARTICLES].meshInfo->solidColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.5f);
+    m_meshObjects[m_meshParticles].meshInfo->solidColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.5f);
 
     // Update dynamic uniform buffer data
     // Note: Since we requested a host coherent memory type for the uniform buffer, the write is instantly visible to the GPU
@@ -526,11 +680,11 @@ void VKComputeParticles::CreateDescriptorPool()
     // This sample uses four descriptor types (uniform buffer, dynamic uniform buffer and two storage buffers)
     VkDescriptorPoolSize typeCounts[3];
     typeCounts[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    typeCounts[0].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[0].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-    typeCounts[1].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    typeCounts[1].descriptorCount = static_cast<uint32_t>(m_framesInFlight);
     typeCounts[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-    typeCounts[2].descriptorCount = static_cast<uint32_t>(MAX_FRAME_LAG) * 2;  // Previous and current storage buffers
+    typeCounts[2].descriptorCount = static_cast<uint32_t>(m_framesInFlight) * 2;  // Previous and current storage buffers
 
     // Create a global descriptor pool
     // All descriptors set used in this sample will be allocated from this pool
@@ -540,7 +694,7 @@ void VKComputeParticles::CreateDescriptorPool()
     descriptorPoolInfo.poolSizeCount = 3;
     descriptorPoolInfo.pPoolSizes = typeCounts;
     // Set the max. number of descriptor sets that can be requested from this pool (requesting beyond this limit will result in an error)
-    descriptorPoolInfo.maxSets = static_cast<uint32_t>(MAX_FRAME_LAG);
+    descriptorPoolInfo.maxSets = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkCreateDescriptorPool(m_vulkanParams.Device, &descriptorPoolInfo, nullptr, &m_sampleParams.DescriptorPool));
 }
@@ -593,18 +747,18 @@ void VKComputeParticles::CreateDescriptorSetLayout()
 
 void VKComputeParticles::AllocateDescriptorSets()
 {
-    // Allocate MAX_FRAME_LAG descriptor sets from the global descriptor pool.
+    // Allocate m_framesInFlight descriptor sets from the global descriptor pool.
     // Use the descriptor set layout to calculate the amount on memory required to store the descriptor sets.
     VkDescriptorSetAllocateInfo allocInfo = {};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_sampleParams.DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAME_LAG);
-    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(MAX_FRAME_LAG, m_sampleParams.DescriptorSetLayout);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(m_framesInFlight);
+    std::vector<VkDescriptorSetLayout> DescriptorSetLayouts(m_framesInFlight, m_sampleParams.DescriptorSetLayout);
     allocInfo.pSetLayouts = DescriptorSetLayouts.data();
 
-    m_sampleParams.FrameRes.DescriptorSets[DESC_SET_GRAPH_COMP].resize(MAX_FRAME_LAG);
+    m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphComp].resize(m_framesInFlight);
 
-    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[DESC_SET_GRAPH_COMP].data()));
+    VK_CHECK_RESULT(vkAllocateDescriptorSets(m_vulkanParams.Device, &allocInfo, m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphComp].data()));
 
     //
     // Write the descriptors updating the corresponding descriptor sets.
@@ -613,13 +767,13 @@ void VKComputeParticles::AllocateDescriptorSets()
     //
     VkWriteDescriptorSet writeDescriptorSet[4] = {};
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Write the descriptor of the uniform buffer.
         // We need to pass the descriptor set where it is store and 
         // the binding point associated with the descriptor in the descriptor set.
         writeDescriptorSet[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_GRAPH_COMP][i];
+        writeDescriptorSet[0].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphComp][i];
         writeDescriptorSet[0].descriptorCount = 1;
         writeDescriptorSet[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         writeDescriptorSet[0].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleBuffers[i].Descriptor;
@@ -627,23 +781,27 @@ void VKComputeParticles::AllocateDescriptorSets()
 
         // Write the descriptor of the dynamic uniform buffer.
         writeDescriptorSet[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_GRAPH_COMP][i];
+        writeDescriptorSet[1].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphComp][i];
         writeDescriptorSet[1].descriptorCount = 1;
         writeDescriptorSet[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         writeDescriptorSet[1].pBufferInfo = &m_sampleParams.FrameRes.HostVisibleDynamicBuffers[i].Descriptor;
         writeDescriptorSet[1].dstBinding = 1;
 
         // Write the descriptor of the previous storage buffer.
+        // With timeline semaphores the compute shader reads (and updates) the simulation state instead.
         writeDescriptorSet[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[2].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_GRAPH_COMP][i];
+        writeDescriptorSet[2].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphComp][i];
         writeDescriptorSet[2].descriptorCount = 1;
         writeDescriptorSet[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        writeDescriptorSet[2].pBufferInfo = &m_storageBuffers[(i - 1) % MAX_FRAME_LAG].StorageBuffer.Descriptor; // if (i == 0) then -1 % 2 = 1, since -1 = 2*(-1) + 1 <-- remainder
+        if (m_timelineSemaphores)
+            writeDescriptorSet[2].pBufferInfo = &m_stateBuffer.StorageBuffer.Descriptor;
+        else
+            writeDescriptorSet[2].pBufferInfo = &m_storageBuffers[(i + m_framesInFlight - 1) % m_framesInFlight].StorageBuffer.Descriptor; // The previous frame slot (the last one if i == 0)
         writeDescriptorSet[2].dstBinding = 2;
 
         // Write the descriptor of the current storage buffer.
         writeDescriptorSet[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        writeDescriptorSet[3].dstSet = m_sampleParams.FrameRes.DescriptorSets[DESC_SET_GRAPH_COMP][i];
+        writeDescriptorSet[3].dstSet = m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphComp][i];
         writeDescriptorSet[3].descriptorCount = 1;
         writeDescriptorSet[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         writeDescriptorSet[3].pBufferInfo = &m_storageBuffers[i].StorageBuffer.Descriptor;
@@ -870,9 +1028,9 @@ void VKComputeParticles::CreatePipelineObjects()
     
     // Create a graphics pipeline for drawing using a solid color
     VK_CHECK_RESULT(vkCreateGraphicsPipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleParams.Pipelines[PIPELINE_RENDER]));
+                                              &m_sampleParams.Pipelines[m_pipelineRender]));
 
     //
     // Destroy shader modules
@@ -888,11 +1046,19 @@ void VKComputeParticles::CreatePipelineObjects()
 void VKComputeParticles::PrepareCompute()
 {
     //
-    // Get a compute queue from the same queue family used for recording graphics commands
+    // Get a compute queue
     //
 
-    // We already checked that the queue family used for graphics also supports compute work
-    m_vulkanParams.ComputeQueue.FamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+    // With timeline semaphores use the dedicated compute queue family selected at device creation (if any).
+    // Otherwise, use the same queue family used for recording graphics commands, since the storage buffers 
+    // are accessed by both queues in every frame.
+    // We already checked that the queue family used for graphics also supports compute work.
+    if (!m_timelineSemaphores)
+        m_vulkanParams.ComputeQueue.FamilyIndex = m_vulkanParams.GraphicsQueue.FamilyIndex;
+
+    printf("%s scheduling, compute queue family %u, graphics queue family %u\n", 
+           m_timelineSemaphores ? "Timeline semaphore" : "Legacy (fence and binary semaphore)",
+           m_vulkanParams.ComputeQueue.FamilyIndex, m_vulkanParams.GraphicsQueue.FamilyIndex);
 
     // Get a compute queue from the device
     vkGetDeviceQueue(m_vulkanParams.Device, m_vulkanParams.ComputeQueue.FamilyIndex, 0, &m_vulkanParams.ComputeQueue.Handle);
@@ -903,6 +1069,57 @@ void VKComputeParticles::PrepareCompute()
 
     VkShaderModule luminanceCS = LoadSPIRVShaderModule(m_vulkanParams.Device, GetAssetsPath() + "/data/shaders/particle.comp.spv");
 
+    //
+    // Workgroup size and number of workgroups
+    //
+
+    // Use the preferred workgroup size, unless it exceeds the device limits
+    const VkPhysicalDeviceLimits& limits = m_deviceProperties.limits;
+    m_computeSpecConstants.workGroupSize = std::min({ static_cast<uint32_t>(PREFERRED_WORKGROUP_SIZE), 
+                                                      limits.maxComputeWorkGroupSize[0], 
+                                                      limits.maxComputeWorkGroupInvocations });
+    m_computeSpecConstants.particleCount = m_particleCount;
+    m_computeSpecConstants.writeState = m_timelineSemaphores ? VK_TRUE : VK_FALSE;
+
+    // Dispatch enough workgroups to update all the particles. If their number exceeds the max number 
+    // of workgroups that can be dispatched in the X dimension, lay them out on a 2D grid.
+    uint32_t groupCount = (m_particleCount + m_computeSpecConstants.workGroupSize - 1) / m_computeSpecConstants.workGroupSize;
+    m_dispatchGroupCount[0] = std::min(groupCount, limits.maxComputeWorkGroupCount[0]);
+    m_dispatchGroupCount[1] = (groupCount + m_dispatchGroupCount[0] - 1) / m_dispatchGroupCount[0];
+    assert(m_dispatchGroupCount[1] <= limits.maxComputeWorkGroupCount[1]);
+
+    printf("Simulating %u particles with %u x %u workgroups of %u invocations\n", 
+           m_particleCount, m_dispatchGroupCount[0], m_dispatchGroupCount[1], m_computeSpecConstants.workGroupSize);
+
+    //
+    // Set specialization constants
+    //
+
+    // Each VkSpecializationMapEntry maps a constant ID to an offset into the buffer specified by VkSpecializationInfo::pData
+    std::array<VkSpecializationMapEntry, 3> specializationMapEntries;
+
+    // This entry maps constant ID 0 (local_size_x_id) to ComputeSpecConsts::workGroupSize
+    specializationMapEntries[0].constantID = 0;
+    specializationMapEntries[0].size = sizeof(ComputeSpecConsts::workGroupSize);
+    specializationMapEntries[0].offset = offsetof(ComputeSpecConsts, workGroupSize);
+
+    // This entry maps constant ID 1 to ComputeSpecConsts::particleCount
+    specializationMapEntries[1].constantID = 1;
+    specializationMapEntries[1].size = sizeof(ComputeSpecConsts::particleCount);
+    specializationMapEntries[1].offset = offsetof(ComputeSpecConsts, particleCount);
+
+    // This entry maps constant ID 2 to ComputeSpecConsts::writeState
+    specializationMapEntries[2].constantID = 2;
+    specializationMapEntries[2].size = sizeof(ComputeSpecConsts::writeState);
+    specializationMapEntries[2].offset = offsetof(ComputeSpecConsts, writeState);
+
+    // Prepare specialization info for the shader stage
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.dataSize = sizeof(m_computeSpecConstants);
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationMapEntries.size());
+    specializationInfo.pMapEntries = specializationMapEntries.data();
+    specializationInfo.pData = &m_computeSpecConstants;
+
     VkPipelineShaderStageCreateInfo shaderStage{};
     
     // Compute shader
@@ -913,6 +1130,8 @@ void VKComputeParticles::PrepareCompute()
     shaderStage.module = luminanceCS;
     // Main entry point for the shader
     shaderStage.pName = "main";
+    // Specialization info (workgroup size, number of particles and simulation state update)
+    shaderStage.pSpecializationInfo = &specializationInfo;
     assert(shaderStage.module != VK_NULL_HANDLE);
 
     //
@@ -928,9 +1147,9 @@ void VKComputeParticles::PrepareCompute()
     
     // Create a compute pipeline for computing the luminance of the input texture
     VK_CHECK_RESULT(vkCreateComputePipelines(m_vulkanParams.Device, 
-                                              VK_NULL_HANDLE, 1, 
+                                              m_pipelineCache, 1, 
                                               &pipelineCreateInfo, nullptr, 
-                                              &m_sampleComputeParams.Pipelines[PIPELINE_COMPUTE]));
+                                              &m_sampleComputeParams.Pipelines[m_pipelineCompute]));
 
     // Destroy shader modules
     vkDestroyShaderModule(m_vulkanParams.Device, luminanceCS, nullptr);
@@ -939,13 +1158,26 @@ void VKComputeParticles::PrepareCompute()
     // Allocate command buffers to store compute commands
     //
 
-    m_sampleComputeParams.FrameRes.CommandBuffers.resize(MAX_FRAME_LAG);
+    m_sampleComputeParams.FrameRes.CommandBuffers.resize(m_framesInFlight);
+
+    // Command buffers can only be submitted to queues of the family of the command pool they are allocated from.
+    // So, if compute work is submitted to a dedicated queue family, we need a separate command pool.
+    VkCommandPool computeCommandPool = m_sampleParams.CommandPool;
+    if (m_vulkanParams.ComputeQueue.FamilyIndex != m_vulkanParams.GraphicsQueue.FamilyIndex)
+    {
+        VkCommandPoolCreateInfo cmdPoolInfo = {};
+        cmdPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        cmdPoolInfo.queueFamilyIndex = m_vulkanParams.ComputeQueue.FamilyIndex;
+        cmdPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        VK_CHECK_RESULT(vkCreateCommandPool(m_vulkanParams.Device, &cmdPoolInfo, nullptr, &m_sampleComputeParams.CommandPool));
+        computeCommandPool = m_sampleComputeParams.CommandPool;
+    }
 
     VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
     commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    commandBufferAllocateInfo.commandPool = m_sampleParams.CommandPool;
+    commandBufferAllocateInfo.commandPool = computeCommandPool;
     commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(MAX_FRAME_LAG);
+    commandBufferAllocateInfo.commandBufferCount = static_cast<uint32_t>(m_framesInFlight);
 
     VK_CHECK_RESULT(vkAllocateCommandBuffers(m_vulkanParams.Device, &commandBufferAllocateInfo, m_sampleComputeParams.FrameRes.CommandBuffers.data()));
 
@@ -953,8 +1185,15 @@ void VKComputeParticles::PrepareCompute()
     // Create fences and semaphores
     //
 
-    m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE].resize(MAX_FRAME_LAG);
-    m_sampleComputeParams.FrameRes.Fences.resize(MAX_FRAME_LAG);
+    // With timeline semaphores, a couple of semaphores replaces the fences and the binary semaphores below
+    if (m_timelineSemaphores)
+    {
+        CreateTimelineSemaphores();
+        return;
+    }
+
+    m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete].resize(m_framesInFlight);
+    m_sampleComputeParams.FrameRes.Fences.resize(m_framesInFlight);
 
     VkSemaphoreCreateInfo semaphoreCreateInfo = {};
     semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -965,10 +1204,10 @@ void VKComputeParticles::PrepareCompute()
     fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Semaphore synchronizing graphics and compute operations
-        VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE][i]));
+        VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete][i]));
 
         // Signaled fence for synchronizing frames in compute queue
         VK_CHECK_RESULT(vkCreateFence(m_vulkanParams.Device, &fenceCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Fences[i]));
@@ -978,18 +1217,18 @@ void VKComputeParticles::PrepareCompute()
     // Create and signal the graphics semaphores (to immediately submit the compute work during the creation of the first frame)
     //
 
-    m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE].resize(MAX_FRAME_LAG);
+    m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete].resize(m_framesInFlight);
 
-    for (size_t i = 0; i < MAX_FRAME_LAG; i++)
+    for (size_t i = 0; i < m_framesInFlight; i++)
     {
         // Create an unsignaled semaphore
-        VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE][i]));
+        VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete][i]));
     }
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.signalSemaphoreCount = 2;
-    submitInfo.pSignalSemaphores = m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE].data();
+    submitInfo.signalSemaphoreCount = static_cast<uint32_t>(m_framesInFlight);   // One for each frame slot
+    submitInfo.pSignalSemaphores = m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete].data();
     VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
     VK_CHECK_RESULT(vkQueueWaitIdle(m_vulkanParams.GraphicsQueue.Handle));
 }
@@ -1002,30 +1241,63 @@ void VKComputeParticles::PopulateComputeCommandBuffer()
 
     VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
 
-    // Set a memory barrier for the current storage buffer between VS and CS
-    SetBufferMemoryBarrier(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex],
-                           m_storageBuffers[m_frameIndex].StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
-                           VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
-                           VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    if (m_timelineSemaphores)
+    {
+        // The first compute command buffer acquires the ownership of the simulation state, released 
+        // by the graphics queue family after the initial upload (see CreateStorageBuffers).
+        if (m_frameNumber == 1 && m_vulkanParams.ComputeQueue.FamilyIndex != m_vulkanParams.GraphicsQueue.FamilyIndex)
+            SetBufferMemoryBarrier(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex],
+                                   m_stateBuffer.StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
+                                   0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                   VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                   m_vulkanParams.GraphicsQueue.FamilyIndex, m_vulkanParams.ComputeQueue.FamilyIndex);
+
+        // Set a memory barrier for the simulation state between the dispatch of the previous frame and the current one.
+        // No barrier is needed for the current storage buffer: the graphics work that read it m_framesInFlight frames ago
+        // is complete (see WaitForFrameSlot), and its content is entirely overwritten.
+        SetBufferMemoryBarrier(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex],
+                               m_stateBuffer.StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
+                               VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
+    else
+    {
+        // Set a memory barrier for the current storage buffer between VS and CS
+        SetBufferMemoryBarrier(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex],
+                               m_storageBuffers[m_frameIndex].StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
+                               VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                               VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+    }
 
     // Bind the compute pipeline to a compute bind point of the command buffer
     vkCmdBindPipeline(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], 
                         VK_PIPELINE_BIND_POINT_COMPUTE, 
-                        m_sampleComputeParams.Pipelines[PIPELINE_COMPUTE]);
+                        m_sampleComputeParams.Pipelines[m_pipelineCompute]);
     
     // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
-    uint32_t dynamicOffset = m_meshObjects[MESH_PARTICLES].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+    uint32_t dynamicOffset = m_meshObjects[m_meshParticles].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
 
     // Bind descriptor set
     vkCmdBindDescriptorSets(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], 
                             VK_PIPELINE_BIND_POINT_COMPUTE, 
                             m_sampleParams.PipelineLayout, 
                             0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[DESC_SET_GRAPH_COMP][m_frameIndex], 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphComp][m_frameIndex], 
                             1, &dynamicOffset);
 
     // Dispatch compute work
-    vkCmdDispatch(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], 1, 1, 1);
+    m_computeProfiler.BeginScope(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], "Compute");
+    vkCmdDispatch(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], m_dispatchGroupCount[0], m_dispatchGroupCount[1], 1);
+    m_computeProfiler.EndScope(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex], "Compute");
+
+    // Release the ownership of the current storage buffer to the graphics queue family, if it differs from the compute one.
+    // The matching acquire operation is recorded in the graphics command buffer.
+    if (m_timelineSemaphores && m_vulkanParams.ComputeQueue.FamilyIndex != m_vulkanParams.GraphicsQueue.FamilyIndex)
+        SetBufferMemoryBarrier(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex],
+                               m_storageBuffers[m_frameIndex].StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
+                               VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               0, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                               m_vulkanParams.ComputeQueue.FamilyIndex, m_vulkanParams.GraphicsQueue.FamilyIndex);
 
     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
@@ -1058,11 +1330,28 @@ void VKComputeParticles::PopulateCommandBuffer(uint32_t currentImageIndex)
 
     VK_CHECK_RESULT(vkBeginCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], &cmdBufInfo));
 
-    // Set a memory barrier for the current storage buffer between CS and VS
-    SetBufferMemoryBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex],
-                           m_storageBuffers[m_frameIndex].StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
-                           VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
-                           VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+    if (!m_timelineSemaphores)
+    {
+        // Set a memory barrier for the current storage buffer between CS and VS
+        SetBufferMemoryBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex],
+                               m_storageBuffers[m_frameIndex].StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
+                               VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                               VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+    }
+    else if (m_vulkanParams.ComputeQueue.FamilyIndex != m_vulkanParams.GraphicsQueue.FamilyIndex)
+    {
+        // Acquire the ownership of the current storage buffer, released by the compute queue family.
+        // The source stage matches the stage at which the submission waits on the compute timeline semaphore,
+        // which also makes the writes of the compute shader visible (so no source access mask is needed).
+        SetBufferMemoryBarrier(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex],
+                               m_storageBuffers[m_frameIndex].StorageBuffer.Handle, VK_WHOLE_SIZE, 0,
+                               0, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                               VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                               m_vulkanParams.ComputeQueue.FamilyIndex, m_vulkanParams.GraphicsQueue.FamilyIndex);
+    }
+
+    // Measure the GPU time of the render pass (timestamps must be reset outside render pass instances)
+    m_profiler.BeginScope(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], "Graphics");
 
     // Begin the render pass instance.
     // This will clear the color attachment.
@@ -1089,38 +1378,74 @@ void VKComputeParticles::PopulateCommandBuffer(uint32_t currentImageIndex)
     vkCmdBindVertexBuffers(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 0, 1, &m_storageBuffers[m_frameIndex].StorageBuffer.Handle, offsets);
 
     // Dynamic offset used to offset into the uniform buffer described by the dynamic uniform buffer and containing mesh information
-    uint32_t dynamicOffset = m_meshObjects[MESH_PARTICLES].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
+    uint32_t dynamicOffset = m_meshObjects[m_meshParticles].dynIndex * static_cast<uint32_t>(m_dynamicUBOAlignment);
 
     // Bind the graphics pipeline
     vkCmdBindPipeline(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                         VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                        m_sampleParams.Pipelines[PIPELINE_RENDER]);
+                        m_sampleParams.Pipelines[m_pipelineRender]);
 
     // Bind descriptor set
     vkCmdBindDescriptorSets(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], 
                             VK_PIPELINE_BIND_POINT_GRAPHICS, 
                             m_sampleParams.PipelineLayout, 
                             0, 1, 
-                            &m_sampleParams.FrameRes.DescriptorSets[DESC_SET_GRAPH_COMP][m_frameIndex], 
+                            &m_sampleParams.FrameRes.DescriptorSets[m_descSetGraphComp][m_frameIndex], 
                             1, &dynamicOffset);
 
     // Draw the raindrops
-    vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[MESH_PARTICLES].vertexCount, 1, 0, 0);
+    vkCmdDraw(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], m_meshObjects[m_meshParticles].vertexCount, 1, 0, 0);
 
     // Ending the render pass will add an implicit barrier, transitioning the frame buffer color attachment to
     // VK_IMAGE_LAYOUT_PRESENT_SRC_KHR for presenting it to the windowing system
     vkCmdEndRenderPass(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]);
+    m_profiler.EndScope(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex], "Graphics");
     
     VK_CHECK_RESULT(vkEndCommandBuffer(m_sampleParams.FrameRes.CommandBuffers[m_frameIndex]));
 }
 
 void VKComputeParticles::SubmitCommandBuffer()
 {
+    if (m_timelineSemaphores)
+    {
+        // Wait for the compute work of this frame (timeline value m_frameNumber) before reading the storage buffer 
+        // as vertex buffer, and for the swapchain image before writing it.
+        // Signal the graphics timeline semaphore with the frame number when the command buffer has completed.
+        // The values of the binary semaphores are ignored.
+        VkPipelineStageFlags waitStageMasks[] = { VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+        VkSemaphore waitSemaphores[] = { m_computeTimeline, m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex] };
+        uint64_t waitValues[] = { m_frameNumber, 0 };
+        VkSemaphore signalSemaphores[] = { m_graphicsTimeline, m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] };
+        uint64_t signalValues[] = { m_frameNumber, 0 };
+
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.waitSemaphoreValueCount = 2;
+        timelineInfo.pWaitSemaphoreValues = waitValues;
+        timelineInfo.signalSemaphoreValueCount = 2;
+        timelineInfo.pSignalSemaphoreValues = signalValues;
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.pWaitDstStageMask = waitStageMasks;
+        submitInfo.waitSemaphoreCount = 2;
+        submitInfo.pWaitSemaphores = waitSemaphores;
+        submitInfo.signalSemaphoreCount = 2;
+        submitInfo.pSignalSemaphores = signalSemaphores;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_sampleParams.FrameRes.CommandBuffers[m_frameIndex];
+
+        // No fence: the CPU waits on the graphics timeline semaphore instead
+        VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
+        return;
+    }
+
     // Pipeline stages at which the queue submission will wait (via pWaitSemaphores)
     VkPipelineStageFlags waitStageMasks[] = {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
     // Wait Semaphores
-    VkSemaphore waitSemaphores[] = { m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE][m_frameIndex], m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex] };
-    VkSemaphore signalSemaphores[] = { m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE][m_frameIndex], m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] };
+    VkSemaphore waitSemaphores[] = { m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete][m_frameIndex], m_sampleParams.FrameRes.ImageAvailableSemaphores[m_frameIndex] };
+    VkSemaphore signalSemaphores[] = { m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete][m_frameIndex], m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex] };
     // The submit info structure specifies a command buffer queue submission batch
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1133,11 +1458,33 @@ void VKComputeParticles::SubmitCommandBuffer()
     submitInfo.pWaitSemaphores = waitSemaphores;        // Semaphore(s) to wait upon before the pWaitDstStageMask stagess start executing
     submitInfo.pSignalSemaphores = signalSemaphores;    // Semaphore(s) to be signaled when command buffers have completed
 
-    VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
+    VK_CHECK_RESULT(QueueSubmit(m_vulkanParams.GraphicsQueue.Handle, 1, &submitInfo, m_sampleParams.FrameRes.Fences[m_frameIndex]));
 }
 
 void VKComputeParticles::SubmitComputeCommandBuffer()
 {
+    if (m_timelineSemaphores)
+    {
+        // No wait: the simulation state is only accessed by the compute queue, and the graphics work that read 
+        // the current storage buffer is complete (see WaitForFrameSlot).
+        // Signal the compute timeline semaphore with the frame number when the command buffer has completed.
+        VkTimelineSemaphoreSubmitInfoKHR timelineInfo = {};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &m_frameNumber;
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &m_computeTimeline;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex];
+
+        VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.ComputeQueue.Handle, 1, &submitInfo, VK_NULL_HANDLE));
+        return;
+    }
+
     // Pipeline stage at which the queue submission will wait (via pWaitSemaphores)
     VkPipelineStageFlags waitStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
     // The submit info structure specifies a command buffer queue submission batch
@@ -1149,12 +1496,50 @@ void VKComputeParticles::SubmitComputeCommandBuffer()
     submitInfo.pCommandBuffers = &m_sampleComputeParams.FrameRes.CommandBuffers[m_frameIndex];    // Command buffers(s) to execute in this batch (submission)
     submitInfo.commandBufferCount = 1;                                                            // One command buffer
 
-    submitInfo.pWaitSemaphores = &m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_GRAPH_COMPLETE][m_frameIndex];    // Semaphore(s) to wait upon before the pWaitDstStageMask stages start executing
-    submitInfo.pSignalSemaphores = &m_sampleComputeParams.FrameRes.Semaphores[SEMAPHORE_COMP_COMPLETE][m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
+    submitInfo.pWaitSemaphores = &m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreGraphComplete][m_frameIndex];    // Semaphore(s) to wait upon before the pWaitDstStageMask stages start executing
+    submitInfo.pSignalSemaphores = &m_sampleComputeParams.FrameRes.Semaphores[m_semaphoreCompComplete][m_frameIndex];   // Semaphore(s) to be signaled when command buffers have completed
 
     VK_CHECK_RESULT(vkQueueSubmit(m_vulkanParams.ComputeQueue.Handle, 1, &submitInfo, m_sampleComputeParams.FrameRes.Fences[m_frameIndex]));
 }
 
+void VKComputeParticles::CreateTimelineSemaphores()
+{
+    // A timeline semaphore has a 64-bit counter instead of a binary state. Queue submissions signal it with 
+    // a value, and both queues and CPU can wait for the counter to reach a value.
+    // Here the counter is the number of the last frame whose compute (or graphics) work completed.
+    VkSemaphoreTypeCreateInfoKHR semaphoreTypeInfo = {};
+    semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+    semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+    semaphoreTypeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = &semaphoreTypeInfo;
+
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_computeTimeline));
+    VK_CHECK_RESULT(vkCreateSemaphore(m_vulkanParams.Device, &semaphoreCreateInfo, nullptr, &m_graphicsTimeline));
+}
+
+void VKComputeParticles::WaitForFrameSlot()
+{
+    // The resources of the current frame slot (command buffers, storage buffer, descriptor set, etc.) 
+    // were last used by frame m_frameNumber - m_framesInFlight. Its graphics work waited for its compute work,
+    // so waiting for the graphics timeline semaphore to reach that value is enough.
+    // The wait returns immediately if the GPU is not behind, so the CPU only blocks when the ring is full.
+    if (m_frameNumber <= m_framesInFlight)
+        return;
+
+    uint64_t waitValue = m_frameNumber - m_framesInFlight;
+
+    VkSemaphoreWaitInfoKHR waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_graphicsTimeline;
+    waitInfo.pValues = &waitValue;
+
+    VK_CHECK_RESULT(vkWaitSemaphoresKHR(m_vulkanParams.Device, &waitInfo, UINT64_MAX));
+}
+
 void VKComputeParticles::PresentImage(uint32_t currentImageIndex)
 {
     // Present the current image to the presentation engine.
@@ -1173,7 +1558,7 @@ void VKComputeParticles::PresentImage(uint32_t currentImageIndex)
         presentInfo.pWaitSemaphores = &m_sampleParams.FrameRes.RenderingCompleteSemaphores[m_frameIndex];
     }
 
-    VkResult present = vkQueuePresentKHR(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
+    VkResult present = QueuePresent(m_vulkanParams.GraphicsQueue.Handle, &presentInfo);
     if (!((present == VK_SUCCESS) || (present == VK_SUBOPTIMAL_KHR))) 
     {
         if (present == VK_ERROR_OUT_OF_DATE_KHR)
@@ -0,0 +1,101 @@
+#!/bin/bash
+
+# Run the samples in headless benchmark mode and compare the results against a stored baseline.
+#
+# Usage: scripts/benchmark.sh [options] [sample directories...]   (all the samples if none is specified)
+#   --frames N        Number of frames to measure (default: 1000)
+#   --warmup M        Number of frames to render before measuring (default: 100)
+#   --threshold P     Max increase (in percent) of a metric before it's reported as a regression (default: 10)
+#   --save-baseline   Store the results as the new baseline instead of comparing them
+#   --no-build        Don't build the samples before running them
+#
+# Results are written to benchmarks/results, the baseline is stored in benchmarks/baseline.
+# The results are read with python3, which must be available in the PATH.
+# The script returns a non-zero exit code if a sample fails or a regression is detected.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results
+BASELINE_DIR=$ROOT/benchmarks/baseline
+
+FRAMES=1000
+WARMUP=100
+THRESHOLD=10
+SAVE_BASELINE=0
+SAMPLES=()
+
+declare -A VALUE_OPTIONS=([--threshold]=THRESHOLD)
+declare -A SWITCH_OPTIONS=([--save-baseline]="SAVE_BASELINE=1")
+ACCEPT_SAMPLES=1
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+if [ ${#SAMPLES[@]} -eq 0 ]; then
+    for dir in "$ROOT"/samples/*/; do
+        SAMPLES+=("$(basename "$dir")")
+    done
+fi
+
+# Print a line and return non-zero if the value is worse than the baseline by more than THRESHOLD percent
+compare()
+{
+    local name=$1
+    local value=$2
+    local baseline=$3
+
+    if [ -z "$value" ] || [ -z "$baseline" ]; then
+        return 0
+    fi
+
+    awk -v n="$name" -v v="$value" -v b="$baseline" -v t="$THRESHOLD" 'BEGIN {
+        change = (b > 0) ? 100.0 * (v - b) / b : 0.0;
+        status = (change > t) ? "REGRESSION" : "ok";
+        printf "    %-16s %10.3f %10.3f %+8.1f%%  %s\n", n, b, v, change, status;
+        exit (change > t) ? 1 : 0;
+    }'
+}
+
+REGRESSIONS=0
+
+for sample in "${SAMPLES[@]}"; do
+    result=$RESULTS_DIR/$sample.json
+
+    if ! exe=$(find_executable $sample); then
+        FAILURES=$((FAILURES + 1))
+        continue
+    fi
+
+    echo "Running $sample..."
+    run_benchmark "$result" "$sample" "$exe" --headless || continue
+
+    if [ $SAVE_BASELINE -eq 1 ]; then
+        mkdir -p "$BASELINE_DIR"
+        cp "$result" "$BASELINE_DIR/$sample.json"
+        continue
+    fi
+
+    baseline=$BASELINE_DIR/$sample.json
+    if [ ! -f "$baseline" ]; then
+        echo "    no baseline to compare with"
+        continue
+    fi
+
+    printf "    %-16s %10s %10s %9s\n" "(ms, MB)" "baseline" "current" "change"
+
+    for metric in cpuMs gpuMs acquireMs presentMs latencyMs; do
+        for stat in avg p95; do
+            compare "$metric $stat" "$(get_value "$result" $metric.$stat)" "$(get_value "$baseline" $metric.$stat)" || REGRESSIONS=$((REGRESSIONS + 1))
+        done
+    done
+
+    compare "peak memory" "$(get_value "$result" peakDeviceMemoryMB)" "$(get_value "$baseline" peakDeviceMemoryMB)" || REGRESSIONS=$((REGRESSIONS + 1))
+done
+
+if [ $SAVE_BASELINE -eq 1 ]; then
+    echo "Baseline saved to $BASELINE_DIR"
+fi
+
+echo "$FAILURES sample(s) failed, $REGRESSIONS regression(s) detected."
+
+if [ $FAILURES -ne 0 ] || [ $REGRESSIONS -ne 0 ]; then
+    exit 1
+fi
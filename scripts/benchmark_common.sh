@@ -0,0 +1,125 @@
+#!/bin/bash
+
+# Code shared by the benchmark scripts, which source it with their command-line arguments once they have set
+# ROOT, RESULTS_DIR and the default values of their options:
+#
+#   VALUE_OPTIONS    Options taking a value, mapped to the variable they set (for e.g. [--quads]=QUADS)
+#   SWITCH_OPTIONS   Options without a value, mapped to the assignment they make (for e.g. [--autotune]="AUTOTUNE=--autotune")
+#   ACCEPT_SAMPLES   If 1, the other arguments are sample directories, which replace the SAMPLES array
+#
+# --frames N, --warmup M and --no-build are handled for every script. Any other option is an error.
+# Once the options are parsed the samples are built (unless --no-build is given), and RESULTS_DIR is created.
+
+declare -A VALUE_OPTIONS SWITCH_OPTIONS
+
+BUILD=1
+FAILURES=0
+
+parse_options()
+{
+    local samplesSet=0
+
+    while [ $# -gt 0 ]; do
+        case $1 in
+            --frames) FRAMES=$2; shift ;;
+            --warmup) WARMUP=$2; shift ;;
+            --no-build) BUILD=0 ;;
+            *)
+                if [ -n "${VALUE_OPTIONS[$1]}" ]; then
+                    printf -v "${VALUE_OPTIONS[$1]}" '%s' "$2"
+                    shift
+                elif [ -n "${SWITCH_OPTIONS[$1]}" ]; then
+                    printf -v "${SWITCH_OPTIONS[$1]%%=*}" '%s' "${SWITCH_OPTIONS[$1]#*=}"
+                elif [ "$ACCEPT_SAMPLES" = 1 ] && [ "${1#--}" = "$1" ]; then
+                    [ $samplesSet -eq 0 ] && SAMPLES=()
+                    SAMPLES+=("$(basename "$1")")
+                    samplesSet=1
+                else
+                    echo "Unknown option: $1"
+                    exit 1
+                fi
+                ;;
+        esac
+        shift
+    done
+}
+
+build_all()
+{
+    if [ $BUILD -eq 1 ]; then
+        bash "$ROOT/scripts/build_all.sh" || exit 1
+    fi
+
+    mkdir -p "$RESULTS_DIR"
+}
+
+# Print the path of the executable of a sample, or return non-zero (with a message) if it wasn't built
+find_executable()
+{
+    local exe
+    exe=$(ls "$ROOT/samples/$1"/*.out 2>/dev/null | head -n 1)
+
+    if [ -z "$exe" ]; then
+        echo "$1: executable not found" >&2
+        return 1
+    fi
+
+    echo "$exe"
+}
+
+# Run a sample in benchmark mode, with FRAMES measured frames after WARMUP frames, and write its results to the
+# given file (and its output next to it, in a .log file). The arguments after the executable are passed to the sample.
+# If no result is written, print the label of the run, count it in FAILURES and return non-zero.
+run_benchmark()
+{
+    local result=$1
+    local label=$2
+    local exe=$3
+    shift 3
+
+    rm -f "$result"
+    (cd "$(dirname "$exe")" && "$exe" --benchmark --frames "$FRAMES" --warmup "$WARMUP" "$@" --out "$result" > "${result%.json}.log" 2>&1)
+
+    if [ ! -f "$result" ]; then
+        echo "$label: benchmark failed (see ${result%.json}.log)"
+        FAILURES=$((FAILURES + 1))
+        return 1
+    fi
+}
+
+# Print the avg and p95 values of a metric (for e.g. cpuMs) in a results file, or nothing if not measured
+get_stats()
+{
+    python3 -c '
+import json, sys
+stats = json.load(open(sys.argv[1])).get(sys.argv[2])
+if isinstance(stats, dict):
+    print("%.4f %.4f" % (stats["avg"], stats["p95"]))
+' "$1" "$2"
+}
+
+# Print a value of a results file, given its key path (for e.g. fps or cpuMs.p99), or nothing if not measured
+get_value()
+{
+    python3 -c '
+import json, sys
+value = json.load(open(sys.argv[1]))
+for key in sys.argv[2].split("."):
+    value = value.get(key) if isinstance(value, dict) else None
+if value is not None:
+    print(value)
+' "$1" "$2"
+}
+
+# Print the number of failed runs, and exit with a non-zero code if there is any
+report_failures()
+{
+    echo "$FAILURES run(s) failed."
+
+    if [ $FAILURES -ne 0 ]; then
+        exit 1
+    fi
+}
+
+parse_options "$@"
+build_all
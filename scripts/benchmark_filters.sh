@@ -0,0 +1,69 @@
+#!/bin/bash
+
+# Measure the GPU time of chains of compute filters in the compute shader sample (02.F), for increasing sizes of the
+# input texture. The sample runs in headless benchmark mode, and the GPU time of the compute work is read from the
+# profiler report printed at exit, which also includes the GPU time of each pass of the chain (see the log of the run).
+#
+# Usage: scripts/benchmark_filters.sh [options]
+#   --frames N        Number of frames to measure (default: 300)
+#   --warmup M        Number of frames to render before measuring (default: 50)
+#   --sizes "A B"     Sizes of the (square) input texture to test (default: "1024 2048 4096")
+#   --chains "A B"    Chains of filters to test (default: "luminance blur gaussian sobel levels bilateral blur,sobel,levels,bilateral")
+#   --input file.ppm  Use an image loaded from disk as input (--sizes is ignored)
+#   --autotune        Let the sample select the fastest workgroup size of each pass (the sizes selected are in the log)
+#   --no-build        Don't build the samples before running them
+#
+# Results are written to benchmarks/results/filters.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results/filters
+
+FRAMES=300
+WARMUP=50
+SIZES="1024 2048 4096"
+CHAINS="luminance blur gaussian sobel levels bilateral blur,sobel,levels,bilateral"
+INPUT=""
+AUTOTUNE=""
+SAMPLE=02F-VkComputeShader
+
+declare -A VALUE_OPTIONS=([--sizes]=SIZES [--chains]=CHAINS [--input]=INPUT)
+declare -A SWITCH_OPTIONS=([--autotune]="AUTOTUNE=--autotune")
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+# Print the avg and p99 GPU times of a profiler scope in a log file, or nothing if not measured
+get_scope_stats()
+{
+    sed -n "s/^GPU $2 *min [0-9.]* ms, avg \([0-9.]*\) ms, p99 \([0-9.]*\) ms.*/\1 \2/p" "$1"
+}
+
+exe=$(find_executable $SAMPLE) || exit 1
+
+# The sample runs from its own directory
+if [ -n "$INPUT" ]; then
+    INPUT=$(cd "$(dirname "$INPUT")" && pwd)/$(basename "$INPUT")
+    SIZES=$(basename "$INPUT")
+fi
+
+echo "$SAMPLE"
+printf "    %-36s %-12s %10s %12s %12s\n" "filters" "input" "fps" "compute avg" "compute p99"
+
+for size in $SIZES; do
+    for chain in $CHAINS; do
+        result=$RESULTS_DIR/$SAMPLE-${chain//,/-}-$size.json
+
+        if [ -n "$INPUT" ]; then
+            inputFlags="--input $INPUT"
+        else
+            inputFlags="--input-size $size"
+        fi
+
+        run_benchmark "$result" "    $chain $size" "$exe" --headless --filters "$chain" $inputFlags $AUTOTUNE || continue
+
+        fps=$(get_value "$result" fps)
+        read -r computeAvg computeP99 <<< "$(get_scope_stats "${result%.json}.log" Compute)"
+        printf "    %-36s %-12s %10s %12s %12s\n" "$chain" "$size" "${fps:--}" "${computeAvg:--}" "${computeP99:--}"
+    done
+done
+
+report_failures
@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Build and run the microbenchmark comparing the lookup of named resources in a std::map<std::string, ...>
+# against the access through the handles of a VKHandleTable (framework/inc/VKHandleTable.hpp).
+#
+# Usage: scripts/benchmark_handle_table.sh [iterations]
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+OUT_DIR=$ROOT/framework/obj
+
+CXX=${CXX:-g++}
+
+mkdir -p "$OUT_DIR"
+$CXX -std=c++11 -O2 -I"$ROOT/framework/inc" "$ROOT/framework/benchmarks/HandleTableBench.cpp" -o "$OUT_DIR/HandleTableBench.out" || exit 1
+
+"$OUT_DIR/HandleTableBench.out" "$@"
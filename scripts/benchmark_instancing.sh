@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Compare the CPU and GPU frame times of the samples drawing many objects with a draw call each (using a dynamic
+# uniform buffer) against drawing them with instanced draw calls (--instanced), for an increasing number of objects.
+#
+# Usage: scripts/benchmark_instancing.sh [options]
+#   --frames N        Number of frames to measure (default: 500)
+#   --warmup M        Number of frames to render before measuring (default: 50)
+#   --objects "A B"   Numbers of objects to test (default: "1000 10000 100000")
+#   --no-build        Don't build the samples before running them
+#
+# Results are written to benchmarks/results/instancing.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results/instancing
+
+FRAMES=500
+WARMUP=50
+OBJECTS="1000 10000 100000"
+SAMPLES=(01G-VkHelloTransformations 01H-VkHelloLighting)
+
+declare -A VALUE_OPTIONS=([--objects]=OBJECTS)
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+for sample in "${SAMPLES[@]}"; do
+    if ! exe=$(find_executable $sample); then
+        FAILURES=$((FAILURES + 1))
+        continue
+    fi
+
+    echo "$sample"
+    printf "    %-10s %-10s %10s %10s %10s %10s\n" "objects" "mode" "cpu avg" "cpu p95" "gpu avg" "gpu p95"
+
+    for count in $OBJECTS; do
+        for mode in dynamic instanced; do
+            result=$RESULTS_DIR/$sample-$count-$mode.json
+            flags=""
+            [ $mode = instanced ] && flags="--instanced"
+
+            run_benchmark "$result" "    $count $mode" "$exe" --headless --objects "$count" $flags || continue
+
+            read -r cpuAvg cpuP95 <<< "$(get_stats "$result" cpuMs)"
+            read -r gpuAvg gpuP95 <<< "$(get_stats "$result" gpuMs)"
+            printf "    %-10s %-10s %10s %10s %10s %10s\n" "$count" "$mode" "${cpuAvg:--}" "${cpuP95:--}" "${gpuAvg:--}" "${gpuP95:--}"
+        done
+    done
+done
+
+report_failures
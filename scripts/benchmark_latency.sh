@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Measure the throughput/latency tradeoff of a sample for each number of frames in flight and present mode:
+# the sample runs in windowed benchmark mode (the frames must be presented for the latency to be meaningful),
+# and the frame rate and the input-to-present latency are reported for every configuration.
+#
+# Usage: scripts/benchmark_latency.sh [options] [sample directory]   (01E-VkHelloFrameBuffering if none is specified)
+#   --frames N        Number of frames to measure (default: 500)
+#   --warmup M        Number of frames to render before measuring (default: 100)
+#   --in-flight "A B" Numbers of frames in flight to test (default: "1 2 3 4")
+#   --modes "A B"     Present modes to test (default: "fifo fifo_relaxed mailbox immediate")
+#   --present-wait    Pace the frames with VK_KHR_present_wait (if supported), which also measures the actual present time
+#   --no-build        Don't build the samples before running them
+#
+# Results are written to benchmarks/results/latency.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results/latency
+
+FRAMES=500
+WARMUP=100
+IN_FLIGHT="1 2 3 4"
+MODES="fifo fifo_relaxed mailbox immediate"
+PRESENT_WAIT=""
+SAMPLES=(01E-VkHelloFrameBuffering)
+
+declare -A VALUE_OPTIONS=([--in-flight]=IN_FLIGHT [--modes]=MODES)
+declare -A SWITCH_OPTIONS=([--present-wait]="PRESENT_WAIT=--present-wait")
+ACCEPT_SAMPLES=1
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+SAMPLE=${SAMPLES[0]}
+exe=$(find_executable $SAMPLE) || exit 1
+
+echo "$SAMPLE"
+printf "    %-14s %-10s %10s %12s %12s\n" "mode" "in flight" "fps" "latency avg" "latency p95"
+
+for mode in $MODES; do
+    for count in $IN_FLIGHT; do
+        result=$RESULTS_DIR/$SAMPLE-$mode-$count.json
+        run_benchmark "$result" "    $mode $count" "$exe" --present-mode "$mode" --frames-in-flight "$count" $PRESENT_WAIT || continue
+
+        fps=$(get_value "$result" fps)
+        read -r latencyAvg latencyP95 <<< "$(get_stats "$result" latencyMs)"
+        printf "    %-14s %-10s %10s %12s %12s\n" "$mode" "$count" "${fps:--}" "${latencyAvg:--}" "${latencyP95:--}"
+    done
+done
+
+report_failures
@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# Measure the effect of mipmaps on the texture sampling cost in the textures sample (01.F): a large texture is repeated
+# over the triangle (so that it's minified), which is drawn several times to make the frame bound by texture sampling.
+# The sample runs in headless benchmark mode for each mipmap mode and texture size, and the time taken to generate the
+# mip levels (by blits or by the compute downsampler) is read from the log of the run.
+#
+# Usage: scripts/benchmark_mipmaps.sh [options]
+#   --frames N        Number of frames to measure (default: 300)
+#   --warmup M        Number of frames to render before measuring (default: 50)
+#   --modes "A B"     Mipmap modes to test (default: "none blit compute")
+#   --sizes "A B"     Sizes of the (square) texture to test (default: "1024 4096")
+#   --tiling N        Number of times the texture is repeated over the triangle (default: 8)
+#   --overdraw N      Number of times the triangle is drawn (default: 32)
+#   --anisotropy N    Max anisotropy of the sampler, 1 to disable anisotropic filtering (default: 16)
+#   --no-build        Don't build the samples before running them
+#
+# Results are written to benchmarks/results/mipmaps.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results/mipmaps
+
+FRAMES=300
+WARMUP=50
+MODES="none blit compute"
+SIZES="1024 4096"
+TILING=8
+OVERDRAW=32
+ANISOTROPY=16
+SAMPLE=01F-VkHelloTextures
+
+declare -A VALUE_OPTIONS=([--modes]=MODES [--sizes]=SIZES [--tiling]=TILING [--overdraw]=OVERDRAW [--anisotropy]=ANISOTROPY)
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+# Print the time taken to generate the mip levels in a log file, or nothing if not generated
+get_mipmap_time()
+{
+    sed -n "s/^Mip levels generated with .* in \([0-9.]*\) ms$/\1/p" "$1"
+}
+
+exe=$(find_executable $SAMPLE) || exit 1
+
+echo "$SAMPLE (tiling $TILING, overdraw $OVERDRAW, anisotropy $ANISOTROPY)"
+printf "    %-10s %-8s %10s %10s %10s %14s\n" "mips" "size" "fps" "gpu avg" "gpu p95" "generation ms"
+
+for size in $SIZES; do
+    for mode in $MODES; do
+        result=$RESULTS_DIR/$SAMPLE-$mode-$size.json
+        run_benchmark "$result" "    $mode $size" "$exe" --headless --mips "$mode" --texture-size "$size" --tiling "$TILING" --overdraw "$OVERDRAW" --anisotropy "$ANISOTROPY" || continue
+
+        fps=$(get_value "$result" fps)
+        read -r gpuAvg gpuP95 <<< "$(get_stats "$result" gpuMs)"
+        generation=$(get_mipmap_time "${result%.json}.log")
+        printf "    %-10s %-8s %10s %10s %10s %14s\n" "$mode" "$size" "${fps:--}" "${gpuAvg:--}" "${gpuP95:--}" "${generation:--}"
+    done
+done
+
+report_failures
@@ -0,0 +1,50 @@
+#!/bin/bash
+
+# Compare the CPU and GPU frame times of the geometry shader sample (02.C) when the normals of the triangles of the
+# sphere are drawn by the geometry shader every frame (--normals gs), and when they are generated by a compute shader
+# into a vertex buffer, only when the mesh changes, and drawn as a list of lines (--normals compute). The frame times
+# without normals (--normals none) are the baseline. The sample runs in headless benchmark mode for a few
+# tessellations of the sphere, with a static sphere and a deforming one (whose normal lines are generated every frame).
+#
+# Usage: scripts/benchmark_normals.sh [options]
+#   --frames N              Number of frames to measure (default: 500)
+#   --warmup M              Number of frames to render before measuring (default: 50)
+#   --tessellations "A B"   Tessellations of the sphere to test (default: "20 90 180")
+#   --no-build              Don't build the samples before running them
+#
+# Results are written to benchmarks/results/normals.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results/normals
+
+FRAMES=500
+WARMUP=50
+TESSELLATIONS="20 90 180"
+SAMPLE=02C-VkGeometryShader
+
+declare -A VALUE_OPTIONS=([--tessellations]=TESSELLATIONS)
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+exe=$(find_executable $SAMPLE) || exit 1
+
+echo "$SAMPLE"
+printf "    %-13s %-9s %-8s %10s %10s %10s %10s\n" "tessellation" "mesh" "normals" "cpu avg" "cpu p95" "gpu avg" "gpu p95"
+
+for tessellation in $TESSELLATIONS; do
+    for mesh in static deform; do
+        for mode in none gs compute; do
+            result=$RESULTS_DIR/$SAMPLE-$tessellation-$mesh-$mode.json
+            flags="--normals $mode"
+            [ $mesh = deform ] && flags="$flags --deform"
+
+            run_benchmark "$result" "    $tessellation $mesh $mode" "$exe" --headless --sphere-tessellation "$tessellation" $flags || continue
+
+            read -r cpuAvg cpuP95 <<< "$(get_stats "$result" cpuMs)"
+            read -r gpuAvg gpuP95 <<< "$(get_stats "$result" gpuMs)"
+            printf "    %-13s %-9s %-8s %10s %10s %10s %10s\n" "$tessellation" "$mesh" "$mode" "${cpuAvg:--}" "${cpuP95:--}" "${gpuAvg:--}" "${gpuP95:--}"
+        done
+    done
+done
+
+report_failures
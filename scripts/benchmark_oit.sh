@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Compare the CPU and GPU frame times of the transparency modes of the alpha blending sample (02.A): quads sorted
+# back to front on the CPU (sorted), weighted blended order-independent transparency (weighted), and per-pixel linked
+# lists sorted in the composite subpass (linked). The sample runs in headless benchmark mode for an increasing number of
+# quads. The max number of fragments stored in the linked lists in a frame is reported for the linked mode.
+#
+# Usage: scripts/benchmark_oit.sh [options]
+#   --frames N          Number of frames to measure (default: 500)
+#   --warmup M          Number of frames to render before measuring (default: 50)
+#   --quads "A B"       Numbers of quads to test (default: "1000 2000 4000")
+#   --oit-nodes N       Fragments per pixel the linked lists can store (default: 16)
+#   --no-build          Don't build the samples before running them
+#
+# Results are written to benchmarks/results/oit.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results/oit
+
+FRAMES=500
+WARMUP=50
+QUADS="1000 2000 4000"
+NODES=16
+SAMPLE=02A-VkAlphaBlending
+
+declare -A VALUE_OPTIONS=([--quads]=QUADS [--oit-nodes]=NODES)
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+EXE=$(find_executable $SAMPLE) || exit 1
+
+printf "%-8s %-10s %12s %10s %10s %10s %10s\n" "quads" "mode" "fragments" "cpu avg" "cpu p95" "gpu avg" "gpu p95"
+
+for quads in $QUADS; do
+    for mode in sorted weighted linked; do
+        flags=""
+        if [ $mode = linked ]; then
+            flags="--oit-nodes $NODES"
+        fi
+
+        result=$RESULTS_DIR/$SAMPLE-$quads-$mode.json
+        run_benchmark "$result" "$quads $mode" "$EXE" --headless --quads "$quads" --oit $mode $flags || continue
+
+        # Printed by the sample at exit in linked mode
+        fragments=$(sed -n "s/^Linked lists: up to \([0-9]*\) fragments.*/\1/p" "${result%.json}.log")
+
+        read -r cpuAvg cpuP95 <<< "$(get_stats "$result" cpuMs)"
+        read -r gpuAvg gpuP95 <<< "$(get_stats "$result" gpuMs)"
+        printf "%-8s %-10s %12s %10s %10s %10s %10s\n" "$quads" "$mode" "${fragments:--}" "${cpuAvg:--}" "${cpuP95:--}" "${gpuAvg:--}" "${gpuP95:--}"
+    done
+done
+
+report_failures
@@ -0,0 +1,55 @@
+#!/bin/bash
+
+# Compare the CPU and GPU frame times of the two particle systems of the samples: the transform feedback sample (02.D),
+# which updates the particles in a vertex shader and captures them in one of two streams while drawing the other one
+# (plus a geometry shader spawning and killing raindrops with --emit), and the compute particles sample (02.G), which
+# updates them with a compute shader. Both samples run in headless benchmark mode for an increasing number of
+# particles. The average number of live particles is reported for 02.D (it changes over time with --emit).
+#
+# Usage: scripts/benchmark_particles.sh [options]
+#   --frames N          Number of frames to measure (default: 500)
+#   --warmup M          Number of frames to render before measuring (default: 50)
+#   --particles "A B"   Numbers of particles to test (default: "1000000 2000000 4000000")
+#   --no-build          Don't build the samples before running them
+#
+# Results are written to benchmarks/results/particles.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results/particles
+
+FRAMES=500
+WARMUP=50
+PARTICLES="1000000 2000000 4000000"
+TF_SAMPLE=02D-VkTransformFeedback
+COMPUTE_SAMPLE=02G-VkComputeParticles
+
+declare -A VALUE_OPTIONS=([--particles]=PARTICLES)
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+TF_EXE=$(find_executable $TF_SAMPLE) || exit 1
+COMPUTE_EXE=$(find_executable $COMPUTE_SAMPLE) || exit 1
+
+printf "%-10s %-32s %10s %10s %10s %10s %10s\n" "particles" "mode" "live avg" "cpu avg" "cpu p95" "gpu avg" "gpu p95"
+
+for particles in $PARTICLES; do
+    for mode in feedback emit compute; do
+        case $mode in
+            feedback) sample=$TF_SAMPLE; exe=$TF_EXE; flags="" ;;
+            emit) sample=$TF_SAMPLE; exe=$TF_EXE; flags="--emit" ;;
+            compute) sample=$COMPUTE_SAMPLE; exe=$COMPUTE_EXE; flags="" ;;
+        esac
+
+        result=$RESULTS_DIR/$sample-$particles-$mode.json
+        run_benchmark "$result" "$particles $mode" "$exe" --headless --particles "$particles" $flags || continue
+
+        # Printed by 02.D at exit (emitters included)
+        live=$(sed -n "s/^Live particles: avg \([0-9]*\),.*/\1/p" "${result%.json}.log")
+
+        read -r cpuAvg cpuP95 <<< "$(get_stats "$result" cpuMs)"
+        read -r gpuAvg gpuP95 <<< "$(get_stats "$result" gpuMs)"
+        printf "%-10s %-32s %10s %10s %10s %10s %10s\n" "$particles" "$sample $mode" "${live:--}" "${cpuAvg:--}" "${cpuP95:--}" "${gpuAvg:--}" "${gpuP95:--}"
+    done
+done
+
+report_failures
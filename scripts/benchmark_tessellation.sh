@@ -0,0 +1,61 @@
+#!/bin/bash
+
+# Compare the CPU and GPU frame times of the tessellation sample (02.E) when the Bézier patches are evaluated by the
+# tessellation shaders every frame, and when they are tessellated by a compute shader into a cache of vertices
+# (--tess-compute), only when their tessellation levels change. The sample runs in headless benchmark mode for an
+# increasing number of patches, with rotating patches (whose levels change over time) and static ones, and the hit
+# rate of the tessellation cache is read from the log of the run.
+#
+# Usage: scripts/benchmark_tessellation.sh [options]
+#   --frames N        Number of frames to measure (default: 500)
+#   --warmup M        Number of frames to render before measuring (default: 50)
+#   --patches "A B"   Sizes of the grid of patches to test (default: "8 32 64")
+#   --pixels P        Target length of the edges of the triangles in pixels (default: 8)
+#   --no-build        Don't build the samples before running them
+#
+# Results are written to benchmarks/results/tessellation.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RESULTS_DIR=$ROOT/benchmarks/results/tessellation
+
+FRAMES=500
+WARMUP=50
+PATCHES="8 32 64"
+PIXELS=8
+SAMPLE=02E-VkTessellation
+
+declare -A VALUE_OPTIONS=([--patches]=PATCHES [--pixels]=PIXELS)
+
+source "$ROOT/scripts/benchmark_common.sh" "$@"
+
+# Print the hit rate of the tessellation cache in a log file, or nothing if the cache wasn't used
+get_hit_rate()
+{
+    sed -n "s/^Tessellation cache: .* hits (\([0-9.]*\)%).*/\1/p" "$1"
+}
+
+exe=$(find_executable $SAMPLE) || exit 1
+
+echo "$SAMPLE ($PIXELS pixels per edge)"
+printf "    %-8s %-10s %-9s %10s %10s %10s %10s %10s\n" "patches" "motion" "mode" "cpu avg" "cpu p95" "gpu avg" "gpu p95" "hit rate"
+
+for count in $PATCHES; do
+    for motion in rotating static; do
+        for mode in shaders compute; do
+            result=$RESULTS_DIR/$SAMPLE-$count-$motion-$mode.json
+            flags=""
+            [ $mode = compute ] && flags="--tess-compute"
+            [ $motion = static ] && flags="$flags --rotation-speed 0"
+
+            run_benchmark "$result" "    $count $motion $mode" "$exe" --headless --patches "$count" --tess-pixels "$PIXELS" $flags || continue
+
+            read -r cpuAvg cpuP95 <<< "$(get_stats "$result" cpuMs)"
+            read -r gpuAvg gpuP95 <<< "$(get_stats "$result" gpuMs)"
+            hitRate=$(get_hit_rate "${result%.json}.log")
+            [ -n "$hitRate" ] && hitRate="$hitRate%"
+            printf "    %-8s %-10s %-9s %10s %10s %10s %10s %10s\n" "$count" "$motion" "$mode" "${cpuAvg:--}" "${cpuP95:--}" "${gpuAvg:--}" "${gpuP95:--}" "${hitRate:--}"
+        done
+    done
+done
+
+report_failures
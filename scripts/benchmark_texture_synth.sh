@@ -0,0 +1,18 @@
+#!/bin/bash
+
+# Build and run the microbenchmark comparing the generation of procedural textures by VKTextureSynth
+# (framework/inc/VKTextureSynth.hpp) against the checkerboard loop the samples used to run at startup.
+#
+# Usage: scripts/benchmark_texture_synth.sh [max size] [repetitions]
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+OUT_DIR=$ROOT/framework/obj
+
+CXX=${CXX:-g++}
+
+mkdir -p "$OUT_DIR"
+$CXX -std=c++11 -O2 -pthread -I"$ROOT/framework/inc" -I"$ROOT/external/include/vulkan" \
+    "$ROOT/framework/benchmarks/TextureSynthBench.cpp" "$ROOT/framework/src/VKTextureSynth.cpp" "$ROOT/framework/src/VKJobSystem.cpp" \
+    -o "$OUT_DIR/TextureSynthBench.out" || exit 1
+
+"$OUT_DIR/TextureSynthBench.out" "$@"
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Build the framework library once, then all the samples in parallel.
+# Every build is incremental: only the files changed since the previous build are recompiled.
+# Usage: scripts/build_all.sh [number of parallel jobs]
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+JOBS=${1:-$(nproc)}
+
+(cd "$ROOT/framework" && bash scripts/build.sh) || exit 1
+
+export SKIP_FRAMEWORK=1
+
+ls -d "$ROOT"/samples/*/ | xargs -P "$JOBS" -I {} bash -c \
+    'cd "{}" && bash scripts/build.sh > build.log 2>&1 || { echo "FAILED: $(basename "{}") (see {}build.log)"; exit 1; }'
+
+if [ $? -ne 0 ]; then
+    echo Some samples failed to build.
+    exit 1
+fi
+
+echo All samples built.
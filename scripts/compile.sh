@@ -0,0 +1,106 @@
+#!/bin/bash
+
+# Helpers shared by the build scripts of the framework and of the samples.
+# Source this file, then call compile_sources and link_executable (or archive_library).
+# Only the sources whose object file is missing or older than the source or one of the headers it includes
+# (as listed in the dependency file generated by the compiler) are recompiled.
+# Set CXXFLAGS to override the default optimization flags, for example CXXFLAGS="-O0 -g".
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:-"-O2 -g"}
+
+# Return success if $1 must be rebuilt from the files listed in the dependency file $2
+needs_rebuild()
+{
+    local obj=$1
+    local dep=$2
+
+    if [ ! -f "$obj" ] || [ ! -f "$dep" ]; then
+        return 0
+    fi
+
+    # Only the first rule of the dependency file lists the prerequisites of the object file
+    # (-MP appends a phony rule for each header)
+    local prereqs
+    prereqs=$(sed -e '/^$/,$d' -e 's/^[^:]*://' -e 's/\\$//' "$dep")
+
+    local file
+    for file in $prereqs; do
+        if [ ! -f "$file" ] || [ "$file" -nt "$obj" ]; then
+            return 0
+        fi
+    done
+
+    return 1
+}
+
+# compile_sources <object directory> <compiler flags> <source files...>
+# Sets OBJECTS to the list of object files and returns non-zero if a source fails to compile.
+compile_sources()
+{
+    local objdir=$1
+    local flags=$2
+    shift 2
+
+    mkdir -p "$objdir"
+
+    # Rebuild everything if the compiler flags changed since the last build
+    local flagsfile="$objdir/flags.txt"
+    local allflags="$CXX $CXXFLAGS $flags"
+    if [ ! -f "$flagsfile" ] || [ "$(cat "$flagsfile")" != "$allflags" ]; then
+        rm -f "$objdir"/*.o "$objdir"/*.d
+        echo "$allflags" > "$flagsfile"
+    fi
+
+    OBJECTS=""
+    local src obj
+    for src in "$@"; do
+        obj="$objdir/$(basename "${src%.*}").o"
+        OBJECTS="$OBJECTS $obj"
+
+        if needs_rebuild "$obj" "${obj%.o}.d"; then
+            echo "    $src"
+            $CXX $CXXFLAGS -MMD -MP -c "$src" -o "$obj" $flags || return 1
+        fi
+    done
+
+    return 0
+}
+
+# archive_library <library> <object files...>
+archive_library()
+{
+    local lib=$1
+    shift
+
+    local obj
+    for obj in "$@"; do
+        if [ ! -f "$lib" ] || [ "$obj" -nt "$lib" ]; then
+            mkdir -p "$(dirname "$lib")"
+            rm -f "$lib"
+            ar rcs "$lib" "$@"
+            return $?
+        fi
+    done
+
+    return 0
+}
+
+# link_executable <executable> <libraries the executable depends on> <linker flags> <object files...>
+link_executable()
+{
+    local exe=$1
+    local deps=$2
+    local links=$3
+    shift 3
+
+    local file
+    for file in "$@" $deps; do
+        if [ ! -f "$exe" ] || [ "$file" -nt "$exe" ]; then
+            $CXX $CXXFLAGS "$@" -o "$exe" $links
+            return $?
+        fi
+    done
+
+    return 0
+}